@@ -64,6 +64,18 @@ CommandLineHandler::CommandLineHandler()
     m_run_unit_benchmarks.set_max_value_count(1);
     parser().add_option_handler(&m_run_unit_benchmarks);
 
+    m_benchmark_baseline.add_name("--benchmark-baseline");
+    m_benchmark_baseline.set_description("compare unit benchmark results against a previous results file or directory of results files");
+    m_benchmark_baseline.set_syntax("path");
+    m_benchmark_baseline.set_exact_value_count(1);
+    parser().add_option_handler(&m_benchmark_baseline);
+
+    m_benchmark_threshold.add_name("--benchmark-threshold");
+    m_benchmark_threshold.set_description("set the running time increase in percents beyond which a unit benchmark is considered to regress (default: 5)");
+    m_benchmark_threshold.set_syntax("percents");
+    m_benchmark_threshold.set_exact_value_count(1);
+    parser().add_option_handler(&m_benchmark_threshold);
+
     m_verbose_unit_tests.add_name("--verbose-unit-tests");
     m_verbose_unit_tests.set_description("enable verbose mode while unit testing");
     parser().add_option_handler(&m_verbose_unit_tests);
@@ -93,6 +105,12 @@ CommandLineHandler::CommandLineHandler()
     m_rendering_threads.set_exact_value_count(1);
     parser().add_option_handler(&m_rendering_threads);
 
+    m_thread_affinity.add_name("--thread-affinity");
+    m_thread_affinity.set_description("bind rendering threads to cpu cores (none, compact or scatter)");
+    m_thread_affinity.set_syntax("policy");
+    m_thread_affinity.set_exact_value_count(1);
+    parser().add_option_handler(&m_thread_affinity);
+
     m_output.add_name("--output");
     m_output.add_name("-o");
     m_output.set_description("set the name of the output file");
@@ -126,6 +144,18 @@ CommandLineHandler::CommandLineHandler()
     m_override_shading.set_syntax("shader");
     m_override_shading.set_exact_value_count(1);
     parser().add_option_handler(&m_override_shading);
+
+    m_tree_cache.add_name("--tree-cache");
+    m_tree_cache.set_description("cache acceleration structures in the given directory across renders");
+    m_tree_cache.set_syntax("directory");
+    m_tree_cache.set_exact_value_count(1);
+    parser().add_option_handler(&m_tree_cache);
+
+    m_profile.add_name("--profile");
+    m_profile.set_description("profile rendering and write the results in the chrome trace event format");
+    m_profile.set_syntax("filename");
+    m_profile.set_exact_value_count(1);
+    parser().add_option_handler(&m_profile);
 }
 
 void CommandLineHandler::print_program_usage(
@@ -58,6 +58,8 @@ class CommandLineHandler
 #endif
     foundation::ValueOptionHandler<std::string>     m_run_unit_tests;
     foundation::ValueOptionHandler<std::string>     m_run_unit_benchmarks;
+    foundation::ValueOptionHandler<std::string>     m_benchmark_baseline;
+    foundation::ValueOptionHandler<double>          m_benchmark_threshold;
     foundation::FlagOptionHandler                   m_verbose_unit_tests;
 
     foundation::ValueOptionHandler<std::string>     m_configuration;
@@ -66,11 +68,14 @@ class CommandLineHandler
 
     // Aliases for rendering options.
     foundation::ValueOptionHandler<int>             m_rendering_threads;
+    foundation::ValueOptionHandler<std::string>     m_thread_affinity;
     foundation::ValueOptionHandler<std::string>     m_output;
     foundation::ValueOptionHandler<int>             m_resolution;
     foundation::ValueOptionHandler<int>             m_window;
     foundation::ValueOptionHandler<int>             m_samples;
     foundation::ValueOptionHandler<std::string>     m_override_shading;
+    foundation::ValueOptionHandler<std::string>     m_tree_cache;
+    foundation::ValueOptionHandler<std::string>     m_profile;
 
     // Constructor.
     CommandLineHandler();
@@ -46,6 +46,7 @@
 #include "foundation/utility/benchmark.h"
 #include "foundation/utility/filter.h"
 #include "foundation/utility/log.h"
+#include "foundation/utility/profiler.h"
 #include "foundation/utility/settings.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
@@ -171,7 +172,8 @@ namespace
         print_unit_test_result(logger, result);
     }
 
-    void run_unit_benchmarks(Logger& logger)
+    // Return false if some unit benchmarks regressed compared to the baseline.
+    bool run_unit_benchmarks(Logger& logger)
     {
         BenchmarkResult result;
 
@@ -197,6 +199,40 @@ namespace
                 xmlfile_path.native_file_string().c_str());
         }
 
+        // Optionally add a benchmark listener that compares results against a baseline.
+        BenchmarkBaseline baseline;
+        auto_release_ptr<RegressionBenchmarkListener> regression_listener;
+        if (g_cl.m_benchmark_baseline.is_set())
+        {
+            const string& baseline_path = g_cl.m_benchmark_baseline.values().front();
+
+            const bool loaded =
+                filesystem::is_directory(baseline_path)
+                    ? baseline.load_directory(baseline_path.c_str()) > 0
+                    : baseline.load_file(baseline_path.c_str());
+
+            if (loaded)
+            {
+                const double threshold =
+                    g_cl.m_benchmark_threshold.is_set()
+                        ? g_cl.m_benchmark_threshold.values().front() / 100.0
+                        : 0.05;
+
+                regression_listener.reset(
+                    create_regression_benchmark_listener(logger, baseline, threshold));
+                result.add_listener(regression_listener.get());
+            }
+            else
+            {
+                // Don't run the benchmarks: the run was meant to detect regressions.
+                LOG_ERROR(
+                    logger,
+                    "failed to load benchmark baseline from %s.",
+                    baseline_path.c_str());
+                return false;
+            }
+        }
+
         const filesystem::path old_current_path =
             Application::change_current_directory_to_tests_root_path();
 
@@ -225,6 +261,21 @@ namespace
 
         // Print results.
         print_unit_benchmark_result(logger, result);
+
+        if (regression_listener.get() == 0)
+            return true;
+
+        const size_t comparison_count = regression_listener->get_comparison_count();
+        const size_t regression_count = regression_listener->get_regression_count();
+
+        LOG_INFO(
+            logger,
+            "  regressions : %s out of %s compared %s\n",
+            pretty_uint(regression_count).c_str(),
+            pretty_uint(comparison_count).c_str(),
+            plural(comparison_count, "case").c_str());
+
+        return regression_count == 0;
     }
 
     void apply_command_line_options(ParamArray& params)
@@ -237,6 +288,17 @@ namespace
                 g_cl.m_rendering_threads.string_values()[0].c_str());
         }
 
+        // Apply thread affinity option.
+        if (g_cl.m_thread_affinity.is_set())
+        {
+            params.insert_path(
+                "generic_frame_renderer.thread_affinity",
+                g_cl.m_thread_affinity.values()[0].c_str());
+            params.insert_path(
+                "progressive_frame_renderer.thread_affinity",
+                g_cl.m_thread_affinity.values()[0].c_str());
+        }
+
         // Apply window option.
         if (g_cl.m_window.is_set())
         {
@@ -267,6 +329,14 @@ namespace
                 g_cl.m_override_shading.string_values()[0].c_str());
         }
 
+        // Apply acceleration structure cache option.
+        if (g_cl.m_tree_cache.is_set())
+        {
+            params.insert_path(
+                "tree_cache_path",
+                g_cl.m_tree_cache.string_values()[0].c_str());
+        }
+
         // Apply custom parameters.
         for (size_t i = 0; i < g_cl.m_params.values().size(); ++i)
         {
@@ -338,12 +408,29 @@ namespace
             params,
             &renderer_controller);
 
+        // Enable the profiler if requested.
+        if (g_cl.m_profile.is_set())
+            Profiler::instance().set_enabled(true);
+
         // Render the frame.
         Stopwatch<DefaultWallclockTimer> stopwatch;
         stopwatch.start();
         renderer.render();
         stopwatch.measure();
 
+        // Write the profiling results.
+        if (g_cl.m_profile.is_set())
+        {
+            Profiler::instance().set_enabled(false);
+
+            const string& profile_path = g_cl.m_profile.values().front();
+
+            if (Profiler::instance().write_chrome_trace(profile_path.c_str()))
+                RENDERER_LOG_INFO("wrote profiling results to %s.", profile_path.c_str());
+            else
+                RENDERER_LOG_ERROR("failed to write profiling results to %s.", profile_path.c_str());
+        }
+
         // Print rendering time.
         const double seconds = stopwatch.get_seconds();
         RENDERER_LOG_INFO(
@@ -470,8 +557,9 @@ int main(int argc, const char* argv[])
         run_unit_tests(logger);
 
     // Run unit benchmarks.
+    bool success = true;
     if (g_cl.m_run_unit_benchmarks.is_set())
-        run_unit_benchmarks(logger);
+        success = run_unit_benchmarks(logger);
 
     global_logger().add_target(&logger.get_log_target());
 
@@ -479,5 +567,5 @@ int main(int argc, const char* argv[])
     if (!g_cl.m_filenames.values().empty())
         render_project(g_cl.m_filenames.values().front());
 
-    return 0;
+    return success ? 0 : 1;
 }
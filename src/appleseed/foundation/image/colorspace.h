@@ -234,7 +234,7 @@ extern const Spectrum31f RGBCMFStilesBurch195910Def[3];     // Stiles and Burch
 class LightingConditions
 {
   public:
-    Color3f                     m_cmf[31];                  // precomputed values of (cmf[0], cmf[1], cmf[2]) * illuminant
+    Color4f                     m_cmf[31];                  // precomputed values of (cmf[0], cmf[1], cmf[2], 0) * illuminant
 
     LightingConditions(
         const Spectrum31f&      illuminant,                 // illuminant
@@ -259,15 +259,32 @@ void ciexyz_to_spectrum(
     const Color<T, 3>&          xyz,
     Spectrum&                   spectrum);
 
+// Return the luminance of a spectrum, i.e. the Y component of its CIE XYZ representation.
+template <typename T, typename Spectrum>
+T spectrum_to_luminance(
+    const LightingConditions&   lighting,
+    const Spectrum&             spectrum);
 
+
+//
+// Spectrum <-> linear RGB transformations.
 //
-// Linear RGB to spectrum transformation.
+// The generic spectrum to linear RGB transformation first converts the
+// spectrum to the CIE XYZ color space, then converts the resulting CIE XYZ
+// color to the linear RGB color space.
 //
-// The spectrum to linear RGB transformation can be obtained by first
-// converting the spectrum to the CIE XYZ color space, then converting
-// the resulting CIE XYZ color to the linear RGB color space.
+// Spectra with 3 samples are interpreted as linear RGB triplets: the
+// transformations below reduce to copies for such spectra, and the lighting
+// conditions are ignored. This is what allows the renderer to be built in
+// RGB mode (see renderer/global/globaltypes.h).
 //
 
+// Convert a spectrum to a color in the linear RGB color space.
+template <typename T, typename Spectrum>
+Color<T, 3> spectrum_to_linear_rgb(
+    const LightingConditions&   lighting,
+    const Spectrum&             spectrum);
+
 // Convert a color in the linear RGB color space to a spectrum.
 template <typename T, typename Spectrum>
 void linear_rgb_to_spectrum(
@@ -635,26 +652,120 @@ Color<T, 3> spectrum_to_ciexyz(
     return Color<T, 3>(x, y, z);
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+inline Color3f spectrum_to_ciexyz<float, Spectrum31f>(
+    const LightingConditions&   lighting,
+    const Spectrum31f&          spectrum)
+{
+    // Accumulate (x, y, z, 0) in four independent sums to hide the latency of additions.
+    sse4f acc0 = set1ps(0.0f);
+    sse4f acc1 = set1ps(0.0f);
+    sse4f acc2 = set1ps(0.0f);
+    sse4f acc3 = set1ps(0.0f);
+
+    size_t w = 0;
+
+    for (; w < 28; w += 4)
+    {
+        acc0 = addps(acc0, mulps(loadups(&lighting.m_cmf[w + 0][0]), set1ps(spectrum[w + 0])));
+        acc1 = addps(acc1, mulps(loadups(&lighting.m_cmf[w + 1][0]), set1ps(spectrum[w + 1])));
+        acc2 = addps(acc2, mulps(loadups(&lighting.m_cmf[w + 2][0]), set1ps(spectrum[w + 2])));
+        acc3 = addps(acc3, mulps(loadups(&lighting.m_cmf[w + 3][0]), set1ps(spectrum[w + 3])));
+    }
+
+    acc0 = addps(acc0, mulps(loadups(&lighting.m_cmf[w + 0][0]), set1ps(spectrum[w + 0])));
+    acc1 = addps(acc1, mulps(loadups(&lighting.m_cmf[w + 1][0]), set1ps(spectrum[w + 1])));
+    acc2 = addps(acc2, mulps(loadups(&lighting.m_cmf[w + 2][0]), set1ps(spectrum[w + 2])));
+
+    ALIGN_SSE_VARIABLE float xyz[4];
+    storeps(xyz, addps(addps(acc0, acc1), addps(acc2, acc3)));
+
+    return Color3f(xyz[0], xyz[1], xyz[2]);
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
+template <typename T, typename U>
+inline Color<T, 3> spectrum_to_ciexyz(
+    const LightingConditions&   lighting,
+    const RegularSpectrum<U, 3>& spectrum)
+{
+    return
+        linear_rgb_to_ciexyz(
+            Color<T, 3>(
+                static_cast<T>(spectrum[0]),
+                static_cast<T>(spectrum[1]),
+                static_cast<T>(spectrum[2])));
+}
+
 template <typename T, typename Spectrum>
 void ciexyz_to_spectrum(
     const LightingConditions&   lighting,
     const Color<T, 3>&          xyz,
     Spectrum&                   spectrum)
 {
-    // todo: fix to handle arbitrary number of samples.
-    assert(Spectrum::Samples == 31);
-
     linear_rgb_to_spectrum(
         lighting,
         ciexyz_to_linear_rgb(xyz),
         spectrum);
 }
 
+template <typename T, typename Spectrum>
+T spectrum_to_luminance(
+    const LightingConditions&   lighting,
+    const Spectrum&             spectrum)
+{
+    // todo: fix to handle arbitrary numbers of samples.
+    assert(Spectrum::Samples == 31);
+
+    T y = T(0.0);
+
+    for (size_t w = 0; w < 31; ++w)
+        y += lighting.m_cmf[w][1] * spectrum[w];
+
+    return y;
+}
+
+template <typename T, typename U>
+inline T spectrum_to_luminance(
+    const LightingConditions&   lighting,
+    const RegularSpectrum<U, 3>& spectrum)
+{
+    return
+        luminance(
+            Color<T, 3>(
+                static_cast<T>(spectrum[0]),
+                static_cast<T>(spectrum[1]),
+                static_cast<T>(spectrum[2])));
+}
+
 
 //
-// Linear RGB to spectrum transformation implementation.
+// Spectrum <-> linear RGB transformations implementation.
 //
 
+template <typename T, typename Spectrum>
+inline Color<T, 3> spectrum_to_linear_rgb(
+    const LightingConditions&   lighting,
+    const Spectrum&             spectrum)
+{
+    return ciexyz_to_linear_rgb(spectrum_to_ciexyz<T>(lighting, spectrum));
+}
+
+template <typename T, typename U>
+inline Color<T, 3> spectrum_to_linear_rgb(
+    const LightingConditions&   lighting,
+    const RegularSpectrum<U, 3>& spectrum)
+{
+    return
+        Color<T, 3>(
+            static_cast<T>(spectrum[0]),
+            static_cast<T>(spectrum[1]),
+            static_cast<T>(spectrum[2]));
+}
+
 template <typename T, typename Spectrum>
 void linear_rgb_to_spectrum(
     const LightingConditions&   lighting,
@@ -675,6 +786,17 @@ void linear_rgb_to_spectrum(
         spectrum[w] = static_cast<ValueType>(linear_rgb[0]);
 }
 
+template <typename T, typename U>
+inline void linear_rgb_to_spectrum(
+    const LightingConditions&   lighting,
+    const Color<T, 3>&          linear_rgb,
+    RegularSpectrum<U, 3>&      spectrum)
+{
+    spectrum[0] = static_cast<U>(linear_rgb[0]);
+    spectrum[1] = static_cast<U>(linear_rgb[1]);
+    spectrum[2] = static_cast<U>(linear_rgb[2]);
+}
+
 
 //
 // Spectrum <-> Spectrum transformation implementation.
@@ -0,0 +1,380 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "concurrentimagefilereader.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/thread.h"
+
+// boost headers.
+#include "boost/thread/condition_variable.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <list>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// ConcurrentImageFileReader class implementation.
+//
+
+struct ConcurrentImageFileReader::Impl
+{
+    typedef GenericProgressiveImageFileReader Reader;
+
+    struct IdleReader
+    {
+        Impl*                   m_owner;
+        Reader*                 m_reader;
+    };
+
+    typedef list<IdleReader> IdleReaderList;
+
+    // State shared by all concurrent image file readers. Idle readers are kept in
+    // least recently used order, most recently used first, so that the readers
+    // closed to stay within the global limit are the ones idle for the longest time.
+    static boost::mutex                 s_mutex;
+    static boost::condition_variable    s_reader_returned;
+    static IdleReaderList               s_idle_readers;
+    static size_t                       s_reader_count;         // number of open readers, idle or not
+    static size_t                       s_max_reader_count;
+
+    Logger*                             m_logger;
+    size_t                              m_max_reader_count;
+    string                              m_filename;
+    CanvasProperties                    m_props;
+    bool                                m_is_open;
+
+    // The following members are protected by s_mutex.
+    vector<IdleReaderList::iterator>    m_idle_readers;         // most recently used last
+    size_t                              m_reader_count;         // number of open readers, idle or not
+
+    Reader* open_reader() const
+    {
+        Reader* reader = new Reader(m_logger);
+
+        try
+        {
+            reader->open(m_filename.c_str());
+        }
+        catch (...)
+        {
+            delete reader;
+            throw;
+        }
+
+        return reader;
+    }
+
+    // Make a reader idle. The lock must be held.
+    void push_idle_reader(Reader* reader)
+    {
+        IdleReader idle_reader;
+        idle_reader.m_owner = this;
+        idle_reader.m_reader = reader;
+
+        s_idle_readers.push_front(idle_reader);
+        m_idle_readers.push_back(s_idle_readers.begin());
+    }
+
+    // Remove the least recently used idle reader of any concurrent image file reader,
+    // and return it so that it can be closed once the lock is released. The lock must
+    // be held and at least one reader must be idle.
+    static Reader* pop_least_recently_used_reader()
+    {
+        assert(!s_idle_readers.empty());
+
+        const IdleReaderList::iterator it = --s_idle_readers.end();
+        Impl* owner = it->m_owner;
+        Reader* reader = it->m_reader;
+
+        owner->m_idle_readers.erase(
+            find(owner->m_idle_readers.begin(), owner->m_idle_readers.end(), it));
+        --owner->m_reader_count;
+
+        s_idle_readers.erase(it);
+        --s_reader_count;
+
+        return reader;
+    }
+
+    // Remove idle readers until the number of open readers is within the global limit.
+    // The lock must be held.
+    static void trim_idle_readers(vector<Reader*>& closed_readers)
+    {
+        while (s_reader_count > s_max_reader_count && !s_idle_readers.empty())
+            closed_readers.push_back(pop_least_recently_used_reader());
+    }
+
+    static void delete_readers(const vector<Reader*>& readers)
+    {
+        for (size_t i = 0; i < readers.size(); ++i)
+            delete readers[i];
+    }
+
+    Reader* acquire_reader()
+    {
+        boost::mutex::scoped_lock lock(s_mutex);
+
+        while (m_idle_readers.empty())
+        {
+            // A reader with no open reader may always open one, otherwise it could wait forever.
+            const bool can_open =
+                m_reader_count == 0 ||
+                (m_reader_count < m_max_reader_count &&
+                 (s_reader_count < s_max_reader_count || !s_idle_readers.empty()));
+
+            if (can_open)
+            {
+                // Make room for the new reader by closing the least recently used idle reader.
+                Reader* closed_reader =
+                    s_reader_count >= s_max_reader_count && !s_idle_readers.empty()
+                        ? pop_least_recently_used_reader()
+                        : 0;
+
+                // Open a new reader without holding the lock.
+                ++m_reader_count;
+                ++s_reader_count;
+                lock.unlock();
+
+                delete closed_reader;
+
+                try
+                {
+                    return open_reader();
+                }
+                catch (...)
+                {
+                    lock.lock();
+                    --m_reader_count;
+                    --s_reader_count;
+                    s_reader_returned.notify_all();
+                    throw;
+                }
+            }
+
+            s_reader_returned.wait(lock);
+        }
+
+        const IdleReaderList::iterator it = m_idle_readers.back();
+        m_idle_readers.pop_back();
+
+        Reader* reader = it->m_reader;
+        s_idle_readers.erase(it);
+
+        return reader;
+    }
+
+    void release_reader(Reader* reader)
+    {
+        vector<Reader*> closed_readers;
+
+        {
+            boost::mutex::scoped_lock lock(s_mutex);
+            push_idle_reader(reader);
+            trim_idle_readers(closed_readers);
+            s_reader_returned.notify_all();
+        }
+
+        delete_readers(closed_readers);
+    }
+};
+
+boost::mutex ConcurrentImageFileReader::Impl::s_mutex;
+boost::condition_variable ConcurrentImageFileReader::Impl::s_reader_returned;
+ConcurrentImageFileReader::Impl::IdleReaderList ConcurrentImageFileReader::Impl::s_idle_readers;
+size_t ConcurrentImageFileReader::Impl::s_reader_count = 0;
+size_t ConcurrentImageFileReader::Impl::s_max_reader_count =
+    4 * max<size_t>(System::get_logical_cpu_core_count(), 1);
+
+ConcurrentImageFileReader::ConcurrentImageFileReader(
+    Logger*             logger,
+    const size_t        max_reader_count)
+  : impl(new Impl())
+{
+    impl->m_logger = logger;
+    impl->m_max_reader_count =
+        max_reader_count > 0
+            ? max_reader_count
+            : max<size_t>(System::get_logical_cpu_core_count(), 1);
+    impl->m_is_open = false;
+    impl->m_reader_count = 0;
+}
+
+ConcurrentImageFileReader::~ConcurrentImageFileReader()
+{
+    if (is_open())
+        close();
+
+    delete impl;
+}
+
+void ConcurrentImageFileReader::open(const char* filename)
+{
+    assert(filename);
+    assert(!is_open());
+
+    impl->m_filename = filename;
+
+    // Open the first reader right away to report errors early and to read the canvas properties.
+    Impl::Reader* reader = impl->open_reader();
+
+    try
+    {
+        reader->read_canvas_properties(impl->m_props);
+    }
+    catch (...)
+    {
+        delete reader;
+        throw;
+    }
+
+    vector<Impl::Reader*> closed_readers;
+
+    {
+        boost::mutex::scoped_lock lock(Impl::s_mutex);
+        impl->push_idle_reader(reader);
+        impl->m_reader_count = 1;
+        impl->m_is_open = true;
+        ++Impl::s_reader_count;
+        Impl::trim_idle_readers(closed_readers);
+    }
+
+    Impl::delete_readers(closed_readers);
+}
+
+void ConcurrentImageFileReader::close()
+{
+    assert(is_open());
+
+    vector<Impl::Reader*> closed_readers;
+
+    {
+        boost::mutex::scoped_lock lock(Impl::s_mutex);
+
+        assert(impl->m_idle_readers.size() == impl->m_reader_count);
+
+        for (size_t i = 0; i < impl->m_idle_readers.size(); ++i)
+        {
+            closed_readers.push_back(impl->m_idle_readers[i]->m_reader);
+            Impl::s_idle_readers.erase(impl->m_idle_readers[i]);
+        }
+
+        Impl::s_reader_count -= impl->m_reader_count;
+        impl->m_idle_readers.clear();
+        impl->m_reader_count = 0;
+        impl->m_is_open = false;
+
+        Impl::s_reader_returned.notify_all();
+    }
+
+    Impl::delete_readers(closed_readers);
+}
+
+bool ConcurrentImageFileReader::is_open() const
+{
+    boost::mutex::scoped_lock lock(Impl::s_mutex);
+    return impl->m_is_open;
+}
+
+const CanvasProperties& ConcurrentImageFileReader::get_canvas_properties() const
+{
+    assert(is_open());
+    return impl->m_props;
+}
+
+Tile* ConcurrentImageFileReader::read_tile(
+    const size_t        tile_x,
+    const size_t        tile_y)
+{
+    assert(is_open());
+
+    Impl::Reader* reader = impl->acquire_reader();
+
+    Tile* tile;
+
+    try
+    {
+        tile = reader->read_tile(tile_x, tile_y);
+    }
+    catch (...)
+    {
+        impl->release_reader(reader);
+        throw;
+    }
+
+    impl->release_reader(reader);
+
+    return tile;
+}
+
+size_t ConcurrentImageFileReader::get_reader_count() const
+{
+    boost::mutex::scoped_lock lock(Impl::s_mutex);
+    return impl->m_reader_count;
+}
+
+void ConcurrentImageFileReader::set_global_max_reader_count(const size_t max_reader_count)
+{
+    assert(max_reader_count > 0);
+
+    vector<Impl::Reader*> closed_readers;
+
+    {
+        boost::mutex::scoped_lock lock(Impl::s_mutex);
+        Impl::s_max_reader_count = max_reader_count;
+        Impl::trim_idle_readers(closed_readers);
+    }
+
+    Impl::delete_readers(closed_readers);
+}
+
+size_t ConcurrentImageFileReader::get_global_max_reader_count()
+{
+    boost::mutex::scoped_lock lock(Impl::s_mutex);
+    return Impl::s_max_reader_count;
+}
+
+size_t ConcurrentImageFileReader::get_global_reader_count()
+{
+    boost::mutex::scoped_lock lock(Impl::s_mutex);
+    return Impl::s_reader_count;
+}
+
+}   // namespace foundation
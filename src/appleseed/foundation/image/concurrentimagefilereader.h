@@ -0,0 +1,126 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_IMAGE_CONCURRENTIMAGEFILEREADER_H
+#define APPLESEED_FOUNDATION_IMAGE_CONCURRENTIMAGEFILEREADER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class CanvasProperties; }
+namespace foundation    { class Logger; }
+namespace foundation    { class Tile; }
+
+//
+// On Windows, define FOUNDATIONDLL to __declspec(dllexport) when building the DLL
+// and to __declspec(dllimport) when building an application using the DLL.
+// Other platforms don't use this export mechanism and the symbol FOUNDATIONDLL is
+// defined to evaluate to nothing.
+//
+
+#ifndef FOUNDATIONDLL
+#ifdef _WIN32
+#ifdef APPLESEED_FOUNDATION_EXPORTS
+#define FOUNDATIONDLL __declspec(dllexport)
+#else
+#define FOUNDATIONDLL __declspec(dllimport)
+#endif
+#else
+#define FOUNDATIONDLL
+#endif
+#endif
+
+namespace foundation
+{
+
+//
+// An image file reader that allows multiple threads to read tiles at the same time.
+//
+// The reader keeps a pool of progressive readers open on the same file. A thread
+// reading a tile borrows an idle reader, or opens a new one if fewer than the
+// maximum number of readers are open, or waits for a reader to be returned.
+// Tiles are therefore read and decompressed concurrently.
+//
+// The total number of readers open across all concurrent image file readers is
+// also limited: when the limit is reached, idle readers are closed in least
+// recently used order. Every concurrent image file reader can always open at
+// least one reader, so the limit may be exceeded temporarily.
+//
+
+class FOUNDATIONDLL ConcurrentImageFileReader
+  : public NonCopyable
+{
+  public:
+    // Constructor. A maximum reader count of 0 means one reader per logical CPU core.
+    explicit ConcurrentImageFileReader(
+        Logger*             logger = 0,
+        const size_t        max_reader_count = 0);
+
+    // Destructor.
+    ~ConcurrentImageFileReader();
+
+    // Open an image file. Not thread-safe.
+    void open(const char* filename);
+
+    // Close the image file. Not thread-safe.
+    void close();
+
+    // Return true if an image file is currently open.
+    bool is_open() const;
+
+    // Return the canvas properties of the image file.
+    const CanvasProperties& get_canvas_properties() const;
+
+    // Read an image tile. Returns a newly allocated tile. Thread-safe.
+    Tile* read_tile(
+        const size_t        tile_x,
+        const size_t        tile_y);
+
+    // Return the number of readers currently open on the image file.
+    size_t get_reader_count() const;
+
+    // Set or get the maximum number of readers open across all concurrent image
+    // file readers. The default is four readers per logical CPU core.
+    static void set_global_max_reader_count(const size_t max_reader_count);
+    static size_t get_global_max_reader_count();
+
+    // Return the number of readers currently open across all concurrent image file readers.
+    static size_t get_global_reader_count();
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_IMAGE_CONCURRENTIMAGEFILEREADER_H
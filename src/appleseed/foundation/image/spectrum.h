@@ -59,6 +59,8 @@ class RegularSpectrum
 
 #ifdef APPLESEED_FOUNDATION_USE_SSE
     // Number of stored samples such that the size of the sample array is a multiple of 16 bytes.
+    // The padding samples have unspecified values: operations that combine samples together
+    // (comparisons, reductions) must ignore them.
     static const size_t StoredSamples = (((N * sizeof(T)) + 15) & ~15) / sizeof(T);
 #else
     static const size_t StoredSamples = N;
@@ -113,6 +115,10 @@ template <typename T, size_t N> RegularSpectrum<T, N>& operator*=(RegularSpectru
 template <typename T, size_t N> RegularSpectrum<T, N>& operator/=(RegularSpectrum<T, N>& lhs, const T rhs);
 template <typename T, size_t N> RegularSpectrum<T, N>& operator/=(RegularSpectrum<T, N>& lhs, const RegularSpectrum<T, N>& rhs);
 
+// Multiply-add: lhs += a * b.
+template <typename T, size_t N> void madd(RegularSpectrum<T, N>& lhs, const RegularSpectrum<T, N>& a, const RegularSpectrum<T, N>& b);
+template <typename T, size_t N> void madd(RegularSpectrum<T, N>& lhs, const RegularSpectrum<T, N>& a, const T b);
+
 // Return whether all components of a spectrum are in [0,1].
 template <typename T, size_t N> bool is_saturated(const RegularSpectrum<T, N>& s);
 
@@ -286,6 +292,36 @@ inline bool fz(const RegularSpectrum<T, N>& s, const T eps)
     return true;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE bool fz(const RegularSpectrum<float, 31>& s, const float eps)
+{
+    const sse4f mabs = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const sse4f meps = set1ps(eps);
+
+    // Lane 3 of the last packet holds the padding sample and is forced to pass the test.
+    const int mask =
+        movemaskps(cmpltps(andps(loadps(&s[ 0]), mabs), meps)) &
+        movemaskps(cmpltps(andps(loadps(&s[ 4]), mabs), meps)) &
+        movemaskps(cmpltps(andps(loadps(&s[ 8]), mabs), meps)) &
+        movemaskps(cmpltps(andps(loadps(&s[12]), mabs), meps)) &
+        movemaskps(cmpltps(andps(loadps(&s[16]), mabs), meps)) &
+        movemaskps(cmpltps(andps(loadps(&s[20]), mabs), meps)) &
+        movemaskps(cmpltps(andps(loadps(&s[24]), mabs), meps)) &
+        (movemaskps(cmpltps(andps(loadps(&s[28]), mabs), meps)) | 0x8);
+
+    return mask == 0xF;
+}
+
+template <>
+FORCE_INLINE bool fz(const RegularSpectrum<float, 31>& s)
+{
+    return fz(s, default_eps<float>());
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N> operator+(const RegularSpectrum<T, N>& lhs, const RegularSpectrum<T, N>& rhs)
 {
@@ -297,6 +333,27 @@ inline RegularSpectrum<T, N> operator+(const RegularSpectrum<T, N>& lhs, const R
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31> operator+(const RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
+{
+    RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], addps(loadps(&lhs[ 0]), loadps(&rhs[ 0])));
+    storeps(&result[ 4], addps(loadps(&lhs[ 4]), loadps(&rhs[ 4])));
+    storeps(&result[ 8], addps(loadps(&lhs[ 8]), loadps(&rhs[ 8])));
+    storeps(&result[12], addps(loadps(&lhs[12]), loadps(&rhs[12])));
+    storeps(&result[16], addps(loadps(&lhs[16]), loadps(&rhs[16])));
+    storeps(&result[20], addps(loadps(&lhs[20]), loadps(&rhs[20])));
+    storeps(&result[24], addps(loadps(&lhs[24]), loadps(&rhs[24])));
+    storeps(&result[28], addps(loadps(&lhs[28]), loadps(&rhs[28])));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N> operator-(const RegularSpectrum<T, N>& lhs, const RegularSpectrum<T, N>& rhs)
 {
@@ -308,6 +365,27 @@ inline RegularSpectrum<T, N> operator-(const RegularSpectrum<T, N>& lhs, const R
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31> operator-(const RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
+{
+    RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], subps(loadps(&lhs[ 0]), loadps(&rhs[ 0])));
+    storeps(&result[ 4], subps(loadps(&lhs[ 4]), loadps(&rhs[ 4])));
+    storeps(&result[ 8], subps(loadps(&lhs[ 8]), loadps(&rhs[ 8])));
+    storeps(&result[12], subps(loadps(&lhs[12]), loadps(&rhs[12])));
+    storeps(&result[16], subps(loadps(&lhs[16]), loadps(&rhs[16])));
+    storeps(&result[20], subps(loadps(&lhs[20]), loadps(&rhs[20])));
+    storeps(&result[24], subps(loadps(&lhs[24]), loadps(&rhs[24])));
+    storeps(&result[28], subps(loadps(&lhs[28]), loadps(&rhs[28])));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N> operator-(const RegularSpectrum<T, N>& lhs)
 {
@@ -319,6 +397,29 @@ inline RegularSpectrum<T, N> operator-(const RegularSpectrum<T, N>& lhs)
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31> operator-(const RegularSpectrum<float, 31>& lhs)
+{
+    const sse4f msign = set1ps(-0.0f);
+
+    RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], xorps(loadps(&lhs[ 0]), msign));
+    storeps(&result[ 4], xorps(loadps(&lhs[ 4]), msign));
+    storeps(&result[ 8], xorps(loadps(&lhs[ 8]), msign));
+    storeps(&result[12], xorps(loadps(&lhs[12]), msign));
+    storeps(&result[16], xorps(loadps(&lhs[16]), msign));
+    storeps(&result[20], xorps(loadps(&lhs[20]), msign));
+    storeps(&result[24], xorps(loadps(&lhs[24]), msign));
+    storeps(&result[28], xorps(loadps(&lhs[28]), msign));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N> operator*(const RegularSpectrum<T, N>& lhs, const T rhs)
 {
@@ -330,6 +431,29 @@ inline RegularSpectrum<T, N> operator*(const RegularSpectrum<T, N>& lhs, const T
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31> operator*(const RegularSpectrum<float, 31>& lhs, const float rhs)
+{
+    const sse4f mrhs = set1ps(rhs);
+
+    RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], mulps(loadps(&lhs[ 0]), mrhs));
+    storeps(&result[ 4], mulps(loadps(&lhs[ 4]), mrhs));
+    storeps(&result[ 8], mulps(loadps(&lhs[ 8]), mrhs));
+    storeps(&result[12], mulps(loadps(&lhs[12]), mrhs));
+    storeps(&result[16], mulps(loadps(&lhs[16]), mrhs));
+    storeps(&result[20], mulps(loadps(&lhs[20]), mrhs));
+    storeps(&result[24], mulps(loadps(&lhs[24]), mrhs));
+    storeps(&result[28], mulps(loadps(&lhs[28]), mrhs));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N> operator*(const T lhs, const RegularSpectrum<T, N>& rhs)
 {
@@ -347,6 +471,27 @@ inline RegularSpectrum<T, N> operator*(const RegularSpectrum<T, N>& lhs, const R
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31> operator*(const RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
+{
+    RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], mulps(loadps(&lhs[ 0]), loadps(&rhs[ 0])));
+    storeps(&result[ 4], mulps(loadps(&lhs[ 4]), loadps(&rhs[ 4])));
+    storeps(&result[ 8], mulps(loadps(&lhs[ 8]), loadps(&rhs[ 8])));
+    storeps(&result[12], mulps(loadps(&lhs[12]), loadps(&rhs[12])));
+    storeps(&result[16], mulps(loadps(&lhs[16]), loadps(&rhs[16])));
+    storeps(&result[20], mulps(loadps(&lhs[20]), loadps(&rhs[20])));
+    storeps(&result[24], mulps(loadps(&lhs[24]), loadps(&rhs[24])));
+    storeps(&result[28], mulps(loadps(&lhs[28]), loadps(&rhs[28])));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N> operator/(const RegularSpectrum<T, N>& lhs, const T rhs)
 {
@@ -387,6 +532,27 @@ inline RegularSpectrum<T, N> operator/(const RegularSpectrum<T, N>& lhs, const R
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31> operator/(const RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
+{
+    RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], divps(loadps(&lhs[ 0]), loadps(&rhs[ 0])));
+    storeps(&result[ 4], divps(loadps(&lhs[ 4]), loadps(&rhs[ 4])));
+    storeps(&result[ 8], divps(loadps(&lhs[ 8]), loadps(&rhs[ 8])));
+    storeps(&result[12], divps(loadps(&lhs[12]), loadps(&rhs[12])));
+    storeps(&result[16], divps(loadps(&lhs[16]), loadps(&rhs[16])));
+    storeps(&result[20], divps(loadps(&lhs[20]), loadps(&rhs[20])));
+    storeps(&result[24], divps(loadps(&lhs[24]), loadps(&rhs[24])));
+    storeps(&result[28], divps(loadps(&lhs[28]), loadps(&rhs[28])));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N>& operator+=(RegularSpectrum<T, N>& lhs, const RegularSpectrum<T, N>& rhs)
 {
@@ -424,6 +590,25 @@ inline RegularSpectrum<T, N>& operator-=(RegularSpectrum<T, N>& lhs, const Regul
     return lhs;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31>& operator-=(RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
+{
+    storeps(&lhs[ 0], subps(loadps(&lhs[ 0]), loadps(&rhs[ 0])));
+    storeps(&lhs[ 4], subps(loadps(&lhs[ 4]), loadps(&rhs[ 4])));
+    storeps(&lhs[ 8], subps(loadps(&lhs[ 8]), loadps(&rhs[ 8])));
+    storeps(&lhs[12], subps(loadps(&lhs[12]), loadps(&rhs[12])));
+    storeps(&lhs[16], subps(loadps(&lhs[16]), loadps(&rhs[16])));
+    storeps(&lhs[20], subps(loadps(&lhs[20]), loadps(&rhs[20])));
+    storeps(&lhs[24], subps(loadps(&lhs[24]), loadps(&rhs[24])));
+    storeps(&lhs[28], subps(loadps(&lhs[28]), loadps(&rhs[28])));
+
+    return lhs;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline RegularSpectrum<T, N>& operator*=(RegularSpectrum<T, N>& lhs, const T rhs)
 {
@@ -492,19 +677,19 @@ inline RegularSpectrum<T, N>& operator/=(RegularSpectrum<T, N>& lhs, const T rhs
 }
 
 template <size_t N>
-inline RegularSpectrum<float, N>& operator/(RegularSpectrum<float, N>& lhs, const float rhs)
+inline RegularSpectrum<float, N>& operator/=(RegularSpectrum<float, N>& lhs, const float rhs)
 {
     return lhs *= 1.0f / rhs;
 }
 
 template <size_t N>
-inline RegularSpectrum<double, N>& operator/(RegularSpectrum<double, N>& lhs, const double rhs)
+inline RegularSpectrum<double, N>& operator/=(RegularSpectrum<double, N>& lhs, const double rhs)
 {
     return lhs *= 1.0 / rhs;
 }
 
 template <size_t N>
-inline RegularSpectrum<long double, N>& operator/(RegularSpectrum<long double, N>& lhs, const long double rhs)
+inline RegularSpectrum<long double, N>& operator/=(RegularSpectrum<long double, N>& lhs, const long double rhs)
 {
     return lhs *= 1.0L / rhs;
 }
@@ -518,6 +703,75 @@ inline RegularSpectrum<T, N>& operator/=(RegularSpectrum<T, N>& lhs, const Regul
     return lhs;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31>& operator/=(RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
+{
+    storeps(&lhs[ 0], divps(loadps(&lhs[ 0]), loadps(&rhs[ 0])));
+    storeps(&lhs[ 4], divps(loadps(&lhs[ 4]), loadps(&rhs[ 4])));
+    storeps(&lhs[ 8], divps(loadps(&lhs[ 8]), loadps(&rhs[ 8])));
+    storeps(&lhs[12], divps(loadps(&lhs[12]), loadps(&rhs[12])));
+    storeps(&lhs[16], divps(loadps(&lhs[16]), loadps(&rhs[16])));
+    storeps(&lhs[20], divps(loadps(&lhs[20]), loadps(&rhs[20])));
+    storeps(&lhs[24], divps(loadps(&lhs[24]), loadps(&rhs[24])));
+    storeps(&lhs[28], divps(loadps(&lhs[28]), loadps(&rhs[28])));
+
+    return lhs;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
+template <typename T, size_t N>
+inline void madd(RegularSpectrum<T, N>& lhs, const RegularSpectrum<T, N>& a, const RegularSpectrum<T, N>& b)
+{
+    for (size_t i = 0; i < N; ++i)
+        lhs[i] += a[i] * b[i];
+}
+
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE void madd(RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& a, const RegularSpectrum<float, 31>& b)
+{
+    storeps(&lhs[ 0], addps(loadps(&lhs[ 0]), mulps(loadps(&a[ 0]), loadps(&b[ 0]))));
+    storeps(&lhs[ 4], addps(loadps(&lhs[ 4]), mulps(loadps(&a[ 4]), loadps(&b[ 4]))));
+    storeps(&lhs[ 8], addps(loadps(&lhs[ 8]), mulps(loadps(&a[ 8]), loadps(&b[ 8]))));
+    storeps(&lhs[12], addps(loadps(&lhs[12]), mulps(loadps(&a[12]), loadps(&b[12]))));
+    storeps(&lhs[16], addps(loadps(&lhs[16]), mulps(loadps(&a[16]), loadps(&b[16]))));
+    storeps(&lhs[20], addps(loadps(&lhs[20]), mulps(loadps(&a[20]), loadps(&b[20]))));
+    storeps(&lhs[24], addps(loadps(&lhs[24]), mulps(loadps(&a[24]), loadps(&b[24]))));
+    storeps(&lhs[28], addps(loadps(&lhs[28]), mulps(loadps(&a[28]), loadps(&b[28]))));
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
+template <typename T, size_t N>
+inline void madd(RegularSpectrum<T, N>& lhs, const RegularSpectrum<T, N>& a, const T b)
+{
+    for (size_t i = 0; i < N; ++i)
+        lhs[i] += a[i] * b;
+}
+
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE void madd(RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& a, const float b)
+{
+    const sse4f mb = set1ps(b);
+
+    storeps(&lhs[ 0], addps(loadps(&lhs[ 0]), mulps(loadps(&a[ 0]), mb)));
+    storeps(&lhs[ 4], addps(loadps(&lhs[ 4]), mulps(loadps(&a[ 4]), mb)));
+    storeps(&lhs[ 8], addps(loadps(&lhs[ 8]), mulps(loadps(&a[ 8]), mb)));
+    storeps(&lhs[12], addps(loadps(&lhs[12]), mulps(loadps(&a[12]), mb)));
+    storeps(&lhs[16], addps(loadps(&lhs[16]), mulps(loadps(&a[16]), mb)));
+    storeps(&lhs[20], addps(loadps(&lhs[20]), mulps(loadps(&a[20]), mb)));
+    storeps(&lhs[24], addps(loadps(&lhs[24]), mulps(loadps(&a[24]), mb)));
+    storeps(&lhs[28], addps(loadps(&lhs[28]), mulps(loadps(&a[28]), mb)));
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline bool is_saturated(const RegularSpectrum<T, N>& s)
 {
@@ -541,6 +795,30 @@ inline RegularSpectrum<T, N> saturate(const RegularSpectrum<T, N>& s)
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE RegularSpectrum<float, 31> saturate(const RegularSpectrum<float, 31>& s)
+{
+    const sse4f mzero = set1ps(0.0f);
+    const sse4f mone = set1ps(1.0f);
+
+    RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], minps(maxps(loadps(&s[ 0]), mzero), mone));
+    storeps(&result[ 4], minps(maxps(loadps(&s[ 4]), mzero), mone));
+    storeps(&result[ 8], minps(maxps(loadps(&s[ 8]), mzero), mone));
+    storeps(&result[12], minps(maxps(loadps(&s[12]), mzero), mone));
+    storeps(&result[16], minps(maxps(loadps(&s[16]), mzero), mone));
+    storeps(&result[20], minps(maxps(loadps(&s[20]), mzero), mone));
+    storeps(&result[24], minps(maxps(loadps(&s[24]), mzero), mone));
+    storeps(&result[28], minps(maxps(loadps(&s[28]), mzero), mone));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline T min_value(const RegularSpectrum<T, N>& s)
 {
@@ -555,6 +833,34 @@ inline T min_value(const RegularSpectrum<T, N>& s)
     return value;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE float min_value(const RegularSpectrum<float, 31>& s)
+{
+    // Replace the padding sample by a copy of the last sample.
+    const sse4f last = loadps(&s[28]);
+
+    sse4f m = minps(loadps(&s[0]), loadps(&s[4]));
+    m = minps(m, loadps(&s[ 8]));
+    m = minps(m, loadps(&s[12]));
+    m = minps(m, loadps(&s[16]));
+    m = minps(m, loadps(&s[20]));
+    m = minps(m, loadps(&s[24]));
+    m = minps(m, shuffleps(last, last, _MM_SHUFFLE(2, 2, 1, 0)));
+
+    // Horizontal reduction.
+    m = minps(m, shuffleps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = minps(m, shuffleps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    float value;
+    storess(&value, m);
+
+    return value;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline T max_value(const RegularSpectrum<T, N>& s)
 {
@@ -569,6 +875,34 @@ inline T max_value(const RegularSpectrum<T, N>& s)
     return value;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE float max_value(const RegularSpectrum<float, 31>& s)
+{
+    // Replace the padding sample by a copy of the last sample.
+    const sse4f last = loadps(&s[28]);
+
+    sse4f m = maxps(loadps(&s[0]), loadps(&s[4]));
+    m = maxps(m, loadps(&s[ 8]));
+    m = maxps(m, loadps(&s[12]));
+    m = maxps(m, loadps(&s[16]));
+    m = maxps(m, loadps(&s[20]));
+    m = maxps(m, loadps(&s[24]));
+    m = maxps(m, shuffleps(last, last, _MM_SHUFFLE(2, 2, 1, 0)));
+
+    // Horizontal reduction.
+    m = maxps(m, shuffleps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = maxps(m, shuffleps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    float value;
+    storess(&value, m);
+
+    return value;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline size_t min_index(const RegularSpectrum<T, N>& s)
 {
@@ -656,6 +990,34 @@ inline T average_value(const RegularSpectrum<T, N>& s)
     return average / N;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE float average_value(const RegularSpectrum<float, 31>& s)
+{
+    // Clear the padding sample.
+    const sse4f mlast = _mm_castsi128_ps(_mm_set_epi32(0, ~0, ~0, ~0));
+
+    sse4f m = addps(loadps(&s[0]), loadps(&s[4]));
+    m = addps(m, loadps(&s[ 8]));
+    m = addps(m, loadps(&s[12]));
+    m = addps(m, loadps(&s[16]));
+    m = addps(m, loadps(&s[20]));
+    m = addps(m, loadps(&s[24]));
+    m = addps(m, andps(loadps(&s[28]), mlast));
+
+    // Horizontal sum.
+    m = addps(m, shuffleps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = addps(m, shuffleps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    float sum;
+    storess(&sum, m);
+
+    return sum * (1.0f / 31.0f);
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 }       // namespace foundation
 
 
@@ -679,6 +1041,29 @@ inline foundation::RegularSpectrum<T, N> min(
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE foundation::RegularSpectrum<float, 31> min(
+    const foundation::RegularSpectrum<float, 31>&   lhs,
+    const foundation::RegularSpectrum<float, 31>&   rhs)
+{
+    foundation::RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], minps(loadps(&lhs[ 0]), loadps(&rhs[ 0])));
+    storeps(&result[ 4], minps(loadps(&lhs[ 4]), loadps(&rhs[ 4])));
+    storeps(&result[ 8], minps(loadps(&lhs[ 8]), loadps(&rhs[ 8])));
+    storeps(&result[12], minps(loadps(&lhs[12]), loadps(&rhs[12])));
+    storeps(&result[16], minps(loadps(&lhs[16]), loadps(&rhs[16])));
+    storeps(&result[20], minps(loadps(&lhs[20]), loadps(&rhs[20])));
+    storeps(&result[24], minps(loadps(&lhs[24]), loadps(&rhs[24])));
+    storeps(&result[28], minps(loadps(&lhs[28]), loadps(&rhs[28])));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 template <typename T, size_t N>
 inline foundation::RegularSpectrum<T, N> max(
     const foundation::RegularSpectrum<T, N>&    lhs,
@@ -692,6 +1077,29 @@ inline foundation::RegularSpectrum<T, N> max(
     return result;
 }
 
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+template <>
+FORCE_INLINE foundation::RegularSpectrum<float, 31> max(
+    const foundation::RegularSpectrum<float, 31>&   lhs,
+    const foundation::RegularSpectrum<float, 31>&   rhs)
+{
+    foundation::RegularSpectrum<float, 31> result;
+
+    storeps(&result[ 0], maxps(loadps(&lhs[ 0]), loadps(&rhs[ 0])));
+    storeps(&result[ 4], maxps(loadps(&lhs[ 4]), loadps(&rhs[ 4])));
+    storeps(&result[ 8], maxps(loadps(&lhs[ 8]), loadps(&rhs[ 8])));
+    storeps(&result[12], maxps(loadps(&lhs[12]), loadps(&rhs[12])));
+    storeps(&result[16], maxps(loadps(&lhs[16]), loadps(&rhs[16])));
+    storeps(&result[20], maxps(loadps(&lhs[20]), loadps(&rhs[20])));
+    storeps(&result[24], maxps(loadps(&lhs[24]), loadps(&rhs[24])));
+    storeps(&result[28], maxps(loadps(&lhs[28]), loadps(&rhs[28])));
+
+    return result;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
 }       // namespace std
 
 #endif  // !APPLESEED_FOUNDATION_IMAGE_SPECTRUM_H
@@ -32,6 +32,8 @@
 // Interface headers.
 #include "foundation/math/bsp/bsp_builder.h"
 #include "foundation/math/bsp/bsp_intersector.h"
+#include "foundation/math/bsp/bsp_packetintersector.h"
+#include "foundation/math/bsp/bsp_parallelbuilder.h"
 #include "foundation/math/bsp/bsp_statistics.h"
 #include "foundation/math/bsp/bsp_tree.h"
 
@@ -0,0 +1,349 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BSP_BSP_PACKETINTERSECTOR_H
+#define APPLESEED_FOUNDATION_MATH_BSP_BSP_PACKETINTERSECTOR_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/bsp/bsp_intersector.h"
+#include "foundation/math/bsp/bsp_statistics.h"
+#include "foundation/math/ray.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bsp {
+
+//
+// BSP tree intersector for packets of rays.
+//
+// All the rays of a packet are traversed together: a node is only fetched
+// once for the whole packet, and leaves are visited once for all the rays
+// that reach them. Each ray keeps its own [tnear, tfar] interval and the
+// rays that do not reach a given subtree are masked out of it, such that
+// every ray visits exactly the leaves it would visit if it was traced on
+// its own, in the same order.
+//
+// This requires all the rays of the packet to have the same direction
+// signs along all dimensions; use is_coherent() to check this condition
+// and fall back to bsp::Intersector otherwise.
+//
+// The Visitor class must conform to the following prototype:
+//
+//      class Visitor
+//        : public foundation::NonCopyable
+//      {
+//        public:
+//          // Visit a leaf with the rays whose bit is set in 'ray_mask', and
+//          // return in 'distances' the distance to the closest intersection
+//          // found so far for each of these rays.
+//          void visit(
+//              const Leaf*         leaf,
+//              const RayType       rays[],
+//              const RayInfoType   ray_infos[],
+//              const uint32        ray_mask,
+//              ValueType           distances[]);
+//      };
+//
+
+template <typename T, typename Tree, typename Visitor, size_t N = 4, size_t S = 64>
+class PacketIntersector
+  : public NonCopyable
+{
+  public:
+    // Types.
+    typedef T ValueType;
+    typedef typename Tree::NodeType NodeType;
+    typedef typename Tree::LeafType LeafType;
+    typedef Ray<T, Tree::Dimension> RayType;
+    typedef RayInfo<T, Tree::Dimension> RayInfoType;
+
+    // Number of rays in a packet.
+    static const size_t PacketSize = N;
+
+    // Return true if the rays whose bit is set in 'ray_mask' can be traversed together.
+    static bool is_coherent(
+        const RayInfoType       ray_infos[],
+        const uint32            ray_mask);
+
+    // Intersect a packet of rays with a given BSP tree. Only the rays
+    // whose bit is set in 'ray_mask' are traced; they must be coherent.
+    void intersect(
+        const Tree&             tree,
+        const RayType           rays[],
+        const RayInfoType       ray_infos[],
+        const uint32            ray_mask,
+        Visitor&                visitor
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+        , TraversalStatistics&  stats
+#endif
+        ) const;
+
+  private:
+    // Node stack size.
+    static const size_t StackSize = S;
+
+    // Entry of the node stack.
+    struct NodeEntry
+    {
+        ValueType           m_tnear[N];
+        ValueType           m_tfar[N];
+        uint32              m_mask;
+        const NodeType*     m_node;
+    };
+};
+
+
+//
+// PacketIntersector class implementation.
+//
+
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+#define FOUNDATION_BSP_TRAVERSAL_STATS(x) x
+#else
+#define FOUNDATION_BSP_TRAVERSAL_STATS(x)
+#endif
+
+// Return true if the rays whose bit is set in 'ray_mask' can be traversed together.
+template <typename T, typename Tree, typename Visitor, size_t N, size_t S>
+bool PacketIntersector<T, Tree, Visitor, N, S>::is_coherent(
+    const RayInfoType       ray_infos[],
+    const uint32            ray_mask)
+{
+    const RayInfoType* reference = 0;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (!(ray_mask & (1UL << i)))
+            continue;
+
+        if (reference == 0)
+        {
+            reference = &ray_infos[i];
+            continue;
+        }
+
+        for (size_t d = 0; d < Tree::Dimension; ++d)
+        {
+            if (ray_infos[i].m_sgn_dir[d] != reference->m_sgn_dir[d])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Intersect a packet of rays with a given BSP tree.
+template <typename T, typename Tree, typename Visitor, size_t N, size_t S>
+void PacketIntersector<T, Tree, Visitor, N, S>::intersect(
+    const Tree&             tree,
+    const RayType           rays[],
+    const RayInfoType       ray_infos[],
+    const uint32            ray_mask,
+    Visitor&                visitor
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+    , TraversalStatistics&  stats
+#endif
+    ) const
+{
+    assert(!tree.m_nodes.empty());
+    assert(is_coherent(ray_infos, ray_mask));
+
+    if (ray_mask == 0)
+        return;
+
+    // Initialize traversal statistics.
+    FOUNDATION_BSP_TRAVERSAL_STATS(++stats.m_traversal_count);
+    FOUNDATION_BSP_TRAVERSAL_STATS(size_t visited_interior = 0);
+    FOUNDATION_BSP_TRAVERSAL_STATS(size_t visited_leaves = 0);
+    FOUNDATION_BSP_TRAVERSAL_STATS(size_t intersected_items = 0);
+
+    // Direction signs shared by all the rays of the packet.
+    size_t first_ray = 0;
+    while (!(ray_mask & (1UL << first_ray)))
+        ++first_ray;
+    const RayInfoType& ref_ray_info = ray_infos[first_ray];
+
+    // Initialize the node stack.
+    NodeEntry stack[StackSize];
+    NodeEntry* stack_ptr = stack;
+
+    // Start at the root node.
+    const NodeType* node = &tree.m_nodes.front();
+    uint32 mask = ray_mask;
+    ValueType tnear[N];
+    ValueType tfar[N];
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (ray_mask & (1UL << i))
+        {
+            tnear[i] = rays[i].m_tmin;
+            tfar[i] = rays[i].m_tmax;
+        }
+    }
+
+    // Rays whose closest intersection is still unknown.
+    uint32 live_mask = ray_mask;
+
+    ValueType distances[N];
+
+    // Traverse the tree and intersect leaf nodes.
+    while (true)
+    {
+        // Traverse the tree until a leaf is reached.
+        while (node->is_interior())
+        {
+            // Update statistics.
+            FOUNDATION_BSP_TRAVERSAL_STATS(++visited_interior);
+
+            // Get the splitting dimension and abscissa.
+            const size_t split_dim = node->get_split_dim();
+            const ValueType split_abs = node->get_split_abs();
+
+            // Get child node index and ray direction sign.
+            node = &tree.m_nodes[node->get_child_node_index()];
+            const size_t sgn_dir = ref_ray_info.m_sgn_dir[split_dim];
+
+            // Classify the rays against the splitting plane.
+            ValueType t[N];
+            uint32 front_mask = 0;
+            uint32 back_mask = 0;
+            for (size_t i = 0; i < N; ++i)
+            {
+                if (!(mask & (1UL << i)))
+                    continue;
+
+                t[i] = (split_abs - rays[i].m_org[split_dim]) * ray_infos[i].m_rcp_dir[split_dim];
+
+                if (!(t[i] < tnear[i]))
+                    front_mask |= 1UL << i;
+
+                if (!(t[i] >= tfar[i]))
+                    back_mask |= 1UL << i;
+            }
+
+            if (front_mask == 0)
+            {
+                // Follow the back node.
+                node += sgn_dir;
+            }
+            else
+            {
+                // Push the back node on the stack.
+                if (back_mask != 0)
+                {
+                    assert(stack_ptr < &stack[StackSize]);
+                    stack_ptr->m_mask = back_mask;
+                    stack_ptr->m_node = node + sgn_dir;
+                    for (size_t i = 0; i < N; ++i)
+                    {
+                        if (back_mask & (1UL << i))
+                        {
+                            stack_ptr->m_tnear[i] = (front_mask & (1UL << i)) ? t[i] : tnear[i];
+                            stack_ptr->m_tfar[i] = tfar[i];
+                        }
+                    }
+                    ++stack_ptr;
+
+                    for (size_t i = 0; i < N; ++i)
+                    {
+                        if ((front_mask & back_mask) & (1UL << i))
+                            tfar[i] = t[i];
+                    }
+                }
+
+                // Follow the front node.
+                node += 1 - sgn_dir;
+                mask = front_mask;
+            }
+        }
+
+        if (node->get_leaf_size() > 0)
+        {
+            // Update statistics.
+            FOUNDATION_BSP_TRAVERSAL_STATS(++visited_leaves);
+            FOUNDATION_BSP_TRAVERSAL_STATS(intersected_items += node->get_leaf_size());
+
+            // Fetch the leaf.
+            const LeafType* leaf = tree.m_leaves[node->get_leaf_index()];
+
+            // Visit the leaf.
+            visitor.visit(leaf, rays, ray_infos, mask, distances);
+
+            // The rays that found an intersection within the bounds of the leaf
+            // have found their closest intersection and can be retired.
+            for (size_t i = 0; i < N; ++i)
+            {
+                if ((mask & (1UL << i)) && distances[i] < tfar[i])
+                    live_mask &= ~(1UL << i);
+            }
+
+            if (live_mask == 0)
+                break;
+        }
+
+        // Pop the next node from the stack.
+        mask = 0;
+        while (stack_ptr > stack && mask == 0)
+        {
+            --stack_ptr;
+            mask = stack_ptr->m_mask & live_mask;
+        }
+
+        // Terminate traversal if there is no more nodes to visit.
+        if (mask == 0)
+            break;
+
+        // Update tnear and tfar.
+        node = stack_ptr->m_node;
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (mask & (1UL << i))
+            {
+                tnear[i] = stack_ptr->m_tnear[i];
+                tfar[i] = stack_ptr->m_tfar[i];
+            }
+        }
+    }
+
+    // Store traversal statistics.
+    FOUNDATION_BSP_TRAVERSAL_STATS(stats.m_visited_interior.insert(visited_interior));
+    FOUNDATION_BSP_TRAVERSAL_STATS(stats.m_visited_leaves.insert(visited_leaves));
+    FOUNDATION_BSP_TRAVERSAL_STATS(stats.m_intersected_items.insert(intersected_items));
+}
+
+#undef FOUNDATION_BSP_TRAVERSAL_STATS
+
+}       // namespace bsp
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BSP_BSP_PACKETINTERSECTOR_H
@@ -0,0 +1,714 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BSP_BSP_PARALLELBUILDER_H
+#define APPLESEED_FOUNDATION_MATH_BSP_BSP_PARALLELBUILDER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/bsp/bsp_builder.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/split.h"
+#include "foundation/platform/timer.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <queue>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class Logger; }
+
+namespace foundation {
+namespace bsp {
+
+//
+// Multithreaded BSP tree builder.
+//
+// This builder produces exactly the same tree as bsp::Builder: leaves are still
+// split one at a time, in order of decreasing priority and within the same global
+// duplication budget. However, when the next leaf to split is large enough, the
+// splits of the leaves at the top of the leaf queue are computed ahead of time,
+// in parallel, by a set of worker threads. Smaller leaves are split on the calling
+// thread.
+//
+// The LeafFactory and LeafSplitter classes must conform to the prototypes given
+// in bsp_builder.h. In addition, the LeafSplitter class must provide the following
+// method:
+//
+//      // Create a new splitter with the same settings as this one.
+//      // The new splitter will be used concurrently with this one.
+//      LeafSplitter* clone() const;
+//
+// The split() and sort() methods of the leaf splitter must only depend on their
+// arguments. get_priority() and the leaf factory are only used by the calling thread.
+//
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer = DefaultWallclockTimer
+>
+class ParallelBuilder
+  : public NonCopyable
+{
+  public:
+    // Types.
+    typedef typename Tree::ValueType ValueType;
+    typedef typename Tree::AABBType AABBType;
+    typedef typename Tree::NodeType NodeType;
+    typedef typename Tree::LeafType LeafType;
+    typedef Tree TreeType;
+
+    // Constructor.
+    ParallelBuilder(
+        Logger&                 logger,
+        const size_t            thread_count,               // number of worker threads
+        const size_t            min_parallel_leaf_size);    // leaves smaller than this are split on the calling thread
+
+    // Build a BSP tree for a given root leaf.
+    void build(
+        TreeType&               tree,
+        std::auto_ptr<LeafType> root_leaf,
+        LeafFactory&            factory,
+        LeafSplitter&           splitter,
+        const double            max_duplication_rate = 2.0);
+
+    // Return the construction time.
+    double get_build_time() const;
+
+  private:
+    typedef Split<ValueType> SplitType;
+    typedef LeafInfo<ValueType, Tree::Dimension> LeafInfoType;
+    typedef LeafRecord<ValueType, Tree::Dimension> LeafRecordType;
+    typedef std::vector<LeafSplitter*> LeafSplitterVector;
+    typedef std::vector<LeafType*> LeafVector;
+
+    // A priority queue of leaf records whose heap can be read without popping.
+    class LeafQueue
+      : public std::priority_queue<LeafRecordType>
+    {
+      public:
+        typedef typename std::vector<LeafRecordType>::const_iterator const_iterator;
+
+        // Iterate over the leaf records in heap order: the first record is the top one,
+        // and a record is never preceded by one of its descendants.
+        const_iterator begin() const { return this->c.begin(); }
+        const_iterator end() const { return this->c.end(); }
+    };
+
+    // The result of splitting a leaf.
+    struct SplitResult
+    {
+        bool                    m_completed;                // true once the split has been fully computed
+        bool                    m_split_found;              // true if the leaf was actually split
+        SplitType               m_split;
+        AABBType                m_left_leaf_bbox;
+        AABBType                m_right_leaf_bbox;
+        LeafType*               m_left_leaf;
+        LeafType*               m_right_leaf;
+    };
+
+    typedef std::vector<SplitResult*> SplitResultVector;
+
+    // A job computing the split of a single leaf.
+    class SplitJob
+      : public IJob
+    {
+      public:
+        SplitJob(
+            LeafSplitterVector& splitters,
+            const LeafType&     leaf,
+            const LeafInfoType& leaf_info,
+            SplitResult&        result)
+          : m_splitters(splitters)
+          , m_leaf(leaf)
+          , m_leaf_info(leaf_info)
+          , m_result(result)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            assert(thread_index < m_splitters.size());
+            compute_split(*m_splitters[thread_index], m_leaf, m_leaf_info, m_result);
+        }
+
+      private:
+        LeafSplitterVector&     m_splitters;
+        const LeafType&         m_leaf;
+        const LeafInfoType      m_leaf_info;
+        SplitResult&            m_result;
+    };
+
+    Logger&                     m_logger;
+    const size_t                m_thread_count;
+    const size_t                m_min_parallel_leaf_size;
+    double                      m_build_time;
+
+    // Insert a leaf into a leaf queue.
+    static void insert_leaf_record(
+        TreeType&               tree,
+        LeafSplitter&           splitter,
+        LeafQueue&              leaf_queue,
+        const LeafInfoType&     leaf_info,
+        const size_t            leaf_index,
+        const size_t            node_index);
+
+    // Create the root of the tree.
+    void create_root(
+        TreeType&               tree,
+        std::auto_ptr<LeafType> root_leaf);
+
+    // Create a new split result, reusing recycled leaves when possible.
+    static SplitResult* create_split_result(
+        LeafFactory&            factory,
+        LeafVector&             free_leaves);
+
+    // Find a split for a given leaf and sort the leaf into child leaves.
+    static void compute_split(
+        LeafSplitter&           splitter,
+        const LeafType&         leaf,
+        const LeafInfoType&     leaf_info,
+        SplitResult&            result);
+
+    // Compute in parallel the splits of the leaves at the top of the leaf queue.
+    void precompute_splits(
+        TreeType&               tree,
+        const LeafQueue&        leaf_queue,
+        LeafFactory&            factory,
+        LeafVector&             free_leaves,
+        LeafSplitterVector&     splitters,
+        JobQueue&               job_queue,
+        SplitResultVector&      results) const;
+
+    // Subdivide the tree.
+    void subdivide(
+        TreeType&               tree,
+        LeafFactory&            factory,
+        LeafSplitter&           splitter,
+        const double            max_duplication_rate);
+};
+
+
+//
+// ParallelBuilder class implementation.
+//
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::ParallelBuilder(
+    Logger&                 logger,
+    const size_t            thread_count,
+    const size_t            min_parallel_leaf_size)
+  : m_logger(logger)
+  , m_thread_count(thread_count)
+  , m_min_parallel_leaf_size(min_parallel_leaf_size)
+  , m_build_time(0.0)
+{
+}
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+void ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::build(
+    TreeType&               tree,
+    std::auto_ptr<LeafType> root_leaf,
+    LeafFactory&            factory,
+    LeafSplitter&           splitter,
+    const double            max_duplication_rate)
+{
+    // Start stopwatch.
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    // Clear the BSP tree.
+    tree.clear();
+
+    // Initialize the bounding box of the tree.
+    tree.m_bbox = root_leaf->get_bbox();
+
+    // Slightly enlarge the bounding box of the tree to avoid
+    // missing intersections with entities lying exactly on a
+    // wall of the bounding box.
+    if (tree.m_bbox.is_valid())
+    {
+        const ValueType eps = get_bbox_grow_eps<ValueType>();
+        tree.m_bbox.robust_grow(eps);
+    }
+
+    // Create the root of the tree.
+    create_root(tree, root_leaf);
+
+    // Subdivide the tree.
+    subdivide(tree, factory, splitter, max_duplication_rate);
+
+    // Measure and save construction time.
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+}
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+double ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::get_build_time() const
+{
+    return m_build_time;
+}
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+void ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::insert_leaf_record(
+    TreeType&               tree,
+    LeafSplitter&           splitter,
+    LeafQueue&              leaf_queue,
+    const LeafInfoType&     leaf_info,
+    const size_t            leaf_index,
+    const size_t            node_index)
+{
+    // Compute the splitting priority of the leaf.
+    const LeafType& leaf = *tree.m_leaves[leaf_index];
+    const double leaf_priority = splitter.get_priority(leaf, leaf_info);
+
+    // Insert the leaf into the leaf queue if it needs to be split.
+    if (leaf_priority > 0.0)
+    {
+        const LeafRecordType leaf_record(
+            node_index,
+            leaf_info,
+            leaf_priority);
+        leaf_queue.push(leaf_record);
+    }
+}
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+void ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::create_root(
+    TreeType&               tree,
+    std::auto_ptr<LeafType> root_leaf)
+{
+    assert(tree.m_leaves.empty());
+    assert(tree.m_nodes.empty());
+
+    // Store the root leaf.
+    tree.m_leaves.push_back(root_leaf.release());
+
+    // Create the root node.
+    NodeType root_node;
+    root_node.set_type(NodeType::Leaf);
+    root_node.set_leaf_index(0);
+    root_node.set_leaf_size(tree.m_leaves.front()->get_size());
+    tree.m_nodes.push_back(root_node);
+}
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+typename ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::SplitResult*
+ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::create_split_result(
+    LeafFactory&            factory,
+    LeafVector&             free_leaves)
+{
+    SplitResult* result = new SplitResult();
+    result->m_completed = false;
+    result->m_split_found = false;
+
+    LeafType* leaves[2];
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        if (free_leaves.empty())
+            leaves[i] = factory.create_leaf();
+        else
+        {
+            leaves[i] = free_leaves.back();
+            free_leaves.pop_back();
+        }
+    }
+
+    result->m_left_leaf = leaves[0];
+    result->m_right_leaf = leaves[1];
+
+    return result;
+}
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+void ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::compute_split(
+    LeafSplitter&           splitter,
+    const LeafType&         leaf,
+    const LeafInfoType&     leaf_info,
+    SplitResult&            result)
+{
+    // Attempt to split the leaf.
+    result.m_split_found = splitter.split(leaf, leaf_info, result.m_split);
+
+    if (result.m_split_found)
+    {
+        // Compute the bounding box of the child leaves.
+        split_bbox(
+            leaf_info.get_bbox(),
+            result.m_split,
+            result.m_left_leaf_bbox,
+            result.m_right_leaf_bbox);
+
+        // Create LeafInfo for left and right leaves.
+        const size_t child_depth = leaf_info.get_node_depth() + 1;
+        const LeafInfoType left_leaf_info(child_depth, result.m_left_leaf_bbox);
+        const LeafInfoType right_leaf_info(child_depth, result.m_right_leaf_bbox);
+
+        // Sort the elements of the leaf into the child leaves.
+        splitter.sort(
+            leaf,
+            leaf_info,
+            result.m_split,
+            *result.m_left_leaf,
+            left_leaf_info,
+            *result.m_right_leaf,
+            right_leaf_info);
+    }
+
+    result.m_completed = true;
+}
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+void ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::precompute_splits(
+    TreeType&               tree,
+    const LeafQueue&        leaf_queue,
+    LeafFactory&            factory,
+    LeafVector&             free_leaves,
+    LeafSplitterVector&     splitters,
+    JobQueue&               job_queue,
+    SplitResultVector&      results) const
+{
+    // Keep a few jobs per worker thread to balance the load.
+    const size_t max_job_count = m_thread_count * 4;
+    const size_t max_scanned_leaf_count = max_job_count * 4;
+
+    if (results.size() < tree.m_nodes.size())
+        results.resize(tree.m_nodes.size(), 0);
+
+    // Visit the leaves at the top of the heap: these are the next ones to be split,
+    // in roughly the order in which they will be split. Scanning the heap directly
+    // avoids copying the whole leaf queue every time.
+    size_t job_count = 0;
+    size_t scanned_leaf_count = 0;
+
+    for (typename LeafQueue::const_iterator i = leaf_queue.begin();
+         i != leaf_queue.end() && scanned_leaf_count < max_scanned_leaf_count && job_count < max_job_count;
+         ++i, ++scanned_leaf_count)
+    {
+        const LeafRecordType& leaf_record = *i;
+
+        // Skip leaves whose split is already known.
+        const size_t node_index = leaf_record.get_node_index();
+        if (results[node_index])
+            continue;
+
+        // Skip leaves that are too small to be worth a job.
+        const NodeType& node = tree.m_nodes[node_index];
+        assert(node.get_type() == NodeType::Leaf);
+        const LeafType& leaf = *tree.m_leaves[node.get_leaf_index()];
+        if (leaf.get_size() < m_min_parallel_leaf_size)
+            continue;
+
+        // Schedule the computation of the split of this leaf.
+        SplitResult* result = create_split_result(factory, free_leaves);
+        results[node_index] = result;
+        job_queue.schedule(
+            new SplitJob(
+                splitters,
+                leaf,
+                leaf_record.get_leaf_info(),
+                *result));
+        ++job_count;
+    }
+
+    // Wait until all splits are computed.
+    job_queue.wait_until_completion();
+}
+
+template <
+    typename Tree,
+    typename LeafFactory,
+    typename LeafSplitter,
+    typename Timer
+>
+void ParallelBuilder<Tree, LeafFactory, LeafSplitter, Timer>::subdivide(
+    TreeType&               tree,
+    LeafFactory&            factory,
+    LeafSplitter&           splitter,
+    const double            max_duplication_rate)
+{
+    // Create the leaf queue, keeping track of leaves that needs
+    // splitting, and ordering them by splitting priority.
+    LeafQueue leaf_queue;
+
+    // Insert the root leaf into the leaf queue.
+    const LeafInfoType root_leaf_info(0, tree.m_bbox);
+    insert_leaf_record(
+        tree,               // tree
+        splitter,           // leaf splitter
+        leaf_queue,         // leaf queue
+        root_leaf_info,     // leaf info
+        0,                  // leaf index
+        0);                 // node index
+
+    // Precomputed splits, indexed by node index, and recycled leaves.
+    SplitResultVector results;
+    LeafVector free_leaves;
+
+    // Create one leaf splitter per worker thread, and start the worker threads.
+    LeafSplitterVector splitters;
+    JobQueue job_queue;
+    std::auto_ptr<JobManager> job_manager;
+    if (m_thread_count > 1)
+    {
+        for (size_t i = 0; i < m_thread_count; ++i)
+            splitters.push_back(splitter.clone());
+
+        job_manager.reset(
+            new JobManager(
+                m_logger,
+                job_queue,
+                m_thread_count));
+
+        job_manager->start();
+    }
+
+    // Initially, the tree contains as many objects as the root leaf.
+    size_t tree_size = tree.m_leaves.front()->get_size();
+
+    // Compute maximum tree size, given the maximum duplication rate.
+    const size_t max_tree_size = truncate<size_t>(tree_size * max_duplication_rate);
+
+    // Subdivide until there is no node to split anymore,
+    // or until the maximum tree size has been reached.
+    while (!leaf_queue.empty() && tree_size < max_tree_size)
+    {
+        // Get leaf record and leaf info of next leaf to split.
+        const LeafRecordType leaf_record = leaf_queue.top();
+        const LeafInfoType& leaf_info = leaf_record.get_leaf_info();
+        const size_t node_index = leaf_record.get_node_index();
+
+        // Get leaf node.
+        NodeType& node = tree.m_nodes[node_index];
+        assert(node.get_type() == NodeType::Leaf);
+
+        // Get leaf.
+        const size_t leaf_index = node.get_leaf_index();
+        LeafType& leaf = *tree.m_leaves[leaf_index];
+
+        // If this leaf is large, split it and the leaves that follow it in parallel.
+        if (job_manager.get() &&
+            leaf.get_size() >= m_min_parallel_leaf_size &&
+            (node_index >= results.size() || results[node_index] == 0))
+        {
+            precompute_splits(
+                tree,
+                leaf_queue,
+                factory,
+                free_leaves,
+                splitters,
+                job_queue,
+                results);
+        }
+
+        leaf_queue.pop();
+
+        // Fetch the split of the leaf, or compute it now.
+        SplitResult* result = 0;
+        if (node_index < results.size())
+        {
+            result = results[node_index];
+            results[node_index] = 0;
+        }
+        if (result == 0)
+            result = create_split_result(factory, free_leaves);
+        if (!result->m_completed)
+        {
+            // Either the split was not precomputed, or its computation failed.
+            result->m_left_leaf->clear();
+            result->m_right_leaf->clear();
+            compute_split(splitter, leaf, leaf_info, *result);
+        }
+
+        LeafType* left_leaf = result->m_left_leaf;
+        LeafType* right_leaf = result->m_right_leaf;
+
+        if (result->m_split_found)
+        {
+            const SplitType& split = result->m_split;
+
+            // Compute the indices of the child leaves and child nodes.
+            const size_t left_leaf_index  = leaf_index;
+            const size_t right_leaf_index = tree.m_leaves.size();
+            const size_t left_node_index  = tree.m_nodes.size();
+            const size_t right_node_index = left_node_index + 1;
+
+            // Create LeafInfo for left and right leaves.
+            const size_t child_depth = leaf_info.get_node_depth() + 1;
+            const LeafInfoType left_leaf_info(child_depth, result->m_left_leaf_bbox);
+            const LeafInfoType right_leaf_info(child_depth, result->m_right_leaf_bbox);
+
+            // Count the number of objects in the parent, left and right leaves.
+            const size_t leaf_size = leaf.get_size();
+            const size_t left_leaf_size = left_leaf->get_size();
+            const size_t right_leaf_size = right_leaf->get_size();
+            assert(left_leaf_size + right_leaf_size >= leaf_size);
+
+            // Update the tree size.
+            tree_size += left_leaf_size + right_leaf_size;
+            if (tree_size > leaf_size)
+                tree_size -= leaf_size;
+            else tree_size = 0;
+
+            // Replace the parent leaf with its left child.
+            std::swap(tree.m_leaves[leaf_index], left_leaf);
+
+            // Append the right child to the leaf vector.
+            tree.m_leaves.push_back(right_leaf);
+
+            // Recycle the left leaf (which is really the parent leaf).
+            left_leaf->clear();
+            free_leaves.push_back(left_leaf);
+
+            // Transform the leaf node to an interior node.
+            node.set_type(NodeType::Interior);
+            node.set_child_node_index(left_node_index);
+            node.set_split_dim(split.m_dimension);
+            node.set_split_abs(split.m_abscissa);
+
+            // Create the left node.
+            NodeType left_node;
+            left_node.set_type(NodeType::Leaf);
+            left_node.set_leaf_index(left_leaf_index);
+            left_node.set_leaf_size(left_leaf_size);
+            tree.m_nodes.push_back(left_node);
+
+            // Create the right node.
+            NodeType right_node;
+            right_node.set_type(NodeType::Leaf);
+            right_node.set_leaf_index(right_leaf_index);
+            right_node.set_leaf_size(right_leaf_size);
+            tree.m_nodes.push_back(right_node);
+
+            // Insert the left leaf into the leaf queue.
+            insert_leaf_record(
+                tree,                   // tree
+                splitter,               // leaf splitter
+                leaf_queue,             // leaf queue
+                left_leaf_info,         // leaf info
+                left_leaf_index,        // leaf index
+                left_node_index);       // node index
+
+            // Insert the right leaf into the leaf queue.
+            insert_leaf_record(
+                tree,                   // tree
+                splitter,               // leaf splitter
+                leaf_queue,             // leaf queue
+                right_leaf_info,        // leaf info
+                right_leaf_index,       // leaf index
+                right_node_index);      // node index
+        }
+        else
+        {
+            // The leaf was not split: recycle the child leaves.
+            left_leaf->clear();
+            right_leaf->clear();
+            free_leaves.push_back(left_leaf);
+            free_leaves.push_back(right_leaf);
+        }
+
+        delete result;
+    }
+
+    // Stop the worker threads.
+    job_manager.reset();
+
+    // Discard the splits that were computed but never used.
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (results[i])
+        {
+            delete results[i]->m_left_leaf;
+            delete results[i]->m_right_leaf;
+            delete results[i];
+        }
+    }
+
+    for (size_t i = 0; i < free_leaves.size(); ++i)
+        delete free_leaves[i];
+
+    for (size_t i = 0; i < splitters.size(); ++i)
+        delete splitters[i];
+}
+
+}       // namespace bsp
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BSP_BSP_PARALLELBUILDER_H
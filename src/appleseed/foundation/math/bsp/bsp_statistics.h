@@ -71,6 +71,8 @@ class TreeStatistics
     const size_t            m_node_count;           // total number of nodes (leaf and interior nodes)
     const size_t            m_leaf_count;           // number of leaf nodes
     const ValueType         m_volume;               // volume of the tree
+    const double            m_half_surface_area;    // half surface area of the tree
+    double                  m_sah_cost;             // SAH cost of the tree (unit traversal and intersection costs)
     ValueType               m_empty_volume;         // total empty volume
     size_t                  m_empty_leaf_count;     // number of empty leaf nodes
     size_t                  m_tree_size;            // number of objects
@@ -122,6 +124,8 @@ TreeStatistics<Tree, Builder>::TreeStatistics(
   , m_node_count(tree.m_nodes.size())
   , m_leaf_count(tree.m_leaves.size())
   , m_volume(tree.m_bbox.is_valid() ? tree.m_bbox.volume() : ValueType(0.0))
+  , m_half_surface_area(tree.m_bbox.is_valid() ? tree.m_bbox.half_surface_area() : 0.0)
+  , m_sah_cost(0.0)
   , m_empty_volume(ValueType(0.0))
   , m_empty_leaf_count(0)
   , m_tree_size(0)
@@ -140,12 +144,14 @@ void TreeStatistics<Tree, Builder>::print(Logger& logger)
     LOG_DEBUG(
         logger,
         "  build time       %s\n"
+        "  sah cost         %.1f\n"
         "  size             %s  %s %s\n"
         "  nodes            total %s  interior %s  leaves %s\n"
         "  empty leaves     leaves %s  volume %s\n"
         "  leaf depth       avg %.1f  min %s  max %s  dev %.1f\n"
         "  leaf size        avg %.1f  min %s  max %s  dev %.1f",
         pretty_time(m_build_time).c_str(),
+        m_sah_cost,
         pretty_size(m_memory_size).c_str(),
         pretty_uint(m_tree_size).c_str(),
         plural(m_tree_size, "item").c_str(),
@@ -172,6 +178,10 @@ void TreeStatistics<Tree, Builder>::collect_stats_recurse(
     const AABBType&         bbox,
     const size_t            depth)
 {
+    // Probability of hitting this node given that the root node is hit.
+    const double hit_prob =
+        m_half_surface_area > 0.0 ? bbox.half_surface_area() / m_half_surface_area : 0.0;
+
     if (node.get_type() == NodeType::Leaf)
     {
         // Gather leaf statistics.
@@ -181,6 +191,9 @@ void TreeStatistics<Tree, Builder>::collect_stats_recurse(
         m_leaf_size.insert(leaf_size);
         m_tree_size += leaf_size;
 
+        // Accumulate the cost of intersecting the items of the leaf.
+        m_sah_cost += hit_prob * leaf_size;
+
         // Gather empty leaves statistics.
         if (leaf_size == 0)
         {
@@ -190,6 +203,9 @@ void TreeStatistics<Tree, Builder>::collect_stats_recurse(
     }
     else
     {
+        // Accumulate the cost of traversing this node.
+        m_sah_cost += hit_prob;
+
         // Compute the bounding boxes of the child nodes.
         const Split<ValueType> split(node.get_split_dim(), node.get_split_abs());
         AABBType left_bbox, right_bbox;
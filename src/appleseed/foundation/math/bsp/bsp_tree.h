@@ -103,6 +103,14 @@ class Tree
     >
     friend class Builder;
 
+    template <
+        typename Tree,
+        typename LeafFactory,
+        typename LeafSplitter,
+        typename Timer
+    >
+    friend class ParallelBuilder;
+
     template <
         typename T_,
         typename Tree,
@@ -111,6 +119,15 @@ class Tree
     >
     friend class Intersector;
 
+    template <
+        typename T_,
+        typename Tree,
+        typename Visitor,
+        size_t N_,
+        size_t S
+    >
+    friend class PacketIntersector;
+
     template <typename Tree, typename Builder>
     friend class TreeStatistics;
 
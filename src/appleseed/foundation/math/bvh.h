@@ -32,6 +32,10 @@
 // Interface headers.
 #include "foundation/math/bvh/bvh_builder.h"
 #include "foundation/math/bvh/bvh_intersector.h"
+#include "foundation/math/bvh/bvh_qbuilder.h"
+#include "foundation/math/bvh/bvh_qintersector.h"
+#include "foundation/math/bvh/bvh_qnode.h"
+#include "foundation/math/bvh/bvh_qtree.h"
 #include "foundation/math/bvh/bvh_statistics.h"
 #include "foundation/math/bvh/bvh_tree.h"
 
@@ -0,0 +1,235 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_QBUILDER_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_QBUILDER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/platform/timer.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// QBVH builder.
+//
+// Collapses the binary nodes of a tree previously built with bvh::Builder
+// into 4-wide nodes. Each 4-wide node is obtained by repeatedly opening
+// the interior child with the largest surface area, until four children
+// are gathered or all children are leaves.
+//
+
+template <
+    typename Tree,
+    typename Timer = DefaultWallclockTimer
+>
+class QBuilder
+  : public NonCopyable
+{
+  public:
+    // Types.
+    typedef typename Tree::ValueType ValueType;
+    typedef typename Tree::AABBType AABBType;
+    typedef typename Tree::NodeType NodeType;
+    typedef typename Tree::QNodeType QNodeType;
+    typedef Tree TreeType;
+
+    // Constructor.
+    QBuilder();
+
+    // Collapse the binary nodes of a given tree into 4-wide nodes.
+    void build(TreeType& tree);
+
+    // Return the construction time.
+    double get_build_time() const;
+
+  private:
+    double m_build_time;
+
+    // Recursively collapse the tree.
+    void collapse_recurse(
+        TreeType&       tree,
+        const size_t    qnode_index,
+        const size_t    node_index);
+};
+
+
+//
+// QBuilder class implementation.
+//
+
+// Constructor.
+template <typename Tree, typename Timer>
+QBuilder<Tree, Timer>::QBuilder()
+  : m_build_time(0.0)
+{
+}
+
+// Collapse the binary nodes of a given tree into 4-wide nodes.
+template <typename Tree, typename Timer>
+void QBuilder<Tree, Timer>::build(TreeType& tree)
+{
+    assert(!tree.m_nodes.empty());
+
+    // Start stopwatch.
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    // Clear the 4-wide nodes.
+    tree.m_qnodes.clear();
+
+    // A binary tree with n leaves has n - 1 interior nodes,
+    // and a 4-wide tree never has more nodes than that.
+    tree.m_qnodes.reserve(tree.m_nodes.size() / 2 + 1);
+
+    // Create the root node of the tree.
+    tree.m_qnodes.push_back(QNodeType());
+
+    // Recursively collapse the tree.
+    collapse_recurse(tree, 0, 0);
+
+    // Measure and save construction time.
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+}
+
+// Return the construction time.
+template <typename Tree, typename Timer>
+double QBuilder<Tree, Timer>::get_build_time() const
+{
+    return m_build_time;
+}
+
+// Recursively collapse the tree.
+template <typename Tree, typename Timer>
+void QBuilder<Tree, Timer>::collapse_recurse(
+    TreeType&           tree,
+    const size_t        qnode_index,
+    const size_t        node_index)
+{
+    assert(qnode_index < tree.m_qnodes.size());
+    assert(node_index < tree.m_nodes.size());
+
+    const NodeType& node = tree.m_nodes[node_index];
+
+    // Gather up to four binary nodes that will become the children of this 4-wide node.
+    size_t children[QNodeType::Width];
+    size_t child_count;
+    if (node.is_leaf())
+    {
+        // Only happens when the whole tree is a single leaf.
+        children[0] = node_index;
+        child_count = 1;
+    }
+    else
+    {
+        children[0] = node.get_child_node_index();
+        children[1] = children[0] + 1;
+        child_count = 2;
+
+        while (child_count < QNodeType::Width)
+        {
+            // Find the interior child with the largest surface area.
+            size_t best_child = ~size_t(0);
+            ValueType best_area = ValueType(-1.0);
+            for (size_t i = 0; i < child_count; ++i)
+            {
+                const NodeType& child_node = tree.m_nodes[children[i]];
+                if (child_node.is_interior())
+                {
+                    const ValueType area = child_node.get_bbox().half_surface_area();
+                    if (best_area < area)
+                    {
+                        best_area = area;
+                        best_child = i;
+                    }
+                }
+            }
+
+            // Stop if all children are leaves.
+            if (best_child == ~size_t(0))
+                break;
+
+            // Replace this child by its own two children.
+            const size_t first_grandchild = tree.m_nodes[children[best_child]].get_child_node_index();
+            children[best_child] = first_grandchild;
+            children[child_count++] = first_grandchild + 1;
+        }
+    }
+
+    // Interior children are stored contiguously, right after the existing nodes.
+    const size_t first_qnode_index = tree.m_qnodes.size();
+    size_t interior_child_count = 0;
+
+    // Fill in the 4-wide node.
+    QNodeType& qnode = tree.m_qnodes[qnode_index];
+    qnode.set_child_count(child_count);
+    for (size_t i = 0; i < child_count; ++i)
+    {
+        const NodeType& child_node = tree.m_nodes[children[i]];
+
+        qnode.set_child_bbox(i, child_node.get_bbox());
+
+        if (child_node.is_leaf())
+        {
+            qnode.set_child_type(i, QNodeType::Leaf);
+            qnode.set_child_item_index(i, child_node.get_item_index());
+            qnode.set_child_item_count(i, child_node.get_item_count());
+        }
+        else
+        {
+            qnode.set_child_type(i, QNodeType::Interior);
+            qnode.set_child_node_index(i, first_qnode_index + interior_child_count++);
+            qnode.set_child_item_count(i, 0);
+        }
+    }
+
+    // Create the child nodes (this may invalidate the qnode reference).
+    tree.m_qnodes.resize(first_qnode_index + interior_child_count);
+
+    // Recurse into the interior children.
+    for (size_t i = 0, j = 0; i < child_count; ++i)
+    {
+        const NodeType& child_node = tree.m_nodes[children[i]];
+
+        if (child_node.is_interior())
+            collapse_recurse(tree, first_qnode_index + j++, children[i]);
+    }
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_QBUILDER_H
@@ -0,0 +1,406 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_QINTERSECTOR_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_QINTERSECTOR_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/bvh/bvh_qnode.h"
+#include "foundation/math/bvh/bvh_statistics.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/fp.h"
+#include "foundation/math/intersection.h"
+#include "foundation/math/ray.h"
+#include "foundation/platform/types.h"
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Intersect a ray with the (up to) four child bounding boxes of a QBVH node.
+//
+// Return a bit mask of the children that are intersected by the ray.
+// For these children, the distances to the entry and exit points,
+// clipped to the ray's [tmin, tmax] interval, are returned in 'tmin'
+// and 'tmax'. This is the 4-way equivalent of foundation::intersect().
+//
+
+template <typename T, typename U>
+size_t intersect_children(
+    const QNode<U, 3>&      node,
+    const Ray<T, 3>&        ray,
+    const RayInfo<T, 3>&    ray_info,
+    T                       tmin[4],
+    T                       tmax[4]);
+
+
+//
+// QBVH intersector.
+//
+// The Visitor class must conform to the prototype described in bvh_intersector.h.
+//
+
+template <
+    typename T,
+    typename Tree,
+    typename Visitor,
+    size_t StackSize = 128
+>
+class QIntersector
+  : public NonCopyable
+{
+  public:
+    // Types.
+    typedef T ValueType;
+    typedef typename Tree::ItemType ItemType;
+    typedef typename Tree::QNodeType QNodeType;
+    typedef AABB<T, Tree::Dimension> AABBType;
+    typedef Ray<T, Tree::Dimension> RayType;
+    typedef RayInfo<T, Tree::Dimension> RayInfoType;
+
+    // Intersect a ray with a given QBVH.
+    void intersect(
+        const Tree&             tree,
+        const RayType&          ray,
+        const RayInfoType&      ray_info,
+        Visitor&                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , TraversalStatistics&  stats
+#endif
+        ) const;
+
+  private:
+    // Entry of the node stack.
+    struct NodeEntry
+    {
+        ValueType   m_tmin;
+        ValueType   m_tmax;
+        uint32      m_info;
+        uint32      m_count;
+    };
+};
+
+
+//
+// 4-way ray-AABB intersection implementation.
+//
+
+template <typename T, typename U>
+inline size_t intersect_children(
+    const QNode<U, 3>&      node,
+    const Ray<T, 3>&        ray,
+    const RayInfo<T, 3>&    ray_info,
+    T                       tmin[4],
+    T                       tmax[4])
+{
+    size_t mask = 0;
+
+    for (size_t i = 0; i < node.get_child_count(); ++i)
+    {
+        const AABB<T, 3> bbox(node.get_child_bbox(i));
+
+        if (foundation::intersect(ray, ray_info, bbox, tmin[i], tmax[i]))
+            mask |= size_t(1) << i;
+    }
+
+    return mask;
+}
+
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+// Single-precision ray, single-precision bounding boxes.
+inline size_t intersect_children(
+    const QNode<float, 3>&  node,
+    const Ray3f&            ray,
+    const RayInfo3f&        ray_info,
+    float                   tmin_out[4],
+    float                   tmax_out[4])
+{
+    const sse4f pos_inf = set1ps(FP<float>::pos_inf());
+    const sse4f neg_inf = set1ps(FP<float>::neg_inf());
+
+    sse4f tmax = pos_inf;
+    sse4f tmin = neg_inf;
+
+    for (size_t d = 0; d < 3; ++d)
+    {
+        const sse4f org = set1ps(ray.m_org[d]);
+        const sse4f rcp_dir = set1ps(ray_info.m_rcp_dir[d]);
+        const sse4f l1 = mulps(rcp_dir, subps(loadups(node.get_child_bbox_min(d)), org));
+        const sse4f l2 = mulps(rcp_dir, subps(loadups(node.get_child_bbox_max(d)), org));
+
+        tmax = minps(maxps(minps(l1, pos_inf), minps(l2, pos_inf)), tmax);
+        tmin = maxps(minps(maxps(l1, neg_inf), maxps(l2, neg_inf)), tmin);
+    }
+
+    const sse4f ray_tmin = set1ps(ray.m_tmin);
+    const sse4f ray_tmax = set1ps(ray.m_tmax);
+
+    const int miss =
+        movemaskps(
+            orps(
+                cmpgtps(tmin, tmax),
+                orps(
+                    cmpltps(tmax, ray_tmin),
+                    cmpgeps(tmin, ray_tmax))));
+
+    storeups(tmin_out, maxps(ray_tmin, tmin));
+    storeups(tmax_out, minps(ray_tmax, tmax));
+
+    return ~static_cast<size_t>(miss) & ((size_t(1) << node.get_child_count()) - 1);
+}
+
+// Double-precision ray, single-precision bounding boxes.
+inline size_t intersect_children(
+    const QNode<float, 3>&  node,
+    const Ray3d&            ray,
+    const RayInfo3d&        ray_info,
+    double                  tmin_out[4],
+    double                  tmax_out[4])
+{
+    const sse2d pos_inf = set1pd(FP<double>::pos_inf());
+    const sse2d neg_inf = set1pd(FP<double>::neg_inf());
+
+    // Children 0-1 and children 2-3 are processed in separate registers.
+    sse2d tmax[2] = { pos_inf, pos_inf };
+    sse2d tmin[2] = { neg_inf, neg_inf };
+
+    for (size_t d = 0; d < 3; ++d)
+    {
+        const sse2d org = set1pd(ray.m_org[d]);
+        const sse2d rcp_dir = set1pd(ray_info.m_rcp_dir[d]);
+
+        const sse4f bbox_min = loadups(node.get_child_bbox_min(d));
+        const sse4f bbox_max = loadups(node.get_child_bbox_max(d));
+
+        const sse2d bbox_min_pd[2] = { _mm_cvtps_pd(bbox_min), _mm_cvtps_pd(_mm_movehl_ps(bbox_min, bbox_min)) };
+        const sse2d bbox_max_pd[2] = { _mm_cvtps_pd(bbox_max), _mm_cvtps_pd(_mm_movehl_ps(bbox_max, bbox_max)) };
+
+        for (size_t h = 0; h < 2; ++h)
+        {
+            const sse2d l1 = mulpd(rcp_dir, subpd(bbox_min_pd[h], org));
+            const sse2d l2 = mulpd(rcp_dir, subpd(bbox_max_pd[h], org));
+
+            tmax[h] = minpd(maxpd(minpd(l1, pos_inf), minpd(l2, pos_inf)), tmax[h]);
+            tmin[h] = maxpd(minpd(maxpd(l1, neg_inf), maxpd(l2, neg_inf)), tmin[h]);
+        }
+    }
+
+    const sse2d ray_tmin = set1pd(ray.m_tmin);
+    const sse2d ray_tmax = set1pd(ray.m_tmax);
+
+    int miss = 0;
+
+    for (size_t h = 0; h < 2; ++h)
+    {
+        miss |=
+            movemaskpd(
+                orpd(
+                    cmpgtpd(tmin[h], tmax[h]),
+                    orpd(
+                        cmpltpd(tmax[h], ray_tmin),
+                        cmpgepd(tmin[h], ray_tmax)))) << (2 * h);
+
+        storeupd(tmin_out + 2 * h, maxpd(ray_tmin, tmin[h]));
+        storeupd(tmax_out + 2 * h, minpd(ray_tmax, tmax[h]));
+    }
+
+    return ~static_cast<size_t>(miss) & ((size_t(1) << node.get_child_count()) - 1);
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
+
+//
+// QIntersector class implementation.
+//
+
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+#define FOUNDATION_BVH_TRAVERSAL_STATS(x) x
+#else
+#define FOUNDATION_BVH_TRAVERSAL_STATS(x)
+#endif
+
+// Intersect a ray with a given QBVH.
+template <
+    typename T,
+    typename Tree,
+    typename Visitor,
+    size_t StackSize
+>
+void QIntersector<T, Tree, Visitor, StackSize>::intersect(
+    const Tree&             tree,
+    const RayType&          ray,
+    const RayInfoType&      ray_info,
+    Visitor&                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , TraversalStatistics&  stats
+#endif
+    ) const
+{
+    assert(!tree.m_qnodes.empty());
+
+    // Handle empty trees.
+    if (tree.size() == 0)
+        return;
+
+    // Check the intersection between the ray and the bounding box of the tree.
+    const AABBType root_bbox = AABBType(tree.get_bbox());
+    ValueType tmin, tmax;
+    if (!foundation::intersect(ray, ray_info, root_bbox, tmin, tmax))
+        return;
+
+    // Initialize traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(++stats.m_traversal_count);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t fetched_nodes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_leaves = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t intersected_items = 0);
+
+    // Initialize the node stack.
+    NodeEntry stack[StackSize];
+    NodeEntry* stack_ptr = stack;
+
+    // Push the root node to the stack.
+    stack_ptr->m_tmin = tmin;
+    stack_ptr->m_tmax = tmax;
+    stack_ptr->m_info = QNodeType::Interior;
+    stack_ptr->m_count = 0;
+    ++stack_ptr;
+
+    // Traverse the tree and intersect leaf nodes.
+    ValueType tfar = ray.m_tmax;
+    while (stack_ptr > stack)
+    {
+        // Pop a node from the stack.
+        --stack_ptr;
+
+        const ValueType tmin = stack_ptr->m_tmin;
+        const ValueType tmax = stack_ptr->m_tmax;
+
+        // Skip nodes that are farther than the closest intersection found so far.
+        if (tmin >= tfar)
+            continue;
+
+        if (stack_ptr->m_info & QNodeType::Interior)
+        {
+            // Fetch the node.
+            FOUNDATION_BVH_TRAVERSAL_STATS(++fetched_nodes);
+            const QNodeType& node = tree.m_qnodes[stack_ptr->m_info & 0x7FFFFFFFUL];
+
+            // Intersect the bounding boxes of all children at once.
+            ValueType child_tmin[QNodeType::Width];
+            ValueType child_tmax[QNodeType::Width];
+            const size_t hit_mask =
+                intersect_children(node, ray, ray_info, child_tmin, child_tmax);
+
+            // Sort the intersected children by decreasing distance.
+            size_t hits[QNodeType::Width];
+            size_t hit_count = 0;
+            for (size_t i = 0; i < node.get_child_count(); ++i)
+            {
+                // Discard the child if it isn't intersected by the ray or if it is
+                // farther than the closest intersection so far.
+                if (!(hit_mask & (size_t(1) << i)) || child_tmin[i] >= tfar)
+                    continue;
+
+                size_t j = hit_count++;
+                for (; j > 0 && child_tmin[hits[j - 1]] < child_tmin[i]; --j)
+                    hits[j] = hits[j - 1];
+                hits[j] = i;
+            }
+
+            assert(stack_ptr + hit_count <= stack + StackSize);
+
+            // Push the intersected children to the stack, the closest one last.
+            for (size_t i = 0; i < hit_count; ++i)
+            {
+                const size_t child = hits[i];
+                stack_ptr->m_tmin = child_tmin[child];
+                stack_ptr->m_tmax = child_tmax[child];
+                stack_ptr->m_info = node.get_child_info(child);
+                stack_ptr->m_count = node.get_child_count_field(child);
+                ++stack_ptr;
+            }
+        }
+        else
+        {
+            const size_t item_begin = static_cast<size_t>(stack_ptr->m_info);
+            const size_t item_end = item_begin + static_cast<size_t>(stack_ptr->m_count);
+            assert(item_begin < item_end);
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(++visited_leaves);
+            FOUNDATION_BVH_TRAVERSAL_STATS(intersected_items += item_end - item_begin);
+
+            // Visit the leaf.
+            ValueType distance;
+#ifndef NDEBUG
+            distance = ValueType(-1.0);
+#endif
+            const bool proceed =
+                visitor.visit(
+                    tree.m_items,
+                    tree.m_bboxes,
+                    item_begin,
+                    item_end,
+                    ray,
+                    ray_info,
+                    tmin,
+                    tmax,
+                    distance);
+            assert(!proceed || distance >= ValueType(0.0));
+
+            // Terminate traversal if the visitor decided so.
+            if (!proceed)
+                break;
+
+            // Keep track of the distance to the closest intersection.
+            if (tfar > distance)
+                tfar = distance;
+        }
+    }
+
+    // Store traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_fetched_nodes.insert(fetched_nodes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_leaves.insert(visited_leaves));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(intersected_items));
+}
+
+#undef FOUNDATION_BVH_TRAVERSAL_STATS
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_QINTERSECTOR_H
@@ -0,0 +1,296 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_QNODE_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_QNODE_H
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Node of a 4-wide BVH (QBVH).
+//
+// A node stores the bounding boxes of its (up to) four children in
+// structure-of-arrays form so that all four of them can be tested
+// against a ray with a single SIMD slab test. Children are either
+// interior children (referencing another node) or leaf children
+// (referencing a range of items).
+//
+
+template <typename T, size_t N>
+class QNode
+{
+  public:
+    // Value type and dimension.
+    typedef T ValueType;
+    static const size_t Dimension = N;
+
+    // Maximum number of children of a node.
+    static const size_t Width = 4;
+
+    // AABB type.
+    typedef AABB<T, N> AABBType;
+
+    // Child types.
+    typedef uint32 Type;
+    static const Type Leaf     = 0x00000000UL;
+    static const Type Interior = 0x80000000UL;
+
+    // Set/get the number of children of this node.
+    void set_child_count(const size_t count);
+    size_t get_child_count() const;
+
+    // Set/get the bounding box of a given child.
+    void set_child_bbox(const size_t child, const AABBType& bbox);
+    AABBType get_child_bbox(const size_t child) const;
+
+    // Access the bounding box coordinates of all children along a given dimension.
+    const T* get_child_bbox_min(const size_t dim) const;
+    const T* get_child_bbox_max(const size_t dim) const;
+
+    // Set/get the type of a given child.
+    void set_child_type(const size_t child, const Type type);
+    Type get_child_type(const size_t child) const;
+    bool is_interior_child(const size_t child) const;
+    bool is_leaf_child(const size_t child) const;
+
+    // Set/get the node index of a given child (interior children only).
+    void set_child_node_index(const size_t child, const size_t index);
+    size_t get_child_node_index(const size_t child) const;
+
+    // Set/get the item index of a given child (leaf children only).
+    void set_child_item_index(const size_t child, const size_t index);
+    size_t get_child_item_index(const size_t child) const;
+
+    // Set/get the item count of a given child (leaf children only).
+    void set_child_item_count(const size_t child, const size_t count);
+    size_t get_child_item_count(const size_t child) const;
+
+    // Return the raw info and count fields of a given child.
+    uint32 get_child_info(const size_t child) const;
+    uint32 get_child_count_field(const size_t child) const;
+
+  private:
+
+    //
+    // The info field of each child is organized as follow:
+    //
+    //   interior child:
+    //
+    //     bits 0-30    node index
+    //     bit  31      child type (1 for interior child)
+    //
+    //   leaf child:
+    //
+    //     bits 0-30    item index
+    //     bit  31      child type (0 for leaf child)
+    //
+
+    ALIGN_SSE_VARIABLE
+    T           m_bbox_min[N][Width];
+    T           m_bbox_max[N][Width];
+    uint32      m_info[Width];
+    uint32      m_count[Width];
+    uint32      m_child_count;
+};
+
+
+//
+// QNode class implementation.
+//
+
+// Set/get the number of children of this node.
+template <typename T, size_t N>
+inline void QNode<T, N>::set_child_count(const size_t count)
+{
+    assert(count >= 1 && count <= Width);
+    m_child_count = static_cast<uint32>(count);
+
+    // Unused child slots get an empty bounding box.
+    for (size_t c = count; c < Width; ++c)
+    {
+        for (size_t d = 0; d < N; ++d)
+        {
+            m_bbox_min[d][c] = T(0.0);
+            m_bbox_max[d][c] = T(0.0);
+        }
+
+        m_info[c] = 0;
+        m_count[c] = 0;
+    }
+}
+template <typename T, size_t N>
+inline size_t QNode<T, N>::get_child_count() const
+{
+    return static_cast<size_t>(m_child_count);
+}
+
+// Set/get the bounding box of a given child.
+template <typename T, size_t N>
+inline void QNode<T, N>::set_child_bbox(const size_t child, const AABBType& bbox)
+{
+    assert(child < Width);
+
+    for (size_t d = 0; d < N; ++d)
+    {
+        m_bbox_min[d][child] = bbox.min[d];
+        m_bbox_max[d][child] = bbox.max[d];
+    }
+}
+template <typename T, size_t N>
+inline AABB<T, N> QNode<T, N>::get_child_bbox(const size_t child) const
+{
+    assert(child < Width);
+
+    AABBType bbox;
+
+    for (size_t d = 0; d < N; ++d)
+    {
+        bbox.min[d] = m_bbox_min[d][child];
+        bbox.max[d] = m_bbox_max[d][child];
+    }
+
+    return bbox;
+}
+
+// Access the bounding box coordinates of all children along a given dimension.
+template <typename T, size_t N>
+inline const T* QNode<T, N>::get_child_bbox_min(const size_t dim) const
+{
+    assert(dim < N);
+    return m_bbox_min[dim];
+}
+template <typename T, size_t N>
+inline const T* QNode<T, N>::get_child_bbox_max(const size_t dim) const
+{
+    assert(dim < N);
+    return m_bbox_max[dim];
+}
+
+// Set/get the type of a given child.
+template <typename T, size_t N>
+inline void QNode<T, N>::set_child_type(const size_t child, const Type type)
+{
+    assert(child < Width);
+    assert(type == Leaf || type == Interior);
+    m_info[child] &= 0x7FFFFFFFUL;
+    m_info[child] |= type;
+}
+template <typename T, size_t N>
+inline typename QNode<T, N>::Type QNode<T, N>::get_child_type(const size_t child) const
+{
+    assert(child < Width);
+    return static_cast<Type>(m_info[child] & 0x80000000UL);
+}
+template <typename T, size_t N>
+inline bool QNode<T, N>::is_interior_child(const size_t child) const
+{
+    assert(child < Width);
+    return (m_info[child] & 0x80000000UL) != 0;
+}
+template <typename T, size_t N>
+inline bool QNode<T, N>::is_leaf_child(const size_t child) const
+{
+    assert(child < Width);
+    return (m_info[child] & 0x80000000UL) == 0;
+}
+
+// Set/get the node index of a given child (interior children only).
+template <typename T, size_t N>
+inline void QNode<T, N>::set_child_node_index(const size_t child, const size_t index)
+{
+    assert(child < Width);
+    assert(index < (1UL << 31));
+    m_info[child] &= 0x80000000UL;
+    m_info[child] |= static_cast<uint32>(index);
+}
+template <typename T, size_t N>
+inline size_t QNode<T, N>::get_child_node_index(const size_t child) const
+{
+    assert(child < Width);
+    return static_cast<size_t>(m_info[child] & 0x7FFFFFFFUL);
+}
+
+// Set/get the item index of a given child (leaf children only).
+template <typename T, size_t N>
+inline void QNode<T, N>::set_child_item_index(const size_t child, const size_t index)
+{
+    assert(child < Width);
+    assert(index < (1UL << 31));
+    m_info[child] &= 0x80000000UL;
+    m_info[child] |= static_cast<uint32>(index);
+}
+template <typename T, size_t N>
+inline size_t QNode<T, N>::get_child_item_index(const size_t child) const
+{
+    assert(child < Width);
+    return static_cast<size_t>(m_info[child] & 0x7FFFFFFFUL);
+}
+
+// Set/get the item count of a given child (leaf children only).
+template <typename T, size_t N>
+inline void QNode<T, N>::set_child_item_count(const size_t child, const size_t count)
+{
+    assert(child < Width);
+    assert(count <= 0xFFFFFFFFUL);
+    m_count[child] = static_cast<uint32>(count);
+}
+template <typename T, size_t N>
+inline size_t QNode<T, N>::get_child_item_count(const size_t child) const
+{
+    assert(child < Width);
+    return static_cast<size_t>(m_count[child]);
+}
+
+// Return the raw info and count fields of a given child.
+template <typename T, size_t N>
+inline uint32 QNode<T, N>::get_child_info(const size_t child) const
+{
+    assert(child < Width);
+    return m_info[child];
+}
+template <typename T, size_t N>
+inline uint32 QNode<T, N>::get_child_count_field(const size_t child) const
+{
+    assert(child < Width);
+    return m_count[child];
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_QNODE_H
@@ -0,0 +1,123 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_QTREE_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_QTREE_H
+
+// appleseed.foundation headers.
+#include "foundation/math/bvh/bvh_qnode.h"
+#include "foundation/math/bvh/bvh_tree.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace foundation {
+namespace bvh {
+
+//
+// 4-wide Bounding Volume Hierarchy (QBVH).
+//
+// A QBVH is first built as a regular binary BVH (using bvh::Builder),
+// then collapsed into a 4-wide hierarchy (using bvh::QBuilder).
+// The binary nodes are kept around so that the tree can still be
+// traversed with bvh::Intersector and analyzed with bvh::TreeStatistics.
+//
+
+template <typename T, size_t N, typename Item>
+class QTree
+  : public Tree<T, N, Item>
+{
+  public:
+    // Types.
+    typedef Tree<T, N, Item> BinaryTreeType;
+    typedef QTree<T, N, Item> TreeType;
+    typedef QNode<T, N> QNodeType;
+
+    // Constructor.
+    QTree();
+
+    // Clear the tree.
+    void clear();
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+  protected:
+    template <
+        typename Tree,
+        typename Timer
+    >
+    friend class QBuilder;
+
+    template <
+        typename T_,
+        typename Tree,
+        typename Visitor,
+        size_t StackSize
+    >
+    friend class QIntersector;
+
+    typedef std::vector<QNodeType> QNodeVector;
+
+    QNodeVector m_qnodes;       // 4-wide nodes of the tree
+};
+
+
+//
+// QTree class implementation.
+//
+
+// Constructor.
+template <typename T, size_t N, typename Item>
+QTree<T, N, Item>::QTree()
+{
+}
+
+// Clear the tree.
+template <typename T, size_t N, typename Item>
+void QTree<T, N, Item>::clear()
+{
+    BinaryTreeType::clear();
+    m_qnodes.clear();
+}
+
+// Return the size (in bytes) of this object in memory.
+template <typename T, size_t N, typename Item>
+size_t QTree<T, N, Item>::get_memory_size() const
+{
+    size_t mem_size = BinaryTreeType::get_memory_size();
+    mem_size += sizeof(*this) - sizeof(BinaryTreeType);
+    mem_size += m_qnodes.capacity() * sizeof(QNodeType);
+    return mem_size;
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_QTREE_H
@@ -32,6 +32,9 @@
 // appleseed.foundation headers.
 #include "foundation/platform/types.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace foundation
 {
 
@@ -77,6 +80,22 @@ uint32 mix32(
     const uint32 d);
 
 
+//
+// Byte sequence hash functions.
+//
+
+// Initial value for hash_bytes64().
+const uint64 HashBytes64Init = 0xCBF29CE484222325LL;
+
+// Hash a sequence of bytes to a 64-bit integer (64-bit FNV-1a). Several
+// sequences can be hashed together by passing the result of the previous
+// call as the initial value of the next call.
+uint64 hash_bytes64(
+    const void*     bytes,
+    const size_t    size,
+    const uint64    initial = HashBytes64Init);
+
+
 //
 // Integer hash functions implementation.
 //
@@ -158,6 +177,28 @@ inline uint32 mix32(
     return h3;
 }
 
+
+//
+// Byte sequence hash functions implementation.
+//
+
+inline uint64 hash_bytes64(
+    const void*     bytes,
+    const size_t    size,
+    const uint64    initial)
+{
+    const uint8* p = static_cast<const uint8*>(bytes);
+    uint64 h = initial;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= p[i];
+        h *= 0x00000100000001B3LL;
+    }
+
+    return h;
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MATH_HASH_H
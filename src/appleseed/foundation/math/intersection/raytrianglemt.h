@@ -33,6 +33,14 @@
 #include "foundation/math/ray.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
 
 namespace foundation
 {
@@ -45,6 +53,8 @@ namespace foundation
 //   http://jgt.akpeters.com/papers/MollerTrumbore97/
 //
 
+template <typename T> struct TriangleMTRayPacket;
+
 template <typename T>
 struct TriangleMT
 {
@@ -78,6 +88,44 @@ struct TriangleMT
         ValueType&          v) const;
 
     bool intersect(const RayType& ray) const;
+
+    // Intersect a packet of rays with the triangle. Only the rays whose bit is
+    // set in 'ray_mask' are considered. Return the bit mask of the rays that hit
+    // the triangle; 't', 'u' and 'v' are only meaningful for these rays.
+    uint32 intersect(
+        const TriangleMTRayPacket<T>&   packet,
+        const uint32                    ray_mask,
+        ValueType                       t[],
+        ValueType                       u[],
+        ValueType                       v[]) const;
+};
+
+//
+// A packet of rays stored in structure-of-arrays layout, as expected by the
+// packet variant of TriangleMT::intersect().
+//
+
+template <typename T>
+struct TriangleMTRayPacket
+{
+    // Types.
+    typedef T ValueType;
+    typedef Ray<T, 3> RayType;
+
+    // Number of rays in a packet.
+    static const size_t Size = 4;
+
+    ALIGN_SSE_VARIABLE
+    ValueType   m_org[3][Size];
+    ValueType   m_dir[3][Size];
+    ValueType   m_tmin[Size];
+    ValueType   m_tmax[Size];
+
+    // Store a ray in a given slot of the packet.
+    void set(const size_t index, const RayType& ray);
+
+    // Retrieve the ray stored in a given slot of the packet.
+    RayType get(const size_t index) const;
 };
 
 template <typename T>
@@ -255,6 +303,165 @@ FORCE_INLINE bool TriangleMT<T>::intersect(const RayType& ray) const
     return true;
 }
 
+template <typename T>
+inline uint32 TriangleMT<T>::intersect(
+    const TriangleMTRayPacket<T>&   packet,
+    const uint32                    ray_mask,
+    ValueType                       t[],
+    ValueType                       u[],
+    ValueType                       v[]) const
+{
+    uint32 hit_mask = 0;
+
+    for (size_t i = 0; i < TriangleMTRayPacket<T>::Size; ++i)
+    {
+        if ((ray_mask & (1UL << i)) && intersect(packet.get(i), t[i], u[i], v[i]))
+            hit_mask |= 1UL << i;
+    }
+
+    return hit_mask;
+}
+
+#ifdef APPLESEED_FOUNDATION_USE_SSE
+
+//
+// SSE2 implementation of the packet test, two rays at a time.
+//
+// The comparisons are made branch-free by flipping the sign of u, v and t
+// according to the sign of the determinant; since negation is exact, the
+// results are identical to the ones of the single-ray test.
+//
+
+template <>
+FORCE_INLINE uint32 TriangleMT<double>::intersect(
+    const TriangleMTRayPacket<double>&  packet,
+    const uint32                        ray_mask,
+    double                              t[],
+    double                              u[],
+    double                              v[]) const
+{
+    const sse2d zero = set1pd(0.0);
+    const sse2d sign_mask = set1pd(-0.0);
+
+    const sse2d v0x = set1pd(m_v0.x);
+    const sse2d v0y = set1pd(m_v0.y);
+    const sse2d v0z = set1pd(m_v0.z);
+    const sse2d e0x = set1pd(m_e0.x);
+    const sse2d e0y = set1pd(m_e0.y);
+    const sse2d e0z = set1pd(m_e0.z);
+    const sse2d e1x = set1pd(m_e1.x);
+    const sse2d e1y = set1pd(m_e1.y);
+    const sse2d e1z = set1pd(m_e1.z);
+
+    uint32 hit_mask = 0;
+
+    for (size_t i = 0; i < TriangleMTRayPacket<double>::Size; i += 2)
+    {
+        if ((ray_mask & (3UL << i)) == 0)
+            continue;
+
+        const sse2d dx = loadpd(&packet.m_dir[0][i]);
+        const sse2d dy = loadpd(&packet.m_dir[1][i]);
+        const sse2d dz = loadpd(&packet.m_dir[2][i]);
+
+        // Calculate determinant.
+        const sse2d px = subpd(mulpd(dy, e1z), mulpd(e1y, dz));
+        const sse2d py = subpd(mulpd(dz, e1x), mulpd(e1z, dx));
+        const sse2d pz = subpd(mulpd(dx, e1y), mulpd(e1x, dy));
+        const sse2d det = addpd(addpd(mulpd(e0x, px), mulpd(e0y, py)), mulpd(e0z, pz));
+
+        // Calculate distance from v0 to ray origin.
+        const sse2d tx = subpd(loadpd(&packet.m_org[0][i]), v0x);
+        const sse2d ty = subpd(loadpd(&packet.m_org[1][i]), v0y);
+        const sse2d tz = subpd(loadpd(&packet.m_org[2][i]), v0z);
+
+        // Calculate u parameter.
+        const sse2d uu = addpd(addpd(mulpd(tx, px), mulpd(ty, py)), mulpd(tz, pz));
+
+        // Calculate v parameter.
+        const sse2d qx = subpd(mulpd(ty, e0z), mulpd(e0y, tz));
+        const sse2d qy = subpd(mulpd(tz, e0x), mulpd(e0z, tx));
+        const sse2d qz = subpd(mulpd(tx, e0y), mulpd(e0x, ty));
+        const sse2d vv = addpd(addpd(mulpd(dx, qx), mulpd(dy, qy)), mulpd(dz, qz));
+
+        // Calculate t parameter.
+        const sse2d tt = addpd(addpd(mulpd(e1x, qx), mulpd(e1y, qy)), mulpd(e1z, qz));
+
+        // Flip signs so that all the tests can be written for a positive determinant.
+        const sse2d det_sign = andpd(det, sign_mask);
+        const sse2d abs_det = xorpd(det, det_sign);
+        const sse2d su = xorpd(uu, det_sign);
+        const sse2d sv = xorpd(vv, det_sign);
+        const sse2d suv = xorpd(addpd(uu, vv), det_sign);
+        const sse2d st = xorpd(tt, det_sign);
+
+        // Test bounds.
+        const sse2d tmin = mulpd(loadpd(&packet.m_tmin[i]), abs_det);
+        const sse2d tmax = mulpd(loadpd(&packet.m_tmax[i]), abs_det);
+        const sse2d hit =
+            andpd(
+                andpd(
+                    andpd(cmpgepd(su, zero), cmplepd(su, abs_det)),
+                    andpd(cmpgepd(sv, zero), cmplepd(suv, abs_det))),
+                andpd(cmpltpd(st, tmax), cmpgepd(st, tmin)));
+
+        const uint32 pair_mask = (static_cast<uint32>(movemaskpd(hit)) << i) & ray_mask;
+
+        if (pair_mask)
+        {
+            // Scale parameters.
+            const sse2d rcp_det = divpd(set1pd(1.0), det);
+            storeupd(&t[i], mulpd(tt, rcp_det));
+            storeupd(&u[i], mulpd(uu, rcp_det));
+            storeupd(&v[i], mulpd(vv, rcp_det));
+            hit_mask |= pair_mask;
+        }
+    }
+
+    return hit_mask;
+}
+
+#endif  // APPLESEED_FOUNDATION_USE_SSE
+
+
+//
+// TriangleMTRayPacket class implementation.
+//
+
+template <typename T>
+inline void TriangleMTRayPacket<T>::set(const size_t index, const RayType& ray)
+{
+    assert(index < Size);
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        m_org[i][index] = ray.m_org[i];
+        m_dir[i][index] = ray.m_dir[i];
+    }
+
+    m_tmin[index] = ray.m_tmin;
+    m_tmax[index] = ray.m_tmax;
+}
+
+template <typename T>
+inline Ray<T, 3> TriangleMTRayPacket<T>::get(const size_t index) const
+{
+    assert(index < Size);
+
+    RayType ray;
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        ray.m_org[i] = m_org[i][index];
+        ray.m_dir[i] = m_dir[i][index];
+    }
+
+    ray.m_tmin = m_tmin[index];
+    ray.m_tmax = m_tmax[index];
+
+    return ray;
+}
+
 
 //
 // TriangleMTSupportPlane class implementation.
@@ -30,7 +30,9 @@
 #define APPLESEED_FOUNDATION_MATH_QMC_H
 
 // appleseed.foundation headers.
+#include "foundation/math/hash.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cassert>
@@ -50,7 +52,7 @@ namespace foundation
 //   implement specializations of Halton and Hammersley sequences generators for bases (2,3).
 //   implement incremental radical inverse (for successive input values).
 //   implement vectorized radical inverse functions with SSE2.
-//   implement Sobol sequence generator.
+//   implement Sobol sequence generator for more than two dimensions.
 //
 
 
@@ -169,6 +171,59 @@ Vector<T, Dim> hammersley_zaremba_sequence(
     const size_t        count);         // total number of samples in sequence
 
 
+//
+// Sobol (0,2)-sequence with hash-based Owen scrambling.
+//
+// The first two dimensions of the Sobol sequence form a (0,2)-sequence in base 2:
+// any aligned block of 2^m consecutive points has exactly one point in each of the
+// elementary intervals of area 2^-m of the unit square. Nested uniform (Owen)
+// scrambling preserves this property while producing independent randomizations
+// of the sequence; it is approximated here by the Laine-Karras hash. Scrambling
+// the index as well shuffles the order of the points within aligned blocks.
+//
+// References:
+//
+//   Laine and Karras, Stratified Sampling for Stochastic Transparency
+//   http://www.tml.tkk.fi/~samuli/publications/laine2011egsr_paper.pdf
+//
+//   Burley, Practical Hash-based Owen Scrambling
+//   http://jcgt.org/published/0009/04/01/
+//
+// All return values are in the interval [0, 1)^2.
+//
+
+// Reverse the order of the bits of a 32-bit integer.
+uint32 reverse_bits(uint32 n);
+
+// Hash-based permutation of 32-bit integers where each bit of the result only
+// depends on the bits of equal or lesser significance of the input.
+uint32 laine_karras_permutation(
+    const uint32        seed,           // permutation seed
+    uint32              x);             // input value
+
+// Nested uniform scrambling of the base-2 digits of a 32-bit fixed point value.
+uint32 owen_scramble_base2(
+    const uint32        seed,           // scrambling seed
+    uint32              x);             // 32-bit fixed point value in [0, 1)
+
+// Return the n'th sample of the Sobol (0,2)-sequence as 32-bit fixed point values.
+void sobol02_sequence_base2(
+    uint32              n,              // input digits
+    uint32&             x,              // first dimension
+    uint32&             y);             // second dimension
+
+// Return the n'th sample of the Sobol (0,2)-sequence.
+template <typename T>
+Vector<T, 2> sobol02_sequence(
+    const uint32        n);             // input digits
+
+// Return the n'th sample of the Sobol (0,2)-sequence with Owen scrambling.
+template <typename T>
+Vector<T, 2> owen_scrambled_sobol02_sequence(
+    const uint32        seed,           // scrambling seed
+    const uint32        n);             // input digits
+
+
 
 //
 // Base-2 radical inverse functions implementation.
@@ -448,6 +503,115 @@ inline Vector<T, Dim> hammersley_zaremba_sequence(
     return p;
 }
 
+
+//
+// Sobol (0,2)-sequence implementation.
+//
+
+inline uint32 reverse_bits(uint32 n)
+{
+    n = (n >> 16) | (n << 16);      // 16-bit swap
+    n = ((n & 0xFF00FF00) >> 8) |
+        ((n & 0x00FF00FF) << 8);    // 8-bit swap
+    n = ((n & 0xF0F0F0F0) >> 4) |
+        ((n & 0x0F0F0F0F) << 4);    // 4-bit swap
+    n = ((n & 0xCCCCCCCC) >> 2) |
+        ((n & 0x33333333) << 2);    // 2-bit swap
+    n = ((n & 0xAAAAAAAA) >> 1) |
+        ((n & 0x55555555) << 1);    // 1-bit swap
+
+    return n;
+}
+
+inline uint32 laine_karras_permutation(
+    const uint32        seed,
+    uint32              x)
+{
+    // Multiplications by even constants only propagate bits upward.
+    x += seed;
+    x ^= x * 0x6C50B47Cu;
+    x ^= x * 0xB82F1E52u;
+    x ^= x * 0xC7AFE638u;
+    x ^= x * 0x8D22F6E6u;
+
+    return x;
+}
+
+inline uint32 owen_scramble_base2(
+    const uint32        seed,
+    uint32              x)
+{
+    // Applying the Laine-Karras permutation to the reversed digits makes each
+    // digit of x depend on the more significant digits only, which is exactly
+    // what nested uniform scrambling does.
+    return reverse_bits(laine_karras_permutation(seed, reverse_bits(x)));
+}
+
+namespace impl
+{
+    // Multiply the bits of n by the Pascal matrix modulo 2. By Lucas' theorem,
+    // bit j of the result is the XOR of the bits i of n such that j is a subset
+    // of i, which is computed in log2(32) steps instead of one per bit of n.
+    inline uint32 pascal_matrix_base2(uint32 n)
+    {
+        n ^= (n >> 1) & 0x55555555;
+        n ^= (n >> 2) & 0x33333333;
+        n ^= (n >> 4) & 0x0F0F0F0F;
+        n ^= (n >> 8) & 0x00FF00FF;
+        n ^= (n >> 16) & 0x0000FFFF;
+
+        return n;
+    }
+}
+
+inline void sobol02_sequence_base2(
+    uint32              n,
+    uint32&             x,
+    uint32&             y)
+{
+    // The first dimension is the radical inverse in base 2, the generator
+    // matrix of the second dimension is the Pascal matrix modulo 2.
+    x = reverse_bits(n);
+    y = reverse_bits(impl::pascal_matrix_base2(n));
+}
+
+template <typename T>
+inline Vector<T, 2> sobol02_sequence(
+    const uint32        n)
+{
+    uint32 x, y;
+    sobol02_sequence_base2(n, x, y);
+
+    return
+        Vector<T, 2>(
+            static_cast<T>(x) / static_cast<T>(0x100000000LL),
+            static_cast<T>(y) / static_cast<T>(0x100000000LL));
+}
+
+template <typename T>
+inline Vector<T, 2> owen_scrambled_sobol02_sequence(
+    const uint32        seed,
+    const uint32        n)
+{
+    // Derive independent seeds for the index and for both dimensions.
+    const uint32 seed_index = hashint32(seed);
+    const uint32 seed_x = hashint32(seed_index);
+    const uint32 seed_y = hashint32(seed_x);
+
+    // Shuffle the points within aligned blocks of the sequence.
+    const uint32 index = owen_scramble_base2(seed_index, n);
+
+    // Scramble both dimensions; the bit reversals of the radical inverse and
+    // of the scrambling cancel out.
+    const uint32 x = reverse_bits(laine_karras_permutation(seed_x, index));
+    const uint32 y = reverse_bits(laine_karras_permutation(seed_y, impl::pascal_matrix_base2(index)));
+
+    return
+        Vector<T, 2>(
+            static_cast<T>(x) / static_cast<T>(0x100000000LL),
+            static_cast<T>(y) / static_cast<T>(0x100000000LL));
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MATH_QMC_H
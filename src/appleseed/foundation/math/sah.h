@@ -139,10 +139,13 @@ class ExactSAHFunction
 
 
 //
-// Surface Area Heuristic (SAH) function, approximate version.
+// Surface Area Heuristic (SAH) function, approximate (binned) version.
+//
+// MaxBinCount is the capacity of the function; the number of bins
+// actually used can be chosen at construction time.
 //
 
-template <typename T, size_t BinCount>
+template <typename T, size_t MaxBinCount>
 class ApproxSAHFunction
   : public NonCopyable
 {
@@ -154,7 +157,8 @@ class ApproxSAHFunction
     // minimize() will never report them as valid abscissas.
     ApproxSAHFunction(
         const ValueType domain_begin,
-        const ValueType domain_end);
+        const ValueType domain_end,
+        const size_t    bin_count = MaxBinCount);
 
     // Insert an interval into the function.
     void insert(
@@ -184,11 +188,12 @@ class ApproxSAHFunction
         size_t  m_leave;
     };
 
+    const size_t        m_bin_count;
     const ValueType     m_domain_begin;
     const ValueType     m_domain_end;
     const ValueType     m_domain_length;
     const ValueType     m_domain_scale;
-    Event               m_events[BinCount];
+    Event               m_events[MaxBinCount];
     size_t              m_initial_left_count;
     size_t              m_interval_count;
 };
@@ -414,19 +419,23 @@ void ExactSAHFunction<T>::visit(
 //
 
 // Constructor.
-template <typename T, size_t BinCount>
-ApproxSAHFunction<T, BinCount>::ApproxSAHFunction(
+template <typename T, size_t MaxBinCount>
+ApproxSAHFunction<T, MaxBinCount>::ApproxSAHFunction(
     const ValueType domain_begin,
-    const ValueType domain_end)
-  : m_domain_begin(domain_begin)
+    const ValueType domain_end,
+    const size_t    bin_count)
+  : m_bin_count(bin_count)
+  , m_domain_begin(domain_begin)
   , m_domain_end(domain_end)
   , m_domain_length(m_domain_end - m_domain_begin)
-  , m_domain_scale(static_cast<ValueType>(BinCount + 1) / m_domain_length)
+  , m_domain_scale(static_cast<ValueType>(bin_count + 1) / m_domain_length)
   , m_initial_left_count(0)
   , m_interval_count(0)
 {
+    assert(m_bin_count > 0);
+    assert(m_bin_count <= MaxBinCount);
     assert(m_domain_begin < m_domain_end);
-    for (size_t i = 0; i < BinCount; ++i)
+    for (size_t i = 0; i < m_bin_count; ++i)
     {
         m_events[i].m_enter = 0;
         m_events[i].m_leave = 0;
@@ -434,8 +443,8 @@ ApproxSAHFunction<T, BinCount>::ApproxSAHFunction(
 }
 
 // Insert an interval into the function.
-template <typename T, size_t BinCount>
-inline void ApproxSAHFunction<T, BinCount>::insert(
+template <typename T, size_t MaxBinCount>
+inline void ApproxSAHFunction<T, MaxBinCount>::insert(
     const ValueType interval_begin,
     const ValueType interval_end)
 {
@@ -450,7 +459,7 @@ inline void ApproxSAHFunction<T, BinCount>::insert(
     {
         const ValueType x = interval_begin - m_domain_begin;
         const size_t bin = truncate<size_t>(x * m_domain_scale);
-        if (bin < BinCount)
+        if (bin < m_bin_count)
             ++m_events[bin].m_enter;
     }
     else ++m_initial_left_count;
@@ -460,7 +469,7 @@ inline void ApproxSAHFunction<T, BinCount>::insert(
     {
         const ValueType x = interval_end - m_domain_begin;
         const size_t bin = truncate<size_t>(x * m_domain_scale);
-        if (bin < BinCount)
+        if (bin < m_bin_count)
             ++m_events[bin].m_leave;
     }
 
@@ -468,8 +477,8 @@ inline void ApproxSAHFunction<T, BinCount>::insert(
 }
 
 // Find the abscissa with the smallest cost, with respect to the SAH.
-template <typename T, size_t BinCount>
-void ApproxSAHFunction<T, BinCount>::minimize(
+template <typename T, size_t MaxBinCount>
+void ApproxSAHFunction<T, MaxBinCount>::minimize(
     const AABBType& bbox,
     const size_t    dimension,
     ValueType&      min_cost,
@@ -483,9 +492,9 @@ void ApproxSAHFunction<T, BinCount>::minimize(
     size_t left_count = m_initial_left_count;
     size_t right_count = m_interval_count;
 
-    const ValueType scale = m_domain_length / (BinCount + 1);
+    const ValueType scale = m_domain_length / (m_bin_count + 1);
 
-    for (size_t i = 0; i < BinCount; ++i)
+    for (size_t i = 0; i < m_bin_count; ++i)
     {
         // Compute the left and right lengths.
         const ValueType left_length = static_cast<ValueType>(i + 1) * scale;
@@ -522,9 +531,9 @@ void ApproxSAHFunction<T, BinCount>::minimize(
 }
 
 // Visit the SAH function, useful for debugging.
-template <typename T, size_t BinCount>
+template <typename T, size_t MaxBinCount>
 template <typename Visitor>
-void ApproxSAHFunction<T, BinCount>::visit(
+void ApproxSAHFunction<T, MaxBinCount>::visit(
     const AABBType& bbox,
     const size_t    dimension,
     Visitor&        visitor) const
@@ -534,9 +543,9 @@ void ApproxSAHFunction<T, BinCount>::visit(
     size_t left_count = m_initial_left_count;
     size_t right_count = m_interval_count;
 
-    const ValueType scale = m_domain_length / (BinCount + 1);
+    const ValueType scale = m_domain_length / (m_bin_count + 1);
 
-    for (size_t i = 0; i < BinCount; ++i)
+    for (size_t i = 0; i < m_bin_count; ++i)
     {
         // Compute the left and right lengths.
         const ValueType left_length = static_cast<ValueType>(i + 1) * scale;
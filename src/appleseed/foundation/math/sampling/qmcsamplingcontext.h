@@ -30,11 +30,13 @@
 #define APPLESEED_FOUNDATION_MATH_SAMPLING_QMCSAMPLINGCONTEXT_H
 
 // appleseed.foundation headers.
+#include "foundation/math/hash.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/primes.h"
 #include "foundation/math/qmc.h"
 #include "foundation/math/rng.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/test/helpers.h"
 
 // Standard headers.
@@ -58,11 +60,18 @@ namespace foundation
 //   - Cranley-Patterson rotation
 //   - Monte Carlo padding
 //
-// Reference:
+// or, alternatively, on the Sobol (0,2)-sequence with hash-based Owen scrambling,
+// padded by scrambling each pair of dimensions independently. The (0,2)-sequence
+// is best stratified when sample counts are powers of two.
+//
+// References:
 //
 //   Kollig and Keller, Efficient Multidimensional Sampling
 //   www.uni-kl.de/AG-Heinrich/EMS.pdf
 //
+//   Burley, Practical Hash-based Owen Scrambling
+//   http://jcgt.org/published/0009/04/01/
+//
 
 template <typename RNG>
 class QMCSamplingContext
@@ -73,13 +82,23 @@ class QMCSamplingContext
 
     typedef Vector<double, 4> VectorType;
 
+    // Low discrepancy sequence used to generate the samples.
+    enum Mode
+    {
+        HaltonMode,                         // scrambled and rotated Halton sequence
+        SobolMode                           // Owen-scrambled Sobol (0,2)-sequence
+    };
+
     // Constructors.
-    explicit QMCSamplingContext(RNG& rng);
+    explicit QMCSamplingContext(
+        RNG&            rng,
+        const Mode      mode = HaltonMode);
     QMCSamplingContext(
         RNG&            rng,
         const size_t    dimension,
         const size_t    sample_count,
-        const size_t    instance = 0);
+        const size_t    instance = 0,
+        const Mode      mode = HaltonMode);
 
     // Assignment operator.
     QMCSamplingContext& operator=(const QMCSamplingContext& rhs);
@@ -118,6 +137,9 @@ class QMCSamplingContext
     // Return the total instance number of this sampler.
     size_t get_total_instance() const;
 
+    // Return the low discrepancy sequence used by this sampler.
+    Mode get_mode() const;
+
   private:
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, InitialStateIsCorrect);
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestAssignmentOperator);
@@ -125,6 +147,7 @@ class QMCSamplingContext
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Math_Sampling_QMCSamplingContext, TestDoubleSplitting);
 
     RNG&        m_rng;
+    Mode        m_mode;
 
     size_t      m_base_dimension;
     size_t      m_base_instance;
@@ -137,6 +160,7 @@ class QMCSamplingContext
 
     QMCSamplingContext(
         RNG&                rng,
+        const Mode          mode,
         const size_t        base_dimension,
         const size_t        base_instance,
         const size_t        dimension,
@@ -144,6 +168,12 @@ class QMCSamplingContext
 
     void compute_offset();
 
+    template <size_t N>
+    Vector<double, N> next_vector2_halton();
+
+    template <size_t N>
+    Vector<double, N> next_vector2_sobol();
+
     // Cranley-Patterson rotation.
     static double rotate(double x, const double offset);
 };
@@ -154,8 +184,11 @@ class QMCSamplingContext
 //
 
 template <typename RNG>
-inline QMCSamplingContext<RNG>::QMCSamplingContext(RNG& rng)
+inline QMCSamplingContext<RNG>::QMCSamplingContext(
+    RNG&                rng,
+    const Mode          mode)
   : m_rng(rng)
+  , m_mode(mode)
   , m_base_dimension(0)
   , m_base_instance(0)
   , m_dimension(0)
@@ -170,8 +203,10 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
     RNG&                rng,
     const size_t        dimension,
     const size_t        sample_count,
-    const size_t        instance)
+    const size_t        instance,
+    const Mode          mode)
   : m_rng(rng)
+  , m_mode(mode)
   , m_base_dimension(0)
   , m_base_instance(0)
   , m_dimension(dimension)
@@ -185,11 +220,13 @@ inline QMCSamplingContext<RNG>::QMCSamplingContext(
 template <typename RNG>
 inline QMCSamplingContext<RNG>::QMCSamplingContext(
     RNG&                rng,
+    const Mode          mode,
     const size_t        base_dimension,
     const size_t        base_instance,
     const size_t        dimension,
     const size_t        sample_count)
   : m_rng(rng)
+  , m_mode(mode)
   , m_base_dimension(base_dimension)
   , m_base_instance(base_instance)
   , m_dimension(dimension)
@@ -205,6 +242,7 @@ template <typename RNG> inline
 QMCSamplingContext<RNG>&
 QMCSamplingContext<RNG>::operator=(const QMCSamplingContext& rhs)
 {
+    m_mode = rhs.m_mode;
     m_base_dimension = rhs.m_base_dimension;
     m_base_instance = rhs.m_base_instance;
     m_dimension = rhs.m_dimension;
@@ -222,6 +260,7 @@ inline QMCSamplingContext<RNG> QMCSamplingContext<RNG>::split(
     return
         QMCSamplingContext(
             m_rng,
+            m_mode,
             m_base_dimension + m_dimension,         // dimension allocation
             m_base_instance + m_instance,           // decorrelation by generalization
             dimension,
@@ -248,6 +287,10 @@ inline void QMCSamplingContext<RNG>::split_in_place(
 template <typename RNG>
 inline void QMCSamplingContext<RNG>::compute_offset()
 {
+    // Scrambled Sobol sequences need no rotation.
+    if (m_mode == SobolMode)
+        return;
+
     for (size_t i = 0, d = m_base_dimension; i < m_dimension; ++i, ++d)
     {
         if (d < FaurePermutationTableSize)
@@ -300,6 +343,17 @@ inline Vector<double, N> QMCSamplingContext<RNG>::next_vector2()
 {
     assert(m_sample_count == 0 || m_instance < m_sample_count);
     assert(N == m_dimension);
+
+    return
+        m_mode == SobolMode
+            ? next_vector2_sobol<N>()
+            : next_vector2_halton<N>();
+}
+
+template <typename RNG>
+template <size_t N>
+inline Vector<double, N> QMCSamplingContext<RNG>::next_vector2_halton()
+{
     assert(N <= PrimeTableSize);
 
     Vector<double, N> v;
@@ -329,6 +383,45 @@ inline Vector<double, N> QMCSamplingContext<RNG>::next_vector2()
     return v;
 }
 
+template <typename RNG>
+template <size_t N>
+inline Vector<double, N> QMCSamplingContext<RNG>::next_vector2_sobol()
+{
+    Vector<double, N> v;
+
+    // All trajectories draw from the same sequence, indexed so that the samples of the
+    // children of a trajectory form a contiguous block of the sequence. Consecutive
+    // trajectories, such as the samples of a pixel followed by single-sample splits,
+    // map to consecutive blocks and remain stratified with respect to each other.
+    // The index wraps around on very large sample numbers.
+    const size_t index =
+        m_sample_count > 0
+            ? m_base_instance * m_sample_count + m_instance
+            : m_base_instance + m_instance;
+
+    // Pad the sample with one independently scrambled (0,2)-sequence per pair
+    // of dimensions. The scrambling seed only depends on the absolute dimension
+    // of the pair.
+    for (size_t i = 0; i < N; i += 2)
+    {
+        const uint32 seed = hashint32(static_cast<uint32>(m_base_dimension + i));
+
+        const Vector<double, 2> s =
+            owen_scrambled_sobol02_sequence<double>(
+                seed,
+                static_cast<uint32>(index));
+
+        v[i] = s[0];
+
+        if (i + 1 < N)
+            v[i + 1] = s[1];
+    }
+
+    ++m_instance;
+
+    return v;
+}
+
 template <typename RNG>
 inline double QMCSamplingContext<RNG>::rotate(double x, const double offset)
 {
@@ -352,6 +445,12 @@ inline size_t QMCSamplingContext<RNG>::get_total_instance() const
     return m_base_instance + m_instance;
 }
 
+template <typename RNG>
+inline typename QMCSamplingContext<RNG>::Mode QMCSamplingContext<RNG>::get_mode() const
+{
+    return m_mode;
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MATH_SAMPLING_QMCSAMPLINGCONTEXT_H
@@ -0,0 +1,535 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_SPARSEVOXELGRID_H
+#define APPLESEED_FOUNDATION_MATH_SPARSEVOXELGRID_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// A regular 3D grid of voxels that only stores the regions where values are non-zero.
+//
+// Voxels are grouped into cubic bricks of BrickSize^3 voxels. A dense table holds
+// one pointer per brick; bricks that were never written to all point to a single
+// shared brick of zeros. Bricks are allocated the first time one of their voxels
+// is accessed through the non-const voxel() method.
+//
+// Lookups return the same values as foundation::VoxelGrid3 lookups.
+//
+
+template <typename ValueType, typename CoordType>
+class SparseVoxelGrid3
+  : public NonCopyable
+{
+  public:
+    // Types.
+    typedef Vector<CoordType, 3> PointType;
+
+    // Size of the bricks, in voxels along each axis.
+    static const size_t BrickSizeLog2 = 3;
+    static const size_t BrickSize = 1 << BrickSizeLog2;
+
+    // Constructor.
+    SparseVoxelGrid3(
+        const size_t        nx,
+        const size_t        ny,
+        const size_t        nz,
+        const size_t        channel_count);
+
+    // Destructor.
+    ~SparseVoxelGrid3();
+
+    // Get the grid properties.
+    size_t get_xres() const;
+    size_t get_yres() const;
+    size_t get_zres() const;
+    size_t get_channel_count() const;
+
+    // Return the number of bricks allocated so far.
+    size_t get_allocated_brick_count() const;
+
+    // Return true if the brick containing a given voxel has been allocated.
+    bool is_allocated_brick(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+    // Direct access to a given voxel. The non-const version allocates the brick
+    // containing the voxel if necessary. The const version never allocates: the
+    // values of voxels in unallocated bricks are all zero.
+    ValueType* voxel(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z);
+    const ValueType* voxel(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    // Perform an unfiltered lookup of the voxel grid.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    void nearest_lookup(
+        const PointType&    point,
+        ValueType           values[]) const;
+
+    // Perform a trilinearly interpolated lookup of the voxel grid.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    void linear_lookup(
+        const PointType&    point,
+        ValueType           values[]) const;
+
+    // Perform a triquadratically interpolated lookup of the voxel grid.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    void quadratic_lookup(
+        const PointType&    point,
+        ValueType           values[]) const;
+
+  private:
+    static const size_t BrickMask = BrickSize - 1;
+
+    const size_t            m_nx;
+    const size_t            m_ny;
+    const size_t            m_nz;
+    const CoordType         m_scalar_nx;
+    const CoordType         m_scalar_ny;
+    const CoordType         m_scalar_nz;
+    const CoordType         m_max_x;
+    const CoordType         m_max_y;
+    const CoordType         m_max_z;
+    const size_t            m_channel_count;
+    const size_t            m_brick_row_size;
+    const size_t            m_brick_slice_size;
+    const size_t            m_brick_value_count;
+    const size_t            m_brick_nx;
+    const size_t            m_brick_ny;
+    std::vector<ValueType>  m_empty_brick;
+    std::vector<ValueType*> m_bricks;
+    size_t                  m_allocated_brick_count;
+
+    size_t get_brick_index(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    size_t get_value_offset(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+};
+
+
+//
+// SparseVoxelGrid3 class implementation.
+//
+
+template <typename ValueType, typename CoordType>
+SparseVoxelGrid3<ValueType, CoordType>::SparseVoxelGrid3(
+    const size_t            nx,
+    const size_t            ny,
+    const size_t            nz,
+    const size_t            channel_count)
+  : m_nx(nx)
+  , m_ny(ny)
+  , m_nz(nz)
+  , m_scalar_nx(static_cast<CoordType>(nx))
+  , m_scalar_ny(static_cast<CoordType>(ny))
+  , m_scalar_nz(static_cast<CoordType>(nz))
+  , m_max_x(static_cast<CoordType>(nx - 1))
+  , m_max_y(static_cast<CoordType>(ny - 1))
+  , m_max_z(static_cast<CoordType>(nz - 1))
+  , m_channel_count(channel_count)
+  , m_brick_row_size(channel_count * BrickSize)                         // number of values in one row of a brick
+  , m_brick_slice_size(channel_count * BrickSize * BrickSize)           // number of values in one slice of a brick
+  , m_brick_value_count(channel_count * BrickSize * BrickSize * BrickSize)
+  , m_brick_nx((nx + BrickMask) >> BrickSizeLog2)
+  , m_brick_ny((ny + BrickMask) >> BrickSizeLog2)
+  , m_empty_brick(m_brick_value_count, ValueType(0.0))
+  , m_allocated_brick_count(0)
+{
+    assert(m_nx > 0);
+    assert(m_ny > 0);
+    assert(m_nz > 0);
+    assert(m_channel_count > 0);
+
+    const size_t brick_nz = (nz + BrickMask) >> BrickSizeLog2;
+    m_bricks.assign(m_brick_nx * m_brick_ny * brick_nz, &m_empty_brick[0]);
+}
+
+template <typename ValueType, typename CoordType>
+SparseVoxelGrid3<ValueType, CoordType>::~SparseVoxelGrid3()
+{
+    const ValueType* empty_brick = &m_empty_brick[0];
+
+    for (size_t i = 0; i < m_bricks.size(); ++i)
+    {
+        if (m_bricks[i] != empty_brick)
+            delete [] m_bricks[i];
+    }
+}
+
+template <typename ValueType, typename CoordType>
+FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_xres() const
+{
+    return m_nx;
+}
+
+template <typename ValueType, typename CoordType>
+FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_yres() const
+{
+    return m_ny;
+}
+
+template <typename ValueType, typename CoordType>
+FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_zres() const
+{
+    return m_nz;
+}
+
+template <typename ValueType, typename CoordType>
+FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_channel_count() const
+{
+    return m_channel_count;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_allocated_brick_count() const
+{
+    return m_allocated_brick_count;
+}
+
+template <typename ValueType, typename CoordType>
+inline bool SparseVoxelGrid3<ValueType, CoordType>::is_allocated_brick(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    assert(x < m_nx);
+    assert(y < m_ny);
+    assert(z < m_nz);
+
+    return m_bricks[get_brick_index(x, y, z)] != &m_empty_brick[0];
+}
+
+template <typename ValueType, typename CoordType>
+size_t SparseVoxelGrid3<ValueType, CoordType>::get_memory_size() const
+{
+    size_t mem_size = sizeof(*this);
+
+    mem_size += m_bricks.capacity() * sizeof(ValueType*);
+    mem_size += (m_allocated_brick_count + 1) * m_brick_value_count * sizeof(ValueType);
+
+    return mem_size;
+}
+
+template <typename ValueType, typename CoordType>
+FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_brick_index(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    return
+        ((z >> BrickSizeLog2) * m_brick_ny + (y >> BrickSizeLog2)) * m_brick_nx
+        + (x >> BrickSizeLog2);
+}
+
+template <typename ValueType, typename CoordType>
+FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_value_offset(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    return
+        (z & BrickMask) * m_brick_slice_size +
+        (y & BrickMask) * m_brick_row_size +
+        (x & BrickMask) * m_channel_count;
+}
+
+template <typename ValueType, typename CoordType>
+FORCE_INLINE ValueType* SparseVoxelGrid3<ValueType, CoordType>::voxel(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z)
+{
+    assert(x < m_nx);
+    assert(y < m_ny);
+    assert(z < m_nz);
+
+    ValueType*& brick = m_bricks[get_brick_index(x, y, z)];
+
+    if (brick == &m_empty_brick[0])
+    {
+        brick = new ValueType[m_brick_value_count];
+
+        for (size_t i = 0; i < m_brick_value_count; ++i)
+            brick[i] = ValueType(0.0);
+
+        ++m_allocated_brick_count;
+    }
+
+    return brick + get_value_offset(x, y, z);
+}
+
+template <typename ValueType, typename CoordType>
+FORCE_INLINE const ValueType* SparseVoxelGrid3<ValueType, CoordType>::voxel(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    assert(x < m_nx);
+    assert(y < m_ny);
+    assert(z < m_nz);
+
+    return m_bricks[get_brick_index(x, y, z)] + get_value_offset(x, y, z);
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::nearest_lookup(
+    const PointType&        point,
+    ValueType* RESTRICT     values) const
+{
+    // Compute the coordinates of the voxel containing the lookup point.
+    const CoordType x = clamp(point.x * m_scalar_nx, CoordType(0.0), m_max_x);
+    const CoordType y = clamp(point.y * m_scalar_ny, CoordType(0.0), m_max_y);
+    const CoordType z = clamp(point.z * m_scalar_nz, CoordType(0.0), m_max_z);
+    const size_t ix = truncate<size_t>(x);
+    const size_t iy = truncate<size_t>(y);
+    const size_t iz = truncate<size_t>(z);
+
+    // Return the values of that voxel.
+    const ValueType* RESTRICT source = voxel(ix, iy, iz);
+    for (size_t i = 0; i < m_channel_count; ++i)
+        *values++ = *source++;
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::linear_lookup(
+    const PointType&        point,
+    ValueType* RESTRICT     values) const
+{
+    // Compute the coordinates of the voxel containing the lookup point.
+    const CoordType x = saturate(point.x) * m_max_x;
+    const CoordType y = saturate(point.y) * m_max_y;
+    const CoordType z = saturate(point.z) * m_max_z;
+    const size_t ix = truncate<size_t>(x);
+    const size_t iy = truncate<size_t>(y);
+    const size_t iz = truncate<size_t>(z);
+
+    // Compute interpolation weights.
+    const ValueType x1 = static_cast<ValueType>(x - ix);
+    const ValueType y1 = static_cast<ValueType>(y - iy);
+    const ValueType z1 = static_cast<ValueType>(z - iz);
+    const ValueType x0 = ValueType(1.0) - x1;
+    const ValueType y0 = ValueType(1.0) - y1;
+    const ValueType z0 = ValueType(1.0) - z1;
+    const ValueType y0z0 = y0 * z0;
+    const ValueType y1z0 = y1 * z0;
+    const ValueType y0z1 = y0 * z1;
+    const ValueType y1z1 = y1 * z1;
+    const ValueType w000 = x0 * y0z0;
+    const ValueType w100 = x1 * y0z0;
+    const ValueType w010 = x0 * y1z0;
+    const ValueType w110 = x1 * y1z0;
+    const ValueType w001 = x0 * y0z1;
+    const ValueType w101 = x1 * y0z1;
+    const ValueType w011 = x0 * y1z1;
+    const ValueType w111 = x1 * y1z1;
+
+    // Compute the coordinates of the farthest voxel involved in the lookup.
+    const size_t jx = ix == m_nx - 1 ? ix : ix + 1;
+    const size_t jy = iy == m_ny - 1 ? iy : iy + 1;
+    const size_t jz = iz == m_nz - 1 ? iz : iz + 1;
+
+    // Compute source pointers. Along each axis, split voxel coordinates
+    // into a brick coordinate and an offset within the brick.
+    const size_t brick_slice_count = m_brick_nx * m_brick_ny;
+    const size_t bx0 = ix >> BrickSizeLog2;
+    const size_t bx1 = jx >> BrickSizeLog2;
+    const size_t by0 = (iy >> BrickSizeLog2) * m_brick_nx;
+    const size_t by1 = (jy >> BrickSizeLog2) * m_brick_nx;
+    const size_t bz0 = (iz >> BrickSizeLog2) * brick_slice_count;
+    const size_t bz1 = (jz >> BrickSizeLog2) * brick_slice_count;
+    const size_t ox0 = (ix & BrickMask) * m_channel_count;
+    const size_t ox1 = (jx & BrickMask) * m_channel_count;
+    const size_t oy0 = (iy & BrickMask) * m_brick_row_size;
+    const size_t oy1 = (jy & BrickMask) * m_brick_row_size;
+    const size_t oz0 = (iz & BrickMask) * m_brick_slice_size;
+    const size_t oz1 = (jz & BrickMask) * m_brick_slice_size;
+    const ValueType* RESTRICT src000 = m_bricks[bz0 + by0 + bx0] + oz0 + oy0 + ox0;
+    const ValueType* RESTRICT src100 = m_bricks[bz0 + by0 + bx1] + oz0 + oy0 + ox1;
+    const ValueType* RESTRICT src010 = m_bricks[bz0 + by1 + bx0] + oz0 + oy1 + ox0;
+    const ValueType* RESTRICT src110 = m_bricks[bz0 + by1 + bx1] + oz0 + oy1 + ox1;
+    const ValueType* RESTRICT src001 = m_bricks[bz1 + by0 + bx0] + oz1 + oy0 + ox0;
+    const ValueType* RESTRICT src101 = m_bricks[bz1 + by0 + bx1] + oz1 + oy0 + ox1;
+    const ValueType* RESTRICT src011 = m_bricks[bz1 + by1 + bx0] + oz1 + oy1 + ox0;
+    const ValueType* RESTRICT src111 = m_bricks[bz1 + by1 + bx1] + oz1 + oy1 + ox1;
+
+    // Blend.
+    ValueType* RESTRICT dest = values;
+    for (size_t i = 0; i < m_channel_count; ++i)
+    {
+       *dest++ =
+           *src000++ * w000 +
+           *src100++ * w100 +
+           *src010++ * w010 +
+           *src110++ * w110 +
+           *src001++ * w001 +
+           *src101++ * w101 +
+           *src011++ * w011 +
+           *src111++ * w111;
+    }
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::quadratic_lookup(
+    const PointType&        point,
+    ValueType               values[]) const
+{
+    // See foundation::VoxelGrid3::quadratic_lookup() for the definition
+    // of the quadratic interpolation polynomial.
+
+    // Compute the coordinates of the voxel containing the lookup point.
+    const CoordType x = saturate(point.x) * m_max_x;
+    const CoordType y = saturate(point.y) * m_max_y;
+    const CoordType z = saturate(point.z) * m_max_z;
+    const size_t ix = truncate<size_t>(x + CoordType(0.5));
+    const size_t iy = truncate<size_t>(y + CoordType(0.5));
+    const size_t iz = truncate<size_t>(z + CoordType(0.5));
+
+    // Compute interpolation weights.
+    const ValueType tx = static_cast<ValueType>(x - ix) + ValueType(0.5);
+    const ValueType ty = static_cast<ValueType>(y - iy) + ValueType(0.5);
+    const ValueType tz = static_cast<ValueType>(z - iz) + ValueType(0.5);
+    const ValueType tx2 = tx * tx;
+    const ValueType wx2 = ValueType(0.5) * tx2;
+    const ValueType wx1 = tx - tx2 + ValueType(0.5);
+    const ValueType wx0 = wx2 - tx + ValueType(0.5);
+    const ValueType ty2 = ty * ty;
+    const ValueType wy2 = ValueType(0.5) * ty2;
+    const ValueType wy1 = ty - ty2 + ValueType(0.5);
+    const ValueType wy0 = wy2 - ty + ValueType(0.5);
+    const ValueType tz2 = tz * tz;
+    const ValueType wz2 = ValueType(0.5) * tz2;
+    const ValueType wz1 = tz - tz2 + ValueType(0.5);
+    const ValueType wz0 = wz2 - tz + ValueType(0.5);
+
+    // Compute the coordinates of the voxels involved in the lookup along each axis.
+    const size_t cx[3] = { ix == 0 ? ix : ix - 1, ix, ix == m_nx - 1 ? ix : ix + 1 };
+    const size_t cy[3] = { iy == 0 ? iy : iy - 1, iy, iy == m_ny - 1 ? iy : iy + 1 };
+    const size_t cz[3] = { iz == 0 ? iz : iz - 1, iz, iz == m_nz - 1 ? iz : iz + 1 };
+
+    // Compute source pointers. Along each axis, split voxel coordinates
+    // into a brick coordinate and an offset within the brick.
+    const size_t brick_slice_count = m_brick_nx * m_brick_ny;
+    const size_t bx0 = cx[0] >> BrickSizeLog2;
+    const size_t bx1 = cx[1] >> BrickSizeLog2;
+    const size_t bx2 = cx[2] >> BrickSizeLog2;
+    const size_t by0 = (cy[0] >> BrickSizeLog2) * m_brick_nx;
+    const size_t by1 = (cy[1] >> BrickSizeLog2) * m_brick_nx;
+    const size_t by2 = (cy[2] >> BrickSizeLog2) * m_brick_nx;
+    const size_t bz0 = (cz[0] >> BrickSizeLog2) * brick_slice_count;
+    const size_t bz1 = (cz[1] >> BrickSizeLog2) * brick_slice_count;
+    const size_t bz2 = (cz[2] >> BrickSizeLog2) * brick_slice_count;
+    const size_t ox0 = (cx[0] & BrickMask) * m_channel_count;
+    const size_t ox1 = (cx[1] & BrickMask) * m_channel_count;
+    const size_t ox2 = (cx[2] & BrickMask) * m_channel_count;
+    const size_t oy0 = (cy[0] & BrickMask) * m_brick_row_size;
+    const size_t oy1 = (cy[1] & BrickMask) * m_brick_row_size;
+    const size_t oy2 = (cy[2] & BrickMask) * m_brick_row_size;
+    const size_t oz0 = (cz[0] & BrickMask) * m_brick_slice_size;
+    const size_t oz1 = (cz[1] & BrickMask) * m_brick_slice_size;
+    const size_t oz2 = (cz[2] & BrickMask) * m_brick_slice_size;
+    const ValueType* RESTRICT src000 = m_bricks[bz0 + by0 + bx0] + oz0 + oy0 + ox0;
+    const ValueType* RESTRICT src100 = m_bricks[bz0 + by0 + bx1] + oz0 + oy0 + ox1;
+    const ValueType* RESTRICT src200 = m_bricks[bz0 + by0 + bx2] + oz0 + oy0 + ox2;
+    const ValueType* RESTRICT src010 = m_bricks[bz0 + by1 + bx0] + oz0 + oy1 + ox0;
+    const ValueType* RESTRICT src110 = m_bricks[bz0 + by1 + bx1] + oz0 + oy1 + ox1;
+    const ValueType* RESTRICT src210 = m_bricks[bz0 + by1 + bx2] + oz0 + oy1 + ox2;
+    const ValueType* RESTRICT src020 = m_bricks[bz0 + by2 + bx0] + oz0 + oy2 + ox0;
+    const ValueType* RESTRICT src120 = m_bricks[bz0 + by2 + bx1] + oz0 + oy2 + ox1;
+    const ValueType* RESTRICT src220 = m_bricks[bz0 + by2 + bx2] + oz0 + oy2 + ox2;
+    const ValueType* RESTRICT src001 = m_bricks[bz1 + by0 + bx0] + oz1 + oy0 + ox0;
+    const ValueType* RESTRICT src101 = m_bricks[bz1 + by0 + bx1] + oz1 + oy0 + ox1;
+    const ValueType* RESTRICT src201 = m_bricks[bz1 + by0 + bx2] + oz1 + oy0 + ox2;
+    const ValueType* RESTRICT src011 = m_bricks[bz1 + by1 + bx0] + oz1 + oy1 + ox0;
+    const ValueType* RESTRICT src111 = m_bricks[bz1 + by1 + bx1] + oz1 + oy1 + ox1;
+    const ValueType* RESTRICT src211 = m_bricks[bz1 + by1 + bx2] + oz1 + oy1 + ox2;
+    const ValueType* RESTRICT src021 = m_bricks[bz1 + by2 + bx0] + oz1 + oy2 + ox0;
+    const ValueType* RESTRICT src121 = m_bricks[bz1 + by2 + bx1] + oz1 + oy2 + ox1;
+    const ValueType* RESTRICT src221 = m_bricks[bz1 + by2 + bx2] + oz1 + oy2 + ox2;
+    const ValueType* RESTRICT src002 = m_bricks[bz2 + by0 + bx0] + oz2 + oy0 + ox0;
+    const ValueType* RESTRICT src102 = m_bricks[bz2 + by0 + bx1] + oz2 + oy0 + ox1;
+    const ValueType* RESTRICT src202 = m_bricks[bz2 + by0 + bx2] + oz2 + oy0 + ox2;
+    const ValueType* RESTRICT src012 = m_bricks[bz2 + by1 + bx0] + oz2 + oy1 + ox0;
+    const ValueType* RESTRICT src112 = m_bricks[bz2 + by1 + bx1] + oz2 + oy1 + ox1;
+    const ValueType* RESTRICT src212 = m_bricks[bz2 + by1 + bx2] + oz2 + oy1 + ox2;
+    const ValueType* RESTRICT src022 = m_bricks[bz2 + by2 + bx0] + oz2 + oy2 + ox0;
+    const ValueType* RESTRICT src122 = m_bricks[bz2 + by2 + bx1] + oz2 + oy2 + ox1;
+    const ValueType* RESTRICT src222 = m_bricks[bz2 + by2 + bx2] + oz2 + oy2 + ox2;
+
+    // Blend.
+    ValueType* RESTRICT dest = values;
+    for (size_t i = 0; i < m_channel_count; ++i)
+    {
+        const ValueType p00 = *src000++ * wx0 + *src100++ * wx1 + *src200++ * wx2;
+        const ValueType p01 = *src001++ * wx0 + *src101++ * wx1 + *src201++ * wx2;
+        const ValueType p02 = *src002++ * wx0 + *src102++ * wx1 + *src202++ * wx2;
+
+        const ValueType p10 = *src010++ * wx0 + *src110++ * wx1 + *src210++ * wx2;
+        const ValueType p11 = *src011++ * wx0 + *src111++ * wx1 + *src211++ * wx2;
+        const ValueType p12 = *src012++ * wx0 + *src112++ * wx1 + *src212++ * wx2;
+
+        const ValueType p20 = *src020++ * wx0 + *src120++ * wx1 + *src220++ * wx2;
+        const ValueType p21 = *src021++ * wx0 + *src121++ * wx1 + *src221++ * wx2;
+        const ValueType p22 = *src022++ * wx0 + *src122++ * wx1 + *src222++ * wx2;
+
+        const ValueType q0 = p00 * wy0 + p10 * wy1 + p20 * wy2;
+        const ValueType q1 = p01 * wy0 + p11 * wy1 + p21 * wy2;
+        const ValueType q2 = p02 * wy0 + p12 * wy1 + p22 * wy2;
+
+        *dest++ = q0 * wz0 + q1 * wz1 + q2 * wz2;
+    }
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_SPARSEVOXELGRID_H
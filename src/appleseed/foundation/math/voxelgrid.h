@@ -70,6 +70,9 @@ class VoxelGrid3
     size_t get_zres() const;
     size_t get_channel_count() const;
 
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
     // Direct access to a given voxel.
     ValueType* voxel(
         const size_t        x,
@@ -169,6 +172,16 @@ FORCE_INLINE size_t VoxelGrid3<ValueType, CoordType>::get_channel_count() const
     return m_channel_count;
 }
 
+template <typename ValueType, typename CoordType>
+size_t VoxelGrid3<ValueType, CoordType>::get_memory_size() const
+{
+    size_t mem_size = sizeof(*this);
+
+    mem_size += m_values.capacity() * sizeof(ValueType);
+
+    return mem_size;
+}
+
 template <typename ValueType, typename CoordType>
 FORCE_INLINE ValueType* VoxelGrid3<ValueType, CoordType>::voxel(
     const size_t            x,
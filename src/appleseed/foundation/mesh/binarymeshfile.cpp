@@ -0,0 +1,260 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "binarymeshfile.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/core/exceptions/exceptionunsupportedfileformat.h"
+#include "foundation/platform/memorymappedfile.h"
+
+// Standard headers.
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// BinaryMeshFile class implementation.
+//
+
+const char* BinaryMeshFile::Extension = ".binarymesh";
+
+const char BinaryMeshFile::Magic[8] = { 'A', 'S', 'B', 'M', 'E', 'S', 'H', '\0' };
+
+const size_t BinaryMeshFile::BlockAlignment;
+const uint32 BinaryMeshFile::None;
+const uint32 BinaryMeshFile::Version;
+
+struct BinaryMeshFile::Impl
+{
+    MemoryMappedFile    m_file;
+    vector<Mesh>        m_meshes;
+};
+
+BinaryMeshFile::BinaryMeshFile()
+  : impl(new Impl())
+{
+}
+
+BinaryMeshFile::~BinaryMeshFile()
+{
+    delete impl;
+}
+
+namespace
+{
+    // Return true if a block of a given size at a given offset lies entirely within the file.
+    bool is_block_valid(
+        const uint64    offset,
+        const uint64    size,
+        const uint64    file_size)
+    {
+        return offset <= file_size && size <= file_size - offset;
+    }
+
+    template <typename T>
+    const T* get_block(
+        const uint8*    base,
+        const uint64    offset,
+        const uint64    count,
+        const uint64    item_size,
+        const uint64    file_size)
+    {
+        if (count == 0)
+            return 0;
+
+        if (count > file_size / item_size || !is_block_valid(offset, count * item_size, file_size))
+            throw ExceptionIOError("truncated binary mesh file");
+
+        return reinterpret_cast<const T*>(base + offset);
+    }
+
+    // Return true if the three indices of a face feature are either all valid or all absent.
+    bool are_indices_valid(
+        const uint32    i0,
+        const uint32    i1,
+        const uint32    i2,
+        const size_t    count,
+        const bool      required)
+    {
+        if (!required &&
+            i0 == BinaryMeshFile::None &&
+            i1 == BinaryMeshFile::None &&
+            i2 == BinaryMeshFile::None)
+            return true;
+
+        return i0 < count && i1 < count && i2 < count;
+    }
+
+    // Check that the faces of a mesh only reference existing vertices, vertex normals and
+    // texture coordinates, so that the mesh can be used without checking indices again.
+    void check_faces(const BinaryMeshFile::Mesh& mesh)
+    {
+        const bool normals_required = (mesh.m_flags & BinaryMeshFile::AllFacesHaveNormals) != 0;
+
+        for (size_t i = 0; i < mesh.m_face_count; ++i)
+        {
+            const BinaryMeshFile::Face& face = mesh.m_faces[i];
+
+            if (!are_indices_valid(face.m_v0, face.m_v1, face.m_v2, mesh.m_vertex_count, true) ||
+                !are_indices_valid(face.m_n0, face.m_n1, face.m_n2, mesh.m_vertex_normal_count, normals_required) ||
+                !are_indices_valid(face.m_t0, face.m_t1, face.m_t2, mesh.m_tex_coords_count, false))
+                throw ExceptionIOError("invalid binary mesh file");
+        }
+    }
+}
+
+void BinaryMeshFile::open(const string& filename)
+{
+    close();
+
+    if (!impl->m_file.open(filename.c_str()))
+        throw ExceptionIOError("could not map binary mesh file");
+
+    const uint8* base = static_cast<const uint8*>(impl->m_file.data());
+    const uint64 file_size = static_cast<uint64>(impl->m_file.size());
+
+    // Read and check the file header.
+    if (file_size < sizeof(FileHeader))
+    {
+        close();
+        throw ExceptionUnsupportedFileFormat(filename.c_str());
+    }
+
+    const FileHeader& file_header = *reinterpret_cast<const FileHeader*>(base);
+
+    if (memcmp(file_header.m_magic, Magic, sizeof(Magic)) != 0 ||
+        file_header.m_version != Version)
+    {
+        close();
+        throw ExceptionUnsupportedFileFormat(filename.c_str());
+    }
+
+    try
+    {
+        if (file_header.m_file_size != file_size)
+            throw ExceptionIOError("truncated binary mesh file");
+
+        const MeshHeader* mesh_headers =
+            get_block<MeshHeader>(
+                base,
+                sizeof(FileHeader),
+                file_header.m_mesh_count,
+                sizeof(MeshHeader),
+                file_size);
+
+        impl->m_meshes.resize(file_header.m_mesh_count);
+
+        for (uint32 i = 0; i < file_header.m_mesh_count; ++i)
+        {
+            const MeshHeader& header = mesh_headers[i];
+            Mesh& mesh = impl->m_meshes[i];
+
+            if (header.m_vertex_encoding > VertexQuantized16 ||
+                header.m_vertex_normal_encoding > NormalOctahedral16)
+                throw ExceptionIOError("invalid binary mesh file");
+
+            const char* name =
+                get_block<char>(base, header.m_name_offset, header.m_name_length, 1, file_size);
+            mesh.m_name = name ? string(name, header.m_name_length) : string();
+
+            mesh.m_bbox.min = Vector3f(header.m_bbox_min);
+            mesh.m_bbox.max = Vector3f(header.m_bbox_max);
+            mesh.m_flags = header.m_flags;
+            mesh.m_vertex_encoding = static_cast<VertexEncoding>(header.m_vertex_encoding);
+            mesh.m_vertex_normal_encoding = static_cast<NormalEncoding>(header.m_vertex_normal_encoding);
+
+            mesh.m_vertex_count = header.m_vertex_count;
+            mesh.m_vertices =
+                get_block<void>(
+                    base,
+                    header.m_vertices_offset,
+                    header.m_vertex_count,
+                    mesh.m_vertex_encoding == VertexQuantized16 ? 3 * sizeof(uint16) : 3 * sizeof(float),
+                    file_size);
+
+            mesh.m_vertex_normal_count = header.m_vertex_normal_count;
+            mesh.m_vertex_normals =
+                get_block<void>(
+                    base,
+                    header.m_vertex_normals_offset,
+                    header.m_vertex_normal_count,
+                    mesh.m_vertex_normal_encoding == NormalOctahedral16 ? 2 * sizeof(int16) : 3 * sizeof(float),
+                    file_size);
+
+            mesh.m_tex_coords_count = header.m_tex_coords_count;
+            mesh.m_tex_coords =
+                get_block<Vector2f>(
+                    base,
+                    header.m_tex_coords_offset,
+                    header.m_tex_coords_count,
+                    sizeof(Vector2f),
+                    file_size);
+
+            mesh.m_face_count = header.m_face_count;
+            mesh.m_faces =
+                get_block<Face>(
+                    base,
+                    header.m_faces_offset,
+                    header.m_face_count,
+                    sizeof(Face),
+                    file_size);
+
+            check_faces(mesh);
+        }
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
+}
+
+void BinaryMeshFile::close()
+{
+    impl->m_meshes.clear();
+    impl->m_file.close();
+}
+
+size_t BinaryMeshFile::get_mesh_count() const
+{
+    return impl->m_meshes.size();
+}
+
+const BinaryMeshFile::Mesh& BinaryMeshFile::get_mesh(const size_t index) const
+{
+    assert(index < impl->m_meshes.size());
+    return impl->m_meshes[index];
+}
+
+}   // namespace foundation
@@ -0,0 +1,322 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MESH_BINARYMESHFILE_H
+#define APPLESEED_FOUNDATION_MESH_BINARYMESHFILE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+namespace foundation
+{
+
+//
+// Binary mesh file.
+//
+// A compact binary format for triangle meshes, designed to be loaded without parsing:
+// the geometry of each mesh is stored in blocks that start on page boundaries and
+// whose layout matches the in-memory layout used by the renderer, so that the file
+// can be mapped read-only into memory and used in place. A file contains any number
+// of meshes and is laid out as follows:
+//
+//   file header                         FileHeader
+//   mesh headers                        MeshHeader[mesh count]
+//   mesh names                          char[], not null-terminated
+//   for each mesh, page-aligned:
+//     vertices                          float[3] or uint16[3] (quantized in the bbox)
+//     vertex normals                    float[3] or int16[2] (octahedral encoding)
+//     texture coordinates               float[2]
+//     faces                             Face
+//
+// All values are stored in little-endian byte order.
+//
+
+class BinaryMeshFile
+  : public NonCopyable
+{
+  public:
+    // File name extension.
+    static const char* Extension;
+
+    // Alignment in bytes of the data blocks.
+    static const size_t BlockAlignment = 4096;
+
+    // Encodings of vertices.
+    enum VertexEncoding
+    {
+        VertexFloat32       = 0,                // 3 x 32-bit floating-point
+        VertexQuantized16   = 1                 // 3 x 16-bit unsigned integers, relative to the bounding box
+    };
+
+    // Encodings of vertex normals.
+    enum NormalEncoding
+    {
+        NormalFloat32       = 0,                // 3 x 32-bit floating-point
+        NormalOctahedral16  = 1                 // 2 x 16-bit signed integers, octahedral mapping
+    };
+
+    // Mesh flags.
+    enum MeshFlags
+    {
+        AllFacesHaveNormals = 1 << 0            // every face references vertex normals
+    };
+
+    // Special index value used to indicate that a feature is not present.
+    static const uint32 None = ~uint32(0);
+
+    // Triangular face.
+    struct Face
+    {
+        uint32      m_v0, m_v1, m_v2;           // vertex indices
+        uint32      m_n0, m_n1, m_n2;           // vertex normal indices
+        uint32      m_t0, m_t1, m_t2;           // texture coordinates indices
+        uint32      m_material;                 // material index
+    };
+
+    // File header, as stored on disk.
+    struct FileHeader
+    {
+        char        m_magic[8];
+        uint32      m_version;
+        uint32      m_mesh_count;
+        uint64      m_file_size;
+    };
+
+    // Mesh header, as stored on disk.
+    struct MeshHeader
+    {
+        uint64      m_name_offset;
+        uint64      m_vertices_offset;
+        uint64      m_vertex_normals_offset;
+        uint64      m_tex_coords_offset;
+        uint64      m_faces_offset;
+        uint32      m_name_length;
+        uint32      m_vertex_count;
+        uint32      m_vertex_normal_count;
+        uint32      m_tex_coords_count;
+        uint32      m_face_count;
+        uint32      m_vertex_encoding;
+        uint32      m_vertex_normal_encoding;
+        uint32      m_flags;
+        float       m_bbox_min[3];
+        float       m_bbox_max[3];
+    };
+
+    // Mesh, as exposed by an open binary mesh file.
+    struct Mesh
+    {
+        std::string         m_name;
+        AABB3f              m_bbox;
+        uint32              m_flags;
+        VertexEncoding      m_vertex_encoding;
+        NormalEncoding      m_vertex_normal_encoding;
+        size_t              m_vertex_count;
+        const void*         m_vertices;
+        size_t              m_vertex_normal_count;
+        const void*         m_vertex_normals;
+        size_t              m_tex_coords_count;
+        const Vector2f*     m_tex_coords;
+        size_t              m_face_count;
+        const Face*         m_faces;
+
+        // Decode a given vertex.
+        Vector3f get_vertex(const size_t index) const;
+
+        // Decode a given vertex normal.
+        Vector3f get_vertex_normal(const size_t index) const;
+    };
+
+    // Format identification.
+    static const char Magic[8];
+    static const uint32 Version = 1;
+
+    // Constructor.
+    BinaryMeshFile();
+
+    // Destructor, unmaps the file.
+    ~BinaryMeshFile();
+
+    // Map a binary mesh file into memory. Throw an ExceptionIOError exception
+    // if the file cannot be mapped, is truncated or has faces referencing missing
+    // vertices, vertex normals or texture coordinates, and an ExceptionUnsupportedFileFormat
+    // exception if the file is not a binary mesh file.
+    void open(const std::string& filename);
+
+    // Unmap the file.
+    void close();
+
+    // Access the meshes of the file.
+    size_t get_mesh_count() const;
+    const Mesh& get_mesh(const size_t index) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+
+//
+// Vertex quantization and normal encoding functions.
+//
+
+// Quantize a vertex to 16 bits per component relative to a bounding box.
+void quantize_vertex(
+    const Vector3f&     v,
+    const AABB3f&       bbox,
+    uint16              q[3]);
+
+// Reconstruct a vertex quantized with quantize_vertex().
+Vector3f dequantize_vertex(
+    const uint16        q[3],
+    const AABB3f&       bbox);
+
+// Encode a unit-length vector to two 16-bit integers using the octahedral mapping.
+//
+// Reference:
+//
+//   Cigolle et al., A Survey of Efficient Representations for Independent Unit Vectors
+//   http://jcgt.org/published/0003/02/01/
+//
+void encode_octahedral_normal(
+    const Vector3f&     n,
+    int16               q[2]);
+
+// Decode a unit-length vector encoded with encode_octahedral_normal().
+Vector3f decode_octahedral_normal(
+    const int16         q[2]);
+
+
+//
+// BinaryMeshFile::Mesh class implementation.
+//
+
+inline Vector3f BinaryMeshFile::Mesh::get_vertex(const size_t index) const
+{
+    assert(index < m_vertex_count);
+
+    if (m_vertex_encoding == VertexQuantized16)
+        return dequantize_vertex(static_cast<const uint16*>(m_vertices) + 3 * index, m_bbox);
+    else return static_cast<const Vector3f*>(m_vertices)[index];
+}
+
+inline Vector3f BinaryMeshFile::Mesh::get_vertex_normal(const size_t index) const
+{
+    assert(index < m_vertex_normal_count);
+
+    if (m_vertex_normal_encoding == NormalOctahedral16)
+        return decode_octahedral_normal(static_cast<const int16*>(m_vertex_normals) + 2 * index);
+    else return static_cast<const Vector3f*>(m_vertex_normals)[index];
+}
+
+
+//
+// Vertex quantization and normal encoding functions implementation.
+//
+
+inline void quantize_vertex(
+    const Vector3f&     v,
+    const AABB3f&       bbox,
+    uint16              q[3])
+{
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const float extent = bbox.max[i] - bbox.min[i];
+        const float t = extent > 0.0f ? (v[i] - bbox.min[i]) / extent : 0.0f;
+        q[i] = static_cast<uint16>(round<int>(saturate(t) * 65535.0f));
+    }
+}
+
+inline Vector3f dequantize_vertex(
+    const uint16        q[3],
+    const AABB3f&       bbox)
+{
+    const float Scale = 1.0f / 65535.0f;
+
+    return
+        Vector3f(
+            bbox.min[0] + (bbox.max[0] - bbox.min[0]) * (q[0] * Scale),
+            bbox.min[1] + (bbox.max[1] - bbox.min[1]) * (q[1] * Scale),
+            bbox.min[2] + (bbox.max[2] - bbox.min[2]) * (q[2] * Scale));
+}
+
+inline void encode_octahedral_normal(
+    const Vector3f&     n,
+    int16               q[2])
+{
+    // Project the vector onto the octahedron, then onto the z = 0 plane.
+    const float rcp_norm1 = 1.0f / (std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]));
+    float x = n[0] * rcp_norm1;
+    float y = n[1] * rcp_norm1;
+
+    // Fold the lower hemisphere over the diagonals.
+    if (n[2] < 0.0f)
+    {
+        const float fx = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float fy = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+
+    q[0] = static_cast<int16>(round<int>(clamp(x, -1.0f, 1.0f) * 32767.0f));
+    q[1] = static_cast<int16>(round<int>(clamp(y, -1.0f, 1.0f) * 32767.0f));
+}
+
+inline Vector3f decode_octahedral_normal(
+    const int16         q[2])
+{
+    const float Scale = 1.0f / 32767.0f;
+
+    float x = q[0] * Scale;
+    float y = q[1] * Scale;
+    const float z = 1.0f - std::abs(x) - std::abs(y);
+
+    // Unfold the lower hemisphere.
+    if (z < 0.0f)
+    {
+        const float fx = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float fy = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+
+    return normalize(Vector3f(x, y, z));
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MESH_BINARYMESHFILE_H
@@ -0,0 +1,102 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "binarymeshfilereader.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfile.h"
+#include "foundation/mesh/imeshbuilder.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// BinaryMeshFileReader class implementation.
+//
+
+void BinaryMeshFileReader::read(
+    const string&   filename,
+    IMeshBuilder&   builder)
+{
+    BinaryMeshFile file;
+    file.open(filename);
+
+    for (size_t mesh_index = 0; mesh_index < file.get_mesh_count(); ++mesh_index)
+    {
+        const BinaryMeshFile::Mesh& mesh = file.get_mesh(mesh_index);
+
+        builder.begin_mesh(mesh.m_name);
+
+        for (size_t i = 0; i < mesh.m_vertex_count; ++i)
+            builder.push_vertex(Vector3d(mesh.get_vertex(i)));
+
+        for (size_t i = 0; i < mesh.m_vertex_normal_count; ++i)
+            builder.push_vertex_normal(Vector3d(mesh.get_vertex_normal(i)));
+
+        for (size_t i = 0; i < mesh.m_tex_coords_count; ++i)
+            builder.push_tex_coords(Vector2d(mesh.m_tex_coords[i]));
+
+        for (size_t i = 0; i < mesh.m_face_count; ++i)
+        {
+            const BinaryMeshFile::Face& face = mesh.m_faces[i];
+
+            builder.begin_face(3);
+
+            const size_t vertices[3] = { face.m_v0, face.m_v1, face.m_v2 };
+            builder.set_face_vertices(vertices);
+
+            if (face.m_n0 != BinaryMeshFile::None)
+            {
+                const size_t vertex_normals[3] = { face.m_n0, face.m_n1, face.m_n2 };
+                builder.set_face_vertex_normals(vertex_normals);
+            }
+
+            if (face.m_t0 != BinaryMeshFile::None)
+            {
+                const size_t tex_coords[3] = { face.m_t0, face.m_t1, face.m_t2 };
+                builder.set_face_vertex_tex_coords(tex_coords);
+            }
+
+            if (face.m_material != BinaryMeshFile::None)
+                builder.set_face_material(face.m_material);
+
+            builder.end_face();
+        }
+
+        builder.end_mesh();
+    }
+}
+
+}   // namespace foundation
@@ -0,0 +1,64 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MESH_BINARYMESHFILEREADER_H
+#define APPLESEED_FOUNDATION_MESH_BINARYMESHFILEREADER_H
+
+// appleseed.foundation headers.
+#include "foundation/mesh/imeshfilereader.h"
+
+// Standard headers.
+#include <string>
+
+// Forward declarations.
+namespace foundation    { class IMeshBuilder; }
+
+namespace foundation
+{
+
+//
+// Binary mesh file reader.
+//
+// This reader feeds the content of a binary mesh file to a mesh builder, like any
+// other mesh file reader. Use BinaryMeshFile directly to access the mapped data
+// without copying it.
+//
+
+class BinaryMeshFileReader
+  : public IMeshFileReader
+{
+  public:
+    // Read a binary mesh file.
+    virtual void read(
+        const std::string&  filename,
+        IMeshBuilder&       builder);
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MESH_BINARYMESHFILEREADER_H
@@ -0,0 +1,353 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "binarymeshfilewriter.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfile.h"
+#include "foundation/mesh/imeshwalker.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// BinaryMeshFileWriter class implementation.
+//
+
+namespace
+{
+    uint64 align_offset(const uint64 offset)
+    {
+        const uint64 Alignment = BinaryMeshFile::BlockAlignment;
+        return (offset + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    uint32 to_index(const size_t index)
+    {
+        return index == IMeshWalker::Face::None ? BinaryMeshFile::None : static_cast<uint32>(index);
+    }
+
+    class Writer
+    {
+      public:
+        explicit Writer(FILE* file)
+          : m_file(file)
+          , m_offset(0)
+        {
+        }
+
+        void write(const void* data, const size_t size)
+        {
+            if (size > 0 && fwrite(data, size, 1, m_file) != 1)
+                throw ExceptionIOError();
+
+            m_offset += size;
+        }
+
+        void pad_to(const uint64 offset)
+        {
+            assert(offset >= m_offset);
+
+            static const char Zeros[BinaryMeshFile::BlockAlignment] = { 0 };
+
+            while (m_offset < offset)
+            {
+                const uint64 remaining = offset - m_offset;
+                write(Zeros, static_cast<size_t>(remaining < sizeof(Zeros) ? remaining : sizeof(Zeros)));
+            }
+        }
+
+      private:
+        FILE*   m_file;
+        uint64  m_offset;
+    };
+
+    void write_vertices(
+        Writer&                         writer,
+        const IMeshWalker&              walker,
+        const BinaryMeshFile::MeshHeader& header)
+    {
+        const size_t vertex_count = walker.get_vertex_count();
+
+        if (header.m_vertex_encoding == BinaryMeshFile::VertexQuantized16)
+        {
+            const AABB3f bbox(Vector3f(header.m_bbox_min), Vector3f(header.m_bbox_max));
+
+            for (size_t i = 0; i < vertex_count; ++i)
+            {
+                uint16 q[3];
+                quantize_vertex(Vector3f(walker.get_vertex(i)), bbox, q);
+                writer.write(q, sizeof(q));
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < vertex_count; ++i)
+            {
+                const Vector3f v(walker.get_vertex(i));
+                writer.write(&v, sizeof(v));
+            }
+        }
+    }
+
+    void write_vertex_normals(
+        Writer&                         writer,
+        const IMeshWalker&              walker,
+        const BinaryMeshFile::MeshHeader& header)
+    {
+        const size_t vertex_normal_count = walker.get_vertex_normal_count();
+
+        if (header.m_vertex_normal_encoding == BinaryMeshFile::NormalOctahedral16)
+        {
+            for (size_t i = 0; i < vertex_normal_count; ++i)
+            {
+                int16 q[2];
+                encode_octahedral_normal(Vector3f(walker.get_vertex_normal(i)), q);
+                writer.write(q, sizeof(q));
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < vertex_normal_count; ++i)
+            {
+                const Vector3f n(walker.get_vertex_normal(i));
+                writer.write(&n, sizeof(n));
+            }
+        }
+    }
+
+    void write_tex_coords(
+        Writer&                         writer,
+        const IMeshWalker&              walker)
+    {
+        const size_t tex_coords_count = walker.get_tex_coords_count();
+
+        for (size_t i = 0; i < tex_coords_count; ++i)
+        {
+            const Vector2f uv(walker.get_tex_coords(i));
+            writer.write(&uv, sizeof(uv));
+        }
+    }
+
+    void write_faces(
+        Writer&                         writer,
+        const IMeshWalker&              walker)
+    {
+        const size_t face_count = walker.get_face_count();
+
+        for (size_t i = 0; i < face_count; ++i)
+        {
+            const IMeshWalker::Face face = walker.get_face(i);
+
+            BinaryMeshFile::Face f;
+            f.m_v0 = to_index(face.m_v0);
+            f.m_v1 = to_index(face.m_v1);
+            f.m_v2 = to_index(face.m_v2);
+            f.m_n0 = to_index(face.m_n0);
+            f.m_n1 = to_index(face.m_n1);
+            f.m_n2 = to_index(face.m_n2);
+            f.m_t0 = to_index(face.m_t0);
+            f.m_t1 = to_index(face.m_t1);
+            f.m_t2 = to_index(face.m_t2);
+            f.m_material = to_index(face.m_material);
+
+            writer.write(&f, sizeof(f));
+        }
+    }
+}
+
+BinaryMeshFileWriter::BinaryMeshFileWriter(const int options)
+  : m_options(options)
+{
+}
+
+void BinaryMeshFileWriter::write(
+    const string&           filename,
+    const IMeshWalker&      walker)
+{
+    vector<const IMeshWalker*> walkers;
+    walkers.push_back(&walker);
+    write(filename, walkers);
+}
+
+void BinaryMeshFileWriter::write(
+    const string&                       filename,
+    const vector<const IMeshWalker*>&   walkers)
+{
+    const size_t mesh_count = walkers.size();
+
+    vector<string> names(mesh_count);
+    vector<BinaryMeshFile::MeshHeader> headers(mesh_count);
+
+    // Lay out the file: headers and names first, then the page-aligned data blocks of each mesh.
+    uint64 offset = sizeof(BinaryMeshFile::FileHeader) + mesh_count * sizeof(BinaryMeshFile::MeshHeader);
+
+    for (size_t i = 0; i < mesh_count; ++i)
+    {
+        const IMeshWalker& walker = *walkers[i];
+        BinaryMeshFile::MeshHeader& header = headers[i];
+        memset(&header, 0, sizeof(header));
+
+        names[i] = walker.get_name();
+        header.m_name_offset = offset;
+        header.m_name_length = static_cast<uint32>(names[i].size());
+        offset += header.m_name_length;
+    }
+
+    for (size_t i = 0; i < mesh_count; ++i)
+    {
+        const IMeshWalker& walker = *walkers[i];
+        BinaryMeshFile::MeshHeader& header = headers[i];
+
+        header.m_vertex_count = static_cast<uint32>(walker.get_vertex_count());
+        header.m_vertex_normal_count = static_cast<uint32>(walker.get_vertex_normal_count());
+        header.m_tex_coords_count = static_cast<uint32>(walker.get_tex_coords_count());
+        header.m_face_count = static_cast<uint32>(walker.get_face_count());
+
+        header.m_vertex_encoding =
+            (m_options & QuantizeVertices)
+                ? BinaryMeshFile::VertexQuantized16
+                : BinaryMeshFile::VertexFloat32;
+        header.m_vertex_normal_encoding =
+            (m_options & QuantizeNormals)
+                ? BinaryMeshFile::NormalOctahedral16
+                : BinaryMeshFile::NormalFloat32;
+
+        // Compute the bounding box of the mesh.
+        AABB3f bbox;
+        bbox.invalidate();
+        for (size_t j = 0; j < header.m_vertex_count; ++j)
+            bbox.insert(Vector3f(walker.get_vertex(j)));
+        if (!bbox.is_valid())
+            bbox = AABB3f(Vector3f(0.0f), Vector3f(0.0f));
+        for (size_t d = 0; d < 3; ++d)
+        {
+            header.m_bbox_min[d] = bbox.min[d];
+            header.m_bbox_max[d] = bbox.max[d];
+        }
+
+        // Determine whether every face references vertex normals.
+        bool all_faces_have_normals = header.m_vertex_normal_count > 0;
+        for (size_t j = 0; all_faces_have_normals && j < header.m_face_count; ++j)
+        {
+            const IMeshWalker::Face face = walker.get_face(j);
+            if (face.m_n0 == IMeshWalker::Face::None ||
+                face.m_n1 == IMeshWalker::Face::None ||
+                face.m_n2 == IMeshWalker::Face::None)
+                all_faces_have_normals = false;
+        }
+        if (all_faces_have_normals)
+            header.m_flags |= BinaryMeshFile::AllFacesHaveNormals;
+
+        const size_t vertex_size =
+            header.m_vertex_encoding == BinaryMeshFile::VertexQuantized16
+                ? 3 * sizeof(uint16)
+                : 3 * sizeof(float);
+        const size_t normal_size =
+            header.m_vertex_normal_encoding == BinaryMeshFile::NormalOctahedral16
+                ? 2 * sizeof(int16)
+                : 3 * sizeof(float);
+
+        header.m_vertices_offset = offset = align_offset(offset);
+        offset += static_cast<uint64>(header.m_vertex_count) * vertex_size;
+
+        header.m_vertex_normals_offset = offset = align_offset(offset);
+        offset += static_cast<uint64>(header.m_vertex_normal_count) * normal_size;
+
+        header.m_tex_coords_offset = offset = align_offset(offset);
+        offset += static_cast<uint64>(header.m_tex_coords_count) * sizeof(Vector2f);
+
+        header.m_faces_offset = offset = align_offset(offset);
+        offset += static_cast<uint64>(header.m_face_count) * sizeof(BinaryMeshFile::Face);
+    }
+
+    BinaryMeshFile::FileHeader file_header;
+    memset(&file_header, 0, sizeof(file_header));
+    memcpy(file_header.m_magic, BinaryMeshFile::Magic, sizeof(file_header.m_magic));
+    file_header.m_version = BinaryMeshFile::Version;
+    file_header.m_mesh_count = static_cast<uint32>(mesh_count);
+    file_header.m_file_size = offset;
+
+    FILE* file = fopen(filename.c_str(), "wb");
+
+    if (file == 0)
+        throw ExceptionIOError();
+
+    try
+    {
+        Writer writer(file);
+
+        writer.write(&file_header, sizeof(file_header));
+
+        for (size_t i = 0; i < mesh_count; ++i)
+            writer.write(&headers[i], sizeof(headers[i]));
+
+        for (size_t i = 0; i < mesh_count; ++i)
+            writer.write(names[i].data(), names[i].size());
+
+        for (size_t i = 0; i < mesh_count; ++i)
+        {
+            const IMeshWalker& walker = *walkers[i];
+            const BinaryMeshFile::MeshHeader& header = headers[i];
+
+            writer.pad_to(header.m_vertices_offset);
+            write_vertices(writer, walker, header);
+
+            writer.pad_to(header.m_vertex_normals_offset);
+            write_vertex_normals(writer, walker, header);
+
+            writer.pad_to(header.m_tex_coords_offset);
+            write_tex_coords(writer, walker);
+
+            writer.pad_to(header.m_faces_offset);
+            write_faces(writer, walker);
+        }
+    }
+    catch (...)
+    {
+        fclose(file);
+        throw;
+    }
+
+    fclose(file);
+}
+
+}   // namespace foundation
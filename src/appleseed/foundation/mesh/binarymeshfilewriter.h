@@ -0,0 +1,82 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MESH_BINARYMESHFILEWRITER_H
+#define APPLESEED_FOUNDATION_MESH_BINARYMESHFILEWRITER_H
+
+// appleseed.foundation headers.
+#include "foundation/mesh/imeshfilewriter.h"
+
+// Standard headers.
+#include <string>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class IMeshWalker; }
+
+namespace foundation
+{
+
+//
+// Binary mesh file writer.
+//
+// See foundation/mesh/binarymeshfile.h for a description of the format.
+//
+
+class BinaryMeshFileWriter
+  : public IMeshFileWriter
+{
+  public:
+    // Writing options.
+    enum Options
+    {
+        Defaults                = 0,
+        QuantizeVertices        = 1 << 0,       // store vertices as 16-bit integers relative to the bounding box
+        QuantizeNormals         = 1 << 1        // store vertex normals using a 16-bit octahedral encoding
+    };
+
+    // Constructor.
+    explicit BinaryMeshFileWriter(const int options = Defaults);
+
+    // Write a binary mesh file containing a single mesh.
+    virtual void write(
+        const std::string&                      filename,
+        const IMeshWalker&                      walker);
+
+    // Write a binary mesh file containing multiple meshes.
+    void write(
+        const std::string&                      filename,
+        const std::vector<const IMeshWalker*>&  walkers);
+
+  private:
+    const int   m_options;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MESH_BINARYMESHFILEWRITER_H
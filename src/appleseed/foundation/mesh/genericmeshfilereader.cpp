@@ -32,6 +32,8 @@
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionunsupportedfileformat.h"
 #include "foundation/mesh/alembicmeshfilereader.h"
+#include "foundation/mesh/binarymeshfile.h"
+#include "foundation/mesh/binarymeshfilereader.h"
 #include "foundation/mesh/objmeshfilereader.h"
 #include "foundation/utility/string.h"
 
@@ -61,6 +63,11 @@ void GenericMeshFileReader::read(
         AlembicMeshFileReader reader;
         reader.read(filename, builder);
     }
+    else if (extension == BinaryMeshFile::Extension)
+    {
+        BinaryMeshFileReader reader;
+        reader.read(filename, builder);
+    }
     else
     {
         throw ExceptionUnsupportedFileFormat(filename.c_str());
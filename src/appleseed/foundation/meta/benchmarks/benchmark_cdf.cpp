@@ -27,12 +27,14 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/math/aliastable.h"
 #include "foundation/math/cdf.h"
 #include "foundation/math/rng.h"
 #include "foundation/utility/benchmark.h"
 
 // Standard headers.
 #include <cassert>
+#include <cstddef>
 
 BENCHMARK_SUITE(Foundation_Math_CDF)
 {
@@ -64,4 +66,51 @@ BENCHMARK_SUITE(Foundation_Math_CDF)
     {
         m_x += m_cdf.sample(0.5).second;
     }
+
+    // Compare the CDF and the alias table on a distribution as large as the
+    // set of emitting triangles of a scene with heavy mesh lights.
+    template <template <typename, typename> class Distribution>
+    struct LargeFixture
+    {
+        static const size_t ItemCount = 1000000;
+        static const size_t SampleCount = 1024;
+
+        Distribution<size_t, double>    m_distribution;
+        double                          m_inputs[SampleCount];
+        double                          m_x;
+
+        LargeFixture()
+          : m_x(0.0)
+        {
+            MersenneTwister rng;
+
+            m_distribution.reserve(ItemCount);
+
+            for (size_t i = 0; i < ItemCount; ++i)
+                m_distribution.insert(i, rand_double1(rng));
+
+            assert(m_distribution.valid());
+
+            m_distribution.prepare();
+
+            for (size_t i = 0; i < SampleCount; ++i)
+                m_inputs[i] = rand_double2(rng);
+        }
+
+        void payload()
+        {
+            for (size_t i = 0; i < SampleCount; ++i)
+                m_x += m_distribution.sample(m_inputs[i]).second;
+        }
+    };
+
+    BENCHMARK_CASE_F(LargeDistributionSampling_CDF, LargeFixture<CDF>)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(LargeDistributionSampling_AliasTable, LargeFixture<AliasTable>)
+    {
+        payload();
+    }
 }
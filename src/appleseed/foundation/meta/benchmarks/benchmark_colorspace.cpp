@@ -29,8 +29,12 @@
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
+#include "foundation/image/spectrum.h"
 #include "foundation/utility/benchmark.h"
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 
 BENCHMARK_SUITE(Foundation_Image_ColorSpace)
@@ -55,4 +59,28 @@ BENCHMARK_SUITE(Foundation_Image_ColorSpace)
     {
         m_output = fast_linear_rgb_to_srgb(m_input);
     }
+
+    struct SpectrumFixture
+    {
+        const LightingConditions    m_lighting_conditions;
+        Spectrum31f                 m_input;
+        Color3f                     m_output;
+
+        SpectrumFixture()
+          : m_lighting_conditions(IlluminantCIED65, XYZCMFCIE196410Deg)
+        {
+            for (size_t i = 0; i < Spectrum31f::Samples; ++i)
+                m_input[i] = 0.5f + 0.01f * i;
+        }
+    };
+
+    BENCHMARK_CASE_F(SpectrumToCIEXYZConversion, SpectrumFixture)
+    {
+        m_output = spectrum_to_ciexyz<float>(m_lighting_conditions, m_input);
+    }
+
+    BENCHMARK_CASE_F(SpectrumToLuminanceConversion, SpectrumFixture)
+    {
+        m_output[0] = spectrum_to_luminance<float>(m_lighting_conditions, m_input);
+    }
 }
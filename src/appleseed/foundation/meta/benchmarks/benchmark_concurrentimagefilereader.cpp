@@ -0,0 +1,207 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/concurrentimagefilereader.h"
+#include "foundation/image/exrimagefilewriter.h"
+#include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/thread.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace std;
+
+BENCHMARK_SUITE(Foundation_Image_ConcurrentImageFileReader)
+{
+    const char* Filename = "unit benchmarks/outputs/benchmark_concurrentimagefilereader.exr";
+
+    // Every benchmark iteration reads all the tiles of a 1024x1024 image made of 64x64 tiles.
+    const size_t ImageSize = 1024;
+    const size_t TileSize = 64;
+    const size_t TileCount = (ImageSize / TileSize) * (ImageSize / TileSize);
+
+    void write_test_image_file()
+    {
+        static bool written = false;
+
+        if (!written)
+        {
+            Image image(ImageSize, ImageSize, TileSize, TileSize, 4, PixelFormatFloat);
+            image.clear(Color4f(0.2f, 0.4f, 0.6f, 1.0f));
+
+            EXRImageFileWriter writer;
+            writer.write(Filename, image);
+
+            written = true;
+        }
+    }
+
+    // Reads tiles through a single reader shared by all threads, as DiskTexture2d used to do.
+    struct LockedReader
+    {
+        boost::mutex                        m_mutex;
+        GenericProgressiveImageFileReader   m_reader;
+
+        LockedReader()
+        {
+            m_reader.open(Filename);
+        }
+
+        Tile* read_tile(const size_t tile_x, const size_t tile_y)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            return m_reader.read_tile(tile_x, tile_y);
+        }
+    };
+
+    // Reads tiles through a pool of readers.
+    struct PooledReader
+    {
+        ConcurrentImageFileReader           m_reader;
+
+        PooledReader()
+        {
+            m_reader.open(Filename);
+        }
+
+        Tile* read_tile(const size_t tile_x, const size_t tile_y)
+        {
+            return m_reader.read_tile(tile_x, tile_y);
+        }
+    };
+
+    template <typename Reader>
+    struct ReadTilesJob
+      : public IJob
+    {
+        Reader*     m_reader;
+        size_t      m_begin;
+        size_t      m_end;
+
+        virtual void execute(const size_t thread_index)
+        {
+            const size_t tile_count_x = ImageSize / TileSize;
+
+            for (size_t i = m_begin; i < m_end; ++i)
+                delete m_reader->read_tile(i % tile_count_x, i / tile_count_x);
+        }
+    };
+
+    template <typename Reader, size_t ThreadCount>
+    struct Fixture
+    {
+        Logger                  m_logger;
+        JobQueue                m_job_queue;
+        JobManager              m_job_manager;
+        Reader*                 m_reader;
+        ReadTilesJob<Reader>    m_jobs[ThreadCount];
+
+        Fixture()
+          : m_job_manager(m_logger, m_job_queue, ThreadCount)
+        {
+            write_test_image_file();
+
+            m_reader = new Reader();
+
+            for (size_t i = 0; i < ThreadCount; ++i)
+            {
+                m_jobs[i].m_reader = m_reader;
+                m_jobs[i].m_begin = (i * TileCount) / ThreadCount;
+                m_jobs[i].m_end = ((i + 1) * TileCount) / ThreadCount;
+            }
+
+            m_job_manager.start();
+        }
+
+        ~Fixture()
+        {
+            delete m_reader;
+        }
+
+        void payload()
+        {
+            for (size_t i = 0; i < ThreadCount; ++i)
+                m_job_queue.schedule(&m_jobs[i], false);
+
+            m_job_queue.wait_until_completion();
+        }
+    };
+
+    typedef Fixture<LockedReader, 1> LockedReaderFixture1;
+    typedef Fixture<LockedReader, 4> LockedReaderFixture4;
+    typedef Fixture<LockedReader, 8> LockedReaderFixture8;
+    typedef Fixture<PooledReader, 1> PooledReaderFixture1;
+    typedef Fixture<PooledReader, 2> PooledReaderFixture2;
+    typedef Fixture<PooledReader, 4> PooledReaderFixture4;
+    typedef Fixture<PooledReader, 8> PooledReaderFixture8;
+
+    BENCHMARK_CASE_F(ReadTiles_LockedReader_SingleThreaded, LockedReaderFixture1)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(ReadTiles_LockedReader_QuadThreaded, LockedReaderFixture4)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(ReadTiles_LockedReader_OctoThreaded, LockedReaderFixture8)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(ReadTiles_PooledReader_SingleThreaded, PooledReaderFixture1)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(ReadTiles_PooledReader_DoubleThreaded, PooledReaderFixture2)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(ReadTiles_PooledReader_QuadThreaded, PooledReaderFixture4)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(ReadTiles_PooledReader_OctoThreaded, PooledReaderFixture8)
+    {
+        payload();
+    }
+}
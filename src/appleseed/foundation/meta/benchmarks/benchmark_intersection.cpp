@@ -27,7 +27,9 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/aabb.h"
+#include "foundation/math/bvh.h"
 #include "foundation/math/intersection.h"
 #include "foundation/math/ray.h"
 #include "foundation/math/rng.h"
@@ -37,8 +39,11 @@
 #include "foundation/utility/benchmark.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
 #include <limits>
+#include <utility>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -299,3 +304,152 @@ BENCHMARK_SUITE(Foundation_Math_Intersection_RayTriangleSSK)
     BENCHMARK_CASE_F(Intersect_DoublePrecision_HitRateIs66Percents, FixtureDouble66) { payload(); }
     BENCHMARK_CASE_F(Intersect_DoublePrecision_HitRateIs100Percents, FixtureDouble100) { payload(); }
 };
+
+BENCHMARK_SUITE(Foundation_Math_Intersection_RayBVH)
+{
+    typedef bvh::QTree<float, 3, size_t> Tree;
+
+    struct BboxCenterPredicate
+    {
+        const size_t m_dim;
+
+        explicit BboxCenterPredicate(const size_t dim)
+          : m_dim(dim)
+        {
+        }
+
+        bool operator()(const pair<AABB3f, size_t>& lhs, const pair<AABB3f, size_t>& rhs) const
+        {
+            return lhs.first.center()[m_dim] < rhs.first.center()[m_dim];
+        }
+    };
+
+    struct MedianPartitioner
+      : public NonCopyable
+    {
+        size_t partition(
+            vector<size_t>&         items,
+            vector<AABB3f>&         bboxes,
+            const size_t            begin,
+            const size_t            end,
+            const AABB3f&           bbox)
+        {
+            vector<pair<AABB3f, size_t> > entries;
+            for (size_t i = begin; i < end; ++i)
+                entries.push_back(make_pair(bboxes[i], items[i]));
+
+            sort(entries.begin(), entries.end(), BboxCenterPredicate(max_index(bbox.extent())));
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                bboxes[i] = entries[i - begin].first;
+                items[i] = entries[i - begin].second;
+            }
+
+            return (begin + end) / 2;
+        }
+    };
+
+    struct ClosestHitVisitor
+      : public NonCopyable
+    {
+        double m_closest_hit;
+
+        ClosestHitVisitor()
+          : m_closest_hit(numeric_limits<double>::max())
+        {
+        }
+
+        bool visit(
+            const vector<size_t>&   items,
+            const vector<AABB3f>&   bboxes,
+            const size_t            begin,
+            const size_t            end,
+            const Ray3d&            ray,
+            const RayInfo3d&        ray_info,
+            const double            tmin,
+            const double            tmax,
+            double&                 distance)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                double t;
+
+                if (intersect(ray, ray_info, AABB3d(bboxes[i]), t) && m_closest_hit > t)
+                    m_closest_hit = t;
+            }
+
+            distance = m_closest_hit;
+            return true;
+        }
+    };
+
+    // Emulate a scene with a few thousand assembly instances.
+    struct Fixture
+      : public FixtureBase<double>
+    {
+        static const size_t ItemCount = 4096;
+        static const size_t RayCount = 1000;
+
+        Tree            m_tree;
+        Ray3d           m_ray[RayCount];
+        RayInfo3d       m_ray_info[RayCount];
+
+        double          m_distance;
+
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        bvh::TraversalStatistics m_traversal_stats;
+#endif
+
+        Fixture()
+          : m_distance(0.0)
+        {
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < ItemCount; ++i)
+            {
+                const Vector3f center(get_random_vector<3>(rng, -5.0, 5.0));
+                const Vector3f extent(get_random_vector<3>(rng, 0.01, 0.2));
+                m_tree.insert(i, AABB3f(center - extent, center + extent));
+            }
+
+            MedianPartitioner partitioner;
+            bvh::Builder<Tree, MedianPartitioner> builder;
+            builder.build(m_tree, partitioner);
+
+            bvh::QBuilder<Tree> qbuilder;
+            qbuilder.build(m_tree);
+
+            for (size_t i = 0; i < RayCount; ++i)
+                get_random_ray(rng, 10.0, m_ray[i], m_ray_info[i]);
+        }
+
+        template <typename Intersector>
+        FORCE_INLINE void payload()
+        {
+            Intersector intersector;
+
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                ClosestHitVisitor visitor;
+                intersector.intersect(
+                    m_tree,
+                    m_ray[i],
+                    m_ray_info[i],
+                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , m_traversal_stats
+#endif
+                    );
+                m_distance += visitor.m_closest_hit;
+            }
+        }
+    };
+
+    // We need these typedefs because we can't use commas in macro parameters.
+    typedef bvh::Intersector<double, Tree, ClosestHitVisitor> BinaryIntersector;
+    typedef bvh::QIntersector<double, Tree, ClosestHitVisitor> QIntersector;
+
+    BENCHMARK_CASE_F(Intersect_BinaryBVH, Fixture) { payload<BinaryIntersector>(); }
+    BENCHMARK_CASE_F(Intersect_QBVH, Fixture) { payload<QIntersector>(); }
+}
@@ -81,4 +81,122 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
     {
         payload();
     }
+
+    // A job performing a fixed amount of arithmetic, then optionally scheduling
+    // child jobs from the worker thread, which other threads then have to steal.
+    class BusyJob
+      : public IJob
+    {
+      public:
+        BusyJob(
+            JobQueue&       job_queue,
+            const size_t    child_count,
+            volatile double& sink)
+          : m_job_queue(job_queue)
+          , m_child_count(child_count)
+          , m_sink(sink)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            for (size_t i = 0; i < m_child_count; ++i)
+                m_job_queue.schedule(new BusyJob(m_job_queue, 0, m_sink));
+
+            double x = 1.0;
+            for (size_t i = 0; i < 2000; ++i)
+                x = x * 0.999 + 0.001;
+
+            m_sink = x;
+        }
+
+      private:
+        JobQueue&           m_job_queue;
+        const size_t        m_child_count;
+        volatile double&    m_sink;
+    };
+
+    template <size_t ThreadCount>
+    struct ScalingFixture
+    {
+        Logger              m_logger;
+        JobQueue            m_job_queue;
+        JobManager          m_job_manager;
+        volatile double     m_sink;
+
+        ScalingFixture()
+          : m_job_manager(m_logger, m_job_queue, ThreadCount)
+          , m_sink(0.0)
+        {
+            m_job_manager.start();
+        }
+
+        // Schedule many independent jobs from the calling thread.
+        void flat_payload()
+        {
+            for (size_t i = 0; i < 1024; ++i)
+                m_job_queue.schedule(new BusyJob(m_job_queue, 0, m_sink));
+
+            m_job_queue.wait_until_completion();
+        }
+
+        // Schedule a few jobs that each spawn many child jobs.
+        void nested_payload()
+        {
+            for (size_t i = 0; i < 16; ++i)
+                m_job_queue.schedule(new BusyJob(m_job_queue, 63, m_sink));
+
+            m_job_queue.wait_until_completion();
+        }
+    };
+
+    BENCHMARK_CASE_F(FlatJobExecution_1Thread, ScalingFixture<1>)
+    {
+        flat_payload();
+    }
+
+    BENCHMARK_CASE_F(FlatJobExecution_4Threads, ScalingFixture<4>)
+    {
+        flat_payload();
+    }
+
+    BENCHMARK_CASE_F(FlatJobExecution_16Threads, ScalingFixture<16>)
+    {
+        flat_payload();
+    }
+
+    BENCHMARK_CASE_F(FlatJobExecution_64Threads, ScalingFixture<64>)
+    {
+        flat_payload();
+    }
+
+    BENCHMARK_CASE_F(FlatJobExecution_128Threads, ScalingFixture<128>)
+    {
+        flat_payload();
+    }
+
+    BENCHMARK_CASE_F(NestedJobExecution_1Thread, ScalingFixture<1>)
+    {
+        nested_payload();
+    }
+
+    BENCHMARK_CASE_F(NestedJobExecution_4Threads, ScalingFixture<4>)
+    {
+        nested_payload();
+    }
+
+    BENCHMARK_CASE_F(NestedJobExecution_16Threads, ScalingFixture<16>)
+    {
+        nested_payload();
+    }
+
+    BENCHMARK_CASE_F(NestedJobExecution_64Threads, ScalingFixture<64>)
+    {
+        nested_payload();
+    }
+
+    BENCHMARK_CASE_F(NestedJobExecution_128Threads, ScalingFixture<128>)
+    {
+        nested_payload();
+    }
 }
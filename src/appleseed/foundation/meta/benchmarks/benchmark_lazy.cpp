@@ -0,0 +1,141 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/lazy.h"
+#include "foundation/utility/log.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+BENCHMARK_SUITE(Foundation_Utility_Lazy)
+{
+    struct Object
+    {
+        size_t m_value;
+    };
+
+    struct ObjectFactory
+      : public ILazyFactory<Object>
+    {
+        virtual auto_ptr<Object> create()
+        {
+            auto_ptr<Object> object(new Object());
+            object->m_value = 1;
+            return object;
+        }
+    };
+
+    // A few popular objects, as when many instances share the same assemblies.
+    const size_t ObjectCount = 4;
+    const size_t AccessCount = 10000;
+
+    struct AccessJob
+      : public IJob
+    {
+        Lazy<Object>**  m_objects;
+        size_t          m_sum;
+
+        AccessJob()
+          : m_objects(0)
+          , m_sum(0)
+        {
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            Access<Object> access;
+
+            for (size_t i = 0; i < AccessCount; ++i)
+            {
+                access.reset(m_objects[(i + thread_index) % ObjectCount]);
+                m_sum += access->m_value;
+            }
+        }
+    };
+
+    template <size_t ThreadCount>
+    struct Fixture
+    {
+        Logger          m_logger;
+        JobQueue        m_job_queue;
+        JobManager      m_job_manager;
+        Lazy<Object>*   m_objects[ObjectCount];
+        AccessJob       m_jobs[ThreadCount];
+
+        Fixture()
+          : m_job_manager(m_logger, m_job_queue, ThreadCount)
+        {
+            for (size_t i = 0; i < ObjectCount; ++i)
+            {
+                m_objects[i] = new Lazy<Object>(auto_ptr<ILazyFactory<Object> >(new ObjectFactory()));
+                Access<Object> access(m_objects[i]);
+            }
+
+            for (size_t i = 0; i < ThreadCount; ++i)
+                m_jobs[i].m_objects = m_objects;
+
+            m_job_manager.start();
+        }
+
+        ~Fixture()
+        {
+            for (size_t i = 0; i < ObjectCount; ++i)
+                delete m_objects[i];
+        }
+
+        void payload()
+        {
+            for (size_t i = 0; i < ThreadCount; ++i)
+                m_job_queue.schedule(&m_jobs[i], false);
+
+            m_job_queue.wait_until_completion();
+        }
+    };
+
+    BENCHMARK_CASE_F(SingleThreadedAccess, Fixture<1>)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(QuadThreadedAccess, Fixture<4>)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(OctoThreadedAccess, Fixture<8>)
+    {
+        payload();
+    }
+}
@@ -30,6 +30,10 @@
 #include "foundation/math/permutation.h"
 #include "foundation/math/primes.h"
 #include "foundation/math/qmc.h"
+#include "foundation/math/rng.h"
+#include "foundation/math/sampling/qmcsamplingcontext.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/benchmark.h"
 
 // Standard headers.
@@ -110,8 +114,55 @@ BENCHMARK_SUITE(Foundation_Math_QMC)
             for (size_t i = 0; i < 64; ++i)
                 m_x += hammersley_sequence<T, 2>(Bases, i, 64);
         }
+
+        void sobol02_payload()
+        {
+            m_x = Vector<T, 2>(0.0f);
+
+            for (uint32 i = 0; i < 64; ++i)
+                m_x += sobol02_sequence<T>(i);
+        }
+
+        void owen_scrambled_sobol02_payload()
+        {
+            m_x = Vector<T, 2>(0.0f);
+
+            for (uint32 i = 0; i < 64; ++i)
+                m_x += owen_scrambled_sobol02_sequence<T>(i, i);
+        }
+    };
+
+    // Simulate the sampling pattern of a path tracer: 16 pixel samples,
+    // each followed by 4 light samples, drawn from 2D sampling contexts.
+    template <QMCSamplingContext<MersenneTwister>::Mode Mode>
+    struct SamplingContextFixture
+    {
+        typedef QMCSamplingContext<MersenneTwister> SamplingContext;
+
+        MersenneTwister m_rng;
+        Vector2d        m_x;
+
+        void payload()
+        {
+            m_x = Vector2d(0.0);
+
+            SamplingContext sampling_context(m_rng, 2, 16, 0, Mode);
+
+            for (size_t i = 0; i < 16; ++i)
+            {
+                m_x += sampling_context.next_vector2<2>();
+
+                SamplingContext child_sampling_context = sampling_context.split(2, 4);
+
+                for (size_t j = 0; j < 4; ++j)
+                    m_x += child_sampling_context.next_vector2<2>();
+            }
+        }
     };
 
+    typedef SamplingContextFixture<QMCSamplingContext<MersenneTwister>::HaltonMode> HaltonSamplingContextFixture;
+    typedef SamplingContextFixture<QMCSamplingContext<MersenneTwister>::SobolMode> SobolSamplingContextFixture;
+
     BENCHMARK_CASE_F(RadicalInverseBase2_SinglePrecision, ScalarFixture<float>)
     {
         radical_inverse_base2_payload();
@@ -161,4 +212,34 @@ BENCHMARK_SUITE(Foundation_Math_QMC)
     {
         hammersley_payload();
     }
+
+    BENCHMARK_CASE_F(Sobol02Sequence_SinglePrecision, Vector2Fixture<float>)
+    {
+        sobol02_payload();
+    }
+
+    BENCHMARK_CASE_F(Sobol02Sequence_DoublePrecision, Vector2Fixture<double>)
+    {
+        sobol02_payload();
+    }
+
+    BENCHMARK_CASE_F(OwenScrambledSobol02Sequence_SinglePrecision, Vector2Fixture<float>)
+    {
+        owen_scrambled_sobol02_payload();
+    }
+
+    BENCHMARK_CASE_F(OwenScrambledSobol02Sequence_DoublePrecision, Vector2Fixture<double>)
+    {
+        owen_scrambled_sobol02_payload();
+    }
+
+    BENCHMARK_CASE_F(QMCSamplingContext_HaltonMode, HaltonSamplingContextFixture)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(QMCSamplingContext_SobolMode, SobolSamplingContextFixture)
+    {
+        payload();
+    }
 }
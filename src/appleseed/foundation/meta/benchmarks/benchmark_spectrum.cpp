@@ -30,6 +30,10 @@
 #include "foundation/image/spectrum.h"
 #include "foundation/utility/benchmark.h"
 
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+
 BENCHMARK_SUITE(Foundation_Image_Spectrum31f)
 {
     using namespace foundation;
@@ -38,10 +42,18 @@ BENCHMARK_SUITE(Foundation_Image_Spectrum31f)
     {
         Spectrum31f m_spectrum1;
         Spectrum31f m_spectrum2;
+        Spectrum31f m_spectrum3;
+        Spectrum31f m_zero;
+        float       m_value;
+        size_t      m_zero_count;
 
         Fixture()
           : m_spectrum1(42.0f)
           , m_spectrum2(1.1f)
+          , m_spectrum3(0.9f)
+          , m_zero(0.0f)
+          , m_value(0.0f)
+          , m_zero_count(0)
         {
         }
     };
@@ -65,4 +77,54 @@ BENCHMARK_SUITE(Foundation_Image_Spectrum31f)
     {
         m_spectrum1 *= m_spectrum2;
     }
+
+    BENCHMARK_CASE_F(Addition, Fixture)
+    {
+        m_spectrum1 = m_spectrum1 + m_spectrum2;
+    }
+
+    BENCHMARK_CASE_F(MultiplicationByScalar, Fixture)
+    {
+        m_spectrum1 = m_spectrum1 * 1.1f;
+    }
+
+    BENCHMARK_CASE_F(MultiplicationBySpectrum, Fixture)
+    {
+        m_spectrum1 = m_spectrum1 * m_spectrum2;
+    }
+
+    BENCHMARK_CASE_F(DivisionBySpectrum, Fixture)
+    {
+        m_spectrum1 = m_spectrum2 / m_spectrum3;
+    }
+
+    BENCHMARK_CASE_F(MultiplyAdd, Fixture)
+    {
+        madd(m_spectrum1, m_spectrum2, m_spectrum3);
+    }
+
+    BENCHMARK_CASE_F(Max, Fixture)
+    {
+        m_spectrum1 = std::max(m_spectrum1, m_spectrum2);
+    }
+
+    BENCHMARK_CASE_F(MaxValue, Fixture)
+    {
+        m_value += max_value(m_spectrum1);
+    }
+
+    BENCHMARK_CASE_F(AverageValue, Fixture)
+    {
+        m_value += average_value(m_spectrum1);
+    }
+
+    BENCHMARK_CASE_F(Fz_GivenNonZeroSpectrum, Fixture)
+    {
+        m_zero_count += fz(m_spectrum1) ? 1 : 0;
+    }
+
+    BENCHMARK_CASE_F(Fz_GivenZeroSpectrum, Fixture)
+    {
+        m_zero_count += fz(m_zero) ? 1 : 0;
+    }
 }
@@ -28,6 +28,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/rng.h"
+#include "foundation/math/sparsevoxelgrid.h"
 #include "foundation/math/vector.h"
 #include "foundation/math/voxelgrid.h"
 #include "foundation/utility/benchmark.h"
@@ -40,12 +41,13 @@ using namespace foundation;
 
 BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
 {
+    const size_t ChannelCount = 4;
+    const size_t LookupPointCount = 64;
+
+    template <typename Grid>
     struct Fixture
     {
-        static const size_t ChannelCount = 4;
-        static const size_t LookupPointCount = 64;
-
-        VoxelGrid3<float, double>   m_grid;
+        Grid                        m_grid;
         Vector3d                    m_lookup_points[LookupPointCount];
         float                       m_accumulated_values[ChannelCount];
 
@@ -71,9 +73,9 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
             for (size_t i = 0; i < LookupPointCount; ++i)
             {
                 Vector3d& p = m_lookup_points[i];
-                p[0] = rand_double1(rng, 0.0, m_grid.get_xres());
-                p[1] = rand_double1(rng, 0.0, m_grid.get_yres());
-                p[2] = rand_double1(rng, 0.0, m_grid.get_zres());
+                p[0] = rand_double1(rng);
+                p[1] = rand_double1(rng);
+                p[2] = rand_double1(rng);
             }
 
             for (size_t i = 0; i < ChannelCount; ++i)
@@ -81,7 +83,46 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
         }
     };
 
-    BENCHMARK_CASE_F(NearestLookup, Fixture)
+    typedef Fixture<VoxelGrid3<float, double> > DenseFixture;
+    typedef Fixture<SparseVoxelGrid3<float, double> > SparseFixture;
+
+    BENCHMARK_CASE_F(NearestLookup, DenseFixture)
+    {
+        for (size_t i = 0; i < LookupPointCount; ++i)
+        { 
+            ALIGN_SSE_VARIABLE float values[ChannelCount];
+            m_grid.nearest_lookup(m_lookup_points[i], values);
+
+            for (size_t j = 0; j < ChannelCount; ++j)
+                m_accumulated_values[j] += values[j];
+        }
+    }
+
+    BENCHMARK_CASE_F(LinearLookup, DenseFixture)
+    {
+        for (size_t i = 0; i < LookupPointCount; ++i)
+        { 
+            ALIGN_SSE_VARIABLE float values[ChannelCount];
+            m_grid.linear_lookup(m_lookup_points[i], values);
+
+            for (size_t j = 0; j < ChannelCount; ++j)
+                m_accumulated_values[j] += values[j];
+        }
+    }
+
+    BENCHMARK_CASE_F(QuadraticLookup, DenseFixture)
+    {
+        for (size_t i = 0; i < LookupPointCount; ++i)
+        { 
+            ALIGN_SSE_VARIABLE float values[ChannelCount];
+            m_grid.quadratic_lookup(m_lookup_points[i], values);
+
+            for (size_t j = 0; j < ChannelCount; ++j)
+                m_accumulated_values[j] += values[j];
+        }
+    }
+
+    BENCHMARK_CASE_F(SparseNearestLookup, SparseFixture)
     {
         for (size_t i = 0; i < LookupPointCount; ++i)
         { 
@@ -93,7 +134,7 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
         }
     }
 
-    BENCHMARK_CASE_F(LinearLookup, Fixture)
+    BENCHMARK_CASE_F(SparseLinearLookup, SparseFixture)
     {
         for (size_t i = 0; i < LookupPointCount; ++i)
         { 
@@ -105,7 +146,7 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
         }
     }
 
-    BENCHMARK_CASE_F(QuadraticLookup, Fixture)
+    BENCHMARK_CASE_F(SparseQuadraticLookup, SparseFixture)
     {
         for (size_t i = 0; i < LookupPointCount; ++i)
         { 
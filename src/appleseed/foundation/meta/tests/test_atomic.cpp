@@ -0,0 +1,127 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+TEST_SUITE(Foundation_Platform_Atomic)
+{
+    using namespace foundation;
+
+    TEST_CASE(AtomicRead_ReturnsLastWrittenValue)
+    {
+        volatile uint32 value = 0;
+
+        atomic_write(&value, 42);
+
+        EXPECT_EQ(42, atomic_read(&value));
+    }
+
+    TEST_CASE(AtomicAdd_ReturnsNewValue)
+    {
+        volatile uint32 value = 40;
+
+        EXPECT_EQ(42, atomic_add(&value, 2));
+        EXPECT_EQ(42, value);
+    }
+
+    TEST_CASE(AtomicIncAndDec_ReturnNewValue)
+    {
+        volatile uint32 value = 41;
+
+        EXPECT_EQ(42, atomic_inc(&value));
+        EXPECT_EQ(41, atomic_dec(&value));
+    }
+
+    TEST_CASE(AtomicCAS_GivenExpectedValue_ReplacesValueAndReturnsPreviousValue)
+    {
+        volatile uint32 value = 1;
+
+        EXPECT_EQ(1, atomic_cas(&value, 1, 2));
+        EXPECT_EQ(2, value);
+    }
+
+    TEST_CASE(AtomicCAS_GivenUnexpectedValue_LeavesValueUnchangedAndReturnsCurrentValue)
+    {
+        volatile uint32 value = 1;
+
+        EXPECT_EQ(1, atomic_cas(&value, 3, 2));
+        EXPECT_EQ(1, value);
+    }
+
+    TEST_CASE(AtomicCAS_GivenPointers_ReplacesPointerIfExpected)
+    {
+        int a, b;
+        int* volatile ptr = &a;
+
+        EXPECT_EQ(&a, atomic_cas(&ptr, &a, &b));
+        EXPECT_EQ(&b, atomic_read(&ptr));
+
+        EXPECT_EQ(&b, atomic_cas(&ptr, &a, &a));
+        EXPECT_EQ(&b, atomic_read(&ptr));
+    }
+
+    struct Incrementer
+    {
+        volatile uint32*    m_value;
+        size_t              m_count;
+
+        Incrementer(volatile uint32* value, const size_t count)
+          : m_value(value)
+          , m_count(count)
+        {
+        }
+
+        void operator()()
+        {
+            for (size_t i = 0; i < m_count; ++i)
+                atomic_inc(m_value);
+        }
+    };
+
+    TEST_CASE(AtomicInc_GivenConcurrentIncrements_DoesNotLoseAnyIncrement)
+    {
+        const size_t ThreadCount = 4;
+        const size_t IncrementCount = 100000;
+
+        volatile uint32 value = 0;
+
+        boost::thread_group threads;
+        for (size_t i = 0; i < ThreadCount; ++i)
+            threads.create_thread(Incrementer(&value, IncrementCount));
+        threads.join_all();
+
+        EXPECT_EQ(ThreadCount * IncrementCount, value);
+    }
+}
@@ -0,0 +1,276 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark/benchmarkbaseline.h"
+#include "foundation/utility/benchmark/regressionbenchmarklistener.h"
+#include "foundation/utility/benchmark/timingresult.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Utility_Benchmark_BenchmarkBaseline)
+{
+    TEST_CASE(LoadFile_GivenBenchmarkFile_LoadsTimingResults)
+    {
+        BenchmarkBaseline baseline;
+        const bool success = baseline.load_file("unit tests/inputs/test_benchmarkbaseline/benchmark.xml");
+
+        ASSERT_TRUE(success);
+        EXPECT_EQ(2, baseline.size());
+
+        const TimingResult* result = baseline.get("Suite", "Case1");
+
+        ASSERT_NEQ(0, result);
+        EXPECT_EQ(12, result->m_iteration_count);
+        EXPECT_EQ(2000, result->m_measurement_count);
+        EXPECT_EQ(2.0e9, result->m_frequency);
+        EXPECT_EQ(780.0, result->m_ticks);
+        EXPECT_EQ(800.0, result->m_mean_ticks);
+        EXPECT_EQ(20.0, result->m_dev_ticks);
+    }
+
+    TEST_CASE(LoadFile_GivenResultsWithoutStatistics_LeavesMeanRunningTimeNegative)
+    {
+        BenchmarkBaseline baseline;
+        baseline.load_file("unit tests/inputs/test_benchmarkbaseline/benchmark.xml");
+
+        const TimingResult* result = baseline.get("Suite", "Case2");
+
+        ASSERT_NEQ(0, result);
+        EXPECT_EQ(877.22, result->m_ticks);
+        EXPECT_LT(0.0, result->m_mean_ticks);
+    }
+
+    TEST_CASE(LoadFile_GivenNonBenchmarkFile_ReturnsFalse)
+    {
+        BenchmarkBaseline baseline;
+        const bool success = baseline.load_file("unit tests/inputs/test_benchmarkbaseline/non benchmark file.xml");
+
+        EXPECT_FALSE(success);
+        EXPECT_EQ(0, baseline.size());
+    }
+
+    TEST_CASE(LoadFile_GivenMalformedFile_ReturnsFalse)
+    {
+        BenchmarkBaseline baseline;
+        const bool success = baseline.load_file("unit tests/inputs/test_benchmarkbaseline/malformed file.xml");
+
+        EXPECT_FALSE(success);
+        EXPECT_EQ(0, baseline.size());
+    }
+
+    TEST_CASE(LoadDirectory_GivenDirectoryWithInvalidFiles_LoadsValidFilesOnly)
+    {
+        BenchmarkBaseline baseline;
+        const size_t loaded_file_count = baseline.load_directory("unit tests/inputs/test_benchmarkbaseline/");
+
+        EXPECT_EQ(1, loaded_file_count);
+        EXPECT_EQ(2, baseline.size());
+    }
+
+    TEST_CASE(Get_GivenUnknownBenchmarkCase_ReturnsNull)
+    {
+        BenchmarkBaseline baseline;
+        baseline.load_file("unit tests/inputs/test_benchmarkbaseline/benchmark.xml");
+
+        EXPECT_EQ(0, baseline.get("Suite", "Case3"));
+    }
+
+    TEST_CASE(LoadFile_GivenSameFileTwice_PoolsMeasurements)
+    {
+        BenchmarkBaseline baseline;
+        baseline.load_file("unit tests/inputs/test_benchmarkbaseline/benchmark.xml");
+        baseline.load_file("unit tests/inputs/test_benchmarkbaseline/benchmark.xml");
+
+        const TimingResult* result = baseline.get("Suite", "Case1");
+
+        ASSERT_NEQ(0, result);
+        EXPECT_EQ(4000, result->m_measurement_count);
+        EXPECT_FEQ(800.0, result->m_mean_ticks);
+        EXPECT_FEQ(20.0, result->m_dev_ticks);
+    }
+
+    TimingResult make_timing_result(
+        const size_t    measurement_count,
+        const double    frequency,
+        const double    mean_ticks,
+        const double    dev_ticks)
+    {
+        TimingResult result;
+        result.m_iteration_count = 1;
+        result.m_measurement_count = measurement_count;
+        result.m_frequency = frequency;
+        result.m_ticks = mean_ticks - dev_ticks;
+        result.m_mean_ticks = mean_ticks;
+        result.m_dev_ticks = dev_ticks;
+        return result;
+    }
+
+    TEST_CASE(PoolTimingResults_GivenDifferentMeans_ReturnsCombinedMeanAndDeviation)
+    {
+        // { 1, 3 } and { 5, 7 }.
+        const TimingResult lhs = make_timing_result(2, 1.0, 2.0, 1.0);
+        const TimingResult rhs = make_timing_result(2, 1.0, 6.0, 1.0);
+
+        const TimingResult result = pool_timing_results(lhs, rhs);
+
+        EXPECT_EQ(4, result.m_measurement_count);
+        EXPECT_FEQ(4.0, result.m_mean_ticks);
+        EXPECT_FEQ(2.2360679774997898, result.m_dev_ticks);
+        EXPECT_FEQ(1.0, result.m_ticks);
+    }
+
+    TEST_CASE(PoolTimingResults_GivenDifferentFrequencies_ExpressesResultInTicksOfFirstResult)
+    {
+        const TimingResult lhs = make_timing_result(10, 1000.0, 100.0, 0.0);
+        const TimingResult rhs = make_timing_result(10, 2000.0, 200.0, 0.0);
+
+        const TimingResult result = pool_timing_results(lhs, rhs);
+
+        EXPECT_EQ(1000.0, result.m_frequency);
+        EXPECT_FEQ(100.0, result.m_mean_ticks);
+        EXPECT_FEQ(0.0, result.m_dev_ticks);
+    }
+
+    TEST_CASE(PoolTimingResults_GivenResultWithoutStatistics_ReturnsResultWithoutStatistics)
+    {
+        const TimingResult lhs = make_timing_result(10, 1.0, 100.0, 0.0);
+        TimingResult rhs = make_timing_result(10, 1.0, 80.0, 0.0);
+        rhs.m_mean_ticks = -1.0;
+
+        const TimingResult result = pool_timing_results(lhs, rhs);
+
+        EXPECT_EQ(20, result.m_measurement_count);
+        EXPECT_FEQ(80.0, result.m_ticks);
+        EXPECT_LT(0.0, result.m_mean_ticks);
+    }
+}
+
+TEST_SUITE(Foundation_Utility_Benchmark_RegressionBenchmarkListener)
+{
+    TimingResult make_timing_result(
+        const size_t    measurement_count,
+        const double    frequency,
+        const double    mean_ticks,
+        const double    dev_ticks)
+    {
+        TimingResult result;
+        result.m_iteration_count = 1;
+        result.m_measurement_count = measurement_count;
+        result.m_frequency = frequency;
+        result.m_ticks = mean_ticks - dev_ticks;
+        result.m_mean_ticks = mean_ticks;
+        result.m_dev_ticks = dev_ticks;
+        return result;
+    }
+
+    TEST_CASE(CompareTimingResults_GivenIdenticalResults_ReturnsIntervalAroundOne)
+    {
+        const TimingResult result = make_timing_result(100, 1.0e9, 1000.0, 50.0);
+
+        const TimingComparison comparison = compare_timing_results(result, result);
+
+        EXPECT_FEQ(1.0, comparison.m_ratio);
+        EXPECT_GT(1.0, comparison.m_ratio_high);
+        EXPECT_LT(1.0, comparison.m_ratio_low);
+    }
+
+    TEST_CASE(CompareTimingResults_GivenExactResults_ReturnsEmptyInterval)
+    {
+        const TimingResult baseline = make_timing_result(100, 1.0e9, 1000.0, 0.0);
+        const TimingResult result = make_timing_result(100, 1.0e9, 1100.0, 0.0);
+
+        const TimingComparison comparison = compare_timing_results(baseline, result);
+
+        EXPECT_FEQ(1.1, comparison.m_ratio);
+        EXPECT_FEQ(1.1, comparison.m_ratio_low);
+        EXPECT_FEQ(1.1, comparison.m_ratio_high);
+    }
+
+    TEST_CASE(CompareTimingResults_GivenDifferentFrequencies_ComparesRunningTimesInSeconds)
+    {
+        const TimingResult baseline = make_timing_result(100, 1.0e9, 1000.0, 0.0);
+        const TimingResult result = make_timing_result(100, 2.0e9, 2000.0, 0.0);
+
+        const TimingComparison comparison = compare_timing_results(baseline, result);
+
+        EXPECT_FEQ(1.0, comparison.m_ratio);
+    }
+
+    TEST_CASE(CompareTimingResults_GivenSlowerResultWithLowNoise_ReturnsIntervalAboveOne)
+    {
+        const TimingResult baseline = make_timing_result(1000, 1.0e9, 1000.0, 10.0);
+        const TimingResult result = make_timing_result(1000, 1.0e9, 1200.0, 10.0);
+
+        const TimingComparison comparison = compare_timing_results(baseline, result);
+
+        EXPECT_FEQ(1.2, comparison.m_ratio);
+        EXPECT_GT(1.15, comparison.m_ratio_low);
+    }
+
+    TEST_CASE(CompareTimingResults_GivenSlowerResultWithHighNoise_ReturnsIntervalContainingOne)
+    {
+        const TimingResult baseline = make_timing_result(5, 1.0e9, 1000.0, 500.0);
+        const TimingResult result = make_timing_result(5, 1.0e9, 1200.0, 500.0);
+
+        const TimingComparison comparison = compare_timing_results(baseline, result);
+
+        EXPECT_LT(1.0, comparison.m_ratio_low);
+        EXPECT_GT(1.0, comparison.m_ratio_high);
+    }
+
+    TEST_CASE(CompareTimingResults_GivenSingleMeasurement_ReturnsInconclusiveComparison)
+    {
+        const TimingResult baseline = make_timing_result(100, 1.0e9, 1000.0, 10.0);
+        const TimingResult result = make_timing_result(1, 1.0e9, 1200.0, 0.0);
+
+        const TimingComparison comparison = compare_timing_results(baseline, result);
+
+        EXPECT_FALSE(comparison.m_conclusive);
+        EXPECT_FEQ(1.2, comparison.m_ratio);
+    }
+
+    TEST_CASE(CompareTimingResults_GivenBaselineWithoutStatistics_ComparesLowestRunningTimes)
+    {
+        TimingResult baseline = make_timing_result(100, 1.0e9, 1000.0, 0.0);
+        baseline.m_ticks = 900.0;
+        baseline.m_mean_ticks = -1.0;
+        const TimingResult result = make_timing_result(100, 2.0e9, 2000.0, 20.0);
+
+        const TimingComparison comparison = compare_timing_results(baseline, result);
+
+        EXPECT_TRUE(comparison.m_conclusive);
+        EXPECT_FEQ(1980.0 / 1800.0, comparison.m_ratio);
+        EXPECT_FEQ(comparison.m_ratio, comparison.m_ratio_low);
+        EXPECT_FEQ(comparison.m_ratio, comparison.m_ratio_high);
+    }
+}
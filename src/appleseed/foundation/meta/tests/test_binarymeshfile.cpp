@@ -0,0 +1,475 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/core/exceptions/exceptionunsupportedfileformat.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfile.h"
+#include "foundation/mesh/binarymeshfilereader.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
+#include "foundation/mesh/imeshwalker.h"
+#include "foundation/mesh/meshbuilderbase.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+TEST_SUITE(Foundation_Mesh_BinaryMeshFile)
+{
+    using namespace foundation;
+    using namespace std;
+
+    const char* Filename = "unit tests/outputs/test_binarymeshfile.binarymesh";
+
+    // A unit square made of two triangles, with vertex normals and texture coordinates.
+    struct SquareMeshWalker
+      : public IMeshWalker
+    {
+        virtual string get_name() const
+        {
+            return "square";
+        }
+
+        virtual size_t get_vertex_count() const
+        {
+            return 4;
+        }
+
+        virtual Vector3d get_vertex(const size_t i) const
+        {
+            static const Vector3d Vertices[4] =
+            {
+                Vector3d(-1.0, 0.0, -1.0),
+                Vector3d(+1.0, 0.0, -1.0),
+                Vector3d(+1.0, 0.5, +1.0),
+                Vector3d(-1.0, 0.5, +1.0)
+            };
+
+            return Vertices[i];
+        }
+
+        virtual size_t get_vertex_normal_count() const
+        {
+            return 2;
+        }
+
+        virtual Vector3d get_vertex_normal(const size_t i) const
+        {
+            return i == 0 ? Vector3d(0.0, 1.0, 0.0) : normalize(Vector3d(0.3, -0.8, 0.1));
+        }
+
+        virtual size_t get_tex_coords_count() const
+        {
+            return 4;
+        }
+
+        virtual Vector2d get_tex_coords(const size_t i) const
+        {
+            return Vector2d(i == 1 || i == 2 ? 1.0 : 0.0, i >= 2 ? 1.0 : 0.0);
+        }
+
+        virtual size_t get_face_count() const
+        {
+            return 2;
+        }
+
+        virtual Face get_face(const size_t i) const
+        {
+            Face face;
+            face.m_v0 = 0;
+            face.m_v1 = i == 0 ? 1 : 2;
+            face.m_v2 = i == 0 ? 2 : 3;
+            face.m_n0 = face.m_n1 = face.m_n2 = i;
+            face.m_t0 = face.m_v0;
+            face.m_t1 = face.m_v1;
+            face.m_t2 = face.m_v2;
+            face.m_material = i == 0 ? 0 : Face::None;
+            return face;
+        }
+    };
+
+    // The same square, without vertex normals and texture coordinates.
+    struct BareSquareMeshWalker
+      : public SquareMeshWalker
+    {
+        virtual string get_name() const
+        {
+            return "";
+        }
+
+        virtual size_t get_vertex_normal_count() const
+        {
+            return 0;
+        }
+
+        virtual size_t get_tex_coords_count() const
+        {
+            return 0;
+        }
+
+        virtual Face get_face(const size_t i) const
+        {
+            Face face = SquareMeshWalker::get_face(i);
+            face.m_n0 = face.m_n1 = face.m_n2 = Face::None;
+            face.m_t0 = face.m_t1 = face.m_t2 = Face::None;
+            return face;
+        }
+    };
+
+    struct MeshBuilder
+      : public MeshBuilderBase
+    {
+        size_t              m_mesh_count;
+        vector<Vector3d>    m_vertices;
+        vector<size_t>      m_face_normals;
+        vector<size_t>      m_materials;
+
+        MeshBuilder()
+          : m_mesh_count(0)
+        {
+        }
+
+        virtual void begin_mesh(const string& name)
+        {
+            ++m_mesh_count;
+        }
+
+        virtual size_t push_vertex(const Vector3d& v)
+        {
+            m_vertices.push_back(v);
+            return m_vertices.size() - 1;
+        }
+
+        virtual void begin_face(const size_t vertex_count)
+        {
+            m_face_normals.push_back(~size_t(0));
+            m_materials.push_back(~size_t(0));
+        }
+
+        virtual void set_face_vertex_normals(const size_t vertex_normals[])
+        {
+            m_face_normals.back() = vertex_normals[0];
+        }
+
+        virtual void set_face_material(const size_t material)
+        {
+            m_materials.back() = material;
+        }
+    };
+
+    TEST_CASE(Open_GivenWrittenFile_ExposesMeshData)
+    {
+        SquareMeshWalker walker;
+        BinaryMeshFileWriter writer;
+        writer.write(Filename, walker);
+
+        BinaryMeshFile file;
+        file.open(Filename);
+
+        ASSERT_EQ(1, file.get_mesh_count());
+
+        const BinaryMeshFile::Mesh& mesh = file.get_mesh(0);
+
+        EXPECT_EQ("square", mesh.m_name);
+        EXPECT_EQ(Vector3f(-1.0f, 0.0f, -1.0f), mesh.m_bbox.min);
+        EXPECT_EQ(Vector3f(+1.0f, 0.5f, +1.0f), mesh.m_bbox.max);
+        EXPECT_TRUE((mesh.m_flags & BinaryMeshFile::AllFacesHaveNormals) != 0);
+
+        ASSERT_EQ(4, mesh.m_vertex_count);
+        EXPECT_EQ(Vector3f(+1.0f, 0.5f, +1.0f), mesh.get_vertex(2));
+
+        ASSERT_EQ(2, mesh.m_vertex_normal_count);
+        EXPECT_EQ(Vector3f(0.0f, 1.0f, 0.0f), mesh.get_vertex_normal(0));
+
+        ASSERT_EQ(4, mesh.m_tex_coords_count);
+        EXPECT_EQ(Vector2f(1.0f, 1.0f), mesh.m_tex_coords[2]);
+
+        ASSERT_EQ(2, mesh.m_face_count);
+        EXPECT_EQ(0, mesh.m_faces[1].m_v0);
+        EXPECT_EQ(2, mesh.m_faces[1].m_v1);
+        EXPECT_EQ(3, mesh.m_faces[1].m_v2);
+        EXPECT_EQ(1, mesh.m_faces[1].m_n2);
+        EXPECT_EQ(3, mesh.m_faces[1].m_t2);
+        EXPECT_EQ(0, mesh.m_faces[0].m_material);
+        EXPECT_EQ(BinaryMeshFile::None, mesh.m_faces[1].m_material);
+    }
+
+    TEST_CASE(Open_GivenWrittenFile_AlignsDataBlocks)
+    {
+        SquareMeshWalker walker;
+        BinaryMeshFileWriter writer;
+        writer.write(Filename, walker);
+
+        BinaryMeshFile file;
+        file.open(Filename);
+
+        const BinaryMeshFile::Mesh& mesh = file.get_mesh(0);
+        const uint8* faces = reinterpret_cast<const uint8*>(mesh.m_faces);
+        const uint8* vertices = static_cast<const uint8*>(mesh.m_vertices);
+
+        EXPECT_EQ(0, (faces - vertices) % BinaryMeshFile::BlockAlignment);
+    }
+
+    TEST_CASE(Open_GivenMultipleMeshes_ExposesAllMeshes)
+    {
+        SquareMeshWalker walker1;
+        BareSquareMeshWalker walker2;
+
+        vector<const IMeshWalker*> walkers;
+        walkers.push_back(&walker1);
+        walkers.push_back(&walker2);
+
+        BinaryMeshFileWriter writer;
+        writer.write(Filename, walkers);
+
+        BinaryMeshFile file;
+        file.open(Filename);
+
+        ASSERT_EQ(2, file.get_mesh_count());
+
+        const BinaryMeshFile::Mesh& mesh = file.get_mesh(1);
+
+        EXPECT_EQ("", mesh.m_name);
+        EXPECT_EQ(0, mesh.m_flags & BinaryMeshFile::AllFacesHaveNormals);
+        EXPECT_EQ(4, mesh.m_vertex_count);
+        EXPECT_EQ(0, mesh.m_vertex_normal_count);
+        EXPECT_EQ(0, mesh.m_tex_coords_count);
+        EXPECT_EQ(BinaryMeshFile::None, mesh.m_faces[0].m_n0);
+    }
+
+    TEST_CASE(Open_GivenQuantizedFile_ReconstructsVerticesAndNormals)
+    {
+        SquareMeshWalker walker;
+        BinaryMeshFileWriter writer(
+            BinaryMeshFileWriter::QuantizeVertices | BinaryMeshFileWriter::QuantizeNormals);
+        writer.write(Filename, walker);
+
+        BinaryMeshFile file;
+        file.open(Filename);
+
+        const BinaryMeshFile::Mesh& mesh = file.get_mesh(0);
+
+        EXPECT_EQ(BinaryMeshFile::VertexQuantized16, mesh.m_vertex_encoding);
+        EXPECT_EQ(BinaryMeshFile::NormalOctahedral16, mesh.m_vertex_normal_encoding);
+
+        for (size_t i = 0; i < walker.get_vertex_count(); ++i)
+            EXPECT_FEQ_EPS(Vector3f(walker.get_vertex(i)), mesh.get_vertex(i), 1.0e-4f);
+
+        for (size_t i = 0; i < walker.get_vertex_normal_count(); ++i)
+            EXPECT_LT(1.0e-4f, norm(mesh.get_vertex_normal(i) - Vector3f(walker.get_vertex_normal(i))));
+    }
+
+    TEST_CASE(Read_GivenWrittenFile_FeedsMeshBuilder)
+    {
+        SquareMeshWalker walker;
+        BinaryMeshFileWriter writer;
+        writer.write(Filename, walker);
+
+        MeshBuilder builder;
+        BinaryMeshFileReader reader;
+        reader.read(Filename, builder);
+
+        EXPECT_EQ(1, builder.m_mesh_count);
+        ASSERT_EQ(4, builder.m_vertices.size());
+        EXPECT_EQ(Vector3d(-1.0, 0.5, 1.0), builder.m_vertices[3]);
+        ASSERT_EQ(2, builder.m_face_normals.size());
+        EXPECT_EQ(1, builder.m_face_normals[1]);
+        EXPECT_EQ(0, builder.m_materials[0]);
+        EXPECT_EQ(~size_t(0), builder.m_materials[1]);
+    }
+
+    TEST_CASE(Open_GivenFileWithWrongMagic_ThrowsExceptionUnsupportedFileFormat)
+    {
+        FILE* f = fopen(Filename, "wb");
+        const char Data[64] = "not a binary mesh file";
+        fwrite(Data, sizeof(Data), 1, f);
+        fclose(f);
+
+        BinaryMeshFile file;
+
+        EXPECT_EXCEPTION(ExceptionUnsupportedFileFormat,
+        {
+            file.open(Filename);
+        });
+    }
+
+    TEST_CASE(Open_GivenTruncatedFile_ThrowsExceptionIOError)
+    {
+        SquareMeshWalker walker;
+        BinaryMeshFileWriter writer;
+        writer.write(Filename, walker);
+
+        // Keep only the headers.
+        vector<char> data(sizeof(BinaryMeshFile::FileHeader) + sizeof(BinaryMeshFile::MeshHeader));
+        FILE* f = fopen(Filename, "rb");
+        fread(&data[0], data.size(), 1, f);
+        fclose(f);
+        f = fopen(Filename, "wb");
+        fwrite(&data[0], data.size(), 1, f);
+        fclose(f);
+
+        BinaryMeshFile file;
+
+        EXPECT_EXCEPTION(ExceptionIOError,
+        {
+            file.open(Filename);
+        });
+    }
+
+    // Write the square mesh, then overwrite the first face of the file.
+    void write_square_mesh_with_first_face(const BinaryMeshFile::Face& face)
+    {
+        SquareMeshWalker walker;
+        BinaryMeshFileWriter writer;
+        writer.write(Filename, walker);
+
+        FILE* f = fopen(Filename, "r+b");
+        BinaryMeshFile::MeshHeader header;
+        fseek(f, sizeof(BinaryMeshFile::FileHeader), SEEK_SET);
+        fread(&header, sizeof(header), 1, f);
+        fseek(f, static_cast<long>(header.m_faces_offset), SEEK_SET);
+        fwrite(&face, sizeof(face), 1, f);
+        fclose(f);
+    }
+
+    BinaryMeshFile::Face make_face(
+        const uint32    v,
+        const uint32    n,
+        const uint32    t)
+    {
+        BinaryMeshFile::Face face;
+        face.m_v0 = 0; face.m_v1 = 1; face.m_v2 = v;
+        face.m_n0 = 0; face.m_n1 = 0; face.m_n2 = n;
+        face.m_t0 = 0; face.m_t1 = 1; face.m_t2 = t;
+        face.m_material = 0;
+        return face;
+    }
+
+    TEST_CASE(Open_GivenFaceWithValidIndices_Succeeds)
+    {
+        write_square_mesh_with_first_face(make_face(2, 1, 2));
+
+        BinaryMeshFile file;
+        file.open(Filename);
+
+        EXPECT_EQ(1, file.get_mesh_count());
+    }
+
+    TEST_CASE(Open_GivenFaceWithOutOfRangeVertexIndex_ThrowsExceptionIOError)
+    {
+        write_square_mesh_with_first_face(make_face(4, 1, 2));
+
+        BinaryMeshFile file;
+
+        EXPECT_EXCEPTION(ExceptionIOError,
+        {
+            file.open(Filename);
+        });
+    }
+
+    TEST_CASE(Open_GivenFaceWithOutOfRangeVertexNormalIndex_ThrowsExceptionIOError)
+    {
+        write_square_mesh_with_first_face(make_face(2, 2, 2));
+
+        BinaryMeshFile file;
+
+        EXPECT_EXCEPTION(ExceptionIOError,
+        {
+            file.open(Filename);
+        });
+    }
+
+    TEST_CASE(Open_GivenFaceWithOutOfRangeTexCoordsIndex_ThrowsExceptionIOError)
+    {
+        write_square_mesh_with_first_face(make_face(2, 1, 4));
+
+        BinaryMeshFile file;
+
+        EXPECT_EXCEPTION(ExceptionIOError,
+        {
+            file.open(Filename);
+        });
+    }
+
+    TEST_CASE(Open_GivenFaceWithoutVertexNormalsInMeshFlaggedAsHavingThem_ThrowsExceptionIOError)
+    {
+        BinaryMeshFile::Face face = make_face(2, 1, 2);
+        face.m_n0 = face.m_n1 = face.m_n2 = BinaryMeshFile::None;
+        write_square_mesh_with_first_face(face);
+
+        BinaryMeshFile file;
+
+        EXPECT_EXCEPTION(ExceptionIOError,
+        {
+            file.open(Filename);
+        });
+    }
+
+    TEST_CASE(DecodeOctahedralNormal_GivenEncodedUnitVectors_ReturnsOriginalVectors)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            Vector2d s;
+            s[0] = rand_double2(rng);
+            s[1] = rand_double2(rng);
+
+            const Vector3f n(sample_sphere_uniform(s));
+
+            int16 q[2];
+            encode_octahedral_normal(n, q);
+
+            EXPECT_LT(1.0e-4f, norm(decode_octahedral_normal(q) - n));
+        }
+    }
+
+    TEST_CASE(DequantizeVertex_GivenQuantizedVertex_ReturnsVertexWithinQuantizationStep)
+    {
+        const AABB3f bbox(Vector3f(-10.0f, 0.0f, 5.0f), Vector3f(10.0f, 1.0f, 5.0f));
+        const Vector3f v(3.3f, 0.7f, 5.0f);
+
+        uint16 q[3];
+        quantize_vertex(v, bbox, q);
+
+        const Vector3f r = dequantize_vertex(q, bbox);
+
+        EXPECT_FEQ_EPS(v[0], r[0], 20.0f / 65535.0f);
+        EXPECT_FEQ_EPS(v[1], r[1], 1.0f / 65535.0f);
+        EXPECT_EQ(v[2], r[2]);
+    }
+}
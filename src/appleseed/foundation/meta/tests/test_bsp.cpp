@@ -32,11 +32,16 @@
 #include "foundation/math/bsp.h"
 #include "foundation/math/intersection.h"
 #include "foundation/math/ray.h"
+#include "foundation/math/rng.h"
 #include "foundation/math/split.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <memory>
 #include <vector>
@@ -266,14 +271,73 @@ TEST_SUITE(Foundation_Math_BSP_Intersector)
         double  m_closest_hit;
     };
 
+    class PacketLeafVisitor
+      : public NonCopyable
+    {
+      public:
+        PacketLeafVisitor()
+        {
+            for (size_t i = 0; i < 4; ++i)
+            {
+                m_visited_leaf_count[i] = 0;
+                m_closest_hit[i] = numeric_limits<double>::max();
+            }
+        }
+
+        void visit(
+            const Leaf*             leaf,
+            const Ray3d             rays[],
+            const RayInfo3d         ray_infos[],
+            const uint32            ray_mask,
+            double                  distances[])
+        {
+            for (size_t r = 0; r < 4; ++r)
+            {
+                if (!(ray_mask & (1UL << r)))
+                    continue;
+
+                ++m_visited_leaf_count[r];
+
+                for (size_t i = 0; i < leaf->get_size(); ++i)
+                {
+                    const AABB3d& box = leaf->get_box(i);
+
+                    double distance;
+
+                    if (intersect(rays[r], ray_infos[r], box, distance))
+                        m_closest_hit[r] = min(m_closest_hit[r], distance);
+                }
+
+                distances[r] = m_closest_hit[r];
+            }
+        }
+
+        size_t get_visited_leaf_count(const size_t r) const
+        {
+            return m_visited_leaf_count[r];
+        }
+
+        double get_closest_hit(const size_t r) const
+        {
+            return m_closest_hit[r];
+        }
+
+      private:
+        size_t  m_visited_leaf_count[4];
+        double  m_closest_hit[4];
+    };
+
     struct Fixture
     {
         typedef bsp::Tree<double, 3, Leaf> Tree;
         typedef bsp::Intersector<double, Tree, LeafVisitor> Intersector;
+        typedef bsp::PacketIntersector<double, Tree, PacketLeafVisitor> PacketIntersector;
 
         Tree                        m_tree;
         LeafVisitor                 m_leaf_visitor;     // todo: Visitor or LeafVisitor?
         Intersector                 m_intersector;
+        PacketLeafVisitor           m_packet_leaf_visitor;
+        PacketIntersector           m_packet_intersector;
         bsp::TraversalStatistics    m_traversal_stats;
 
         Fixture()
@@ -329,7 +393,340 @@ TEST_SUITE(Foundation_Math_BSP_Intersector)
         EXPECT_FEQ(1.0 - 0.7, m_leaf_visitor.get_closest_hit());
     }
 
+    TEST_CASE_F(Intersect_GivenCoherentPacket_MatchesSingleRayTraversals, Fixture)
+    {
+        const Ray3d rays[4] =
+        {
+            Ray3d(Vector3d(0.0, 0.0, 1.0), Vector3d(0.0, 0.0, -1.0)),
+            Ray3d(Vector3d(-0.5, 0.0, 1.0), Vector3d(0.0, 0.0, -1.0)),
+            Ray3d(Vector3d(0.5, 0.0, 1.0), Vector3d(0.0, 0.0, -1.0)),
+            Ray3d(Vector3d(-0.5, 0.0, 1.0), Vector3d(0.5, 0.0, -1.0))
+        };
+
+        const RayInfo3d ray_infos[4] =
+        {
+            RayInfo3d(rays[0]),
+            RayInfo3d(rays[1]),
+            RayInfo3d(rays[2]),
+            RayInfo3d(rays[3])
+        };
+
+        ASSERT_TRUE(PacketIntersector::is_coherent(ray_infos, 0xF));
+
+        m_packet_intersector.intersect(m_tree, rays, ray_infos, 0xF, m_packet_leaf_visitor TRAVERSAL_STATISTICS);
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            LeafVisitor visitor;
+            m_intersector.intersect(m_tree, rays[i], ray_infos[i], visitor TRAVERSAL_STATISTICS);
+
+            EXPECT_EQ(visitor.get_visited_leaf_count(), m_packet_leaf_visitor.get_visited_leaf_count(i));
+            EXPECT_EQ(visitor.get_closest_hit(), m_packet_leaf_visitor.get_closest_hit(i));
+        }
+    }
+
+    TEST_CASE_F(Intersect_GivenMaskedOutRay_DoesNotVisitAnyLeafForThisRay, Fixture)
+    {
+        Ray3d rays[4];
+        RayInfo3d ray_infos[4];
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            rays[i] = Ray3d(Vector3d(-0.5, 0.0, 1.0), Vector3d(0.0, 0.0, -1.0));
+            ray_infos[i] = RayInfo3d(rays[i]);
+        }
+
+        m_packet_intersector.intersect(m_tree, rays, ray_infos, 0x5, m_packet_leaf_visitor TRAVERSAL_STATISTICS);
+
+        EXPECT_EQ(1, m_packet_leaf_visitor.get_visited_leaf_count(0));
+        EXPECT_EQ(0, m_packet_leaf_visitor.get_visited_leaf_count(1));
+        EXPECT_EQ(1, m_packet_leaf_visitor.get_visited_leaf_count(2));
+        EXPECT_EQ(0, m_packet_leaf_visitor.get_visited_leaf_count(3));
+    }
+
+    TEST_CASE(IsCoherent_GivenRaysWithOppositeDirections_ReturnsFalse)
+    {
+        const Ray3d ray1(Vector3d(0.0, 0.0, 1.0), Vector3d(0.0, 0.0, -1.0));
+        const Ray3d ray2(Vector3d(0.0, 0.0, -1.0), Vector3d(0.0, 0.0, 1.0));
+
+        const RayInfo3d ray_infos[4] =
+        {
+            RayInfo3d(ray1),
+            RayInfo3d(ray1),
+            RayInfo3d(ray2),
+            RayInfo3d(ray1)
+        };
+
+        EXPECT_FALSE(Fixture::PacketIntersector::is_coherent(ray_infos, 0xF));
+        EXPECT_TRUE(Fixture::PacketIntersector::is_coherent(ray_infos, 0xB));
+    }
+
 #pragma warning (pop)
 
 #undef TRAVERSAL_STATISTICS
 }
+
+TEST_SUITE(Foundation_Math_BSP_ParallelBuilder)
+{
+    using namespace foundation;
+    using namespace std;
+
+    class Leaf
+      : public NonCopyable
+    {
+      public:
+        void clear()
+        {
+            m_boxes.clear();
+        }
+
+        size_t get_size() const
+        {
+            return m_boxes.size();
+        }
+
+        void insert(const AABB3d& box)
+        {
+            m_boxes.push_back(box);
+        }
+
+        const AABB3d& get_box(const size_t i) const
+        {
+            return m_boxes[i];
+        }
+
+        AABB3d get_bbox() const
+        {
+            AABB3d bbox;
+            bbox.invalidate();
+
+            for (size_t i = 0; i < m_boxes.size(); ++i)
+                bbox.insert(m_boxes[i]);
+
+            return bbox;
+        }
+
+        size_t get_memory_size() const
+        {
+            return 0;
+        }
+
+      private:
+        vector<AABB3d>  m_boxes;
+    };
+
+    struct LeafFactory
+      : public NonCopyable
+    {
+        Leaf* create_leaf()
+        {
+            return new Leaf();
+        }
+    };
+
+    struct LeafSplitter
+      : public NonCopyable
+    {
+        typedef bsp::LeafInfo<double, 3> LeafInfoType;
+        typedef Split<double> SplitType;
+
+        LeafSplitter* clone() const
+        {
+            return new LeafSplitter();
+        }
+
+        double get_priority(
+            const Leaf&             leaf,
+            const LeafInfoType&     leaf_info) const
+        {
+            const size_t size = leaf.get_size();
+            return size > 2 ? size / exp(static_cast<double>(leaf_info.get_node_depth())) : 0.0;
+        }
+
+        // Split in the middle of the longest dimension of the bounding box of the box centers.
+        bool split(
+            const Leaf&             leaf,
+            const LeafInfoType&     leaf_info,
+            SplitType&              split)
+        {
+            AABB3d centers;
+            centers.invalidate();
+
+            for (size_t i = 0; i < leaf.get_size(); ++i)
+                centers.insert(leaf.get_box(i).center());
+
+            const Vector3d extent = centers.extent();
+            const size_t dim = max_index(extent);
+
+            if (extent[dim] == 0.0)
+                return false;
+
+            split.m_dimension = dim;
+            split.m_abscissa = 0.5 * (centers.min[dim] + centers.max[dim]);
+
+            return true;
+        }
+
+        void sort(
+            const Leaf&             leaf,
+            const LeafInfoType&     leaf_info,
+            const SplitType&        split,
+            Leaf&                   left_leaf,
+            const LeafInfoType&     left_leaf_info,
+            Leaf&                   right_leaf,
+            const LeafInfoType&     right_leaf_info) const
+        {
+            for (size_t i = 0; i < leaf.get_size(); ++i)
+            {
+                const AABB3d& box = leaf.get_box(i);
+
+                if (box.max[split.m_dimension] <= split.m_abscissa)
+                {
+                    left_leaf.insert(box);
+                }
+                else if (box.min[split.m_dimension] >= split.m_abscissa)
+                {
+                    right_leaf.insert(box);
+                }
+                else
+                {
+                    left_leaf.insert(box);
+                    right_leaf.insert(box);
+                }
+            }
+        }
+    };
+
+    typedef bsp::Tree<double, 3, Leaf> Tree;
+    typedef bsp::Builder<Tree, LeafFactory, LeafSplitter> Builder;
+    typedef bsp::ParallelBuilder<Tree, LeafFactory, LeafSplitter> ParallelBuilder;
+
+    class TestTree
+      : public Tree
+    {
+      public:
+        typedef Tree::NodeVector NodeVector;
+        typedef Tree::LeafVector LeafVector;
+
+        const NodeVector& get_nodes() const
+        {
+            return m_nodes;
+        }
+
+        const LeafVector& get_leaves() const
+        {
+            return m_leaves;
+        }
+    };
+
+    auto_ptr<Leaf> create_root_leaf(const size_t box_count)
+    {
+        auto_ptr<Leaf> root_leaf(new Leaf());
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < box_count; ++i)
+        {
+            const Vector3d center(
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0));
+
+            const Vector3d half_extent(
+                rand_double1(rng, 0.01, 0.5),
+                rand_double1(rng, 0.01, 0.5),
+                rand_double1(rng, 0.01, 0.5));
+
+            root_leaf->insert(AABB3d(center - half_extent, center + half_extent));
+        }
+
+        return root_leaf;
+    }
+
+    bool are_equal(const TestTree& lhs, const TestTree& rhs)
+    {
+        if (lhs.get_bbox() != rhs.get_bbox())
+            return false;
+
+        const TestTree::NodeVector& lhs_nodes = lhs.get_nodes();
+        const TestTree::NodeVector& rhs_nodes = rhs.get_nodes();
+
+        if (lhs_nodes.size() != rhs_nodes.size())
+            return false;
+
+        for (size_t i = 0; i < lhs_nodes.size(); ++i)
+        {
+            if (lhs_nodes[i].get_type() != rhs_nodes[i].get_type())
+                return false;
+
+            if (lhs_nodes[i].is_leaf())
+            {
+                if (lhs_nodes[i].get_leaf_index() != rhs_nodes[i].get_leaf_index() ||
+                    lhs_nodes[i].get_leaf_size() != rhs_nodes[i].get_leaf_size())
+                    return false;
+            }
+            else
+            {
+                if (lhs_nodes[i].get_child_node_index() != rhs_nodes[i].get_child_node_index() ||
+                    lhs_nodes[i].get_split_dim() != rhs_nodes[i].get_split_dim() ||
+                    lhs_nodes[i].get_split_abs() != rhs_nodes[i].get_split_abs())
+                    return false;
+            }
+        }
+
+        const TestTree::LeafVector& lhs_leaves = lhs.get_leaves();
+        const TestTree::LeafVector& rhs_leaves = rhs.get_leaves();
+
+        if (lhs_leaves.size() != rhs_leaves.size())
+            return false;
+
+        for (size_t i = 0; i < lhs_leaves.size(); ++i)
+        {
+            if (lhs_leaves[i]->get_size() != rhs_leaves[i]->get_size())
+                return false;
+
+            for (size_t j = 0; j < lhs_leaves[i]->get_size(); ++j)
+            {
+                if (lhs_leaves[i]->get_box(j) != rhs_leaves[i]->get_box(j))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void build_serial_and_parallel_trees(
+        const size_t    box_count,
+        const size_t    thread_count,
+        TestTree&       serial_tree,
+        TestTree&       parallel_tree)
+    {
+        LeafFactory factory;
+        LeafSplitter splitter;
+
+        Builder builder;
+        builder.build(serial_tree, create_root_leaf(box_count), factory, splitter);
+
+        Logger logger;
+        ParallelBuilder parallel_builder(logger, thread_count, 16);
+        parallel_builder.build(parallel_tree, create_root_leaf(box_count), factory, splitter);
+    }
+
+    TEST_CASE(Build_GivenSingleThread_ProducesSameTreeAsSerialBuilder)
+    {
+        TestTree serial_tree, parallel_tree;
+        build_serial_and_parallel_trees(1000, 1, serial_tree, parallel_tree);
+
+        EXPECT_GT(1, serial_tree.get_nodes().size());
+        EXPECT_TRUE(are_equal(serial_tree, parallel_tree));
+    }
+
+    TEST_CASE(Build_GivenMultipleThreads_ProducesSameTreeAsSerialBuilder)
+    {
+        TestTree serial_tree, parallel_tree;
+        build_serial_and_parallel_trees(5000, 4, serial_tree, parallel_tree);
+
+        EXPECT_GT(1, serial_tree.get_nodes().size());
+        EXPECT_TRUE(are_equal(serial_tree, parallel_tree));
+    }
+}
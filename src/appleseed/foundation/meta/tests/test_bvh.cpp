@@ -0,0 +1,290 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/bvh.h"
+#include "foundation/math/intersection.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/rng.h"
+#include "foundation/math/sampling.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+TEST_SUITE(Foundation_Math_BVH_QNode)
+{
+    using namespace foundation;
+
+    typedef bvh::QNode<float, 3> QNodeType;
+
+    TEST_CASE(TestLeafChild)
+    {
+        QNodeType node;
+        node.set_child_count(2);
+
+        node.set_child_type(1, QNodeType::Leaf);
+        node.set_child_item_index(1, 42);
+        node.set_child_item_count(1, 7);
+
+        EXPECT_EQ(2, node.get_child_count());
+        EXPECT_TRUE(node.is_leaf_child(1));
+        EXPECT_EQ(42, node.get_child_item_index(1));
+        EXPECT_EQ(7, node.get_child_item_count(1));
+
+        const size_t ItemIndex = (size_t(1) << 31) - 1;
+        node.set_child_item_index(1, ItemIndex);
+        EXPECT_TRUE(node.is_leaf_child(1));
+        EXPECT_EQ(ItemIndex, node.get_child_item_index(1));
+    }
+
+    TEST_CASE(TestInteriorChild)
+    {
+        QNodeType node;
+        node.set_child_count(4);
+
+        node.set_child_type(3, QNodeType::Interior);
+        node.set_child_node_index(3, 42);
+
+        EXPECT_TRUE(node.is_interior_child(3));
+        EXPECT_EQ(42, node.get_child_node_index(3));
+
+        node.set_child_node_index(3, 66);
+        EXPECT_TRUE(node.is_interior_child(3));
+        EXPECT_EQ(66, node.get_child_node_index(3));
+    }
+
+    TEST_CASE(TestChildBoundingBox)
+    {
+        QNodeType node;
+        node.set_child_count(3);
+
+        const AABB3f bbox(Vector3f(-1.0f, -2.0f, -3.0f), Vector3f(4.0f, 5.0f, 6.0f));
+        node.set_child_bbox(2, bbox);
+
+        EXPECT_EQ(bbox.min, node.get_child_bbox(2).min);
+        EXPECT_EQ(bbox.max, node.get_child_bbox(2).max);
+        EXPECT_EQ(-2.0f, node.get_child_bbox_min(1)[2]);
+        EXPECT_EQ(6.0f, node.get_child_bbox_max(2)[2]);
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_QIntersector)
+{
+    using namespace foundation;
+    using namespace std;
+
+    typedef bvh::QTree<float, 3, size_t> Tree;
+
+    struct BboxCenterPredicate
+    {
+        const size_t m_dim;
+
+        explicit BboxCenterPredicate(const size_t dim)
+          : m_dim(dim)
+        {
+        }
+
+        bool operator()(const pair<AABB3f, size_t>& lhs, const pair<AABB3f, size_t>& rhs) const
+        {
+            return lhs.first.center()[m_dim] < rhs.first.center()[m_dim];
+        }
+    };
+
+    struct MedianPartitioner
+      : public NonCopyable
+    {
+        size_t partition(
+            vector<size_t>&         items,
+            vector<AABB3f>&         bboxes,
+            const size_t            begin,
+            const size_t            end,
+            const AABB3f&           bbox)
+        {
+            vector<pair<AABB3f, size_t> > entries;
+            for (size_t i = begin; i < end; ++i)
+                entries.push_back(make_pair(bboxes[i], items[i]));
+
+            sort(entries.begin(), entries.end(), BboxCenterPredicate(max_index(bbox.extent())));
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                bboxes[i] = entries[i - begin].first;
+                items[i] = entries[i - begin].second;
+            }
+
+            return (begin + end) / 2;
+        }
+    };
+
+    class ClosestHitVisitor
+      : public NonCopyable
+    {
+      public:
+        ClosestHitVisitor()
+          : m_visited_leaf_count(0)
+          , m_closest_item(~size_t(0))
+          , m_closest_hit(numeric_limits<double>::max())
+        {
+        }
+
+        bool visit(
+            const vector<size_t>&   items,
+            const vector<AABB3f>&   bboxes,
+            const size_t            begin,
+            const size_t            end,
+            const Ray3d&            ray,
+            const RayInfo3d&        ray_info,
+            const double            tmin,
+            const double            tmax,
+            double&                 distance)
+        {
+            ++m_visited_leaf_count;
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                double t;
+
+                if (intersect(ray, ray_info, AABB3d(bboxes[i]), t) && t < m_closest_hit)
+                {
+                    m_closest_hit = t;
+                    m_closest_item = items[i];
+                }
+            }
+
+            distance = m_closest_hit;
+            return true;
+        }
+
+        size_t  m_visited_leaf_count;
+        size_t  m_closest_item;
+        double  m_closest_hit;
+    };
+
+    struct Fixture
+    {
+        Tree m_tree;
+
+        explicit Fixture(const size_t item_count = 1000)
+        {
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < item_count; ++i)
+            {
+                const Vector3f center(
+                    static_cast<float>(rand_double1(rng, -10.0, 10.0)),
+                    static_cast<float>(rand_double1(rng, -10.0, 10.0)),
+                    static_cast<float>(rand_double1(rng, -10.0, 10.0)));
+                const Vector3f extent(
+                    static_cast<float>(rand_double1(rng, 0.01, 0.5)),
+                    static_cast<float>(rand_double1(rng, 0.01, 0.5)),
+                    static_cast<float>(rand_double1(rng, 0.01, 0.5)));
+
+                m_tree.insert(i, AABB3f(center - extent, center + extent));
+            }
+
+            MedianPartitioner partitioner;
+            bvh::Builder<Tree, MedianPartitioner> builder;
+            builder.build(m_tree, partitioner);
+
+            bvh::QBuilder<Tree> qbuilder;
+            qbuilder.build(m_tree);
+        }
+    };
+
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+#define TRAVERSAL_STATISTICS , traversal_stats
+#else
+#define TRAVERSAL_STATISTICS
+#endif
+
+    TEST_CASE_F(Intersect_GivenRandomRays_ReturnsSameClosestHitAsBinaryIntersector, Fixture)
+    {
+        MersenneTwister rng;
+
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        bvh::TraversalStatistics traversal_stats;
+#endif
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            Vector2d s;
+            s[0] = rand_double2(rng);
+            s[1] = rand_double2(rng);
+            const Vector3d origin = 20.0 * sample_sphere_uniform(s);
+
+            const Vector3d target(
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0));
+
+            const Ray3d ray(origin, normalize(target - origin));
+            const RayInfo3d ray_info(ray);
+
+            ClosestHitVisitor binary_visitor;
+            bvh::Intersector<double, Tree, ClosestHitVisitor> binary_intersector;
+            binary_intersector.intersect(m_tree, ray, ray_info, binary_visitor TRAVERSAL_STATISTICS);
+
+            ClosestHitVisitor qbvh_visitor;
+            bvh::QIntersector<double, Tree, ClosestHitVisitor> qbvh_intersector;
+            qbvh_intersector.intersect(m_tree, ray, ray_info, qbvh_visitor TRAVERSAL_STATISTICS);
+
+            EXPECT_EQ(binary_visitor.m_closest_item, qbvh_visitor.m_closest_item);
+            EXPECT_EQ(binary_visitor.m_closest_hit, qbvh_visitor.m_closest_hit);
+        }
+    }
+
+    TEST_CASE(Intersect_GivenSingleItemTree_VisitsItem)
+    {
+        Fixture fixture(1);
+
+        const Ray3d ray(Vector3d(0.0, 0.0, 100.0), Vector3d(0.0, 0.0, -1.0));
+        const AABB3d bbox(fixture.m_tree.get_bbox());
+        const Ray3d aimed_ray(ray.m_org + Vector3d(bbox.center()[0], bbox.center()[1], 0.0), ray.m_dir);
+
+        ClosestHitVisitor visitor;
+        bvh::QIntersector<double, Tree, ClosestHitVisitor> intersector;
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        bvh::TraversalStatistics traversal_stats;
+#endif
+        intersector.intersect(fixture.m_tree, aimed_ray, RayInfo3d(aimed_ray), visitor TRAVERSAL_STATISTICS);
+
+        EXPECT_EQ(1, visitor.m_visited_leaf_count);
+        EXPECT_EQ(0, visitor.m_closest_item);
+    }
+
+#undef TRAVERSAL_STATISTICS
+}
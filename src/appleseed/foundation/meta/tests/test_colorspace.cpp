@@ -174,6 +174,15 @@ TEST_SUITE(Foundation_Image_ColorSpace)
             1.0e-6f);
     }
 
+    TEST_CASE(TestSpectrumToLuminanceConversion)
+    {
+        const Spectrum31f spectrum = get_white_spectrum();
+        const LightingConditions lighting_conditions(IlluminantCIED65, XYZCMFCIE196410Deg);
+        const float y = spectrum_to_luminance<float>(lighting_conditions, spectrum);
+
+        EXPECT_FEQ_EPS(0.738633f, y, 1.0e-6f);
+    }
+
     TEST_CASE(TestCIEXYZToSpectrumConversion)
     {
         const Color3f ciexyz(0.699385f, 0.738633f, 0.790319f);
@@ -196,6 +205,41 @@ TEST_SUITE(Foundation_Image_ColorSpace)
             1.0e-6f);
     }
 
+    TEST_CASE(TestLinearRGBToThreeSampleSpectrumConversion)
+    {
+        const Color3f linear_rgb(0.2f, 0.5f, 0.8f);
+        const LightingConditions lighting_conditions(IlluminantCIED65, XYZCMFCIE196410Deg);
+
+        RegularSpectrum<float, 3> spectrum;
+        linear_rgb_to_spectrum(lighting_conditions, linear_rgb, spectrum);
+
+        EXPECT_EQ(0.2f, spectrum[0]);
+        EXPECT_EQ(0.5f, spectrum[1]);
+        EXPECT_EQ(0.8f, spectrum[2]);
+    }
+
+    TEST_CASE(TestThreeSampleSpectrumToLinearRGBConversion)
+    {
+        const float Values[3] = { 0.2f, 0.5f, 0.8f };
+        const RegularSpectrum<float, 3> spectrum(Values);
+        const LightingConditions lighting_conditions(IlluminantCIED65, XYZCMFCIE196410Deg);
+
+        const Color3f linear_rgb = spectrum_to_linear_rgb<float>(lighting_conditions, spectrum);
+
+        EXPECT_EQ(Color3f(0.2f, 0.5f, 0.8f), linear_rgb);
+    }
+
+    TEST_CASE(TestThreeSampleSpectrumToCIEXYZConversion)
+    {
+        const float Values[3] = { 0.2f, 0.5f, 0.8f };
+        const RegularSpectrum<float, 3> spectrum(Values);
+        const LightingConditions lighting_conditions(IlluminantCIED65, XYZCMFCIE196410Deg);
+
+        const Color3f ciexyz = spectrum_to_ciexyz<float>(lighting_conditions, spectrum);
+
+        EXPECT_FEQ(linear_rgb_to_ciexyz(Color3f(0.2f, 0.5f, 0.8f)), ciexyz);
+    }
+
     TEST_CASE(TestSpectrumToSpectrumConversion)
     {
         static const float InputWavelength[Spectrum31f::Samples] =
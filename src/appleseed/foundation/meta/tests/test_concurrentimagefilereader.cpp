@@ -0,0 +1,115 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/concurrentimagefilereader.h"
+#include "foundation/image/exrimagefilewriter.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Image_ConcurrentImageFileReader)
+{
+    const char* Filename = "unit tests/outputs/test_concurrentimagefilereader.exr";
+
+    struct Fixture
+    {
+        const size_t    m_initial_max_reader_count;
+        const size_t    m_initial_reader_count;
+
+        Fixture()
+          : m_initial_max_reader_count(ConcurrentImageFileReader::get_global_max_reader_count())
+          , m_initial_reader_count(ConcurrentImageFileReader::get_global_reader_count())
+        {
+            Image image(8, 8, 4, 4, 4, PixelFormatFloat);
+            image.clear(Color4f(0.2f, 0.4f, 0.6f, 1.0f));
+
+            EXRImageFileWriter writer;
+            writer.write(Filename, image);
+
+            ConcurrentImageFileReader::set_global_max_reader_count(m_initial_reader_count + 1);
+        }
+
+        ~Fixture()
+        {
+            ConcurrentImageFileReader::set_global_max_reader_count(m_initial_max_reader_count);
+        }
+    };
+
+    TEST_CASE_F(Open_GivenGlobalLimitReached_ClosesIdleReaderOfOtherFile, Fixture)
+    {
+        ConcurrentImageFileReader reader1;
+        reader1.open(Filename);
+
+        ConcurrentImageFileReader reader2;
+        reader2.open(Filename);
+
+        EXPECT_EQ(0, reader1.get_reader_count());
+        EXPECT_EQ(1, reader2.get_reader_count());
+        EXPECT_EQ(m_initial_reader_count + 1, ConcurrentImageFileReader::get_global_reader_count());
+    }
+
+    TEST_CASE_F(ReadTile_GivenAllReadersClosed_ReopensReader, Fixture)
+    {
+        ConcurrentImageFileReader reader1;
+        reader1.open(Filename);
+
+        ConcurrentImageFileReader reader2;
+        reader2.open(Filename);
+
+        Tile* tile = reader1.read_tile(1, 1);
+        Color4f color;
+        tile->get_pixel(0, 0, color);
+        delete tile;
+
+        EXPECT_EQ(Color4f(0.2f, 0.4f, 0.6f, 1.0f), color);
+        EXPECT_EQ(1, reader1.get_reader_count());
+        EXPECT_EQ(0, reader2.get_reader_count());
+        EXPECT_EQ(m_initial_reader_count + 1, ConcurrentImageFileReader::get_global_reader_count());
+    }
+
+    TEST_CASE_F(Close_GivenOpenReaders_ReleasesReadersFromGlobalCount, Fixture)
+    {
+        ConcurrentImageFileReader reader;
+        reader.open(Filename);
+        delete reader.read_tile(0, 0);
+
+        reader.close();
+
+        EXPECT_FALSE(reader.is_open());
+        EXPECT_EQ(m_initial_reader_count, ConcurrentImageFileReader::get_global_reader_count());
+    }
+}
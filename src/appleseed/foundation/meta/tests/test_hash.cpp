@@ -0,0 +1,64 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/hash.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstring>
+
+TEST_SUITE(Foundation_Math_Hash)
+{
+    using namespace foundation;
+
+    uint64 hash_string(const char* s)
+    {
+        return hash_bytes64(s, std::strlen(s));
+    }
+
+    TEST_CASE(HashBytes64_GivenEmptyBuffer_ReturnsInitialValue)
+    {
+        EXPECT_EQ(HashBytes64Init, hash_string(""));
+    }
+
+    TEST_CASE(HashBytes64_GivenReferenceStrings_ReturnsReferenceHashes)
+    {
+        EXPECT_EQ(0xAF63DC4C8601EC8CULL, hash_string("a"));
+        EXPECT_EQ(0x85944171F73967E8ULL, hash_string("foobar"));
+    }
+
+    TEST_CASE(HashBytes64_GivenBufferHashedInTwoParts_ReturnsSameHashAsWholeBuffer)
+    {
+        const uint64 partial = hash_bytes64("foo", 3);
+        const uint64 result = hash_bytes64("bar", 3, partial);
+
+        EXPECT_EQ(hash_string("foobar"), result);
+    }
+}
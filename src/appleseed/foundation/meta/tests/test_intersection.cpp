@@ -30,10 +30,13 @@
 #include "foundation/math/aabb.h"
 #include "foundation/math/intersection.h"
 #include "foundation/math/ray.h"
+#include "foundation/math/rng.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <cstddef>
 #include <limits>
 
 using namespace foundation;
@@ -493,6 +496,69 @@ TEST_SUITE(Foundation_Math_Intersection_RayTriangleMT)
         EXPECT_FEQ(0.0, u);
         EXPECT_FEQ(0.5, v);
     }
+
+    TEST_CASE_F(IntersectPacket_GivenRayHittingTMinBoundary_ReturnsHitForThisRayOnly, Fixture)
+    {
+        TriangleMTRayPacket<double> packet;
+        packet.set(0, Ray3d(Vector3d(-0.2, 1.0, 0.2), Vector3d(0.0, -1.0, 0.0), 1.0, 10.0));
+        packet.set(1, Ray3d(Vector3d(-0.2, 1.0, 0.2), Vector3d(0.0, -1.0, 0.0), 0.0, 1.0));
+        packet.set(2, Ray3d(Vector3d(-0.2, 1.0, 0.2), Vector3d(0.0, 1.0, 0.0)));
+        packet.set(3, Ray3d(Vector3d(0.8, 1.0, 0.2), Vector3d(0.0, -1.0, 0.0)));
+
+        double t[4], u[4], v[4];
+        const uint32 hit_mask = m_triangle.intersect(packet, 0xF, t, u, v);
+
+        ASSERT_EQ(0x1, hit_mask);
+        EXPECT_FEQ(1.0, t[0]);
+    }
+
+    TEST_CASE_F(IntersectPacket_GivenRandomRays_MatchesSingleRayTest, Fixture)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            TriangleMTRayPacket<double> packet;
+            Ray3d rays[4];
+
+            for (size_t j = 0; j < 4; ++j)
+            {
+                const Vector3d target(
+                    rand_double1(rng, -0.6, 0.6),
+                    0.0,
+                    rand_double1(rng, -0.6, 0.6));
+                const Vector3d org(
+                    rand_double1(rng, -1.0, 1.0),
+                    rand_double1(rng, -2.0, 2.0),
+                    rand_double1(rng, -1.0, 1.0));
+
+                rays[j] = Ray3d(org, target - org, 0.0, rand_double1(rng, 0.5, 1.5));
+                packet.set(j, rays[j]);
+            }
+
+            const uint32 ray_mask = static_cast<uint32>(i & 0xF);
+
+            double t[4], u[4], v[4];
+            const uint32 hit_mask = m_triangle.intersect(packet, ray_mask, t, u, v);
+
+            for (size_t j = 0; j < 4; ++j)
+            {
+                double expected_t, expected_u, expected_v;
+                const bool expected_hit =
+                    (ray_mask & (1UL << j)) &&
+                    m_triangle.intersect(rays[j], expected_t, expected_u, expected_v);
+
+                ASSERT_EQ(expected_hit, (hit_mask & (1UL << j)) != 0);
+
+                if (expected_hit)
+                {
+                    EXPECT_EQ(expected_t, t[j]);
+                    EXPECT_EQ(expected_u, u[j]);
+                    EXPECT_EQ(expected_v, v[j]);
+                }
+            }
+        }
+    }
 }
 
 TEST_SUITE(Foundation_Math_Intersection_RayTriangleSSK)
@@ -27,12 +27,14 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/platform/atomic.h"
 #include "foundation/platform/timer.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/job/abortswitch.h"
 #include "foundation/utility/job/ijob.h"
 #include "foundation/utility/job/jobmanager.h"
 #include "foundation/utility/job/jobqueue.h"
+#include "foundation/utility/job/threadbudget.h"
 #include "foundation/utility/job/workerthread.h"
 #include "foundation/utility/log.h"
 #include "foundation/utility/test.h"
@@ -375,6 +377,130 @@ TEST_SUITE(Foundation_Utility_Job_JobManager)
 
         EXPECT_EQ(1, execution_count);
     }
+
+    TEST_CASE_F(JobManagerWithScatterThreadAffinityExecutesJobs, FixtureJobManager)
+    {
+        volatile size_t execution_count = 0;
+
+        job_queue.schedule(
+            new JobNotifyingAboutExecution(execution_count));
+
+        job_manager.set_thread_affinity(JobManager::AffinityScatter);
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(1, execution_count);
+    }
+
+    class JobCreatingJobTree
+      : public IJob
+    {
+      public:
+        JobCreatingJobTree(
+            JobQueue&           job_queue,
+            volatile uint32&    execution_count,
+            const size_t        depth)
+          : m_job_queue(job_queue)
+          , m_execution_count(execution_count)
+          , m_depth(depth)
+        {
+        }
+
+        virtual void execute(const size_t /*thread_index*/)
+        {
+            if (m_depth > 0)
+            {
+                m_job_queue.schedule(new JobCreatingJobTree(m_job_queue, m_execution_count, m_depth - 1));
+                m_job_queue.schedule(new JobCreatingJobTree(m_job_queue, m_execution_count, m_depth - 1));
+            }
+
+            atomic_inc(&m_execution_count);
+        }
+
+      private:
+        JobQueue&           m_job_queue;
+        volatile uint32&    m_execution_count;
+        const size_t        m_depth;
+    };
+
+    TEST_CASE(WaitUntilCompletion_GivenJobsSchedulingChildJobs_ReturnsAfterAllJobsAreExecuted)
+    {
+        const size_t Depth = 4;
+        const uint32 JobCount = (1 << (Depth + 1)) - 1;
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 8);
+        job_manager.start();
+
+        for (size_t i = 0; i < 2000; ++i)
+        {
+            volatile uint32 execution_count = 0;
+
+            job_queue.schedule(new JobCreatingJobTree(job_queue, execution_count, Depth));
+            job_queue.wait_until_completion();
+
+            ASSERT_EQ(JobCount, atomic_read(&execution_count));
+            ASSERT_FALSE(job_queue.has_scheduled_or_running_jobs());
+        }
+    }
+}
+
+TEST_SUITE(Foundation_Utility_Job_ThreadBudget)
+{
+    TEST_CASE(Constructor_MakesAllThreadsAvailable)
+    {
+        ThreadBudget budget(4);
+
+        EXPECT_EQ(4, budget.get_thread_count());
+        EXPECT_EQ(4, budget.get_available_thread_count());
+    }
+
+    TEST_CASE(Acquire_GivenEnoughAvailableThreads_AcquiresRequestedThreads)
+    {
+        ThreadBudget budget(4);
+
+        EXPECT_EQ(3, budget.acquire(3));
+        EXPECT_EQ(1, budget.get_available_thread_count());
+
+        budget.release(3);
+    }
+
+    TEST_CASE(Acquire_GivenTooFewAvailableThreads_AcquiresAvailableThreads)
+    {
+        ThreadBudget budget(4);
+        budget.acquire(3);
+
+        EXPECT_EQ(1, budget.acquire(3));
+        EXPECT_EQ(0, budget.acquire(3));
+        EXPECT_EQ(0, budget.get_available_thread_count());
+
+        budget.release(4);
+    }
+
+    TEST_CASE(Release_MakesThreadsAvailableAgain)
+    {
+        ThreadBudget budget(4);
+        budget.acquire(3);
+
+        budget.release(3);
+
+        EXPECT_EQ(4, budget.get_available_thread_count());
+    }
+
+    TEST_CASE(ThreadBudgetReservation_ReleasesThreadsOnDestruction)
+    {
+        ThreadBudget budget(4);
+
+        {
+            const ThreadBudgetReservation reservation(budget, 6);
+
+            EXPECT_EQ(4, reservation.get_thread_count());
+            EXPECT_EQ(0, budget.get_available_thread_count());
+        }
+
+        EXPECT_EQ(4, budget.get_available_thread_count());
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Job_WorkerThread)
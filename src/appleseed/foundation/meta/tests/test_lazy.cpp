@@ -27,10 +27,14 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <cstddef>
 #include <memory>
 
 TEST_SUITE(Foundation_Utility_Lazy_Access)
@@ -112,4 +116,59 @@ TEST_SUITE(Foundation_Utility_Lazy_Access)
 
         EXPECT_EQ(0, access.get());
     }
+
+    struct CountingObjectFactory : public ObjectFactory
+    {
+        volatile uint32* m_creation_count;
+
+        explicit CountingObjectFactory(volatile uint32* creation_count)
+          : m_creation_count(creation_count)
+        {
+        }
+
+        virtual auto_ptr<Object> create()
+        {
+            atomic_inc(m_creation_count);
+            yield();
+            return auto_ptr<Object>(new Object(42));
+        }
+    };
+
+    struct Accessor
+    {
+        Lazy<Object>*   m_object;
+        const Object**  m_result;
+
+        Accessor(Lazy<Object>* object, const Object** result)
+          : m_object(object)
+          , m_result(result)
+        {
+        }
+
+        void operator()()
+        {
+            Access<Object> access(m_object);
+            *m_result = access.get();
+        }
+    };
+
+    TEST_CASE(Access_GivenConcurrentAccesses_CreatesObjectOnlyOnce)
+    {
+        const size_t ThreadCount = 8;
+
+        volatile uint32 creation_count = 0;
+        auto_ptr<ObjectFactory> factory(new CountingObjectFactory(&creation_count));
+        Lazy<Object> object(factory);
+
+        const Object* results[ThreadCount];
+        boost::thread_group threads;
+        for (size_t i = 0; i < ThreadCount; ++i)
+            threads.create_thread(Accessor(&object, &results[i]));
+        threads.join_all();
+
+        EXPECT_EQ(1, creation_count);
+
+        for (size_t i = 1; i < ThreadCount; ++i)
+            EXPECT_EQ(results[0], results[i]);
+    }
 }
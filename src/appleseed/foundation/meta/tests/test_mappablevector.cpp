@@ -0,0 +1,108 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/containers/mappablevector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+TEST_SUITE(Foundation_Utility_Containers_MappableVector)
+{
+    using namespace foundation;
+
+    TEST_CASE(PushBack_AppendsOwnedElements)
+    {
+        MappableVector<int> v;
+        v.push_back(1);
+        v.push_back(2);
+
+        EXPECT_FALSE(v.is_mapped());
+        ASSERT_EQ(2, v.size());
+        EXPECT_EQ(1, v[0]);
+        EXPECT_EQ(2, v[1]);
+    }
+
+    TEST_CASE(Map_RefersToExternalElements)
+    {
+        const int Elements[3] = { 4, 5, 6 };
+
+        MappableVector<int> v;
+        v.push_back(1);
+        v.map(Elements, 3);
+
+        EXPECT_TRUE(v.is_mapped());
+        ASSERT_EQ(3, v.size());
+        EXPECT_EQ(&Elements[2], &v[2]);
+    }
+
+    TEST_CASE(Clear_GivenMappedVector_MakesVectorOwnItsElementsAgain)
+    {
+        const int Elements[3] = { 4, 5, 6 };
+
+        MappableVector<int> v;
+        v.map(Elements, 3);
+        v.clear();
+        v.push_back(7);
+
+        EXPECT_FALSE(v.is_mapped());
+        ASSERT_EQ(1, v.size());
+        EXPECT_EQ(7, v[0]);
+    }
+    TEST_CASE(PushBack_GivenMappedVector_CopiesExternalElements)
+    {
+        const int Elements[3] = { 4, 5, 6 };
+
+        MappableVector<int> v;
+        v.map(Elements, 3);
+        v.push_back(7);
+
+        EXPECT_FALSE(v.is_mapped());
+        ASSERT_EQ(4, v.size());
+        EXPECT_NEQ(&Elements[0], &v[0]);
+        EXPECT_EQ(4, v[0]);
+        EXPECT_EQ(6, v[2]);
+        EXPECT_EQ(7, v[3]);
+    }
+
+    TEST_CASE(Reserve_GivenMappedVector_CopiesExternalElements)
+    {
+        const int Elements[3] = { 4, 5, 6 };
+
+        MappableVector<int> v;
+        v.map(Elements, 3);
+        v.reserve(10);
+
+        EXPECT_FALSE(v.is_mapped());
+        ASSERT_EQ(3, v.size());
+        EXPECT_NEQ(&Elements[0], &v[0]);
+        EXPECT_EQ(5, v[1]);
+        EXPECT_GT(9, v.capacity());
+    }
+}
@@ -0,0 +1,140 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/profiler.h"
+#include "foundation/utility/test.h"
+
+// boost headers.
+#include "boost/bind.hpp"
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <cstdio>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_Profiler)
+{
+    struct Fixture
+    {
+        Profiler& m_profiler;
+
+        Fixture()
+          : m_profiler(Profiler::instance())
+        {
+        }
+
+        ~Fixture()
+        {
+            m_profiler.set_enabled(false);
+            m_profiler.clear();
+        }
+    };
+
+    TEST_CASE_F(ProfilerZone_GivenDisabledProfiler_RecordsNothing, Fixture)
+    {
+        m_profiler.set_enabled(false);
+        m_profiler.clear();
+
+        {
+            FOUNDATION_PROFILE_ZONE("zone");
+        }
+
+        EXPECT_EQ(0, m_profiler.get_zone_count());
+    }
+
+    TEST_CASE_F(ProfilerZone_GivenEnabledProfiler_RecordsZone, Fixture)
+    {
+        m_profiler.set_enabled(true);
+
+        {
+            FOUNDATION_PROFILE_ZONE("outer");
+            FOUNDATION_PROFILE_ZONE("inner");
+        }
+
+        EXPECT_EQ(2, m_profiler.get_zone_count());
+    }
+
+    TEST_CASE_F(SetEnabled_DiscardsRecordedZones, Fixture)
+    {
+        m_profiler.set_enabled(true);
+
+        {
+            FOUNDATION_PROFILE_ZONE("zone");
+        }
+
+        m_profiler.set_enabled(true);
+
+        EXPECT_EQ(0, m_profiler.get_zone_count());
+    }
+
+    void record_zones(Profiler* profiler)
+    {
+        for (size_t i = 0; i < 10; ++i)
+            profiler->record("zone", profiler->read_clock(), profiler->read_clock());
+    }
+
+    TEST_CASE(Record_GivenZonesFromSeveralThreads_KeepsZonesOfTerminatedThreads)
+    {
+        Profiler profiler;
+
+        boost::thread thread1(boost::bind(record_zones, &profiler));
+        boost::thread thread2(boost::bind(record_zones, &profiler));
+        thread1.join();
+        thread2.join();
+
+        EXPECT_EQ(20, profiler.get_zone_count());
+    }
+
+    TEST_CASE(WriteChromeTrace_WritesCompleteEvents)
+    {
+        const char* Filename = "unit tests/outputs/test_profiler.json";
+
+        Profiler profiler;
+        profiler.record("zone", profiler.read_clock(), profiler.read_clock());
+
+        ASSERT_TRUE(profiler.write_chrome_trace(Filename));
+
+        FILE* file = fopen(Filename, "rt");
+        ASSERT_NEQ(0, file);
+
+        string contents;
+        char buffer[256];
+        while (fgets(buffer, sizeof(buffer), file))
+            contents += buffer;
+
+        fclose(file);
+
+        EXPECT_NEQ(string::npos, contents.find("\"traceEvents\""));
+        EXPECT_NEQ(string::npos, contents.find("\"name\": \"zone\""));
+        EXPECT_NEQ(string::npos, contents.find("\"ph\": \"X\""));
+    }
+}
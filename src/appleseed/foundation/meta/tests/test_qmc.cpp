@@ -37,6 +37,8 @@
 #include "foundation/math/rng.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/iostreamop.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/maplefile.h"
 #include "foundation/utility/string.h"
@@ -273,6 +275,107 @@ TEST_SUITE(Foundation_Math_QMC)
         generate_hammersley_zaremba_sequence_image(11);
     }
 
+    void generate_owen_scrambled_sobol02_sequence_image(
+        const uint32    seed)
+    {
+        vector<Vector2d> points;
+
+        for (size_t i = 0; i < PointCount; ++i)
+            points.push_back(owen_scrambled_sobol02_sequence<double>(seed, static_cast<uint32>(i)));
+
+        write_point_cloud_image(
+            "unit tests/outputs/test_qmc_owen_scrambled_sobol02_" + to_string(seed) + ".png",
+            points);
+    }
+
+    TEST_CASE(Generate2DOwenScrambledSobol02SequenceImages)
+    {
+        generate_owen_scrambled_sobol02_sequence_image(0);
+        generate_owen_scrambled_sobol02_sequence_image(1);
+        generate_owen_scrambled_sobol02_sequence_image(2);
+    }
+
+    TEST_CASE(ReverseBits)
+    {
+        EXPECT_EQ(0x00000000u, reverse_bits(0x00000000u));
+        EXPECT_EQ(0x80000000u, reverse_bits(0x00000001u));
+        EXPECT_EQ(0x00000001u, reverse_bits(0x80000000u));
+        EXPECT_EQ(0xF0000000u, reverse_bits(0x0000000Fu));
+        EXPECT_EQ(0x1E6A2C48u, reverse_bits(0x12345678u));
+    }
+
+    TEST_CASE(Sobol02Sequence)
+    {
+        const Vector2d Expected[] =
+        {
+            Vector2d(0.0,   0.0),
+            Vector2d(0.5,   0.5),
+            Vector2d(0.25,  0.75),
+            Vector2d(0.75,  0.25),
+            Vector2d(0.125, 0.625),
+            Vector2d(0.625, 0.125),
+            Vector2d(0.375, 0.375),
+            Vector2d(0.875, 0.875)
+        };
+
+        for (uint32 i = 0; i < 8; ++i)
+            EXPECT_FEQ(Expected[i], sobol02_sequence<double>(i));
+    }
+
+    // Return true if each of the elementary intervals of area 1/count of the unit
+    // square contains exactly one of the count points (count must be a power of 2).
+    bool is_02_net(const vector<Vector2d>& points)
+    {
+        const size_t count = points.size();
+
+        for (size_t nx = 1; nx <= count; nx *= 2)
+        {
+            const size_t ny = count / nx;
+
+            vector<size_t> cells(count, 0);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const size_t x = truncate<size_t>(points[i][0] * nx);
+                const size_t y = truncate<size_t>(points[i][1] * ny);
+
+                if (++cells[y * nx + x] > 1)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    TEST_CASE(OwenScrambledSobol02Sequence_AlignedBlocksAre02Nets)
+    {
+        const size_t BlockSize = 64;
+
+        for (uint32 seed = 0; seed < 4; ++seed)
+        {
+            for (size_t block = 0; block < 4; ++block)
+            {
+                vector<Vector2d> points;
+
+                for (size_t i = 0; i < BlockSize; ++i)
+                {
+                    const uint32 n = static_cast<uint32>(block * BlockSize + i);
+                    points.push_back(owen_scrambled_sobol02_sequence<double>(seed, n));
+                }
+
+                EXPECT_TRUE(is_02_net(points));
+            }
+        }
+    }
+
+    TEST_CASE(OwenScrambledSobol02Sequence_DistinctSeedsGiveDistinctSequences)
+    {
+        const Vector2d a = owen_scrambled_sobol02_sequence<double>(0, 0);
+        const Vector2d b = owen_scrambled_sobol02_sequence<double>(1, 0);
+
+        EXPECT_NEQ(a, b);
+    }
+
     // 2D scrambled Hammersley sequence.
     template <typename T>
     inline Vector<T, 2> hammersley_sequence(
@@ -430,6 +533,88 @@ TEST_SUITE(Foundation_Math_QMC)
                 MaplePlotDef("qmc_rmsd").set_legend("RMS Deviation (QMC)").set_color("red")));
     }
 
+    double integrand(const Vector2d& p)
+    {
+        return sin(p[0] * Pi) * sin(p[1] * Pi);
+    }
+
+    TEST_CASE(Integrate2DFunctionInHighDimensions)
+    {
+        //
+        // Integrate a smooth 2D function using the 31st and 32nd dimensions of the
+        // samplers, where the Halton sequence suffers from strong correlations between
+        // consecutive prime bases. Each estimate uses a freshly scrambled sequence,
+        // as the sampling contexts do for each trajectory.
+        //
+
+        const double ExactIntegral = 4.0 / (Pi * Pi);
+        const size_t Dimension = 30;
+        const size_t MaxSampleCount = 1024;
+        const size_t TrialCount = 32;
+
+        MersenneTwister rng;
+
+        vector<double> abscissa;
+        vector<double> rng_rmsd;
+        vector<double> halton_rmsd;
+        vector<double> sobol_rmsd;
+
+        for (size_t sample_count = 16; sample_count <= MaxSampleCount; sample_count *= 2)
+        {
+            double rng_error = 0.0;
+            double halton_error = 0.0;
+            double sobol_error = 0.0;
+
+            for (size_t trial = 0; trial < TrialCount; ++trial)
+            {
+                const size_t Bases[2] = { Primes[Dimension], Primes[Dimension + 1] };
+                const Vector2d offset(rand_double2(rng), rand_double2(rng));
+                const uint32 seed = static_cast<uint32>(trial);
+
+                double rng_sum = 0.0;
+                double halton_sum = 0.0;
+                double sobol_sum = 0.0;
+
+                for (size_t i = 0; i < sample_count; ++i)
+                {
+                    rng_sum += integrand(Vector2d(rand_double2(rng), rand_double2(rng)));
+
+                    Vector2d h = halton_sequence<double, 2>(Bases, i) + offset;
+                    if (h[0] >= 1.0) h[0] -= 1.0;
+                    if (h[1] >= 1.0) h[1] -= 1.0;
+                    halton_sum += integrand(h);
+
+                    sobol_sum +=
+                        integrand(
+                            owen_scrambled_sobol02_sequence<double>(
+                                seed,
+                                static_cast<uint32>(i)));
+                }
+
+                rng_error += square(rng_sum / sample_count - ExactIntegral);
+                halton_error += square(halton_sum / sample_count - ExactIntegral);
+                sobol_error += square(sobol_sum / sample_count - ExactIntegral);
+            }
+
+            abscissa.push_back(static_cast<double>(sample_count));
+            rng_rmsd.push_back(sqrt(rng_error / TrialCount));
+            halton_rmsd.push_back(sqrt(halton_error / TrialCount));
+            sobol_rmsd.push_back(sqrt(sobol_error / TrialCount));
+
+            EXPECT_LT(halton_rmsd.back(), sobol_rmsd.back());
+        }
+
+        MapleFile file("unit tests/outputs/test_qmc_integrate2dfunctioninhighdimensions.mpl");
+        file.define("rng_rmsd", abscissa, rng_rmsd);
+        file.define("halton_rmsd", abscissa, halton_rmsd);
+        file.define("sobol_rmsd", abscissa, sobol_rmsd);
+        file.plot(
+            make_vector(
+                MaplePlotDef("rng_rmsd").set_legend("RMS Deviation (RNG)").set_color("blue"),
+                MaplePlotDef("halton_rmsd").set_legend("RMS Deviation (Halton)").set_color("red"),
+                MaplePlotDef("sobol_rmsd").set_legend("RMS Deviation (Sobol)").set_color("green")));
+    }
+
 #if 0
 
     TEST_CASE(PrecomputeHaltonSequence)
@@ -0,0 +1,91 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/sah.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+
+TEST_SUITE(Foundation_Math_ApproxSAHFunction)
+{
+    using namespace foundation;
+
+    template <size_t MaxBinCount>
+    void find_split(
+        const size_t    bin_count,
+        double&         min_cost,
+        double&         min_abscissa)
+    {
+        // Two clusters of intervals, at both ends of the domain.
+        ApproxSAHFunction<double, MaxBinCount> function(0.0, 10.0, bin_count);
+        for (size_t i = 0; i < 10; ++i)
+        {
+            function.insert(0.5, 1.5);
+            function.insert(8.5, 9.5);
+        }
+
+        const AABB3d bbox(Vector3d(0.0), Vector3d(10.0, 1.0, 1.0));
+        function.minimize(bbox, 0, min_cost, min_abscissa);
+    }
+
+    TEST_CASE(Minimize_GivenTwoClustersOfIntervals_ReturnsAbscissaBetweenClusters)
+    {
+        double min_cost, min_abscissa;
+        find_split<64>(16, min_cost, min_abscissa);
+
+        EXPECT_GT(1.5, min_abscissa);
+        EXPECT_LT(8.5, min_abscissa);
+    }
+
+    TEST_CASE(Minimize_GivenBinCountLowerThanCapacity_MatchesFunctionWithSameFixedBinCount)
+    {
+        double expected_cost, expected_abscissa;
+        find_split<16>(16, expected_cost, expected_abscissa);
+
+        double min_cost, min_abscissa;
+        find_split<64>(16, min_cost, min_abscissa);
+
+        EXPECT_EQ(expected_cost, min_cost);
+        EXPECT_EQ(expected_abscissa, min_abscissa);
+    }
+
+    TEST_CASE(Minimize_GivenBinCount_ReturnsAbscissaOnBinBoundary)
+    {
+        double min_cost, min_abscissa;
+        find_split<64>(19, min_cost, min_abscissa);
+
+        // With 19 bins, candidate abscissas are multiples of 10 / 20.
+        const double k = min_abscissa * 2.0;
+        EXPECT_FEQ(std::floor(k + 0.5), k);
+    }
+}
@@ -103,6 +103,104 @@ TEST_SUITE(Foundation_Math_Sampling_QMCSamplingContext)
         EXPECT_EQ(4, child_child_context.m_dimension);
         EXPECT_EQ(0, child_child_context.m_instance);
     }
+
+    TEST_CASE(SplittingPreservesMode)
+    {
+        RNG rng;
+        QMCSamplingContext context(rng, 2, 64, 7, QMCSamplingContext::SobolMode);
+        QMCSamplingContext child_context = context.split(3, 16);
+
+        EXPECT_EQ(QMCSamplingContext::SobolMode, child_context.get_mode());
+    }
+
+    TEST_CASE(AssignmentOperatorCopiesMode)
+    {
+        RNG rng;
+        QMCSamplingContext original(rng, 2, 64, 7, QMCSamplingContext::SobolMode);
+
+        QMCSamplingContext copy(rng);
+        copy = original;
+
+        EXPECT_EQ(QMCSamplingContext::SobolMode, copy.get_mode());
+    }
+
+    TEST_CASE(SobolMode_ChildSamplesAreStratified)
+    {
+        const size_t SampleCount = 16;
+
+        RNG rng;
+        QMCSamplingContext context(rng, 2, 64, 7, QMCSamplingContext::SobolMode);
+        QMCSamplingContext child_context = context.split(2, SampleCount);
+
+        bool occupied[SampleCount] = { false };
+        bool stratified = true;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const Vector2d s = child_context.next_vector2<2>();
+            const size_t x = static_cast<size_t>(s[0] * 4.0);
+            const size_t y = static_cast<size_t>(s[1] * 4.0);
+
+            if (occupied[y * 4 + x])
+                stratified = false;
+
+            occupied[y * 4 + x] = true;
+        }
+
+        EXPECT_TRUE(stratified);
+    }
+
+    TEST_CASE(SobolMode_SiblingContextsAreDecorrelated)
+    {
+        RNG rng;
+        QMCSamplingContext context(rng, 2, 64, 0, QMCSamplingContext::SobolMode);
+
+        QMCSamplingContext first_child_context = context.split(2, 16);
+        context.set_instance(1);
+        QMCSamplingContext second_child_context = context.split(2, 16);
+
+        EXPECT_NEQ(
+            first_child_context.next_vector2<2>(),
+            second_child_context.next_vector2<2>());
+    }
+
+    TEST_CASE(SobolMode_SingleSampleSplitsOfPixelSamplesAreStratified)
+    {
+        const size_t PixelSampleCount = 16;
+        const size_t Depth = 4;
+
+        RNG rng;
+        size_t counts[Depth][PixelSampleCount] = { { 0 } };
+
+        // Follow the renderer: one context per pixel sample, then one split of a
+        // single sample per bounce.
+        for (size_t instance = 0; instance < PixelSampleCount; ++instance)
+        {
+            QMCSamplingContext context(rng, 1, instance, instance, QMCSamplingContext::SobolMode);
+
+            for (size_t d = 0; d < Depth; ++d)
+            {
+                context.split_in_place(2, 1);
+
+                const Vector2d s = context.next_vector2<2>();
+                const size_t x = static_cast<size_t>(s[0] * 4.0);
+                const size_t y = static_cast<size_t>(s[1] * 4.0);
+
+                ++counts[d][y * 4 + x];
+            }
+        }
+
+        // The first bounce draws from an aligned block of the sequence: one sample per stratum.
+        // Deeper bounces draw from a block shifted by the bounce number: at most two per stratum.
+        for (size_t i = 0; i < PixelSampleCount; ++i)
+            EXPECT_EQ(1, counts[0][i]);
+
+        for (size_t d = 1; d < Depth; ++d)
+        {
+            for (size_t i = 0; i < PixelSampleCount; ++i)
+                EXPECT_LT(3, counts[d][i]);
+        }
+    }
 }
 
 TEST_SUITE(Foundation_Math_Sampling_QMCSamplingContext_DirectIlluminationSimulation)
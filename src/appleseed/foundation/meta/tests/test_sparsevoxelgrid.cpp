@@ -0,0 +1,212 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/rng.h"
+#include "foundation/math/sparsevoxelgrid.h"
+#include "foundation/math/vector.h"
+#include "foundation/math/voxelgrid.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Math_SparseVoxelGrid3)
+{
+    const size_t ChannelCount = 3;
+
+    typedef VoxelGrid3<float, double> DenseGrid;
+    typedef SparseVoxelGrid3<float, double> SparseGrid;
+
+    TEST_CASE(Constructor_DoesNotAllocateBricks)
+    {
+        const SparseGrid grid(20, 13, 17, ChannelCount);
+
+        EXPECT_EQ(0, grid.get_allocated_brick_count());
+    }
+
+    TEST_CASE(ConstVoxel_GivenUnallocatedBrick_ReturnsZeroValues)
+    {
+        const SparseGrid grid(20, 13, 17, ChannelCount);
+
+        const float* values = grid.voxel(19, 12, 16);
+
+        EXPECT_EQ(0.0f, values[0]);
+        EXPECT_EQ(0.0f, values[1]);
+        EXPECT_EQ(0.0f, values[2]);
+        EXPECT_EQ(0, grid.get_allocated_brick_count());
+    }
+
+    TEST_CASE(Voxel_GivenVoxelsOfSameBrick_AllocatesSingleBrick)
+    {
+        SparseGrid grid(20, 13, 17, ChannelCount);
+
+        grid.voxel(16, 8, 8)[0] = 1.0f;
+        grid.voxel(19, 12, 15)[2] = 2.0f;
+
+        EXPECT_EQ(1, grid.get_allocated_brick_count());
+
+        const SparseGrid& const_grid = grid;
+        EXPECT_EQ(1.0f, const_grid.voxel(16, 8, 8)[0]);
+        EXPECT_EQ(0.0f, const_grid.voxel(16, 8, 8)[1]);
+        EXPECT_EQ(2.0f, const_grid.voxel(19, 12, 15)[2]);
+        EXPECT_EQ(0.0f, const_grid.voxel(15, 8, 8)[0]);
+    }
+
+    TEST_CASE(GetMemorySize_GivenMostlyEmptyGrid_IsMuchSmallerThanDenseStorage)
+    {
+        SparseGrid grid(128, 128, 128, ChannelCount);
+
+        for (size_t z = 60; z < 68; ++z)
+        {
+            for (size_t y = 60; y < 68; ++y)
+            {
+                for (size_t x = 60; x < 68; ++x)
+                    grid.voxel(x, y, z)[0] = 1.0f;
+            }
+        }
+
+        const size_t dense_size = 128 * 128 * 128 * ChannelCount * sizeof(float);
+
+        EXPECT_EQ(8, grid.get_allocated_brick_count());
+        EXPECT_LT(dense_size / 100, grid.get_memory_size());
+    }
+
+    struct Fixture
+    {
+        DenseGrid   m_dense_grid;
+        SparseGrid  m_sparse_grid;
+
+        // Fill a ball of random values in a grid whose size is not a multiple of
+        // the brick size; the rest of the grid is left empty.
+        Fixture()
+          : m_dense_grid(20, 13, 17, ChannelCount)
+          , m_sparse_grid(20, 13, 17, ChannelCount)
+        {
+            MersenneTwister rng;
+
+            for (size_t z = 0; z < 17; ++z)
+            {
+                for (size_t y = 0; y < 13; ++y)
+                {
+                    for (size_t x = 0; x < 20; ++x)
+                    {
+                        const Vector3d d(x / 19.0 - 0.6, y / 12.0 - 0.5, z / 16.0 - 0.5);
+                        if (square_norm(d) > 0.16)
+                            continue;
+
+                        for (size_t c = 0; c < ChannelCount; ++c)
+                        {
+                            const float value = rand_float1(rng);
+                            m_dense_grid.voxel(x, y, z)[c] = value;
+                            m_sparse_grid.voxel(x, y, z)[c] = value;
+                        }
+                    }
+                }
+            }
+        }
+
+        enum Interpolator
+        {
+            Nearest,
+            Linear,
+            Quadratic
+        };
+
+        template <typename Grid>
+        static void lookup(
+            const Grid&         grid,
+            const Interpolator  interpolator,
+            const Vector3d&     point,
+            float               values[])
+        {
+            switch (interpolator)
+            {
+              case Nearest:
+                grid.nearest_lookup(point, values);
+                break;
+
+              case Linear:
+                grid.linear_lookup(point, values);
+                break;
+
+              case Quadratic:
+                grid.quadratic_lookup(point, values);
+                break;
+            }
+        }
+
+        size_t count_mismatches(const Interpolator interpolator) const
+        {
+            MersenneTwister rng;
+            size_t mismatch_count = 0;
+
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                // Include points outside of the unit cube to exercise the borders of the grid.
+                const Vector3d point(
+                    rand_double1(rng, -0.1, 1.1),
+                    rand_double1(rng, -0.1, 1.1),
+                    rand_double1(rng, -0.1, 1.1));
+
+                float dense_values[ChannelCount];
+                float sparse_values[ChannelCount];
+                lookup(m_dense_grid, interpolator, point, dense_values);
+                lookup(m_sparse_grid, interpolator, point, sparse_values);
+
+                for (size_t c = 0; c < ChannelCount; ++c)
+                {
+                    if (!feq(dense_values[c], sparse_values[c]))
+                    {
+                        ++mismatch_count;
+                        break;
+                    }
+                }
+            }
+
+            return mismatch_count;
+        }
+    };
+
+    TEST_CASE_F(NearestLookup_MatchesDenseGrid, Fixture)
+    {
+        EXPECT_EQ(0, count_mismatches(Nearest));
+    }
+
+    TEST_CASE_F(LinearLookup_MatchesDenseGrid, Fixture)
+    {
+        EXPECT_EQ(0, count_mismatches(Linear));
+    }
+
+    TEST_CASE_F(QuadraticLookup_MatchesDenseGrid, Fixture)
+    {
+        EXPECT_EQ(0, count_mismatches(Quadratic));
+    }
+}
@@ -31,6 +31,10 @@
 #include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+
 TEST_SUITE(Foundation_Image_Spectrum31f)
 {
     using namespace foundation;
@@ -162,4 +166,97 @@ TEST_SUITE(Foundation_Image_Spectrum31f)
 
         EXPECT_FALSE(is_saturated(s));
     }
+
+    TEST_CASE(MultiplyAdd)
+    {
+        const Spectrum31f A(2.0f);
+        const Spectrum31f B(3.0f);
+        Spectrum31f s(1.0f);
+
+        madd(s, A, B);
+
+        EXPECT_FEQ(Spectrum31f(7.0f), s);
+    }
+
+    TEST_CASE(MultiplyAddByScalar)
+    {
+        const Spectrum31f A(2.0f);
+        Spectrum31f s(1.0f);
+
+        madd(s, A, 0.5f);
+
+        EXPECT_FEQ(Spectrum31f(2.0f), s);
+    }
+
+    TEST_CASE(DivisionByScalar_DoesNotModifyOperand)
+    {
+        Spectrum31f s(2.0f);
+
+        const Spectrum31f result = s / 2.0f;
+
+        EXPECT_FEQ(Spectrum31f(1.0f), result);
+        EXPECT_FEQ(Spectrum31f(2.0f), s);
+    }
+
+    // The following tests make sure that the padding samples, which are set by set(), are ignored.
+
+    TEST_CASE(MaxValue_GivenNegativeSpectrum_ReturnsLargestComponent)
+    {
+        Spectrum31f s(10.0f);
+
+        for (size_t i = 0; i < 31; ++i)
+            s[i] = -1.0f - static_cast<float>(i);
+
+        EXPECT_EQ(-1.0f, max_value(s));
+    }
+
+    TEST_CASE(MinValue_GivenPositiveSpectrum_ReturnsSmallestComponent)
+    {
+        Spectrum31f s(-10.0f);
+
+        for (size_t i = 0; i < 31; ++i)
+            s[i] = 1.0f + static_cast<float>(i);
+
+        EXPECT_EQ(1.0f, min_value(s));
+    }
+
+    TEST_CASE(AverageValue)
+    {
+        Spectrum31f s(100.0f);
+
+        for (size_t i = 0; i < 31; ++i)
+            s[i] = static_cast<float>(i);
+
+        EXPECT_FEQ(15.0f, average_value(s));
+    }
+
+    TEST_CASE(Fz_GivenZeroSpectrum_ReturnsTrue)
+    {
+        Spectrum31f s(1.0f);
+
+        for (size_t i = 0; i < 31; ++i)
+            s[i] = 0.0f;
+
+        EXPECT_TRUE(fz(s));
+    }
+
+    TEST_CASE(Fz_GivenSpectrumWithNonZeroLastComponent_ReturnsFalse)
+    {
+        Spectrum31f s(0.0f);
+        s[30] = 1.0f;
+
+        EXPECT_FALSE(fz(s));
+    }
+
+    TEST_CASE(Max)
+    {
+        Spectrum31f a(1.0f);
+        Spectrum31f b(2.0f);
+        a[3] = 3.0f;
+
+        const Spectrum31f result = std::max(a, b);
+
+        EXPECT_EQ(3.0f, result[3]);
+        EXPECT_EQ(2.0f, result[30]);
+    }
 }
@@ -0,0 +1,246 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_PLATFORM_ATOMIC_H
+#define APPLESEED_FOUNDATION_PLATFORM_ATOMIC_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Platform headers.
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace foundation
+{
+
+//
+// Atomic operations on 32-bit integers and on pointers.
+//
+// Reads have acquire semantics, writes have release semantics, and
+// read-modify-write operations act as full memory barriers.
+//
+
+// Read a value.
+uint32 atomic_read(const volatile uint32* ptr);
+template <typename T> T* atomic_read(T* const volatile* ptr);
+
+// Write a value.
+void atomic_write(volatile uint32* ptr, const uint32 value);
+template <typename T> void atomic_write(T* volatile* ptr, T* value);
+
+// Add a value to an integer and return the new value.
+uint32 atomic_add(volatile uint32* ptr, const uint32 value);
+
+// Increment or decrement an integer and return the new value.
+uint32 atomic_inc(volatile uint32* ptr);
+uint32 atomic_dec(volatile uint32* ptr);
+
+// Replace a value by new_value if it is equal to expected_value.
+// Return the value that was stored before the operation.
+uint32 atomic_cas(volatile uint32* ptr, const uint32 expected_value, const uint32 new_value);
+template <typename T> T* atomic_cas(T* volatile* ptr, T* expected_value, T* new_value);
+
+
+//
+// Visual C++ implementation.
+//
+// On x86 and x64, volatile reads and writes have acquire and release
+// semantics; we only need to prevent the compiler from reordering them.
+//
+
+#if defined _MSC_VER
+
+inline uint32 atomic_read(const volatile uint32* ptr)
+{
+    const uint32 value = *ptr;
+    _ReadWriteBarrier();
+    return value;
+}
+
+template <typename T>
+inline T* atomic_read(T* const volatile* ptr)
+{
+    T* value = *ptr;
+    _ReadWriteBarrier();
+    return value;
+}
+
+inline void atomic_write(volatile uint32* ptr, const uint32 value)
+{
+    _ReadWriteBarrier();
+    *ptr = value;
+}
+
+template <typename T>
+inline void atomic_write(T* volatile* ptr, T* value)
+{
+    _ReadWriteBarrier();
+    *ptr = value;
+}
+
+inline uint32 atomic_add(volatile uint32* ptr, const uint32 value)
+{
+    return static_cast<uint32>(
+        _InterlockedExchangeAdd(reinterpret_cast<volatile long*>(ptr), static_cast<long>(value))) + value;
+}
+
+inline uint32 atomic_inc(volatile uint32* ptr)
+{
+    return static_cast<uint32>(_InterlockedIncrement(reinterpret_cast<volatile long*>(ptr)));
+}
+
+inline uint32 atomic_dec(volatile uint32* ptr)
+{
+    return static_cast<uint32>(_InterlockedDecrement(reinterpret_cast<volatile long*>(ptr)));
+}
+
+inline uint32 atomic_cas(volatile uint32* ptr, const uint32 expected_value, const uint32 new_value)
+{
+    return static_cast<uint32>(
+        _InterlockedCompareExchange(
+            reinterpret_cast<volatile long*>(ptr),
+            static_cast<long>(new_value),
+            static_cast<long>(expected_value)));
+}
+
+template <typename T>
+inline T* atomic_cas(T* volatile* ptr, T* expected_value, T* new_value)
+{
+    return static_cast<T*>(
+        _InterlockedCompareExchangePointer(
+            reinterpret_cast<void* volatile*>(ptr),
+            new_value,
+            expected_value));
+}
+
+
+//
+// gcc implementation.
+//
+// The __atomic builtins are used when available (gcc 4.7 and later, clang),
+// otherwise we fall back to full memory barriers.
+//
+
+#elif defined __GNUC__
+
+#if defined __ATOMIC_ACQUIRE
+
+inline uint32 atomic_read(const volatile uint32* ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+template <typename T>
+inline T* atomic_read(T* const volatile* ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+inline void atomic_write(volatile uint32* ptr, const uint32 value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+inline void atomic_write(T* volatile* ptr, T* value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+#else
+
+inline uint32 atomic_read(const volatile uint32* ptr)
+{
+    const uint32 value = *ptr;
+    __sync_synchronize();
+    return value;
+}
+
+template <typename T>
+inline T* atomic_read(T* const volatile* ptr)
+{
+    T* value = *ptr;
+    __sync_synchronize();
+    return value;
+}
+
+inline void atomic_write(volatile uint32* ptr, const uint32 value)
+{
+    __sync_synchronize();
+    *ptr = value;
+}
+
+template <typename T>
+inline void atomic_write(T* volatile* ptr, T* value)
+{
+    __sync_synchronize();
+    *ptr = value;
+}
+
+#endif
+
+inline uint32 atomic_add(volatile uint32* ptr, const uint32 value)
+{
+    return __sync_add_and_fetch(ptr, value);
+}
+
+inline uint32 atomic_inc(volatile uint32* ptr)
+{
+    return __sync_add_and_fetch(ptr, 1);
+}
+
+inline uint32 atomic_dec(volatile uint32* ptr)
+{
+    return __sync_sub_and_fetch(ptr, 1);
+}
+
+inline uint32 atomic_cas(volatile uint32* ptr, const uint32 expected_value, const uint32 new_value)
+{
+    return __sync_val_compare_and_swap(ptr, expected_value, new_value);
+}
+
+template <typename T>
+inline T* atomic_cas(T* volatile* ptr, T* expected_value, T* new_value)
+{
+    return __sync_val_compare_and_swap(ptr, expected_value, new_value);
+}
+
+
+//
+// Unsupported platform.
+//
+
+#else
+#error Atomic operations are not implemented on this platform.
+#endif
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_PLATFORM_ATOMIC_H
@@ -82,6 +82,7 @@ typedef __m128d sse2d;
 #define storeps         _mm_store_ps
 #define storeups        _mm_storeu_ps
 #define subps           _mm_sub_ps
+#define xorps           _mm_xor_ps
 
 // Double-precision packet instructions.
 #define addpd           _mm_add_pd
@@ -110,6 +111,7 @@ typedef __m128d sse2d;
 #define storepd         _mm_store_pd
 #define storeupd        _mm_storeu_pd
 #define subpd           _mm_sub_pd
+#define xorpd           _mm_xor_pd
 
 
 //
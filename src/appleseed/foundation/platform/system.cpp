@@ -31,8 +31,19 @@
 
 // appleseed.foundation headers.
 #include "foundation/platform/thread.h"
+#ifdef _WIN32
+#include "foundation/platform/windows.h"
+#endif
 #include "foundation/platform/x86timer.h"
 
+// Standard headers.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
 namespace foundation
 {
 
@@ -53,6 +64,145 @@ uint64 System::get_cpu_core_frequency(const size_t /*cpu_id*/, const uint32 cali
     return X86Timer(calibration_time_ms).frequency();
 }
 
+#if defined _WIN32
+
+size_t System::get_numa_node_count()
+{
+    ULONG highest_node_number;
+
+    if (!GetNumaHighestNodeNumber(&highest_node_number))
+        return 1;
+
+    return static_cast<size_t>(highest_node_number) + 1;
+}
+
+void System::get_numa_node_cpus(
+    const size_t            node,
+    vector<size_t>&         cpus)
+{
+    cpus.clear();
+
+    ULONGLONG mask;
+
+    if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask))
+    {
+        // Assume a single node containing all logical CPU cores.
+        if (node == 0)
+        {
+            const size_t cpu_count = get_logical_cpu_core_count();
+            for (size_t i = 0; i < cpu_count; ++i)
+                cpus.push_back(i);
+        }
+
+        return;
+    }
+
+    for (size_t i = 0; i < 64; ++i)
+    {
+        if (mask & (ULONGLONG(1) << i))
+            cpus.push_back(i);
+    }
+}
+
+#elif defined __linux__
+
+namespace
+{
+    // Read the list of logical CPU cores of a given NUMA node from sysfs.
+    // The list has the form "0-7,16-23". Return false if the node does not exist.
+    bool read_numa_node_cpu_list(const size_t node, vector<size_t>& cpus)
+    {
+        char path[128];
+        sprintf(path, "/sys/devices/system/node/node%u/cpulist", static_cast<unsigned int>(node));
+
+        FILE* file = fopen(path, "rt");
+
+        if (file == 0)
+            return false;
+
+        char buffer[4096];
+        const bool success = fgets(buffer, sizeof(buffer), file) != 0;
+
+        fclose(file);
+
+        if (!success)
+            return false;
+
+        const char* p = buffer;
+
+        while (*p >= '0' && *p <= '9')
+        {
+            char* end;
+            const size_t first = static_cast<size_t>(strtoul(p, &end, 10));
+            size_t last = first;
+            p = end;
+
+            if (*p == '-')
+            {
+                last = static_cast<size_t>(strtoul(p + 1, &end, 10));
+                p = end;
+            }
+
+            for (size_t cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+
+            if (*p == ',')
+                ++p;
+        }
+
+        return true;
+    }
+}
+
+size_t System::get_numa_node_count()
+{
+    size_t node_count = 0;
+    vector<size_t> cpus;
+
+    while (read_numa_node_cpu_list(node_count, cpus))
+        ++node_count;
+
+    return node_count > 0 ? node_count : 1;
+}
+
+void System::get_numa_node_cpus(
+    const size_t            node,
+    vector<size_t>&         cpus)
+{
+    cpus.clear();
+
+    if (!read_numa_node_cpu_list(node, cpus) && node == 0)
+    {
+        // Assume a single node containing all logical CPU cores.
+        const size_t cpu_count = get_logical_cpu_core_count();
+        for (size_t i = 0; i < cpu_count; ++i)
+            cpus.push_back(i);
+    }
+}
+
+#else
+
+size_t System::get_numa_node_count()
+{
+    return 1;
+}
+
+void System::get_numa_node_cpus(
+    const size_t            node,
+    vector<size_t>&         cpus)
+{
+    cpus.clear();
+
+    if (node == 0)
+    {
+        const size_t cpu_count = get_logical_cpu_core_count();
+        for (size_t i = 0; i < cpu_count; ++i)
+            cpus.push_back(i);
+    }
+}
+
+#endif
+
 size_t System::get_l1_data_cache_size(const size_t /*cpu_id*/)
 {
     // todo: implement.
@@ -35,6 +35,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 //
 // On Windows, define FOUNDATIONDLL to __declspec(dllexport) when building the DLL
@@ -78,6 +79,19 @@ class FOUNDATIONDLL System
         const size_t    cpu_id,
         const uint32    calibration_time_ms = 10);
 
+    //
+    // NUMA nodes.
+    //
+
+    // Return the number of NUMA nodes in the system. Systems without NUMA support
+    // are reported as having a single node that contains all logical CPU cores.
+    static size_t get_numa_node_count();
+
+    // Retrieve the logical CPU cores that belong to a given NUMA node, in ascending order.
+    static void get_numa_node_cpus(
+        const size_t            node,
+        std::vector<size_t>&    cpus);
+
     //
     // CPU caches.
     //
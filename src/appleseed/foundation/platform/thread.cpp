@@ -39,6 +39,10 @@
 
 // Standard headers.
 #include <cassert>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace boost;
 
@@ -116,4 +120,32 @@ void yield()
     this_thread::yield();
 }
 
+bool set_current_thread_cpu_affinity(const size_t cpu)
+{
+#if defined _WIN32
+
+    if (cpu >= sizeof(DWORD_PTR) * 8)
+        return false;
+
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+
+#elif defined __linux__
+
+    if (cpu >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+
+#else
+
+    // Not supported on this platform.
+    return false;
+
+#endif
+}
+
 }   // namespace foundation
@@ -150,6 +150,10 @@ FOUNDATIONDLL void sleep(const uint32 ms);
 // Give up the remainder of the current thread's time slice, to allow other threads to run.
 FOUNDATIONDLL void yield();
 
+// Restrict the current thread to run on a given logical CPU core.
+// Return false if the operation failed or is not supported on this platform.
+FOUNDATIONDLL bool set_current_thread_cpu_affinity(const size_t cpu);
+
 
 //
 // Spinlock class implementation.
@@ -31,6 +31,7 @@
 
 // Interface headers.
 #include "foundation/utility/benchmark/benchmarkaggregator.h"
+#include "foundation/utility/benchmark/benchmarkbaseline.h"
 #include "foundation/utility/benchmark/benchmarkdatapoint.h"
 #include "foundation/utility/benchmark/benchmarklistenerbase.h"
 #include "foundation/utility/benchmark/benchmarkresult.h"
@@ -41,6 +42,7 @@
 #include "foundation/utility/benchmark/ibenchmarkcasefactory.h"
 #include "foundation/utility/benchmark/ibenchmarklistener.h"
 #include "foundation/utility/benchmark/loggerbenchmarklistener.h"
+#include "foundation/utility/benchmark/regressionbenchmarklistener.h"
 #include "foundation/utility/benchmark/timingresult.h"
 #include "foundation/utility/benchmark/xmlfilebenchmarklistener.h"
 
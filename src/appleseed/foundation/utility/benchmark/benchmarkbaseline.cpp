@@ -0,0 +1,371 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "benchmarkbaseline.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark/timingresult.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/xercesc.h"
+
+// boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
+// Xerces-C++ headers.
+#include "xercesc/dom/DOM.hpp"
+#include "xercesc/parsers/XercesDOMParser.hpp"
+#include "xercesc/sax/ErrorHandler.hpp"
+#include "xercesc/sax/SAXParseException.hpp"
+#include "xercesc/util/XMLException.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <string>
+
+using namespace boost;
+using namespace std;
+using namespace xercesc;
+
+namespace foundation
+{
+
+namespace
+{
+    string get_attribute(const DOMNode* node, const char* name)
+    {
+        const DOMNamedNodeMap* attributes = node->getAttributes();
+        const DOMNode* attribute = attributes->getNamedItem(transcode(name).c_str());
+        return attribute ? transcode(attribute->getNodeValue()) : string();
+    }
+
+    string get_text(const DOMNode* node)
+    {
+        const DOMNode* child = node->getFirstChild();
+        return child && child->getNodeType() == DOMNode::TEXT_NODE
+            ? transcode(child->getTextContent())
+            : string();
+    }
+
+    bool is_element(const DOMNode* node, const char* name)
+    {
+        return
+            node->getNodeType() == DOMNode::ELEMENT_NODE &&
+            transcode(node->getNodeName()) == name;
+    }
+
+    //
+    // Terminates parsing on the first error. Files that aren't valid benchmark
+    // files are simply not loaded, so errors aren't reported to the user.
+    //
+
+    class ParseErrorHandler
+      : public ErrorHandler
+    {
+      public:
+        virtual void resetErrors()
+        {
+        }
+
+        virtual void warning(const SAXParseException& e)
+        {
+        }
+
+        virtual void error(const SAXParseException& e)
+        {
+            throw e;    // terminate parsing
+        }
+
+        virtual void fatalError(const SAXParseException& e)
+        {
+            throw e;    // terminate parsing
+        }
+    };
+}
+
+struct BenchmarkBaseline::Impl
+{
+    XercesCContext      m_xerces_context;
+    ParseErrorHandler   m_error_handler;
+    XercesDOMParser     m_xerces_parser;
+
+    typedef map<string, TimingResult> TimingResultMap;
+
+    TimingResultMap     m_results;
+
+    Impl()
+    {
+        m_xerces_parser.setCreateCommentNodes(false);
+        m_xerces_parser.setErrorHandler(&m_error_handler);
+    }
+
+    static string make_key(
+        const string&               suite_name,
+        const string&               case_name)
+    {
+        return suite_name + "::" + case_name;
+    }
+
+    bool scan_document(const DOMDocument* document)
+    {
+        assert(document);
+
+        const DOMNode* node = document->getFirstChild();
+
+        while (node && node->getNodeType() != DOMNode::ELEMENT_NODE)
+            node = node->getNextSibling();
+
+        if (!node || !is_element(node, "benchmarkexecution"))
+            return false;
+
+        for (node = node->getFirstChild(); node; node = node->getNextSibling())
+        {
+            if (is_element(node, "benchmarksuite"))
+                scan_cases(node, get_attribute(node, "name"));
+        }
+
+        return true;
+    }
+
+    void scan_cases(
+        const DOMNode*              node,
+        const string&               suite_name)
+    {
+        for (node = node->getFirstChild(); node; node = node->getNextSibling())
+        {
+            if (!is_element(node, "benchmarkcase"))
+                continue;
+
+            TimingResult result;
+
+            if (!scan_results(node, result))
+                continue;
+
+            const string key = make_key(suite_name, get_attribute(node, "name"));
+            const TimingResultMap::iterator i = m_results.find(key);
+
+            if (i == m_results.end())
+                m_results[key] = result;
+            else
+                i->second = pool_timing_results(i->second, result);
+        }
+    }
+
+    static bool scan_results(
+        const DOMNode*              node,
+        TimingResult&               result)
+    {
+        for (node = node->getFirstChild(); node; node = node->getNextSibling())
+        {
+            if (is_element(node, "results"))
+                break;
+        }
+
+        if (!node)
+            return false;
+
+        result.m_iteration_count = 0;
+        result.m_measurement_count = 0;
+        result.m_frequency = 0.0;
+        result.m_ticks = 0.0;
+        result.m_mean_ticks = -1.0;
+        result.m_dev_ticks = 0.0;
+
+        for (node = node->getFirstChild(); node; node = node->getNextSibling())
+        {
+            if (node->getNodeType() != DOMNode::ELEMENT_NODE)
+                continue;
+
+            const string name = transcode(node->getNodeName());
+            const string text = get_text(node);
+
+            if (name == "iterations")
+                result.m_iteration_count = from_string<size_t>(text);
+            else if (name == "measurements")
+                result.m_measurement_count = from_string<size_t>(text);
+            else if (name == "frequency")
+                result.m_frequency = from_string<double>(text);
+            else if (name == "ticks")
+                result.m_ticks = from_string<double>(text);
+            else if (name == "meanticks")
+                result.m_mean_ticks = from_string<double>(text);
+            else if (name == "devticks")
+                result.m_dev_ticks = from_string<double>(text);
+        }
+
+        // Files written before running time statistics were recorded only contain
+        // the lowest running time; m_mean_ticks is left negative for those.
+        return result.m_frequency > 0.0;
+    }
+};
+
+BenchmarkBaseline::BenchmarkBaseline()
+  : impl(new Impl())
+{
+}
+
+BenchmarkBaseline::~BenchmarkBaseline()
+{
+    delete impl;
+}
+
+void BenchmarkBaseline::clear()
+{
+    impl->m_results.clear();
+}
+
+bool BenchmarkBaseline::load_file(const char* path)
+{
+    assert(path);
+
+    if (!impl->m_xerces_context.is_initialized())
+        return false;
+
+    if (!filesystem::is_regular_file(path))
+        return false;
+
+    try
+    {
+        impl->m_xerces_parser.parse(path);
+    }
+    catch (const SAXParseException&)
+    {
+        return false;
+    }
+    catch (const XMLException&)
+    {
+        return false;
+    }
+    catch (const DOMException&)
+    {
+        return false;
+    }
+
+    const DOMDocument* document = impl->m_xerces_parser.getDocument();
+
+    if (!document)
+        return false;
+
+    return impl->scan_document(document);
+}
+
+size_t BenchmarkBaseline::load_directory(const char* path)
+{
+    assert(path);
+
+    if (!filesystem::is_directory(path))
+        return 0;
+
+    size_t loaded_file_count = 0;
+
+    for (filesystem::directory_iterator i(path), e; i != e; ++i)
+    {
+        if (!filesystem::is_regular_file(i->status()))
+            continue;
+
+        if (load_file(i->path().string().c_str()))
+            ++loaded_file_count;
+    }
+
+    return loaded_file_count;
+}
+
+size_t BenchmarkBaseline::size() const
+{
+    return impl->m_results.size();
+}
+
+const TimingResult* BenchmarkBaseline::get(
+    const char*     suite_name,
+    const char*     case_name) const
+{
+    assert(suite_name);
+    assert(case_name);
+
+    const Impl::TimingResultMap::const_iterator i =
+        impl->m_results.find(Impl::make_key(suite_name, case_name));
+
+    return i == impl->m_results.end() ? 0 : &i->second;
+}
+
+TimingResult pool_timing_results(
+    const TimingResult& lhs,
+    const TimingResult& rhs)
+{
+    assert(lhs.m_frequency > 0.0);
+    assert(rhs.m_frequency > 0.0);
+
+    // Express the second result in the timer ticks of the first one.
+    const double scale = lhs.m_frequency / rhs.m_frequency;
+    const double rhs_ticks = rhs.m_ticks * scale;
+    const double rhs_mean = rhs.m_mean_ticks * scale;
+    const double rhs_dev = rhs.m_dev_ticks * scale;
+
+    const double n1 = static_cast<double>(lhs.m_measurement_count);
+    const double n2 = static_cast<double>(rhs.m_measurement_count);
+    const double n = n1 + n2;
+
+    TimingResult result;
+    result.m_iteration_count = lhs.m_iteration_count;
+    result.m_measurement_count = lhs.m_measurement_count + rhs.m_measurement_count;
+    result.m_frequency = lhs.m_frequency;
+    result.m_ticks = min(lhs.m_ticks, rhs_ticks);
+
+    if (lhs.m_mean_ticks < 0.0 || rhs.m_mean_ticks < 0.0)
+    {
+        // Statistics are missing on one side, only the lowest running time is meaningful.
+        result.m_mean_ticks = -1.0;
+        result.m_dev_ticks = 0.0;
+    }
+    else if (n > 0.0)
+    {
+        // Combine the means and the variances of both populations.
+        const double mean = (n1 * lhs.m_mean_ticks + n2 * rhs_mean) / n;
+        const double d1 = lhs.m_mean_ticks - mean;
+        const double d2 = rhs_mean - mean;
+        const double var =
+            (n1 * (lhs.m_dev_ticks * lhs.m_dev_ticks + d1 * d1) +
+             n2 * (rhs_dev * rhs_dev + d2 * d2)) / n;
+
+        result.m_mean_ticks = mean;
+        result.m_dev_ticks = sqrt(var);
+    }
+    else
+    {
+        result.m_mean_ticks = lhs.m_mean_ticks;
+        result.m_dev_ticks = lhs.m_dev_ticks;
+    }
+
+    return result;
+}
+
+}   // namespace foundation
@@ -0,0 +1,113 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_BENCHMARK_BENCHMARKBASELINE_H
+#define APPLESEED_FOUNDATION_UTILITY_BENCHMARK_BENCHMARKBASELINE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class TimingResult; }
+
+//
+// On Windows, define FOUNDATIONDLL to __declspec(dllexport) when building the DLL
+// and to __declspec(dllimport) when building an application using the DLL.
+// Other platforms don't use this export mechanism and the symbol FOUNDATIONDLL is
+// defined to evaluate to nothing.
+//
+
+#ifndef FOUNDATIONDLL
+#ifdef _WIN32
+#ifdef APPLESEED_FOUNDATION_EXPORTS
+#define FOUNDATIONDLL __declspec(dllexport)
+#else
+#define FOUNDATIONDLL __declspec(dllimport)
+#endif
+#else
+#define FOUNDATIONDLL
+#endif
+#endif
+
+namespace foundation
+{
+
+//
+// The timing results of previous benchmark executions, used as a reference to
+// detect performance regressions. Results are read from the files written by
+// XMLFileBenchmarkListener. When several files are loaded, the measurements of
+// a given benchmark case are pooled together.
+//
+
+class FOUNDATIONDLL BenchmarkBaseline
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    BenchmarkBaseline();
+
+    // Destructor.
+    ~BenchmarkBaseline();
+
+    // Remove all timing results from the baseline.
+    void clear();
+
+    // Load the timing results from a benchmark results file.
+    // Returns true on success, false otherwise.
+    bool load_file(const char* path);
+
+    // Load the timing results from all the benchmark results files of a directory.
+    // Returns the number of files that were successfully loaded.
+    size_t load_directory(const char* path);
+
+    // Return the number of benchmark cases in the baseline.
+    size_t size() const;
+
+    // Return the timing result of a given benchmark case,
+    // or 0 if this benchmark case is not part of the baseline.
+    const TimingResult* get(
+        const char*     suite_name,
+        const char*     case_name) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+// Merge the measurements of two timing results of the same benchmark case.
+// The merged result is expressed in the timer ticks of the first result.
+FOUNDATIONDLL TimingResult pool_timing_results(
+    const TimingResult& lhs,
+    const TimingResult& rhs);
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_BENCHMARK_BENCHMARKBASELINE_H
@@ -30,6 +30,7 @@
 #include "benchmarksuite.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/population.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/timer.h"
 #include "foundation/platform/types.h"
@@ -154,6 +155,38 @@ struct BenchmarkSuite::Impl
         const size_t InitialMeasurementCount = 100;
         const double TargetMeasurementRuntime = 1.0e-4;     // seconds
         const double TargetTotalRuntime = 0.2;              // seconds
+        const size_t MaxProbeMeasurementCount = 20;
+        const double SlowCaseRuntime = 1.0e-3;              // seconds
+
+        // Measure the runtime of a single iteration first: cases such as building
+        // acceleration structures or rendering a frame can't afford to be run
+        // thousands of times just to estimate benchmarking parameters. Single runs
+        // are repeated within the target total runtime and the lowest runtime is
+        // kept, since early runs suffer from cold caches and thread startup.
+        double single_runtime = numeric_limits<double>::max();
+        double probe_runtime = 0.0;
+
+        for (size_t i = 0; i < MaxProbeMeasurementCount && probe_runtime < TargetTotalRuntime; ++i)
+        {
+            const double runtime =
+                measure_runtime_seconds(
+                    benchmark,
+                    stopwatch,
+                    1);
+
+            single_runtime = min(single_runtime, runtime);
+            probe_runtime += runtime;
+        }
+
+        // Measure slow cases one iteration at a time, for the target total runtime.
+        if (single_runtime >= SlowCaseRuntime)
+        {
+            params.m_iteration_count = 1;
+            params.m_measurement_count =
+                static_cast<size_t>(TargetTotalRuntime / single_runtime);
+            params.m_measurement_count = max<size_t>(1, params.m_measurement_count);
+            return;
+        }
 
         // Measure the runtime for this initial number of iterations.
         const double runtime =
@@ -175,19 +208,23 @@ struct BenchmarkSuite::Impl
         params.m_measurement_count = max<size_t>(1, params.m_measurement_count);
     }
 
-    static double measure_iteration_runtime(
+    // Measure the running time of a single iteration, once per measurement.
+    static void measure_iteration_runtime(
         IBenchmarkCase*         benchmark,
         StopwatchType&          stopwatch,
-        const BenchmarkParams&  params)
+        const BenchmarkParams&  params,
+        Population<double>&     runtimes)
     {
-        return
-            measure_runtime(
-                benchmark,
-                stopwatch,
-                BenchmarkSuite::Impl::measure_runtime_ticks,
-                params.m_iteration_count,
-                params.m_measurement_count)
-            / params.m_iteration_count;
+        for (size_t i = 0; i < params.m_measurement_count; ++i)
+        {
+            const double runtime =
+                measure_runtime_ticks(
+                    benchmark,
+                    stopwatch,
+                    params.m_iteration_count);
+
+            runtimes.insert(runtime / params.m_iteration_count);
+        }
     }
 
     // Measure and return the overhead (in ticks) of running an empty benchmark case.
@@ -196,7 +233,9 @@ struct BenchmarkSuite::Impl
         const BenchmarkParams&  params)
     {
         auto_ptr<IBenchmarkCase> empty_case(new EmptyBenchmarkCase());
-        return measure_iteration_runtime(empty_case.get(), stopwatch, params);
+        Population<double> runtimes;
+        measure_iteration_runtime(empty_case.get(), stopwatch, params, runtimes);
+        return runtimes.get_min();
     }
 };
 
@@ -274,18 +313,23 @@ void BenchmarkSuite::run(
                 Impl::measure_call_overhead(stopwatch, params);
 
             // Run the benchmark case.
-            const double execution_time =
-                Impl::measure_iteration_runtime(
-                    benchmark.get(),
-                    stopwatch,
-                    params);
+            Population<double> runtimes;
+            Impl::measure_iteration_runtime(
+                benchmark.get(),
+                stopwatch,
+                params,
+                runtimes);
 
             // Gather the timing results.
+            const double execution_time = runtimes.get_min();
+            const double mean_execution_time = runtimes.get_avg();
             TimingResult timing_result;
             timing_result.m_iteration_count = params.m_iteration_count;
             timing_result.m_measurement_count = params.m_measurement_count;
             timing_result.m_frequency = static_cast<double>(stopwatch.get_timer().frequency());
             timing_result.m_ticks = execution_time > overhead ? execution_time - overhead : 0.0;
+            timing_result.m_mean_ticks = mean_execution_time > overhead ? mean_execution_time - overhead : 0.0;
+            timing_result.m_dev_ticks = runtimes.get_dev();
 
             // Post the timing result.
             suite_result.write(
@@ -0,0 +1,274 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "regressionbenchmarklistener.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark/benchmarkbaseline.h"
+#include "foundation/utility/benchmark/benchmarksuite.h"
+#include "foundation/utility/benchmark/ibenchmarkcase.h"
+#include "foundation/utility/benchmark/timingresult.h"
+#include "foundation/utility/countof.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cassert>
+#include <cmath>
+#include <string>
+
+using namespace std;
+
+namespace foundation
+{
+
+namespace
+{
+    // Return the 97.5th percentile of Student's t-distribution with a given number
+    // of degrees of freedom, used to build two-sided 95% confidence intervals.
+    double student_t_975(const double dof)
+    {
+        static const double Table[] =
+        {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+             2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+             2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+
+        if (dof < 1.0)
+            return Table[0];
+
+        if (dof <= countof(Table))
+            return Table[static_cast<size_t>(dof) - 1];
+
+        if (dof <= 60.0)
+            return 2.021;
+
+        if (dof <= 120.0)
+            return 2.000;
+
+        return 1.960;
+    }
+
+    // Pretty-print a ratio as a signed relative change, e.g. "+4.2%".
+    string pretty_change(const double ratio)
+    {
+        const double change = (ratio - 1.0) * 100.0;
+        return (change < 0.0 ? "-" : "+") + pretty_scalar(abs(change)) + "%";
+    }
+}
+
+TimingComparison compare_timing_results(
+    const TimingResult&     baseline,
+    const TimingResult&     timing_result)
+{
+    assert(baseline.m_frequency > 0.0);
+    assert(timing_result.m_frequency > 0.0);
+
+    TimingComparison comparison;
+    comparison.m_conclusive = true;
+
+    if (baseline.m_mean_ticks < 0.0)
+    {
+        // The baseline only records the lowest running time: compare it to ours, as an exact value.
+        // Work in seconds since the timer frequency varies from one execution to the next.
+        const double base_lowest = baseline.m_ticks / baseline.m_frequency;
+        const double lowest = timing_result.m_ticks / timing_result.m_frequency;
+
+        comparison.m_ratio = base_lowest > 0.0 ? lowest / base_lowest : 1.0;
+        comparison.m_ratio_low = comparison.m_ratio_high = comparison.m_ratio;
+        return comparison;
+    }
+
+    // Work in seconds since the timer frequency varies from one execution to the next.
+    const double base_mean = baseline.m_mean_ticks / baseline.m_frequency;
+    const double base_dev = baseline.m_dev_ticks / baseline.m_frequency;
+    const double mean = timing_result.m_mean_ticks / timing_result.m_frequency;
+    const double dev = timing_result.m_dev_ticks / timing_result.m_frequency;
+
+    if (base_mean <= 0.0)
+    {
+        // The baseline running time is negligible, nothing meaningful can be said.
+        comparison.m_ratio = comparison.m_ratio_low = comparison.m_ratio_high = 1.0;
+        return comparison;
+    }
+
+    if (baseline.m_measurement_count < 2 || timing_result.m_measurement_count < 2)
+    {
+        // A single measurement says nothing about the variance of the running time.
+        comparison.m_conclusive = false;
+        comparison.m_ratio = comparison.m_ratio_low = comparison.m_ratio_high = mean / base_mean;
+        return comparison;
+    }
+
+    // Variances of the sample means. Recorded deviations are population deviations,
+    // so dividing their square by n - 1 yields the unbiased estimate.
+    const double base_n = static_cast<double>(baseline.m_measurement_count);
+    const double n = static_cast<double>(timing_result.m_measurement_count);
+    const double base_var = base_dev * base_dev / (base_n - 1.0);
+    const double var = dev * dev / (n - 1.0);
+
+    // Welch-Satterthwaite approximation of the degrees of freedom.
+    double half_width = 0.0;
+    if (base_var + var > 0.0)
+    {
+        const double d =
+              base_var * base_var / (base_n - 1.0)
+            + var * var / (n - 1.0);
+        const double dof = (base_var + var) * (base_var + var) / d;
+
+        half_width = student_t_975(dof) * sqrt(base_var + var);
+    }
+
+    const double diff = mean - base_mean;
+
+    comparison.m_ratio = 1.0 + diff / base_mean;
+    comparison.m_ratio_low = 1.0 + (diff - half_width) / base_mean;
+    comparison.m_ratio_high = 1.0 + (diff + half_width) / base_mean;
+
+    return comparison;
+}
+
+
+//
+// RegressionBenchmarkListener class implementation.
+//
+
+struct RegressionBenchmarkListener::Impl
+{
+    Logger&                     m_logger;
+    const BenchmarkBaseline&    m_baseline;
+    double                      m_threshold;
+    size_t                      m_comparison_count;
+    size_t                      m_regression_count;
+
+    Impl(
+        Logger&                     logger,
+        const BenchmarkBaseline&    baseline,
+        const double                threshold)
+      : m_logger(logger)
+      , m_baseline(baseline)
+      , m_threshold(threshold)
+      , m_comparison_count(0)
+      , m_regression_count(0)
+    {
+    }
+};
+
+RegressionBenchmarkListener::RegressionBenchmarkListener(
+    Logger&                     logger,
+    const BenchmarkBaseline&    baseline,
+    const double                threshold)
+  : impl(new Impl(logger, baseline, threshold))
+{
+}
+
+RegressionBenchmarkListener::~RegressionBenchmarkListener()
+{
+    delete impl;
+}
+
+void RegressionBenchmarkListener::release()
+{
+    delete this;
+}
+
+void RegressionBenchmarkListener::write(
+    const BenchmarkSuite&   benchmark_suite,
+    const IBenchmarkCase&   benchmark_case,
+    const char*             file,
+    const size_t            line,
+    const TimingResult&     timing_result)
+{
+    const TimingResult* baseline =
+        impl->m_baseline.get(
+            benchmark_suite.get_name(),
+            benchmark_case.get_name());
+
+    if (baseline == 0)
+        return;
+
+    const TimingComparison comparison = compare_timing_results(*baseline, timing_result);
+
+    ++impl->m_comparison_count;
+
+    if (!comparison.m_conclusive)
+    {
+        LOG_WARNING(
+            impl->m_logger,
+            "%s::%s: running time %s, inconclusive (too few measurements).\n",
+            benchmark_suite.get_name(),
+            benchmark_case.get_name(),
+            pretty_change(comparison.m_ratio).c_str());
+    }
+    else if (comparison.m_ratio_low > 1.0 + impl->m_threshold)
+    {
+        ++impl->m_regression_count;
+
+        LOG_ERROR(
+            impl->m_logger,
+            "%s::%s regressed: running time %s (95%% confidence interval: %s to %s).\n",
+            benchmark_suite.get_name(),
+            benchmark_case.get_name(),
+            pretty_change(comparison.m_ratio).c_str(),
+            pretty_change(comparison.m_ratio_low).c_str(),
+            pretty_change(comparison.m_ratio_high).c_str());
+    }
+    else
+    {
+        LOG_INFO(
+            impl->m_logger,
+            "%s::%s: running time %s (95%% confidence interval: %s to %s).\n",
+            benchmark_suite.get_name(),
+            benchmark_case.get_name(),
+            pretty_change(comparison.m_ratio).c_str(),
+            pretty_change(comparison.m_ratio_low).c_str(),
+            pretty_change(comparison.m_ratio_high).c_str());
+    }
+}
+
+size_t RegressionBenchmarkListener::get_comparison_count() const
+{
+    return impl->m_comparison_count;
+}
+
+size_t RegressionBenchmarkListener::get_regression_count() const
+{
+    return impl->m_regression_count;
+}
+
+RegressionBenchmarkListener* create_regression_benchmark_listener(
+    Logger&                     logger,
+    const BenchmarkBaseline&    baseline,
+    const double                threshold)
+{
+    return new RegressionBenchmarkListener(logger, baseline, threshold);
+}
+
+}   // namespace foundation
@@ -0,0 +1,145 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_BENCHMARK_REGRESSIONBENCHMARKLISTENER_H
+#define APPLESEED_FOUNDATION_UTILITY_BENCHMARK_REGRESSIONBENCHMARKLISTENER_H
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark/benchmarklistenerbase.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class BenchmarkBaseline; }
+namespace foundation    { class BenchmarkSuite; }
+namespace foundation    { class IBenchmarkCase; }
+namespace foundation    { class Logger; }
+namespace foundation    { class TimingResult; }
+
+//
+// On Windows, define FOUNDATIONDLL to __declspec(dllexport) when building the DLL
+// and to __declspec(dllimport) when building an application using the DLL.
+// Other platforms don't use this export mechanism and the symbol FOUNDATIONDLL is
+// defined to evaluate to nothing.
+//
+
+#ifndef FOUNDATIONDLL
+#ifdef _WIN32
+#ifdef APPLESEED_FOUNDATION_EXPORTS
+#define FOUNDATIONDLL __declspec(dllexport)
+#else
+#define FOUNDATIONDLL __declspec(dllimport)
+#endif
+#else
+#define FOUNDATIONDLL
+#endif
+#endif
+
+namespace foundation
+{
+
+//
+// Comparison of the running time of a benchmark case against a baseline.
+//
+
+class TimingComparison
+{
+  public:
+    double  m_ratio;                // ratio of the mean running time to the baseline one
+    double  m_ratio_low;            // lower bound of the 95% confidence interval of the ratio
+    double  m_ratio_high;           // upper bound of the 95% confidence interval of the ratio
+    bool    m_conclusive;           // false if there are too few measurements to build the interval
+};
+
+// Compare the mean running times of two timing results of the same benchmark case.
+// The confidence interval is derived from Welch's t-test, treating each measurement
+// as an independent sample. Cases with fewer than two measurements on either side
+// are inconclusive. If the baseline has no running time statistics, the lowest
+// running times are compared instead, as exact values.
+FOUNDATIONDLL TimingComparison compare_timing_results(
+    const TimingResult&     baseline,
+    const TimingResult&     timing_result);
+
+
+//
+// A benchmark listener that compares timing results against a baseline and reports
+// the benchmark cases whose running time increased beyond a given threshold with
+// 95% confidence.
+//
+
+class FOUNDATIONDLL RegressionBenchmarkListener
+  : public BenchmarkListenerBase
+{
+  public:
+    // Delete this instance.
+    virtual void release();
+
+    // Write a timing result.
+    virtual void write(
+        const BenchmarkSuite&   benchmark_suite,
+        const IBenchmarkCase&   benchmark_case,
+        const char*             file,
+        const size_t            line,
+        const TimingResult&     timing_result);
+
+    // Return the number of benchmark cases that were compared against the baseline.
+    size_t get_comparison_count() const;
+
+    // Return the number of benchmark cases that regressed.
+    size_t get_regression_count() const;
+
+  private:
+    friend FOUNDATIONDLL RegressionBenchmarkListener* create_regression_benchmark_listener(
+        Logger&                     logger,
+        const BenchmarkBaseline&    baseline,
+        const double                threshold);
+
+    struct Impl;
+    Impl* impl;
+
+    // Constructor.
+    RegressionBenchmarkListener(
+        Logger&                     logger,
+        const BenchmarkBaseline&    baseline,
+        const double                threshold);
+
+    // Destructor.
+    ~RegressionBenchmarkListener();
+};
+
+// Create an instance of a benchmark listener that detects regressions. The threshold
+// is the tolerated relative increase of the running time, e.g. 0.05 for 5%.
+FOUNDATIONDLL RegressionBenchmarkListener* create_regression_benchmark_listener(
+    Logger&                     logger,
+    const BenchmarkBaseline&    baseline,
+    const double                threshold);
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_BENCHMARK_REGRESSIONBENCHMARKLISTENER_H
@@ -46,6 +46,8 @@ class TimingResult
     size_t  m_measurement_count;    // number of measurements per benchmark case
     double  m_frequency;            // frequency of the timer used for the measurement
     double  m_ticks;                // average running time, in timer ticks
+    double  m_mean_ticks;           // mean running time over all measurements, in timer ticks, negative if not recorded
+    double  m_dev_ticks;            // standard deviation of the running time over all measurements, in timer ticks
 };
 
 }       // namespace foundation
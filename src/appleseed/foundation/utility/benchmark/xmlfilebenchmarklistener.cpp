@@ -181,6 +181,16 @@ void XMLFileBenchmarkListener::write(
         impl->m_indenter.c_str(),
         timing_result.m_ticks);
 
+    fprintf(impl->m_file,
+        "%s<meanticks>%f</meanticks>\n",
+        impl->m_indenter.c_str(),
+        timing_result.m_mean_ticks);
+
+    fprintf(impl->m_file,
+        "%s<devticks>%f</devticks>\n",
+        impl->m_indenter.c_str(),
+        timing_result.m_dev_ticks);
+
     --impl->m_indenter;
 
     fprintf(impl->m_file, "%s</results>\n", impl->m_indenter.c_str());
@@ -0,0 +1,203 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_CONTAINERS_MAPPABLEVECTOR_H
+#define APPLESEED_FOUNDATION_UTILITY_CONTAINERS_MAPPABLEVECTOR_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// A vector that either owns its elements, or refers read-only to elements
+// stored elsewhere, for instance in a memory-mapped file. Modifying a vector
+// that refers to external elements first copies them into owned storage.
+//
+
+template <typename T>
+class MappableVector
+  : public NonCopyable
+{
+  public:
+    // Value type.
+    typedef T value_type;
+
+    // Constructor.
+    MappableVector();
+
+    // Remove all elements. The vector owns its elements again after this call.
+    void clear();
+
+    // Make the vector refer to an external array of elements. The array must
+    // remain valid for the lifetime of the vector or until clear() is called.
+    void map(const T* elements, const size_t size);
+
+    // Return true if the vector refers to an external array of elements.
+    bool is_mapped() const;
+
+    // Reserve memory for a given number of owned elements.
+    // External elements are copied into owned storage first.
+    void reserve(const size_t capacity);
+
+    // Append an element to the vector.
+    // External elements are copied into owned storage first.
+    void push_back(const T& element);
+
+    // Return the number of elements in the vector.
+    size_t size() const;
+
+    // Return true if the vector is empty.
+    bool empty() const;
+
+    // Return the number of elements the vector can hold without reallocating
+    // (owned elements) or the number of elements of the external array.
+    size_t capacity() const;
+
+    // Access a given element.
+    const T& operator[](const size_t index) const;
+
+  private:
+    std::vector<T>  m_storage;
+    const T*        m_elements;
+    size_t          m_size;
+    bool            m_mapped;
+
+    void make_owned();
+    void update_view();
+};
+
+
+//
+// MappableVector class implementation.
+//
+
+template <typename T>
+MappableVector<T>::MappableVector()
+  : m_elements(0)
+  , m_size(0)
+  , m_mapped(false)
+{
+}
+
+template <typename T>
+void MappableVector<T>::clear()
+{
+    m_storage.clear();
+    m_mapped = false;
+    update_view();
+}
+
+template <typename T>
+void MappableVector<T>::map(const T* elements, const size_t size)
+{
+    assert(elements || size == 0);
+
+    std::vector<T>().swap(m_storage);
+
+    m_elements = elements;
+    m_size = size;
+    m_mapped = true;
+}
+
+template <typename T>
+inline bool MappableVector<T>::is_mapped() const
+{
+    return m_mapped;
+}
+
+template <typename T>
+void MappableVector<T>::reserve(const size_t capacity)
+{
+    make_owned();
+
+    m_storage.reserve(capacity);
+    update_view();
+}
+
+template <typename T>
+inline void MappableVector<T>::push_back(const T& element)
+{
+    if (m_mapped)
+        make_owned();
+
+    m_storage.push_back(element);
+    update_view();
+}
+
+template <typename T>
+inline size_t MappableVector<T>::size() const
+{
+    return m_size;
+}
+
+template <typename T>
+inline bool MappableVector<T>::empty() const
+{
+    return m_size == 0;
+}
+
+template <typename T>
+inline size_t MappableVector<T>::capacity() const
+{
+    return m_mapped ? m_size : m_storage.capacity();
+}
+
+template <typename T>
+inline const T& MappableVector<T>::operator[](const size_t index) const
+{
+    assert(index < m_size);
+    return m_elements[index];
+}
+
+template <typename T>
+void MappableVector<T>::make_owned()
+{
+    if (m_mapped)
+    {
+        m_storage.assign(m_elements, m_elements + m_size);
+        m_mapped = false;
+    }
+}
+
+template <typename T>
+inline void MappableVector<T>::update_view()
+{
+    m_elements = m_storage.empty() ? 0 : &m_storage[0];
+    m_size = m_storage.size();
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_CONTAINERS_MAPPABLEVECTOR_H
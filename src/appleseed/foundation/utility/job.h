@@ -34,5 +34,6 @@
 #include "foundation/utility/job/ijob.h"
 #include "foundation/utility/job/jobmanager.h"
 #include "foundation/utility/job/jobqueue.h"
+#include "foundation/utility/job/threadbudget.h"
 
 #endif  // !APPLESEED_FOUNDATION_UTILITY_JOB_H
@@ -30,6 +30,7 @@
 #include "jobmanager.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/system.h"
 #include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/job/workerthread.h"
 #include "foundation/utility/foreach.h"
@@ -49,6 +50,50 @@ namespace foundation
 // JobManager class implementation.
 //
 
+namespace
+{
+    // Compute the order in which worker threads are assigned to logical CPU cores.
+    void compute_cpu_order(
+        const JobManager::ThreadAffinity    affinity,
+        vector<size_t>&                     cpus)
+    {
+        const size_t node_count = System::get_numa_node_count();
+
+        vector<vector<size_t> > node_cpus(node_count);
+        for (size_t i = 0; i < node_count; ++i)
+            System::get_numa_node_cpus(i, node_cpus[i]);
+
+        cpus.clear();
+
+        if (affinity == JobManager::AffinityCompact)
+        {
+            // All cores of the first node, then all cores of the second node, etc.
+            for (size_t i = 0; i < node_count; ++i)
+                cpus.insert(cpus.end(), node_cpus[i].begin(), node_cpus[i].end());
+        }
+        else
+        {
+            // The first core of each node, then the second core of each node, etc.
+            for (size_t j = 0; ; ++j)
+            {
+                bool found = false;
+
+                for (size_t i = 0; i < node_count; ++i)
+                {
+                    if (j < node_cpus[i].size())
+                    {
+                        cpus.push_back(node_cpus[i][j]);
+                        found = true;
+                    }
+                }
+
+                if (!found)
+                    break;
+            }
+        }
+    }
+}
+
 struct JobManager::Impl
 {
     typedef vector<WorkerThread*> WorkerThreads;
@@ -57,6 +102,7 @@ struct JobManager::Impl
     JobQueue&           m_job_queue;
     size_t              m_thread_count;
     const bool          m_keep_running;
+    ThreadAffinity      m_thread_affinity;
     WorkerThreads       m_worker_threads;
 
     // Constructor.
@@ -69,6 +115,7 @@ struct JobManager::Impl
       , m_job_queue(job_queue)
       , m_thread_count(thread_count)
       , m_keep_running(keep_running)
+      , m_thread_affinity(AffinityNone)
     {
     }
 };
@@ -99,6 +146,11 @@ size_t JobManager::get_thread_count() const
     return impl->m_thread_count;
 }
 
+void JobManager::set_thread_affinity(const ThreadAffinity affinity)
+{
+    impl->m_thread_affinity = affinity;
+}
+
 void JobManager::start()
 {
     assert(impl->m_worker_threads.empty() ||
@@ -107,6 +159,10 @@ void JobManager::start()
     // Create the worker threads if they don't already exist.
     if (impl->m_worker_threads.empty())
     {
+        vector<size_t> cpus;
+        if (impl->m_thread_affinity != AffinityNone)
+            compute_cpu_order(impl->m_thread_affinity, cpus);
+
         for (size_t i = 0; i < impl->m_thread_count; ++i)
         {
             impl->m_worker_threads.push_back(
@@ -114,7 +170,8 @@ void JobManager::start()
                     i,
                     impl->m_logger,
                     impl->m_job_queue,
-                    impl->m_keep_running));
+                    impl->m_keep_running,
+                    cpus.empty() ? ~0 : cpus[i % cpus.size()]));
         }
     }
 
@@ -71,6 +71,14 @@ class FOUNDATIONDLL JobManager
   : public NonCopyable
 {
   public:
+    // Policies for binding worker threads to logical CPU cores.
+    enum ThreadAffinity
+    {
+        AffinityNone,                               // let the operating system schedule worker threads
+        AffinityCompact,                            // fill NUMA nodes one after the other
+        AffinityScatter                             // spread worker threads evenly across NUMA nodes
+    };
+
     // Constructor.
     JobManager(
         Logger&         logger,
@@ -84,6 +92,10 @@ class FOUNDATIONDLL JobManager
     // Return the number of worker threads.
     size_t get_thread_count() const;
 
+    // Set the policy for binding worker threads to CPU cores.
+    // Takes effect the next time worker threads are created.
+    void set_thread_affinity(const ThreadAffinity affinity);
+
     // Start job execution. Returns immediately.
     void start();
 
@@ -30,15 +30,21 @@
 #include "jobqueue.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/rng.h"
+#include "foundation/platform/atomic.h"
 #include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/job/abortswitch.h"
 #include "foundation/utility/job/ijob.h"
-#include "foundation/utility/foreach.h"
-#include "foundation/utility/iterators.h"
+
+// boost headers.
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/tss.hpp"
 
 // Standard headers.
 #include <cassert>
+#include <deque>
 
-using namespace boost;
 using namespace std;
 
 namespace foundation
@@ -48,21 +54,196 @@ namespace foundation
 // JobQueue class implementation.
 //
 
+namespace
+{
+    // Maximum number of worker deques. Worker threads with larger indices share deques.
+    const size_t MaxWorkerDequeCount = 256;
+
+    // Index of the deque holding jobs scheduled from outside of the worker threads.
+    const size_t SharedDequeIndex = MaxWorkerDequeCount;
+
+    // Returned in place of a deque index when no job could be found.
+    const size_t InvalidDequeIndex = ~size_t(0);
+}
+
 struct JobQueue::Impl
 {
-    mutable Spinlock    m_spinlock;
-    JobList             m_scheduled_jobs;
-    JobList             m_running_jobs;
+    typedef deque<JobInfo> JobDeque;
 
-    static void delete_jobs(JobList& list)
+    struct WorkerDeque
     {
-        for (each<JobList> i = list; i; ++i)
+        Spinlock        m_spinlock;
+        JobDeque        m_jobs;
+        size_t          m_index;
+        Xorshift        m_rng;              // used by the owning worker thread to pick victims
+
+        explicit WorkerDeque(const size_t index)
+          : m_index(index)
+          , m_rng(static_cast<uint32>(index) * 2654435761UL + 1)
+        {
+        }
+    };
+
+    // Worker deques are created on demand and only deleted with the queue,
+    // so that other threads can steal from them without taking m_mutex.
+    WorkerDeque* volatile               m_worker_deques[MaxWorkerDequeCount];
+    volatile uint32                     m_worker_deque_count;
+    WorkerDeque                         m_shared_deque;
+
+    // Deque of the worker thread bound to the calling thread, if any.
+    boost::thread_specific_ptr<WorkerDeque> m_current_deque;
+
+    volatile uint32                     m_scheduled_job_count;
+    volatile uint32                     m_running_job_count;
+    volatile uint32                     m_pending_job_count;    // scheduled or running jobs
+    volatile uint32                     m_sleeping_thread_count;
+
+    boost::mutex                        m_mutex;
+    boost::condition_variable           m_job_scheduled;
+    boost::condition_variable           m_queue_idle;
+
+    Impl()
+      : m_worker_deque_count(0)
+      , m_shared_deque(SharedDequeIndex)
+      , m_current_deque(&do_not_delete)
+      , m_scheduled_job_count(0)
+      , m_running_job_count(0)
+      , m_pending_job_count(0)
+      , m_sleeping_thread_count(0)
+    {
+        for (size_t i = 0; i < MaxWorkerDequeCount; ++i)
+            m_worker_deques[i] = 0;
+    }
+
+    ~Impl()
+    {
+        for (size_t i = 0; i < MaxWorkerDequeCount; ++i)
+            delete m_worker_deques[i];
+    }
+
+    // Worker deques are owned by the queue, not by the threads bound to them.
+    static void do_not_delete(WorkerDeque*)
+    {
+    }
+
+    static void delete_jobs(JobDeque& jobs)
+    {
+        for (JobDeque::iterator i = jobs.begin(), e = jobs.end(); i != e; ++i)
         {
             if (i->m_owned)
                 delete i->m_job;
         }
- 
-        list.clear();
+
+        jobs.clear();
+    }
+
+    // Delete the scheduled jobs of a deque and return how many there were.
+    static size_t clear_deque(WorkerDeque& deque)
+    {
+        JobDeque jobs;
+
+        {
+            Spinlock::ScopedLock lock(deque.m_spinlock);
+            jobs.swap(deque.m_jobs);
+        }
+
+        const size_t job_count = jobs.size();
+        delete_jobs(jobs);
+
+        return job_count;
+    }
+
+    // Return the deque of a given worker thread, creating it if necessary.
+    WorkerDeque* get_worker_deque(const size_t thread_index)
+    {
+        const size_t index = thread_index % MaxWorkerDequeCount;
+
+        WorkerDeque* deque = atomic_read(&m_worker_deques[index]);
+
+        if (deque == 0)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            deque = m_worker_deques[index];
+
+            if (deque == 0)
+            {
+                deque = new WorkerDeque(index);
+                atomic_write(&m_worker_deques[index], deque);
+
+                if (index >= m_worker_deque_count)
+                    atomic_write(&m_worker_deque_count, static_cast<uint32>(index + 1));
+            }
+        }
+
+        return deque;
+    }
+
+    static bool pop_back(WorkerDeque& deque, JobInfo& job_info)
+    {
+        Spinlock::ScopedLock lock(deque.m_spinlock);
+
+        if (deque.m_jobs.empty())
+            return false;
+
+        job_info = deque.m_jobs.back();
+        deque.m_jobs.pop_back();
+
+        return true;
+    }
+
+    static bool pop_front(WorkerDeque& deque, JobInfo& job_info)
+    {
+        Spinlock::ScopedLock lock(deque.m_spinlock);
+
+        if (deque.m_jobs.empty())
+            return false;
+
+        job_info = deque.m_jobs.front();
+        deque.m_jobs.pop_front();
+
+        return true;
+    }
+
+    // Take a scheduled job out of the deques. Return the index of the deque
+    // the job was taken from, or InvalidDequeIndex if all deques were found empty.
+    size_t take_job(JobInfo& job_info)
+    {
+        WorkerDeque* own_deque = m_current_deque.get();
+
+        // Newest job of our own deque.
+        if (own_deque && pop_back(*own_deque, job_info))
+            return own_deque->m_index;
+
+        // Oldest job scheduled from outside of the worker threads.
+        if (pop_front(m_shared_deque, job_info))
+            return SharedDequeIndex;
+
+        // Oldest job of another worker thread, starting at a random victim.
+        const size_t deque_count = atomic_read(&m_worker_deque_count);
+
+        if (deque_count > 0)
+        {
+            const size_t start =
+                own_deque ? own_deque->m_rng.rand_uint32() % deque_count : 0;
+
+            for (size_t i = 0; i < deque_count; ++i)
+            {
+                const size_t index = (start + i) % deque_count;
+                WorkerDeque* victim = atomic_read(&m_worker_deques[index]);
+
+                if (victim && victim != own_deque && pop_front(*victim, job_info))
+                    return index;
+            }
+        }
+
+        return InvalidDequeIndex;
+    }
+
+    void notify_queue_idle()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_queue_idle.notify_all();
     }
 };
 
@@ -76,117 +257,167 @@ JobQueue::~JobQueue()
     // We assume that worker threads are not running, so we don't lock.
 
     // At this point, no job must be running.
-    assert(impl->m_running_jobs.empty());
+    assert(impl->m_running_job_count == 0);
+    assert(impl->m_pending_job_count == impl->m_scheduled_job_count);
 
     // Delete all scheduled jobs that the queue owns.
-    Impl::delete_jobs(impl->m_scheduled_jobs);
+    Impl::delete_jobs(impl->m_shared_deque.m_jobs);
+    for (size_t i = 0; i < MaxWorkerDequeCount; ++i)
+    {
+        if (impl->m_worker_deques[i])
+            Impl::delete_jobs(impl->m_worker_deques[i]->m_jobs);
+    }
 
     delete impl;
 }
 
 void JobQueue::clear_scheduled_jobs()
 {
-    Spinlock::ScopedLock lock(impl->m_spinlock);
+    size_t job_count = Impl::clear_deque(impl->m_shared_deque);
+
+    const size_t deque_count = atomic_read(&impl->m_worker_deque_count);
+    for (size_t i = 0; i < deque_count; ++i)
+    {
+        Impl::WorkerDeque* deque = atomic_read(&impl->m_worker_deques[i]);
 
-    impl->delete_jobs(impl->m_scheduled_jobs);
+        if (deque)
+            job_count += Impl::clear_deque(*deque);
+    }
+
+    if (job_count > 0)
+    {
+        atomic_add(&impl->m_scheduled_job_count, static_cast<uint32>(0 - job_count));
+
+        if (atomic_add(&impl->m_pending_job_count, static_cast<uint32>(0 - job_count)) == 0)
+            impl->notify_queue_idle();
+    }
 }
 
 bool JobQueue::has_scheduled_jobs() const
 {
-    Spinlock::ScopedLock lock(impl->m_spinlock);
-
-    return !impl->m_scheduled_jobs.empty();
+    return get_scheduled_job_count() > 0;
 }
 
 bool JobQueue::has_running_jobs() const
 {
-    Spinlock::ScopedLock lock(impl->m_spinlock);
-
-    return !impl->m_running_jobs.empty();
+    return get_running_job_count() > 0;
 }
 
 bool JobQueue::has_scheduled_or_running_jobs() const
 {
-    Spinlock::ScopedLock lock(impl->m_spinlock);
-
-    return !impl->m_scheduled_jobs.empty() || !impl->m_running_jobs.empty();
+    return get_total_job_count() > 0;
 }
 
 size_t JobQueue::get_scheduled_job_count() const
 {
-    Spinlock::ScopedLock lock(impl->m_spinlock);
-
-    return impl->m_scheduled_jobs.size();
+    return atomic_read(&impl->m_scheduled_job_count);
 }
 
 size_t JobQueue::get_running_job_count() const
 {
-    Spinlock::ScopedLock lock(impl->m_spinlock);
-
-    return impl->m_running_jobs.size();
+    return atomic_read(&impl->m_running_job_count);
 }
 
 size_t JobQueue::get_total_job_count() const
 {
-    Spinlock::ScopedLock lock(impl->m_spinlock);
-
-    return impl->m_scheduled_jobs.size() + impl->m_running_jobs.size();
+    // Summing the scheduled and running counts would race with jobs changing state
+    // or scheduling child jobs between the two reads, so a single counter is kept.
+    return atomic_read(&impl->m_pending_job_count);
 }
 
 void JobQueue::schedule(IJob* job, const bool transfer_ownership)
 {
     assert(job);
 
-    Spinlock::ScopedLock lock(impl->m_spinlock);
+    // Count the job before publishing it, so that the counts never go negative.
+    atomic_inc(&impl->m_pending_job_count);
+    atomic_inc(&impl->m_scheduled_job_count);
+
+    // Jobs scheduled by a worker thread go to its own deque.
+    Impl::WorkerDeque* deque = impl->m_current_deque.get();
+    if (deque == 0)
+        deque = &impl->m_shared_deque;
+
+    {
+        Spinlock::ScopedLock lock(deque->m_spinlock);
+        deque->m_jobs.push_back(JobInfo(job, transfer_ownership));
+    }
 
-    impl->m_scheduled_jobs.push_back(JobInfo(job, transfer_ownership));
+    // Wake up a sleeping worker thread, if any.
+    if (atomic_read(&impl->m_sleeping_thread_count) > 0)
+    {
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+        impl->m_job_scheduled.notify_one();
+    }
 }
 
 void JobQueue::wait_until_completion()
 {
-    while (true)
-    {
-        if (impl->m_spinlock.try_lock())
-        {
-            if (impl->m_scheduled_jobs.empty() && impl->m_running_jobs.empty())
-            {
-                impl->m_spinlock.unlock();
-                return;
-            }
+    boost::mutex::scoped_lock lock(impl->m_mutex);
 
-            impl->m_spinlock.unlock();
-        }
+    while (get_total_job_count() > 0)
+        impl->m_queue_idle.wait(lock);
+}
 
-        yield();
-    }
+void JobQueue::bind_worker_thread(const size_t thread_index)
+{
+    impl->m_current_deque.reset(impl->get_worker_deque(thread_index));
 }
 
-JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job()
+void JobQueue::unbind_worker_thread()
 {
-    Spinlock::ScopedLock lock(impl->m_spinlock);
+    impl->m_current_deque.reset(0);
+}
 
+JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job()
+{
     // Bail out if there is no scheduled job.
-    if (impl->m_scheduled_jobs.empty())
-        return RunningJobInfo(JobInfo(0, false), impl->m_running_jobs.end());
+    if (atomic_read(&impl->m_scheduled_job_count) == 0)
+        return RunningJobInfo(JobInfo(0, false), InvalidDequeIndex);
 
-    // Move the next scheduled job to the end of the queue of running jobs.
-    const JobInfo job_info = impl->m_scheduled_jobs.front();
-    impl->m_scheduled_jobs.pop_front();
-    impl->m_running_jobs.push_back(job_info);
+    JobInfo job_info(0, false);
+    const size_t deque_index = impl->take_job(job_info);
 
-    return RunningJobInfo(job_info, pred(impl->m_running_jobs.end()));
+    if (deque_index == InvalidDequeIndex)
+        return RunningJobInfo(job_info, deque_index);
+
+    // Change the state of the job from 'scheduled' to 'running'.
+    atomic_inc(&impl->m_running_job_count);
+    atomic_dec(&impl->m_scheduled_job_count);
+
+    return RunningJobInfo(job_info, deque_index);
 }
 
 void JobQueue::retire_running_job(const RunningJobInfo& running_job_info)
 {
-    // Remove the job from the running list.
-    impl->m_spinlock.lock();
-    impl->m_running_jobs.erase(running_job_info.second);
-    impl->m_spinlock.unlock();
-
     // Delete the job.
     if (running_job_info.first.m_owned)
         delete running_job_info.first.m_job;
+
+    atomic_dec(&impl->m_running_job_count);
+
+    // Wake up threads waiting for completion when the last pending job is retired.
+    // Jobs scheduled by this job were counted before it got here.
+    if (atomic_dec(&impl->m_pending_job_count) == 0)
+        impl->notify_queue_idle();
+}
+
+void JobQueue::wait_for_scheduled_job(AbortSwitch& abort_switch)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    atomic_inc(&impl->m_sleeping_thread_count);
+
+    while (atomic_read(&impl->m_scheduled_job_count) == 0 && !abort_switch.is_aborted())
+        impl->m_job_scheduled.wait(lock);
+
+    atomic_dec(&impl->m_sleeping_thread_count);
+}
+
+void JobQueue::wake_worker_threads()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->m_job_scheduled.notify_all();
 }
 
 }   // namespace foundation
@@ -31,14 +31,14 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
-#include "foundation/utility/poolallocator.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
 #include <cstddef>
-#include <list>
+#include <utility>
 
 // Forward declarations.
+namespace foundation    { class AbortSwitch; }
 namespace foundation    { class IJob; }
 
 // Unit test case declarations.
@@ -80,6 +80,13 @@ namespace foundation
 //   - scheduled: the job was inserted into the job queue, but hasn't yet been executed
 //   - running: the job is currently being executed
 //
+// Scheduled jobs are distributed over a set of deques: one per worker thread, plus
+// one for jobs scheduled from outside of the worker threads. A worker thread takes
+// jobs from the back of its own deque, then from the front of the shared deque,
+// and finally steals jobs from the front of the deque of another worker thread
+// chosen at random. Worker threads that find no job to execute sleep until a job
+// is scheduled instead of polling the queue.
+//
 
 class FOUNDATIONDLL JobQueue
   : public NonCopyable
@@ -134,7 +141,7 @@ class FOUNDATIONDLL JobQueue
     struct JobInfo
     {
         IJob*       m_job;
-        const bool  m_owned;
+        bool        m_owned;
 
         JobInfo(IJob* job, const bool owned)
           : m_job(job)
@@ -143,15 +150,24 @@ class FOUNDATIONDLL JobQueue
         }
     };
 
-    typedef std::list<JobInfo, PoolAllocator<JobInfo, 64> > JobList;
+    // A running job and the index of the deque it was taken from.
+    typedef std::pair<JobInfo, size_t> RunningJobInfo;
 
-    typedef std::pair<JobInfo, JobList::iterator> RunningJobInfo;
+    // Bind the calling thread to the deque of a given worker thread, or unbind it.
+    void bind_worker_thread(const size_t thread_index);
+    void unbind_worker_thread();
 
     // Acquire a scheduled job and change its state from 'scheduled' to 'running'.
     RunningJobInfo acquire_scheduled_job();
 
     // Retire a running job. The job is deleted if it is owned by the queue.
     void retire_running_job(const RunningJobInfo& running_job_info);
+
+    // Block until a job is scheduled or the abort switch is set.
+    void wait_for_scheduled_job(AbortSwitch& abort_switch);
+
+    // Wake up all worker threads blocked in wait_for_scheduled_job().
+    void wake_worker_threads();
 };
 
 }       // namespace foundation
@@ -0,0 +1,102 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "threadbudget.h"
+
+// boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// ThreadBudget class implementation.
+//
+
+struct ThreadBudget::Impl
+{
+    const size_t            m_thread_count;
+    mutable boost::mutex    m_mutex;
+    size_t                  m_available_thread_count;
+
+    explicit Impl(const size_t thread_count)
+      : m_thread_count(thread_count)
+      , m_available_thread_count(thread_count)
+    {
+    }
+};
+
+ThreadBudget::ThreadBudget(const size_t thread_count)
+  : impl(new Impl(thread_count))
+{
+}
+
+ThreadBudget::~ThreadBudget()
+{
+    assert(impl->m_available_thread_count == impl->m_thread_count);
+
+    delete impl;
+}
+
+size_t ThreadBudget::get_thread_count() const
+{
+    return impl->m_thread_count;
+}
+
+size_t ThreadBudget::get_available_thread_count() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    return impl->m_available_thread_count;
+}
+
+size_t ThreadBudget::acquire(const size_t max_thread_count)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    const size_t thread_count = min(max_thread_count, impl->m_available_thread_count);
+    impl->m_available_thread_count -= thread_count;
+
+    return thread_count;
+}
+
+void ThreadBudget::release(const size_t thread_count)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    impl->m_available_thread_count += thread_count;
+    assert(impl->m_available_thread_count <= impl->m_thread_count);
+}
+
+}   // namespace foundation
@@ -0,0 +1,146 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_JOB_THREADBUDGET_H
+#define APPLESEED_FOUNDATION_UTILITY_JOB_THREADBUDGET_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+
+//
+// On Windows, define FOUNDATIONDLL to __declspec(dllexport) when building the DLL
+// and to __declspec(dllimport) when building an application using the DLL.
+// Other platforms don't use this export mechanism and the symbol FOUNDATIONDLL is
+// defined to evaluate to nothing.
+//
+
+#ifndef FOUNDATIONDLL
+#ifdef _WIN32
+#ifdef APPLESEED_FOUNDATION_EXPORTS
+#define FOUNDATIONDLL __declspec(dllexport)
+#else
+#define FOUNDATIONDLL __declspec(dllimport)
+#endif
+#else
+#define FOUNDATIONDLL
+#endif
+#endif
+
+namespace foundation
+{
+
+//
+// A pool of threads shared by several concurrent, independently started
+// computations, so that together they don't start more threads than the
+// machine has cores.
+//
+// This class is thread-safe.
+//
+
+class FOUNDATIONDLL ThreadBudget
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    explicit ThreadBudget(const size_t thread_count);
+
+    // Destructor.
+    ~ThreadBudget();
+
+    // Return the total number of threads of the budget.
+    size_t get_thread_count() const;
+
+    // Return the number of threads not currently acquired.
+    size_t get_available_thread_count() const;
+
+    // Acquire up to max_thread_count threads. Never blocks.
+    // Return the number of threads actually acquired, possibly zero.
+    size_t acquire(const size_t max_thread_count);
+
+    // Return threads previously acquired with acquire().
+    void release(const size_t thread_count);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+
+//
+// Acquire threads from a thread budget and release them on destruction.
+//
+
+class ThreadBudgetReservation
+  : public NonCopyable
+{
+  public:
+    // Constructor, acquires up to max_thread_count threads.
+    ThreadBudgetReservation(
+        ThreadBudget&   budget,
+        const size_t    max_thread_count);
+
+    // Destructor, releases the acquired threads.
+    ~ThreadBudgetReservation();
+
+    // Return the number of threads actually acquired.
+    size_t get_thread_count() const;
+
+  private:
+    ThreadBudget&       m_budget;
+    const size_t        m_thread_count;
+};
+
+
+//
+// ThreadBudgetReservation class implementation.
+//
+
+inline ThreadBudgetReservation::ThreadBudgetReservation(
+    ThreadBudget&       budget,
+    const size_t        max_thread_count)
+  : m_budget(budget)
+  , m_thread_count(budget.acquire(max_thread_count))
+{
+}
+
+inline ThreadBudgetReservation::~ThreadBudgetReservation()
+{
+    m_budget.release(m_thread_count);
+}
+
+inline size_t ThreadBudgetReservation::get_thread_count() const
+{
+    return m_thread_count;
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_JOB_THREADBUDGET_H
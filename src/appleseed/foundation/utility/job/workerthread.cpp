@@ -55,11 +55,13 @@ WorkerThread::WorkerThread(
     const size_t    thread_index,
     Logger&         logger,
     JobQueue&       job_queue,
-    const bool      keep_running)
+    const bool      keep_running,
+    const size_t    cpu)
   : m_thread_index(thread_index)
   , m_logger(logger)
   , m_job_queue(job_queue)
   , m_keep_running(keep_running)
+  , m_cpu(cpu)
   , m_thread_func(*this)
   , m_thread(0)
 {
@@ -87,6 +89,7 @@ void WorkerThread::stop()
         return;
 
     m_abort_switch.abort();
+    m_job_queue.wake_worker_threads();
     m_thread->join();
 
     delete m_thread;
@@ -95,6 +98,20 @@ void WorkerThread::stop()
 
 void WorkerThread::run()
 {
+    // Bind this thread to its CPU core before it allocates anything, so that memory
+    // first touched by this thread gets allocated on the NUMA node of that core.
+    if (m_cpu != size_t(~0) && !set_current_thread_cpu_affinity(m_cpu))
+    {
+        LOG_WARNING(
+            m_logger,
+            "worker thread " FMT_SIZE_T ": failed to bind to cpu " FMT_SIZE_T ".",
+            m_thread_index,
+            m_cpu);
+    }
+
+    // Jobs scheduled from this thread will go to its own deque.
+    m_job_queue.bind_worker_thread(m_thread_index);
+
     while (!m_abort_switch.is_aborted())
     {
         // Acquire a job.
@@ -106,8 +123,8 @@ void WorkerThread::run()
         {
             if (m_keep_running)
             {
-                // Give up time slice.
-                yield();
+                // Sleep until a job is scheduled or the thread is stopped.
+                m_job_queue.wait_for_scheduled_job(m_abort_switch);
 
                 // Keep the thread running and checking for new jobs.
                 continue;
@@ -125,6 +142,8 @@ void WorkerThread::run()
         // Retire the job.
         m_job_queue.retire_running_job(running_job_info);
     }
+
+    m_job_queue.unbind_worker_thread();
 }
 
 void WorkerThread::execute_job(IJob& job)
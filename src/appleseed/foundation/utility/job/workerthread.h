@@ -58,7 +58,8 @@ class WorkerThread
         const size_t    thread_index,       // index of this worker thread
         Logger&         logger,             // logger
         JobQueue&       job_queue,          // job queue
-        const bool      keep_running);      // keep this worker thread running even if the job queue is empty
+        const bool      keep_running,       // keep this worker thread running even if the job queue is empty
+        const size_t    cpu = ~0);          // logical CPU core this worker thread is bound to, ~0 for none
 
     // Destructor.
     ~WorkerThread();
@@ -91,6 +92,7 @@ class WorkerThread
     Logger&             m_logger;
     JobQueue&           m_job_queue;
     const bool          m_keep_running;
+    const size_t        m_cpu;
 
     AbortSwitch         m_abort_switch;
     ThreadFunc          m_thread_func;
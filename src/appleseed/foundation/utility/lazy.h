@@ -32,9 +32,11 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/core/exceptions/exception.h"
+#include "foundation/platform/atomic.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/cache.h"
+#include "foundation/utility/profiler.h"
 #include "foundation/utility/typetraits.h"
 #include "foundation/utility/uid.h"
 
@@ -69,6 +71,9 @@ class ILazyFactory
 //
 // A lazily constructed object.
 //
+// Once the object has been constructed, acquiring access to it is lock-free.
+// The mutex is only taken by the threads that find the object missing.
+//
 
 template <typename Object>
 class Lazy
@@ -96,12 +101,17 @@ class Lazy
     template <typename>
     friend class Access;
 
-    boost::mutex        m_mutex;
-    int                 m_reference_count;
+    boost::mutex                    m_mutex;
+#ifndef NDEBUG
+    volatile uint32                 m_reference_count;      // only used to check that no access outlives the object
+#endif
 
-    FactoryType*        m_factory;
-    const ObjectType*   m_object;
-    const bool          m_own_object;
+    FactoryType*                    m_factory;
+    const ObjectType* volatile      m_object;
+    const bool                      m_own_object;
+
+    // Return the object, creating it if necessary.
+    const ObjectType* acquire();
 };
 
 
@@ -145,7 +155,8 @@ class Access
     const ObjectType& operator*() const;
 
   private:
-    LazyType*   m_lazy;
+    LazyType*           m_lazy;
+    const ObjectType*   m_object;
 };
 
 
@@ -335,21 +346,26 @@ class AccessCacheMap
 
 template <typename Object>
 Lazy<Object>::Lazy(std::auto_ptr<FactoryType> factory)
-  : m_reference_count(0)
-  , m_factory(factory.release())
+  : m_factory(factory.release())
   , m_object(0)
   , m_own_object(true)
 {
     assert(m_factory);
+
+#ifndef NDEBUG
+    m_reference_count = 0;
+#endif
 }
 
 template <typename Object>
 Lazy<Object>::Lazy(const ObjectType* object)
-  : m_reference_count(0)
-  , m_factory(0)
+  : m_factory(0)
   , m_object(object)
   , m_own_object(false)
 {
+#ifndef NDEBUG
+    m_reference_count = 0;
+#endif
 }
 
 template <typename Object>
@@ -366,6 +382,28 @@ Lazy<Object>::~Lazy()
     m_object = 0;
 }
 
+template <typename Object>
+inline const Object* Lazy<Object>::acquire()
+{
+    // Fast path: the object already exists.
+    const ObjectType* object = atomic_read(&m_object);
+    if (object)
+        return object;
+
+    // Slow path: create the object, unless another thread beat us to it.
+    FOUNDATION_PROFILE_ZONE("Lazy::acquire");
+    boost::mutex::scoped_lock lock(m_mutex);
+    object = m_object;
+    if (object == 0)
+    {
+        assert(m_factory);
+        object = m_factory->create().release();
+        atomic_write(&m_object, object);
+    }
+
+    return object;
+}
+
 
 //
 // Access class implementation.
@@ -374,6 +412,7 @@ Lazy<Object>::~Lazy()
 template <typename Object>
 inline Access<Object>::Access(LazyType* lazy)
   : m_lazy(0)
+  , m_object(0)
 {
     reset(lazy);
 }
@@ -381,6 +420,7 @@ inline Access<Object>::Access(LazyType* lazy)
 template <typename Object>
 inline Access<Object>::Access(const Access& rhs)
   : m_lazy(0)
+  , m_object(0)
 {
     reset(rhs.m_lazy);
 }
@@ -401,51 +441,46 @@ inline Access<Object>::~Access()
 template <typename Object>
 void Access<Object>::reset(LazyType* lazy)
 {
+#ifndef NDEBUG
     // Release access to the current lazy object, if any.
     if (m_lazy)
     {
-        boost::mutex::scoped_lock lock(m_lazy->m_mutex);
         assert(m_lazy->m_reference_count > 0);
-        --m_lazy->m_reference_count;
+        atomic_dec(&m_lazy->m_reference_count);
     }
+#endif
 
     // Acquire access to the new lazy object.
     m_lazy = lazy;
+    m_object = lazy ? lazy->acquire() : 0;
+
+#ifndef NDEBUG
     if (m_lazy)
-    {
-        boost::mutex::scoped_lock lock(m_lazy->m_mutex);
-        ++m_lazy->m_reference_count;
-
-        // Create the object if it doesn't exist yet.
-        if (m_lazy->m_object == 0)
-        {
-            assert(m_lazy->m_factory);
-            m_lazy->m_object = m_lazy->m_factory->create().release();
-        }
-    }
+        atomic_inc(&m_lazy->m_reference_count);
+#endif
 }
 
 template <typename Object>
 inline const Object* Access<Object>::get() const
 {
     assert(m_lazy);
-    return m_lazy->m_object;
+    return m_object;
 }
 
 template <typename Object>
 inline const Object* Access<Object>::operator->() const
 {
     assert(m_lazy);
-    assert(m_lazy->m_object);
-    return m_lazy->m_object;
+    assert(m_object);
+    return m_object;
 }
 
 template <typename Object>
 inline const Object& Access<Object>::operator*() const
 {
     assert(m_lazy);
-    assert(m_lazy->m_object);
-    return *m_lazy->m_object;
+    assert(m_object);
+    return *m_object;
 }
 
 
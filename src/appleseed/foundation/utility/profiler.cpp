@@ -0,0 +1,254 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "profiler.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/thread.h"
+
+// boost headers.
+#include "boost/thread/tss.hpp"
+
+// Standard headers.
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// Profiler class implementation.
+//
+
+namespace
+{
+    struct Zone
+    {
+        const char*     m_name;
+        uint64          m_begin;
+        uint64          m_end;
+    };
+
+    struct ThreadBuffer
+    {
+        size_t          m_thread_index;
+        vector<Zone>    m_zones;
+    };
+
+    // Thread buffers are owned by the profiler, not by the threads they belong to,
+    // so that zones survive the threads that recorded them.
+    void do_not_delete(ThreadBuffer*)
+    {
+    }
+
+    void write_escaped_string(FILE* file, const char* s)
+    {
+        fputc('"', file);
+
+        for (; *s; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+                fputc('\\', file);
+
+            fputc(*s, file);
+        }
+
+        fputc('"', file);
+    }
+}
+
+struct Profiler::Impl
+{
+    DefaultWallclockTimer                   m_timer;
+    uint64                                  m_origin;
+
+    boost::mutex                            m_mutex;
+    vector<ThreadBuffer*>                   m_buffers;
+    boost::thread_specific_ptr<ThreadBuffer> m_current_buffer;
+
+    Impl()
+      : m_origin(m_timer.read())
+      , m_current_buffer(&do_not_delete)
+    {
+    }
+
+    ~Impl()
+    {
+        for (size_t i = 0; i < m_buffers.size(); ++i)
+            delete m_buffers[i];
+    }
+
+    ThreadBuffer* get_current_buffer()
+    {
+        ThreadBuffer* buffer = m_current_buffer.get();
+
+        if (buffer == 0)
+        {
+            buffer = new ThreadBuffer();
+
+            boost::mutex::scoped_lock lock(m_mutex);
+            buffer->m_thread_index = m_buffers.size();
+            m_buffers.push_back(buffer);
+
+            m_current_buffer.reset(buffer);
+        }
+
+        return buffer;
+    }
+};
+
+Profiler::Profiler()
+  : impl(new Impl())
+  , m_enabled(0)
+{
+}
+
+Profiler::~Profiler()
+{
+    delete impl;
+}
+
+void Profiler::set_enabled(const bool enabled)
+{
+    if (enabled)
+        clear();
+
+    m_enabled = enabled ? 1 : 0;
+}
+
+void Profiler::clear()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    for (size_t i = 0; i < impl->m_buffers.size(); ++i)
+        impl->m_buffers[i]->m_zones.clear();
+
+    impl->m_origin = impl->m_timer.read();
+}
+
+uint64 Profiler::read_clock()
+{
+    return impl->m_timer.read();
+}
+
+void Profiler::record(
+    const char*     name,
+    const uint64    begin,
+    const uint64    end)
+{
+    assert(name);
+    assert(begin <= end);
+
+    Zone zone;
+    zone.m_name = name;
+    zone.m_begin = begin;
+    zone.m_end = end;
+
+    impl->get_current_buffer()->m_zones.push_back(zone);
+}
+
+size_t Profiler::get_zone_count() const
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    size_t zone_count = 0;
+
+    for (size_t i = 0; i < impl->m_buffers.size(); ++i)
+        zone_count += impl->m_buffers[i]->m_zones.size();
+
+    return zone_count;
+}
+
+bool Profiler::write_chrome_trace(const char* path) const
+{
+    assert(path);
+
+    FILE* file = fopen(path, "wt");
+
+    if (file == 0)
+        return false;
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    // Timestamps are expressed in microseconds.
+    const double scale = 1.0e6 / impl->m_timer.frequency();
+    const uint64 origin = impl->m_origin;
+
+    fprintf(file, "{\n\"traceEvents\": [\n");
+
+    bool first_event = true;
+
+    for (size_t i = 0; i < impl->m_buffers.size(); ++i)
+    {
+        const ThreadBuffer& buffer = *impl->m_buffers[i];
+
+        fprintf(
+            file,
+            "%s{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " FMT_SIZE_T ", "
+            "\"args\": { \"name\": \"thread " FMT_SIZE_T "\" } }",
+            first_event ? "" : ",\n",
+            buffer.m_thread_index,
+            buffer.m_thread_index);
+
+        first_event = false;
+
+        for (size_t j = 0; j < buffer.m_zones.size(); ++j)
+        {
+            const Zone& zone = buffer.m_zones[j];
+
+            // Zones that were open when the profiler was last cleared start before the origin.
+            const double ts = zone.m_begin > origin ? (zone.m_begin - origin) * scale : 0.0;
+            const double dur = (zone.m_end - zone.m_begin) * scale;
+
+            fprintf(file, ",\n{ \"name\": ");
+            write_escaped_string(file, zone.m_name);
+            fprintf(
+                file,
+                ", \"cat\": \"appleseed\", \"ph\": \"X\", \"pid\": 0, \"tid\": " FMT_SIZE_T ", "
+                "\"ts\": %.3f, \"dur\": %.3f }",
+                buffer.m_thread_index,
+                ts,
+                dur);
+        }
+    }
+
+    fprintf(file, "\n],\n\"displayTimeUnit\": \"ms\"\n}\n");
+
+    const bool success = ferror(file) == 0;
+
+    fclose(file);
+
+    return success;
+}
+
+}   // namespace foundation
@@ -0,0 +1,183 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_PROFILER_H
+#define APPLESEED_FOUNDATION_UTILITY_PROFILER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/core/concepts/singleton.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+
+//
+// On Windows, define FOUNDATIONDLL to __declspec(dllexport) when building the DLL
+// and to __declspec(dllimport) when building an application using the DLL.
+// Other platforms don't use this export mechanism and the symbol FOUNDATIONDLL is
+// defined to evaluate to nothing.
+//
+
+#ifndef FOUNDATIONDLL
+#ifdef _WIN32
+#ifdef APPLESEED_FOUNDATION_EXPORTS
+#define FOUNDATIONDLL __declspec(dllexport)
+#else
+#define FOUNDATIONDLL __declspec(dllimport)
+#endif
+#else
+#define FOUNDATIONDLL
+#endif
+#endif
+
+namespace foundation
+{
+
+//
+// The (unique) profiler. It records named time intervals (zones) in per-thread
+// buffers, without any locking once a thread has recorded its first zone. Zones
+// nest naturally when scoped zones are used. Recorded zones can be exported to
+// the Chrome trace event format and inspected with chrome://tracing.
+//
+// The profiler is disabled by default. While it is disabled, a scoped zone
+// costs a single test.
+//
+// Only the pointers to zone names are stored: zone names must be string
+// literals, or otherwise outlive the recorded zones.
+//
+
+class FOUNDATIONDLL Profiler
+  : public Singleton<Profiler>
+{
+  public:
+    // Constructor (kept public for the unit tests).
+    Profiler();
+
+    // Destructor (kept public for the unit tests).
+    ~Profiler();
+
+    // Enable or disable the profiler. Enabling the profiler discards all recorded zones.
+    void set_enabled(const bool enabled = true);
+
+    // Return true if the profiler is enabled.
+    bool is_enabled() const;
+
+    // Discard all recorded zones. Must not be called while zones are being recorded.
+    void clear();
+
+    // Return the current time, in profiler clock ticks.
+    uint64 read_clock();
+
+    // Record a zone on the calling thread. Begin and end times are in profiler clock ticks.
+    void record(
+        const char*     name,
+        const uint64    begin,
+        const uint64    end);
+
+    // Return the number of recorded zones.
+    size_t get_zone_count() const;
+
+    // Write all recorded zones to a file, in the Chrome trace event format.
+    // Returns true on success, false otherwise.
+    bool write_chrome_trace(const char* path) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+
+    volatile uint32 m_enabled;
+};
+
+
+//
+// A zone that spans the lifetime of this object.
+//
+
+class ProfilerZone
+  : public NonCopyable
+{
+  public:
+    // Constructor, opens the zone if the profiler is enabled.
+    explicit ProfilerZone(const char* name);
+
+    // Destructor, closes the zone.
+    ~ProfilerZone();
+
+  private:
+    Profiler*       m_profiler;
+    const char*     m_name;
+    uint64          m_begin;
+};
+
+// Profile the enclosing scope.
+#define FOUNDATION_PROFILE_ZONE(name) \
+    FOUNDATION_PROFILE_ZONE_IMPL(name, __LINE__)
+#define FOUNDATION_PROFILE_ZONE_IMPL(name, line) \
+    FOUNDATION_PROFILE_ZONE_IMPL2(name, line)
+#define FOUNDATION_PROFILE_ZONE_IMPL2(name, line) \
+    foundation::ProfilerZone profiler_zone_##line(name)
+
+
+//
+// Profiler class implementation.
+//
+
+inline bool Profiler::is_enabled() const
+{
+    return m_enabled != 0;
+}
+
+
+//
+// ProfilerZone class implementation.
+//
+
+inline ProfilerZone::ProfilerZone(const char* name)
+  : m_profiler(0)
+  , m_name(name)
+  , m_begin(0)
+{
+    Profiler& profiler = Profiler::instance();
+
+    if (profiler.is_enabled())
+    {
+        m_profiler = &profiler;
+        m_begin = profiler.read_clock();
+    }
+}
+
+inline ProfilerZone::~ProfilerZone()
+{
+    if (m_profiler)
+        m_profiler->record(m_name, m_begin, m_profiler->read_clock());
+}
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_PROFILER_H
@@ -37,5 +37,6 @@
 #include "renderer/modeling/project/projectfilewriter.h"
 #include "renderer/modeling/project-builtin/cornellboxproject.h"
 #include "renderer/modeling/project-builtin/defaultproject.h"
+#include "renderer/modeling/project-builtin/syntheticproject.h"
 
 #endif  // !APPLESEED_RENDERER_API_PROJECT_H
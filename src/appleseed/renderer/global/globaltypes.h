@@ -51,8 +51,14 @@ typedef foundation::Vector<GScalar, 3>          GVector3;
 typedef foundation::AABB<GScalar, 3>            GAABB3;
 typedef foundation::AABB<GScalar, 1>            GAABB1;
 
-// Spectrum representation.
+// Spectrum representation. Define APPLESEED_RENDERER_USE_RGB_SPECTRUM to build a
+// renderer that carries linear RGB triplets instead of 31-band spectra through the
+// light simulation. Spectral inputs are then converted to linear RGB at load time.
+#ifdef APPLESEED_RENDERER_USE_RGB_SPECTRUM
+typedef foundation::RegularSpectrum<float, 3>   Spectrum;
+#else
 typedef foundation::RegularSpectrum<float, 31>  Spectrum;
+#endif
 
 // Alpha channel representation.
 typedef foundation::Color<float, 1>             Alpha;
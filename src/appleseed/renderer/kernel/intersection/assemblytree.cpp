@@ -42,7 +42,9 @@
 #include "foundation/math/intersection.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/sah.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/profiler.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -190,6 +192,10 @@ typedef bvh::Builder<
         AssemblyTreePartitioner
     > AssemblyTreeBuilder;
 
+#ifdef RENDERER_ASSEMBLY_TREE_USE_QBVH
+typedef bvh::QBuilder<AssemblyTree> AssemblyTreeQBuilder;
+#endif
+
 
 //
 // Assembly tree statistics.
@@ -201,12 +207,42 @@ typedef bvh::TreeStatistics<
     > AssemblyTreeStatistics;
 
 
+//
+// A job that forces the construction of a lazy child tree.
+//
+
+namespace
+{
+    template <typename Tree>
+    class PrebuildChildTreeJob
+      : public IJob
+    {
+      public:
+        explicit PrebuildChildTreeJob(Lazy<Tree>* tree)
+          : m_tree(tree)
+        {
+        }
+
+        virtual void execute(const size_t /*thread_index*/)
+        {
+            Access<Tree> access(m_tree);
+        }
+
+      private:
+        Lazy<Tree>* m_tree;
+    };
+}
+
+
 //
 // AssemblyTree class implementation.
 //
 
-AssemblyTree::AssemblyTree(const Scene& scene)
+AssemblyTree::AssemblyTree(
+    const Scene&            scene,
+    const string&           tree_cache_path)
   : m_scene(scene)
+  , m_tree_cache_path(tree_cache_path)
 {
     update();
 }
@@ -227,13 +263,56 @@ AssemblyTree::~AssemblyTree()
     m_triangle_trees.clear();
 }
 
+void AssemblyTree::set_tree_cache_path(const string& tree_cache_path)
+{
+    m_tree_cache_path = tree_cache_path;
+}
+
 void AssemblyTree::update()
 {
+    FOUNDATION_PROFILE_ZONE("AssemblyTree::update");
+
     clear();
     build_assembly_tree();
     update_child_trees();
 }
 
+void AssemblyTree::prebuild_child_trees(const size_t thread_count) const
+{
+    const size_t tree_count = m_triangle_trees.size() + m_region_trees.size();
+
+    if (tree_count == 0)
+        return;
+
+    // The threads building trees side by side are taken from the budget shared
+    // by all tree constructions, so that the parallel construction of each tree
+    // only uses the cores left over.
+    const ThreadBudgetReservation builder_threads(
+        get_tree_construction_thread_budget(),
+        min(thread_count, tree_count));
+    const size_t builder_thread_count = max<size_t>(builder_threads.get_thread_count(), 1);
+
+    // Log a progress message.
+    RENDERER_LOG_INFO(
+        "prebuilding %s %s using %s %s...",
+        pretty_uint(tree_count).c_str(),
+        plural(tree_count, "child tree").c_str(),
+        pretty_uint(builder_thread_count).c_str(),
+        plural(builder_thread_count, "thread").c_str());
+
+    JobQueue job_queue;
+
+    for (const_each<TriangleTreeContainer> i = m_triangle_trees; i; ++i)
+        job_queue.schedule(new PrebuildChildTreeJob<TriangleTree>(i->second));
+
+    for (const_each<RegionTreeContainer> i = m_region_trees; i; ++i)
+        job_queue.schedule(new PrebuildChildTreeJob<RegionTree>(i->second));
+
+    JobManager job_manager(global_logger(), job_queue, builder_thread_count);
+    job_manager.start();
+    job_queue.wait_until_completion();
+}
+
 void AssemblyTree::collect_assemblies(vector<UniqueID>& assemblies) const
 {
     assert(assemblies.empty());
@@ -308,7 +387,8 @@ Lazy<TriangleTree>* AssemblyTree::create_triangle_tree(const Assembly& assembly)
                 assembly.get_uid(),
                 assembly_bbox,
                 assembly,
-                regions)));
+                regions,
+                m_tree_cache_path)));
 
     return new Lazy<TriangleTree>(triangle_tree_factory);
 }
@@ -360,6 +440,17 @@ void AssemblyTree::build_assembly_tree()
     AssemblyTreeStatistics tree_stats(*this, builder);
     RENDERER_LOG_DEBUG("assembly bvh statistics:");
     tree_stats.print(global_logger());
+
+#ifdef RENDERER_ASSEMBLY_TREE_USE_QBVH
+    // Collapse the assembly tree into a 4-wide tree.
+    AssemblyTreeQBuilder qbuilder;
+    qbuilder.build(*this);
+    RENDERER_LOG_DEBUG(
+        "collapsed assembly bvh into %s %s in %s.",
+        pretty_uint(m_qnodes.size()).c_str(),
+        plural(m_qnodes.size(), "4-wide node").c_str(),
+        pretty_time(qbuilder.get_build_time()).c_str());
+#endif
 }
 
 void AssemblyTree::update_child_trees()
@@ -459,6 +550,24 @@ void AssemblyLeafVisitorBase::transform_ray_to_assembly_instance_space(
     }
 }
 
+void AssemblyLeafVisitorBase::update_closest_hit(
+    const AssemblyInstance*             assembly_instance,
+    const ShadingPoint&                 local_shading_point,
+    ShadingPoint&                       shading_point)
+{
+    if (local_shading_point.m_hit && local_shading_point.m_ray.m_tmax < shading_point.m_ray.m_tmax)
+    {
+        shading_point.m_ray.m_tmax = local_shading_point.m_ray.m_tmax;
+        shading_point.m_hit = true;
+        shading_point.m_bary = local_shading_point.m_bary;
+        shading_point.m_asm_instance_uid = assembly_instance->get_uid();
+        shading_point.m_object_instance_index = local_shading_point.m_object_instance_index;
+        shading_point.m_region_index = local_shading_point.m_region_index;
+        shading_point.m_triangle_index = local_shading_point.m_triangle_index;
+        shading_point.m_triangle_support_plane = local_shading_point.m_triangle_support_plane;
+    }
+}
+
 
 //
 // AssemblyLeafVisitor class implementation.
@@ -557,20 +666,166 @@ bool AssemblyLeafVisitor::visit(
     }
 
     // Keep track of the closest hit.
-    if (result.m_hit && result.m_ray.m_tmax < m_shading_point.m_ray.m_tmax)
+    update_closest_hit(assembly_instance, result, m_shading_point);
+
+    // Continue traversal.
+    distance = m_shading_point.m_ray.m_tmax;
+    return true;
+}
+
+
+//
+// AssemblyLeafPacketVisitor class implementation.
+//
+
+bool AssemblyLeafPacketVisitor::visit(
+    const vector<UniqueID>&             items,
+    const vector<GAABB3>&               bboxes,
+    const size_t                        begin,
+    const size_t                        end,
+    const ShadingRay::RayType&          /*ray*/,
+    const ShadingRay::RayInfoType&      /*ray_info*/,
+    const double                        /*tmin*/,
+    const double                        /*tmax*/,
+    double&                             distance)
+{
+    assert(begin + 1 == end);
+
+    const UniqueID assembly_instance_uid = items[begin];
+
+    // Intersect this assembly instance with the whole packet, unless this was already done.
+    if (find(
+            m_visited_assembly_instances.begin(),
+            m_visited_assembly_instances.end(),
+            assembly_instance_uid) == m_visited_assembly_instances.end())
     {
-        m_shading_point.m_ray.m_tmax = result.m_ray.m_tmax;
-        m_shading_point.m_hit = true;
-        m_shading_point.m_bary = result.m_bary;
-        m_shading_point.m_asm_instance_uid = assembly_instance->get_uid();
-        m_shading_point.m_object_instance_index = result.m_object_instance_index;
-        m_shading_point.m_region_index = result.m_region_index;
-        m_shading_point.m_triangle_index = result.m_triangle_index;
-        m_shading_point.m_triangle_support_plane = result.m_triangle_support_plane;
+        m_visited_assembly_instances.push_back(assembly_instance_uid);
+
+        // Retrieve the assembly instance.
+        const AssemblyInstance* assembly_instance =
+            m_tree.m_scene.assembly_instances().get_by_uid(assembly_instance_uid);
+        assert(assembly_instance);
+
+        // Find the rays of the packet that reach the assembly instance.
+        const AABB3d bbox(bboxes[begin]);
+        uint32 ray_mask = 0;
+        for (size_t i = 0; i < RayPacketSize; ++i)
+        {
+            if (intersect(m_shading_points[i].m_ray, m_ray_infos[i], bbox))
+                ray_mask |= 1UL << i;
+        }
+
+        if (ray_mask && !intersect_packet(assembly_instance, ray_mask))
+        {
+            // The rays diverge in the space of the assembly instance: intersect them one by one.
+            for (size_t i = 0; i < RayPacketSize; ++i)
+            {
+                if (!(ray_mask & (1UL << i)))
+                    continue;
+
+                ShadingPoint& shading_point = m_shading_points[i];
+
+                AssemblyLeafVisitor visitor(
+                    shading_point,
+                    m_tree,
+                    m_region_tree_cache,
+                    m_triangle_tree_cache,
+                    0
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+                    , m_triangle_bsp_stats
+#endif
+                    );
+
+                double ray_distance;
+                visitor.visit(
+                    items,
+                    bboxes,
+                    begin,
+                    end,
+                    shading_point.m_ray,
+                    m_ray_infos[i],
+                    shading_point.m_ray.m_tmin,
+                    shading_point.m_ray.m_tmax,
+                    ray_distance);
+            }
+        }
     }
 
     // Continue traversal.
-    distance = m_shading_point.m_ray.m_tmax;
+    distance = m_shading_points[m_ray_index].m_ray.m_tmax;
+    return true;
+}
+
+bool AssemblyLeafPacketVisitor::intersect_packet(
+    const AssemblyInstance*             assembly_instance,
+    const uint32                        ray_mask)
+{
+    // Region trees are only traversed one ray at a time.
+    if (assembly_instance->get_assembly().is_flushable())
+        return false;
+
+    ShadingPoint results[RayPacketSize];
+    ShadingRay::RayType local_rays[RayPacketSize];
+    ShadingRay::RayInfoType local_ray_infos[RayPacketSize];
+
+    for (size_t i = 0; i < RayPacketSize; ++i)
+    {
+        if (!(ray_mask & (1UL << i)))
+            continue;
+
+        const ShadingPoint& shading_point = m_shading_points[i];
+
+        ShadingPoint& result = results[i];
+        result.m_ray.m_tmin = shading_point.m_ray.m_tmin;
+        result.m_ray.m_tmax = shading_point.m_ray.m_tmax;
+        result.m_ray.m_time = shading_point.m_ray.m_time;
+        result.m_ray.m_flags = shading_point.m_ray.m_flags;
+
+        // Transform the ray to assembly instance space.
+        transform_ray_to_assembly_instance_space(
+            assembly_instance,
+            0,
+            shading_point.m_ray,
+            result.m_ray);
+
+        local_rays[i] = result.m_ray;
+        local_ray_infos[i] = ShadingRay::RayInfoType(result.m_ray);
+    }
+
+    if (!TriangleLeafPacketIntersector::is_coherent(local_ray_infos, ray_mask))
+        return false;
+
+    // Retrieve the triangle tree of this assembly.
+    const TriangleTree* triangle_tree =
+        m_triangle_tree_cache.access(
+            assembly_instance->get_assembly_uid(),
+            m_tree.m_triangle_trees);
+
+    if (triangle_tree)
+    {
+        // Check the intersection between the packet and the triangle tree.
+        TriangleLeafPacketVisitor visitor(results);
+        TriangleLeafPacketIntersector intersector;
+        intersector.intersect(
+            *triangle_tree,
+            local_rays,
+            local_ray_infos,
+            ray_mask,
+            visitor
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+            , m_triangle_bsp_stats
+#endif
+            );
+        visitor.read_hit_triangle_data();
+
+        // Keep track of the closest hits.
+        for (size_t i = 0; i < RayPacketSize; ++i)
+        {
+            if (ray_mask & (1UL << i))
+                update_closest_hit(assembly_instance, results[i], m_shading_points[i]);
+        }
+    }
+
     return true;
 }
 
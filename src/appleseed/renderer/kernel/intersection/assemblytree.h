@@ -48,6 +48,7 @@
 
 // Standard headers.
 #include <map>
+#include <string>
 #include <vector>
 
 // Forward declarations.
@@ -61,25 +62,43 @@ namespace renderer
 // Assembly tree.
 //
 
+#ifdef RENDERER_ASSEMBLY_TREE_USE_QBVH
+typedef foundation::bvh::QTree<GScalar, 3, foundation::UniqueID> AssemblyTreeBase;
+#else
+typedef foundation::bvh::Tree<GScalar, 3, foundation::UniqueID> AssemblyTreeBase;
+#endif
+
 class AssemblyTree
-  : public foundation::bvh::Tree<GScalar, 3, foundation::UniqueID>
+  : public AssemblyTreeBase
 {
   public:
     // Constructor, builds the tree for a given scene.
-    explicit AssemblyTree(const Scene& scene);
+    explicit AssemblyTree(
+        const Scene&            scene,
+        const std::string&      tree_cache_path = std::string());
 
     // Destructor.
     ~AssemblyTree();
 
+    // Set the directory where triangle trees are cached (empty to disable caching).
+    // Only affects triangle trees created by subsequent updates.
+    void set_tree_cache_path(const std::string& tree_cache_path);
+
     // Update the assembly tree and all the child trees.
     void update();
 
+    // Build the child trees that have not been built yet, using multiple threads.
+    // Region trees are built but the triangle trees they refer to remain lazy.
+    void prebuild_child_trees(const size_t thread_count) const;
+
   private:
     friend class AssemblyLeafVisitor;
+    friend class AssemblyLeafPacketVisitor;
     friend class AssemblyLeafProbeVisitor;
     friend class Intersector;
 
     const Scene&            m_scene;
+    std::string             m_tree_cache_path;
     RegionTreeContainer     m_region_trees;
     TriangleTreeContainer   m_triangle_trees;
 
@@ -121,6 +140,12 @@ class AssemblyLeafVisitorBase
         const ShadingPoint*                         parent_shading_point,
         const ShadingRay::RayType&                  input_ray,
         ShadingRay::RayType&                        output_ray);
+
+    // Record a hit found in an assembly instance if it is closer than the current one.
+    void update_closest_hit(
+        const AssemblyInstance*                     assembly_instance,
+        const ShadingPoint&                         local_shading_point,
+        ShadingPoint&                               shading_point);
 };
 
 
@@ -212,10 +237,91 @@ class AssemblyLeafProbeVisitor
 };
 
 
+//
+// Assembly leaf visitor for packets of rays.
+//
+// The assembly tree is traversed once per ray of the packet, but each
+// assembly instance is intersected only once by the whole packet, the
+// first time one of the rays reaches it.
+//
+
+class AssemblyLeafPacketVisitor
+  : public AssemblyLeafVisitorBase
+{
+  public:
+    // Constructor.
+    AssemblyLeafPacketVisitor(
+        ShadingPoint                                shading_points[],
+        const ShadingRay::RayInfoType               ray_infos[],
+        const size_t                                ray_index,          // ray of the packet being traversed
+        std::vector<foundation::UniqueID>&          visited_assembly_instances,
+        const AssemblyTree&                         tree,
+        RegionTreeAccessCache&                      region_tree_cache,
+        TriangleTreeAccessCache&                    triangle_tree_cache
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+        , foundation::bsp::TraversalStatistics&     triangle_bsp_stats
+#endif
+        );
+
+    // Visit a leaf.
+    bool visit(
+        const std::vector<foundation::UniqueID>&    items,
+        const std::vector<GAABB3>&                  bboxes,
+        const size_t                                begin,
+        const size_t                                end,
+        const ShadingRay::RayType&                  ray,
+        const ShadingRay::RayInfoType&              ray_info,
+        const double                                tmin,
+        const double                                tmax,
+        double&                                     distance);
+
+  private:
+    ShadingPoint*                                   m_shading_points;
+    const ShadingRay::RayInfoType*                  m_ray_infos;
+    const size_t                                    m_ray_index;
+    std::vector<foundation::UniqueID>&              m_visited_assembly_instances;
+    const AssemblyTree&                             m_tree;
+    RegionTreeAccessCache&                          m_region_tree_cache;
+    TriangleTreeAccessCache&                        m_triangle_tree_cache;
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+    foundation::bsp::TraversalStatistics&           m_triangle_bsp_stats;
+#endif
+
+    // Intersect the rays of the packet whose bit is set in 'ray_mask' with a
+    // given assembly instance. Return false if the rays could not be traced
+    // together in the space of the assembly instance.
+    bool intersect_packet(
+        const AssemblyInstance*                     assembly_instance,
+        const foundation::uint32                    ray_mask);
+};
+
+
 //
 // Assembly tree intersectors.
 //
 
+#ifdef RENDERER_ASSEMBLY_TREE_USE_QBVH
+
+typedef foundation::bvh::QIntersector<
+    double,
+    AssemblyTree,
+    AssemblyLeafVisitor
+> AssemblyLeafIntersector;
+
+typedef foundation::bvh::QIntersector<
+    double,
+    AssemblyTree,
+    AssemblyLeafProbeVisitor
+> AssemblyLeafProbeIntersector;
+
+typedef foundation::bvh::QIntersector<
+    double,
+    AssemblyTree,
+    AssemblyLeafPacketVisitor
+> AssemblyLeafPacketIntersector;
+
+#else
+
 typedef foundation::bvh::Intersector<
     double,
     AssemblyTree,
@@ -228,6 +334,14 @@ typedef foundation::bvh::Intersector<
     AssemblyLeafProbeVisitor
 > AssemblyLeafProbeIntersector;
 
+typedef foundation::bvh::Intersector<
+    double,
+    AssemblyTree,
+    AssemblyLeafPacketVisitor
+> AssemblyLeafPacketIntersector;
+
+#endif
+
 
 //
 // AssemblyLeafVisitor class implementation.
@@ -255,6 +369,36 @@ inline AssemblyLeafVisitor::AssemblyLeafVisitor(
 }
 
 
+//
+// AssemblyLeafPacketVisitor class implementation.
+//
+
+inline AssemblyLeafPacketVisitor::AssemblyLeafPacketVisitor(
+    ShadingPoint                                    shading_points[],
+    const ShadingRay::RayInfoType                   ray_infos[],
+    const size_t                                    ray_index,
+    std::vector<foundation::UniqueID>&              visited_assembly_instances,
+    const AssemblyTree&                             tree,
+    RegionTreeAccessCache&                          region_tree_cache,
+    TriangleTreeAccessCache&                        triangle_tree_cache
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+    , foundation::bsp::TraversalStatistics&         triangle_bsp_stats
+#endif
+    )
+  : m_shading_points(shading_points)
+  , m_ray_infos(ray_infos)
+  , m_ray_index(ray_index)
+  , m_visited_assembly_instances(visited_assembly_instances)
+  , m_tree(tree)
+  , m_region_tree_cache(region_tree_cache)
+  , m_triangle_tree_cache(triangle_tree_cache)
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+  , m_triangle_bsp_stats(triangle_bsp_stats)
+#endif
+{
+}
+
+
 //
 // AssemblyLeafProbeVisitor class implementation.
 //
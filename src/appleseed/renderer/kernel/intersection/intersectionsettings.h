@@ -49,6 +49,32 @@ typedef foundation::TriangleMT<GScalar> GTriangleType;
 typedef foundation::TriangleMT<double> TriangleType;
 typedef foundation::TriangleMTSupportPlane<double> TriangleSupportPlaneType;
 
+// Packet of rays used for packet intersection.
+typedef foundation::TriangleMTRayPacket<double> TriangleRayPacketType;
+
+
+//
+// Packet tracing settings.
+//
+
+// Number of rays in a packet traced by Intersector::trace_packet().
+const size_t RayPacketSize = TriangleRayPacketType::Size;
+
+// If defined, the camera rays of a pixel are traced by packets when the
+// pixel has enough samples. If left undefined, camera rays are traced
+// one at a time.
+#define RENDERER_TRACE_CAMERA_RAY_PACKETS
+
+
+//
+// Assembly BVH settings.
+//
+
+// If defined, the assembly tree is collapsed into a 4-wide BVH after
+// construction and traversed with 4-way SIMD ray-box tests. If left
+// undefined, the binary BVH is traversed one bounding box at a time.
+#define RENDERER_ASSEMBLY_TREE_USE_QBVH
+
 
 //
 // Region BSP tree statistics.
@@ -86,9 +112,13 @@ const size_t TriangleTreeMaxLeafSize = 1;
 // Maximum depth of the tree.
 const size_t TriangleTreeMaxDepth = 64;
 
-// Number of bins used in the construction of the approximate SAH function.
+// Default number of bins used in the construction of the approximate SAH function.
 const size_t TriangleTreeApproxSAHBinCount = 32;
 
+// Allowed range for the number of bins of the approximate SAH function.
+const size_t TriangleTreeMinApproxSAHBinCount = 16;
+const size_t TriangleTreeMaxApproxSAHBinCount = 64;
+
 // Multiplier for the cost of keeping a leaf unsplit.
 const GScalar TriangleTreeLeafCostMultiplier = GScalar(0.99);
 
@@ -107,7 +137,13 @@ const size_t TriangleTreeMinLeafPageSize = 1024 * 1024;
 // Size of the triangle tree access cache.
 const size_t TriangleTreeAccessCacheSize = 16;
 
-// Enable/disable construction tracing.
+// Leaves with at least this many triangles are split in parallel.
+const size_t TriangleTreeMinParallelSplitSize = 8 * 1024;
+
+// Enable/disable multithreaded construction.
+const bool TriangleTreeParallelConstruction = true;
+
+// Enable/disable construction tracing (forces single-threaded construction).
 const bool TriangleTreeTraceConstruction = false;
 
 }       // namespace renderer
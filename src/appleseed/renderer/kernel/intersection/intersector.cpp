@@ -93,6 +93,7 @@ Intersector::Intersector(
   , m_assembly_tree_aabb(m_trace_context.get_assembly_tree().get_bbox())
   , m_ray_count(0)
   , m_probe_ray_count(0)
+  , m_packet_count(0)
 {
     if (m_print_statistics)
     {
@@ -116,10 +117,12 @@ Intersector::~Intersector()
         RENDERER_LOG_DEBUG(
             "general intersection statistics:\n"
             "  total rays       %s\n"
-            "  probe rays       %s (%s)",
+            "  probe rays       %s (%s)\n"
+            "  ray packets      %s",
             pretty_int(total_ray_count).c_str(),
             pretty_int(m_probe_ray_count).c_str(),
-            pretty_percent(m_probe_ray_count, total_ray_count).c_str());
+            pretty_percent(m_probe_ray_count, total_ray_count).c_str(),
+            pretty_int(m_packet_count).c_str());
 
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         RENDERER_LOG_DEBUG("assembly bvh intersection statistics:");
@@ -264,6 +267,69 @@ bool Intersector::trace(
     return shading_point.hit();
 }
 
+void Intersector::trace_packet(
+    const ShadingRay    rays[],
+    ShadingPoint        shading_points[]) const
+{
+    // Update ray casting statistics.
+    m_ray_count += RayPacketSize;
+    ++m_packet_count;
+
+    ShadingRay::RayInfoType ray_infos[RayPacketSize];
+
+    for (size_t i = 0; i < RayPacketSize; ++i)
+    {
+        ShadingPoint& shading_point = shading_points[i];
+
+        assert(shading_point.m_scene == 0);
+        assert(shading_point.hit() == false);
+
+        // Initialize the shading point.
+        shading_point.m_region_kit_cache = &m_region_kit_cache;
+        shading_point.m_tess_cache = &m_tess_cache;
+        shading_point.m_scene = &m_trace_context.get_scene();
+        shading_point.m_ray = rays[i];
+
+        // Compute ray info once for the entire traversal.
+        ray_infos[i] = ShadingRay::RayInfoType(shading_point.m_ray);
+    }
+
+    // Retrieve assembly tree.
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+    m_packet_assembly_instances.clear();
+
+    // Check the intersection between the rays and the assembly tree. Each
+    // assembly instance is intersected by the whole packet when the first
+    // ray reaches it; the traversals of the next rays are then pruned by
+    // the intersections already found.
+    for (size_t i = 0; i < RayPacketSize; ++i)
+    {
+        AssemblyLeafPacketVisitor visitor(
+            shading_points,
+            ray_infos,
+            i,
+            m_packet_assembly_instances,
+            assembly_tree,
+            m_region_tree_cache,
+            m_triangle_tree_cache
+#ifdef FOUNDATION_BSP_ENABLE_TRAVERSAL_STATS
+            , m_triangle_bsp_traversal_stats
+#endif
+            );
+        AssemblyLeafPacketIntersector intersector;
+        intersector.intersect(
+            assembly_tree,
+            shading_points[i].m_ray,
+            ray_infos[i],
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_bvh_traversal_stats
+#endif
+            );
+    }
+}
+
 bool Intersector::trace_probe(
     const ShadingRay&   ray,
     const ShadingPoint* parent_shading_point) const
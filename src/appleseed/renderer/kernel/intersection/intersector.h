@@ -41,6 +41,9 @@
 // appleseed.foundation headers.
 #include "foundation/math/bvh.h"
 
+// Standard headers.
+#include <vector>
+
 // Forward declarations.
 namespace renderer  { class ShadingPoint; }
 namespace renderer  { class TraceContext; }
@@ -84,6 +87,13 @@ class Intersector
         ShadingPoint&                   shading_point,
         const ShadingPoint*             parent_shading_point = 0) const;
 
+    // Trace a packet of RayPacketSize world space rays through the scene.
+    // Rays that remain coherent share traversal steps and triangle tests;
+    // the others are traced one at a time.
+    void trace_packet(
+        const ShadingRay                rays[],
+        ShadingPoint                    shading_points[]) const;
+
     // Trace a world space probe ray through the scene.
     bool trace_probe(
         const ShadingRay&               ray,
@@ -117,9 +127,13 @@ class Intersector
     mutable RegionKitAccessCache                    m_region_kit_cache;
     mutable StaticTriangleTessAccessCache           m_tess_cache;
 
+    // Assembly instances already intersected by the current ray packet.
+    mutable std::vector<foundation::UniqueID>       m_packet_assembly_instances;
+
     // Intersection statistics.
     mutable foundation::uint64                      m_ray_count;
     mutable foundation::uint64                      m_probe_ray_count;
+    mutable foundation::uint64                      m_packet_count;
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     mutable foundation::bvh::TraversalStatistics    m_assembly_bvh_traversal_stats;
 #endif
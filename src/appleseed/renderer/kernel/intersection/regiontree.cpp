@@ -46,6 +46,7 @@
 #include "foundation/math/transform.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/profiler.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -417,6 +418,8 @@ RegionTree::Arguments::Arguments(
 RegionTree::RegionTree(const Arguments& arguments)
   : m_assembly_uid(arguments.m_assembly_uid)
 {
+    FOUNDATION_PROFILE_ZONE("RegionTree::build");
+
     // Build the intermediate representation of the tree.
     IntermRegionTree interm_tree(arguments);
 
@@ -32,6 +32,9 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/intersection/assemblytree.h"
 
+// Standard headers.
+#include <cassert>
+
 namespace renderer
 {
 
@@ -39,9 +42,11 @@ namespace renderer
 // TraceContext class implementation.
 //
 
-TraceContext::TraceContext(const Scene& scene)
+TraceContext::TraceContext(
+    const Scene&    scene,
+    const char*     tree_cache_path)
   : m_scene(scene)
-  , m_assembly_tree(new AssemblyTree(scene))
+  , m_assembly_tree(new AssemblyTree(scene, tree_cache_path))
 {
 }
 
@@ -50,9 +55,21 @@ TraceContext::~TraceContext()
     delete m_assembly_tree;
 }
 
+void TraceContext::set_tree_cache_path(const char* tree_cache_path)
+{
+    assert(tree_cache_path);
+    m_assembly_tree->set_tree_cache_path(tree_cache_path);
+}
+
 void TraceContext::update()
 {
     m_assembly_tree->update();
 }
 
+void TraceContext::prebuild_trees(const size_t thread_count) const
+{
+    assert(thread_count > 0);
+    m_assembly_tree->prebuild_child_trees(thread_count);
+}
+
 }   // namespace renderer
@@ -51,7 +51,10 @@ class RENDERERDLL TraceContext
 {
   public:
     // Constructor, initializes the trace context for a given scene.
-    explicit TraceContext(const Scene& scene);
+    // Triangle trees are cached in tree_cache_path, unless it is empty.
+    explicit TraceContext(
+        const Scene&    scene,
+        const char*     tree_cache_path = "");
 
     // Destructor.
     ~TraceContext();
@@ -62,9 +65,16 @@ class RENDERERDLL TraceContext
     // Get the assembly tree.
     const AssemblyTree& get_assembly_tree() const;
 
+    // Set the directory where triangle trees are cached (empty to disable caching).
+    // Only affects triangle trees created after this call.
+    void set_tree_cache_path(const char* tree_cache_path);
+
     // Synchronize the trace context with the scene.
     void update();
 
+    // Build all lazily constructed acceleration structures upfront, using multiple threads.
+    void prebuild_trees(const size_t thread_count) const;
+
   private:
     const Scene&    m_scene;
     AssemblyTree*   m_assembly_tree;
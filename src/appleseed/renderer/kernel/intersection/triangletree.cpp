@@ -41,19 +41,31 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/area.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/intersection.h"
 #include "foundation/math/sah.h"
 #include "foundation/math/split.h"
 #include "foundation/math/transform.h"
 #include "foundation/platform/snprintf.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/timer.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/job/threadbudget.h"
 #include "foundation/utility/maplefile.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/profiler.h"
 #include "foundation/utility/string.h"
 
+// boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
 // Standard headers.
 #include <cstring>
 #include <stack>
+#include <string>
 
+using namespace boost;
 using namespace foundation;
 using namespace std;
 
@@ -64,6 +76,17 @@ namespace
 {
     typedef vector<GAABB3> GAABB3Vector;
 
+    // Version of the triangle tree cache file format. Increment it whenever
+    // the layout of the tree or the construction algorithm changes.
+    const uint32 TriangleTreeCacheFormatVersion = 1;
+
+    // Hash an integer, independently of the size of size_t on this platform.
+    uint64 hash_integer(const size_t value, const uint64 h)
+    {
+        const uint64 v = static_cast<uint64>(value);
+        return hash_bytes64(&v, sizeof(v), h);
+    }
+
 
     //
     // Leaf of an intermediate triangle tree.
@@ -155,6 +178,56 @@ namespace
     };
 
 
+    //
+    // Triangle tree construction parameters, read from the parameters of the assembly.
+    //
+
+    enum SplitMethod
+    {
+        SplitMethodExactSAH,                    // exact SAH for small leaves, binned SAH for larger ones
+        SplitMethodBinnedSAH                    // binned SAH for all leaves: faster construction
+    };
+
+    struct TriangleTreeBuildParams
+    {
+        SplitMethod     m_split_method;
+        size_t          m_sah_bin_count;        // number of bins of the binned SAH
+
+        explicit TriangleTreeBuildParams(const ParamArray& params)
+        {
+            const string split_method =
+                params.get_optional<string>("triangle_tree_split_method", "exact_sah");
+
+            if (split_method == "exact_sah")
+                m_split_method = SplitMethodExactSAH;
+            else if (split_method == "binned_sah")
+                m_split_method = SplitMethodBinnedSAH;
+            else
+            {
+                RENDERER_LOG_ERROR(
+                    "invalid value \"%s\" for parameter \"triangle_tree_split_method\", "
+                    "using default value \"exact_sah\".",
+                    split_method.c_str());
+                m_split_method = SplitMethodExactSAH;
+            }
+
+            m_sah_bin_count =
+                params.get_optional<size_t>("triangle_tree_sah_bin_count", TriangleTreeApproxSAHBinCount);
+
+            if (m_sah_bin_count < TriangleTreeMinApproxSAHBinCount ||
+                m_sah_bin_count > TriangleTreeMaxApproxSAHBinCount)
+            {
+                RENDERER_LOG_ERROR(
+                    "invalid value \"" FMT_SIZE_T "\" for parameter \"triangle_tree_sah_bin_count\", "
+                    "using default value \"" FMT_SIZE_T "\".",
+                    m_sah_bin_count,
+                    TriangleTreeApproxSAHBinCount);
+                m_sah_bin_count = TriangleTreeApproxSAHBinCount;
+            }
+        }
+    };
+
+
     //
     // Intermediate triangle leaf splitter.
     //
@@ -166,9 +239,11 @@ namespace
         // Constructor.
         IntermTriangleLeafSplitter(
             const TriangleInfoVector&               triangle_infos,
-            const GAABB3Vector&                     triangle_bboxes)
+            const GAABB3Vector&                     triangle_bboxes,
+            const TriangleTreeBuildParams&          build_params)
           : m_triangle_infos(triangle_infos)
           , m_triangle_bboxes(triangle_bboxes)
+          , m_build_params(build_params)
         {
             // Precompute 1/exp(i).
             for (size_t i = 0; i < TriangleTreeMaxDepth; ++i)
@@ -178,6 +253,16 @@ namespace
                 m_tracer.reset(new Tracer());
         }
 
+        // Create a new splitter with the same settings as this one.
+        IntermTriangleLeafSplitter* clone() const
+        {
+            return
+                new IntermTriangleLeafSplitter(
+                    m_triangle_infos,
+                    m_triangle_bboxes,
+                    m_build_params);
+        }
+
         // Return the splitting priority of a leaf.
         double get_priority(
             const IntermTriangleLeaf&               leaf,
@@ -198,14 +283,15 @@ namespace
             const size_t triangle_count = leaf.get_size();
             assert(triangle_count > 0);
 
-            if (triangle_count <= TriangleTreeO2Threshold)
+            if (triangle_count <= TriangleTreeO2Threshold &&
+                m_build_params.m_split_method == SplitMethodExactSAH)
             {
                 // Small leaf: use an exact SAH function.
                 return exact_sah_split(leaf, leaf_info, split);
             }
             else if (triangle_count <= TriangleTreeO1Threshold)
             {
-                // Medium leaf: use an approximate SAH function.
+                // Medium leaf, or binned SAH requested: use an approximate SAH function.
                 return approximate_sah_split(leaf, leaf_info, split);
             }
             else
@@ -470,14 +556,15 @@ namespace
 
         typedef ApproxSAHFunction<
             GScalar,
-            TriangleTreeApproxSAHBinCount
+            TriangleTreeMaxApproxSAHBinCount
         > ApproxSAHFunc;
 
-        const TriangleInfoVector&   m_triangle_infos;
-        const GAABB3Vector&         m_triangle_bboxes;
-        double                      m_rcp_exp_depth[TriangleTreeMaxDepth];
-        ExactSAHFunction<GScalar>   m_exact_sah_function;
-        auto_ptr<Tracer>            m_tracer;
+        const TriangleInfoVector&       m_triangle_infos;
+        const GAABB3Vector&             m_triangle_bboxes;
+        const TriangleTreeBuildParams   m_build_params;
+        double                          m_rcp_exp_depth[TriangleTreeMaxDepth];
+        ExactSAHFunction<GScalar>       m_exact_sah_function;
+        auto_ptr<Tracer>                m_tracer;
 
         // Find a split using an exact SAH function.
         bool exact_sah_split(
@@ -571,7 +658,8 @@ namespace
             // Build the SAH function.
             ApproxSAHFunc approx_sah_function(
                 leaf_bbox.min[dim],
-                leaf_bbox.max[dim]);
+                leaf_bbox.max[dim],
+                m_build_params.m_sah_bin_count);
             for (size_t i = 0; i < triangle_count; ++i)
             {
                 const size_t triangle_index = leaf.get_triangle(i);
@@ -593,9 +681,10 @@ namespace
 
 #else
 
-            ApproxSAHFunc sah_func_x(leaf_bbox.min[0], leaf_bbox.max[0]);
-            ApproxSAHFunc sah_func_y(leaf_bbox.min[1], leaf_bbox.max[1]);
-            ApproxSAHFunc sah_func_z(leaf_bbox.min[2], leaf_bbox.max[2]);
+            const size_t bin_count = m_build_params.m_sah_bin_count;
+            ApproxSAHFunc sah_func_x(leaf_bbox.min[0], leaf_bbox.max[0], bin_count);
+            ApproxSAHFunc sah_func_y(leaf_bbox.min[1], leaf_bbox.max[1], bin_count);
+            ApproxSAHFunc sah_func_z(leaf_bbox.min[2], leaf_bbox.max[2], bin_count);
 
             // Build the SAH functions over all three axes.
             for (size_t i = 0; i < triangle_count; ++i)
@@ -694,7 +783,7 @@ namespace
 
     class IntermTriangleTree;
 
-    typedef bsp::Builder<
+    typedef bsp::ParallelBuilder<
         IntermTriangleTree,
         IntermTriangleLeafFactory,
         IntermTriangleLeafSplitter
@@ -719,12 +808,9 @@ namespace
       : public bsp::Tree<GScalar, 3, IntermTriangleLeaf>
     {
       public:
-        // Constructor, builds the tree for a given assembly.
+        // Constructor, collects the triangles of a given assembly.
         explicit IntermTriangleTree(const TriangleTree::Arguments& arguments)
         {
-            // Create the leaf factory.
-            IntermTriangleLeafFactory factory(m_triangle_bboxes);
-
             // Collect all triangles for this tree.
             const size_t region_count = arguments.m_regions.size();
             for (size_t region_index = 0; region_index < region_count; ++region_index)
@@ -795,6 +881,55 @@ namespace
                     }
                 }
             }
+        }
+
+        // Compute a key identifying the tree that build() would produce.
+        uint64 compute_key(
+            const TriangleTree::Arguments&  arguments,
+            const TriangleTreeBuildParams&  build_params) const
+        {
+            // Hash the construction settings.
+            const uint32 scalar_size = sizeof(GScalar);
+            uint64 h = hash_bytes64(&TriangleTreeCacheFormatVersion, sizeof(TriangleTreeCacheFormatVersion));
+            h = hash_bytes64(&scalar_size, sizeof(scalar_size), h);
+            h = hash_bytes64(&TriangleTreeMaxDuplication, sizeof(TriangleTreeMaxDuplication), h);
+            h = hash_integer(TriangleTreeMaxLeafSize, h);
+            h = hash_integer(TriangleTreeMaxDepth, h);
+            h = hash_bytes64(&TriangleTreeLeafCostMultiplier, sizeof(TriangleTreeLeafCostMultiplier), h);
+            h = hash_integer(TriangleTreeO1Threshold, h);
+            h = hash_integer(TriangleTreeO2Threshold, h);
+            h = hash_integer(TriangleTreeSubtreeDepth, h);
+            h = hash_integer(TriangleTreeMinLeafPageSize, h);
+            h = hash_integer(static_cast<size_t>(build_params.m_split_method), h);
+            h = hash_integer(build_params.m_sah_bin_count, h);
+
+            // Hash the bounding box of the tree.
+            h = hash_bytes64(&arguments.m_bbox.min[0], 3 * sizeof(GScalar), h);
+            h = hash_bytes64(&arguments.m_bbox.max[0], 3 * sizeof(GScalar), h);
+
+            // Hash the triangles.
+            const size_t triangle_count = m_triangle_infos.size();
+            h = hash_integer(triangle_count, h);
+            for (size_t i = 0; i < triangle_count; ++i)
+            {
+                const TriangleInfo& triangle_info = m_triangle_infos[i];
+                h = hash_integer(triangle_info.get_object_instance_index(), h);
+                h = hash_integer(triangle_info.get_region_index(), h);
+                h = hash_integer(triangle_info.get_triangle_index(), h);
+                for (size_t j = 0; j < 3; ++j)
+                    h = hash_bytes64(&triangle_info.get_vertex(j)[0], 3 * sizeof(GScalar), h);
+            }
+
+            return h;
+        }
+
+        // Build the tree.
+        void build(
+            const TriangleTree::Arguments&  arguments,
+            const TriangleTreeBuildParams&  build_params)
+        {
+            // Create the leaf factory.
+            IntermTriangleLeafFactory factory(m_triangle_bboxes);
 
             const size_t triangle_count = m_triangle_infos.size();
 
@@ -811,8 +946,20 @@ namespace
                 root_leaf->insert(i);
 
             // Build the triangle tree.
-            IntermTriangleLeafSplitter splitter(m_triangle_infos, m_triangle_bboxes);
-            IntermTriangleTreeBuilder builder;
+            IntermTriangleLeafSplitter splitter(
+                m_triangle_infos,
+                m_triangle_bboxes,
+                build_params);
+            // The calling thread is not part of the thread budget: only acquire the others.
+            const ThreadBudgetReservation helper_threads(
+                get_tree_construction_thread_budget(),
+                TriangleTreeParallelConstruction && !TriangleTreeTraceConstruction
+                    ? System::get_logical_cpu_core_count() - 1
+                    : 0);
+            IntermTriangleTreeBuilder builder(
+                global_logger(),
+                1 + helper_threads.get_thread_count(),
+                TriangleTreeMinParallelSplitSize);
             builder.build(
                 *this,
                 root_leaf,
@@ -871,6 +1018,48 @@ namespace
     };
 
 
+    //
+    // Triangle tree cache files.
+    //
+    // A cache file holds the final representation of a triangle tree, in native
+    // byte order. All sections are 8-byte aligned so that the file can be mapped
+    // into memory:
+    //
+    //   header              TriangleTreeCacheHeader
+    //   nodes               node_count x TriangleTree::NodeType
+    //   page sizes          page_count x uint64 (in 4-byte words)
+    //   leaf locations      leaf_count x (uint32 page index, uint32 word offset)
+    //   leaf pages          page_count pages of 4-byte words, back to back
+    //
+
+    const char TriangleTreeCacheMagic[8] = { 'A', 'S', 'T', 'R', 'I', 'T', 'R', 'E' };
+
+    struct TriangleTreeCacheHeader
+    {
+        char        m_magic[8];
+        uint32      m_version;
+        uint32      m_scalar_size;
+        uint64      m_key;
+        uint64      m_node_count;
+        uint64      m_leaf_count;
+        uint64      m_page_count;
+        GScalar     m_bbox_min[3];
+        GScalar     m_bbox_max[3];
+    };
+
+    string get_cache_file_path(const string& cache_path, const uint64 key)
+    {
+        static const char Digits[] = "0123456789abcdef";
+
+        string filename = "triangletree-";
+        for (int shift = 60; shift >= 0; shift -= 4)
+            filename += Digits[(key >> shift) & 15];
+        filename += ".bin";
+
+        return (filesystem::path(cache_path) / filename).string();
+    }
+
+
     //
     // TriangleLeaf packer.
     //
@@ -1062,20 +1251,48 @@ TriangleTree::Arguments::Arguments(
     const UniqueID          triangle_tree_uid,
     const GAABB3&           bbox,
     const Assembly&         assembly,
-    const RegionInfoVector& regions)
+    const RegionInfoVector& regions,
+    const string&           cache_path)
   : m_triangle_tree_uid(triangle_tree_uid)
   , m_bbox(bbox)
   , m_assembly(assembly)
   , m_regions(regions)
+  , m_cache_path(cache_path)
 {
 }
 
 TriangleTree::TriangleTree(const Arguments& arguments)
   : m_triangle_tree_uid(arguments.m_triangle_tree_uid)
 {
-    // Build the intermediate representation of the tree.
+    FOUNDATION_PROFILE_ZONE("TriangleTree::build");
+
+    // Collect the triangles of the tree.
     IntermTriangleTree interm_tree(arguments);
 
+    // Retrieve the construction parameters of the tree.
+    const TriangleTreeBuildParams build_params(arguments.m_assembly.get_parameters());
+
+    // Attempt to load the tree from the cache.
+    uint64 key = 0;
+    string cache_file_path;
+    if (!arguments.m_cache_path.empty())
+    {
+        key = interm_tree.compute_key(arguments, build_params);
+        cache_file_path = get_cache_file_path(arguments.m_cache_path, key);
+
+        if (load(cache_file_path, key))
+        {
+            RENDERER_LOG_INFO(
+                "loaded triangle bsp tree #" FMT_UNIQUE_ID " from %s.",
+                m_triangle_tree_uid,
+                cache_file_path.c_str());
+            return;
+        }
+    }
+
+    // Build the intermediate representation of the tree.
+    interm_tree.build(arguments, build_params);
+
     // Copy tree bounding box.
     m_bbox = interm_tree.m_bbox;
 
@@ -1143,9 +1360,29 @@ TriangleTree::TriangleTree(const Arguments& arguments)
 
         // Store the page into the page array.
         m_leaf_page_array.push_back(page);
+        m_leaf_page_sizes.push_back(page_size);
 
         begin = end;
     }
+
+    // Store the tree into the cache.
+    if (!cache_file_path.empty())
+    {
+        if (save(cache_file_path, key))
+        {
+            RENDERER_LOG_INFO(
+                "wrote triangle bsp tree #" FMT_UNIQUE_ID " to %s.",
+                m_triangle_tree_uid,
+                cache_file_path.c_str());
+        }
+        else
+        {
+            RENDERER_LOG_WARNING(
+                "failed to write triangle bsp tree #" FMT_UNIQUE_ID " to %s.",
+                m_triangle_tree_uid,
+                cache_file_path.c_str());
+        }
+    }
 }
 
 TriangleTree::~TriangleTree()
@@ -1160,11 +1397,241 @@ TriangleTree::~TriangleTree()
     // to delete each leaf individually, which is incorrect in this case
     // because leaves are really just pointers into pages of memory, and
     // thus cannot be deleted individually.
+    delete_leaves();
+}
+
+void TriangleTree::delete_leaves()
+{
     m_leaves.clear();
 
     // Delete the pages.
     for (size_t i = 0; i < m_leaf_page_array.size(); ++i)
         delete [] m_leaf_page_array[i];
+
+    m_leaf_page_array.clear();
+    m_leaf_page_sizes.clear();
+}
+
+bool TriangleTree::load(const string& path, const uint64 key)
+{
+    BufferedFile file;
+    if (!file.open(path.c_str(), BufferedFile::BinaryType, BufferedFile::ReadMode))
+        return false;
+
+    // Read and check the header.
+    TriangleTreeCacheHeader header;
+    if (file.read(header) != sizeof(header) ||
+        memcmp(header.m_magic, TriangleTreeCacheMagic, sizeof(header.m_magic)) != 0 ||
+        header.m_version != TriangleTreeCacheFormatVersion ||
+        header.m_scalar_size != sizeof(GScalar) ||
+        header.m_key != key ||
+        header.m_node_count == 0)
+        return false;
+
+    // Read the tree bounding box.
+    for (size_t i = 0; i < 3; ++i)
+    {
+        m_bbox.min[i] = header.m_bbox_min[i];
+        m_bbox.max[i] = header.m_bbox_max[i];
+    }
+
+    // Read the nodes.
+    const size_t node_count = static_cast<size_t>(header.m_node_count);
+    const size_t nodes_size = node_count * sizeof(NodeType);
+    m_nodes.resize(node_count);
+    if (file.read(&m_nodes[0], nodes_size) != nodes_size)
+    {
+        m_nodes.clear();
+        return false;
+    }
+
+    // Check the nodes. Children are always stored after their parent,
+    // which also guarantees that traversals terminate.
+    const size_t leaf_count = static_cast<size_t>(header.m_leaf_count);
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        const NodeType& node = m_nodes[i];
+
+        const bool valid =
+            node.get_type() == NodeType::Leaf
+                ? node.get_leaf_index() < leaf_count
+                : node.get_child_node_index() > i && node.get_child_node_index() + 1 < node_count;
+
+        if (!valid)
+        {
+            m_nodes.clear();
+            return false;
+        }
+    }
+
+    // Read the page sizes.
+    const size_t page_count = static_cast<size_t>(header.m_page_count);
+    vector<uint64> page_sizes(page_count);
+    const size_t page_sizes_size = page_count * sizeof(uint64);
+    if (page_count > 0 && file.read(&page_sizes[0], page_sizes_size) != page_sizes_size)
+    {
+        m_nodes.clear();
+        return false;
+    }
+
+    // Read the leaf locations.
+    vector<uint32> leaf_locations(2 * leaf_count);
+    const size_t leaf_locations_size = leaf_locations.size() * sizeof(uint32);
+    if (leaf_count > 0 && file.read(&leaf_locations[0], leaf_locations_size) != leaf_locations_size)
+    {
+        m_nodes.clear();
+        return false;
+    }
+
+    // Read the leaf pages.
+    for (size_t i = 0; i < page_count; ++i)
+    {
+        const size_t page_size = static_cast<size_t>(page_sizes[i]);
+        uint32* page = new uint32[page_size];
+        m_leaf_page_array.push_back(page);
+        m_leaf_page_sizes.push_back(page_size);
+
+        const size_t page_bytes = page_size * sizeof(uint32);
+        if (file.read(page, page_bytes) != page_bytes)
+        {
+            m_nodes.clear();
+            delete_leaves();
+            return false;
+        }
+    }
+
+    // Point the leaves into the pages.
+    m_leaves.resize(leaf_count);
+    for (size_t i = 0; i < leaf_count; ++i)
+    {
+        const size_t page_index = leaf_locations[i * 2];
+        const size_t offset = leaf_locations[i * 2 + 1];
+
+        if (page_index >= page_count || offset >= m_leaf_page_sizes[page_index])
+        {
+            m_nodes.clear();
+            delete_leaves();
+            return false;
+        }
+
+        m_leaves[i] = m_leaf_page_array[page_index] + offset;
+    }
+
+    return true;
+}
+
+bool TriangleTree::save(const string& path, const uint64 key) const
+{
+    // Find the location of each leaf.
+    const size_t leaf_count = m_leaves.size();
+    const size_t page_count = m_leaf_page_array.size();
+    vector<uint32> leaf_locations(2 * leaf_count);
+    for (size_t i = 0, page_index = 0; i < leaf_count; ++i)
+    {
+        // Leaves are stored in order, from the first page to the last one.
+        while (page_index < page_count &&
+               (m_leaves[i] < m_leaf_page_array[page_index] ||
+                m_leaves[i] >= m_leaf_page_array[page_index] + m_leaf_page_sizes[page_index]))
+            ++page_index;
+
+        if (page_index == page_count)
+            return false;
+
+        leaf_locations[i * 2] = static_cast<uint32>(page_index);
+        leaf_locations[i * 2 + 1] = static_cast<uint32>(m_leaves[i] - m_leaf_page_array[page_index]);
+    }
+
+    // Prepare the header.
+    TriangleTreeCacheHeader header;
+    memcpy(header.m_magic, TriangleTreeCacheMagic, sizeof(header.m_magic));
+    header.m_version = TriangleTreeCacheFormatVersion;
+    header.m_scalar_size = sizeof(GScalar);
+    header.m_key = key;
+    header.m_node_count = m_nodes.size();
+    header.m_leaf_count = leaf_count;
+    header.m_page_count = page_count;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        header.m_bbox_min[i] = m_bbox.min[i];
+        header.m_bbox_max[i] = m_bbox.max[i];
+    }
+
+    // Write to a temporary file first, then rename it, so that other processes
+    // sharing the cache never see a partially written file.
+    const filesystem::path final_path(path);
+    const filesystem::path temp_path(
+        path + "." + to_string(m_triangle_tree_uid) + "." +
+        to_string(DefaultWallclockTimer().read()) + ".tmp");
+
+    try
+    {
+        filesystem::create_directories(final_path.parent_path());
+
+        bool success;
+
+        {
+            BufferedFile file;
+            if (!file.open(temp_path.string().c_str(), BufferedFile::BinaryType, BufferedFile::WriteMode))
+                return false;
+
+            success = file.write(header) == sizeof(header);
+
+            const size_t nodes_size = m_nodes.size() * sizeof(NodeType);
+            success = success && file.write(&m_nodes[0], nodes_size) == nodes_size;
+
+            for (size_t i = 0; i < page_count; ++i)
+            {
+                const uint64 page_size = m_leaf_page_sizes[i];
+                success = success && file.write(page_size) == sizeof(page_size);
+            }
+
+            const size_t leaf_locations_size = leaf_locations.size() * sizeof(uint32);
+            if (leaf_count > 0)
+                success = success && file.write(&leaf_locations[0], leaf_locations_size) == leaf_locations_size;
+
+            for (size_t i = 0; i < page_count; ++i)
+            {
+                const size_t page_bytes = m_leaf_page_sizes[i] * sizeof(uint32);
+                success = success && file.write(m_leaf_page_array[i], page_bytes) == page_bytes;
+            }
+
+            success = file.close() && success;
+        }
+
+        if (success)
+        {
+#ifdef _WIN32
+            // Renaming onto an existing file fails on Windows.
+            filesystem::remove(final_path);
+#endif
+            filesystem::rename(temp_path, final_path);
+        }
+        else filesystem::remove(temp_path);
+
+        return success;
+    }
+    catch (const filesystem::filesystem_error&)
+    {
+        // Don't leave the temporary file behind.
+        boost::system::error_code ec;
+        filesystem::remove(temp_path, ec);
+        return false;
+    }
+}
+
+
+//
+// Tree construction thread budget.
+//
+
+namespace
+{
+    ThreadBudget g_tree_construction_thread_budget(System::get_logical_cpu_core_count());
+}
+
+ThreadBudget& get_tree_construction_thread_budget()
+{
+    return g_tree_construction_thread_budget;
 }
 
 
@@ -1255,6 +1722,108 @@ void TriangleLeafVisitor::read_hit_triangle_data() const
 }
 
 
+//
+// TriangleLeafPacketVisitor class implementation.
+//
+
+TriangleLeafPacketVisitor::TriangleLeafPacketVisitor(ShadingPoint shading_points[])
+  : m_shading_points(shading_points)
+{
+    for (size_t i = 0; i < RayPacketSize; ++i)
+    {
+        m_packet.set(i, m_shading_points[i].m_ray);
+        m_triangle_ptr[i] = 0;
+    }
+}
+
+void TriangleLeafPacketVisitor::visit(
+    const TriangleLeaf*             leaf,
+    const ShadingRay::RayType       /*rays*/[],
+    const ShadingRay::RayInfoType   /*ray_infos*/[],
+    const uint32                    ray_mask,
+    double                          distances[])
+{
+    assert(leaf);
+
+    // Size, in 4-byte words, of one triangle.
+    const size_t TriangleSize = sizeof(GTriangleType) / sizeof(uint32);
+
+    // Start reading at the beginning of the hot section of the leaf.
+    const uint32* ptr = leaf;
+
+    // Read the number of triangles in the leaf.
+    const uint32 triangle_count = *ptr++;
+    assert(triangle_count > 0);
+
+    // Sequentially intersect all triangles of this leaf.
+    size_t i = triangle_count;
+    do
+    {
+        // Read the object instance index.
+        const uint32 object_instance_index = *ptr++;
+
+        // todo: check object instance flags.
+
+        // Read the triangle geometry.
+        const TriangleGeometryReader reader(ptr);
+
+        // Intersect the triangle with all the rays of the packet at once.
+        double t[RayPacketSize], u[RayPacketSize], v[RayPacketSize];
+        const uint32 hit_mask = reader.m_triangle.intersect(m_packet, ray_mask, t, u, v);
+
+        if (hit_mask)
+        {
+            for (size_t r = 0; r < RayPacketSize; ++r)
+            {
+                if (!(hit_mask & (1UL << r)))
+                    continue;
+
+                ShadingPoint& shading_point = m_shading_points[r];
+                m_triangle_ptr[r] = ptr;
+                m_cold_data_index[r] = 2 * triangle_count + i * (TriangleSize - 1) - 1;
+                m_packet.m_tmax[r] = t[r];
+                shading_point.m_ray.m_tmax = t[r];
+                shading_point.m_hit = true;
+                shading_point.m_bary[0] = u[r];
+                shading_point.m_bary[1] = v[r];
+                shading_point.m_object_instance_index = static_cast<size_t>(object_instance_index);
+            }
+        }
+
+        // Next triangle.
+        ptr += TriangleSize;
+    }
+    while (--i);
+
+    // Return the distance to the closest intersection so far.
+    for (size_t r = 0; r < RayPacketSize; ++r)
+    {
+        if (ray_mask & (1UL << r))
+            distances[r] = m_shading_points[r].m_ray.m_tmax;
+    }
+}
+
+void TriangleLeafPacketVisitor::read_hit_triangle_data() const
+{
+    for (size_t i = 0; i < RayPacketSize; ++i)
+    {
+        if (m_triangle_ptr[i])
+        {
+            ShadingPoint& shading_point = m_shading_points[i];
+
+            // Compute and store the support plane of the hit triangle.
+            const TriangleGeometryReader reader(m_triangle_ptr[i]);
+            shading_point.m_triangle_support_plane.initialize(reader.m_triangle);
+
+            // Read region and triangle indices.
+            const uint32* cold_data_ptr = m_triangle_ptr[i] + m_cold_data_index[i];
+            shading_point.m_region_index = static_cast<size_t>(cold_data_ptr[0]);
+            shading_point.m_triangle_index = static_cast<size_t>(cold_data_ptr[1]);
+        }
+    }
+}
+
+
 //
 // TriangleLeafProbeVisitor class implementation.
 //
@@ -38,16 +38,19 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/bsp.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/poolallocator.h"
 
 // Standard headers.
 #include <map>
+#include <string>
 #include <vector>
 
 // Forward declarations.
-namespace renderer  { class Assembly; }
-namespace renderer  { class ShadingPoint; }
+namespace foundation    { class ThreadBudget; }
+namespace renderer      { class Assembly; }
+namespace renderer      { class ShadingPoint; }
 
 namespace renderer
 {
@@ -74,16 +77,19 @@ class TriangleTree
         const GAABB3                    m_bbox;
         const Assembly&                 m_assembly;
         const RegionInfoVector          m_regions;
+        const std::string               m_cache_path;       // cache directory, or empty to disable caching
 
         // Constructor.
         Arguments(
             const foundation::UniqueID  triangle_tree_uid,
             const GAABB3&               bbox,
             const Assembly&             assembly,
-            const RegionInfoVector&     regions);
+            const RegionInfoVector&     regions,
+            const std::string&          cache_path = std::string());
     };
 
-    // Constructor, builds the tree for a given set of regions.
+    // Constructor, builds the tree for a given set of regions, or loads
+    // it from the cache directory if it was previously built.
     explicit TriangleTree(const Arguments& arguments);
 
     // Destructor.
@@ -92,6 +98,17 @@ class TriangleTree
   private:
     const foundation::UniqueID          m_triangle_tree_uid;
     std::vector<foundation::uint32*>    m_leaf_page_array;
+    std::vector<size_t>                 m_leaf_page_sizes;  // in 4-byte words
+
+    // Delete all leaves and leaf pages.
+    void delete_leaves();
+
+    // Load the tree from a cache file. Return false if the file doesn't
+    // exist, is invalid or doesn't match the given key.
+    bool load(const std::string& path, const foundation::uint64 key);
+
+    // Write the tree to a cache file. Return true on success.
+    bool save(const std::string& path, const foundation::uint64 key) const;
 };
 
 
@@ -115,6 +132,20 @@ class TriangleTreeFactory
 };
 
 
+//
+// Threads shared by all the tree constructions running at the same time,
+// as many as there are logical CPU cores. Every thread that builds a tree
+// in parallel with other trees, or that helps building a tree, should be
+// acquired from this budget.
+//
+// Rendering threads are not part of this budget: a tree built lazily while
+// rendering is in progress may still start as many helper threads as there
+// are cores, on top of the rendering threads.
+//
+
+foundation::ThreadBudget& get_tree_construction_thread_budget();
+
+
 //
 // Some additional types.
 //
@@ -213,6 +244,36 @@ class TriangleLeafVisitor
 };
 
 
+//
+// Triangle leaf visitor for packets of rays, used during packet intersection.
+//
+
+class TriangleLeafPacketVisitor
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. The rays of the packet are the rays of the shading points.
+    explicit TriangleLeafPacketVisitor(ShadingPoint shading_points[]);
+
+    // Visit a leaf.
+    void visit(
+        const TriangleLeaf*             leaf,
+        const ShadingRay::RayType       rays[],
+        const ShadingRay::RayInfoType   ray_infos[],
+        const foundation::uint32        ray_mask,
+        double                          distances[]);
+
+    // Read additional data about the triangles that were hit, if any.
+    void read_hit_triangle_data() const;
+
+  private:
+    ShadingPoint*               m_shading_points;
+    TriangleRayPacketType       m_packet;
+    const foundation::uint32*   m_triangle_ptr[RayPacketSize];
+    size_t                      m_cold_data_index[RayPacketSize];
+};
+
+
 //
 // Triangle leaf visitor for probe rays, only return boolean answers
 // (whether an intersection was found or not).
@@ -246,6 +307,13 @@ typedef foundation::bsp::Intersector<
     TriangleLeafProbeVisitor
 > TriangleLeafProbeIntersector;
 
+typedef foundation::bsp::PacketIntersector<
+    double,
+    TriangleTree,
+    TriangleLeafPacketVisitor,
+    RayPacketSize
+> TriangleLeafPacketIntersector;
+
 
 //
 // TriangleLeafVisitor class implementation.
@@ -287,7 +287,7 @@ void DirectLightingIntegrator::take_single_bsdf_sample(
         const double bsdf_point_prob = bsdf_prob * cos_on / square_distance;
 
         // Compute the probability density wrt. surface area mesure of the light sample.
-        const double light_point_prob = m_light_sampler.evaluate_pdf(light_shading_point);
+        const double light_point_prob = m_light_sampler.evaluate_pdf(m_point, light_shading_point);
 
         // Apply multiply importance sampling.
         weight *=
@@ -315,7 +315,7 @@ void DirectLightingIntegrator::take_single_light_sample(
     const Vector3d s = sampling_context.next_vector2<3>();
 
     LightSample sample;
-    if (!m_light_sampler.sample(s, sample))
+    if (!m_light_sampler.sample(s, m_point, sample))
         return;
 
     SamplingContext child_sampling_context(sampling_context);
@@ -321,8 +321,7 @@ namespace
                 }
 
                 // Update the path radiance.
-                vertex_radiance *= throughput;
-                m_path_radiance += vertex_radiance;
+                madd(m_path_radiance, vertex_radiance, throughput);
                 vertex_aovs *= throughput;
                 m_path_aovs += vertex_aovs;
 
@@ -30,6 +30,7 @@
 #include "lightsampler.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/tessellation/statictessellation.h"
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
@@ -44,6 +45,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionnotimplemented.h"
+#include "foundation/math/aabb.h"
 #include "foundation/math/area.h"
 #include "foundation/math/sampling.h"
 #include "foundation/utility/foreach.h"
@@ -52,6 +54,7 @@
 
 // Standard headers.
 #include <algorithm>
+#include <cmath>
 #include <map>
 
 using namespace foundation;
@@ -106,9 +109,12 @@ LightSampler::LightSampler(const Scene& scene)
     m_light_count = m_lights.size();
     m_rcp_total_emissive_area = 1.0 / m_total_emissive_area;
 
-    // Prepare the CDF for sampling.
-    if (m_light_cdf.valid())
-        m_light_cdf.prepare();
+    // Prepare the emitter table for sampling.
+    if (m_emitter_table.valid())
+        m_emitter_table.prepare();
+
+    // Build the light tree for sampling emitters as seen from a given point.
+    build_light_tree();
 
     RENDERER_LOG_INFO(
         "found %s %s, %s emitting %s.",
@@ -140,8 +146,8 @@ void LightSampler::collect_lights(const AssemblyInstance& assembly_instance)
         // todo: compute importance.
         const double importance = 1.0;
 
-        // Insert the light into the CDF.
-        m_light_cdf.insert(light_index, importance);
+        // Insert the light into the emitter table.
+        m_emitter_table.insert(light_index, importance);
     }
 }
 
@@ -272,26 +278,36 @@ void LightSampler::collect_emitting_triangles(
                     // Create a light-emitting triangle.
                     EmittingTriangle emitting_triangle;
                     emitting_triangle.m_assembly_instance_uid = assembly_instance.get_uid();
-                    emitting_triangle.m_object_instance_index = object_instance_index;
-                    emitting_triangle.m_region_index = region_index;
-                    emitting_triangle.m_triangle_index = triangle_index;
-                    emitting_triangle.m_v0 = v0;
-                    emitting_triangle.m_v1 = v1;
-                    emitting_triangle.m_v2 = v2;
-                    emitting_triangle.m_n0 = side_n0;
-                    emitting_triangle.m_n1 = side_n1;
-                    emitting_triangle.m_n2 = side_n2;
-                    emitting_triangle.m_geometric_normal = side_geometric_normal;
+                    emitting_triangle.m_object_instance_index = static_cast<uint32>(object_instance_index);
+                    emitting_triangle.m_region_index = static_cast<uint32>(region_index);
+                    emitting_triangle.m_triangle_index = static_cast<uint32>(triangle_index);
+                    emitting_triangle.m_rcp_area = static_cast<float>(rcp_area);
+                    emitting_triangle.m_v0 = Vector3f(v0);
+                    emitting_triangle.m_v1 = Vector3f(v1);
+                    emitting_triangle.m_v2 = Vector3f(v2);
+                    emitting_triangle.m_n0 = Vector3f(side_n0);
+                    emitting_triangle.m_n1 = Vector3f(side_n1);
+                    emitting_triangle.m_n2 = Vector3f(side_n2);
+                    emitting_triangle.m_geometric_normal = Vector3f(side_geometric_normal);
                     emitting_triangle.m_triangle_support_plane = triangle_support_plane;
-                    emitting_triangle.m_rcp_area = rcp_area;
                     emitting_triangle.m_edf = material->get_edf();
 
                     // Store the light-emitting triangle.
                     const size_t emitting_triangle_index = m_lights.size() + m_emitting_triangles.size();
                     m_emitting_triangles.push_back(emitting_triangle);
 
-                    // Insert the light-emitting triangle into the CDF.
-                    m_light_cdf.insert(emitting_triangle_index, area);
+                    // Insert the light-emitting triangle into the emitter table.
+                    m_emitter_table.insert(emitting_triangle_index, area);
+
+                    // Record which side of which triangle this emitter is.
+                    EmittingTriangleKey key;
+                    key.m_assembly_instance_uid = emitting_triangle.m_assembly_instance_uid;
+                    key.m_object_instance_index = emitting_triangle.m_object_instance_index;
+                    key.m_region_index = emitting_triangle.m_region_index;
+                    key.m_triangle_index = emitting_triangle.m_triangle_index;
+                    key.m_side = static_cast<uint32>(side);
+                    key.m_emitter_index = static_cast<uint32>(emitting_triangle_index);
+                    m_emitting_triangle_keys.push_back(key);
 
                     // Keep track of the total area of the light-emitting triangles.
                     m_total_emissive_area += area;
@@ -301,12 +317,80 @@ void LightSampler::collect_emitting_triangles(
     }
 }
 
+bool LightSampler::EmittingTriangleKey::operator<(const EmittingTriangleKey& rhs) const
+{
+    if (m_assembly_instance_uid != rhs.m_assembly_instance_uid)
+        return m_assembly_instance_uid < rhs.m_assembly_instance_uid;
+
+    if (m_object_instance_index != rhs.m_object_instance_index)
+        return m_object_instance_index < rhs.m_object_instance_index;
+
+    if (m_region_index != rhs.m_region_index)
+        return m_region_index < rhs.m_region_index;
+
+    if (m_triangle_index != rhs.m_triangle_index)
+        return m_triangle_index < rhs.m_triangle_index;
+
+    return m_side < rhs.m_side;
+}
+
+void LightSampler::build_light_tree()
+{
+    LightTree::EmitterVector emitters;
+    emitters.reserve(m_light_count + m_emitting_triangles.size());
+
+    // Lights are treated as omnidirectional points.
+    for (size_t i = 0; i < m_light_count; ++i)
+    {
+        const Transformd::MatrixType& mat = m_lights[i]->get_transform().get_local_to_parent();
+        const Vector3d position(mat[3], mat[7], mat[11]);
+
+        LightTree::Emitter emitter;
+        emitter.m_bbox = AABB3d(position, position);
+        emitter.m_axis = Vector3d(0.0, 1.0, 0.0);
+        emitter.m_theta_o = Pi;
+        emitter.m_energy = 1.0;     // same importance as in the emitter table
+        emitters.push_back(emitter);
+    }
+
+    // Emitting triangles emit around their geometric normal, within the spread of their vertex normals.
+    for (size_t i = 0; i < m_emitting_triangles.size(); ++i)
+    {
+        const EmittingTriangle& triangle = m_emitting_triangles[i];
+        const Vector3d axis(triangle.m_geometric_normal);
+
+        LightTree::Emitter emitter;
+        emitter.m_bbox.invalidate();
+        emitter.m_bbox.insert(Vector3d(triangle.m_v0));
+        emitter.m_bbox.insert(Vector3d(triangle.m_v1));
+        emitter.m_bbox.insert(Vector3d(triangle.m_v2));
+        emitter.m_axis = axis;
+        emitter.m_theta_o =
+            acos(
+                clamp(
+                    min(
+                        min(
+                            dot(axis, normalize(Vector3d(triangle.m_n0))),
+                            dot(axis, normalize(Vector3d(triangle.m_n1)))),
+                        dot(axis, normalize(Vector3d(triangle.m_n2)))),
+                    -1.0,
+                    1.0));
+        emitter.m_energy = 1.0 / triangle.m_rcp_area;
+        emitters.push_back(emitter);
+    }
+
+    m_light_tree.build(emitters);
+
+    // Allow finding the emitters hit by rays.
+    sort(m_emitting_triangle_keys.begin(), m_emitting_triangle_keys.end());
+}
+
 bool LightSampler::sample(
     const Vector3d&         s,
     LightSample&            sample) const
 {
     // No light source in the scene.
-    if (!m_light_cdf.valid())
+    if (!m_emitter_table.valid())
         return false;
 
     sample_emitters(s, sample);
@@ -314,12 +398,39 @@ bool LightSampler::sample(
     return true;
 }
 
+bool LightSampler::sample(
+    const Vector3d&         s,
+    const Vector3d&         point,
+    LightSample&            sample) const
+{
+    // No light source in the scene.
+    if (m_light_tree.empty())
+        return false;
+
+    // Choose an emitter according to its estimated contribution to the point.
+    const pair<size_t, double> result = m_light_tree.sample(point, s[0]);
+    const size_t emitter_index = result.first;
+    const double emitter_prob = result.second;
+
+    // No emitter can contribute to the point.
+    if (emitter_prob == 0.0)
+        return false;
+
+    sample_emitter(Vector2d(s[1], s[2]), emitter_index, emitter_prob, sample);
+
+    // The probability of choosing a point on an emitting triangle depends on the triangle.
+    if (sample.m_triangle)
+        sample.m_probability = emitter_prob * sample.m_triangle->m_rcp_area;
+
+    return true;
+}
+
 bool LightSampler::sample(
     SamplingContext&        sampling_context,
     LightSample&            sample) const
 {
     // No light source in the scene.
-    if (!m_light_cdf.valid())
+    if (!m_emitter_table.valid())
         return false;
 
     sampling_context.split_in_place(3, 1);
@@ -335,7 +446,7 @@ bool LightSampler::sample(
     LightSampleVector&      samples) const
 {
     // No light source in the scene.
-    if (!m_light_cdf.valid())
+    if (!m_emitter_table.valid())
         return false;
 
     sampling_context.split_in_place(3, sample_count);
@@ -355,16 +466,23 @@ void LightSampler::sample_emitters(
     LightSample&            sample) const
 {
     // Sample the set of emitters (lights and emitting triangles).
-    const LightCDF::ItemWeightPair result = m_light_cdf.sample(s[0]);
-    const size_t emitter_index = result.first;
-    const double emitter_prob = result.second;
+    const EmitterTable::ItemWeightPair result = m_emitter_table.sample(s[0]);
+
+    sample_emitter(Vector2d(s[1], s[2]), result.first, result.second, sample);
+}
 
+void LightSampler::sample_emitter(
+    const Vector2d&         s,
+    const size_t            emitter_index,
+    const double            emitter_prob,
+    LightSample&            sample) const
+{
     // Generate one sample on the chosen emitter.
     if (emitter_index < m_light_count)
     {
         sample.m_triangle = 0;
         sample_light(
-            Vector2d(s[1], s[2]),
+            s,
             emitter_index,
             emitter_prob,
             sample);
@@ -373,7 +491,7 @@ void LightSampler::sample_emitters(
     {
         sample.m_light = 0;
         sample_emitting_triangle(
-            Vector2d(s[1], s[2]),
+            s,
             emitter_index - m_light_count,
             emitter_prob,
             sample);
@@ -421,24 +539,65 @@ void LightSampler::sample_emitting_triangle(
 
     // Compute the world space position of the sample.
     sample.m_input_params.m_point =
-          bary[0] * triangle.m_v0
-        + bary[1] * triangle.m_v1
-        + bary[2] * triangle.m_v2;
+          bary[0] * Vector3d(triangle.m_v0)
+        + bary[1] * Vector3d(triangle.m_v1)
+        + bary[2] * Vector3d(triangle.m_v2);
 
     // Compute the world space shading normal at the position of the sample.
     sample.m_input_params.m_shading_normal =
-          bary[0] * triangle.m_n0
-        + bary[1] * triangle.m_n1
-        + bary[2] * triangle.m_n2;
+          bary[0] * Vector3d(triangle.m_n0)
+        + bary[1] * Vector3d(triangle.m_n1)
+        + bary[2] * Vector3d(triangle.m_n2);
     sample.m_input_params.m_shading_normal =
         normalize(sample.m_input_params.m_shading_normal);
 
     // Set the world space geometric normal.
-    sample.m_input_params.m_geometric_normal = triangle.m_geometric_normal;
+    sample.m_input_params.m_geometric_normal = Vector3d(triangle.m_geometric_normal);
 
     // Compute the probability of choosing this sample.
 //  assert(feq(triangle_prob * triangle.m_rcp_area, m_rcp_total_emissive_area));    // subject to numerical instability
     sample.m_probability = m_rcp_total_emissive_area;
 }
 
+double LightSampler::evaluate_pdf(const ShadingPoint& result) const
+{
+    return evaluate_pdf(result.get_ray().m_org, result);
+}
+
+double LightSampler::evaluate_pdf(
+    const Vector3d&         origin,
+    const ShadingPoint&     result) const
+{
+    //
+    // The probability density of a given light sample is
+    //
+    //   p_sample = p_triangle * p_point
+    //
+    // where p_triangle is the probability of choosing the triangle by traversing
+    // the light tree from the origin of the sample, and the probability density
+    // of a given point on the triangle is
+    //
+    //                  1.0
+    //   p_point = -------------
+    //             triangle area
+    //
+
+    EmittingTriangleKey key;
+    key.m_assembly_instance_uid = result.get_assembly_instance().get_uid();
+    key.m_object_instance_index = static_cast<uint32>(result.get_object_instance_index());
+    key.m_region_index = static_cast<uint32>(result.get_region_index());
+    key.m_triangle_index = static_cast<uint32>(result.get_triangle_index());
+    key.m_side = result.get_side() == ObjectInstance::BackSide ? 1 : 0;
+
+    const EmittingTriangleKeyVector::const_iterator i =
+        lower_bound(m_emitting_triangle_keys.begin(), m_emitting_triangle_keys.end(), key);
+
+    if (i == m_emitting_triangle_keys.end() || key < *i)
+        return 0.0;
+
+    const EmittingTriangle& triangle = m_emitting_triangles[i->m_emitter_index - m_light_count];
+
+    return m_light_tree.evaluate_pdf(origin, i->m_emitter_index) * triangle.m_rcp_area;
+}
+
 }   // namespace renderer
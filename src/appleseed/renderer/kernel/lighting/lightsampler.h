@@ -32,11 +32,14 @@
 // appleseed.renderer headers.
 #include "renderer/global/global.h"
 #include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/lighting/lighttree.h"
 #include "renderer/modeling/input/inputparams.h"
 
 // appleseed.foundation headers.
-#include "foundation/math/cdf.h"
+#include "foundation/math/aliastable.h"
 #include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <vector>
@@ -55,18 +58,22 @@ namespace renderer
 //
 // Light-emitting triangle.
 //
+// Scenes may contain millions of emitting triangles, so vertices and normals
+// are stored in single precision. Only the support plane, used to prevent
+// self-intersections, is kept in double precision.
+//
 
 struct EmittingTriangle
 {
     foundation::UniqueID        m_assembly_instance_uid;
-    size_t                      m_object_instance_index;
-    size_t                      m_region_index;
-    size_t                      m_triangle_index;
-    foundation::Vector3d        m_v0, m_v1, m_v2;               // world space vertices of the triangle
-    foundation::Vector3d        m_n0, m_n1, m_n2;               // world space vertex normals
-    foundation::Vector3d        m_geometric_normal;             // world space geometric normal, unit-length
+    foundation::uint32          m_object_instance_index;
+    foundation::uint32          m_region_index;
+    foundation::uint32          m_triangle_index;
+    float                       m_rcp_area;                     // world space triangle area reciprocal
+    foundation::Vector3f        m_v0, m_v1, m_v2;               // world space vertices of the triangle
+    foundation::Vector3f        m_n0, m_n1, m_n2;               // world space vertex normals
+    foundation::Vector3f        m_geometric_normal;             // world space geometric normal, unit-length
     TriangleSupportPlaneType    m_triangle_support_plane;       // support plane of the triangle in assembly space
-    double                      m_rcp_area;                     // world space triangle area reciprocal
     const EDF*                  m_edf;
 };
 
@@ -108,6 +115,10 @@ class LightSampler
     bool sample(
         const foundation::Vector3d&     s,
         LightSample&                    sample) const;
+    bool sample(
+        const foundation::Vector3d&     s,
+        const foundation::Vector3d&     point,
+        LightSample&                    sample) const;
     bool sample(
         SamplingContext&                sampling_context,
         LightSample&                    sample) const;
@@ -116,13 +127,31 @@ class LightSampler
         const size_t                    sample_count,
         LightSampleVector&              samples) const;
 
-    // Compute the probability density in area measure of a given light sample.
+    // Compute the probability density in area measure of a given light sample,
+    // as chosen from the origin of the ray that hit it, or from a given point.
     double evaluate_pdf(const ShadingPoint& result) const;
+    double evaluate_pdf(
+        const foundation::Vector3d&     origin,
+        const ShadingPoint&             result) const;
 
   private:
     typedef std::vector<const Light*> LightVector;
     typedef std::vector<EmittingTriangle> EmittingTriangleVector;
-    typedef foundation::CDF<size_t, double> LightCDF;
+    typedef foundation::AliasTable<size_t, double> EmitterTable;
+
+    struct EmittingTriangleKey
+    {
+        foundation::UniqueID    m_assembly_instance_uid;
+        foundation::uint32      m_object_instance_index;
+        foundation::uint32      m_region_index;
+        foundation::uint32      m_triangle_index;
+        foundation::uint32      m_side;
+        foundation::uint32      m_emitter_index;
+
+        bool operator<(const EmittingTriangleKey& rhs) const;
+    };
+
+    typedef std::vector<EmittingTriangleKey> EmittingTriangleKeyVector;
 
     LightVector                 m_lights;
     size_t                      m_light_count;
@@ -131,7 +160,12 @@ class LightSampler
     double                      m_total_emissive_area;
     double                      m_rcp_total_emissive_area;
 
-    LightCDF                    m_light_cdf;
+    EmitterTable                m_emitter_table;            // point-independent emitter selection
+    LightTree                   m_light_tree;               // emitter selection as seen from a given point
+    EmittingTriangleKeyVector   m_emitting_triangle_keys;   // sorted, to find hit triangles in m_light_tree
+
+    // Build the light tree and the lookup table of emitting triangles.
+    void build_light_tree();
 
     // Collect all lights from a given scene.
     void collect_lights(const Scene& scene);
@@ -152,6 +186,13 @@ class LightSampler
         const foundation::Vector3d&     s,
         LightSample&                    sample) const;
 
+    // Sample a given emitter.
+    void sample_emitter(
+        const foundation::Vector2d&     s,
+        const size_t                    emitter_index,
+        const double                    emitter_prob,
+        LightSample&                    sample) const;
+
     // Sample a given light.
     void sample_light(
         const foundation::Vector2d&     s,
@@ -174,32 +215,7 @@ class LightSampler
 
 inline bool LightSampler::has_lights() const
 {
-    return m_light_cdf.valid();
-}
-
-inline double LightSampler::evaluate_pdf(const ShadingPoint& /*result*/) const
-{
-    //
-    // The probability density of a given triangle is
-    //
-    //                   triangle area
-    //   p_triangle = -------------------
-    //                total emissive area
-    //
-    // The probability density of a given point on a given triangle is
-    //
-    //                  1.0
-    //   p_point = -------------
-    //             triangle area
-    //
-    // The probability density of a given light sample is thus
-    //
-    //                                             1.0
-    //   p_sample = p_triangle * p_point = -------------------
-    //                                     total emissive area
-    //
-
-    return m_rcp_total_emissive_area;
+    return m_emitter_table.valid();
 }
 
 }       // namespace renderer
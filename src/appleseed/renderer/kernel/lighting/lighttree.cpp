@@ -0,0 +1,337 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "lighttree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#include "foundation/utility/memory.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // A cone of directions, as used to bound the emission directions of a set of emitters.
+    //
+
+    struct Cone
+    {
+        Vector3d    m_axis;
+        double      m_theta_o;
+
+        Cone() {}
+
+        Cone(const Vector3d& axis, const double theta_o)
+          : m_axis(axis)
+          , m_theta_o(theta_o)
+        {
+        }
+    };
+
+    // Return the smallest cone (approximately) enclosing two cones.
+    Cone merge(const Cone& lhs, const Cone& rhs)
+    {
+        const Cone& a = lhs.m_theta_o >= rhs.m_theta_o ? lhs : rhs;
+        const Cone& b = lhs.m_theta_o >= rhs.m_theta_o ? rhs : lhs;
+
+        const double theta_d = acos(clamp(dot(a.m_axis, b.m_axis), -1.0, 1.0));
+
+        // The wider cone already encloses the other one.
+        if (min(theta_d + b.m_theta_o, Pi) <= a.m_theta_o)
+            return a;
+
+        const double theta_o = 0.5 * (a.m_theta_o + theta_d + b.m_theta_o);
+
+        if (theta_o >= Pi)
+            return Cone(a.m_axis, Pi);
+
+        // Rotate the axis of the wider cone toward the axis of the other cone.
+        const Vector3d k = cross(a.m_axis, b.m_axis);
+        const double k_norm = norm(k);
+
+        // The axes are opposite: any axis orthogonal to them would do but the
+        // resulting cone would cover nearly the whole sphere anyway.
+        if (k_norm < 1.0e-9)
+            return Cone(a.m_axis, Pi);
+
+        const double theta_r = theta_o - a.m_theta_o;
+        const Vector3d axis =
+              a.m_axis * cos(theta_r)
+            + cross(k / k_norm, a.m_axis) * sin(theta_r);
+
+        return Cone(normalize(axis), theta_o);
+    }
+
+    struct CentroidOrder
+    {
+        const LightTree::EmitterVector& m_emitters;
+        const size_t                    m_dim;
+
+        CentroidOrder(
+            const LightTree::EmitterVector& emitters,
+            const size_t                    dim)
+          : m_emitters(emitters)
+          , m_dim(dim)
+        {
+        }
+
+        bool operator()(const uint32 lhs, const uint32 rhs) const
+        {
+            return
+                m_emitters[lhs].m_bbox.center()[m_dim] <
+                m_emitters[rhs].m_bbox.center()[m_dim];
+        }
+    };
+}
+
+
+//
+// LightTree class implementation.
+//
+
+void LightTree::build(const EmitterVector& emitters)
+{
+    clear_release_memory(m_nodes);
+    clear_release_memory(m_emitter_leaves);
+
+    const size_t emitter_count = emitters.size();
+
+    if (emitter_count == 0)
+        return;
+
+    IndexVector indices(emitter_count);
+    for (size_t i = 0; i < emitter_count; ++i)
+        indices[i] = static_cast<uint32>(i);
+
+    m_nodes.reserve(2 * emitter_count - 1);
+    m_emitter_leaves.resize(emitter_count);
+
+    build_node(emitters, indices, 0, emitter_count, ~0);
+}
+
+size_t LightTree::get_memory_size() const
+{
+    return
+          sizeof(*this)
+        + m_nodes.capacity() * sizeof(Node)
+        + m_emitter_leaves.capacity() * sizeof(uint32);
+}
+
+pair<size_t, double> LightTree::sample(
+    const Vector3d&     point,
+    const double        s) const
+{
+    assert(!empty());
+    assert(s >= 0.0 && s < 1.0);
+
+    double x = s;
+    double probability = 1.0;
+    size_t node_index = 0;
+
+    while (!m_nodes[node_index].m_is_leaf)
+    {
+        const size_t left_index = node_index + 1;
+        const size_t right_index = m_nodes[node_index].m_index;
+
+        const double left_importance = importance(m_nodes[left_index], point);
+        const double right_importance = importance(m_nodes[right_index], point);
+        const double total_importance = left_importance + right_importance;
+
+        if (total_importance <= 0.0)
+            return make_pair(size_t(0), 0.0);
+
+        const double p_left = left_importance / total_importance;
+
+        if (x < p_left)
+        {
+            x /= p_left;
+            probability *= p_left;
+            node_index = left_index;
+        }
+        else
+        {
+            x = (x - p_left) / (1.0 - p_left);
+            probability *= 1.0 - p_left;
+            node_index = right_index;
+        }
+
+        // Guard against x reaching 1 due to rounding.
+        x = min(x, 0.99999999999999989);
+    }
+
+    return make_pair(static_cast<size_t>(m_nodes[node_index].m_index), probability);
+}
+
+double LightTree::evaluate_pdf(
+    const Vector3d&     point,
+    const size_t        emitter_index) const
+{
+    assert(emitter_index < m_emitter_leaves.size());
+
+    double probability = 1.0;
+    size_t node_index = m_emitter_leaves[emitter_index];
+
+    while (node_index != 0)
+    {
+        const size_t parent_index = m_nodes[node_index].m_parent;
+        const size_t left_index = parent_index + 1;
+        const size_t right_index = m_nodes[parent_index].m_index;
+
+        const double left_importance = importance(m_nodes[left_index], point);
+        const double right_importance = importance(m_nodes[right_index], point);
+        const double total_importance = left_importance + right_importance;
+
+        if (total_importance <= 0.0)
+            return 0.0;
+
+        probability *=
+            (node_index == left_index ? left_importance : right_importance) / total_importance;
+
+        node_index = parent_index;
+    }
+
+    return probability;
+}
+
+size_t LightTree::build_node(
+    const EmitterVector&    emitters,
+    IndexVector&            indices,
+    const size_t            begin,
+    const size_t            end,
+    const size_t            parent)
+{
+    assert(begin < end);
+
+    // Compute the bounds and the energy of the emitters in this node.
+    AABB3d bbox;
+    bbox.invalidate();
+    Cone cone(emitters[indices[begin]].m_axis, emitters[indices[begin]].m_theta_o);
+    double energy = 0.0;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const Emitter& emitter = emitters[indices[i]];
+        bbox.insert(emitter.m_bbox);
+        cone = merge(cone, Cone(emitter.m_axis, emitter.m_theta_o));
+        energy += emitter.m_energy;
+    }
+
+    const size_t node_index = m_nodes.size();
+    m_nodes.push_back(Node());
+
+    Node& node = m_nodes.back();
+    node.m_bbox = AABB3f(bbox);
+    node.m_axis = Vector3f(cone.m_axis);
+    node.m_theta_o = static_cast<float>(cone.m_theta_o);
+    node.m_energy = static_cast<float>(energy);
+    node.m_parent = static_cast<uint32>(parent);
+
+    if (end - begin == 1)
+    {
+        node.m_index = indices[begin];
+        node.m_is_leaf = 1;
+        m_emitter_leaves[indices[begin]] = static_cast<uint32>(node_index);
+        return node_index;
+    }
+
+    m_nodes[node_index].m_is_leaf = 0;
+
+    // Split the emitters in two halves along the longest axis of the node.
+    const size_t dim = max_index(bbox.extent());
+    const size_t middle = (begin + end) / 2;
+    nth_element(
+        indices.begin() + begin,
+        indices.begin() + middle,
+        indices.begin() + end,
+        CentroidOrder(emitters, dim));
+
+    // The left child immediately follows its parent.
+    build_node(emitters, indices, begin, middle, node_index);
+    const size_t right_index = build_node(emitters, indices, middle, end, node_index);
+
+    // Don't keep a reference to the node: m_nodes may have been reallocated.
+    m_nodes[node_index].m_index = static_cast<uint32>(right_index);
+
+    return node_index;
+}
+
+double LightTree::importance(
+    const Node&         node,
+    const Vector3d&     point) const
+{
+    const AABB3d bbox(node.m_bbox);
+    const Vector3d center = bbox.center();
+    const Vector3d to_point = point - center;
+
+    const double square_dist = square_norm(to_point);
+    const double square_radius = 0.25 * square_norm(bbox.extent());
+    const double energy = static_cast<double>(node.m_energy);
+
+    // Keep the importance of point-like nodes bounded.
+    const double MinSquareDist = 1.0e-6;
+
+    // The point is inside the bounding sphere of the node: any orientation is possible.
+    if (square_dist <= square_radius)
+        return energy / max(square_radius, MinSquareDist);
+
+    const double theta_o = static_cast<double>(node.m_theta_o);
+
+    if (theta_o < HalfPi)
+    {
+        // Angle subtended by the bounding sphere of the node, as seen from the point.
+        const double theta_b = asin(min(sqrt(square_radius / square_dist), 1.0));
+
+        // Angle between the emission axis and the direction toward the point.
+        const Vector3d axis(node.m_axis);
+        const double cos_theta_w = dot(axis, to_point) / sqrt(square_dist);
+        const double theta_w = acos(clamp(cos_theta_w, -1.0, 1.0));
+
+        // Smallest possible angle between an emission direction and the point.
+        const double theta = max(theta_w - theta_o - theta_b, 0.0);
+
+        if (theta >= HalfPi)
+            return 0.0;
+
+        return energy * cos(theta) / max(square_dist, MinSquareDist);
+    }
+
+    return energy / max(square_dist, MinSquareDist);
+}
+
+}   // namespace renderer
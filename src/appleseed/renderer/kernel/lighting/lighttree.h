@@ -0,0 +1,146 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A bounding volume hierarchy over light emitters, where each node bounds the
+// positions of its emitters with a box and their emission directions with a cone.
+//
+// An emitter is chosen by traversing the tree from the root and picking a child
+// with a probability proportional to its estimated contribution to a given point,
+// which takes into account the energy of the child, its distance to the point and
+// its orientation relative to the point.
+//
+// Emitters are assumed to emit light in the hemisphere around each direction of
+// their cone (as diffuse emitters do). Omnidirectional emitters use a cone with
+// an aperture of Pi.
+//
+// Reference:
+//
+//   Importance Sampling of Many Lights with Adaptive Tree Splitting
+//   Alejandro Conty Estevez, Christopher Kulla
+//   http://www.aconty.com/pdf/many-lights-hpg2018.pdf
+//
+
+class LightTree
+  : public foundation::NonCopyable
+{
+  public:
+    struct Emitter
+    {
+        foundation::AABB3d          m_bbox;                 // world space bounding box
+        foundation::Vector3d        m_axis;                 // world space emission axis, unit-length
+        double                      m_theta_o;              // angle in [0, Pi] bounding the normals around the axis
+        double                      m_energy;               // nonnegative importance of the emitter
+    };
+
+    typedef std::vector<Emitter> EmitterVector;
+
+    // Build the tree. Any previous content is discarded.
+    void build(const EmitterVector& emitters);
+
+    // Return true if the tree contains no emitter.
+    bool empty() const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+    // Choose an emitter as seen from a given point. s is in [0,1).
+    // Return the index of the emitter and the probability of choosing it,
+    // or a probability of zero if no emitter can contribute to the point.
+    std::pair<size_t, double> sample(
+        const foundation::Vector3d& point,
+        const double                s) const;
+
+    // Return the probability of choosing a given emitter as seen from a given point.
+    double evaluate_pdf(
+        const foundation::Vector3d& point,
+        const size_t                emitter_index) const;
+
+  private:
+    // Interior nodes have their left child right after them and store the index
+    // of their right child; leaves store the index of their single emitter.
+    struct Node
+    {
+        foundation::AABB3f          m_bbox;
+        foundation::Vector3f        m_axis;
+        float                       m_theta_o;
+        float                       m_energy;
+        foundation::uint32          m_parent;
+        foundation::uint32          m_index;                // right child or emitter index
+        foundation::uint32          m_is_leaf;
+    };
+
+    typedef std::vector<Node> NodeVector;
+    typedef std::vector<foundation::uint32> IndexVector;
+
+    NodeVector                      m_nodes;
+    IndexVector                     m_emitter_leaves;       // emitter index -> leaf node index
+
+    size_t build_node(
+        const EmitterVector&        emitters,
+        IndexVector&                indices,
+        const size_t                begin,
+        const size_t                end,
+        const size_t                parent);
+
+    // Estimate the contribution of the emitters below a node to a given point.
+    double importance(
+        const Node&                 node,
+        const foundation::Vector3d& point) const;
+};
+
+
+//
+// LightTree class implementation.
+//
+
+inline bool LightTree::empty() const
+{
+    return m_nodes.empty();
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_H
@@ -29,25 +29,123 @@
 // Interface header.
 #include "accumulationframebuffer.h"
 
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#include "foundation/utility/profiler.h"
+
+// Standard headers.
+#include <algorithm>
+#include <vector>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
+namespace
+{
+    // Height in pixels of the stripes of the framebuffer.
+    const size_t StripeHeight = 8;
+}
+
 AccumulationFramebuffer::AccumulationFramebuffer(
     const size_t    width,
     const size_t    height)
   : m_width(width)
   , m_height(height)
   , m_pixel_count(width * height)
+  , m_stripe_count(max<size_t>((height + StripeHeight - 1) / StripeHeight, 1))
+  , m_stripe_locks(new StripeLock[m_stripe_count])
 {
 }
 
-void AccumulationFramebuffer::render_to_frame(Frame& frame)
+AccumulationFramebuffer::~AccumulationFramebuffer()
+{
+    delete [] m_stripe_locks;
+}
+
+void AccumulationFramebuffer::store_samples(
+    const size_t    sample_count,
+    const Sample    samples[])
+{
+    if (sample_count == 0)
+        return;
+
+    const double fb_height = static_cast<double>(m_height);
+
+    // Sort the samples by stripe (counting sort).
+    vector<size_t> stripe_indices(sample_count);
+    vector<size_t> stripe_offsets(m_stripe_count + 1, 0);
+
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const size_t y = truncate<size_t>(samples[i].m_position.y * fb_height);
+        const size_t stripe = min(y / StripeHeight, m_stripe_count - 1);
+
+        stripe_indices[i] = stripe;
+        ++stripe_offsets[stripe + 1];
+    }
+
+    for (size_t i = 0; i < m_stripe_count; ++i)
+        stripe_offsets[i + 1] += stripe_offsets[i];
+
+    vector<Sample> sorted_samples(sample_count);
+    vector<size_t> stripe_ends(stripe_offsets.begin(), stripe_offsets.end() - 1);
+
+    for (size_t i = 0; i < sample_count; ++i)
+        sorted_samples[stripe_ends[stripe_indices[i]]++] = samples[i];
+
+    // Store the samples of each stripe while holding the lock of that stripe only.
+    for (size_t i = 0; i < m_stripe_count; ++i)
+    {
+        const size_t begin = stripe_offsets[i];
+        const size_t end = stripe_offsets[i + 1];
+
+        if (begin < end)
+        {
+            Spinlock::ScopedLock lock(m_stripe_locks[i].m_spinlock);
+            store_samples_no_lock(end - begin, &sorted_samples[begin]);
+        }
+    }
+}
+
+void AccumulationFramebuffer::increment_sample_count(const uint64 delta_sample_count)
 {
     Spinlock::ScopedLock lock(m_spinlock);
 
-    develop_to_frame(frame);
+    m_sample_count += delta_sample_count;
+}
+
+void AccumulationFramebuffer::render_to_frame(Frame& frame)
+{
+    FOUNDATION_PROFILE_ZONE("AccumulationFramebuffer::render_to_frame");
+
+    lock_all_stripes();
+
+    {
+        Spinlock::ScopedLock lock(m_spinlock);
+        FOUNDATION_PROFILE_ZONE("AccumulationFramebuffer::develop_to_frame");
+        develop_to_frame(frame);
+    }
+
+    unlock_all_stripes();
+}
+
+void AccumulationFramebuffer::lock_all_stripes()
+{
+    // Always lock the stripes in the same order to prevent deadlocks.
+    for (size_t i = 0; i < m_stripe_count; ++i)
+        m_stripe_locks[i].m_spinlock.lock();
+}
+
+void AccumulationFramebuffer::unlock_all_stripes()
+{
+    for (size_t i = 0; i < m_stripe_count; ++i)
+        m_stripe_locks[i].m_spinlock.unlock();
 }
 
 void AccumulationFramebuffer::clear_no_lock()
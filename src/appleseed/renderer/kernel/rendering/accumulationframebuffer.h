@@ -44,6 +44,15 @@ namespace renderer      { class Sample; }
 namespace renderer
 {
 
+//
+// Base class for accumulation framebuffers.
+//
+// The framebuffer is split into horizontal stripes of pixels, each protected by
+// its own lock, so that threads storing samples only contend when their samples
+// land in the same stripe. Developing or clearing the framebuffer locks all the
+// stripes.
+//
+
 class AccumulationFramebuffer
   : public foundation::NonCopyable
 {
@@ -54,7 +63,7 @@ class AccumulationFramebuffer
         const size_t    height);
 
     // Destructor.
-    virtual ~AccumulationFramebuffer() {}
+    virtual ~AccumulationFramebuffer();
 
     // Get the dimensions of the framebuffer.
     size_t get_width() const;
@@ -69,7 +78,10 @@ class AccumulationFramebuffer
     // Store @samples into the framebuffer. Thread-safe.
     virtual void store_samples(
         const size_t    sample_count,
-        const Sample    samples[]) = 0;
+        const Sample    samples[]);
+
+    // Increment the number of samples used for pixel values renormalization. Thread-safe.
+    void increment_sample_count(const foundation::uint64 delta_sample_count);
 
     // Develop the framebuffer to a frame. Thread-safe.
     void render_to_frame(Frame& frame);
@@ -78,12 +90,32 @@ class AccumulationFramebuffer
     const size_t                        m_width;
     const size_t                        m_height;
     const size_t                        m_pixel_count;
-    mutable foundation::Spinlock        m_spinlock;
+    mutable foundation::Spinlock        m_spinlock;         // protects m_sample_count
     foundation::uint64                  m_sample_count;
 
+    // Acquire and release the locks of all stripes.
+    void lock_all_stripes();
+    void unlock_all_stripes();
+
     void clear_no_lock();
 
+    // Store samples that all fall into the same stripe. Called with the lock of that stripe held.
+    virtual void store_samples_no_lock(
+        const size_t    sample_count,
+        const Sample    samples[]) = 0;
+
     virtual void develop_to_frame(Frame& frame) const = 0;
+
+  private:
+    // Pad stripe locks to avoid false sharing between them.
+    struct StripeLock
+    {
+        foundation::Spinlock            m_spinlock;
+        foundation::uint8               m_padding[64 - sizeof(foundation::Spinlock)];
+    };
+
+    const size_t                        m_stripe_count;
+    StripeLock*                         m_stripe_locks;
 };
 
 
@@ -30,6 +30,7 @@
 #include "blanksamplerenderer.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/intersection/intersectionsettings.h"
 #include "renderer/kernel/shading/shadingresult.h"
 
 using namespace foundation;
@@ -61,6 +62,16 @@ namespace
         {
             shading_result.clear();
         }
+
+        // Render a packet of samples at given points on the image plane.
+        virtual void render_sample_packet(
+            SamplingContext     sampling_contexts[],
+            const Vector2d      image_points[],
+            ShadingResult       shading_results[])
+        {
+            for (size_t i = 0; i < RayPacketSize; ++i)
+                shading_results[i].clear();
+        }
     };
 }
 
@@ -73,6 +73,35 @@ size_t FrameRendererBase::get_rendering_thread_count(const ParamArray& params)
     return thread_count;
 }
 
+JobManager::ThreadAffinity FrameRendererBase::get_thread_affinity(const ParamArray& params)
+{
+    const string thread_affinity =
+        params.get_optional<string>("thread_affinity", "none");
+
+    if (thread_affinity == "none")
+    {
+        return JobManager::AffinityNone;
+    }
+    else if (thread_affinity == "compact")
+    {
+        return JobManager::AffinityCompact;
+    }
+    else if (thread_affinity == "scatter")
+    {
+        return JobManager::AffinityScatter;
+    }
+    else
+    {
+        RENDERER_LOG_ERROR(
+            "invalid value \"%s\" for parameter \"%s\", using default value \"%s\".",
+            thread_affinity.c_str(),
+            "thread_affinity",
+            "none");
+
+        return JobManager::AffinityNone;
+    }
+}
+
 void FrameRendererBase::print_rendering_thread_count(const size_t thread_count)
 {
     RENDERER_LOG_INFO(
@@ -33,6 +33,9 @@
 #include "renderer/global/global.h"
 #include "renderer/kernel/rendering/iframerenderer.h"
 
+// appleseed.foundation headers.
+#include "foundation/utility/job.h"
+
 namespace renderer
 {
 
@@ -47,6 +50,9 @@ class RENDERERDLL FrameRendererBase
     // Extract the number of rendering threads from the "rendering_threads" parameter.
     static size_t get_rendering_thread_count(const ParamArray& params);
 
+    // Extract the affinity of rendering threads from the "thread_affinity" parameter.
+    static foundation::JobManager::ThreadAffinity get_thread_affinity(const ParamArray& params);
+
     // Output the number of rendering threads to the log.
     static void print_rendering_thread_count(const size_t thread_count);
 };
@@ -67,6 +67,7 @@ namespace
             const ParamArray&       params)
           : m_frame(frame)
           , m_params(params)
+          , m_tile_renderer_factory(renderer_factory)
         {
             // We must have a renderer factory, but it's OK not to have a callback factory.
             assert(renderer_factory);
@@ -78,10 +79,11 @@ namespace
                     m_job_queue,
                     m_params.m_thread_count,
                     false));        // don't keep threads alive if there's no more jobs
+            m_job_manager->set_thread_affinity(m_params.m_thread_affinity);
 
-            // Instantiate tile renderers, one per rendering thread.
-            for (size_t i = 0; i < m_params.m_thread_count; ++i)
-                m_tile_renderers.push_back(renderer_factory->create());
+            // Tile renderers, one per rendering thread, are instantiated by the
+            // rendering threads themselves when they render their first tile.
+            m_tile_renderers.assign(m_params.m_thread_count, 0);
 
             if (callback_factory)
             {
@@ -101,7 +103,10 @@ namespace
 
             // Delete tile renderers.
             for (const_each<vector<ITileRenderer*> > i = m_tile_renderers; i; ++i)
-                (*i)->release();
+            {
+                if (*i)
+                    (*i)->release();
+            }
         }
 
         virtual void release()
@@ -127,6 +132,8 @@ namespace
             m_tile_job_factory.create(
                 m_frame,
                 m_params.m_tile_ordering,
+                m_tile_renderer_factory,
+                m_tile_renderer_factory_mutex,
                 m_tile_renderers,
                 m_tile_callbacks,
                 tile_jobs,
@@ -166,10 +173,12 @@ namespace
         struct Parameters
         {
             const size_t                        m_thread_count;     // number of rendering threads
+            const JobManager::ThreadAffinity    m_thread_affinity;  // binding of rendering threads to CPU cores
             const TileJobFactory::TileOrdering  m_tile_ordering;    // tile rendering order
 
             explicit Parameters(const ParamArray& params)
               : m_thread_count(FrameRendererBase::get_rendering_thread_count(params))
+              , m_thread_affinity(FrameRendererBase::get_thread_affinity(params))
               , m_tile_ordering(get_tile_ordering(params))
             {
             }
@@ -215,7 +224,9 @@ namespace
         auto_ptr<JobManager>        m_job_manager;
         AbortSwitch                 m_abort_switch;
 
-        vector<ITileRenderer*>      m_tile_renderers;   // tile renderers, one per thread
+        ITileRendererFactory*       m_tile_renderer_factory;
+        boost::mutex                m_tile_renderer_factory_mutex;
+        vector<ITileRenderer*>      m_tile_renderers;   // tile renderers, one per thread, created lazily
         vector<ITileCallback*>      m_tile_callbacks;   // tile callbacks, none or one per thread
 
         TileJobFactory              m_tile_job_factory;
@@ -175,9 +175,11 @@ namespace
         GenericSampleGenerator(
             const Frame&                    frame,
             ISampleRendererFactory*         sample_renderer_factory,
+            const SamplingContext::Mode     sampling_mode,
             const size_t                    generator_index,
             const size_t                    generator_count)
           : SampleGeneratorBase(generator_index, generator_count)
+          , m_sampling_mode(sampling_mode)
           , m_frame(frame)
           , m_frame_props(frame.image().properties())
           , m_lighting_conditions(frame.get_lighting_conditions())
@@ -218,6 +220,7 @@ namespace
         }
 
       private:
+        const SamplingContext::Mode         m_sampling_mode;
         const Frame&                        m_frame;
         const CanvasProperties&             m_frame_props;
         const LightingConditions&           m_lighting_conditions;
@@ -254,7 +257,8 @@ namespace
                 m_rng,
                 2,                          // number of dimensions
                 0,                          // number of samples
-                sequence_index);            // initial instance number
+                sequence_index,             // initial instance number
+                m_sampling_mode);
 
             // Compute the sample position in NDC.
             sampling_context.split_in_place(2, 1);
@@ -276,7 +280,8 @@ namespace
                 m_rng,
                 2,                          // number of dimensions
                 sequence_index,             // number of samples
-                sequence_index);            // initial instance number
+                sequence_index,             // initial instance number
+                m_sampling_mode);
 
 #endif
 
@@ -333,9 +338,11 @@ namespace
 
 GenericSampleGeneratorFactory::GenericSampleGeneratorFactory(
     const Frame&            frame,
-    ISampleRendererFactory* sample_renderer_factory)
+    ISampleRendererFactory* sample_renderer_factory,
+    const SamplingContext::Mode sampling_mode)
   : m_frame(frame)
   , m_sample_renderer_factory(sample_renderer_factory)
+  , m_sampling_mode(sampling_mode)
 {
 }
 
@@ -352,6 +359,7 @@ ISampleGenerator* GenericSampleGeneratorFactory::create(
         new GenericSampleGenerator(
             m_frame,
             m_sample_renderer_factory,
+            m_sampling_mode,
             generator_index,
             generator_count);
 }
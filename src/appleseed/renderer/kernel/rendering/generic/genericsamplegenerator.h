@@ -30,6 +30,7 @@
 #define APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_GENERICSAMPLEGENERATOR_H
 
 // appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
 #include "renderer/kernel/rendering/isamplegenerator.h"
 
 // appleseed.main headers.
@@ -53,7 +54,8 @@ class DLLSYMBOL GenericSampleGeneratorFactory
     // Constructor.
     GenericSampleGeneratorFactory(
         const Frame&            frame,
-        ISampleRendererFactory* sample_renderer_factory);
+        ISampleRendererFactory* sample_renderer_factory,
+        const SamplingContext::Mode sampling_mode);
 
     // Delete this instance.
     virtual void release();
@@ -71,6 +73,7 @@ class DLLSYMBOL GenericSampleGeneratorFactory
   private:
     const Frame&                m_frame;
     ISampleRendererFactory*     m_sample_renderer_factory;
+    const SamplingContext::Mode m_sampling_mode;
 };
 
 }       // namespace renderer
@@ -43,6 +43,10 @@
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/scene/scene.h"
 
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+
 using namespace foundation;
 using namespace std;
 
@@ -68,6 +72,7 @@ namespace
             const Scene&            scene,
             const Frame&            frame,
             const TraceContext&     trace_context,
+            TextureStore&           texture_store,
             ILightingEngineFactory* lighting_engine_factory,
             ShadingEngine&          shading_engine,
             const ParamArray&       params)
@@ -75,9 +80,10 @@ namespace
           , m_scene(scene)
           , m_lighting_conditions(frame.get_lighting_conditions())
           , m_intersector(trace_context, true, m_params.m_report_self_intersections)
-          , m_texture_cache(scene, m_params.m_texture_cache_size)
+          , m_texture_cache(texture_store, m_params.m_texture_cache_size)
           , m_lighting_engine(lighting_engine_factory->create())
           , m_shading_engine(shading_engine)
+          , m_primary_ray_spread(compute_primary_ray_spread(scene, frame))
         {
         }
 
@@ -116,54 +122,19 @@ namespace
                 sampling_context,
                 image_point,
                 primary_ray);
+            primary_ray.m_spread = m_primary_ray_spread;
 
-            // Initialize the result to linear RGB transparent black.
-            shading_result.clear();
-
-            ShadingPoint shading_points[2];
-            size_t shading_point_index = 0;
-            const ShadingPoint* shading_point_ptr = 0;
-
-            while (true)
-            {
-                // Trace the ray.
-                shading_points[shading_point_index].clear();
-                m_intersector.trace(
-                    primary_ray,
-                    shading_points[shading_point_index],
-                    shading_point_ptr);
-
-                // Update the pointers to the shading points.
-                shading_point_ptr = &shading_points[shading_point_index];
-                shading_point_index = 1 - shading_point_index;
+            // Trace the primary ray.
+            ShadingPoint shading_point;
+            m_intersector.trace(primary_ray, shading_point);
 
-                // Shade the intersection point.
-                ShadingResult local_result;
-                local_result.m_aovs.set_size(shading_result.m_aovs.size());
-                m_shading_engine.shade(
-                    sampling_context,
-                    shading_context,
-                    *shading_point_ptr,
-                    local_result);
-
-                // Transform the result to the linear RGB color space.
-                local_result.transform_to_linear_rgb(m_lighting_conditions);
-
-                // "Over" alpha compositing.
-                shading_result.composite_over(local_result);
-
-                // Stop once we hit the environment.
-                if (!shading_point_ptr->hit())
-                    break;
-
-                // Stop once we hit full opacity.
-                if (max_value(shading_result.m_alpha) > m_params.m_transparency_threshold)
-                    break;
-
-                // Move the ray origin to the intersection point.
-                primary_ray.m_org = shading_point_ptr->get_point();
-                primary_ray.m_tmax = numeric_limits<double>::max();
-            }
+            // Shade the sample.
+            shade_primary_ray(
+                sampling_context,
+                shading_context,
+                primary_ray,
+                shading_point,
+                shading_result);
 
 #ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCES
 
@@ -201,6 +172,44 @@ namespace
 #endif
         }
 
+        virtual void render_sample_packet(
+            SamplingContext         sampling_contexts[],
+            const Vector2d          image_points[],     // points in image plane, in NDC
+            ShadingResult           shading_results[])
+        {
+            // Construct a shading context.
+            ShadingContext shading_context(
+                m_intersector,
+                m_texture_cache,
+                m_lighting_engine);
+
+            // Construct the primary rays.
+            ShadingRay primary_rays[RayPacketSize];
+            for (size_t i = 0; i < RayPacketSize; ++i)
+            {
+                m_scene.get_camera()->generate_ray(
+                    sampling_contexts[i],
+                    image_points[i],
+                    primary_rays[i]);
+                primary_rays[i].m_spread = m_primary_ray_spread;
+            }
+
+            // Trace the primary rays together.
+            ShadingPoint shading_points[RayPacketSize];
+            m_intersector.trace_packet(primary_rays, shading_points);
+
+            // Shade the samples.
+            for (size_t i = 0; i < RayPacketSize; ++i)
+            {
+                shade_primary_ray(
+                    sampling_contexts[i],
+                    shading_context,
+                    primary_rays[i],
+                    shading_points[i],
+                    shading_results[i]);
+            }
+        }
+
       private:
         struct Parameters
         {
@@ -223,6 +232,95 @@ namespace
         TextureCache                m_texture_cache;
         ILightingEngine*            m_lighting_engine;
         ShadingEngine&              m_shading_engine;
+        const double                m_primary_ray_spread;
+
+        // Compute the growth of the footprint of primary rays per unit of distance,
+        // such that the footprint of a primary ray roughly covers one pixel.
+        static double compute_primary_ray_spread(
+            const Scene&            scene,
+            const Frame&            frame)
+        {
+            const Camera* camera = scene.get_camera();
+            if (camera == 0)
+                return 0.0;
+
+            const double film_width = camera->get_film_dimensions()[0];
+            const double focal_length = camera->get_focal_length();
+            const size_t canvas_width = frame.image().properties().m_canvas_width;
+
+            return film_width / (focal_length * canvas_width);
+        }
+
+        // Shade a primary ray given its first intersection with the scene,
+        // following the ray through the surfaces that are not fully opaque.
+        void shade_primary_ray(
+            SamplingContext&        sampling_context,
+            const ShadingContext&   shading_context,
+            ShadingRay&             primary_ray,
+            const ShadingPoint&     first_shading_point,
+            ShadingResult&          shading_result)
+        {
+            // Initialize the result to linear RGB transparent black.
+            shading_result.clear();
+
+            ShadingPoint shading_points[2];
+            size_t shading_point_index = 0;
+            const ShadingPoint* shading_point_ptr = &first_shading_point;
+
+            while (true)
+            {
+                // Shade the intersection point.
+                ShadingResult local_result;
+                local_result.m_aovs.set_size(shading_result.m_aovs.size());
+                m_shading_engine.shade(
+                    sampling_context,
+                    shading_context,
+                    *shading_point_ptr,
+                    local_result);
+
+                // Composite in the native color space of the shading results whenever
+                // possible: the conversion to linear RGB is then deferred to the tile
+                // renderer which only performs it once per pixel.
+                if (local_result.m_color_space == ColorSpaceSRGB)
+                    local_result.transform_to_linear_rgb(m_lighting_conditions);
+                if (local_result.m_color_space != shading_result.m_color_space)
+                {
+                    if (shading_result.m_alpha[0] == 0.0f)
+                        shading_result.clear(local_result.m_color_space);
+                    else
+                    {
+                        shading_result.transform_to_linear_rgb(m_lighting_conditions);
+                        local_result.transform_to_linear_rgb(m_lighting_conditions);
+                    }
+                }
+
+                // "Over" alpha compositing.
+                shading_result.composite_over(local_result);
+
+                // Stop once we hit the environment.
+                if (!shading_point_ptr->hit())
+                    break;
+
+                // Stop once we hit full opacity.
+                if (max_value(shading_result.m_alpha) > m_params.m_transparency_threshold)
+                    break;
+
+                // Move the ray origin to the intersection point.
+                primary_ray.m_org = shading_point_ptr->get_point();
+                primary_ray.m_tmax = numeric_limits<double>::max();
+
+                // Trace the ray.
+                shading_points[shading_point_index].clear();
+                m_intersector.trace(
+                    primary_ray,
+                    shading_points[shading_point_index],
+                    shading_point_ptr);
+
+                // Update the pointers to the shading points.
+                shading_point_ptr = &shading_points[shading_point_index];
+                shading_point_index = 1 - shading_point_index;
+            }
+        }
     };
 }
 
@@ -235,12 +333,14 @@ GenericSampleRendererFactory::GenericSampleRendererFactory(
     const Scene&            scene,
     const Frame&            frame,
     const TraceContext&     trace_context,
+    TextureStore&           texture_store,
     ILightingEngineFactory* lighting_engine_factory,
     ShadingEngine&          shading_engine,
     const ParamArray&       params)
   : m_scene(scene)
   , m_frame(frame)
   , m_trace_context(trace_context)
+  , m_texture_store(texture_store)
   , m_lighting_engine_factory(lighting_engine_factory)
   , m_shading_engine(shading_engine)
   , m_params(params)
@@ -259,6 +359,7 @@ ISampleRenderer* GenericSampleRendererFactory::create()
             m_scene,
             m_frame,
             m_trace_context,
+            m_texture_store,
             m_lighting_engine_factory,
             m_shading_engine,
             m_params);
@@ -268,6 +369,7 @@ ISampleRenderer* GenericSampleRendererFactory::create(
     const Scene&            scene,
     const Frame&            frame,
     const TraceContext&     trace_context,
+    TextureStore&           texture_store,
     ILightingEngineFactory* lighting_engine_factory,
     ShadingEngine&          shading_engine,
     const ParamArray&       params)
@@ -277,6 +379,7 @@ ISampleRenderer* GenericSampleRendererFactory::create(
             scene,
             frame,
             trace_context,
+            texture_store,
             lighting_engine_factory,
             shading_engine,
             params);
@@ -30,7 +30,9 @@
 #include "generictilerenderer.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/intersection/intersectionsettings.h"
 #include "renderer/kernel/rendering/generic/pixelsampler.h"
+#include "renderer/kernel/rendering/generic/pixelsampleschedule.h"
 #include "renderer/kernel/rendering/isamplerenderer.h"
 #include "renderer/kernel/shading/shadingresult.h"
 #include "renderer/modeling/aov/aovcollection.h"
@@ -38,8 +40,12 @@
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
 #include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/minmax.h"
 #include "foundation/math/ordering.h"
@@ -47,8 +53,14 @@
 #include "foundation/math/scalar.h"
 #include "foundation/platform/breakpoint.h"
 #include "foundation/utility/job.h"
+#include "foundation/utility/otherwise.h"
+#include "foundation/utility/profiler.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
 #include <vector>
 
 using namespace foundation;
@@ -71,6 +83,9 @@ namespace
     // when a specific pixel is about to be rendered.
     // #define DEBUG_BREAK_AT_PIXEL Vector<size_t, 2>(0, 0)
 
+    // Name of the AOV image holding the number of samples taken in each pixel.
+    const char* SampleCountAOVName = "sample_count";
+
     class GenericTileRenderer
       : public ITileRenderer
     {
@@ -78,8 +93,10 @@ namespace
         GenericTileRenderer(
             const Frame&                frame,
             ISampleRendererFactory*     factory,
+            const SamplingContext::Mode sampling_mode,
             const ParamArray&           params)
           : m_params(params)
+          , m_sampling_mode(sampling_mode)
           , m_sample_renderer(factory->create())
           , m_frame_properties(frame.image().properties())
           , m_lighting_conditions(frame.get_lighting_conditions())
@@ -110,22 +127,44 @@ namespace
                 m_pixel_ordering[i].y = static_cast<uint16>(y);
             }
 
-            // Compute the approximate size of one side of the subpixel grid inside a pixel.
-            m_sqrt_max_samples =
-                round<size_t>(sqrt(static_cast<double>(m_params.m_max_samples)));
+            // Sampling contexts of the ray packets, reused from one packet to the next.
+            m_packet_sampling_contexts.reserve(RayPacketSize);
+
+            // Generate the order in which the cells of the subpixel grid are visited.
+            m_sample_schedule.initialize(m_params.m_min_samples, m_params.m_max_samples);
+            m_sqrt_max_samples = m_sample_schedule.get_subpixel_grid_size();
             RENDERER_LOG_INFO(
                 "effective subpixel grid size: " FMT_SIZE_T "x" FMT_SIZE_T,
                 m_sqrt_max_samples,
                 m_sqrt_max_samples);
 
+            if (m_sample_schedule.is_adaptive())
+            {
+                RENDERER_LOG_INFO(
+                    "adaptive sampling: " FMT_SIZE_T " to " FMT_SIZE_T " samples per pixel, noise threshold %f",
+                    m_sample_schedule.get_initial_sample_count(),
+                    m_sample_schedule.get_max_sample_count(),
+                    m_params.m_noise_threshold);
+            }
+
             // Initialize the pixel sampler.
             m_pixel_sampler.initialize(m_sqrt_max_samples);
 
-            // Precompute some stuff.
+            // Find the AOV image that receives the number of samples per pixel, if any.
             m_aov_image_count = m_aov_images.size();
+            m_sample_count_aov_index = ~size_t(0);
+            if (m_params.m_sample_count_aov)
+            {
+                for (size_t i = 0; i < m_aov_image_count; ++i)
+                {
+                    if (strcmp(m_aov_images.get_name(i), SampleCountAOVName) == 0)
+                        m_sample_count_aov_index = i;
+                }
+            }
+
+            // Precompute some stuff.
             m_rcp_sample_canvas_width = 1.0 / (properties.m_canvas_width * m_sqrt_max_samples);
             m_rcp_sample_canvas_height = 1.0 / (properties.m_canvas_height * m_sqrt_max_samples);
-            m_rcp_sample_count = 1.0f / (m_sqrt_max_samples * m_sqrt_max_samples);
         }
 
         virtual void release()
@@ -142,6 +181,8 @@ namespace
             assert(tile_x < m_frame_properties.m_tile_count_x);
             assert(tile_y < m_frame_properties.m_tile_count_y);
 
+            FOUNDATION_PROFILE_ZONE("GenericTileRenderer::render_tile");
+
             // Access the tile.
             Tile& tile = frame.image().tile(tile_x, tile_y);
             const size_t tile_width = tile.get_width();
@@ -199,13 +240,17 @@ namespace
         {
             const size_t        m_min_samples;          // minimum number of samples per pixel
             const size_t        m_max_samples;          // maximum number of samples per pixel
+            const float         m_noise_threshold;      // maximum standard error of the pixel luminance
+            const bool          m_sample_count_aov;     // output the number of samples per pixel?
             bool                m_crop;                 // is cropping enabled?
             Vector4i            m_crop_window;          // crop window
 
             // Constructor, extract parameters.
             explicit Parameters(const ParamArray& params)
-              : m_min_samples   ( params.get_required<size_t>("min_samples", 1) )
-              , m_max_samples   ( params.get_required<size_t>("max_samples", 1) )
+              : m_min_samples       ( params.get_required<size_t>("min_samples", 1) )
+              , m_max_samples       ( params.get_required<size_t>("max_samples", 1) )
+              , m_noise_threshold   ( params.get_optional<float>("noise_threshold", 0.01f) )
+              , m_sample_count_aov  ( params.get_optional<bool>("sample_count_aov", false) )
             {
                 // Retrieve crop window parameter.
                 m_crop = params.strings().exist("crop_window");
@@ -222,7 +267,143 @@ namespace
         // Pixel coordinates in a tile; max tile size is 65536 x 65536 pixels.
         typedef Vector<uint16, 2> Pixel;
 
+        // Running statistics of the luminance of the samples of a pixel.
+        struct PixelStatistics
+        {
+            size_t              m_sample_count;
+            double              m_sum;
+            double              m_sum_squares;
+
+            PixelStatistics()
+              : m_sample_count(0)
+              , m_sum(0.0)
+              , m_sum_squares(0.0)
+            {
+            }
+
+            void insert(const float value)
+            {
+                ++m_sample_count;
+                m_sum += value;
+                m_sum_squares += static_cast<double>(value) * value;
+            }
+
+            // Return the standard error of the mean, relative to the mean for
+            // bright pixels and absolute for pixels darker than 1.
+            double get_noise() const
+            {
+                assert(m_sample_count > 1);
+                const double n = static_cast<double>(m_sample_count);
+                const double mean = m_sum / n;
+                const double variance = max((m_sum_squares - m_sum * mean) / (n - 1.0), 0.0);
+                return sqrt(variance / n) / max(mean, 1.0);
+            }
+        };
+
+        // Sums of the samples of a pixel. Samples are summed in their own color space
+        // and the sums are only transformed to linear RGB once all the samples of the
+        // pixel have been taken, instead of transforming each sample individually.
+        class PixelAccumulator
+          : public NonCopyable
+        {
+          public:
+            // Reset all sums to transparent black.
+            void clear(const size_t aov_count)
+            {
+                m_linear_rgb.m_aovs.set_size(aov_count);
+                m_linear_rgb.clear(ColorSpaceLinearRGB);
+
+                m_ciexyz.m_aovs.set_size(aov_count);
+                m_has_ciexyz = false;
+
+                m_spectral.m_aovs.set_size(aov_count);
+                m_has_spectral = false;
+            }
+
+            // Add a sample to the sums. The sample must be in a linear color space.
+            void insert(const ShadingResult& sample)
+            {
+                switch (sample.m_color_space)
+                {
+                  case ColorSpaceLinearRGB:
+                    add(m_linear_rgb, sample);
+                    break;
+
+                  case ColorSpaceCIEXYZ:
+                    if (!m_has_ciexyz)
+                    {
+                        m_ciexyz.clear(ColorSpaceCIEXYZ);
+                        m_has_ciexyz = true;
+                    }
+                    add(m_ciexyz, sample);
+                    break;
+
+                  case ColorSpaceSpectral:
+                    if (!m_has_spectral)
+                    {
+                        m_spectral.clear(ColorSpaceSpectral);
+                        m_has_spectral = true;
+                    }
+                    m_spectral.m_color += sample.m_color;
+                    m_spectral.m_alpha += sample.m_alpha;
+                    m_spectral.m_aovs += sample.m_aovs;
+                    break;
+
+                  assert_otherwise;
+                }
+            }
+
+            // Transform the sums to linear RGB and add them to the pixel values.
+            void resolve(
+                const LightingConditions&   lighting,
+                Color4f&                    pixel_color,
+                AOVCollection&              pixel_aovs)
+            {
+                if (m_has_ciexyz)
+                {
+                    m_ciexyz.transform_to_linear_rgb(lighting);
+                    add(m_linear_rgb, m_ciexyz);
+                }
+
+                if (m_has_spectral)
+                {
+                    m_spectral.transform_to_linear_rgb(lighting);
+                    add(m_linear_rgb, m_spectral);
+                }
+
+                pixel_color[0] += m_linear_rgb.m_color[0];
+                pixel_color[1] += m_linear_rgb.m_color[1];
+                pixel_color[2] += m_linear_rgb.m_color[2];
+                pixel_color[3] += m_linear_rgb.m_alpha[0];
+                pixel_aovs += m_linear_rgb.m_aovs;
+            }
+
+          private:
+            ShadingResult   m_linear_rgb;
+            ShadingResult   m_ciexyz;
+            ShadingResult   m_spectral;
+            bool            m_has_ciexyz;
+            bool            m_has_spectral;
+
+            // Add the first three components of a shading result to another one.
+            static void add(ShadingResult& sum, const ShadingResult& sample)
+            {
+                sum.m_color[0] += sample.m_color[0];
+                sum.m_color[1] += sample.m_color[1];
+                sum.m_color[2] += sample.m_color[2];
+                sum.m_alpha += sample.m_alpha;
+
+                for (size_t i = 0; i < sum.m_aovs.size(); ++i)
+                {
+                    sum.m_aovs[i][0] += sample.m_aovs[i][0];
+                    sum.m_aovs[i][1] += sample.m_aovs[i][1];
+                    sum.m_aovs[i][2] += sample.m_aovs[i][2];
+                }
+            }
+        };
+
         const Parameters                    m_params;
+        const SamplingContext::Mode         m_sampling_mode;
         auto_release_ptr<ISampleRenderer>   m_sample_renderer;
 
         const CanvasProperties&             m_frame_properties;
@@ -230,15 +411,19 @@ namespace
         const AOVImageCollection&           m_aov_images;
         size_t                              m_aov_image_count;
 
+        size_t                              m_sample_count_aov_index;
+
         vector<Pixel>                       m_pixel_ordering;
         PixelSampler                        m_pixel_sampler;
 
         size_t                              m_sqrt_max_samples;
+        PixelSampleSchedule                 m_sample_schedule;
+        PixelAccumulator                    m_pixel_accumulator;
         double                              m_rcp_sample_canvas_width;
         double                              m_rcp_sample_canvas_height;
-        float                               m_rcp_sample_count;
 
         SamplingContext::RNGType            m_rng;
+        vector<SamplingContext>             m_packet_sampling_contexts;
 
         bool is_pixel_inside_crop_window(
             const size_t                ix,
@@ -258,62 +443,197 @@ namespace
             Color4f&                    pixel_color,
             AOVCollection&              pixel_aovs)
         {
-            const size_t base_sx = ix * m_sqrt_max_samples;
-            const size_t base_sy = iy * m_sqrt_max_samples;
+            const size_t initial_sample_count = m_sample_schedule.get_initial_sample_count();
+            const size_t max_sample_count = m_sample_schedule.get_max_sample_count();
+            PixelStatistics stats;
+
+            // Reset the sums of the samples.
+            m_pixel_accumulator.clear(pixel_aovs.size());
+
+            // Take the initial samples.
+            size_t sample_count = initial_sample_count;
+            render_samples(frame, ix, iy, 0, sample_count, pixel_aovs.size(), stats);
+
+            // Keep refining the pixel by batches of samples while it is too noisy.
+            while (sample_count < max_sample_count && stats.get_noise() > m_params.m_noise_threshold)
+            {
+                const size_t batch_end = min(sample_count + initial_sample_count, max_sample_count);
+                render_samples(frame, ix, iy, sample_count, batch_end, pixel_aovs.size(), stats);
+                sample_count = batch_end;
+            }
+
+            // Transform the sums of the samples to the linear RGB color space.
+            m_pixel_accumulator.resolve(m_lighting_conditions, pixel_color, pixel_aovs);
+
+            // Finish computing the pixel values.
+            const float rcp_sample_count = 1.0f / sample_count;
+            pixel_color *= rcp_sample_count;
+            pixel_aovs *= rcp_sample_count;
+
+            // Store the number of samples taken in this pixel.
+            if (m_sample_count_aov_index != ~size_t(0))
+                pixel_aovs[m_sample_count_aov_index].set(static_cast<float>(sample_count));
+        }
+
+        // Render and accumulate the samples [sample_begin, sample_end) of a pixel.
+        void render_samples(
+            const Frame&                frame,
+            const size_t                ix,
+            const size_t                iy,
+            const size_t                sample_begin,
+            const size_t                sample_end,
+            const size_t                aov_count,
+            PixelStatistics&            stats)
+        {
+            size_t sample_index = sample_begin;
+
+#ifdef RENDERER_TRACE_CAMERA_RAY_PACKETS
 
-            for (size_t sy = 0; sy < m_sqrt_max_samples; ++sy)
+            // Render the samples by packets as long as there are enough of them.
+            for (; sample_index + RayPacketSize <= sample_end; sample_index += RayPacketSize)
             {
-                for (size_t sx = 0; sx < m_sqrt_max_samples; ++sx)
+                m_packet_sampling_contexts.clear();
+
+                Vector2d sample_positions[RayPacketSize];
+
+                for (size_t i = 0; i < RayPacketSize; ++i)
                 {
-                    // Compute the sample position in sample space and the instance number.
-                    Vector2d s;
                     size_t instance;
-                    m_pixel_sampler.sample(
-                        base_sx + sx,
-                        base_sy + sy,
-                        s,
+                    compute_sample_position(
+                        frame,
+                        ix,
+                        iy,
+                        sample_index + i,
+                        sample_positions[i],
                         instance);
 
-                    // Compute the sample position in NDC.
-                    const Vector2d sample_position =
-                        frame.get_sample_position(s.x, s.y);
-
-                    // Create a sampling context. We start with an initial dimension of 1,
-                    // as this seems to give less correlation artifacts than when the
-                    // initial dimension is set to 0 or 2.
-                    SamplingContext sampling_context(
-                        m_rng,
-                        1,              // number of dimensions
-                        instance,       // number of samples
-                        instance);      // initial instance number
-
-                    // Render the sample.
-                    ShadingResult shading_result;
-                    shading_result.m_aovs.set_size(pixel_aovs.size());
-                    m_sample_renderer->render_sample(
-                        sampling_context,
-                        sample_position,
-                        shading_result);
-
-                    // todo: implement proper sample filtering.
-                    // todo: detect invalid sample values (NaN, infinity, etc.), set
-                    // them to black and mark them as faulty in the diagnostic map.
-
-                    // Transform the sample to the linear RGB color space.
-                    shading_result.transform_to_linear_rgb(m_lighting_conditions);
-
-                    // Accumulate the sample.
-                    pixel_color[0] += shading_result.m_color[0];
-                    pixel_color[1] += shading_result.m_color[1];
-                    pixel_color[2] += shading_result.m_color[2];
-                    pixel_color[3] += shading_result.m_alpha[0];
-                    pixel_aovs += shading_result.m_aovs;
+                    // Create a sampling context (see below).
+                    m_packet_sampling_contexts.push_back(
+                        SamplingContext(
+                            m_rng,
+                            1,              // number of dimensions
+                            instance,       // number of samples
+                            instance,       // initial instance number
+                            m_sampling_mode));
                 }
+
+                // Render the samples.
+                ShadingResult shading_results[RayPacketSize];
+                for (size_t i = 0; i < RayPacketSize; ++i)
+                    shading_results[i].m_aovs.set_size(aov_count);
+                m_sample_renderer->render_sample_packet(
+                    &m_packet_sampling_contexts[0],
+                    sample_positions,
+                    shading_results);
+
+                // Accumulate the samples.
+                for (size_t i = 0; i < RayPacketSize; ++i)
+                    accumulate_sample(shading_results[i], stats);
             }
 
-            // Finish computing the pixel values.
-            pixel_color *= m_rcp_sample_count;
-            pixel_aovs *= m_rcp_sample_count;
+#endif
+
+            // Render the remaining samples one by one.
+            for (; sample_index < sample_end; ++sample_index)
+            {
+                Vector2d sample_position;
+                size_t instance;
+                compute_sample_position(
+                    frame,
+                    ix,
+                    iy,
+                    sample_index,
+                    sample_position,
+                    instance);
+
+                // Create a sampling context. We start with an initial dimension of 1,
+                // as this seems to give less correlation artifacts than when the
+                // initial dimension is set to 0 or 2.
+                SamplingContext sampling_context(
+                    m_rng,
+                    1,              // number of dimensions
+                    instance,       // number of samples
+                    instance,       // initial instance number
+                    m_sampling_mode);
+
+                // Render the sample.
+                ShadingResult shading_result;
+                shading_result.m_aovs.set_size(aov_count);
+                m_sample_renderer->render_sample(
+                    sampling_context,
+                    sample_position,
+                    shading_result);
+
+                // Accumulate the sample.
+                accumulate_sample(shading_result, stats);
+            }
+        }
+
+        // Compute the position in NDC and the instance number of a given sample of a pixel.
+        void compute_sample_position(
+            const Frame&                frame,
+            const size_t                ix,
+            const size_t                iy,
+            const size_t                sample_index,
+            Vector2d&                   sample_position,
+            size_t&                     instance)
+        {
+            const size_t cell = m_sample_schedule.get_cell(sample_index);
+            const size_t sx = ix * m_sqrt_max_samples + cell % m_sqrt_max_samples;
+            const size_t sy = iy * m_sqrt_max_samples + cell / m_sqrt_max_samples;
+
+            // Compute the sample position in sample space and the instance number.
+            Vector2d s;
+            m_pixel_sampler.sample(sx, sy, s, instance);
+
+            // Compute the sample position in NDC.
+            sample_position = frame.get_sample_position(s.x, s.y);
+        }
+
+        // Accumulate a sample into the pixel values.
+        void accumulate_sample(
+            ShadingResult&              shading_result,
+            PixelStatistics&            stats)
+        {
+            // todo: implement proper sample filtering.
+            // todo: detect invalid sample values (NaN, infinity, etc.), set
+            // them to black and mark them as faulty in the diagnostic map.
+
+            // sRGB is not a linear color space: such samples can't be summed as is.
+            if (shading_result.m_color_space == ColorSpaceSRGB)
+                shading_result.transform_to_linear_rgb(m_lighting_conditions);
+
+            // Update the pixel statistics used to drive adaptive sampling.
+            if (m_sample_schedule.is_adaptive())
+                stats.insert(compute_luminance(shading_result));
+
+            // Accumulate the sample in its own color space.
+            m_pixel_accumulator.insert(shading_result);
+        }
+
+        // Compute the luminance of a sample.
+        float compute_luminance(const ShadingResult& shading_result) const
+        {
+            const Color3f color(
+                shading_result.m_color[0],
+                shading_result.m_color[1],
+                shading_result.m_color[2]);
+
+            switch (shading_result.m_color_space)
+            {
+              case ColorSpaceLinearRGB:
+                return luminance(color);
+
+              case ColorSpaceCIEXYZ:
+                return luminance(ciexyz_to_linear_rgb(color));
+
+              case ColorSpaceSpectral:
+                return spectrum_to_luminance<float>(m_lighting_conditions, shading_result.m_color);
+
+              assert_otherwise;
+            }
+
+            return 0.0f;
         }
     };
 }
@@ -326,11 +646,28 @@ namespace
 GenericTileRendererFactory::GenericTileRendererFactory(
     const Frame&                frame,
     ISampleRendererFactory*     factory,
+    const SamplingContext::Mode sampling_mode,
     const ParamArray&           params)
   : m_frame(frame)
   , m_factory(factory)
+  , m_sampling_mode(sampling_mode)
   , m_params(params)
 {
+    // Add the AOV image that will receive the number of samples per pixel.
+    if (m_params.get_optional<bool>("sample_count_aov", false))
+    {
+        AOVImageCollection& aov_images = frame.aov_images();
+
+        if (aov_images.size() < AOVCollection::MaxSize)
+            aov_images.insert(SampleCountAOVName, PixelFormatFloat);
+        else
+        {
+            RENDERER_LOG_ERROR(
+                "could not create the \"%s\" aov, maximum number of aovs (" FMT_SIZE_T ") reached.",
+                SampleCountAOVName,
+                AOVCollection::MaxSize);
+        }
+    }
 }
 
 void GenericTileRendererFactory::release()
@@ -344,18 +681,21 @@ ITileRenderer* GenericTileRendererFactory::create()
         new GenericTileRenderer(
             m_frame,
             m_factory,
+            m_sampling_mode,
             m_params);
 }
 
 ITileRenderer* GenericTileRendererFactory::create(
     const Frame&                frame,
     ISampleRendererFactory*     factory,
+    const SamplingContext::Mode sampling_mode,
     const ParamArray&           params)
 {
     return
         new GenericTileRenderer(
             frame,
             factory,
+            sampling_mode,
             params);
 }
 
@@ -55,6 +55,7 @@ class RENDERERDLL GenericTileRendererFactory
     GenericTileRendererFactory(
         const Frame&            frame,
         ISampleRendererFactory* factory,
+        const SamplingContext::Mode sampling_mode,
         const ParamArray&       params);
 
     // Delete this instance.
@@ -67,11 +68,13 @@ class RENDERERDLL GenericTileRendererFactory
     static ITileRenderer* create(
         const Frame&            frame,
         ISampleRendererFactory* factory,
+        const SamplingContext::Mode sampling_mode,
         const ParamArray&       params);
 
   private:
     const Frame&                m_frame;
     ISampleRendererFactory*     m_factory;
+    const SamplingContext::Mode m_sampling_mode;
     ParamArray                  m_params;
 };
 
@@ -0,0 +1,122 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "pixelsampleschedule.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Generate an ordering of the cells of a square subpixel grid such that
+    // the cells visited first are evenly spread over the pixel: cells are
+    // sorted by the bit-reversed Morton code of their coordinates.
+    void progressive_subpixel_ordering(
+        vector<size_t>&             ordering,
+        const size_t                grid_size)
+    {
+        size_t bits = 0;
+        while ((size_t(1) << bits) < grid_size)
+            ++bits;
+
+        vector<pair<size_t, size_t> > keys;
+        keys.reserve(grid_size * grid_size);
+
+        for (size_t y = 0; y < grid_size; ++y)
+        {
+            for (size_t x = 0; x < grid_size; ++x)
+            {
+                size_t key = 0;
+
+                for (size_t b = 0; b < bits; ++b)
+                {
+                    // Interleave the bits of x and y, most significant bits last.
+                    key |= ((x >> b) & 1) << (2 * (bits - 1 - b) + 1);
+                    key |= ((y >> b) & 1) << (2 * (bits - 1 - b));
+                }
+
+                keys.push_back(make_pair(key, y * grid_size + x));
+            }
+        }
+
+        sort(keys.begin(), keys.end());
+
+        ordering.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+            ordering[i] = keys[i].second;
+    }
+}
+
+
+//
+// PixelSampleSchedule class implementation.
+//
+
+void PixelSampleSchedule::initialize(
+    const size_t                min_samples,
+    const size_t                max_samples)
+{
+    // Compute the approximate size of one side of the subpixel grid inside a pixel.
+    m_subpixel_grid_size =
+        max<size_t>(round<size_t>(sqrt(static_cast<double>(max_samples))), 1);
+
+    const size_t cell_count = m_subpixel_grid_size * m_subpixel_grid_size;
+
+    // Only switch to adaptive sampling if it was asked for: a fixed, non-square
+    // sample count keeps sampling all the cells of the rounded grid.
+    m_adaptive = min_samples < max_samples;
+
+    if (m_adaptive)
+    {
+        // Don't take more samples than asked for, even if the grid has more cells.
+        progressive_subpixel_ordering(m_cells, m_subpixel_grid_size);
+        m_cells.resize(min(max_samples, cell_count));
+        m_initial_sample_count = min(max<size_t>(min_samples, 2), m_cells.size());
+    }
+    else
+    {
+        m_cells.resize(cell_count);
+        for (size_t i = 0; i < cell_count; ++i)
+            m_cells[i] = i;
+        m_initial_sample_count = cell_count;
+    }
+}
+
+}   // namespace renderer
@@ -0,0 +1,116 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_PIXELSAMPLESCHEDULE_H
+#define APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_PIXELSAMPLESCHEDULE_H
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// The order in which the cells of the subpixel grid of a pixel are sampled.
+//
+// When the minimum and maximum numbers of samples per pixel are equal, all
+// the cells of the grid are sampled, in raster order. Otherwise sampling is
+// adaptive: it may stop after any number of samples between the initial
+// sample count and the maximum sample count, so the cells are visited in
+// bit-reversed Morton order such that the first samples cover the pixel.
+//
+
+class PixelSampleSchedule
+{
+  public:
+    // Initialize the schedule for a given range of samples per pixel.
+    void initialize(
+        const size_t            min_samples,
+        const size_t            max_samples);
+
+    // Return the number of cells along one side of the subpixel grid.
+    size_t get_subpixel_grid_size() const;
+
+    // Return true if sampling may stop before the maximum sample count.
+    bool is_adaptive() const;
+
+    // Return the number of samples taken before deciding whether to continue.
+    size_t get_initial_sample_count() const;
+
+    // Return the maximum number of samples taken in a pixel.
+    size_t get_max_sample_count() const;
+
+    // Return the index of the subpixel grid cell of a given sample.
+    size_t get_cell(const size_t sample_index) const;
+
+  private:
+    size_t                      m_subpixel_grid_size;
+    bool                        m_adaptive;
+    size_t                      m_initial_sample_count;
+    std::vector<size_t>         m_cells;
+};
+
+
+//
+// PixelSampleSchedule class implementation.
+//
+
+inline size_t PixelSampleSchedule::get_subpixel_grid_size() const
+{
+    return m_subpixel_grid_size;
+}
+
+inline bool PixelSampleSchedule::is_adaptive() const
+{
+    return m_adaptive;
+}
+
+inline size_t PixelSampleSchedule::get_initial_sample_count() const
+{
+    return m_initial_sample_count;
+}
+
+inline size_t PixelSampleSchedule::get_max_sample_count() const
+{
+    return m_cells.size();
+}
+
+inline size_t PixelSampleSchedule::get_cell(const size_t sample_index) const
+{
+    assert(sample_index < m_cells.size());
+    return m_cells[sample_index];
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_RENDERING_GENERIC_PIXELSAMPLESCHEDULE_H
@@ -53,13 +53,17 @@ namespace renderer
 //
 
 TileJob::TileJob(
-    const TileRendererVector&   tile_renderers,
+    ITileRendererFactory*       tile_renderer_factory,
+    boost::mutex&               tile_renderer_factory_mutex,
+    TileRendererVector&         tile_renderers,
     const TileCallbackVector&   tile_callbacks,
     const Frame&                frame,
     const size_t                tile_x,
     const size_t                tile_y,
     AbortSwitch&                abort_switch)
-  : m_tile_renderers(tile_renderers)
+  : m_tile_renderer_factory(tile_renderer_factory)
+  , m_tile_renderer_factory_mutex(tile_renderer_factory_mutex)
+  , m_tile_renderers(tile_renderers)
   , m_tile_callbacks(tile_callbacks)
   , m_frame(frame)
   , m_tile_x(tile_x)
@@ -77,6 +81,16 @@ void TileJob::execute(const size_t thread_index)
 {
     assert(thread_index < m_tile_renderers.size());
 
+    // Create the tile renderer of this thread if it doesn't exist yet.
+    if (m_tile_renderers[thread_index] == 0)
+    {
+        assert(m_tile_renderer_factory);
+
+        // Tile renderer factories are not required to be thread-safe.
+        boost::mutex::scoped_lock lock(m_tile_renderer_factory_mutex);
+        m_tile_renderers[thread_index] = m_tile_renderer_factory->create();
+    }
+
     // Retrieve the tile callback.
     ITileCallback* tile_callback =
         m_tile_callbacks.size() == m_tile_renderers.size()
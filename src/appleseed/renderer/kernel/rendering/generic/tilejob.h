@@ -35,12 +35,16 @@
 // appleseed.foundation headers.
 #include "foundation/utility/job.h"
 
+// boost headers.
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <vector>
 
 // Forward declarations.
 namespace renderer      { class Frame; }
 namespace renderer      { class ITileRenderer; }
+namespace renderer      { class ITileRendererFactory; }
 namespace renderer      { class ITileCallback; }
 
 namespace renderer
@@ -57,9 +61,12 @@ class TileJob
     typedef std::vector<ITileRenderer*> TileRendererVector;
     typedef std::vector<ITileCallback*> TileCallbackVector;
 
-    // Constructor.
+    // Constructor. Null tile renderers are created on first use by the rendering
+    // thread itself, so that their memory is allocated close to that thread.
     TileJob(
-        const TileRendererVector&   tile_renderers,
+        ITileRendererFactory*       tile_renderer_factory,
+        boost::mutex&               tile_renderer_factory_mutex,
+        TileRendererVector&         tile_renderers,
         const TileCallbackVector&   tile_callbacks,
         const Frame&                frame,
         const size_t                tile_x,
@@ -70,7 +77,9 @@ class TileJob
     virtual void execute(const size_t thread_index);
 
   private:
-    const TileRendererVector&       m_tile_renderers;
+    ITileRendererFactory*           m_tile_renderer_factory;
+    boost::mutex&                   m_tile_renderer_factory_mutex;
+    TileRendererVector&             m_tile_renderers;
     const TileCallbackVector&       m_tile_callbacks;
     const Frame&                    m_frame;
     const size_t                    m_tile_x;
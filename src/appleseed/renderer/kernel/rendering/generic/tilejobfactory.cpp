@@ -50,7 +50,9 @@ namespace renderer
 void TileJobFactory::create(
     const Frame&                        frame,
     const TileOrdering                  tile_ordering,
-    const TileJob::TileRendererVector&  tile_renderers,
+    ITileRendererFactory*               tile_renderer_factory,
+    boost::mutex&                       tile_renderer_factory_mutex,
+    TileJob::TileRendererVector&        tile_renderers,
     const TileJob::TileCallbackVector&  tile_callbacks,
     TileJobVector&                      tile_jobs,
     AbortSwitch&                        abort_switch)
@@ -78,6 +80,8 @@ void TileJobFactory::create(
         // Create the tile job.
         tile_jobs.push_back(
             new TileJob(
+                tile_renderer_factory,
+                tile_renderer_factory_mutex,
                 tile_renderers,
                 tile_callbacks,
                 frame,
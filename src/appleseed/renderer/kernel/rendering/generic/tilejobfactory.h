@@ -43,6 +43,7 @@
 namespace foundation    { class AbortSwitch; }
 namespace foundation    { class CanvasProperties; }
 namespace renderer      { class Frame; }
+namespace renderer      { class ITileRendererFactory; }
 namespace renderer      { class TileJob; }
 
 namespace renderer
@@ -70,7 +71,9 @@ class TileJobFactory
     void create(
         const Frame&                        frame,
         const TileOrdering                  tile_ordering,
-        const TileJob::TileRendererVector&  tile_renderers,
+        ITileRendererFactory*               tile_renderer_factory,
+        boost::mutex&                       tile_renderer_factory_mutex,
+        TileJob::TileRendererVector&        tile_renderers,
         const TileJob::TileCallbackVector&  tile_callbacks,
         TileJobVector&                      tile_jobs,
         foundation::AbortSwitch&            abort_switch);
@@ -65,19 +65,22 @@ GlobalAccumulationFramebuffer::GlobalAccumulationFramebuffer(
 
 void GlobalAccumulationFramebuffer::clear()
 {
-    Spinlock::ScopedLock lock(m_spinlock);
+    lock_all_stripes();
 
-    AccumulationFramebuffer::clear_no_lock();
+    {
+        Spinlock::ScopedLock lock(m_spinlock);
+        AccumulationFramebuffer::clear_no_lock();
+    }
 
     m_tile->clear(Color3f(0.0));
+
+    unlock_all_stripes();
 }
 
-void GlobalAccumulationFramebuffer::store_samples(
+void GlobalAccumulationFramebuffer::store_samples_no_lock(
     const size_t    sample_count,
     const Sample    samples[])
 {
-    Spinlock::ScopedLock lock(m_spinlock);
-
     const double fb_width = static_cast<double>(m_width);
     const double fb_height = static_cast<double>(m_height);
 
@@ -98,12 +101,6 @@ void GlobalAccumulationFramebuffer::store_samples(
     }
 }
 
-void GlobalAccumulationFramebuffer::increment_sample_count(const uint64 delta_sample_count)
-{
-    Spinlock::ScopedLock lock(m_spinlock);
-    m_sample_count += delta_sample_count;
-}
-
 void GlobalAccumulationFramebuffer::develop_to_frame(Frame& frame) const
 {
     Image& image = frame.image();
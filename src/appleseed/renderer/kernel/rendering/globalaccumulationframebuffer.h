@@ -60,17 +60,13 @@ class GlobalAccumulationFramebuffer
     // Reset the framebuffer to its initial state. Thread-safe.
     virtual void clear();
 
-    // Store @samples into the framebuffer. Thread-safe.
-    virtual void store_samples(
-        const size_t    sample_count,
-        const Sample    samples[]);
-
-    // Increment the number of samples used for pixel values renormalization. Thread-safe.
-    void increment_sample_count(const foundation::uint64 delta_sample_count);
-
   private:
     std::auto_ptr<foundation::Tile>     m_tile;
 
+    virtual void store_samples_no_lock(
+        const size_t                    sample_count,
+        const Sample                    samples[]);
+
     void add_pixel(
         const size_t                    x,
         const size_t                    y,
@@ -52,6 +52,13 @@ class RENDERERDLL ISampleRenderer
         SamplingContext&                sampling_context,
         const foundation::Vector2d&     image_point,            // point in image plane, in NDC
         ShadingResult&                  shading_result) = 0;
+
+    // Render a packet of RayPacketSize samples (see intersectionsettings.h)
+    // at given points on the image plane.
+    virtual void render_sample_packet(
+        SamplingContext                 sampling_contexts[],
+        const foundation::Vector2d      image_points[],         // points in image plane, in NDC
+        ShadingResult                   shading_results[]) = 0;
 };
 
 
@@ -95,12 +95,15 @@ namespace
             const Scene&                scene,
             const Frame&                frame,
             const TraceContext&         trace_context,
+            TextureStore&               texture_store,
             const LightSampler&         light_sampler,
+            const SamplingContext::Mode sampling_mode,
             const size_t                generator_index,
             const size_t                generator_count,
             const ParamArray&           params)
           : SampleGeneratorBase(generator_index, generator_count)
           , m_params(params)
+          , m_sampling_mode(sampling_mode)
           , m_scene(scene)
           , m_frame(frame)
           , m_env_edf(scene.get_environment()->get_environment_edf())
@@ -108,7 +111,7 @@ namespace
           , m_disk_point_prob(1.0 / (Pi * square(m_safe_scene_radius)))
           , m_light_sampler(light_sampler)
           , m_intersector(trace_context, true, m_params.m_report_self_intersections)
-          , m_texture_cache(scene, m_params.m_texture_cache_size)
+          , m_texture_cache(texture_store, m_params.m_texture_cache_size)
         {
             RENDERER_LOG_INFO(
                 "light tracing settings:\n"
@@ -423,8 +426,7 @@ namespace
                 Sample sample;
                 sample.m_position = position_ndc;
                 sample.m_color.rgb() =
-                    ciexyz_to_linear_rgb(
-                        spectrum_to_ciexyz<float>(m_lighting_conditions, radiance));
+                    spectrum_to_linear_rgb<float>(m_lighting_conditions, radiance);
                 sample.m_color[3] = 1.0f;
                 m_samples.push_back(sample);
                 ++m_sample_count;
@@ -438,6 +440,7 @@ namespace
         > PathTracerType;
 
         const Parameters                m_params;
+        const SamplingContext::Mode     m_sampling_mode;
         Statistics                      m_stats;
 
         const Scene&                    m_scene;
@@ -465,7 +468,8 @@ namespace
                 m_rng,
                 0,
                 sequence_index,
-                sequence_index);
+                sequence_index,
+                m_sampling_mode);
 
             size_t stored_sample_count = 0;
 
@@ -747,12 +751,16 @@ LightTracingSampleGeneratorFactory::LightTracingSampleGeneratorFactory(
     const Scene&            scene,
     const Frame&            frame,
     const TraceContext&     trace_context,
+    TextureStore&           texture_store,
     const LightSampler&     light_sampler,
+    const SamplingContext::Mode sampling_mode,
     const ParamArray&       params)
   : m_scene(scene)
   , m_frame(frame)
   , m_trace_context(trace_context)
+  , m_texture_store(texture_store)
   , m_light_sampler(light_sampler)
+  , m_sampling_mode(sampling_mode)
   , m_params(params)
 {
 }
@@ -771,7 +779,9 @@ ISampleGenerator* LightTracingSampleGeneratorFactory::create(
             m_scene,
             m_frame,
             m_trace_context,
+            m_texture_store,
             m_light_sampler,
+            m_sampling_mode,
             generator_index,
             generator_count,
             m_params);
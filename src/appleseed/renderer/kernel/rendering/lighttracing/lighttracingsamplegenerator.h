@@ -30,6 +30,7 @@
 #define APPLESEED_RENDERER_KERNEL_RENDERING_LIGHTTRACING_LIGHTTRACINGSAMPLEGENERATOR_H
 
 // appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
 #include "renderer/kernel/rendering/isamplegenerator.h"
 #include "renderer/utility/paramarray.h"
 
@@ -44,6 +45,7 @@ namespace renderer      { class AccumulationFramebuffer; }
 namespace renderer      { class Frame; }
 namespace renderer      { class LightSampler; }
 namespace renderer      { class Scene; }
+namespace renderer      { class TextureStore; }
 namespace renderer      { class TraceContext; }
 
 namespace renderer
@@ -58,7 +60,9 @@ class DLLSYMBOL LightTracingSampleGeneratorFactory
         const Scene&            scene,
         const Frame&            frame,
         const TraceContext&     trace_context,
+        TextureStore&           texture_store,
         const LightSampler&     light_sampler,
+        const SamplingContext::Mode sampling_mode,
         const ParamArray&       params);
 
     // Delete this instance.
@@ -78,7 +82,9 @@ class DLLSYMBOL LightTracingSampleGeneratorFactory
     const Scene&                m_scene;
     const Frame&                m_frame;
     const TraceContext&         m_trace_context;
+    TextureStore&               m_texture_store;
     const LightSampler&         m_light_sampler;
+    const SamplingContext::Mode m_sampling_mode;
     const ParamArray            m_params;
 };
 
@@ -74,9 +74,12 @@ LocalAccumulationFramebuffer::LocalAccumulationFramebuffer(
 
 void LocalAccumulationFramebuffer::clear()
 {
-    Spinlock::ScopedLock lock(m_spinlock);
+    lock_all_stripes();
 
-    AccumulationFramebuffer::clear_no_lock();
+    {
+        Spinlock::ScopedLock lock(m_spinlock);
+        AccumulationFramebuffer::clear_no_lock();
+    }
 
     AccumulationPixel* pixel =
         reinterpret_cast<AccumulationPixel*>(m_tile->pixel(0));
@@ -86,14 +89,23 @@ void LocalAccumulationFramebuffer::clear()
         pixel[i].m_color.set(0.0f);
         pixel[i].m_count = 0;
     }
+
+    unlock_all_stripes();
 }
 
 void LocalAccumulationFramebuffer::store_samples(
     const size_t    sample_count,
     const Sample    samples[])
 {
-    Spinlock::ScopedLock lock(m_spinlock);
+    AccumulationFramebuffer::store_samples(sample_count, samples);
+
+    increment_sample_count(sample_count);
+}
 
+void LocalAccumulationFramebuffer::store_samples_no_lock(
+    const size_t    sample_count,
+    const Sample    samples[])
+{
     const double fb_width = static_cast<double>(m_width);
     const double fb_height = static_cast<double>(m_height);
 
@@ -112,8 +124,6 @@ void LocalAccumulationFramebuffer::store_samples(
 
         ++sample_ptr;
     }
-
-    m_sample_count += sample_count;
 }
 
 void LocalAccumulationFramebuffer::develop_to_frame(Frame& frame) const
@@ -74,6 +74,10 @@ class LocalAccumulationFramebuffer
 
     std::auto_ptr<foundation::Tile>     m_tile;
 
+    virtual void store_samples_no_lock(
+        const size_t                    sample_count,
+        const Sample                    samples[]);
+
     void add_pixel(
         const size_t                    x,
         const size_t                    y,
@@ -30,6 +30,8 @@
 #include "masterrenderer.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/lighting/drt/drt.h"
 #include "renderer/kernel/lighting/ilightingengine.h"
 #include "renderer/kernel/lighting/lightsampler.h"
@@ -49,6 +51,7 @@
 #include "renderer/kernel/rendering/itilerenderer.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingengine.h"
+#include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/input/inputbinder.h"
 #include "renderer/modeling/project/project.h"
@@ -57,6 +60,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exception.h"
 #include "foundation/core/exceptions/stringexception.h"
+#include "foundation/platform/system.h"
 
 // Standard headers.
 #include <exception>
@@ -156,8 +160,17 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
         return IRendererController::AbortRendering;
 
     m_project.create_aov_images();
+
+    // Set the directory where triangle trees are cached across renders.
+    if (m_params.strings().exist("tree_cache_path"))
+        m_project.set_tree_cache_path(m_params.strings().get("tree_cache_path"));
+
     m_project.update_trace_context();
 
+    // Optionally build all child trees before rendering starts, instead of on first access.
+    if (m_params.get_optional<bool>("prebuild_trees", false))
+        m_project.get_trace_context().prebuild_trees(System::get_logical_cpu_core_count());
+
     const Scene& scene = *m_project.get_scene();
     Frame& frame = *m_project.get_frame();
 
@@ -167,6 +180,32 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
     // Create the shading engine.
     ShadingEngine shading_engine(m_params.child("shading_engine"));
 
+    // Create the texture store, shared by the texture caches of all rendering threads.
+    TextureStore texture_store(
+        scene,
+        m_params.get_optional<size_t>("texture_store_size", 256 * 1024 * 1024));
+
+    //
+    // Choose the low discrepancy sequence used by the sampling contexts.
+    //
+
+    SamplingContext::Mode sampling_mode;
+
+    const string sampling_mode_param =
+        m_params.get_optional<string>("sampling_mode", "qmc");
+
+    if (sampling_mode_param == "qmc")
+        sampling_mode = SamplingContext::HaltonMode;
+    else if (sampling_mode_param == "sobol")
+        sampling_mode = SamplingContext::SobolMode;
+    else
+    {
+        RENDERER_LOG_ERROR(
+            "invalid value for \"sampling_mode\" parameter: \"%s\".",
+            sampling_mode_param.c_str());
+        return IRendererController::AbortRendering;
+    }
+
     //
     // Create a lighting engine factory.
     //
@@ -214,6 +253,7 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
                 scene,
                 frame,
                 m_project.get_trace_context(),
+                texture_store,
                 lighting_engine_factory.get(),
                 shading_engine,
                 m_params.child("generic_sample_renderer")));
@@ -241,6 +281,7 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
             new GenericTileRendererFactory(
                 frame,
                 sample_renderer_factory.get(),
+                sampling_mode,
                 m_params.child("generic_tile_renderer")));
     }
     else if (tile_renderer_param == "blank")
@@ -273,7 +314,8 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
         sample_generator_factory.reset(
             new GenericSampleGeneratorFactory(
                 frame,
-                sample_renderer_factory.get()));
+                sample_renderer_factory.get(),
+                sampling_mode));
     }
     else if (sample_generator_param == "lighttracing")
     {
@@ -282,7 +324,9 @@ IRendererController::Status MasterRenderer::initialize_and_render_frame_sequence
                 scene,
                 frame,
                 m_project.get_trace_context(),
+                texture_store,
                 light_sampler,
+                sampling_mode,
                 m_params.child("lighttracing_sample_generator")));
     }
     else
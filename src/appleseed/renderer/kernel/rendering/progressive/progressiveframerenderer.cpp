@@ -104,6 +104,7 @@ namespace
                     m_job_queue,
                     m_params.m_thread_count,
                     true));         // keep threads alive, even if there's no more jobs
+            m_job_manager->set_thread_affinity(m_params.m_thread_affinity);
 
             // Instantiate sample generators, one per rendering thread.
             for (size_t i = 0; i < m_params.m_thread_count; ++i)
@@ -245,6 +246,8 @@ namespace
         struct Parameters
         {
             const size_t    m_thread_count;             // number of rendering threads
+            const JobManager::ThreadAffinity
+                            m_thread_affinity;          // binding of rendering threads to CPU cores
             const uint64    m_max_sample_count;         // maximum total number of samples to store in the framebuffer
             const bool      m_print_luminance_stats;    // compute and print luminance statistics?
             const string    m_ref_image_path;           // path to the reference image
@@ -252,6 +255,7 @@ namespace
             // Constructor, extract parameters.
             explicit Parameters(const ParamArray& params)
               : m_thread_count(FrameRendererBase::get_rendering_thread_count(params))
+              , m_thread_affinity(FrameRendererBase::get_thread_affinity(params))
               , m_max_sample_count(params.get_optional<uint64>("max_samples", numeric_limits<uint64>::max()))
               , m_print_luminance_stats(params.get_optional<bool>("print_luminance_statistics", false))
               , m_ref_image_path(params.get_optional<string>("reference_image", ""))
@@ -35,6 +35,7 @@
 // appleseed.foundation headers.
 #include "foundation/utility/job.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/profiler.h"
 
 // Standard headers.
 #include <cassert>
@@ -71,6 +72,8 @@ void SampleGeneratorBase::generate_samples(
 {
     assert(sample_count > 0);
 
+    FOUNDATION_PROFILE_ZONE("SampleGeneratorBase::generate_samples");
+
     clear_keep_memory(m_samples);
     m_samples.reserve(sample_count);
 
@@ -38,6 +38,10 @@
 #include "foundation/math/intersection.h"
 #include "foundation/utility/attributeset.h"
 
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+
 using namespace foundation;
 using namespace std;
 
@@ -134,6 +138,58 @@ void ShadingPoint::fetch_source_geometry() const
     m_n2 = tess.m_vertex_normals[triangle.m_n2];
 }
 
+void ShadingPoint::compute_uv_footprint() const
+{
+    assert(hit());
+
+    m_input_params.m_duvdx = Vector2d(0.0);
+    m_input_params.m_duvdy = Vector2d(0.0);
+
+    // Width of the ray footprint at the intersection point.
+    const double width = m_ray.m_tmax * norm(m_ray.m_dir) * m_ray.m_spread;
+    if (width <= 0.0)
+        return;
+
+    // Build two world space axes spanning the footprint in the plane of the triangle:
+    // the first one is perpendicular to the ray, the second one is stretched according
+    // to the obliquity of the ray with respect to the surface.
+    const Vector3d& n = get_geometric_normal();
+    const Vector3d dir = normalize(m_ray.m_dir);
+    Vector3d x1 = cross(n, dir);
+    const double sin_theta = norm(x1);
+    if (sin_theta > 1.0e-6)
+        x1 /= sin_theta;
+    else x1 = get_shading_basis().get_tangent_u();
+    const Vector3d x2 = cross(n, x1);
+    const double cos_theta = max(abs(dot(n, dir)), 1.0e-3);
+    const Vector3d dpdx = x1 * width;
+    const Vector3d dpdy = x2 * (width / cos_theta);
+
+    // Express the footprint axes in terms of the triangle edges.
+    const Vector3d e1 = get_vertex(1) - get_vertex(0);
+    const Vector3d e2 = get_vertex(2) - get_vertex(0);
+    const double g11 = dot(e1, e1);
+    const double g12 = dot(e1, e2);
+    const double g22 = dot(e2, e2);
+    const double det = g11 * g22 - g12 * g12;
+    if (det <= 1.0e-20 * g11 * g22)
+        return;
+    const double rcp_det = 1.0 / det;
+
+    // Map the footprint axes to UV space.
+    const Vector2d v0_uv(m_v0_uv);
+    const Vector2d duv1 = Vector2d(m_v1_uv) - v0_uv;
+    const Vector2d duv2 = Vector2d(m_v2_uv) - v0_uv;
+    const double ax = dot(dpdx, e1), bx = dot(dpdx, e2);
+    const double ay = dot(dpdy, e1), by = dot(dpdy, e2);
+    m_input_params.m_duvdx =
+          duv1 * ((g22 * ax - g12 * bx) * rcp_det)
+        + duv2 * ((g11 * bx - g12 * ax) * rcp_det);
+    m_input_params.m_duvdy =
+          duv1 * ((g22 * ay - g12 * by) * rcp_det)
+        + duv2 * ((g11 * by - g12 * ay) * rcp_det);
+}
+
 void ShadingPoint::refine_and_offset() const
 {
     assert(hit());
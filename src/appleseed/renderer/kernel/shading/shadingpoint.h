@@ -140,11 +140,13 @@ class ShadingPoint
     size_t get_primitive_attribute_index() const;
 
   private:
+    friend class AssemblyLeafPacketVisitor;
     friend class AssemblyLeafProbeVisitor;
     friend class AssemblyLeafVisitor;
     friend class AssemblyLeafVisitorBase;
     friend class Intersector;
     friend class RegionLeafVisitor;
+    friend class TriangleLeafPacketVisitor;
     friend class TriangleLeafVisitor;
     friend class ShadingPointBuilder;
 
@@ -174,7 +176,8 @@ class ShadingPoint
         HasWorldSpaceVertices       = 1 << 6,                   // world space triangle vertices
         HasWorldSpaceVertexNormals  = 1 << 7,                   // world space vertex normals
         HasMaterial                 = 1 << 8,                   // material at intersection point
-        HasRefinedPoints            = 1 << 9                    // refined intersection points
+        HasRefinedPoints            = 1 << 9,                   // refined intersection points
+        HasUVFootprint              = 1 << 10                   // footprint of the ray in UV set #0 at intersection point
     };
     mutable foundation::uint32      m_members;                  // which members have already been computed
     mutable const AssemblyInstance* m_assembly_instance;        // hit assembly instance
@@ -205,6 +208,9 @@ class ShadingPoint
 
     // Refine and offset the intersection point.
     void refine_and_offset() const;
+
+    // Compute the footprint of the ray in UV set #0 at the intersection point.
+    void compute_uv_footprint() const;
 };
 
 
@@ -260,6 +266,14 @@ inline const InputParams& ShadingPoint::get_input_params() const
 
     get_uv(0);
 
+    if (!(m_members & HasUVFootprint))
+    {
+        compute_uv_footprint();
+
+        // The UV footprint is now available.
+        m_members |= HasUVFootprint;
+    }
+
 /*
     At the moment, only UV coordinates are needed by the input sources
     (see renderer/input/source.h and derivates).
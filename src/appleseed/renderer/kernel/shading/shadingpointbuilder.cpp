@@ -47,6 +47,11 @@ void ShadingPointBuilder::set_scene(const Scene* scene)
     m_shading_point.m_scene = scene;
 }
 
+void ShadingPointBuilder::set_ray(const ShadingRay& ray)
+{
+    m_shading_point.m_ray = ray;
+}
+
 void ShadingPointBuilder::set_point(const Vector3d& point)
 {
     m_shading_point.m_input_params.m_point = point;
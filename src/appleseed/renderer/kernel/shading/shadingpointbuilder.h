@@ -31,6 +31,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/global.h"
+#include "renderer/kernel/shading/shadingray.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/basis.h"
@@ -54,6 +55,7 @@ class ShadingPointBuilder
     explicit ShadingPointBuilder(ShadingPoint& shading_point);
 
     void set_scene(const Scene* scene);
+    void set_ray(const ShadingRay& ray);
     void set_point(const foundation::Vector3d& point);
     void set_geometric_normal(const foundation::Vector3d& n);
     void set_shading_normal(const foundation::Vector3d& n);
@@ -59,9 +59,10 @@ class ShadingRay
     // Public members.
     double          m_time;
     RayFlagsType    m_flags;
+    double          m_spread;                   // growth of the ray footprint width per unit of distance, 0 if unknown
 
     // Constructors.
-    ShadingRay();                               // leave all fields uninitialized
+    ShadingRay();                               // leave all fields uninitialized, except the spread which is set to 0
     ShadingRay(
         const RayType&              ray,
         const double                time,
@@ -96,6 +97,7 @@ ShadingRay transform_to_parent(
 //
 
 inline ShadingRay::ShadingRay()
+  : m_spread(0.0)
 {
 }
 
@@ -106,6 +108,7 @@ inline ShadingRay::ShadingRay(
   : RayType(ray)
   , m_time(time)
   , m_flags(flags)
+  , m_spread(0.0)
 {
 }
 
@@ -117,6 +120,7 @@ inline ShadingRay::ShadingRay(
   : RayType(org, dir)
   , m_time(time)
   , m_flags(flags)
+  , m_spread(0.0)
 {
 }
 
@@ -130,6 +134,7 @@ inline ShadingRay::ShadingRay(
   : RayType(org, dir, tmin, tmax)
   , m_time(time)
   , m_flags(flags)
+  , m_spread(0.0)
 {
 }
 
@@ -138,10 +143,14 @@ inline ShadingRay transform_to_local(
     const foundation::Transform<U>& transform,
     const ShadingRay&               ray)
 {
-    return ShadingRay(
+    ShadingRay result(
         transform.transform_to_local(ray),
         ray.m_time,
         ray.m_flags);
+
+    result.m_spread = ray.m_spread;
+
+    return result;
 }
 
 template <typename U>
@@ -149,10 +158,14 @@ inline ShadingRay transform_to_parent(
     const foundation::Transform<U>& transform,
     const ShadingRay&               ray)
 {
-    return ShadingRay(
+    ShadingRay result(
         transform.transform_to_parent(ray),
         ray.m_time,
         ray.m_flags);
+
+    result.m_spread = ray.m_spread;
+
+    return result;
 }
 
 }       // namespace renderer
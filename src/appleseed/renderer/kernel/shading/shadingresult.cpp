@@ -55,7 +55,7 @@ namespace
     inline void transform_spectrum_to_linear_rgb(const LightingConditions& lighting, Spectrum& s)
     {
         Color3f& linear_rgb = *reinterpret_cast<Color3f*>(&s[0]);
-        linear_rgb = ciexyz_to_linear_rgb(spectrum_to_ciexyz<float>(lighting, s));
+        linear_rgb = spectrum_to_linear_rgb<float>(lighting, s);
     }
 }
 
@@ -147,24 +147,34 @@ void ShadingResult::transform_to_spectrum(
 
 void ShadingResult::composite_over(const ShadingResult& other)
 {
-    assert(m_color_space == ColorSpaceLinearRGB);
-    assert(other.m_color_space == ColorSpaceLinearRGB);
+    assert(m_color_space == other.m_color_space);
+    assert(m_color_space != ColorSpaceSRGB);
 
     const Alpha contrib = Alpha(1.0) - m_alpha;
     const Alpha color_contrib = contrib * other.m_alpha;
 
-    m_color[0] += color_contrib[0] * other.m_color[0];
-    m_color[1] += color_contrib[0] * other.m_color[1];
-    m_color[2] += color_contrib[0] * other.m_color[2];
-
-    for (size_t i = 0; i < m_aovs.size(); ++i)
+    if (m_color_space == ColorSpaceSpectral)
     {
-        const Spectrum& other_aov_color = other.m_aovs[i];
-        Spectrum& aov_color = m_aovs[i];
+        madd(m_color, other.m_color, color_contrib[0]);
 
-        aov_color[0] += color_contrib[0] * other_aov_color[0];
-        aov_color[1] += color_contrib[0] * other_aov_color[1];
-        aov_color[2] += color_contrib[0] * other_aov_color[2];
+        for (size_t i = 0; i < m_aovs.size(); ++i)
+            madd(m_aovs[i], other.m_aovs[i], color_contrib[0]);
+    }
+    else
+    {
+        m_color[0] += color_contrib[0] * other.m_color[0];
+        m_color[1] += color_contrib[0] * other.m_color[1];
+        m_color[2] += color_contrib[0] * other.m_color[2];
+
+        for (size_t i = 0; i < m_aovs.size(); ++i)
+        {
+            const Spectrum& other_aov_color = other.m_aovs[i];
+            Spectrum& aov_color = m_aovs[i];
+
+            aov_color[0] += color_contrib[0] * other_aov_color[0];
+            aov_color[1] += color_contrib[0] * other_aov_color[1];
+            aov_color[2] += color_contrib[0] * other_aov_color[2];
+        }
     }
 
     m_alpha += contrib * other.m_alpha;
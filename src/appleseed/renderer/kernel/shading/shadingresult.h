@@ -56,6 +56,9 @@ class ShadingResult
     // Set the shading result to transparent black in linear RGB.
     void clear();
 
+    // Set the shading result to transparent black in a given color space.
+    void clear(const foundation::ColorSpace color_space);
+
     // Set the shading result to a given linear RGBA value.
     void set_to_linear_rgba(const foundation::Color4f& linear_rgba);
 
@@ -73,6 +76,8 @@ class ShadingResult
     // Set the shading result to solid pink (used for debugging).
     void set_to_solid_pink();
 
+    // Composite another shading result below this one. Both shading results
+    // must be in the same color space, which must be linear (not sRGB).
     void composite_over(const ShadingResult& other);
 };
 
@@ -94,6 +99,14 @@ inline void ShadingResult::clear()
     m_aovs.set(0.0f);
 }
 
+inline void ShadingResult::clear(const foundation::ColorSpace color_space)
+{
+    m_color_space = color_space;
+    m_color.set(0.0f);
+    m_alpha.set(0.0f);
+    m_aovs.set(0.0f);
+}
+
 inline void ShadingResult::set_to_linear_rgba(const foundation::Color4f& linear_rgba)
 {
     m_color_space = foundation::ColorSpaceLinearRGB;
@@ -35,12 +35,10 @@
 
 // appleseed.foundation headers.
 #include "foundation/utility/attributeset.h"
+#include "foundation/utility/containers/mappablevector.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/poolallocator.h"
 
-// Standard headers.
-#include <vector>
-
 namespace renderer
 {
 
@@ -56,10 +54,10 @@ class StaticTessellation
     // Primitive type.
     typedef Primitive PrimitiveType;
 
-    // Vertex and primitive array types.
-    // todo: use paged arrays?
-    typedef std::vector<GVector3> VectorArray;
-    typedef std::vector<PrimitiveType> PrimitiveArray;
+    // Vertex and primitive array types. These arrays may refer to
+    // geometry stored in a memory-mapped file (see MeshObject).
+    typedef foundation::MappableVector<GVector3> VectorArray;
+    typedef foundation::MappableVector<PrimitiveType> PrimitiveArray;
 
     VectorArray                 m_vertices;                 // vertex array
     VectorArray                 m_vertex_normals;           // vertex normal array
@@ -30,10 +30,6 @@
 #include "texturecache.h"
 
 // appleseed.renderer headers.
-#include "renderer/modeling/scene/assembly.h"
-#include "renderer/modeling/scene/containers.h"
-#include "renderer/modeling/scene/scene.h"
-#include "renderer/modeling/texture/texture.h"
 #include "renderer/utility/cache.h"
 
 // appleseed.foundation headers.
@@ -50,69 +46,10 @@ namespace renderer
 //  TextureCache class implementation.
 //
 
-namespace
-{
-    // Convert a tile from the sRGB color space to the linear RGB color space.
-    void convert_tile_srgb_to_linear_rgb(Tile& tile)
-    {
-        const size_t pixel_count = tile.get_pixel_count();
-        const size_t channel_count = tile.get_channel_count();
-        assert(channel_count == 3 || channel_count == 4);
-
-        if (channel_count == 3)
-        {
-            for (size_t i = 0; i < pixel_count; ++i)
-            {
-                Color3f color;
-                tile.get_pixel(i, color);
-                tile.set_pixel(i, srgb_to_linear_rgb(color));
-            }
-        }
-        else
-        {
-            for (size_t i = 0; i < pixel_count; ++i)
-            {
-                Color4f color;
-                tile.get_pixel(i, color);
-                color.rgb() = srgb_to_linear_rgb(color.rgb());
-                tile.set_pixel(i, color);
-            }
-        }
-    }
-
-    // Convert a tile from the CIE XYZ color space to the linear RGB color space.
-    void convert_tile_ciexyz_to_linear_rgb(Tile& tile)
-    {
-        const size_t pixel_count = tile.get_pixel_count();
-        const size_t channel_count = tile.get_channel_count();
-        assert(channel_count == 3 || channel_count == 4);
-
-        if (channel_count == 3)
-        {
-            for (size_t i = 0; i < pixel_count; ++i)
-            {
-                Color3f color;
-                tile.get_pixel(i, color);
-                tile.set_pixel(i, ciexyz_to_linear_rgb(color));
-            }
-        }
-        else
-        {
-            for (size_t i = 0; i < pixel_count; ++i)
-            {
-                Color4f color;
-                tile.get_pixel(i, color);
-                color.rgb() = ciexyz_to_linear_rgb(color.rgb());
-                tile.set_pixel(i, color);
-            }
-        }
-    }
-}
-
 TextureCache::TextureCache(
-    const Scene&    scene,
+    TextureStore&   texture_store,
     const size_t    memory_limit)
-  : m_tile_swapper(scene, memory_limit)
+  : m_tile_swapper(texture_store, memory_limit)
   , m_tile_cache(m_tile_key_hasher, m_tile_swapper, TileKey::invalid())
 {
 }
@@ -128,9 +65,9 @@ TextureCache::~TextureCache()
 //
 
 TextureCache::TileSwapper::TileSwapper(
-    const Scene&    scene,
+    TextureStore&   texture_store,
     const size_t    memory_limit)
-  : m_scene(scene)
+  : m_texture_store(texture_store)
   , m_memory_limit(memory_limit)
   , m_memory_size(0)
 {
@@ -139,77 +76,22 @@ TextureCache::TileSwapper::TileSwapper(
 
 void TextureCache::TileSwapper::load(const TileKey& key, TilePtr& tile)
 {
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == ~UniqueID(0)
-            ? m_scene.textures()
-            : m_scene.assemblies().get_by_uid(key.m_assembly_uid)->textures();
-
-    // Fetch the texture.
-    assert(key.m_texture_index < textures.size());
-    Texture* texture = textures.get_by_index(key.m_texture_index);
-
-/*
-    RENDERER_LOG_DEBUG(
-        "loading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") "
-        "from texture \"%s\"",
-        key.m_tile_x,
-        key.m_tile_y,
-        texture->get_name());
-*/
-
-    // Load the tile.
-    tile = texture->load_tile(key.m_tile_x, key.m_tile_y);
-
-    // Convert the tile to the linear RGB color space.
-    switch (texture->get_color_space())
-    {
-      case ColorSpaceLinearRGB:
-        break;
+    // Acquire the tile from the texture store, which loads it if no other thread holds it.
+    tile = m_texture_store.acquire(key);
 
-      case ColorSpaceSRGB:
-        convert_tile_srgb_to_linear_rgb(*tile);
-        break;
-
-      case ColorSpaceCIEXYZ:
-        convert_tile_ciexyz_to_linear_rgb(*tile);
-        break;
-
-      assert_otherwise;
-    }
-
-    // Track the amount of memory used by the tile cache.
+    // Track the amount of memory held by this cache.
     m_memory_size += dynamic_sizeof(*tile);
 }
 
 void TextureCache::TileSwapper::unload(const TileKey& key, TilePtr& tile)
 {
-    // Track the amount of memory used by the tile cache.
+    // Track the amount of memory held by this cache.
     const size_t tile_memory_size = dynamic_sizeof(*tile);
     assert(m_memory_size >= tile_memory_size);
     m_memory_size -= tile_memory_size;
 
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == ~UniqueID(0)
-            ? m_scene.textures()
-            : m_scene.assemblies().get_by_uid(key.m_assembly_uid)->textures();
-
-    // Fetch the texture.
-    assert(key.m_texture_index < textures.size());
-    Texture* texture = textures.get_by_index(key.m_texture_index);
-
-/*
-    RENDERER_LOG_DEBUG(
-        "unloading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") "
-        "from texture \"%s\"",
-        key.m_tile_x,
-        key.m_tile_y,
-        texture->get_name());
-*/
-
-    // Unload the tile.
-    texture->unload_tile(key.m_tile_x, key.m_tile_y, tile);
+    // Release the tile back to the texture store.
+    m_texture_store.release(key);
 }
 
 bool TextureCache::TileSwapper::is_full(const size_t element_count) const
@@ -31,20 +31,17 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/global.h"
+#include "renderer/kernel/texturing/texturestore.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/tile.h"
-#include "foundation/math/hash.h"
 #include "foundation/utility/cache.h"
 
-// Forward declarations.
-namespace renderer      { class Scene; }
-
 namespace renderer
 {
 
 //
-// A thread-local cache of texture tiles.
+// A thread-local cache of texture tiles, backed by a texture store shared by all threads.
 //
 
 class TextureCache
@@ -52,16 +49,17 @@ class TextureCache
   public:
     // Constructor.
     TextureCache(
-        const Scene&                scene,
+        TextureStore&               texture_store,
         const size_t                memory_limit);
 
     // Destructor.
     ~TextureCache();
 
-    // Get a tile from the cache.
+    // Get a tile of a given level of the mipmap pyramid of a texture from the cache.
     foundation::Tile& get(
         const foundation::UniqueID  assembly_uid,
         const size_t                texture_index,
+        const size_t                level,
         const size_t                tile_x,
         const size_t                tile_y);
 
@@ -74,27 +72,8 @@ class TextureCache
     foundation::uint64 get_stage1_miss_count() const;
 
   private:
-    struct TileKey
-    {
-        foundation::UniqueID        m_assembly_uid;
-        size_t                      m_texture_index;
-        size_t                      m_tile_x;
-        size_t                      m_tile_y;
-
-        // Return an invalid key.
-        static TileKey invalid();
-
-        // Comparison operators.
-        bool operator==(const TileKey& rhs) const;
-        bool operator<(const TileKey& rhs) const;
-    };
-
-    struct TileKeyHasher
-      : public foundation::NonCopyable
-    {
-        // Hash a key into an integer.
-        size_t operator()(const TileKey& key) const;
-    };
+    typedef TextureStore::TileKey TileKey;
+    typedef TextureStore::TileKeyHasher TileKeyHasher;
 
     typedef foundation::Tile* TilePtr;
 
@@ -104,7 +83,7 @@ class TextureCache
       public:
         // Constructor.
         TileSwapper(
-            const Scene&            scene,
+            TextureStore&           texture_store,
             const size_t            memory_limit);
 
         // Load a cache line.
@@ -117,7 +96,7 @@ class TextureCache
         bool is_full(const size_t element_count) const;
             
       private:
-        const Scene&                m_scene;
+        TextureStore&               m_texture_store;
         const size_t                m_memory_limit;
         size_t                      m_memory_size;
     };
@@ -144,6 +123,7 @@ class TextureCache
 inline foundation::Tile& TextureCache::get(
     const foundation::UniqueID      assembly_uid,
     const size_t                    texture_index,
+    const size_t                    level,
     const size_t                    tile_x,
     const size_t                    tile_y)
 {
@@ -151,6 +131,7 @@ inline foundation::Tile& TextureCache::get(
     TileKey key;
     key.m_assembly_uid = assembly_uid;
     key.m_texture_index = texture_index;
+    key.m_level = level;
     key.m_tile_x = tile_x;
     key.m_tile_y = tile_y;
 
@@ -181,56 +162,6 @@ inline foundation::uint64 TextureCache::get_stage1_miss_count() const
     return m_tile_cache.get_stage1_miss_count();
 }
 
-
-//
-// TextureCache::TileKey class implementation.
-//
-
-inline TextureCache::TileKey TextureCache::TileKey::invalid()
-{
-    TileKey key;
-    key.m_assembly_uid = ~foundation::UniqueID(0);
-    key.m_texture_index = ~size_t(0);
-    key.m_tile_x = ~size_t(0);
-    key.m_tile_y = ~size_t(0);
-    return key;
-}
-
-inline bool TextureCache::TileKey::operator==(const TileKey& rhs) const
-{
-    return
-        m_assembly_uid == rhs.m_assembly_uid &&
-        m_texture_index == rhs.m_texture_index &&
-        m_tile_x == rhs.m_tile_x &&
-        m_tile_y == rhs.m_tile_y;
-}
-
-inline bool TextureCache::TileKey::operator<(const TileKey& rhs) const
-{
-    return
-        m_assembly_uid < rhs.m_assembly_uid ? true :
-        m_assembly_uid > rhs.m_assembly_uid ? false :
-        m_texture_index < rhs.m_texture_index ? true :
-        m_texture_index > rhs.m_texture_index ? false :
-        m_tile_y < rhs.m_tile_y ? true :
-        m_tile_y > rhs.m_tile_y ? false :
-        m_tile_x < rhs.m_tile_x;
-}
-
-
-//
-// TextureCache::TileKeyHasher class implementation.
-//
-
-inline size_t TextureCache::TileKeyHasher::operator()(const TileKey& key) const
-{
-    return foundation::mix32(
-        static_cast<foundation::uint32>(key.m_assembly_uid),
-        static_cast<foundation::uint32>(key.m_texture_index),
-        static_cast<foundation::uint32>(key.m_tile_x),
-        static_cast<foundation::uint32>(key.m_tile_y));
-}
-
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTURECACHE_H
@@ -0,0 +1,484 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "texturestore.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/texture/texture.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/thread.h"
+#include "foundation/utility/profiler.h"
+
+// boost headers.
+#include "boost/thread/condition_variable.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <list>
+#include <map>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// TextureStore class implementation.
+//
+
+namespace
+{
+    // Convert a tile from the sRGB color space to the linear RGB color space.
+    void convert_tile_srgb_to_linear_rgb(Tile& tile)
+    {
+        const size_t pixel_count = tile.get_pixel_count();
+        const size_t channel_count = tile.get_channel_count();
+        assert(channel_count == 3 || channel_count == 4);
+
+        if (channel_count == 3)
+        {
+            for (size_t i = 0; i < pixel_count; ++i)
+            {
+                Color3f color;
+                tile.get_pixel(i, color);
+                tile.set_pixel(i, srgb_to_linear_rgb(color));
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < pixel_count; ++i)
+            {
+                Color4f color;
+                tile.get_pixel(i, color);
+                color.rgb() = srgb_to_linear_rgb(color.rgb());
+                tile.set_pixel(i, color);
+            }
+        }
+    }
+
+    // Convert a tile from the CIE XYZ color space to the linear RGB color space.
+    void convert_tile_ciexyz_to_linear_rgb(Tile& tile)
+    {
+        const size_t pixel_count = tile.get_pixel_count();
+        const size_t channel_count = tile.get_channel_count();
+        assert(channel_count == 3 || channel_count == 4);
+
+        if (channel_count == 3)
+        {
+            for (size_t i = 0; i < pixel_count; ++i)
+            {
+                Color3f color;
+                tile.get_pixel(i, color);
+                tile.set_pixel(i, ciexyz_to_linear_rgb(color));
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < pixel_count; ++i)
+            {
+                Color4f color;
+                tile.get_pixel(i, color);
+                color.rgb() = ciexyz_to_linear_rgb(color.rgb());
+                tile.set_pixel(i, color);
+            }
+        }
+    }
+
+    // Number of independently locked shards.
+    const size_t ShardCount = 16;
+}
+
+struct TextureStore::Impl
+{
+    typedef list<TileKey> KeyList;
+
+    struct Entry
+    {
+        Tile*                   m_tile;             // 0 while the tile is being loaded
+        size_t                  m_ref_count;
+        KeyList::iterator       m_lru_position;     // only valid when m_ref_count == 0
+    };
+
+    typedef map<TileKey, Entry> EntryMap;
+
+    struct Shard
+    {
+        boost::mutex                m_mutex;
+        boost::condition_variable   m_tile_loaded;
+        EntryMap                    m_entries;
+        KeyList                     m_lru;          // tiles not held by anyone, least recently released first
+        size_t                      m_memory_size;
+        uint64                      m_hit_count;
+        uint64                      m_miss_count;
+    };
+
+    const Scene&                    m_scene;
+    const size_t                    m_shard_memory_limit;
+    TileKeyHasher                   m_key_hasher;
+    Shard                           m_shards[ShardCount];
+
+    Impl(
+        const Scene&                scene,
+        const size_t                memory_limit)
+      : m_scene(scene)
+      , m_shard_memory_limit(memory_limit / ShardCount)
+    {
+        for (size_t i = 0; i < ShardCount; ++i)
+        {
+            m_shards[i].m_memory_size = 0;
+            m_shards[i].m_hit_count = 0;
+            m_shards[i].m_miss_count = 0;
+        }
+    }
+
+    Shard& get_shard(const TileKey& key)
+    {
+        return m_shards[m_key_hasher(key) % ShardCount];
+    }
+
+    Texture* get_texture(const TileKey& key) const
+    {
+        // Fetch the texture container.
+        const TextureContainer& textures =
+            key.m_assembly_uid == ~UniqueID(0)
+                ? m_scene.textures()
+                : m_scene.assemblies().get_by_uid(key.m_assembly_uid)->textures();
+
+        // Fetch the texture.
+        assert(key.m_texture_index < textures.size());
+        return textures.get_by_index(key.m_texture_index);
+    }
+
+    Tile* load_tile(TextureStore& store, const TileKey& key) const
+    {
+        FOUNDATION_PROFILE_ZONE("TextureStore::load_tile");
+
+        Texture* texture = get_texture(key);
+
+        // Tiles of coarser levels are generated from tiles already in the linear RGB color space.
+        if (key.m_level > 0)
+            return generate_level_tile(store, *texture, key);
+
+        // Load the tile.
+        Tile* tile = texture->load_tile(key.m_tile_x, key.m_tile_y);
+
+        // Convert the tile to the linear RGB color space.
+        switch (texture->get_color_space())
+        {
+          case ColorSpaceLinearRGB:
+            break;
+
+          case ColorSpaceSRGB:
+            convert_tile_srgb_to_linear_rgb(*tile);
+            break;
+
+          case ColorSpaceCIEXYZ:
+            convert_tile_ciexyz_to_linear_rgb(*tile);
+            break;
+
+          assert_otherwise;
+        }
+
+        return tile;
+    }
+
+    void unload_tile(const TileKey& key, Tile* tile) const
+    {
+        if (key.m_level > 0)
+            delete tile;
+        else get_texture(key)->unload_tile(key.m_tile_x, key.m_tile_y, tile);
+    }
+
+    // Generate a tile of a level other than 0 of the mipmap pyramid of a texture.
+    // Each texel is the average of the texels of the level above that it covers:
+    // texel x covers [x * src_w / dst_w, (x + 1) * src_w / dst_w), which handles odd sizes.
+    static Tile* generate_level_tile(
+        TextureStore&       store,
+        Texture&            texture,
+        const TileKey&      key)
+    {
+        const CanvasProperties& src_props = texture.get_level_properties(key.m_level - 1);
+        const CanvasProperties& dst_props = texture.get_level_properties(key.m_level);
+        const size_t channel_count = dst_props.m_channel_count;
+
+        // Compute the destination texels covered by the tile.
+        const size_t dst_x0 = key.m_tile_x * dst_props.m_tile_width;
+        const size_t dst_y0 = key.m_tile_y * dst_props.m_tile_height;
+        const size_t dst_width = dst_props.get_tile_width(key.m_tile_x);
+        const size_t dst_height = dst_props.get_tile_height(key.m_tile_y);
+
+        // Compute the source tiles covered by the tile.
+        const size_t src_tx0 = (dst_x0 * src_props.m_canvas_width / dst_props.m_canvas_width) / src_props.m_tile_width;
+        const size_t src_ty0 = (dst_y0 * src_props.m_canvas_height / dst_props.m_canvas_height) / src_props.m_tile_height;
+        const size_t src_tx1 = ((dst_x0 + dst_width) * src_props.m_canvas_width / dst_props.m_canvas_width - 1) / src_props.m_tile_width;
+        const size_t src_ty1 = ((dst_y0 + dst_height) * src_props.m_canvas_height / dst_props.m_canvas_height - 1) / src_props.m_tile_height;
+        const size_t src_tile_count_x = src_tx1 - src_tx0 + 1;
+
+        // Enumerate the source tiles.
+        vector<TileKey> src_keys;
+        for (size_t src_ty = src_ty0; src_ty <= src_ty1; ++src_ty)
+        {
+            for (size_t src_tx = src_tx0; src_tx <= src_tx1; ++src_tx)
+            {
+                TileKey src_key = key;
+                src_key.m_level = key.m_level - 1;
+                src_key.m_tile_x = src_tx;
+                src_key.m_tile_y = src_ty;
+                src_keys.push_back(src_key);
+            }
+        }
+
+        // Acquire the source tiles, releasing the ones already acquired if loading fails.
+        vector<const Tile*> src_tiles;
+        try
+        {
+            for (size_t i = 0; i < src_keys.size(); ++i)
+                src_tiles.push_back(store.acquire(src_keys[i]));
+        }
+        catch (...)
+        {
+            for (size_t i = 0; i < src_tiles.size(); ++i)
+                store.release(src_keys[i]);
+            throw;
+        }
+
+        Tile* tile = new Tile(dst_width, dst_height, channel_count, dst_props.m_pixel_format);
+        vector<float> sum(channel_count);
+
+        for (size_t py = 0; py < dst_height; ++py)
+        {
+            const size_t dst_y = dst_y0 + py;
+            const size_t sy0 = dst_y * src_props.m_canvas_height / dst_props.m_canvas_height;
+            const size_t sy1 = (dst_y + 1) * src_props.m_canvas_height / dst_props.m_canvas_height;
+
+            for (size_t px = 0; px < dst_width; ++px)
+            {
+                const size_t dst_x = dst_x0 + px;
+                const size_t sx0 = dst_x * src_props.m_canvas_width / dst_props.m_canvas_width;
+                const size_t sx1 = (dst_x + 1) * src_props.m_canvas_width / dst_props.m_canvas_width;
+
+                fill(sum.begin(), sum.end(), 0.0f);
+
+                for (size_t sy = sy0; sy < sy1; ++sy)
+                {
+                    const size_t src_row = sy / src_props.m_tile_height - src_ty0;
+                    const size_t ty = sy % src_props.m_tile_height;
+
+                    for (size_t sx = sx0; sx < sx1; ++sx)
+                    {
+                        const size_t src_column = sx / src_props.m_tile_width - src_tx0;
+                        const size_t tx = sx % src_props.m_tile_width;
+                        const Tile& src_tile = *src_tiles[src_row * src_tile_count_x + src_column];
+
+                        for (size_t c = 0; c < channel_count; ++c)
+                            sum[c] += src_tile.get_component<float>(tx, ty, c);
+                    }
+                }
+
+                const float rcp_count = 1.0f / static_cast<float>((sx1 - sx0) * (sy1 - sy0));
+
+                for (size_t c = 0; c < channel_count; ++c)
+                    tile->set_component(px, py, c, sum[c] * rcp_count);
+            }
+        }
+
+        // Release the source tiles.
+        for (size_t i = 0; i < src_keys.size(); ++i)
+            store.release(src_keys[i]);
+
+        return tile;
+    }
+
+    // Evict tiles that are not held by anyone until the shard fits in its budget.
+    // The shard must be locked.
+    void evict(Shard& shard)
+    {
+        while (shard.m_memory_size > m_shard_memory_limit && !shard.m_lru.empty())
+        {
+            const TileKey key = shard.m_lru.front();
+            shard.m_lru.pop_front();
+
+            const EntryMap::iterator i = shard.m_entries.find(key);
+            assert(i != shard.m_entries.end());
+            assert(i->second.m_ref_count == 0);
+
+            shard.m_memory_size -= dynamic_sizeof(*i->second.m_tile);
+            unload_tile(key, i->second.m_tile);
+            shard.m_entries.erase(i);
+        }
+    }
+};
+
+TextureStore::TextureStore(
+    const Scene&    scene,
+    const size_t    memory_limit)
+  : impl(new Impl(scene, memory_limit))
+{
+}
+
+TextureStore::~TextureStore()
+{
+    for (size_t s = 0; s < ShardCount; ++s)
+    {
+        Impl::Shard& shard = impl->m_shards[s];
+
+        for (Impl::EntryMap::iterator i = shard.m_entries.begin(); i != shard.m_entries.end(); ++i)
+        {
+            assert(i->second.m_ref_count == 0);
+            impl->unload_tile(i->first, i->second.m_tile);
+        }
+    }
+
+    delete impl;
+}
+
+Tile* TextureStore::acquire(const TileKey& key)
+{
+    Impl::Shard& shard = impl->get_shard(key);
+
+    boost::mutex::scoped_lock lock(shard.m_mutex);
+
+    while (true)
+    {
+        const Impl::EntryMap::iterator i = shard.m_entries.find(key);
+
+        if (i == shard.m_entries.end())
+            break;
+
+        Impl::Entry& entry = i->second;
+
+        if (entry.m_tile == 0)
+        {
+            // Another thread is loading this tile: wait for it, then look the tile up again.
+            shard.m_tile_loaded.wait(lock);
+            continue;
+        }
+
+        if (entry.m_ref_count++ == 0)
+            shard.m_lru.erase(entry.m_lru_position);
+
+        ++shard.m_hit_count;
+
+        return entry.m_tile;
+    }
+
+    // Insert a placeholder entry so that concurrent requests for this tile wait for us.
+    Impl::Entry& entry = shard.m_entries[key];
+    entry.m_tile = 0;
+    entry.m_ref_count = 1;
+
+    ++shard.m_miss_count;
+
+    // Load the tile without holding the lock.
+    Tile* tile;
+    lock.unlock();
+
+    try
+    {
+        tile = impl->load_tile(*this, key);
+    }
+    catch (...)
+    {
+        // Let waiting threads retry the load.
+        lock.lock();
+        shard.m_entries.erase(key);
+        shard.m_tile_loaded.notify_all();
+        throw;
+    }
+
+    lock.lock();
+
+    // Entries are never erased while they are being loaded, the reference is still valid.
+    entry.m_tile = tile;
+    shard.m_memory_size += dynamic_sizeof(*tile);
+    impl->evict(shard);
+
+    shard.m_tile_loaded.notify_all();
+
+    return tile;
+}
+
+void TextureStore::release(const TileKey& key)
+{
+    Impl::Shard& shard = impl->get_shard(key);
+
+    boost::mutex::scoped_lock lock(shard.m_mutex);
+
+    const Impl::EntryMap::iterator i = shard.m_entries.find(key);
+    assert(i != shard.m_entries.end());
+
+    Impl::Entry& entry = i->second;
+    assert(entry.m_tile);
+    assert(entry.m_ref_count > 0);
+
+    if (--entry.m_ref_count == 0)
+    {
+        entry.m_lru_position = shard.m_lru.insert(shard.m_lru.end(), key);
+        impl->evict(shard);
+    }
+}
+
+uint64 TextureStore::get_hit_count() const
+{
+    uint64 count = 0;
+
+    for (size_t s = 0; s < ShardCount; ++s)
+    {
+        boost::mutex::scoped_lock lock(impl->m_shards[s].m_mutex);
+        count += impl->m_shards[s].m_hit_count;
+    }
+
+    return count;
+}
+
+uint64 TextureStore::get_miss_count() const
+{
+    uint64 count = 0;
+
+    for (size_t s = 0; s < ShardCount; ++s)
+    {
+        boost::mutex::scoped_lock lock(impl->m_shards[s].m_mutex);
+        count += impl->m_shards[s].m_miss_count;
+    }
+
+    return count;
+}
+
+}   // namespace renderer
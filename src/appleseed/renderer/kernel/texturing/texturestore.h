@@ -0,0 +1,172 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTURESTORE_H
+#define APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTURESTORE_H
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/hash.h"
+
+// Forward declarations.
+namespace foundation    { class Tile; }
+namespace renderer      { class Scene; }
+
+namespace renderer
+{
+
+//
+// A cache of texture tiles shared by all rendering threads.
+//
+// Tiles are reference-counted: a tile stays in memory as long as at least one
+// thread holds it. Tiles that are no longer held are evicted in least recently
+// released order when the store exceeds its memory budget. Concurrent requests
+// for the same tile cause a single load. The store is split into independently
+// locked shards to limit contention; the memory budget is split evenly across shards.
+//
+// Tiles of level 0 of the mipmap pyramid of a texture are loaded from the texture.
+// Tiles of coarser levels are generated on demand by box filtering the tiles of
+// the level above, themselves acquired from the store, and count against the
+// memory budget like any other tile.
+//
+
+class TextureStore
+  : public foundation::NonCopyable
+{
+  public:
+    struct TileKey
+    {
+        foundation::UniqueID        m_assembly_uid;
+        size_t                      m_texture_index;
+        size_t                      m_level;
+        size_t                      m_tile_x;
+        size_t                      m_tile_y;
+
+        // Return an invalid key.
+        static TileKey invalid();
+
+        // Comparison operators.
+        bool operator==(const TileKey& rhs) const;
+        bool operator<(const TileKey& rhs) const;
+    };
+
+    struct TileKeyHasher
+      : public foundation::NonCopyable
+    {
+        // Hash a key into an integer.
+        size_t operator()(const TileKey& key) const;
+    };
+
+    // Constructor.
+    TextureStore(
+        const Scene&                scene,
+        const size_t                memory_limit);
+
+    // Destructor.
+    ~TextureStore();
+
+    // Acquire a tile, loading it if necessary. The tile is converted to the linear
+    // RGB color space. Every call must be balanced by a call to release().
+    foundation::Tile* acquire(const TileKey& key);
+
+    // Release a tile previously acquired with acquire().
+    void release(const TileKey& key);
+
+    // Return the number of tile requests that found the tile in the store.
+    foundation::uint64 get_hit_count() const;
+
+    // Return the number of tile requests that caused a tile to be loaded.
+    foundation::uint64 get_miss_count() const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+
+//
+// TextureStore::TileKey class implementation.
+//
+
+inline TextureStore::TileKey TextureStore::TileKey::invalid()
+{
+    TileKey key;
+    key.m_assembly_uid = ~foundation::UniqueID(0);
+    key.m_texture_index = ~size_t(0);
+    key.m_level = ~size_t(0);
+    key.m_tile_x = ~size_t(0);
+    key.m_tile_y = ~size_t(0);
+    return key;
+}
+
+inline bool TextureStore::TileKey::operator==(const TileKey& rhs) const
+{
+    return
+        m_assembly_uid == rhs.m_assembly_uid &&
+        m_texture_index == rhs.m_texture_index &&
+        m_level == rhs.m_level &&
+        m_tile_x == rhs.m_tile_x &&
+        m_tile_y == rhs.m_tile_y;
+}
+
+inline bool TextureStore::TileKey::operator<(const TileKey& rhs) const
+{
+    return
+        m_assembly_uid < rhs.m_assembly_uid ? true :
+        m_assembly_uid > rhs.m_assembly_uid ? false :
+        m_texture_index < rhs.m_texture_index ? true :
+        m_texture_index > rhs.m_texture_index ? false :
+        m_level < rhs.m_level ? true :
+        m_level > rhs.m_level ? false :
+        m_tile_y < rhs.m_tile_y ? true :
+        m_tile_y > rhs.m_tile_y ? false :
+        m_tile_x < rhs.m_tile_x;
+}
+
+
+//
+// TextureStore::TileKeyHasher class implementation.
+//
+
+inline size_t TextureStore::TileKeyHasher::operator()(const TileKey& key) const
+{
+    return foundation::mix32(
+        static_cast<foundation::uint32>(key.m_assembly_uid),
+        foundation::mix32(
+            static_cast<foundation::uint32>(key.m_texture_index),
+            static_cast<foundation::uint32>(key.m_level)),
+        static_cast<foundation::uint32>(key.m_tile_x),
+        static_cast<foundation::uint32>(key.m_tile_y));
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTURESTORE_H
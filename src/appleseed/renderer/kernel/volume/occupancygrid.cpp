@@ -29,92 +29,559 @@
 // Interface header.
 #include "occupancygrid.h"
 
+// appleseed.foundation headers.
+#include "foundation/math/minmax.h"
+
+// Standard headers.
+#include <algorithm>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
+namespace
+{
+    // Return false if the values of the voxels of a brick and of its neighbors are known to be all zero.
+    bool may_have_values_near_brick(
+        const VoxelGrid&        /*voxel_grid*/,
+        const size_t            /*bx*/,
+        const size_t            /*by*/,
+        const size_t            /*bz*/)
+    {
+        return true;
+    }
+
+    bool may_have_values_near_brick(
+        const SparseVoxelGrid&  voxel_grid,
+        const size_t            bx,
+        const size_t            by,
+        const size_t            bz)
+    {
+        const size_t BrickSizeLog2 = SparseVoxelGrid::BrickSizeLog2;
+        const size_t BrickMask = SparseVoxelGrid::BrickSize - 1;
+        const size_t brick_nx = (voxel_grid.get_xres() + BrickMask) >> BrickSizeLog2;
+        const size_t brick_ny = (voxel_grid.get_yres() + BrickMask) >> BrickSizeLog2;
+        const size_t brick_nz = (voxel_grid.get_zres() + BrickMask) >> BrickSizeLog2;
+
+        for (size_t z = bz > 0 ? bz - 1 : 0; z < min(bz + 2, brick_nz); ++z)
+        {
+            for (size_t y = by > 0 ? by - 1 : 0; y < min(by + 2, brick_ny); ++y)
+            {
+                for (size_t x = bx > 0 ? bx - 1 : 0; x < min(bx + 2, brick_nx); ++x)
+                {
+                    if (voxel_grid.is_allocated_brick(x << BrickSizeLog2, y << BrickSizeLog2, z << BrickSizeLog2))
+                        return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    // Compute the occupancy and the maximum density of the nodes of a level
+    // from those of the 2x2x2 nodes of the level below.
+    void downsample_nodes(
+        const size_t            fine_n,
+        const unsigned char     fine_occupied[],
+        const float             fine_max_density[],
+        unsigned char           coarse_occupied[],
+        float                   coarse_max_density[])
+    {
+        const size_t coarse_n = fine_n / 2;
+
+        for (size_t z = 0; z < coarse_n; ++z)
+        {
+            for (size_t y = 0; y < coarse_n; ++y)
+            {
+                for (size_t x = 0; x < coarse_n; ++x)
+                {
+                    unsigned char occupied = 0;
+                    float max_density = 0.0f;
+
+                    for (size_t dz = 0; dz < 2; ++dz)
+                    {
+                        for (size_t dy = 0; dy < 2; ++dy)
+                        {
+                            for (size_t dx = 0; dx < 2; ++dx)
+                            {
+                                const size_t fine_index =
+                                    ((2 * z + dz) * fine_n + 2 * y + dy) * fine_n + 2 * x + dx;
+
+                                occupied |= fine_occupied[fine_index];
+                                max_density = max(max_density, fine_max_density[fine_index]);
+                            }
+                        }
+                    }
+
+                    const size_t coarse_index = (z * coarse_n + y) * coarse_n + x;
+                    coarse_occupied[coarse_index] = occupied;
+                    coarse_max_density[coarse_index] = max_density;
+                }
+            }
+        }
+    }
+}
+
+
 //
 // OccupancyGrid class implementation.
 //
 
+const uint32 OccupancyGrid::EmptyBrick;
+
 OccupancyGrid::OccupancyGrid(
-    const VoxelGrid&    voxel_grid,
-    const size_t        density_channel_index,
-    const float         occupancy_threshold)
-  : m_grid(
-        voxel_grid.get_xres(),
-        voxel_grid.get_yres(),
-        voxel_grid.get_zres(),
-        1)
+    const VoxelGrid&        voxel_grid,
+    const size_t            density_channel_index,
+    const float             occupancy_threshold)
+  : m_nx(voxel_grid.get_xres())
+  , m_ny(voxel_grid.get_yres())
+  , m_nz(voxel_grid.get_zres())
+  , m_scalar_nx(static_cast<double>(m_nx))
+  , m_scalar_ny(static_cast<double>(m_ny))
+  , m_scalar_nz(static_cast<double>(m_nz))
+  , m_max_x(static_cast<double>(m_nx - 1))
+  , m_max_y(static_cast<double>(m_ny - 1))
+  , m_max_z(static_cast<double>(m_nz - 1))
+  , m_level_count(0)
 {
-    initialize(
+    build_levels(
         voxel_grid,
         density_channel_index,
         occupancy_threshold);
 }
 
-void OccupancyGrid::initialize(
-    const VoxelGrid&    voxel_grid,
+OccupancyGrid::OccupancyGrid(
+    const SparseVoxelGrid&  voxel_grid,
+    const size_t            density_channel_index,
+    const float             occupancy_threshold)
+  : m_nx(voxel_grid.get_xres())
+  , m_ny(voxel_grid.get_yres())
+  , m_nz(voxel_grid.get_zres())
+  , m_scalar_nx(static_cast<double>(m_nx))
+  , m_scalar_ny(static_cast<double>(m_ny))
+  , m_scalar_nz(static_cast<double>(m_nz))
+  , m_max_x(static_cast<double>(m_nx - 1))
+  , m_max_y(static_cast<double>(m_ny - 1))
+  , m_max_z(static_cast<double>(m_nz - 1))
+  , m_level_count(0)
+{
+    build_levels(
+        voxel_grid,
+        density_channel_index,
+        occupancy_threshold);
+}
+
+bool OccupancyGrid::find_empty_node(
+    const Vector3d&     point,
+    AABB3d&             node_bbox) const
+{
+    size_t x, y, z;
+    get_voxel_coordinates(point, x, y, z);
+
+    // Climb the hierarchy as long as the node containing the point is empty.
+    size_t level = 0;
+    while (level < m_level_count && !is_occupied(level, x, y, z))
+        ++level;
+
+    if (level == 0)
+        return false;
+
+    --level;
+    node_bbox = compute_node_bbox(level, x >> level, y >> level, z >> level);
+
+    return true;
+}
+
+float OccupancyGrid::get_max_density(
+    const Vector3d&     point,
+    const size_t        level) const
+{
+    assert(level < m_level_count);
+
+    size_t x, y, z;
+    get_voxel_coordinates(point, x, y, z);
+
+    return get_node_max_density(level, x, y, z);
+}
+
+AABB3d OccupancyGrid::get_node_bbox(
+    const Vector3d&     point,
+    const size_t        level) const
+{
+    assert(level < m_level_count);
+
+    size_t x, y, z;
+    get_voxel_coordinates(point, x, y, z);
+
+    return compute_node_bbox(level, x >> level, y >> level, z >> level);
+}
+
+size_t OccupancyGrid::get_memory_size() const
+{
+    size_t mem_size = sizeof(*this);
+
+    mem_size += m_brick_indices.capacity() * sizeof(uint32);
+    mem_size += m_brick_occupied.capacity() * sizeof(unsigned char);
+    mem_size += m_brick_max_density.capacity() * sizeof(float);
+    mem_size += m_levels.capacity() * sizeof(Level);
+
+    for (size_t i = 0; i < m_levels.size(); ++i)
+    {
+        mem_size += m_levels[i].m_occupied.capacity() * sizeof(unsigned char);
+        mem_size += m_levels[i].m_max_density.capacity() * sizeof(float);
+    }
+
+    return mem_size;
+}
+
+size_t OccupancyGrid::get_build_memory_size()
+{
+    // Two buffers of densities, see build_levels().
+    return 2 * PaddedBrickSize * PaddedBrickSize * PaddedBrickSize * sizeof(float);
+}
+
+template <typename Grid>
+void OccupancyGrid::build_levels(
+    const Grid&         voxel_grid,
     const size_t        density_channel_index,
     const float         occupancy_threshold)
 {
-    for (size_t z = 0; z < m_grid.get_zres(); ++z)
+    // Each level halves the resolution of the level below, down to a single node.
+    m_level_count = 1;
+    for (size_t n = max(m_nx, m_ny, m_nz); n > 1; n = (n + 1) / 2)
+        ++m_level_count;
+
+    // Reserve the dense levels upfront so that they are never copied.
+    const size_t brick_nx = (m_nx + BrickMask) >> BrickSizeLog2;
+    const size_t brick_ny = (m_ny + BrickMask) >> BrickSizeLog2;
+    const size_t brick_nz = (m_nz + BrickMask) >> BrickSizeLog2;
+    size_t dense_level_count = 1;
+    for (size_t n = max(brick_nx, brick_ny, brick_nz); n > 1; n = (n + 1) / 2)
+        ++dense_level_count;
+    m_levels.reserve(dense_level_count);
+
+    // Number the bricks that may contain fluid or have a non-zero maximum density.
+    // A lookup at a point of a voxel involves at most the voxels within a distance
+    // of one (linear interpolation) or two (quadratic interpolation) of that voxel,
+    // hence the maximum density of a voxel is the largest density within two voxels
+    // of it, and a brick without any density within two voxels of it is empty.
+    const size_t brick_count = brick_nx * brick_ny * brick_nz;
+    m_brick_indices.assign(brick_count, EmptyBrick);
+    size_t nonempty_brick_count = 0;
+
+    for (size_t bz = 0; bz < brick_nz; ++bz)
     {
-        for (size_t y = 0; y < m_grid.get_yres(); ++y)
+        for (size_t by = 0; by < brick_ny; ++by)
         {
-            for (size_t x = 0; x < m_grid.get_xres(); ++x)
+            for (size_t bx = 0; bx < brick_nx; ++bx)
             {
-                const float density_sum =
-                    get_density_sum(
-                        voxel_grid,
-                        density_channel_index,
-                        x,
-                        y,
-                        z);
-
-                m_grid.voxel(x, y, z)[0] = density_sum > occupancy_threshold ? 1 : 0;
+                if (occupancy_threshold < 0.0f ||
+                    has_density_near_brick(voxel_grid, density_channel_index, bx, by, bz))
+                {
+                    const size_t brick_index = (bz * brick_ny + by) * brick_nx + bx;
+                    m_brick_indices[brick_index] = static_cast<uint32>(nonempty_brick_count++);
+                }
             }
         }
     }
+
+    assert(nonempty_brick_count < EmptyBrick);
+
+    // Brick level, and levels finer than a brick for the non-empty bricks only.
+    m_levels.push_back(Level());
+    Level& bricks = m_levels.back();
+    bricks.m_nx = brick_nx;
+    bricks.m_ny = brick_ny;
+    bricks.m_nz = brick_nz;
+    bricks.m_occupied.assign(brick_count, 0);
+    bricks.m_max_density.assign(brick_count, 0.0f);
+    m_brick_occupied.resize(nonempty_brick_count * BrickNodeCount);
+    m_brick_max_density.resize(nonempty_brick_count * BrickNodeCount);
+
+    vector<float> densities(PaddedBrickSize * PaddedBrickSize * PaddedBrickSize);
+    vector<float> dilated_densities(densities.size());
+
+    for (size_t bz = 0; bz < brick_nz; ++bz)
+    {
+        for (size_t by = 0; by < brick_ny; ++by)
+        {
+            for (size_t bx = 0; bx < brick_nx; ++bx)
+            {
+                const size_t brick_index = (bz * brick_ny + by) * brick_nx + bx;
+                const uint32 nonempty_brick_index = m_brick_indices[brick_index];
+
+                if (nonempty_brick_index == EmptyBrick)
+                    continue;
+
+                read_padded_brick(
+                    voxel_grid,
+                    density_channel_index,
+                    bx,
+                    by,
+                    bz,
+                    &densities[0]);
+
+                build_brick(
+                    bx,
+                    by,
+                    bz,
+                    occupancy_threshold,
+                    &densities[0],
+                    &dilated_densities[0],
+                    &m_brick_occupied[nonempty_brick_index * BrickNodeCount],
+                    &m_brick_max_density[nonempty_brick_index * BrickNodeCount],
+                    bricks.m_occupied[brick_index],
+                    bricks.m_max_density[brick_index]);
+            }
+        }
+    }
+
+    // Coarser levels: each node covers 2x2x2 nodes of the level below.
+    while (m_levels.back().m_nx > 1 || m_levels.back().m_ny > 1 || m_levels.back().m_nz > 1)
+    {
+        m_levels.push_back(Level());
+        const Level& fine = m_levels[m_levels.size() - 2];
+        Level& coarse = m_levels.back();
+        coarse.m_nx = (fine.m_nx + 1) / 2;
+        coarse.m_ny = (fine.m_ny + 1) / 2;
+        coarse.m_nz = (fine.m_nz + 1) / 2;
+        coarse.m_occupied.assign(coarse.m_nx * coarse.m_ny * coarse.m_nz, 0);
+        coarse.m_max_density.assign(coarse.m_nx * coarse.m_ny * coarse.m_nz, 0.0f);
+
+        for (size_t z = 0; z < fine.m_nz; ++z)
+        {
+            for (size_t y = 0; y < fine.m_ny; ++y)
+            {
+                for (size_t x = 0; x < fine.m_nx; ++x)
+                {
+                    const size_t fine_index = (z * fine.m_ny + y) * fine.m_nx + x;
+                    const size_t coarse_index = ((z / 2) * coarse.m_ny + y / 2) * coarse.m_nx + x / 2;
+
+                    coarse.m_occupied[coarse_index] |= fine.m_occupied[fine_index];
+                    coarse.m_max_density[coarse_index] =
+                        max(coarse.m_max_density[coarse_index], fine.m_max_density[fine_index]);
+                }
+            }
+        }
+    }
+
+    assert(m_levels.size() == dense_level_count);
 }
 
-float OccupancyGrid::get_density_sum(
-    const VoxelGrid&    voxel_grid,
+template <typename Grid>
+void OccupancyGrid::read_padded_brick(
+    const Grid&         voxel_grid,
     const size_t        density_channel_index,
-    const size_t        x,
-    const size_t        y,
-    const size_t        z) const
+    const size_t        bx,
+    const size_t        by,
+    const size_t        bz,
+    float               densities[])
 {
-    float density_sum = 0.0f;
+    const size_t nx = voxel_grid.get_xres();
+    const size_t ny = voxel_grid.get_yres();
+    const size_t nz = voxel_grid.get_zres();
 
-    for (int dx = -1; dx <= +1; ++dx)
+    // Coordinates below zero wrap around and end up outside of the grid as well.
+    for (size_t k = 0; k < PaddedBrickSize; ++k)
     {
-        for (int dy = -1; dy <= +1; ++dy)
+        const size_t z = (bz << BrickSizeLog2) + k - DilationRadius;
+
+        for (size_t j = 0; j < PaddedBrickSize; ++j)
         {
-            for (int dz = -1; dz <= +1; ++dz)
+            const size_t y = (by << BrickSizeLog2) + j - DilationRadius;
+
+            for (size_t i = 0; i < PaddedBrickSize; ++i)
             {
-                const int ix = x + dx;
-                const int iy = y + dy;
-                const int iz = z + dz;
-
-                if (ix < 0 ||
-                    iy < 0 ||
-                    iz < 0 ||
-                    ix >= static_cast<int>(voxel_grid.get_xres()) ||
-                    iy >= static_cast<int>(voxel_grid.get_yres()) ||
-                    iz >= static_cast<int>(voxel_grid.get_zres()))
+                const size_t x = (bx << BrickSizeLog2) + i - DilationRadius;
+
+                *densities++ =
+                    x < nx && y < ny && z < nz
+                        ? voxel_grid.voxel(x, y, z)[density_channel_index]
+                        : 0.0f;
+            }
+        }
+    }
+}
+
+template <typename Grid>
+bool OccupancyGrid::has_density_near_brick(
+    const Grid&         voxel_grid,
+    const size_t        density_channel_index,
+    const size_t        bx,
+    const size_t        by,
+    const size_t        bz)
+{
+    if (!may_have_values_near_brick(voxel_grid, bx, by, bz))
+        return false;
+
+    const size_t x0 = (bx << BrickSizeLog2) > DilationRadius ? (bx << BrickSizeLog2) - DilationRadius : 0;
+    const size_t y0 = (by << BrickSizeLog2) > DilationRadius ? (by << BrickSizeLog2) - DilationRadius : 0;
+    const size_t z0 = (bz << BrickSizeLog2) > DilationRadius ? (bz << BrickSizeLog2) - DilationRadius : 0;
+    const size_t x1 = min(((bx + 1) << BrickSizeLog2) + DilationRadius, voxel_grid.get_xres());
+    const size_t y1 = min(((by + 1) << BrickSizeLog2) + DilationRadius, voxel_grid.get_yres());
+    const size_t z1 = min(((bz + 1) << BrickSizeLog2) + DilationRadius, voxel_grid.get_zres());
+
+    for (size_t z = z0; z < z1; ++z)
+    {
+        for (size_t y = y0; y < y1; ++y)
+        {
+            for (size_t x = x0; x < x1; ++x)
+            {
+                if (voxel_grid.voxel(x, y, z)[density_channel_index] != 0.0f)
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void OccupancyGrid::build_brick(
+    const size_t        bx,
+    const size_t        by,
+    const size_t        bz,
+    const float         occupancy_threshold,
+    float               densities[],
+    float               dilated_densities[],
+    unsigned char       occupied[],
+    float               max_density[],
+    unsigned char&      brick_occupied,
+    float&              brick_max_density) const
+{
+    const size_t P = PaddedBrickSize;
+    const size_t R = DilationRadius;
+
+    // Level 0: occupancy of each voxel, from the densities of the voxel and of its neighbors.
+    for (size_t z = 0; z < BrickSize; ++z)
+    {
+        for (size_t y = 0; y < BrickSize; ++y)
+        {
+            for (size_t x = 0; x < BrickSize; ++x)
+            {
+                const size_t index = (z * BrickSize + y) * BrickSize + x;
+
+                // Voxels of the brick that lie outside of the grid.
+                if ((bx << BrickSizeLog2) + x >= m_nx ||
+                    (by << BrickSizeLog2) + y >= m_ny ||
+                    (bz << BrickSizeLog2) + z >= m_nz)
+                {
+                    occupied[index] = 0;
                     continue;
+                }
+
+                float density_sum = 0.0f;
+
+                for (size_t dx = 0; dx < 3; ++dx)
+                {
+                    for (size_t dy = 0; dy < 3; ++dy)
+                    {
+                        for (size_t dz = 0; dz < 3; ++dz)
+                        {
+                            const float density =
+                                densities[((z + R + dz - 1) * P + y + R + dy - 1) * P + x + R + dx - 1];
+                            assert(density >= 0.0f);
+
+                            density_sum += density;
+                        }
+                    }
+                }
+
+                occupied[index] = density_sum > occupancy_threshold ? 1 : 0;
+            }
+        }
+    }
+
+    // Dilate the densities by DilationRadius voxels, one axis at a time. Only the
+    // voxels of the brick itself end up with their exact maximum density.
+    const size_t strides[3] = { 1, P, P * P };
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        const size_t stride = strides[axis];
+
+        for (size_t i = 0; i < P * P * P; ++i)
+        {
+            const size_t c = (i / stride) % P;
+            const size_t begin = c >= R ? c - R : 0;
+            const size_t end = min(c + R + 1, P);
+            const size_t first = i - (c - begin) * stride;
+
+            float m = densities[first];
+            for (size_t j = 1; j < end - begin; ++j)
+                m = max(m, densities[first + j * stride]);
+
+            dilated_densities[i] = m;
+        }
+
+        swap(densities, dilated_densities);
+    }
 
-                const float* voxel = voxel_grid.voxel(ix, iy, iz);
-                assert(voxel[density_channel_index] >= 0.0f);
+    // Level 0: maximum density of each voxel.
+    for (size_t z = 0; z < BrickSize; ++z)
+    {
+        for (size_t y = 0; y < BrickSize; ++y)
+        {
+            for (size_t x = 0; x < BrickSize; ++x)
+            {
+                const size_t index = (z * BrickSize + y) * BrickSize + x;
 
-                density_sum += voxel[density_channel_index];
+                max_density[index] =
+                    (bx << BrickSizeLog2) + x < m_nx &&
+                    (by << BrickSizeLog2) + y < m_ny &&
+                    (bz << BrickSizeLog2) + z < m_nz
+                        ? densities[((z + R) * P + y + R) * P + x + R]
+                        : 0.0f;
             }
         }
     }
 
-    return density_sum;
+    // Levels finer than a brick, then the brick itself.
+    size_t offset = 0;
+    for (size_t n = BrickSize; n > 2; n /= 2)
+    {
+        const size_t next_offset = offset + n * n * n;
+
+        downsample_nodes(
+            n,
+            occupied + offset,
+            max_density + offset,
+            occupied + next_offset,
+            max_density + next_offset);
+
+        offset = next_offset;
+    }
+
+    assert(offset + 8 == BrickNodeCount);
+
+    downsample_nodes(
+        2,
+        occupied + offset,
+        max_density + offset,
+        &brick_occupied,
+        &brick_max_density);
+}
+
+AABB3d OccupancyGrid::compute_node_bbox(
+    const size_t        level,
+    const size_t        x,
+    const size_t        y,
+    const size_t        z) const
+{
+    const double nx = m_scalar_nx;
+    const double ny = m_scalar_ny;
+    const double nz = m_scalar_nz;
+
+    return
+        AABB3d(
+            Vector3d(
+                (x << level) / nx,
+                (y << level) / ny,
+                (z << level) / nz),
+            Vector3d(
+                min(static_cast<double>((x + 1) << level), nx) / nx,
+                min(static_cast<double>((y + 1) << level), ny) / ny,
+                min(static_cast<double>((z + 1) << level), nz) / nz));
 }
 
 }   // namespace renderer
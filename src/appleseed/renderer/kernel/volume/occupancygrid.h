@@ -33,33 +33,193 @@
 #include "renderer/kernel/volume/volume.h"
 
 // appleseed.foundation headers.
-#include "foundation/math/voxelgrid.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <vector>
 
 namespace renderer
 {
 
+//
+// A binary occupancy grid over a voxel grid, topped by a hierarchy of coarser
+// levels (a mipmap of occupancy and maximum density) that allows to quickly
+// skip over empty regions of the voxel grid and to bound the density of
+// larger regions.
+//
+// The hierarchy is stored sparsely. Voxels are grouped into bricks of the same
+// size as the bricks of renderer::SparseVoxelGrid. The levels finer than a brick
+// are only stored for the bricks that have fluid within two voxels of them, all
+// other bricks being free of fluid and of zero density. The levels from the brick
+// level up are stored densely.
+//
+// All points are expressed in the unit cube [0,1]^3.
+//
+
 class OccupancyGrid
   : public foundation::NonCopyable
 {
   public:
     OccupancyGrid(
-        const VoxelGrid&    voxel_grid,
-        const size_t        density_channel_index,
-        const float         occupancy_threshold);
+        const VoxelGrid&        voxel_grid,
+        const size_t            density_channel_index,
+        const float             occupancy_threshold);
+    OccupancyGrid(
+        const SparseVoxelGrid&  voxel_grid,
+        const size_t            density_channel_index,
+        const float             occupancy_threshold);
 
+    // Return true if fluid is present in the voxel containing a given point.
     bool has_fluid(const foundation::Vector3d& point) const;
 
+    // Return the number of levels in the hierarchy. Level 0 is the occupancy grid itself.
+    size_t get_level_count() const;
+
+    // Find the largest node of the hierarchy that contains a given point and
+    // that is free of fluid. Return false if fluid is present at that point.
+    bool find_empty_node(
+        const foundation::Vector3d& point,
+        foundation::AABB3d&         node_bbox) const;
+
+    // Return an upper bound on the density that any lookup of the voxel grid (nearest,
+    // linear or quadratic) may return in the node containing a given point, at a given
+    // level of the hierarchy.
+    float get_max_density(
+        const foundation::Vector3d& point,
+        const size_t                level) const;
+
+    // Return the bounding box of the node containing a given point, at a given level
+    // of the hierarchy.
+    foundation::AABB3d get_node_bbox(
+        const foundation::Vector3d& point,
+        const size_t                level) const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+    // Return the size (in bytes) of the temporary memory used to build an occupancy grid.
+    static size_t get_build_memory_size();
+
   private:
-    foundation::VoxelGrid3<unsigned char, double> m_grid;
+    // Bricks and the levels of the hierarchy finer than a brick.
+    static const size_t BrickSizeLog2 = SparseVoxelGrid::BrickSizeLog2;
+    static const size_t BrickSize = 1 << BrickSizeLog2;
+    static const size_t BrickMask = BrickSize - 1;
+    static const size_t BrickNodeCount = (BrickSize * BrickSize * BrickSize - 1) * 8 / 7;  // 8^3 + 4^3 + 2^3
+    static const foundation::uint32 EmptyBrick = ~foundation::uint32(0);
+
+    // Voxels read around a brick while building it.
+    static const size_t DilationRadius = 2;
+    static const size_t PaddedBrickSize = BrickSize + 2 * DilationRadius;
+
+    struct Level
+    {
+        size_t                      m_nx;
+        size_t                      m_ny;
+        size_t                      m_nz;
+        std::vector<unsigned char>  m_occupied;             // 1 if any voxel of the node contains fluid
+        std::vector<float>          m_max_density;          // largest density in the vicinity of the node
+    };
 
-    void initialize(
-        const VoxelGrid&    voxel_grid,
+    const size_t                    m_nx;
+    const size_t                    m_ny;
+    const size_t                    m_nz;
+    const double                    m_scalar_nx;
+    const double                    m_scalar_ny;
+    const double                    m_scalar_nz;
+    const double                    m_max_x;
+    const double                    m_max_y;
+    const double                    m_max_z;
+    size_t                          m_level_count;
+    std::vector<foundation::uint32> m_brick_indices;        // index of each brick in the arrays below, or EmptyBrick
+    std::vector<unsigned char>      m_brick_occupied;       // levels finer than a brick, BrickNodeCount nodes per non-empty brick
+    std::vector<float>              m_brick_max_density;    // levels finer than a brick, BrickNodeCount nodes per non-empty brick
+    std::vector<Level>              m_levels;               // levels from the brick level up
+
+    template <typename Grid>
+    void build_levels(
+        const Grid&         voxel_grid,
         const size_t        density_channel_index,
         const float         occupancy_threshold);
 
-    float get_density_sum(
-        const VoxelGrid&    voxel_grid,
+    // Read the densities of the voxels of a brick and of the voxels within
+    // DilationRadius voxels of it. Voxels outside of the grid have zero density.
+    template <typename Grid>
+    static void read_padded_brick(
+        const Grid&         voxel_grid,
+        const size_t        density_channel_index,
+        const size_t        bx,
+        const size_t        by,
+        const size_t        bz,
+        float               densities[]);
+
+    // Return true if any voxel of a brick or within DilationRadius voxels of it
+    // has a non-zero density.
+    template <typename Grid>
+    static bool has_density_near_brick(
+        const Grid&         voxel_grid,
         const size_t        density_channel_index,
+        const size_t        bx,
+        const size_t        by,
+        const size_t        bz);
+
+    // Compute the nodes of a brick from the densities of its voxels and of the
+    // voxels around it (as read by read_padded_brick()). 'densities' is modified.
+    void build_brick(
+        const size_t        bx,
+        const size_t        by,
+        const size_t        bz,
+        const float         occupancy_threshold,
+        float               densities[],
+        float               dilated_densities[],
+        unsigned char       occupied[],
+        float               max_density[],
+        unsigned char&      brick_occupied,
+        float&              brick_max_density) const;
+
+    // Return the occupancy or the maximum density of the node of a given level
+    // that contains the voxel (x, y, z).
+    bool is_occupied(
+        const size_t        level,
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+    float get_node_max_density(
+        const size_t        level,
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    // Return the index of the brick containing the voxel (x, y, z) in the arrays
+    // of the levels finer than a brick, or EmptyBrick.
+    foundation::uint32 get_brick_index(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    // Return the index in a brick of the node of a given level (finer than a brick)
+    // that contains the voxel (x, y, z).
+    static size_t get_brick_node_index(
+        const size_t        level,
+        const size_t        x,
+        const size_t        y,
+        const size_t        z);
+
+    // Compute the coordinates of the voxel (at level 0) containing a given point.
+    void get_voxel_coordinates(
+        const foundation::Vector3d& point,
+        size_t&                     x,
+        size_t&                     y,
+        size_t&                     z) const;
+
+    // Compute the bounding box of a node of the hierarchy.
+    foundation::AABB3d compute_node_bbox(
+        const size_t        level,
         const size_t        x,
         const size_t        y,
         const size_t        z) const;
@@ -72,9 +232,103 @@ class OccupancyGrid
 
 inline bool OccupancyGrid::has_fluid(const foundation::Vector3d& point) const
 {
-    unsigned char result;
-    m_grid.nearest_lookup(point, &result);
-    return result == 1;
+    size_t x, y, z;
+    get_voxel_coordinates(point, x, y, z);
+    return is_occupied(0, x, y, z);
+}
+
+inline size_t OccupancyGrid::get_level_count() const
+{
+    return m_level_count;
+}
+
+inline bool OccupancyGrid::is_occupied(
+    const size_t        level,
+    const size_t        x,
+    const size_t        y,
+    const size_t        z) const
+{
+    if (level >= BrickSizeLog2)
+    {
+        const Level& l = m_levels[level - BrickSizeLog2];
+        return l.m_occupied[((z >> level) * l.m_ny + (y >> level)) * l.m_nx + (x >> level)] != 0;
+    }
+
+    const foundation::uint32 brick_index = get_brick_index(x, y, z);
+
+    if (brick_index == EmptyBrick)
+        return false;
+
+    return m_brick_occupied[brick_index * BrickNodeCount + get_brick_node_index(level, x, y, z)] != 0;
+}
+
+inline float OccupancyGrid::get_node_max_density(
+    const size_t        level,
+    const size_t        x,
+    const size_t        y,
+    const size_t        z) const
+{
+    if (level >= BrickSizeLog2)
+    {
+        const Level& l = m_levels[level - BrickSizeLog2];
+        return l.m_max_density[((z >> level) * l.m_ny + (y >> level)) * l.m_nx + (x >> level)];
+    }
+
+    const foundation::uint32 brick_index = get_brick_index(x, y, z);
+
+    if (brick_index == EmptyBrick)
+        return 0.0f;
+
+    return m_brick_max_density[brick_index * BrickNodeCount + get_brick_node_index(level, x, y, z)];
+}
+
+inline foundation::uint32 OccupancyGrid::get_brick_index(
+    const size_t        x,
+    const size_t        y,
+    const size_t        z) const
+{
+    const Level& bricks = m_levels[0];
+
+    return
+        m_brick_indices[
+            ((z >> BrickSizeLog2) * bricks.m_ny + (y >> BrickSizeLog2)) * bricks.m_nx
+            + (x >> BrickSizeLog2)];
+}
+
+inline size_t OccupancyGrid::get_brick_node_index(
+    const size_t        level,
+    const size_t        x,
+    const size_t        y,
+    const size_t        z)
+{
+    assert(level < BrickSizeLog2);
+
+    // The nodes of a brick are stored level after level, starting with the finest one.
+    size_t offset = 0;
+    for (size_t i = 0; i < level; ++i)
+    {
+        const size_t n = BrickSize >> i;
+        offset += n * n * n;
+    }
+
+    const size_t n = BrickSize >> level;
+    const size_t lx = (x & BrickMask) >> level;
+    const size_t ly = (y & BrickMask) >> level;
+    const size_t lz = (z & BrickMask) >> level;
+
+    return offset + (lz * n + ly) * n + lx;
+}
+
+inline void OccupancyGrid::get_voxel_coordinates(
+    const foundation::Vector3d& point,
+    size_t&                     x,
+    size_t&                     y,
+    size_t&                     z) const
+{
+    // Same mapping as foundation::VoxelGrid3::nearest_lookup().
+    x = foundation::truncate<size_t>(foundation::clamp(point.x * m_scalar_nx, 0.0, m_max_x));
+    y = foundation::truncate<size_t>(foundation::clamp(point.y * m_scalar_ny, 0.0, m_max_y));
+    z = foundation::truncate<size_t>(foundation::clamp(point.z * m_scalar_nz, 0.0, m_max_z));
 }
 
 }       // namespace renderer
@@ -33,7 +33,10 @@
 #include "foundation/utility/cc.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cassert>
 #include <cstdio>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -80,200 +83,363 @@ namespace
         unsigned int    m_has_velocity;
     };
 
+    // Largest number of interleaved channels read at once from a fluid file.
+    const size_t MaxReadChannelCount = 3;
+
+    const size_t BrickSizeLog2 = SparseVoxelGrid::BrickSizeLog2;
+    const size_t BrickMask = SparseVoxelGrid::BrickSize - 1;
+
+    // Index of the brick of a sparse voxel grid containing a given voxel.
+    size_t get_brick_index(
+        const size_t    brick_nx,
+        const size_t    brick_ny,
+        const size_t    x,
+        const size_t    y,
+        const size_t    z)
+    {
+        return ((z >> BrickSizeLog2) * brick_ny + (y >> BrickSizeLog2)) * brick_nx + (x >> BrickSizeLog2);
+    }
+
+    bool is_sparse(const VoxelGrid& /*grid*/)
+    {
+        return false;
+    }
+
+    bool is_sparse(const SparseVoxelGrid& /*grid*/)
+    {
+        return true;
+    }
+
+    // Read one or more interleaved channels of all voxels of a grid. The file is read
+    // one slice at a time and only non-zero values are stored into the grid (which is
+    // initially empty) so that sparse grids don't allocate storage for empty regions.
+    // If stored_bricks is not null, values are only stored in the bricks it flags.
+    template <typename Grid>
     size_t read_channels(
-        FILE*           file,
-        VoxelGrid*      grid,
-        const size_t    channel_index,
-        const size_t    channel_count)
+        FILE*                   file,
+        Grid*                   grid,
+        const size_t            channel_index,
+        const size_t            channel_count,
+        const vector<bool>*     stored_bricks)
     {
         assert(file);
         assert(grid);
         assert(channel_count > 0);
+        assert(channel_count <= MaxReadChannelCount);
+
+        const size_t xres = grid->get_xres();
+        const size_t yres = grid->get_yres();
+        const size_t zres = grid->get_zres();
+        const size_t brick_nx = (xres + BrickMask) >> BrickSizeLog2;
+        const size_t brick_ny = (yres + BrickMask) >> BrickSizeLog2;
+
+        vector<float> slice(xres * yres * channel_count);
 
         size_t read = 0;
 
-        for (size_t z = 0; z < grid->get_zres(); ++z)
+        for (size_t z = 0; z < zres; ++z)
         {
-            for (size_t y = 0; y < grid->get_yres(); ++y)
+            const size_t slice_read =
+                fread(
+                    &slice[0],
+                    sizeof(float),
+                    slice.size(),
+                    file);
+
+            read += slice_read;
+
+            if (slice_read < slice.size())
+                break;
+
+            const float* values = &slice[0];
+
+            for (size_t y = 0; y < yres; ++y)
             {
-                for (size_t x = 0; x < grid->get_xres(); ++x)
+                for (size_t x = 0; x < xres; ++x)
                 {
-                    float* voxel = grid->voxel(x, y, z);
-                    read += fread(
-                        &voxel[channel_index],
-                        sizeof(float),
-                        channel_count,
-                        file);
+                    if (stored_bricks && !(*stored_bricks)[get_brick_index(brick_nx, brick_ny, x, y, z)])
+                    {
+                        values += channel_count;
+                        continue;
+                    }
+
+                    for (size_t c = 0; c < channel_count; ++c)
+                    {
+                        const float value = *values++;
+
+                        if (value != 0.0f)
+                            grid->voxel(x, y, z)[channel_index + c] = value;
+                    }
                 }
             }
         }
 
         return read;
     }
-}
 
-auto_ptr<VoxelGrid> read_fluid_file(
-    const char*         filename,
-    FluidChannels&      channels)
-{
-    assert(filename);
+    // Flag the bricks of a sparse voxel grid that lie within the interpolation footprint
+    // (one voxel in every direction) of a voxel of non-zero density. Other channels are
+    // irrelevant where the density is zero, so only these bricks need storage. The file
+    // must be positioned at the first channel; the channels preceding the density are
+    // skipped. Return false if the file is truncated.
+    bool find_occupied_bricks(
+        FILE*                   file,
+        const size_t            xres,
+        const size_t            yres,
+        const size_t            zres,
+        const size_t            skipped_slice_count,
+        vector<bool>&           occupied_bricks)
+    {
+        const size_t brick_nx = (xres + BrickMask) >> BrickSizeLog2;
+        const size_t brick_ny = (yres + BrickMask) >> BrickSizeLog2;
+        const size_t brick_nz = (zres + BrickMask) >> BrickSizeLog2;
 
-    FILE* file = fopen(filename, "rb");
+        occupied_bricks.assign(brick_nx * brick_ny * brick_nz, false);
 
-    if (file == 0)
-        return auto_ptr<VoxelGrid>(0);
+        vector<float> slice(xres * yres);
 
-    // Read the file header.
-    FluidFileHeader header;
-    if (fread(&header, sizeof(FluidFileHeader), 1, file) < 1)
-    {
-        fclose(file);
-        return auto_ptr<VoxelGrid>(0);
-    }
+        for (size_t i = 0; i < skipped_slice_count; ++i)
+        {
+            if (fread(&slice[0], sizeof(float), slice.size(), file) < slice.size())
+                return false;
+        }
 
-    // Check the validity of the file header.
-    if (header.m_id != CC32('F', 'L', 'D', '3'))
-    {
-        fclose(file);
-        return auto_ptr<VoxelGrid>(0);
-    }
+        for (size_t z = 0; z < zres; ++z)
+        {
+            if (fread(&slice[0], sizeof(float), slice.size(), file) < slice.size())
+                return false;
 
-    const size_t voxel_count = header.m_xres * header.m_yres * header.m_zres;
+            const float* values = &slice[0];
 
-    // Compute the number of channels, and set channel indices.
-    size_t channel_count = 0;
-    if (header.m_has_color)
-    {
-        channels.m_color_index = channel_count;
-        channel_count += 3;
-    }
-    if (header.m_has_density)
-    {
-        channels.m_density_index = channel_count;
-        channel_count += 1;
-    }
-    if (header.m_has_temperature)
-    {
-        channels.m_temperature_index = channel_count;
-        channel_count += 1;
-    }
-    if (header.m_has_fuel)
-    {
-        channels.m_fuel_index = channel_count;
-        channel_count += 1;
-    }
-    if (header.m_has_falloff)
-    {
-        channels.m_falloff_index = channel_count;
-        channel_count += 1;
-    }
-    if (header.m_has_pressure)
-    {
-        channels.m_pressure_index = channel_count;
-        channel_count += 1;
-    }
-    if (header.m_has_coordinates)
-    {
-        channels.m_coordinates_index = channel_count;
-        channel_count += 3;
+            for (size_t y = 0; y < yres; ++y)
+            {
+                for (size_t x = 0; x < xres; ++x)
+                {
+                    if (*values++ == 0.0f)
+                        continue;
+
+                    for (size_t nz = z > 0 ? z - 1 : 0; nz < min(z + 2, zres); ++nz)
+                    {
+                        for (size_t ny = y > 0 ? y - 1 : 0; ny < min(y + 2, yres); ++ny)
+                        {
+                            for (size_t nx = x > 0 ? x - 1 : 0; nx < min(x + 2, xres); ++nx)
+                                occupied_bricks[get_brick_index(brick_nx, brick_ny, nx, ny, nz)] = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
     }
-    if (header.m_has_velocity)
+
+    template <typename Grid>
+    auto_ptr<Grid> read_fluid_file_into_grid(
+        const char*         filename,
+        FluidChannels&      channels)
     {
-        channels.m_velocity_index = channel_count;
-        channel_count += 3;
-    }
+        assert(filename);
 
-    auto_ptr<VoxelGrid> grid(
-        new VoxelGrid(
-            header.m_xres,
-            header.m_yres,
-            header.m_zres,
-            channel_count));
+        FILE* file = fopen(filename, "rb");
 
-    size_t channel_index = 0;
-    size_t read = 0;
-    size_t needed = 0;
+        if (file == 0)
+            return auto_ptr<Grid>(0);
 
-    // Read fluid color.
-    if (header.m_has_color)
-    {
-        read += read_channels(file, grid.get(), channel_index, 3);
-        needed += voxel_count * 3;
-        channel_index += 3;
-    }
+        // Read the file header.
+        FluidFileHeader header;
+        if (fread(&header, sizeof(FluidFileHeader), 1, file) < 1)
+        {
+            fclose(file);
+            return auto_ptr<Grid>(0);
+        }
 
-    // Read fluid density.
-    if (header.m_has_density)
-    {
-        read += read_channels(file, grid.get(), channel_index, 1);
-        needed += voxel_count;
-        channel_index += 1;
-    }
+        // Check the validity of the file header.
+        if (header.m_id != CC32('F', 'L', 'D', '3'))
+        {
+            fclose(file);
+            return auto_ptr<Grid>(0);
+        }
 
-    // Read fluid temperature.
-    if (header.m_has_temperature)
-    {
-        read += read_channels(file, grid.get(), channel_index, 1);
-        needed += voxel_count;
-        channel_index += 1;
-    }
+        const size_t voxel_count = header.m_xres * header.m_yres * header.m_zres;
 
-    // Read fluid fuel.
-    if (header.m_has_fuel)
-    {
-        read += read_channels(file, grid.get(), channel_index, 1);
-        needed += voxel_count;
-        channel_index += 1;
-    }
+        // Compute the number of channels, and set channel indices.
+        size_t channel_count = 0;
+        if (header.m_has_color)
+        {
+            channels.m_color_index = channel_count;
+            channel_count += 3;
+        }
+        if (header.m_has_density)
+        {
+            channels.m_density_index = channel_count;
+            channel_count += 1;
+        }
+        if (header.m_has_temperature)
+        {
+            channels.m_temperature_index = channel_count;
+            channel_count += 1;
+        }
+        if (header.m_has_fuel)
+        {
+            channels.m_fuel_index = channel_count;
+            channel_count += 1;
+        }
+        if (header.m_has_falloff)
+        {
+            channels.m_falloff_index = channel_count;
+            channel_count += 1;
+        }
+        if (header.m_has_pressure)
+        {
+            channels.m_pressure_index = channel_count;
+            channel_count += 1;
+        }
+        if (header.m_has_coordinates)
+        {
+            channels.m_coordinates_index = channel_count;
+            channel_count += 3;
+        }
+        if (header.m_has_velocity)
+        {
+            channels.m_velocity_index = channel_count;
+            channel_count += 3;
+        }
 
-    // Read fluid falloff.
-    if (header.m_has_falloff)
-    {
-        read += read_channels(file, grid.get(), channel_index, 1);
-        needed += voxel_count;
-        channel_index += 1;
-    }
+        auto_ptr<Grid> grid(
+            new Grid(
+                header.m_xres,
+                header.m_yres,
+                header.m_zres,
+                channel_count));
+
+        // In sparse grids, let the density decide which bricks get allocated.
+        vector<bool> occupied_bricks;
+        const vector<bool>* stored_bricks = 0;
+        if (is_sparse(*grid) && header.m_has_density)
+        {
+            if (!find_occupied_bricks(
+                    file,
+                    header.m_xres,
+                    header.m_yres,
+                    header.m_zres,
+                    header.m_has_color ? header.m_zres * 3 : 0,
+                    occupied_bricks) ||
+                fseek(file, sizeof(FluidFileHeader), SEEK_SET) != 0)
+            {
+                fclose(file);
+                return auto_ptr<Grid>(0);
+            }
 
-    // Read fluid pressure.
-    if (header.m_has_pressure)
-    {
-        read += read_channels(file, grid.get(), channel_index, 1);
-        needed += voxel_count;
-        channel_index += 1;
-    }
+            stored_bricks = &occupied_bricks;
+        }
 
-    // Read fluid coordinates.
-    if (header.m_has_coordinates)
-    {
-        read += read_channels(file, grid.get(), channel_index, 3);
-        needed += voxel_count * 3;
-        channel_index += 3;
-    }
+        size_t channel_index = 0;
+        size_t read = 0;
+        size_t needed = 0;
 
-    // Read fluid velocity.
-    if (header.m_has_velocity)
-    {
-        // X.
-        read += read_channels(file, grid.get(), channel_index, 1);
-        needed += voxel_count;
-        channel_index += 1;
-
-        // Y.
-        read += read_channels(file, grid.get(), channel_index, 1);
-        needed += voxel_count;
-        channel_index += 1;
-
-        // Z.
-        read += read_channels(file, grid.get(), channel_index, 1);
-        needed += voxel_count;
-        channel_index += 1;
+        // Read fluid color.
+        if (header.m_has_color)
+        {
+            read += read_channels(file, grid.get(), channel_index, 3, stored_bricks);
+            needed += voxel_count * 3;
+            channel_index += 3;
+        }
+
+        // Read fluid density.
+        if (header.m_has_density)
+        {
+            read += read_channels(file, grid.get(), channel_index, 1, stored_bricks);
+            needed += voxel_count;
+            channel_index += 1;
+        }
+
+        // Read fluid temperature.
+        if (header.m_has_temperature)
+        {
+            read += read_channels(file, grid.get(), channel_index, 1, stored_bricks);
+            needed += voxel_count;
+            channel_index += 1;
+        }
+
+        // Read fluid fuel.
+        if (header.m_has_fuel)
+        {
+            read += read_channels(file, grid.get(), channel_index, 1, stored_bricks);
+            needed += voxel_count;
+            channel_index += 1;
+        }
+
+        // Read fluid falloff.
+        if (header.m_has_falloff)
+        {
+            read += read_channels(file, grid.get(), channel_index, 1, stored_bricks);
+            needed += voxel_count;
+            channel_index += 1;
+        }
+
+        // Read fluid pressure.
+        if (header.m_has_pressure)
+        {
+            read += read_channels(file, grid.get(), channel_index, 1, stored_bricks);
+            needed += voxel_count;
+            channel_index += 1;
+        }
+
+        // Read fluid coordinates.
+        if (header.m_has_coordinates)
+        {
+            read += read_channels(file, grid.get(), channel_index, 3, stored_bricks);
+            needed += voxel_count * 3;
+            channel_index += 3;
+        }
+
+        // Read fluid velocity.
+        if (header.m_has_velocity)
+        {
+            // X.
+            read += read_channels(file, grid.get(), channel_index, 1, stored_bricks);
+            needed += voxel_count;
+            channel_index += 1;
+
+            // Y.
+            read += read_channels(file, grid.get(), channel_index, 1, stored_bricks);
+            needed += voxel_count;
+            channel_index += 1;
+
+            // Z.
+            read += read_channels(file, grid.get(), channel_index, 1, stored_bricks);
+            needed += voxel_count;
+            channel_index += 1;
+        }
+
+        assert(channel_index == channel_count);
+
+        fclose(file);
+
+        return read == needed ? grid : auto_ptr<Grid>(0);
     }
+}
 
-    assert(channel_index == channel_count);
+auto_ptr<VoxelGrid> read_fluid_file(
+    const char*         filename,
+    FluidChannels&      channels)
+{
+    return read_fluid_file_into_grid<VoxelGrid>(filename, channels);
+}
 
-    fclose(file);
+auto_ptr<SparseVoxelGrid> read_sparse_fluid_file(
+    const char*         filename,
+    FluidChannels&      channels)
+{
+    return read_fluid_file_into_grid<SparseVoxelGrid>(filename, channels);
+}
 
-    return read == needed ? grid : auto_ptr<VoxelGrid>(0);
+size_t get_fluid_file_read_buffer_size(
+    const size_t        xres,
+    const size_t        yres)
+{
+    // One slice of the largest group of channels read by read_channels().
+    return xres * yres * MaxReadChannelCount * sizeof(float);
 }
 
 void write_voxel_grid(
@@ -33,16 +33,18 @@
 #include "renderer/global/global.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/sparsevoxelgrid.h"
 #include "foundation/math/voxelgrid.h"
 
 namespace renderer
 {
 
 //
-// The voxel grid used for rendering.
+// The voxel grids used for rendering.
 //
 
 typedef foundation::VoxelGrid3<float, double> VoxelGrid;
+typedef foundation::SparseVoxelGrid3<float, double> SparseVoxelGrid;
 
 
 //
@@ -76,6 +78,19 @@ std::auto_ptr<VoxelGrid> read_fluid_file(
     const char*         filename,
     FluidChannels&      channels);
 
+// Read a fluid file created by 3Delight for Maya into a sparse voxel grid.
+// Only the bricks of the grid within one voxel of a non-zero density value
+// are allocated, or the bricks with non-zero values if there is no density.
+std::auto_ptr<SparseVoxelGrid> read_sparse_fluid_file(
+    const char*         filename,
+    FluidChannels&      channels);
+
+// Return the size (in bytes) of the temporary memory used by read_fluid_file()
+// and read_sparse_fluid_file() to read a fluid file of a given resolution.
+size_t get_fluid_file_read_buffer_size(
+    const size_t        xres,
+    const size_t        yres);
+
 // Write a voxel grid to disk in a human-readable format.
 void write_voxel_grid(
     const char*         filename,
@@ -0,0 +1,170 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/globalaccumulationframebuffer.h"
+#include "renderer/kernel/rendering/localaccumulationframebuffer.h"
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/rng.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Rendering_AccumulationFramebuffer)
+{
+    const size_t Width = 640;
+    const size_t Height = 480;
+
+    // Each job stores as many samples as a sample generator job does in a
+    // typical pass, scattered all over the framebuffer.
+    const size_t SampleCount = 16 * 1024;
+
+    struct StoreSamplesJob
+      : public IJob
+    {
+        AccumulationFramebuffer*    m_framebuffer;
+        vector<Sample>              m_samples;
+
+        StoreSamplesJob()
+          : m_framebuffer(0)
+        {
+        }
+
+        void initialize(AccumulationFramebuffer* framebuffer, const uint32 seed)
+        {
+            m_framebuffer = framebuffer;
+
+            MersenneTwister rng(seed);
+            m_samples.resize(SampleCount);
+
+            for (size_t i = 0; i < SampleCount; ++i)
+            {
+                m_samples[i].m_position.x = rand_double2(rng);
+                m_samples[i].m_position.y = rand_double2(rng);
+                m_samples[i].m_color = Color4f(0.5f);
+            }
+        }
+
+        virtual void execute(const size_t thread_index)
+        {
+            m_framebuffer->store_samples(SampleCount, &m_samples[0]);
+        }
+    };
+
+    template <typename Framebuffer, size_t ThreadCount>
+    struct Fixture
+    {
+        Logger                      m_logger;
+        JobQueue                    m_job_queue;
+        JobManager                  m_job_manager;
+        Framebuffer                 m_framebuffer;
+        StoreSamplesJob             m_jobs[ThreadCount];
+
+        Fixture()
+          : m_job_manager(m_logger, m_job_queue, ThreadCount)
+          , m_framebuffer(Width, Height)
+        {
+            for (size_t i = 0; i < ThreadCount; ++i)
+                m_jobs[i].initialize(&m_framebuffer, static_cast<uint32>(i + 1));
+
+            m_job_manager.start();
+        }
+
+        void payload()
+        {
+            for (size_t i = 0; i < ThreadCount; ++i)
+                m_job_queue.schedule(&m_jobs[i], false);
+
+            m_job_queue.wait_until_completion();
+        }
+    };
+
+    // The generic sample generator stores into a local accumulation framebuffer.
+    typedef Fixture<LocalAccumulationFramebuffer, 1> LocalFixture1;
+    typedef Fixture<LocalAccumulationFramebuffer, 4> LocalFixture4;
+    typedef Fixture<LocalAccumulationFramebuffer, 16> LocalFixture16;
+    typedef Fixture<LocalAccumulationFramebuffer, 64> LocalFixture64;
+
+    // The light tracing sample generator stores into a global accumulation framebuffer.
+    typedef Fixture<GlobalAccumulationFramebuffer, 1> GlobalFixture1;
+    typedef Fixture<GlobalAccumulationFramebuffer, 4> GlobalFixture4;
+    typedef Fixture<GlobalAccumulationFramebuffer, 16> GlobalFixture16;
+    typedef Fixture<GlobalAccumulationFramebuffer, 64> GlobalFixture64;
+
+    BENCHMARK_CASE_F(StoreSamples_Local_1Thread, LocalFixture1)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_Local_4Threads, LocalFixture4)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_Local_16Threads, LocalFixture16)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_Local_64Threads, LocalFixture64)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_Global_1Thread, GlobalFixture1)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_Global_4Threads, GlobalFixture4)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_Global_16Threads, GlobalFixture16)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_Global_64Threads, GlobalFixture64)
+    {
+        payload();
+    }
+}
@@ -0,0 +1,351 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project-builtin/cornellboxproject.h"
+#include "renderer/modeling/project-builtin/syntheticproject.h"
+#include "renderer/modeling/scene/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/basis.h"
+#include "foundation/math/rng.h"
+#include "foundation/math/sampling.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Intersection_Intersector)
+{
+    // Number of rays traced per iteration by the ray tracing cases.
+    // Rays per second are this number times the call rate.
+    const size_t RayCount = 4096;
+
+    const uint32 Seed = 42;
+
+    struct CornellBoxProject
+    {
+        static auto_release_ptr<Project> create()
+        {
+            return CornellBoxProjectFactory::create();
+        }
+    };
+
+    struct HighTriangleCountProject
+    {
+        static auto_release_ptr<Project> create()
+        {
+            return SyntheticProjectFactory::create_triangle_soup(256 * 1024, Seed);
+        }
+    };
+
+    struct ManyInstancesProject
+    {
+        static auto_release_ptr<Project> create()
+        {
+            return SyntheticProjectFactory::create_instance_grid(4096, 64, Seed);
+        }
+    };
+
+    template <typename ProjectType>
+    struct ProjectFixture
+    {
+        auto_release_ptr<Project>   m_project;
+        Scene&                      m_scene;
+
+        ProjectFixture()
+          : m_project(ProjectType::create())
+          , m_scene(*m_project->get_scene())
+        {
+        }
+    };
+
+    template <typename ProjectType>
+    struct TraceFixture
+      : public ProjectFixture<ProjectType>
+    {
+        TraceContext                m_trace_context;
+        Intersector                 m_intersector;
+        vector<ShadingRay>          m_primary_rays;
+        vector<ShadingRay>          m_secondary_rays;
+        size_t                      m_hit_count;
+
+        TraceFixture()
+          : m_trace_context(this->m_scene)
+          , m_intersector(m_trace_context)
+          , m_hit_count(0)
+        {
+            m_trace_context.prebuild_trees(1);
+
+            generate_primary_rays();
+            generate_secondary_rays();
+        }
+
+        // Generate camera rays through a regular grid of points on the film.
+        void generate_primary_rays()
+        {
+            Camera* camera = this->m_scene.get_camera();
+            camera->on_frame_begin(this->m_project.ref());
+
+            MersenneTwister rng(Seed);
+            SamplingContext sampling_context(rng);
+
+            const size_t grid_size = static_cast<size_t>(sqrt(static_cast<double>(RayCount)));
+            m_primary_rays.resize(RayCount);
+
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                const Vector2d point(
+                    ((i % grid_size) + 0.5) / grid_size,
+                    ((i / grid_size) + 0.5) / grid_size);
+
+                camera->generate_ray(sampling_context, point, m_primary_rays[i]);
+            }
+
+            camera->on_frame_end(this->m_project.ref());
+        }
+
+        // Generate diffuse bounce rays from the hit points of the camera rays.
+        void generate_secondary_rays()
+        {
+            vector<Vector3d> origins;
+            vector<Vector3d> normals;
+
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                ShadingPoint shading_point;
+                if (!m_intersector.trace(m_primary_rays[i], shading_point))
+                    continue;
+
+                // Make the normal face the camera.
+                Vector3d n = shading_point.get_geometric_normal();
+                if (dot(n, m_primary_rays[i].m_dir) > 0.0)
+                    n = -n;
+
+                Vector3d front, back;
+                Intersector::offset(shading_point.get_point(), n, front, back);
+
+                origins.push_back(front);
+                normals.push_back(n);
+            }
+
+            if (origins.empty())
+                return;
+
+            MersenneTwister rng(Seed);
+            m_secondary_rays.reserve(RayCount);
+
+            // Reuse hit points as needed to always trace the same number of rays.
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                const size_t hit_index = i % origins.size();
+
+                Vector2d s;
+                s[0] = rand_double2(rng);
+                s[1] = rand_double2(rng);
+
+                const Basis3d basis(normals[hit_index]);
+                const Vector3d dir = basis.transform_to_parent(sample_hemisphere_cosine(s));
+
+                m_secondary_rays.push_back(ShadingRay(origins[hit_index], dir, 0.0, ~0));
+            }
+        }
+
+        void trace(const vector<ShadingRay>& rays)
+        {
+            for (size_t i = 0; i < rays.size(); ++i)
+            {
+                ShadingPoint shading_point;
+                if (m_intersector.trace(rays[i], shading_point))
+                    ++m_hit_count;
+            }
+        }
+    };
+
+    // Trace the secondary rays from several threads at once, each thread using its own
+    // intersector as rendering threads do. The instances of the many-instances project
+    // all share the same trees: this measures the contention on accessing them.
+    template <typename ProjectType, size_t ThreadCount>
+    struct ParallelTraceFixture
+      : public TraceFixture<ProjectType>
+    {
+        struct TraceJob
+          : public IJob
+        {
+            Intersector                 m_intersector;
+            const ShadingRay*           m_rays;
+            size_t                      m_ray_count;
+            size_t                      m_hit_count;
+
+            explicit TraceJob(const TraceContext& trace_context)
+              : m_intersector(trace_context)
+              , m_rays(0)
+              , m_ray_count(0)
+              , m_hit_count(0)
+            {
+            }
+
+            virtual void execute(const size_t /*thread_index*/)
+            {
+                for (size_t i = 0; i < m_ray_count; ++i)
+                {
+                    ShadingPoint shading_point;
+                    if (m_intersector.trace(m_rays[i], shading_point))
+                        ++m_hit_count;
+                }
+            }
+        };
+
+        Logger                          m_logger;
+        JobQueue                        m_job_queue;
+        JobManager                      m_job_manager;
+        vector<TraceJob*>               m_jobs;
+
+        ParallelTraceFixture()
+          : m_job_manager(m_logger, m_job_queue, ThreadCount)
+        {
+            // Split the rays evenly among the threads so that the total number
+            // of rays traced per iteration does not depend on the thread count.
+            const size_t ray_count = this->m_secondary_rays.size();
+
+            for (size_t i = 0; i < ThreadCount; ++i)
+            {
+                const size_t begin = i * ray_count / ThreadCount;
+                const size_t end = (i + 1) * ray_count / ThreadCount;
+
+                TraceJob* job = new TraceJob(this->m_trace_context);
+                job->m_rays = begin < end ? &this->m_secondary_rays[begin] : 0;
+                job->m_ray_count = end - begin;
+                m_jobs.push_back(job);
+            }
+
+            m_job_manager.start();
+        }
+
+        ~ParallelTraceFixture()
+        {
+            m_job_manager.stop();
+
+            for (size_t i = 0; i < m_jobs.size(); ++i)
+                delete m_jobs[i];
+        }
+
+        void trace_in_parallel()
+        {
+            for (size_t i = 0; i < m_jobs.size(); ++i)
+                m_job_queue.schedule(m_jobs[i], false);
+
+            m_job_queue.wait_until_completion();
+        }
+    };
+
+    typedef ProjectFixture<CornellBoxProject> CornellBoxFixture;
+    typedef ProjectFixture<HighTriangleCountProject> HighTriangleCountFixture;
+    typedef ProjectFixture<ManyInstancesProject> ManyInstancesFixture;
+
+    typedef TraceFixture<CornellBoxProject> CornellBoxTraceFixture;
+    typedef TraceFixture<HighTriangleCountProject> HighTriangleCountTraceFixture;
+    typedef TraceFixture<ManyInstancesProject> ManyInstancesTraceFixture;
+
+    typedef ParallelTraceFixture<ManyInstancesProject, 1> ManyInstancesSingleThreadedTraceFixture;
+    typedef ParallelTraceFixture<ManyInstancesProject, 8> ManyInstancesOctoThreadedTraceFixture;
+
+    BENCHMARK_CASE_F(BuildTrees_CornellBox, CornellBoxFixture)
+    {
+        TraceContext trace_context(m_scene);
+        trace_context.prebuild_trees(1);
+    }
+
+    BENCHMARK_CASE_F(BuildTrees_HighTriangleCount, HighTriangleCountFixture)
+    {
+        TraceContext trace_context(m_scene);
+        trace_context.prebuild_trees(1);
+    }
+
+    BENCHMARK_CASE_F(BuildTrees_ManyInstances, ManyInstancesFixture)
+    {
+        TraceContext trace_context(m_scene);
+        trace_context.prebuild_trees(1);
+    }
+
+    BENCHMARK_CASE_F(TracePrimaryRays_CornellBox, CornellBoxTraceFixture)
+    {
+        trace(m_primary_rays);
+    }
+
+    BENCHMARK_CASE_F(TracePrimaryRays_HighTriangleCount, HighTriangleCountTraceFixture)
+    {
+        trace(m_primary_rays);
+    }
+
+    BENCHMARK_CASE_F(TracePrimaryRays_ManyInstances, ManyInstancesTraceFixture)
+    {
+        trace(m_primary_rays);
+    }
+
+    BENCHMARK_CASE_F(TraceSecondaryRays_CornellBox, CornellBoxTraceFixture)
+    {
+        trace(m_secondary_rays);
+    }
+
+    BENCHMARK_CASE_F(TraceSecondaryRays_HighTriangleCount, HighTriangleCountTraceFixture)
+    {
+        trace(m_secondary_rays);
+    }
+
+    BENCHMARK_CASE_F(TraceSecondaryRays_ManyInstances, ManyInstancesTraceFixture)
+    {
+        trace(m_secondary_rays);
+    }
+
+    BENCHMARK_CASE_F(TraceSecondaryRaysSingleThreaded_ManyInstances, ManyInstancesSingleThreadedTraceFixture)
+    {
+        trace_in_parallel();
+    }
+
+    BENCHMARK_CASE_F(TraceSecondaryRaysOctoThreaded_ManyInstances, ManyInstancesOctoThreadedTraceFixture)
+    {
+        trace_in_parallel();
+    }
+}
@@ -0,0 +1,136 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+#include "renderer/kernel/rendering/defaultrenderercontroller.h"
+#include "renderer/kernel/rendering/masterrenderer.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/project/configuration.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/project-builtin/cornellboxproject.h"
+#include "renderer/modeling/project-builtin/defaultproject.h"
+#include "renderer/modeling/project-builtin/syntheticproject.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark.h"
+
+using namespace foundation;
+using namespace renderer;
+
+BENCHMARK_SUITE(Renderer_Kernel_Rendering_MasterRenderer)
+{
+    // Frames are rendered at 32x32 with one sample per pixel on a single thread,
+    // so samples per second are 1024 times the call rate. The default project
+    // has an empty scene: rendering it measures the fixed cost of a frame.
+
+    const uint32 Seed = 42;
+
+    struct DefaultProject
+    {
+        static auto_release_ptr<Project> create()
+        {
+            return DefaultProjectFactory::create();
+        }
+    };
+
+    struct CornellBoxProject
+    {
+        static auto_release_ptr<Project> create()
+        {
+            return CornellBoxProjectFactory::create();
+        }
+    };
+
+    struct ManyInstancesProject
+    {
+        static auto_release_ptr<Project> create()
+        {
+            return SyntheticProjectFactory::create_instance_grid(4096, 64, Seed);
+        }
+    };
+
+    template <typename ProjectType>
+    struct Fixture
+    {
+        auto_release_ptr<Project>   m_project;
+        ParamArray                  m_params;
+        DefaultRendererController   m_renderer_controller;
+
+        Fixture()
+          : m_project(ProjectType::create())
+        {
+            // Replace the frame of the project by a smaller one.
+            ParamArray frame_params = m_project->get_frame()->get_parameters();
+            frame_params.insert("resolution", "32 32");
+            m_project->set_frame(FrameFactory::create("beauty", frame_params));
+
+            m_params = BaseConfigurationFactory::create_base_final()->get_parameters();
+            m_params.insert_path("generic_frame_renderer.rendering_threads", "1");
+            m_params.insert_path("generic_frame_renderer.thread_affinity", "none");
+
+            // Keep per-frame log messages out of the benchmark output.
+            global_logger().set_enabled(false);
+        }
+
+        ~Fixture()
+        {
+            global_logger().set_enabled(true);
+        }
+
+        void render()
+        {
+            MasterRenderer renderer(
+                m_project.ref(),
+                m_params,
+                &m_renderer_controller);
+
+            renderer.render();
+        }
+    };
+
+    typedef Fixture<DefaultProject> DefaultFixture;
+    typedef Fixture<CornellBoxProject> CornellBoxFixture;
+    typedef Fixture<ManyInstancesProject> ManyInstancesFixture;
+
+    BENCHMARK_CASE_F(RenderFrame_Default, DefaultFixture)
+    {
+        render();
+    }
+
+    BENCHMARK_CASE_F(RenderFrame_CornellBox, CornellBoxFixture)
+    {
+        render();
+    }
+
+    BENCHMARK_CASE_F(RenderFrame_ManyInstances, ManyInstancesFixture)
+    {
+        render();
+    }
+}
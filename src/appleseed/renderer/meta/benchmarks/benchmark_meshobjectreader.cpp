@@ -0,0 +1,200 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectreader.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
+#include "foundation/mesh/imeshwalker.h"
+#include "foundation/mesh/objmeshfilewriter.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Modeling_Object_MeshObjectReader)
+{
+    // Every benchmark iteration loads a mesh of 256x256 vertices and 130050 triangles.
+    const size_t GridSize = 256;
+
+    const char* OBJFilename = "unit benchmarks/outputs/benchmark_meshobjectreader.obj";
+    const char* BinaryMeshFilename = "unit benchmarks/outputs/benchmark_meshobjectreader.binarymesh";
+    const char* QuantizedBinaryMeshFilename = "unit benchmarks/outputs/benchmark_meshobjectreader_quantized.binarymesh";
+
+    // A wavy grid with one vertex normal and one texture coordinate per vertex.
+    class GridMeshWalker
+      : public IMeshWalker
+    {
+      public:
+        virtual string get_name() const
+        {
+            return "grid";
+        }
+
+        virtual size_t get_vertex_count() const
+        {
+            return GridSize * GridSize;
+        }
+
+        virtual Vector3d get_vertex(const size_t i) const
+        {
+            const double x = static_cast<double>(i % GridSize) / (GridSize - 1);
+            const double z = static_cast<double>(i / GridSize) / (GridSize - 1);
+            return Vector3d(x, get_height(x, z), z);
+        }
+
+        virtual size_t get_vertex_normal_count() const
+        {
+            return GridSize * GridSize;
+        }
+
+        virtual Vector3d get_vertex_normal(const size_t i) const
+        {
+            const double x = static_cast<double>(i % GridSize) / (GridSize - 1);
+            const double z = static_cast<double>(i / GridSize) / (GridSize - 1);
+            const double dhdx = 0.1 * 20.0 * cos(20.0 * x) * cos(20.0 * z);
+            const double dhdz = -0.1 * 20.0 * sin(20.0 * x) * sin(20.0 * z);
+            return normalize(Vector3d(-dhdx, 1.0, -dhdz));
+        }
+
+        virtual size_t get_tex_coords_count() const
+        {
+            return GridSize * GridSize;
+        }
+
+        virtual Vector2d get_tex_coords(const size_t i) const
+        {
+            const Vector3d v = get_vertex(i);
+            return Vector2d(v[0], v[2]);
+        }
+
+        virtual size_t get_face_count() const
+        {
+            return 2 * (GridSize - 1) * (GridSize - 1);
+        }
+
+        virtual Face get_face(const size_t i) const
+        {
+            const size_t quad = i / 2;
+            const size_t x = quad % (GridSize - 1);
+            const size_t z = quad / (GridSize - 1);
+            const size_t v00 = z * GridSize + x;
+            const size_t v10 = v00 + 1;
+            const size_t v01 = v00 + GridSize;
+            const size_t v11 = v01 + 1;
+
+            Face face;
+            face.m_v0 = v00;
+            face.m_v1 = i % 2 == 0 ? v10 : v11;
+            face.m_v2 = i % 2 == 0 ? v11 : v01;
+            face.m_n0 = face.m_t0 = face.m_v0;
+            face.m_n1 = face.m_t1 = face.m_v1;
+            face.m_n2 = face.m_t2 = face.m_v2;
+            face.m_material = 0;
+            return face;
+        }
+
+      private:
+        static double get_height(const double x, const double z)
+        {
+            return 0.1 * sin(20.0 * x) * cos(20.0 * z);
+        }
+    };
+
+    void write_test_mesh_files()
+    {
+        static bool written = false;
+
+        if (!written)
+        {
+            GridMeshWalker walker;
+
+            OBJMeshFileWriter obj_writer;
+            obj_writer.write(OBJFilename, walker);
+
+            BinaryMeshFileWriter binary_writer;
+            binary_writer.write(BinaryMeshFilename, walker);
+
+            BinaryMeshFileWriter quantized_binary_writer(
+                BinaryMeshFileWriter::QuantizeVertices | BinaryMeshFileWriter::QuantizeNormals);
+            quantized_binary_writer.write(QuantizedBinaryMeshFilename, walker);
+
+            written = true;
+        }
+    }
+
+    struct Fixture
+    {
+        Fixture()
+        {
+            write_test_mesh_files();
+
+            // Keep per-file log messages out of the benchmark output.
+            global_logger().set_enabled(false);
+        }
+
+        ~Fixture()
+        {
+            global_logger().set_enabled(true);
+        }
+
+        void read(const char* filename)
+        {
+            MeshObjectArray objects = MeshObjectReader::read(filename, "grid", ParamArray());
+
+            for (size_t i = 0; i < objects.size(); ++i)
+                objects[i]->release();
+        }
+    };
+
+    BENCHMARK_CASE_F(Read_OBJFile, Fixture)
+    {
+        read(OBJFilename);
+    }
+
+    BENCHMARK_CASE_F(Read_BinaryMeshFile, Fixture)
+    {
+        read(BinaryMeshFilename);
+    }
+
+    BENCHMARK_CASE_F(Read_QuantizedBinaryMeshFile, Fixture)
+    {
+        read(QuantizedBinaryMeshFilename);
+    }
+}
@@ -0,0 +1,211 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/rng.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Texturing_TextureCache)
+{
+    // The texture is made of TileCount x TileCount tiles of TileSize x TileSize pixels.
+    const size_t TileSize = 32;
+    const size_t TileCount = 32;
+
+    // Number of tile lookups per iteration.
+    const size_t LookupCount = 4096;
+
+    // The texture store holds the whole texture while the texture cache
+    // only holds a small fraction of it (12 KB per tile).
+    const size_t StoreMemoryLimit = 64 * 1024 * 1024;
+    const size_t CacheMemoryLimit = 1024 * 1024;
+
+    // A texture whose tiles are generated on demand.
+    class ProceduralTexture
+      : public Texture
+    {
+      public:
+        ProceduralTexture()
+          : Texture("procedural_texture", ParamArray())
+          , m_props(
+                TileSize * TileCount,
+                TileSize * TileCount,
+                TileSize,
+                TileSize,
+                3,
+                PixelFormatFloat)
+        {
+        }
+
+        virtual void release()
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const
+        {
+            return "procedural_texture";
+        }
+
+        virtual ColorSpace get_color_space() const
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties()
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y)
+        {
+            Tile* tile = new Tile(TileSize, TileSize, 3, PixelFormatFloat);
+            tile->clear(Color3f(0.5f));
+            return tile;
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            Tile*           tile)
+        {
+            delete tile;
+        }
+
+      private:
+        const CanvasProperties  m_props;
+    };
+
+    typedef pair<size_t, size_t> TileCoordinates;
+
+    struct Fixture
+      : public TestFixtureBase
+    {
+        const UniqueID              m_assembly_uid;
+        size_t                      m_texture_index;
+        TextureStore*               m_texture_store;
+        TextureCache*               m_texture_cache;
+        vector<TileCoordinates>     m_coherent_lookups;
+        vector<TileCoordinates>     m_random_lookups;
+        float                       m_dummy;
+
+        Fixture()
+          : m_assembly_uid(~UniqueID(0))
+          , m_dummy(0.0f)
+        {
+            m_texture_index =
+                m_scene.textures().insert(auto_release_ptr<Texture>(new ProceduralTexture()));
+
+            m_texture_store = new TextureStore(m_scene, StoreMemoryLimit);
+            m_texture_cache = new TextureCache(*m_texture_store, CacheMemoryLimit);
+
+            // Coherent lookups: every tile is requested a few times in a row,
+            // tiles are visited in scanline order.
+            for (size_t i = 0; i < LookupCount; ++i)
+            {
+                const size_t tile_index = (i / 4) % (TileCount * TileCount);
+                m_coherent_lookups.push_back(
+                    TileCoordinates(tile_index % TileCount, tile_index / TileCount));
+            }
+
+            // Incoherent lookups: tiles are requested in random order.
+            MersenneTwister rng;
+            for (size_t i = 0; i < LookupCount; ++i)
+            {
+                const size_t tile_x = rand_int1(rng, 0, static_cast<int32>(TileCount - 1));
+                const size_t tile_y = rand_int1(rng, 0, static_cast<int32>(TileCount - 1));
+                m_random_lookups.push_back(TileCoordinates(tile_x, tile_y));
+            }
+
+            // Load all tiles into the texture store so that only cache behavior is measured.
+            for (size_t y = 0; y < TileCount; ++y)
+            {
+                for (size_t x = 0; x < TileCount; ++x)
+                    m_texture_cache->get(m_assembly_uid, m_texture_index, 0, x, y);
+            }
+        }
+
+        ~Fixture()
+        {
+            // The texture cache must release its tiles before the texture store goes away.
+            delete m_texture_cache;
+            delete m_texture_store;
+        }
+
+        void lookup(const vector<TileCoordinates>& lookups)
+        {
+            for (size_t i = 0; i < lookups.size(); ++i)
+            {
+                Tile& tile =
+                    m_texture_cache->get(
+                        m_assembly_uid,
+                        m_texture_index,
+                        0,
+                        lookups[i].first,
+                        lookups[i].second);
+
+                m_dummy += tile.get_component<float>(0, 0, 0);
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(Get_CoherentLookups, Fixture)
+    {
+        lookup(m_coherent_lookups);
+    }
+
+    BENCHMARK_CASE_F(Get_RandomLookups, Fixture)
+    {
+        lookup(m_random_lookups);
+    }
+}
@@ -29,6 +29,7 @@
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/bsdf/bsdfmix.h"
 #include "renderer/modeling/bsdf/lambertianbrdf.h"
@@ -126,7 +127,8 @@ TEST_SUITE(Renderer_Modeling_BSDF_BSDFMix)
             i->on_frame_begin(project.ref(), assembly, uniform_data);
         }
 
-        TextureCache texture_cache(scene, 16 * 1024);
+        TextureStore texture_store(scene, 16 * 1024);
+        TextureCache texture_cache(texture_store, 16 * 1024);
         InputEvaluator input_evaluator(texture_cache);
         InputParams input_params;
 
@@ -28,6 +28,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/global.h"
+#include "renderer/kernel/intersection/intersectionsettings.h"
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
@@ -44,6 +45,9 @@
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+
 TEST_SUITE(Renderer_Kernel_Intersection_Intersector)
 {
     using namespace foundation;
@@ -163,4 +167,27 @@ TEST_SUITE(Renderer_Kernel_Intersection_Intersector)
 
         EXPECT_FALSE(hit);
     }
+
+    TEST_CASE_F(TracePacket_GivenAssemblyContainingEmptyBoundingBoxAndRaysWithTMaxInsideAssembly_ReturnsNoHit, Fixture)
+    {
+        ShadingRay rays[RayPacketSize];
+
+        for (size_t i = 0; i < RayPacketSize; ++i)
+        {
+            rays[i] =
+                ShadingRay(
+                    Vector3d(0.1 * i, 0.0, 2.0),
+                    Vector3d(0.0, 0.0, -1.0),
+                    0.0,
+                    2.0,
+                    0.0f,
+                    ~0);
+        }
+
+        ShadingPoint shading_points[RayPacketSize];
+        m_intersector.trace_packet(rays, shading_points);
+
+        for (size_t i = 0; i < RayPacketSize; ++i)
+            EXPECT_FALSE(shading_points[i].hit());
+    }
 }
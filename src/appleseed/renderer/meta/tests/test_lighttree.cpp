@@ -0,0 +1,147 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/lighttree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <utility>
+
+TEST_SUITE(Renderer_Kernel_Lighting_LightTree)
+{
+    using namespace foundation;
+    using namespace renderer;
+    using namespace std;
+
+    LightTree::Emitter make_emitter(
+        const Vector3d&     position,
+        const Vector3d&     axis,
+        const double        energy)
+    {
+        LightTree::Emitter emitter;
+        emitter.m_bbox = AABB3d(position - Vector3d(0.5), position + Vector3d(0.5));
+        emitter.m_axis = axis;
+        emitter.m_theta_o = 0.0;
+        emitter.m_energy = energy;
+        return emitter;
+    }
+
+    struct Fixture
+    {
+        LightTree::EmitterVector    m_emitters;
+        LightTree                   m_tree;
+
+        Fixture()
+        {
+            const Vector3d Up(0.0, 1.0, 0.0);
+
+            for (size_t i = 0; i < 16; ++i)
+            {
+                const double x = static_cast<double>(i) * 4.0;
+                m_emitters.push_back(make_emitter(Vector3d(x, 10.0, 0.0), -Up, 1.0 + i));
+            }
+
+            m_tree.build(m_emitters);
+        }
+    };
+
+    TEST_CASE(Empty_GivenTreeInInitialState_ReturnsTrue)
+    {
+        LightTree tree;
+
+        EXPECT_TRUE(tree.empty());
+    }
+
+    TEST_CASE(Sample_GivenTreeWithOneEmitter_ReturnsEmitterWithProbabilityOne)
+    {
+        LightTree::EmitterVector emitters;
+        emitters.push_back(make_emitter(Vector3d(0.0), Vector3d(0.0, 1.0, 0.0), 1.0));
+
+        LightTree tree;
+        tree.build(emitters);
+
+        const pair<size_t, double> result = tree.sample(Vector3d(0.0, 5.0, 0.0), 0.5);
+
+        EXPECT_EQ(0, result.first);
+        EXPECT_FEQ(1.0, result.second);
+    }
+
+    TEST_CASE_F(EvaluatePDF_SumOverAllEmitters_ReturnsOne, Fixture)
+    {
+        const Vector3d point(13.0, 0.0, 2.0);
+
+        double sum = 0.0;
+
+        for (size_t i = 0; i < m_emitters.size(); ++i)
+            sum += m_tree.evaluate_pdf(point, i);
+
+        EXPECT_FEQ(1.0, sum);
+    }
+
+    TEST_CASE_F(Sample_ReturnsSameProbabilityAsEvaluatePDF, Fixture)
+    {
+        const Vector3d point(13.0, 0.0, 2.0);
+
+        for (size_t i = 0; i < 64; ++i)
+        {
+            const double s = (i + 0.5) / 64.0;
+            const pair<size_t, double> result = m_tree.sample(point, s);
+
+            EXPECT_FEQ(m_tree.evaluate_pdf(point, result.first), result.second);
+        }
+    }
+
+    TEST_CASE_F(EvaluatePDF_GivenPointCloseToEmitter_FavorsThisEmitter, Fixture)
+    {
+        const Vector3d point(0.0, 9.0, 0.0);
+
+        EXPECT_GT(m_tree.evaluate_pdf(point, 15), m_tree.evaluate_pdf(point, 0));
+    }
+
+    TEST_CASE_F(EvaluatePDF_GivenPointBehindEmitters_ReturnsZero, Fixture)
+    {
+        const Vector3d point(30.0, 20.0, 0.0);
+
+        for (size_t i = 0; i < m_emitters.size(); ++i)
+            EXPECT_EQ(0.0, m_tree.evaluate_pdf(point, i));
+    }
+
+    TEST_CASE_F(Sample_GivenPointBehindEmitters_ReturnsZeroProbability, Fixture)
+    {
+        const pair<size_t, double> result = m_tree.sample(Vector3d(30.0, 20.0, 0.0), 0.5);
+
+        EXPECT_EQ(0.0, result.second);
+    }
+}
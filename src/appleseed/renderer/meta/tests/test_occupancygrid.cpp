@@ -0,0 +1,262 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/occupancygrid.h"
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/minmax.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Volume_OccupancyGrid)
+{
+    struct Fixture
+    {
+        VoxelGrid       m_voxel_grid;
+        OccupancyGrid*  m_occupancy_grid;
+
+        Fixture()
+          : m_voxel_grid(8, 8, 8, 1)
+        {
+            // A single voxel of fluid at (6, 6, 6).
+            m_voxel_grid.voxel(6, 6, 6)[0] = 1.0f;
+            m_occupancy_grid = new OccupancyGrid(m_voxel_grid, 0, 0.5f);
+        }
+
+        ~Fixture()
+        {
+            delete m_occupancy_grid;
+        }
+
+        static Vector3d voxel_center(const size_t x, const size_t y, const size_t z)
+        {
+            return Vector3d((x + 0.5) / 8.0, (y + 0.5) / 8.0, (z + 0.5) / 8.0);
+        }
+    };
+
+    TEST_CASE_F(GetLevelCount_Given8x8x8Grid_ReturnsFour, Fixture)
+    {
+        EXPECT_EQ(4, m_occupancy_grid->get_level_count());
+    }
+
+    TEST_CASE_F(HasFluid_GivenPointNextToFluidVoxel_ReturnsTrue, Fixture)
+    {
+        EXPECT_TRUE(m_occupancy_grid->has_fluid(voxel_center(5, 6, 7)));
+    }
+
+    TEST_CASE_F(HasFluid_GivenPointAwayFromFluidVoxel_ReturnsFalse, Fixture)
+    {
+        EXPECT_FALSE(m_occupancy_grid->has_fluid(voxel_center(4, 6, 6)));
+    }
+
+    TEST_CASE_F(FindEmptyNode_GivenPointInOccupiedVoxel_ReturnsFalse, Fixture)
+    {
+        AABB3d node_bbox;
+        const bool empty = m_occupancy_grid->find_empty_node(voxel_center(5, 5, 5), node_bbox);
+
+        EXPECT_FALSE(empty);
+    }
+
+    TEST_CASE_F(FindEmptyNode_GivenPointInEmptyOctant_ReturnsOctant, Fixture)
+    {
+        AABB3d node_bbox;
+        const bool empty = m_occupancy_grid->find_empty_node(voxel_center(1, 2, 3), node_bbox);
+
+        ASSERT_TRUE(empty);
+        EXPECT_EQ(Vector3d(0.0), node_bbox.min);
+        EXPECT_EQ(Vector3d(0.5), node_bbox.max);
+    }
+
+    TEST_CASE_F(FindEmptyNode_GivenPointInEmptyOctantNextToOccupiedOctant_ReturnsOctant, Fixture)
+    {
+        AABB3d node_bbox;
+        const bool empty = m_occupancy_grid->find_empty_node(voxel_center(2, 5, 5), node_bbox);
+
+        ASSERT_TRUE(empty);
+        EXPECT_EQ(Vector3d(0.0, 0.5, 0.5), node_bbox.min);
+        EXPECT_EQ(Vector3d(0.5, 1.0, 1.0), node_bbox.max);
+    }
+
+    TEST_CASE_F(FindEmptyNode_GivenEmptyVoxelWithOccupiedNeighbors_ReturnsVoxel, Fixture)
+    {
+        AABB3d node_bbox;
+        const bool empty = m_occupancy_grid->find_empty_node(voxel_center(4, 4, 4), node_bbox);
+
+        ASSERT_TRUE(empty);
+        EXPECT_EQ(Vector3d(0.5), node_bbox.min);
+        EXPECT_EQ(Vector3d(0.625), node_bbox.max);
+    }
+
+    TEST_CASE_F(GetMaxDensity_GivenVoxelWithinTwoVoxelsOfFluid_ReturnsFluidDensity, Fixture)
+    {
+        const float max_density = m_occupancy_grid->get_max_density(voxel_center(4, 4, 4), 0);
+
+        EXPECT_EQ(1.0f, max_density);
+    }
+
+    TEST_CASE_F(GetMaxDensity_GivenVoxelFartherThanTwoVoxelsFromFluid_ReturnsZero, Fixture)
+    {
+        const float max_density = m_occupancy_grid->get_max_density(voxel_center(3, 6, 6), 0);
+
+        EXPECT_EQ(0.0f, max_density);
+    }
+
+    TEST_CASE_F(GetMaxDensity_GivenRootLevel_ReturnsFluidDensity, Fixture)
+    {
+        const float max_density = m_occupancy_grid->get_max_density(voxel_center(0, 0, 0), 3);
+
+        EXPECT_EQ(1.0f, max_density);
+    }
+
+    TEST_CASE_F(GetNodeBBox_GivenFinestLevel_ReturnsVoxelBoundingBox, Fixture)
+    {
+        const AABB3d node_bbox = m_occupancy_grid->get_node_bbox(voxel_center(4, 4, 4), 0);
+
+        EXPECT_EQ(Vector3d(0.5), node_bbox.min);
+        EXPECT_EQ(Vector3d(0.625), node_bbox.max);
+    }
+
+    TEST_CASE_F(GetNodeBBox_GivenRootLevel_ReturnsUnitCube, Fixture)
+    {
+        const AABB3d node_bbox = m_occupancy_grid->get_node_bbox(voxel_center(0, 0, 0), 3);
+
+        EXPECT_EQ(Vector3d(0.0), node_bbox.min);
+        EXPECT_EQ(Vector3d(1.0), node_bbox.max);
+    }
+
+    TEST_CASE(Constructor_GivenSparseVoxelGrid_MatchesDenseVoxelGrid)
+    {
+        VoxelGrid dense_grid(12, 10, 9, 1);
+        SparseVoxelGrid sparse_grid(12, 10, 9, 1);
+        dense_grid.voxel(2, 3, 4)[0] = sparse_grid.voxel(2, 3, 4)[0] = 1.0f;
+        dense_grid.voxel(10, 8, 7)[0] = sparse_grid.voxel(10, 8, 7)[0] = 2.0f;
+
+        const OccupancyGrid dense_occupancy_grid(dense_grid, 0, 0.5f);
+        const OccupancyGrid sparse_occupancy_grid(sparse_grid, 0, 0.5f);
+
+        ASSERT_EQ(dense_occupancy_grid.get_level_count(), sparse_occupancy_grid.get_level_count());
+
+        for (size_t z = 0; z < 9; ++z)
+        {
+            for (size_t y = 0; y < 10; ++y)
+            {
+                for (size_t x = 0; x < 12; ++x)
+                {
+                    const Vector3d point((x + 0.5) / 12.0, (y + 0.5) / 10.0, (z + 0.5) / 9.0);
+
+                    EXPECT_EQ(dense_occupancy_grid.has_fluid(point), sparse_occupancy_grid.has_fluid(point));
+
+                    for (size_t level = 0; level < dense_occupancy_grid.get_level_count(); ++level)
+                    {
+                        EXPECT_EQ(
+                            dense_occupancy_grid.get_max_density(point, level),
+                            sparse_occupancy_grid.get_max_density(point, level));
+                    }
+                }
+            }
+        }
+    }
+
+    TEST_CASE(Constructor_GivenGridSpanningSeveralBricks_MatchesBruteForceComputation)
+    {
+        const size_t Nx = 21, Ny = 17, Nz = 11;
+        VoxelGrid grid(Nx, Ny, Nz, 1);
+        grid.voxel(0, 0, 0)[0] = 1.0f;
+        grid.voxel(7, 8, 3)[0] = 0.25f;
+        grid.voxel(9, 8, 3)[0] = 2.0f;
+        grid.voxel(20, 16, 10)[0] = 3.0f;
+        grid.voxel(15, 2, 9)[0] = 0.4f;
+
+        const OccupancyGrid occupancy_grid(grid, 0, 0.3f);
+
+        ASSERT_EQ(6, occupancy_grid.get_level_count());
+
+        for (size_t z = 0; z < Nz; ++z)
+        {
+            for (size_t y = 0; y < Ny; ++y)
+            {
+                for (size_t x = 0; x < Nx; ++x)
+                {
+                    float density_sum = 0.0f;
+                    float max_density = 0.0f;
+
+                    for (size_t vz = z > 2 ? z - 2 : 0; vz < min(z + 3, Nz); ++vz)
+                    {
+                        for (size_t vy = y > 2 ? y - 2 : 0; vy < min(y + 3, Ny); ++vy)
+                        {
+                            for (size_t vx = x > 2 ? x - 2 : 0; vx < min(x + 3, Nx); ++vx)
+                            {
+                                const float density = grid.voxel(vx, vy, vz)[0];
+
+                                max_density = max(max_density, density);
+
+                                if (max(vx, x) - min(vx, x) <= 1 &&
+                                    max(vy, y) - min(vy, y) <= 1 &&
+                                    max(vz, z) - min(vz, z) <= 1)
+                                    density_sum += density;
+                            }
+                        }
+                    }
+
+                    const Vector3d point((x + 0.5) / Nx, (y + 0.5) / Ny, (z + 0.5) / Nz);
+
+                    EXPECT_EQ(density_sum > 0.3f, occupancy_grid.has_fluid(point));
+                    EXPECT_EQ(max_density, occupancy_grid.get_max_density(point, 0));
+                }
+            }
+        }
+
+        // Nodes of level 3 cover 8x8x8 voxels.
+        EXPECT_EQ(2.0f, occupancy_grid.get_max_density(Vector3d(4.5 / Nx, 9.5 / Ny, 0.5 / Nz), 3));
+        EXPECT_EQ(0.0f, occupancy_grid.get_max_density(Vector3d(12.5 / Nx, 12.5 / Ny, 9.5 / Nz), 3));
+        EXPECT_EQ(3.0f, occupancy_grid.get_max_density(Vector3d(0.5 / Nx, 0.5 / Ny, 0.5 / Nz), 5));
+    }
+
+    TEST_CASE(GetMemorySize_GivenMostlyEmptyGrid_ReturnsLessThanOneBytePerVoxel)
+    {
+        SparseVoxelGrid grid(128, 128, 128, 1);
+        grid.voxel(64, 64, 64)[0] = 1.0f;
+
+        const OccupancyGrid occupancy_grid(grid, 0, 0.5f);
+
+        EXPECT_TRUE(occupancy_grid.has_fluid(Vector3d((64 + 0.5) / 128)));
+        EXPECT_LT(128 * 128 * 128, occupancy_grid.get_memory_size());
+    }
+}
@@ -0,0 +1,127 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/generic/pixelsampleschedule.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <set>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Rendering_Generic_PixelSampleSchedule)
+{
+    TEST_CASE(Initialize_GivenFixedSquareSampleCount_SamplesAllCellsInRasterOrder)
+    {
+        PixelSampleSchedule schedule;
+        schedule.initialize(16, 16);
+
+        EXPECT_EQ(4, schedule.get_subpixel_grid_size());
+        EXPECT_FALSE(schedule.is_adaptive());
+        EXPECT_EQ(16, schedule.get_initial_sample_count());
+        ASSERT_EQ(16, schedule.get_max_sample_count());
+
+        for (size_t i = 0; i < 16; ++i)
+            EXPECT_EQ(i, schedule.get_cell(i));
+    }
+
+    TEST_CASE(Initialize_GivenFixedNonSquareSampleCount_IsNotAdaptive)
+    {
+        PixelSampleSchedule schedule;
+        schedule.initialize(48, 48);
+
+        EXPECT_FALSE(schedule.is_adaptive());
+    }
+
+    TEST_CASE(Initialize_GivenFixedNonSquareSampleCount_SamplesAllCellsOfRoundedGridInRasterOrder)
+    {
+        PixelSampleSchedule schedule;
+        schedule.initialize(48, 48);
+
+        EXPECT_EQ(7, schedule.get_subpixel_grid_size());
+        EXPECT_EQ(49, schedule.get_initial_sample_count());
+        ASSERT_EQ(49, schedule.get_max_sample_count());
+
+        for (size_t i = 0; i < 49; ++i)
+            EXPECT_EQ(i, schedule.get_cell(i));
+    }
+
+    TEST_CASE(Initialize_GivenSampleCountRange_IsAdaptive)
+    {
+        PixelSampleSchedule schedule;
+        schedule.initialize(4, 16);
+
+        EXPECT_TRUE(schedule.is_adaptive());
+        EXPECT_EQ(4, schedule.get_initial_sample_count());
+        EXPECT_EQ(16, schedule.get_max_sample_count());
+    }
+
+    TEST_CASE(Initialize_GivenSampleCountRange_FirstSamplesCoverAllQuadrantsOfPixel)
+    {
+        PixelSampleSchedule schedule;
+        schedule.initialize(4, 16);
+
+        set<size_t> quadrants;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const size_t cell = schedule.get_cell(i);
+            const size_t x = cell % 4;
+            const size_t y = cell / 4;
+            quadrants.insert((y / 2) * 2 + x / 2);
+        }
+
+        EXPECT_EQ(4, quadrants.size());
+    }
+
+    TEST_CASE(Initialize_GivenSampleCountRange_VisitsEachCellOnce)
+    {
+        PixelSampleSchedule schedule;
+        schedule.initialize(4, 16);
+
+        set<size_t> cells;
+        for (size_t i = 0; i < schedule.get_max_sample_count(); ++i)
+            cells.insert(schedule.get_cell(i));
+
+        EXPECT_EQ(16, cells.size());
+    }
+
+    TEST_CASE(Initialize_GivenNonSquareMaxSampleCount_DoesNotExceedMaxSampleCount)
+    {
+        PixelSampleSchedule schedule;
+        schedule.initialize(8, 48);
+
+        EXPECT_EQ(7, schedule.get_subpixel_grid_size());
+        EXPECT_EQ(48, schedule.get_max_sample_count());
+    }
+}
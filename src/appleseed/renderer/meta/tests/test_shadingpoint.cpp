@@ -0,0 +1,167 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/input/inputparams.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/containers/specializedarrays.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Shading_ShadingPoint)
+{
+    struct TestScene
+    {
+        auto_release_ptr<Scene> m_scene;
+
+        // A unit square in the x = 0 plane, centered on the origin, whose UV coordinates are (y + 0.5, z + 0.5).
+        TestScene()
+          : m_scene(SceneFactory::create())
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory::create("assembly", ParamArray()));
+
+            auto_release_ptr<MeshObject> mesh_object =
+                MeshObjectFactory::create("plane", ParamArray());
+
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, -0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, +0.5f, +0.5f));
+            mesh_object->push_vertex(GVector3(0.0f, -0.5f, +0.5f));
+
+            mesh_object->push_vertex_normal(GVector3(-1.0f, 0.0f, 0.0f));
+
+            mesh_object->push_tex_coords(GVector2(0.0f, 0.0f));
+            mesh_object->push_tex_coords(GVector2(1.0f, 0.0f));
+            mesh_object->push_tex_coords(GVector2(1.0f, 1.0f));
+            mesh_object->push_tex_coords(GVector2(0.0f, 1.0f));
+
+            mesh_object->push_triangle(Triangle(0, 1, 2, 0, 0, 0, 0, 1, 2, 0));
+            mesh_object->push_triangle(Triangle(2, 3, 0, 0, 0, 0, 2, 3, 0, 0));
+
+            Object* object = mesh_object.get();
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "plane_inst",
+                    ParamArray(),
+                    *object,
+                    Transformd(Matrix4d::identity()),
+                    StringArray()));
+
+            m_scene->assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    *assembly,
+                    Transformd(Matrix4d::identity())));
+
+            m_scene->assemblies().insert(assembly);
+        }
+    };
+
+    struct Fixture
+      : public TestScene
+    {
+        TraceContext    m_trace_context;
+        Intersector     m_intersector;
+
+        Fixture()
+          : m_trace_context(m_scene.ref())
+          , m_intersector(m_trace_context)
+        {
+        }
+
+        // Trace a ray of a given spread hitting the origin after travelling a unit distance.
+        InputParams trace(const Vector3d& dir, const double spread)
+        {
+            ShadingRay ray(-dir, dir, 0.0f, ~0);
+            ray.m_spread = spread;
+
+            ShadingPoint shading_point;
+            m_intersector.trace(ray, shading_point);
+
+            return shading_point.get_input_params();
+        }
+    };
+
+    TEST_CASE_F(GetInputParams_GivenRayWithoutSpread_ReturnsZeroFootprint, Fixture)
+    {
+        const InputParams params = trace(Vector3d(1.0, 0.0, 0.0), 0.0);
+
+        EXPECT_EQ(Vector2d(0.0), params.m_duvdx);
+        EXPECT_EQ(Vector2d(0.0), params.m_duvdy);
+    }
+
+    TEST_CASE_F(GetInputParams_GivenRayAtNormalIncidence_ReturnsIsotropicFootprint, Fixture)
+    {
+        const InputParams params = trace(Vector3d(1.0, 0.0, 0.0), 0.01);
+
+        EXPECT_FEQ(0.01, norm(params.m_duvdx));
+        EXPECT_FEQ(0.01, norm(params.m_duvdy));
+        EXPECT_FEQ(0.0, dot(params.m_duvdx, params.m_duvdy));
+    }
+
+    TEST_CASE_F(GetInputParams_GivenRayAtGrazingAngle_StretchesFootprintAlongRay, Fixture)
+    {
+        // The ray travels in the xy plane at 60 degrees from the normal, hence the
+        // footprint is stretched by a factor 2 along u and left unchanged along v.
+        const double angle = 60.0 * Pi / 180.0;
+        const InputParams params = trace(Vector3d(cos(angle), sin(angle), 0.0), 0.01);
+
+        EXPECT_FEQ(0.0, params.m_duvdx[0]);
+        EXPECT_FEQ(0.01, abs(params.m_duvdx[1]));
+        EXPECT_FEQ(0.02, abs(params.m_duvdy[0]));
+        EXPECT_FEQ(0.0, params.m_duvdy[1]);
+    }
+}
@@ -141,6 +141,38 @@ TEST_SUITE(Renderer_Kernel_Shading_ShadingResult)
         EXPECT_EQ(Spectrum(0.0f), result.m_color);
     }
 
+    TEST_CASE(Clear_GivenSpectralColorSpace_SetsAllSamplesToZero)
+    {
+        ShadingResult result;
+        result.m_color.set(1.0f);
+        result.m_alpha.set(1.0f);
+
+        result.clear(ColorSpaceSpectral);
+
+        EXPECT_EQ(ColorSpaceSpectral, result.m_color_space);
+        EXPECT_EQ(Spectrum(0.0f), result.m_color);
+        EXPECT_EQ(0.0f, result.m_alpha[0]);
+    }
+
+    TEST_CASE(CompositeOver_GivenSpectralResults_CompositesAllSamples)
+    {
+        ShadingResult background;
+        background.clear(ColorSpaceSpectral);
+        background.m_color.set(1.0f);
+        background.m_alpha.set(1.0f);
+
+        ShadingResult result;
+        result.clear(ColorSpaceSpectral);
+        result.m_color.set(0.25f);
+        result.m_alpha.set(0.25f);
+
+        result.composite_over(background);
+
+        EXPECT_EQ(ColorSpaceSpectral, result.m_color_space);
+        EXPECT_EQ(Spectrum(1.0f), result.m_color);
+        EXPECT_EQ(1.0f, result.m_alpha[0]);
+    }
+
     TEST_CASE_F(TransformToSpectrum_GivenSpectrum_DoesNothing, Fixture)
     {
         ShadingResult result;
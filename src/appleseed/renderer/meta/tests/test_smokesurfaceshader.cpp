@@ -0,0 +1,223 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingpointbuilder.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/shading/shadingresult.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/surfaceshader/smokesurfaceshader.h"
+#include "renderer/modeling/surfaceshader/surfaceshader.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/rng.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_SurfaceShader_SmokeSurfaceShader)
+{
+    struct Fixture
+    {
+        auto_release_ptr<Project>   m_project;
+        Assembly*                   m_assembly;
+
+        Fixture()
+          : m_project(ProjectFactory::create("project"))
+        {
+            m_project->set_scene(SceneFactory::create());
+
+            m_project->get_scene()->assemblies().insert(
+                AssemblyFactory::create("assembly", ParamArray()));
+
+            m_assembly = m_project->get_scene()->assemblies().get_by_name("assembly");
+        }
+
+        auto_release_ptr<SurfaceShader> create_shader(const ParamArray& extra_params) const
+        {
+            // Without a filename, the shader creates a procedural voxel grid
+            // made of dense clouds separated by empty space.
+            ParamArray params(extra_params);
+            params.insert("bounding_box", "-1.0 -1.0 -1.0 1.0 1.0 1.0");
+            params.insert("step_size", "0.02");
+
+            SmokeSurfaceShaderFactory factory;
+            auto_release_ptr<SurfaceShader> shader(factory.create("smoke", params));
+            shader->on_frame_begin(m_project.ref(), *m_assembly);
+
+            return shader;
+        }
+
+        Color4f shade(const SurfaceShader& shader, const Vector3d& org, const Vector3d& dir) const
+        {
+            Scene& scene = *m_project->get_scene();
+
+            TraceContext trace_context(scene);
+            Intersector intersector(trace_context);
+            TextureStore texture_store(scene, 16 * 1024);
+            TextureCache texture_cache(texture_store, 16 * 1024);
+            ShadingContext shading_context(intersector, texture_cache);
+
+            MersenneTwister rng;
+            SamplingContext sampling_context(rng, 0, 0, 0);
+
+            ShadingPoint shading_point;
+            ShadingPointBuilder builder(shading_point);
+            builder.set_scene(&scene);
+            builder.set_ray(ShadingRay(org, dir, 0.0, 0));
+
+            ShadingResult shading_result;
+            shader.evaluate(sampling_context, shading_context, shading_point, shading_result);
+
+            return
+                Color4f(
+                    shading_result.m_color[0],
+                    shading_result.m_color[1],
+                    shading_result.m_color[2],
+                    shading_result.m_alpha[0]);
+        }
+
+        template <typename Predicate>
+        void check_rays(
+            const SurfaceShader&    reference_shader,
+            const SurfaceShader&    shader,
+            Predicate&              predicate) const
+        {
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < 64; ++i)
+            {
+                const Vector3d org(
+                    rand_double1(rng, -3.0, 3.0),
+                    rand_double1(rng, -3.0, 3.0),
+                    -3.0);
+
+                const Vector3d target(
+                    rand_double1(rng, -0.8, 0.8),
+                    rand_double1(rng, -0.8, 0.8),
+                    rand_double1(rng, -0.8, 0.8));
+
+                predicate(
+                    shade(reference_shader, org, target - org),
+                    shade(shader, org, target - org));
+            }
+        }
+    };
+
+    struct ExpectEqual
+    {
+        size_t m_mismatch_count;
+
+        ExpectEqual() : m_mismatch_count(0) {}
+
+        void operator()(const Color4f& expected, const Color4f& actual)
+        {
+            if (!feq(expected, actual, 1.0e-5f))
+                ++m_mismatch_count;
+        }
+    };
+
+    struct ExpectClose
+    {
+        size_t m_mismatch_count;
+
+        ExpectClose() : m_mismatch_count(0) {}
+
+        void operator()(const Color4f& expected, const Color4f& actual)
+        {
+            for (size_t i = 0; i < 4; ++i)
+            {
+                if (std::abs(expected[i] - actual[i]) > 0.02f)
+                {
+                    ++m_mismatch_count;
+                    break;
+                }
+            }
+        }
+    };
+
+    TEST_CASE_F(Evaluate_GivenEmptySpaceSkipping_MatchesFixedStepMarching, Fixture)
+    {
+        auto_release_ptr<SurfaceShader> reference_shader(
+            create_shader(
+                ParamArray()
+                    .insert("density_scale", "50.0")
+                    .insert("skip_empty_space", "false")));
+
+        auto_release_ptr<SurfaceShader> shader(
+            create_shader(
+                ParamArray()
+                    .insert("density_scale", "50.0")
+                    .insert("skip_empty_space", "true")));
+
+        ExpectEqual predicate;
+        check_rays(reference_shader.ref(), shader.ref(), predicate);
+
+        EXPECT_EQ(0, predicate.m_mismatch_count);
+    }
+
+    TEST_CASE_F(Evaluate_GivenAdaptiveStepSize_CloselyMatchesFixedStepMarching, Fixture)
+    {
+        auto_release_ptr<SurfaceShader> reference_shader(
+            create_shader(
+                ParamArray()
+                    .insert("density_scale", "3.0")
+                    .insert("skip_empty_space", "false")));
+
+        // Thin enough for the shader to take larger steps through most of the volume.
+        auto_release_ptr<SurfaceShader> shader(
+            create_shader(
+                ParamArray()
+                    .insert("density_scale", "3.0")
+                    .insert("max_step_size", "0.08")));
+
+        ExpectClose predicate;
+        check_rays(reference_shader.ref(), shader.ref(), predicate);
+
+        EXPECT_EQ(0, predicate.m_mismatch_count);
+    }
+}
@@ -0,0 +1,134 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+#include "renderer/modeling/texture/texture.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Texture_Texture)
+{
+    // A 5x3 single-channel texture split into 2x2 tiles, whose texels are x + 10 * y.
+    class RampTexture
+      : public Texture
+    {
+      public:
+        RampTexture()
+          : Texture("ramp_texture", ParamArray())
+          , m_props(5, 3, 2, 2, 1, PixelFormatFloat)
+        {
+        }
+
+        virtual void release()
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const
+        {
+            return "ramp_texture";
+        }
+
+        virtual ColorSpace get_color_space() const
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties()
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y)
+        {
+            const size_t width = m_props.get_tile_width(tile_x);
+            const size_t height = m_props.get_tile_height(tile_y);
+
+            Tile* tile = new Tile(width, height, 1, PixelFormatFloat);
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    const size_t ix = tile_x * m_props.m_tile_width + x;
+                    const size_t iy = tile_y * m_props.m_tile_height + y;
+                    tile->set_component(x, y, 0, static_cast<float>(ix + 10 * iy));
+                }
+            }
+
+            return tile;
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            Tile*           tile)
+        {
+            delete tile;
+        }
+
+      private:
+        const CanvasProperties m_props;
+    };
+
+    TEST_CASE(GetLevelCount_GivenNonSquareTexture_StopsAtOnePixel)
+    {
+        RampTexture texture;
+
+        EXPECT_EQ(3, texture.get_level_count());
+    }
+
+    TEST_CASE(GetLevelProperties_GivenOddSizedTexture_HalvesAndClampsTileSize)
+    {
+        RampTexture texture;
+
+        const CanvasProperties& props1 = texture.get_level_properties(1);
+        EXPECT_EQ(2, props1.m_canvas_width);
+        EXPECT_EQ(1, props1.m_canvas_height);
+        EXPECT_EQ(2, props1.m_tile_width);
+        EXPECT_EQ(1, props1.m_tile_height);
+
+        const CanvasProperties& props2 = texture.get_level_properties(2);
+        EXPECT_EQ(1, props2.m_canvas_width);
+        EXPECT_EQ(1, props2.m_canvas_height);
+    }
+}
@@ -0,0 +1,250 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/input/inputparams.h"
+#include "renderer/modeling/input/texturesource.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Modeling_Input_TextureSource)
+{
+    // Texel value of a ramp along the x axis.
+    float ramp(const size_t x, const size_t y)
+    {
+        return static_cast<float>(x);
+    }
+
+    // Texel value of alternating black and white columns.
+    float stripes(const size_t x, const size_t y)
+    {
+        return static_cast<float>(x & 1);
+    }
+
+    // An 8x8 gray texture split into 4x4 tiles, whose texels are given by a function.
+    class FunctionTexture
+      : public Texture
+    {
+      public:
+        typedef float (*TexelFunction)(const size_t x, const size_t y);
+
+        explicit FunctionTexture(const TexelFunction texel_function)
+          : Texture("function_texture", ParamArray())
+          , m_texel_function(texel_function)
+          , m_props(8, 8, 4, 4, 3, PixelFormatFloat)
+        {
+        }
+
+        virtual void release()
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const
+        {
+            return "function_texture";
+        }
+
+        virtual ColorSpace get_color_space() const
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties()
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y)
+        {
+            Tile* tile = new Tile(4, 4, 3, PixelFormatFloat);
+
+            for (size_t y = 0; y < 4; ++y)
+            {
+                for (size_t x = 0; x < 4; ++x)
+                {
+                    const float value = m_texel_function(tile_x * 4 + x, tile_y * 4 + y);
+                    tile->set_pixel(x, y, Color3f(value));
+                }
+            }
+
+            return tile;
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            Tile*           tile)
+        {
+            delete tile;
+        }
+
+      private:
+        const TexelFunction     m_texel_function;
+        const CanvasProperties  m_props;
+    };
+
+    struct Fixture
+      : public TestFixtureBase
+    {
+        TextureStore            m_texture_store;
+        TextureCache            m_texture_cache;
+
+        Fixture()
+          : m_texture_store(m_scene, 1024 * 1024)
+          , m_texture_cache(m_texture_store, 1024 * 1024)
+        {
+        }
+
+        // Sample a texture at (u, 0.5) with a given filter and a given UV footprint.
+        float sample(
+            const FunctionTexture::TexelFunction    texel_function,
+            const char*                             filtering_mode,
+            const double                            u,
+            const Vector2d&                         duvdx,
+            const Vector2d&                         duvdy)
+        {
+            Texture* texture = new FunctionTexture(texel_function);
+            const size_t texture_index = m_scene.textures().insert(auto_release_ptr<Texture>(texture));
+
+            ParamArray params;
+            params.insert("addressing_mode", "clamp");
+            params.insert("filtering_mode", filtering_mode);
+            auto_release_ptr<TextureInstance> texture_instance(
+                TextureInstanceFactory::create("texture_instance", params, texture_index));
+
+            TextureSource source(~UniqueID(0), texture_instance.ref(), *texture);
+
+            InputParams input_params;
+            input_params.m_uv = Vector2d(u, 0.5);
+            input_params.m_duvdx = duvdx;
+            input_params.m_duvdy = duvdy;
+
+            Color3f color;
+            Alpha alpha;
+            source.evaluate(m_texture_cache, input_params, color, alpha);
+
+            return color[0];
+        }
+
+        // Sample a texture at (u, 0.5) with a given filter and an isotropic footprint of a given width, in texels.
+        float sample(
+            const FunctionTexture::TexelFunction    texel_function,
+            const char*                             filtering_mode,
+            const double                            u,
+            const double                            width)
+        {
+            return
+                sample(
+                    texel_function,
+                    filtering_mode,
+                    u,
+                    Vector2d(width / 8.0, 0.0),
+                    Vector2d(0.0, width / 8.0));
+        }
+    };
+
+    // The levels of the ramp texture are 8, 4, 2 and 1 texels wide. At u = 0,
+    // bilinear lookups return their first texels: 0.0, 0.5, 1.5 and 3.5.
+
+    TEST_CASE_F(Trilinear_GivenSubTexelFootprint_SamplesLevelZero, Fixture)
+    {
+        EXPECT_FEQ(0.0f, sample(ramp, "trilinear", 0.0, 0.5));
+    }
+
+    TEST_CASE_F(Trilinear_GivenTwoTexelFootprint_SamplesLevelOne, Fixture)
+    {
+        EXPECT_FEQ(0.5f, sample(ramp, "trilinear", 0.0, 2.0));
+    }
+
+    TEST_CASE_F(Trilinear_GivenFootprintBetweenTwoLevels_BlendsLevels, Fixture)
+    {
+        // Level of detail 1.5, halfway between level 1 and level 2.
+        EXPECT_FEQ(1.0f, sample(ramp, "trilinear", 0.0, 2.0 * sqrt(2.0)));
+    }
+
+    TEST_CASE_F(Trilinear_GivenFootprintLargerThanTexture_SamplesLastLevel, Fixture)
+    {
+        EXPECT_FEQ(3.5f, sample(ramp, "trilinear", 0.0, 16.0));
+    }
+
+    TEST_CASE_F(Trilinear_GivenAnisotropicFootprintAlongStripes_BlursStripes, Fixture)
+    {
+        // Trilinear filtering uses the major axis of the footprint.
+        const float value =
+            sample(stripes, "trilinear", 3.5 / 8.0, Vector2d(0.5 / 8.0, 0.0), Vector2d(0.0, 4.0 / 8.0));
+
+        EXPECT_FEQ(0.5f, value);
+    }
+
+    TEST_CASE_F(EWA_GivenSubTexelFootprint_SamplesLevelZero, Fixture)
+    {
+        EXPECT_FEQ(0.0f, sample(ramp, "ewa", 0.0, 0.5));
+    }
+
+    TEST_CASE_F(EWA_GivenFootprintLargerThanTexture_SamplesLastLevel, Fixture)
+    {
+        EXPECT_FEQ(3.5f, sample(ramp, "ewa", 0.0, 16.0));
+    }
+
+    TEST_CASE_F(EWA_GivenAnisotropicFootprintAlongStripes_PreservesStripes, Fixture)
+    {
+        // EWA filtering uses the minor axis of the footprint, narrower than a stripe.
+        const float value =
+            sample(stripes, "ewa", 3.5 / 8.0, Vector2d(0.5 / 8.0, 0.0), Vector2d(0.0, 4.0 / 8.0));
+
+        EXPECT_GT(0.75f, value);
+    }
+}
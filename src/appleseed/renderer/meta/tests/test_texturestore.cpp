@@ -0,0 +1,355 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/thread.h"
+#include "foundation/utility/test.h"
+
+// boost headers.
+#include "boost/bind.hpp"
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureStore)
+{
+    // A texture that counts how many tiles it loaded and how many are still alive.
+    class CountingTexture
+      : public Texture
+    {
+      public:
+        size_t  m_load_count;
+        size_t  m_live_tile_count;
+
+        CountingTexture()
+          : Texture("counting_texture", ParamArray())
+          , m_load_count(0)
+          , m_live_tile_count(0)
+          , m_props(4, 4, 2, 2, 3, PixelFormatFloat)
+        {
+        }
+
+        virtual void release()
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const
+        {
+            return "counting_texture";
+        }
+
+        virtual ColorSpace get_color_space() const
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties()
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y)
+        {
+            // Give concurrent requests a chance to pile up.
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+
+            boost::mutex::scoped_lock lock(m_mutex);
+            ++m_load_count;
+            ++m_live_tile_count;
+
+            return new Tile(2, 2, 3, PixelFormatFloat);
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            Tile*           tile)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            --m_live_tile_count;
+
+            delete tile;
+        }
+
+      private:
+        boost::mutex            m_mutex;
+        const CanvasProperties  m_props;
+    };
+
+    struct Fixture
+      : public TestFixtureBase
+    {
+        CountingTexture*        m_texture;
+        TextureStore::TileKey   m_key;
+
+        Fixture()
+          : m_texture(new CountingTexture())
+        {
+            m_key.m_assembly_uid = ~UniqueID(0);
+            m_key.m_texture_index = m_scene.textures().insert(auto_release_ptr<Texture>(m_texture));
+            m_key.m_level = 0;
+            m_key.m_tile_x = 1;
+            m_key.m_tile_y = 0;
+        }
+    };
+
+    TEST_CASE_F(Acquire_GivenSameTileTwice_LoadsTileOnce, Fixture)
+    {
+        TextureStore texture_store(m_scene, 1024 * 1024);
+
+        const Tile* tile1 = texture_store.acquire(m_key);
+        const Tile* tile2 = texture_store.acquire(m_key);
+
+        EXPECT_EQ(tile1, tile2);
+        EXPECT_EQ(1, m_texture->m_load_count);
+
+        texture_store.release(m_key);
+        texture_store.release(m_key);
+    }
+
+    TEST_CASE_F(Release_GivenStoreOverBudget_EvictsTile, Fixture)
+    {
+        TextureStore texture_store(m_scene, 0);
+
+        texture_store.acquire(m_key);
+        EXPECT_EQ(1, m_texture->m_live_tile_count);
+
+        texture_store.release(m_key);
+        EXPECT_EQ(0, m_texture->m_live_tile_count);
+
+        texture_store.acquire(m_key);
+        EXPECT_EQ(2, m_texture->m_load_count);
+
+        texture_store.release(m_key);
+    }
+
+    TEST_CASE_F(Release_GivenStoreWithinBudget_KeepsTileForLaterRequests, Fixture)
+    {
+        {
+            TextureStore texture_store(m_scene, 1024 * 1024);
+
+            texture_store.acquire(m_key);
+            texture_store.release(m_key);
+            texture_store.acquire(m_key);
+            texture_store.release(m_key);
+
+            EXPECT_EQ(1, m_texture->m_load_count);
+            EXPECT_EQ(1, texture_store.get_hit_count());
+            EXPECT_EQ(1, texture_store.get_miss_count());
+        }
+
+        EXPECT_EQ(0, m_texture->m_live_tile_count);
+    }
+
+    void acquire_and_release(
+        TextureStore*                   texture_store,
+        const TextureStore::TileKey*    key)
+    {
+        texture_store->acquire(*key);
+        texture_store->release(*key);
+    }
+
+    TEST_CASE_F(Acquire_GivenConcurrentRequestsForSameTile_LoadsTileOnce, Fixture)
+    {
+        TextureStore texture_store(m_scene, 1024 * 1024);
+
+        boost::thread_group threads;
+
+        for (size_t i = 0; i < 8; ++i)
+            threads.create_thread(boost::bind(&acquire_and_release, &texture_store, &m_key));
+
+        threads.join_all();
+
+        EXPECT_EQ(1, m_texture->m_load_count);
+    }
+
+    // A 5x3 single-channel texture split into 2x2 tiles, whose texels are x + 10 * y.
+    class RampTexture
+      : public Texture
+    {
+      public:
+        RampTexture()
+          : Texture("ramp_texture", ParamArray())
+          , m_props(5, 3, 2, 2, 1, PixelFormatFloat)
+        {
+        }
+
+        virtual void release()
+        {
+            delete this;
+        }
+
+        virtual const char* get_model() const
+        {
+            return "ramp_texture";
+        }
+
+        virtual ColorSpace get_color_space() const
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        virtual const CanvasProperties& properties()
+        {
+            return m_props;
+        }
+
+        virtual Tile* load_tile(
+            const size_t    tile_x,
+            const size_t    tile_y)
+        {
+            const size_t width = m_props.get_tile_width(tile_x);
+            const size_t height = m_props.get_tile_height(tile_y);
+
+            Tile* tile = new Tile(width, height, 1, PixelFormatFloat);
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    const size_t ix = tile_x * m_props.m_tile_width + x;
+                    const size_t iy = tile_y * m_props.m_tile_height + y;
+                    tile->set_component(x, y, 0, static_cast<float>(ix + 10 * iy));
+                }
+            }
+
+            return tile;
+        }
+
+        virtual void unload_tile(
+            const size_t    tile_x,
+            const size_t    tile_y,
+            Tile*           tile)
+        {
+            delete tile;
+        }
+
+      private:
+        const CanvasProperties m_props;
+    };
+
+    struct RampFixture
+      : public TestFixtureBase
+    {
+        size_t                  m_texture_index;
+
+        RampFixture()
+          : m_texture_index(m_scene.textures().insert(auto_release_ptr<Texture>(new RampTexture())))
+        {
+        }
+
+        float get_level_texel(
+            const size_t        level,
+            const size_t        x,
+            const size_t        y)
+        {
+            TextureStore texture_store(m_scene, 1024 * 1024);
+
+            TextureStore::TileKey key;
+            key.m_assembly_uid = ~UniqueID(0);
+            key.m_texture_index = m_texture_index;
+            key.m_level = level;
+            key.m_tile_x = 0;
+            key.m_tile_y = 0;
+
+            const float value = texture_store.acquire(key)->get_component<float>(x, y, 0);
+            texture_store.release(key);
+
+            return value;
+        }
+    };
+
+    TEST_CASE_F(Acquire_GivenLevelOneTile_AveragesSourceTexelsAcrossTiles, RampFixture)
+    {
+        // Texels x in [0, 2) and y in [0, 3).
+        EXPECT_FEQ(10.5f, get_level_texel(1, 0, 0));
+
+        // Texels x in [2, 5) and y in [0, 3).
+        EXPECT_FEQ(13.0f, get_level_texel(1, 1, 0));
+    }
+
+    TEST_CASE_F(Acquire_GivenLastLevelTile_AveragesPreviousLevel, RampFixture)
+    {
+        EXPECT_FEQ(11.75f, get_level_texel(2, 0, 0));
+    }
+
+    TEST_CASE_F(Acquire_GivenLevelOneTile_LoadsSourceTilesOnce, Fixture)
+    {
+        TextureStore texture_store(m_scene, 1024 * 1024);
+
+        TextureStore::TileKey key = m_key;
+        key.m_level = 1;
+        key.m_tile_x = 0;
+        key.m_tile_y = 0;
+
+        texture_store.acquire(key);
+        texture_store.release(key);
+        texture_store.acquire(key);
+        texture_store.release(key);
+
+        // Level 1 is a single 2x2 tile generated from the four tiles of level 0.
+        EXPECT_EQ(4, m_texture->m_load_count);
+    }
+
+    TEST_CASE_F(Acquire_GivenLevelOneTileAndStoreOverBudget_DoesNotKeepSourceTiles, Fixture)
+    {
+        TextureStore texture_store(m_scene, 0);
+
+        TextureStore::TileKey key = m_key;
+        key.m_level = 1;
+        key.m_tile_x = 0;
+        key.m_tile_y = 0;
+
+        texture_store.acquire(key);
+
+        EXPECT_EQ(4, m_texture->m_load_count);
+        EXPECT_EQ(0, m_texture->m_live_tile_count);
+
+        texture_store.release(key);
+    }
+}
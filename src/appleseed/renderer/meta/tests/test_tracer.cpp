@@ -33,6 +33,7 @@
 #include "renderer/kernel/lighting/tracer.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/color/colorentity.h"
 #include "renderer/modeling/input/inputbinder.h"
 #include "renderer/modeling/material/material.h"
@@ -186,6 +187,7 @@ TEST_SUITE(Renderer_Kernel_Lighting_Tracer)
     {
         TraceContext        m_trace_context;
         Intersector         m_intersector;
+        TextureStore        m_texture_store;
         TextureCache        m_texture_cache;
         MersenneTwister     m_rng;
         SamplingContext     m_sampling_context;
@@ -194,7 +196,8 @@ TEST_SUITE(Renderer_Kernel_Lighting_Tracer)
         Fixture()
           : m_trace_context(Base::m_scene.ref())
           , m_intersector(m_trace_context)
-          , m_texture_cache(Base::m_scene.ref(), 1024 * 16)
+          , m_texture_store(Base::m_scene.ref(), 1024 * 16)
+          , m_texture_cache(m_texture_store, 1024 * 16)
           , m_sampling_context(m_rng, 0, 0, 0)
           , m_tracer(m_intersector, m_texture_cache)
         {
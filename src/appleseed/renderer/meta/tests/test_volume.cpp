@@ -0,0 +1,207 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/cc.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Volume_Volume)
+{
+    // Same layout as the header of the fluid files read by renderer::read_fluid_file().
+    struct FluidFileHeader
+    {
+        long            m_id;
+        unsigned int    m_xres;
+        unsigned int    m_yres;
+        unsigned int    m_zres;
+        unsigned int    m_has_color;
+        unsigned int    m_has_density;
+        unsigned int    m_has_temperature;
+        unsigned int    m_has_fuel;
+        unsigned int    m_has_falloff;
+        unsigned int    m_has_pressure;
+        unsigned int    m_has_coordinates;
+        unsigned int    m_has_velocity;
+    };
+
+    const char* FluidFilePath = "unit tests/outputs/test_volume_fluid.fld";
+
+    const size_t XRes = 12;
+    const size_t YRes = 10;
+    const size_t ZRes = 20;
+
+    bool is_fluid_present(const size_t x, const size_t y, const size_t z)
+    {
+        // A small cloud in the first brick of a sparse grid, and a single voxel in the last one.
+        return
+            (x >= 2 && x <= 5 && y >= 2 && y <= 5 && z >= 2 && z <= 5) ||
+            (x == XRes - 1 && y == YRes - 1 && z == ZRes - 1);
+    }
+
+    float get_density(const size_t x, const size_t y, const size_t z)
+    {
+        return is_fluid_present(x, y, z) ? 0.5f + x * 0.01f : 0.0f;
+    }
+
+    bool is_stray_color_present(const size_t x, const size_t y, const size_t z)
+    {
+        // A single colored voxel in a brick far away from any density.
+        return x == 0 && y == 0 && z == 12;
+    }
+
+    void write_fluid_file(const bool stray_color)
+    {
+        FluidFileHeader header;
+        header.m_id = CC32('F', 'L', 'D', '3');
+        header.m_xres = XRes;
+        header.m_yres = YRes;
+        header.m_zres = ZRes;
+        header.m_has_color = 1;
+        header.m_has_density = 1;
+        header.m_has_temperature = 0;
+        header.m_has_fuel = 0;
+        header.m_has_falloff = 0;
+        header.m_has_pressure = 0;
+        header.m_has_coordinates = 0;
+        header.m_has_velocity = 0;
+
+        vector<float> color;
+        vector<float> density;
+
+        for (size_t z = 0; z < ZRes; ++z)
+        {
+            for (size_t y = 0; y < YRes; ++y)
+            {
+                for (size_t x = 0; x < XRes; ++x)
+                {
+                    const bool present =
+                        is_fluid_present(x, y, z) ||
+                        (stray_color && is_stray_color_present(x, y, z));
+                    color.push_back(present ? 1.0f : 0.0f);
+                    color.push_back(present ? 0.5f : 0.0f);
+                    color.push_back(present ? 0.25f : 0.0f);
+                    density.push_back(get_density(x, y, z));
+                }
+            }
+        }
+
+        FILE* file = fopen(FluidFilePath, "wb");
+        fwrite(&header, sizeof(FluidFileHeader), 1, file);
+        fwrite(&color[0], sizeof(float), color.size(), file);
+        fwrite(&density[0], sizeof(float), density.size(), file);
+        fclose(file);
+    }
+
+    template <typename Grid>
+    size_t count_mismatches(const Grid& grid, const FluidChannels& channels)
+    {
+        size_t mismatch_count = 0;
+
+        for (size_t z = 0; z < ZRes; ++z)
+        {
+            for (size_t y = 0; y < YRes; ++y)
+            {
+                for (size_t x = 0; x < XRes; ++x)
+                {
+                    const bool present = is_fluid_present(x, y, z);
+                    const float* values = grid.voxel(x, y, z);
+
+                    if (values[channels.m_color_index + 0] != (present ? 1.0f : 0.0f) ||
+                        values[channels.m_color_index + 1] != (present ? 0.5f : 0.0f) ||
+                        values[channels.m_color_index + 2] != (present ? 0.25f : 0.0f) ||
+                        values[channels.m_density_index] != get_density(x, y, z))
+                        ++mismatch_count;
+                }
+            }
+        }
+
+        return mismatch_count;
+    }
+
+    TEST_CASE(ReadFluidFile_ReadsAllChannels)
+    {
+        write_fluid_file(false);
+
+        FluidChannels channels;
+        auto_ptr<VoxelGrid> grid = read_fluid_file(FluidFilePath, channels);
+
+        ASSERT_NEQ(0, grid.get());
+        EXPECT_EQ(4, grid->get_channel_count());
+        EXPECT_EQ(0, channels.m_color_index);
+        EXPECT_EQ(3, channels.m_density_index);
+        EXPECT_EQ(0, count_mismatches(*grid, channels));
+    }
+
+    TEST_CASE(ReadSparseFluidFile_ReadsAllChannels)
+    {
+        write_fluid_file(false);
+
+        FluidChannels channels;
+        auto_ptr<SparseVoxelGrid> grid = read_sparse_fluid_file(FluidFilePath, channels);
+
+        ASSERT_NEQ(0, grid.get());
+        EXPECT_EQ(4, grid->get_channel_count());
+        EXPECT_EQ(0, count_mismatches(*grid, channels));
+    }
+
+    TEST_CASE(ReadSparseFluidFile_AllocatesOnlyBricksContainingFluid)
+    {
+        write_fluid_file(false);
+
+        FluidChannels channels;
+        auto_ptr<SparseVoxelGrid> grid = read_sparse_fluid_file(FluidFilePath, channels);
+
+        ASSERT_NEQ(0, grid.get());
+        EXPECT_EQ(2, grid->get_allocated_brick_count());
+    }
+
+    TEST_CASE(ReadSparseFluidFile_GivenColorAwayFromDensity_IgnoresColor)
+    {
+        write_fluid_file(true);
+
+        FluidChannels channels;
+        auto_ptr<SparseVoxelGrid> grid = read_sparse_fluid_file(FluidFilePath, channels);
+
+        ASSERT_NEQ(0, grid.get());
+        EXPECT_EQ(2, grid->get_allocated_brick_count());
+        EXPECT_EQ(0, count_mismatches(*grid, channels));
+    }
+}
@@ -30,6 +30,7 @@
 #include "wavelengths.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/spectrum.h"
 #include "foundation/math/scalar.h"
 
 using namespace foundation;
@@ -41,7 +42,7 @@ namespace renderer
 // Range of wavelengths used throughout the light simulation.
 //
 
-float g_light_wavelengths[Spectrum::Samples];
+float g_light_wavelengths[Spectrum31f::Samples];
 
 namespace
 {
@@ -49,13 +50,13 @@ namespace
     {
         InitializeLightWavelengths()
         {
-            for (size_t i = 0; i < Spectrum::Samples; ++i)
+            for (size_t i = 0; i < Spectrum31f::Samples; ++i)
             {
                 g_light_wavelengths[i] =
                     fit(
                         static_cast<float>(i),
                         0.0f,
-                        static_cast<float>(Spectrum::Samples - 1),
+                        static_cast<float>(Spectrum31f::Samples - 1),
                         LowWavelength,
                         HighWavelength);
             }
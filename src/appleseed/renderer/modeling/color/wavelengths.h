@@ -41,7 +41,7 @@ namespace renderer
 
 const float LowWavelength  = 400.0f;                    // low wavelength, in nm
 const float HighWavelength = 700.0f;                    // high wavelength, in nm
-extern float g_light_wavelengths[Spectrum::Samples];    // wavelengths, in nm
+extern float g_light_wavelengths[foundation::Spectrum31f::Samples];   // wavelengths, in nm
 
 }       // namespace renderer
 
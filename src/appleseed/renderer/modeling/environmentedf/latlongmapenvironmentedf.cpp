@@ -32,6 +32,7 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/lighting/imageimportancesampler.h"
 #include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/input/inputarray.h"
 #include "renderer/modeling/input/inputevaluator.h"
@@ -359,7 +360,8 @@ namespace
             const size_t texel_count = m_importance_map_width * m_importance_map_height;
             m_probability_scale = texel_count / (2.0 * Pi * Pi);
 
-            TextureCache texture_cache(scene, 1024 * 1024);
+            TextureStore texture_store(scene, 1024 * 1024);
+            TextureCache texture_cache(texture_store, 1024 * 1024);
             ImageSampler sampler(
                 texture_cache,
                 exitance,
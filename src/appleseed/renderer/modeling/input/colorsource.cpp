@@ -74,10 +74,32 @@ namespace
         }
     }
 
+    // Convert a 31-band spectrum to the internal spectrum format.
+    inline void convert_spectrum(
+        const LightingConditions&   lighting,
+        const Spectrum31f&          input,
+        Spectrum31f&                output)
+    {
+        output = input;
+    }
+
+    // Convert a 31-band spectrum to the internal RGB format (RGB rendering mode).
+    inline void convert_spectrum(
+        const LightingConditions&   lighting,
+        const Spectrum31f&          input,
+        RegularSpectrum<float, 3>&  output)
+    {
+        linear_rgb_to_spectrum(
+            lighting,
+            spectrum_to_linear_rgb<float>(lighting, input),
+            output);
+    }
+
     // Convert a set of regularly spaced spectral values to the internal spectrum format.
     Spectrum spectral_values_to_spectrum(
-        const Vector2f&         wavelength_range,
-        const ColorValueArray&  values)
+        const LightingConditions&   lighting,
+        const Vector2f&             wavelength_range,
+        const ColorValueArray&      values)
     {
         assert(wavelength_range[0] <= wavelength_range[1]);
         assert(!values.empty());
@@ -90,14 +112,18 @@ namespace
             wavelengths);
 
         // Resample the spectrum to the internal wavelength range.
-        Spectrum spectrum;
+        Spectrum31f spectrum31;
         spectrum_to_spectrum(
             values.size(),
             &wavelengths[0],
             &values[0],
-            Spectrum::Samples,
+            Spectrum31f::Samples,
             g_light_wavelengths,
-            &spectrum[0]);
+            &spectrum31[0]);
+
+        // Convert the resampled spectrum to the internal color representation.
+        Spectrum spectrum;
+        convert_spectrum(lighting, spectrum31, spectrum);
 
         return spectrum;
     }
@@ -120,6 +146,7 @@ ColorSource::ColorSource(const ColorEntity& color_entity)
             m_scalar = static_cast<double>(values[0]);
             m_spectrum =
                 spectral_values_to_spectrum(
+                    m_lighting_conditions,
                     color_entity.get_wavelength_range(),
                     values);
         }
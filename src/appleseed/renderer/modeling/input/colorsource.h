@@ -87,10 +87,9 @@ inline void ColorSource::evaluate_uniform(
     Alpha&                  alpha)
 {
     linear_rgb =
-        foundation::ciexyz_to_linear_rgb(
-            foundation::spectrum_to_ciexyz<float>(
-                m_lighting_conditions,
-                m_spectrum));
+        foundation::spectrum_to_linear_rgb<float>(
+            m_lighting_conditions,
+            m_spectrum);
     alpha = m_alpha;
 }
 
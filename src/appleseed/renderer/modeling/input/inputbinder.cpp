@@ -531,7 +531,7 @@ void InputBinder::bind_texture_instance_to_input(
             new TextureSource(
                 assembly_uid,
                 *texture_instance,
-                texture->properties()));
+                *texture));
     }
     catch (const exception& e)
     {
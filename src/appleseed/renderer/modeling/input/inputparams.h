@@ -43,11 +43,27 @@ class InputParams
 {
   public:
     foundation::Vector2d    m_uv;                   // UV coordinates
+    foundation::Vector2d    m_duvdx;                // UV footprint along the first screen axis, 0 if unknown
+    foundation::Vector2d    m_duvdy;                // UV footprint along the second screen axis, 0 if unknown
     foundation::Vector3d    m_point;                // world space point
     foundation::Vector3d    m_geometric_normal;     // world space geometric normal, unit-length
     foundation::Vector3d    m_shading_normal;       // world space shading normal, unit-length
+
+    // Constructor, sets the UV footprint to 0 and leaves all other fields uninitialized.
+    InputParams();
 };
 
+
+//
+// InputParams class implementation.
+//
+
+inline InputParams::InputParams()
+  : m_duvdx(0.0)
+  , m_duvdy(0.0)
+{
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_MODELING_INPUT_INPUTPARAMS_H
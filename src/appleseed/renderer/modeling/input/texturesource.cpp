@@ -33,10 +33,17 @@
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/modeling/input/inputparams.h"
 #include "renderer/modeling/scene/textureinstance.h"
+#include "renderer/modeling/texture/texture.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/hash.h"
 #include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 
 using namespace foundation;
 using namespace std;
@@ -130,11 +137,70 @@ namespace
                 static_cast<size_t>(iy));
     }
 
+    // Apply an addressing mode to an (integer) pixel coordinate arbitrarily far from the canvas.
+    inline size_t constrain_to_canvas(
+        const TextureAddressingMode addressing_mode,
+        const size_t                canvas_size,
+        const int                   i)
+    {
+        const int size = static_cast<int>(canvas_size);
+
+        switch (addressing_mode)
+        {
+          case TextureAddressingClamp:
+            return static_cast<size_t>(clamp(i, 0, size - 1));
+
+          case TextureAddressingWrap:
+            {
+                const int m = i % size;
+                return static_cast<size_t>(m < 0 ? m + size : m);
+            }
+
+          default:
+            assert(!"Wrong texture addressing mode.");
+            return 0;
+        }
+    }
+
+    // Gaussian weights of the EWA filter, indexed by the squared radius in the unit ellipse.
+    // Reference: http://www.cs.cmu.edu/~ph/texfund/texfund.pdf
+    class EWAWeights
+    {
+      public:
+        enum { WeightCount = 256 };
+
+        EWAWeights()
+        {
+            const float Alpha = 2.0f;
+
+            for (size_t i = 0; i < WeightCount; ++i)
+            {
+                const float r2 = static_cast<float>(i) / (WeightCount - 1);
+                m_weights[i] = exp(-Alpha * r2) - exp(-Alpha);
+            }
+        }
+
+        float operator()(const double r2) const
+        {
+            assert(r2 >= 0.0);
+            return m_weights[min(truncate<size_t>(r2 * WeightCount), size_t(WeightCount - 1))];
+        }
+
+      private:
+        float m_weights[WeightCount];
+    };
+
+    const EWAWeights g_ewa_weights;
+
+    // Maximum ratio between the major and the minor axes of the EWA filter.
+    const double EWAMaxAnisotropy = 16.0;
+
     // Utility function to sample a tile.
     inline void sample_tile(
         TextureCache&           texture_cache,
         const UniqueID          assembly_uid,
         const size_t            texture_index,
+        const size_t            level,
         const size_t            tile_x,
         const size_t            tile_y,
         const size_t            pixel_x,
@@ -146,6 +212,7 @@ namespace
             texture_cache.get(
                 assembly_uid,
                 texture_index,
+                level,
                 tile_x,
                 tile_y);
 
@@ -163,10 +230,19 @@ namespace
     }
 }
 
+TextureSource::Level::Level(const CanvasProperties& props)
+  : m_props(props)
+  , m_scalar_canvas_width(static_cast<double>(props.m_canvas_width))
+  , m_scalar_canvas_height(static_cast<double>(props.m_canvas_height))
+  , m_max_x(static_cast<double>(props.m_canvas_width - 1))
+  , m_max_y(static_cast<double>(props.m_canvas_height - 1))
+{
+}
+
 TextureSource::TextureSource(
     const UniqueID              assembly_uid,
     const TextureInstance&      texture_instance,
-    const CanvasProperties&     texture_props)
+    Texture&                    texture)
   : Source(false)
   , m_assembly_uid(assembly_uid)
   , m_texture_index(texture_instance.get_texture_index())
@@ -176,29 +252,37 @@ TextureSource::TextureSource(
   , m_lighting_conditions(      // todo: this should be user-settable
         IlluminantCIED65,
         XYZCMFCIE196410Deg)
-  , m_texture_props(texture_props)
-  , m_scalar_canvas_width(static_cast<double>(texture_props.m_canvas_width))
-  , m_scalar_canvas_height(static_cast<double>(texture_props.m_canvas_height))
-  , m_max_x(static_cast<double>(texture_props.m_canvas_width - 1))
-  , m_max_y(static_cast<double>(texture_props.m_canvas_height - 1))
 {
+    const bool mipmapped =
+        m_filtering_mode == TextureFilteringTrilinear ||
+        m_filtering_mode == TextureFilteringEWA;
+
+    const size_t level_count = mipmapped ? texture.get_level_count() : 1;
+
+    m_levels.reserve(level_count);
+
+    for (size_t i = 0; i < level_count; ++i)
+        m_levels.push_back(Level(texture.get_level_properties(i)));
 }
 
 Color4f TextureSource::get_texel(
     TextureCache&               texture_cache,
+    const size_t                level,
     const size_t                ix,
     const size_t                iy) const
 {
-    assert(ix >= 0);
-    assert(iy >= 0);
-    assert(ix < m_texture_props.m_canvas_width);
-    assert(iy < m_texture_props.m_canvas_height);
+    assert(level < m_levels.size());
+
+    const CanvasProperties& props = m_levels[level].m_props;
+
+    assert(ix < props.m_canvas_width);
+    assert(iy < props.m_canvas_height);
 
     // Compute the coordinates of the tile containing the texel (x, y).
-    const size_t tile_x = truncate<size_t>(ix * m_texture_props.m_rcp_tile_width);
-    const size_t tile_y = truncate<size_t>(iy * m_texture_props.m_rcp_tile_height);
-    assert(tile_x < m_texture_props.m_tile_count_x);
-    assert(tile_y < m_texture_props.m_tile_count_y);
+    const size_t tile_x = truncate<size_t>(ix * props.m_rcp_tile_width);
+    const size_t tile_y = truncate<size_t>(iy * props.m_rcp_tile_height);
+    assert(tile_x < props.m_tile_count_x);
+    assert(tile_y < props.m_tile_count_y);
 
 #ifdef DEBUG_DISPLAY_TEXTURE_TILES
 
@@ -213,10 +297,10 @@ Color4f TextureSource::get_texel(
 #endif
 
     // Compute the tile space coordinates of the texel (x, y).
-    const size_t pixel_x = ix - tile_x * m_texture_props.m_tile_width;
-    const size_t pixel_y = iy - tile_y * m_texture_props.m_tile_height;
-    assert(pixel_x < m_texture_props.m_tile_width);
-    assert(pixel_y < m_texture_props.m_tile_height);
+    const size_t pixel_x = ix - tile_x * props.m_tile_width;
+    const size_t pixel_y = iy - tile_y * props.m_tile_height;
+    assert(pixel_x < props.m_tile_width);
+    assert(pixel_y < props.m_tile_height);
 
     // Sample the tile.
     Color4f sample;
@@ -224,6 +308,7 @@ Color4f TextureSource::get_texel(
         texture_cache,
         m_assembly_uid,
         m_texture_index,
+        level,
         tile_x,
         tile_y,
         pixel_x,
@@ -235,6 +320,7 @@ Color4f TextureSource::get_texel(
 
 void TextureSource::get_texels_2x2(
     TextureCache&               texture_cache,
+    const size_t                level,
     const int                   ix,
     const int                   iy,
     Color4f&                    t00,
@@ -242,19 +328,23 @@ void TextureSource::get_texels_2x2(
     Color4f&                    t01,
     Color4f&                    t11) const
 {
+    assert(level < m_levels.size());
+
+    const CanvasProperties& props = m_levels[level].m_props;
+
     const Vector<size_t, 2> p00 =
         constrain_to_canvas(
             m_addressing_mode,
-            m_texture_props.m_canvas_width,
-            m_texture_props.m_canvas_height,
+            props.m_canvas_width,
+            props.m_canvas_height,
             ix + 0,
             iy + 0);
 
     const Vector<size_t, 2> p11 =
         constrain_to_canvas(
             m_addressing_mode,
-            m_texture_props.m_canvas_width,
-            m_texture_props.m_canvas_height,
+            props.m_canvas_width,
+            props.m_canvas_height,
             ix + 1,
             iy + 1);
 
@@ -262,10 +352,10 @@ void TextureSource::get_texels_2x2(
     const Vector<size_t, 2> p01(p00.x, p11.y);
 
     // Compute the coordinates of the tile containing each texel.
-    const size_t tile_x_00 = truncate<size_t>(p00.x * m_texture_props.m_rcp_tile_width);
-    const size_t tile_y_00 = truncate<size_t>(p00.y * m_texture_props.m_rcp_tile_height);
-    const size_t tile_x_11 = truncate<size_t>(p11.x * m_texture_props.m_rcp_tile_width);
-    const size_t tile_y_11 = truncate<size_t>(p11.y * m_texture_props.m_rcp_tile_height);
+    const size_t tile_x_00 = truncate<size_t>(p00.x * props.m_rcp_tile_width);
+    const size_t tile_y_00 = truncate<size_t>(p00.y * props.m_rcp_tile_height);
+    const size_t tile_x_11 = truncate<size_t>(p11.x * props.m_rcp_tile_width);
+    const size_t tile_y_11 = truncate<size_t>(p11.y * props.m_rcp_tile_height);
 
     // Check whether all four texels are part of the same tile.
     const size_t tile_x_mask = tile_x_00 ^ tile_x_11;
@@ -274,16 +364,17 @@ void TextureSource::get_texels_2x2(
     if (tile_x_mask | tile_y_mask)
     {
         // Compute the tile space coordinates of each texel.
-        const size_t pixel_x_00 = p00.x - tile_x_00 * m_texture_props.m_tile_width;
-        const size_t pixel_y_00 = p00.y - tile_y_00 * m_texture_props.m_tile_height;
-        const size_t pixel_x_11 = p11.x - tile_x_11 * m_texture_props.m_tile_width;
-        const size_t pixel_y_11 = p11.y - tile_y_11 * m_texture_props.m_tile_height;
+        const size_t pixel_x_00 = p00.x - tile_x_00 * props.m_tile_width;
+        const size_t pixel_y_00 = p00.y - tile_y_00 * props.m_tile_height;
+        const size_t pixel_x_11 = p11.x - tile_x_11 * props.m_tile_width;
+        const size_t pixel_y_11 = p11.y - tile_y_11 * props.m_tile_height;
 
         // Sample the tile.
         sample_tile(
             texture_cache,
             m_assembly_uid,
             m_texture_index,
+            level,
             tile_x_00,
             tile_y_00,
             pixel_x_00,
@@ -293,6 +384,7 @@ void TextureSource::get_texels_2x2(
             texture_cache,
             m_assembly_uid,
             m_texture_index,
+            level,
             tile_x_11,
             tile_y_00,
             pixel_x_11,
@@ -302,6 +394,7 @@ void TextureSource::get_texels_2x2(
             texture_cache,
             m_assembly_uid,
             m_texture_index,
+            level,
             tile_x_00,
             tile_y_11,
             pixel_x_00,
@@ -311,6 +404,7 @@ void TextureSource::get_texels_2x2(
             texture_cache,
             m_assembly_uid,
             m_texture_index,
+            level,
             tile_x_11,
             tile_y_11,
             pixel_x_11,
@@ -320,8 +414,8 @@ void TextureSource::get_texels_2x2(
     else
     {
         // Compute the tile space coordinates of each texel.
-        const size_t org_x = tile_x_00 * m_texture_props.m_tile_width;
-        const size_t org_y = tile_y_00 * m_texture_props.m_tile_height;
+        const size_t org_x = tile_x_00 * props.m_tile_width;
+        const size_t org_y = tile_y_00 * props.m_tile_height;
         const size_t pixel_x_00 = p00.x - org_x;
         const size_t pixel_y_00 = p00.y - org_y;
         const size_t pixel_x_11 = p11.x - org_x;
@@ -332,6 +426,7 @@ void TextureSource::get_texels_2x2(
             texture_cache.get(
                 m_assembly_uid,
                 m_texture_index,
+                level,
                 tile_x_00,
                 tile_y_00);
 
@@ -374,6 +469,204 @@ void TextureSource::get_texels_2x2(
     }
 }
 
+Color4f TextureSource::sample_bilinear(
+    TextureCache&               texture_cache,
+    const size_t                level,
+    const Vector2d&             p) const
+{
+    assert(level < m_levels.size());
+
+    const Level& lv = m_levels[level];
+
+    const double x = p.x * lv.m_max_x;
+    const double y = p.y * lv.m_max_y;
+
+    const int ix = truncate<int>(x);
+    const int iy = truncate<int>(y);
+
+    // Retrieve the four surrounding texels.
+    Color4f t00, t10, t01, t11;
+    get_texels_2x2(
+        texture_cache,
+        level,
+        ix, iy,
+        t00, t10, t01, t11);
+
+    // Compute weights.
+    const float wx1 = static_cast<float>(x - ix);
+    const float wy1 = static_cast<float>(y - iy);
+    const float wx0 = 1.0f - wx1;
+    const float wy0 = 1.0f - wy1;
+
+    // Apply weights.
+    t00 *= wx0 * wy0;
+    t10 *= wx1 * wy0;
+    t01 *= wx0 * wy1;
+    t11 *= wx1 * wy1;
+
+    // Accumulate.
+    t00 += t10;
+    t00 += t01;
+    t00 += t11;
+
+    return t00;
+}
+
+Color4f TextureSource::sample_trilinear(
+    TextureCache&               texture_cache,
+    const Vector2d&             p,
+    const Vector2d&             dpdx,
+    const Vector2d&             dpdy) const
+{
+    const Level& base = m_levels[0];
+    const size_t last_level = m_levels.size() - 1;
+
+    // Compute the width of the footprint in texels of level 0.
+    const double width =
+        max(
+            norm(Vector2d(dpdx.x * base.m_scalar_canvas_width, dpdx.y * base.m_scalar_canvas_height)),
+            norm(Vector2d(dpdy.x * base.m_scalar_canvas_width, dpdy.y * base.m_scalar_canvas_height)));
+
+    // Magnification or unknown footprint: sample level 0.
+    if (width <= 1.0)
+        return sample_bilinear(texture_cache, 0, p);
+
+    // Select the two levels bracketing the footprint.
+    const double lod = min(log2(width), static_cast<double>(last_level));
+    const size_t level = truncate<size_t>(lod);
+
+    if (level >= last_level)
+        return sample_bilinear(texture_cache, last_level, p);
+
+    const Color4f c0 = sample_bilinear(texture_cache, level, p);
+    const Color4f c1 = sample_bilinear(texture_cache, level + 1, p);
+
+    return lerp(c0, c1, static_cast<float>(lod - level));
+}
+
+Color4f TextureSource::sample_ewa(
+    TextureCache&               texture_cache,
+    const size_t                level,
+    const Vector2d&             p,
+    const Vector2d&             axis0,
+    const Vector2d&             axis1) const
+{
+    assert(level < m_levels.size());
+
+    const Level& lv = m_levels[level];
+
+    // Express the ellipse in the texel space of this level, texel centers being at integer coordinates.
+    const double cx = p.x * lv.m_scalar_canvas_width - 0.5;
+    const double cy = p.y * lv.m_scalar_canvas_height - 0.5;
+    const double ax = axis0.x * lv.m_scalar_canvas_width;
+    const double ay = axis0.y * lv.m_scalar_canvas_height;
+    const double bx = axis1.x * lv.m_scalar_canvas_width;
+    const double by = axis1.y * lv.m_scalar_canvas_height;
+
+    // Compute the coefficients of the implicit ellipse A*x^2 + B*x*y + C*y^2 = 1.
+    // The ellipse is enlarged by one texel so that it always contains texel centers.
+    double A = ay * ay + by * by + 1.0;
+    double B = -2.0 * (ax * ay + bx * by);
+    double C = ax * ax + bx * bx + 1.0;
+    const double rcp_F = 1.0 / (A * C - 0.25 * B * B);
+    A *= rcp_F;
+    B *= rcp_F;
+    C *= rcp_F;
+
+    // Compute the bounding box of the ellipse.
+    const double det = 4.0 * A * C - B * B;
+    const double rcp_det = 1.0 / det;
+    const double extent_x = 2.0 * rcp_det * sqrt(det * C);
+    const double extent_y = 2.0 * rcp_det * sqrt(det * A);
+    const int x0 = static_cast<int>(ceil(cx - extent_x));
+    const int x1 = static_cast<int>(floor(cx + extent_x));
+    const int y0 = static_cast<int>(ceil(cy - extent_y));
+    const int y1 = static_cast<int>(floor(cy + extent_y));
+
+    // Accumulate the texels inside the ellipse.
+    Color4f sum(0.0f);
+    float weight_sum = 0.0f;
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        const double dy = y - cy;
+        const size_t iy = constrain_to_canvas(m_addressing_mode, lv.m_props.m_canvas_height, y);
+
+        for (int x = x0; x <= x1; ++x)
+        {
+            const double dx = x - cx;
+            const double r2 = A * dx * dx + B * dx * dy + C * dy * dy;
+
+            if (r2 < 1.0)
+            {
+                const size_t ix = constrain_to_canvas(m_addressing_mode, lv.m_props.m_canvas_width, x);
+                const float weight = g_ewa_weights(r2);
+                sum += weight * get_texel(texture_cache, level, ix, iy);
+                weight_sum += weight;
+            }
+        }
+    }
+
+    return
+        weight_sum > 0.0f
+            ? sum / weight_sum
+            : sample_bilinear(texture_cache, level, p);
+}
+
+Color4f TextureSource::sample_ewa(
+    TextureCache&               texture_cache,
+    const Vector2d&             p,
+    const Vector2d&             dpdx,
+    const Vector2d&             dpdy) const
+{
+    const Level& base = m_levels[0];
+    const size_t last_level = m_levels.size() - 1;
+
+    // Express the axes of the footprint in texels of level 0.
+    Vector2d major(dpdx.x * base.m_scalar_canvas_width, dpdx.y * base.m_scalar_canvas_height);
+    Vector2d minor(dpdy.x * base.m_scalar_canvas_width, dpdy.y * base.m_scalar_canvas_height);
+    double major_length = norm(major);
+    double minor_length = norm(minor);
+
+    if (major_length < minor_length)
+    {
+        swap(major, minor);
+        swap(major_length, minor_length);
+    }
+
+    // Magnification or unknown footprint: sample level 0.
+    if (major_length <= 1.0)
+        return sample_bilinear(texture_cache, 0, p);
+
+    // Bound the eccentricity of the ellipse, hence the number of texels it covers,
+    // by widening its minor axis.
+    const double min_minor_length = major_length / EWAMaxAnisotropy;
+    if (minor_length < min_minor_length)
+    {
+        minor =
+            minor_length > 0.0
+                ? minor * (min_minor_length / minor_length)
+                : Vector2d(-major.y, major.x) * (min_minor_length / major_length);
+        minor_length = min_minor_length;
+    }
+
+    // Express the axes of the footprint in texture space.
+    const Vector2d axis0(major.x / base.m_scalar_canvas_width, major.y / base.m_scalar_canvas_height);
+    const Vector2d axis1(minor.x / base.m_scalar_canvas_width, minor.y / base.m_scalar_canvas_height);
+
+    // Select the two levels in which the minor axis spans about one texel.
+    const double lod = clamp(log2(minor_length), 0.0, static_cast<double>(last_level));
+    const size_t level = truncate<size_t>(lod);
+
+    if (level >= last_level)
+        return sample_ewa(texture_cache, last_level, p, axis0, axis1);
+
+    const Color4f c0 = sample_ewa(texture_cache, level, p, axis0, axis1);
+    const Color4f c1 = sample_ewa(texture_cache, level + 1, p, axis0, axis1);
+
+    return lerp(c0, c1, static_cast<float>(lod - level));
+}
+
 Color4f TextureSource::sample_texture(
     TextureCache&               texture_cache,
     const InputParams&          params) const
@@ -389,49 +682,35 @@ Color4f TextureSource::sample_texture(
     {
       case TextureFilteringNearest:
         {
-            p.x = clamp(p.x * m_scalar_canvas_width, 0.0, m_max_x);
-            p.y = clamp(p.y * m_scalar_canvas_height, 0.0, m_max_y);
+            const Level& base = m_levels[0];
+
+            p.x = clamp(p.x * base.m_scalar_canvas_width, 0.0, base.m_max_x);
+            p.y = clamp(p.y * base.m_scalar_canvas_height, 0.0, base.m_max_y);
 
             const size_t ix = truncate<size_t>(p.x);
             const size_t iy = truncate<size_t>(p.y);
 
-            return get_texel(texture_cache, ix, iy);
+            return get_texel(texture_cache, 0, ix, iy);
         }
 
       case TextureFilteringBilinear:
-        {
-            p.x *= m_max_x;
-            p.y *= m_max_y;
+        return sample_bilinear(texture_cache, 0, p);
 
-            const int ix = truncate<int>(p.x);
-            const int iy = truncate<int>(p.y);
+      case TextureFilteringTrilinear:
+        return
+            sample_trilinear(
+                texture_cache,
+                p,
+                Vector2d(params.m_duvdx.x, -params.m_duvdx.y),
+                Vector2d(params.m_duvdy.x, -params.m_duvdy.y));
 
-            // Retrieve the four surrounding texels.
-            Color4f t00, t10, t01, t11;
-            get_texels_2x2(
+      case TextureFilteringEWA:
+        return
+            sample_ewa(
                 texture_cache,
-                ix, iy,
-                t00, t10, t01, t11);
-
-            // Compute weights.
-            const float wx1 = static_cast<float>(p.x - ix);
-            const float wy1 = static_cast<float>(p.y - iy);
-            const float wx0 = 1.0f - wx1;
-            const float wy0 = 1.0f - wy1;
-
-            // Apply weights.
-            t00 *= wx0 * wy0;
-            t10 *= wx1 * wy0;
-            t01 *= wx0 * wy1;
-            t11 *= wx1 * wy1;
-
-            // Accumulate.
-            t00 += t10;
-            t00 += t01;
-            t00 += t11;
-
-            return t00;
-        }
+                p,
+                Vector2d(params.m_duvdx.x, -params.m_duvdx.y),
+                Vector2d(params.m_duvdy.x, -params.m_duvdy.y));
 
       default:
         assert(!"Wrong texture filtering mode.");
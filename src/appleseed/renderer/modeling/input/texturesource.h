@@ -38,8 +38,13 @@
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/colorspace.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 // Forward declarations.
 namespace renderer      { class InputParams; }
+namespace renderer      { class Texture; }
 namespace renderer      { class TextureCache; }
 namespace renderer      { class TextureInstance; }
 
@@ -58,7 +63,7 @@ class TextureSource
     TextureSource(
         const foundation::UniqueID          assembly_uid,
         const TextureInstance&              texture_instance,
-        const foundation::CanvasProperties& texture_props);
+        Texture&                            texture);
 
     // Evaluate the source at a given shading point.
     virtual void evaluate(
@@ -77,27 +82,36 @@ class TextureSource
         Alpha&                              alpha);
 
   private:
+    struct Level
+    {
+        foundation::CanvasProperties        m_props;
+        double                              m_scalar_canvas_width;
+        double                              m_scalar_canvas_height;
+        double                              m_max_x;
+        double                              m_max_y;
+
+        explicit Level(const foundation::CanvasProperties& props);
+    };
+
     const foundation::UniqueID              m_assembly_uid;
     const size_t                            m_texture_index;
     const TextureAddressingMode             m_addressing_mode;
     const TextureFilteringMode              m_filtering_mode;
     const float                             m_multiplier;
     const foundation::LightingConditions    m_lighting_conditions;
-    const foundation::CanvasProperties      m_texture_props;
-    const double                            m_scalar_canvas_width;
-    const double                            m_scalar_canvas_height;
-    const double                            m_max_x;
-    const double                            m_max_y;
+    std::vector<Level>                      m_levels;           // levels of the mipmap pyramid, only level 0 without mipmapping
 
-    // Retrieve a given texel. Return a color in the linear RGB color space.
+    // Retrieve a given texel of a given level. Return a color in the linear RGB color space.
     foundation::Color4f get_texel(
         TextureCache&                       texture_cache,
+        const size_t                        level,
         const size_t                        ix,
         const size_t                        iy) const;
 
-    // Retrieve a 2x2 block of texels. Texels are expressed in the linear RGB color space.
+    // Retrieve a 2x2 block of texels of a given level. Texels are expressed in the linear RGB color space.
     void get_texels_2x2(
         TextureCache&                       texture_cache,
+        const size_t                        level,
         const int                           ix,
         const int                           iy,
         foundation::Color4f&                t00,
@@ -105,6 +119,34 @@ class TextureSource
         foundation::Color4f&                t01,
         foundation::Color4f&                t11) const;
 
+    // Sample a given level with a bilinear filter. Return a color in the linear RGB color space.
+    foundation::Color4f sample_bilinear(
+        TextureCache&                       texture_cache,
+        const size_t                        level,
+        const foundation::Vector2d&         p) const;
+
+    // Sample the mipmap pyramid with a trilinear filter. Return a color in the linear RGB color space.
+    foundation::Color4f sample_trilinear(
+        TextureCache&                       texture_cache,
+        const foundation::Vector2d&         p,
+        const foundation::Vector2d&         dpdx,
+        const foundation::Vector2d&         dpdy) const;
+
+    // Sample a given level with an EWA filter whose ellipse axes are expressed in texture space.
+    foundation::Color4f sample_ewa(
+        TextureCache&                       texture_cache,
+        const size_t                        level,
+        const foundation::Vector2d&         p,
+        const foundation::Vector2d&         axis0,
+        const foundation::Vector2d&         axis1) const;
+
+    // Sample the mipmap pyramid with an EWA filter. Return a color in the linear RGB color space.
+    foundation::Color4f sample_ewa(
+        TextureCache&                       texture_cache,
+        const foundation::Vector2d&         p,
+        const foundation::Vector2d&         dpdx,
+        const foundation::Vector2d&         dpdy) const;
+
     // Sample the texture. Return a color in the linear RGB color space.
     foundation::Color4f sample_texture(
         TextureCache&                       texture_cache,
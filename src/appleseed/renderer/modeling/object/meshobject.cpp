@@ -36,10 +36,18 @@
 #include "renderer/modeling/object/triangle.h"
 
 // appleseed.foundation headers.
+#include "foundation/mesh/binarymeshfile.h"
 #include "foundation/utility/attributeset.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/numerictype.h"
 
+// boost headers.
+#include "boost/static_assert.hpp"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
 using namespace foundation;
 using namespace std;
 
@@ -96,6 +104,8 @@ struct MeshObject::Impl
 
     AttributeSet::ChannelID     m_uv0_channel_id;
 
+    boost::shared_ptr<const BinaryMeshFile> m_binary_mesh_file;
+
     Impl()
       : m_region(&m_bbox, &m_tess)
       , m_lazy_region_kit(&m_region_kit)
@@ -253,6 +263,64 @@ const Triangle& MeshObject::get_triangle(const size_t index) const
     return impl->m_tess.m_primitives[index];
 }
 
+void MeshObject::map_binary_mesh(
+    const boost::shared_ptr<const BinaryMeshFile>&  file,
+    const size_t                                    mesh_index)
+{
+    assert(file.get());
+    assert(impl->m_tess.m_vertices.empty());
+    assert(impl->m_tess.m_vertex_normals.empty());
+    assert(impl->m_tess.m_primitives.empty());
+
+    const BinaryMeshFile::Mesh& mesh = file->get_mesh(mesh_index);
+
+    // BinaryMeshFile::open() checked that all face indices, including vertex normal indices, are valid.
+    assert(mesh.m_flags & BinaryMeshFile::AllFacesHaveNormals);
+
+    // Vertices.
+    if (mesh.m_vertex_encoding == BinaryMeshFile::VertexFloat32)
+    {
+        impl->m_tess.m_vertices.map(static_cast<const GVector3*>(mesh.m_vertices), mesh.m_vertex_count);
+        impl->m_bbox = GAABB3(mesh.m_bbox);
+    }
+    else
+    {
+        impl->m_tess.m_vertices.reserve(mesh.m_vertex_count);
+        for (size_t i = 0; i < mesh.m_vertex_count; ++i)
+            push_vertex(GVector3(mesh.get_vertex(i)));
+    }
+
+    // Vertex normals.
+    if (mesh.m_vertex_normal_encoding == BinaryMeshFile::NormalFloat32)
+    {
+        impl->m_tess.m_vertex_normals.map(
+            static_cast<const GVector3*>(mesh.m_vertex_normals),
+            mesh.m_vertex_normal_count);
+    }
+    else
+    {
+        impl->m_tess.m_vertex_normals.reserve(mesh.m_vertex_normal_count);
+        for (size_t i = 0; i < mesh.m_vertex_normal_count; ++i)
+            push_vertex_normal(GVector3(mesh.get_vertex_normal(i)));
+    }
+
+    // Texture coordinates are stored in the attribute set and cannot be mapped.
+    for (size_t i = 0; i < mesh.m_tex_coords_count; ++i)
+        push_tex_coords(GVector2(mesh.m_tex_coords[i]));
+
+    // Triangles share the layout of binary mesh file faces.
+    BOOST_STATIC_ASSERT(sizeof(Triangle) == sizeof(BinaryMeshFile::Face));
+    BOOST_STATIC_ASSERT(offsetof(Triangle, m_v0) == offsetof(BinaryMeshFile::Face, m_v0));
+    BOOST_STATIC_ASSERT(offsetof(Triangle, m_n0) == offsetof(BinaryMeshFile::Face, m_n0));
+    BOOST_STATIC_ASSERT(offsetof(Triangle, m_a0) == offsetof(BinaryMeshFile::Face, m_t0));
+    BOOST_STATIC_ASSERT(offsetof(Triangle, m_pa) == offsetof(BinaryMeshFile::Face, m_material));
+    impl->m_tess.m_primitives.map(
+        reinterpret_cast<const Triangle*>(mesh.m_faces),
+        mesh.m_face_count);
+
+    impl->m_binary_mesh_file = file;
+}
+
 
 //
 // MeshObjectFactory class implementation.
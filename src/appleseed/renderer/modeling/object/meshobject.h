@@ -33,7 +33,14 @@
 #include "renderer/global/global.h"
 #include "renderer/modeling/object/object.h"
 
+// boost headers.
+#include "boost/shared_ptr.hpp"
+
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
+namespace foundation    { class BinaryMeshFile; }
 namespace renderer      { class Triangle; }
 
 namespace renderer
@@ -85,6 +92,16 @@ class RENDERERDLL MeshObject
     size_t get_triangle_count() const;
     const Triangle& get_triangle(const size_t index) const;
 
+    // Use the geometry of a given mesh of an open binary mesh file in place instead of
+    // copying it. Vertices, vertex normals and triangles stored uncompressed are used
+    // directly from the mapped file; quantized data is decoded. The mesh must not use
+    // materials other than 0, and all its faces must have vertex normals. The file is
+    // shared by all the objects using its meshes and stays mapped as long as one of
+    // them exists. This method must be called on an empty object.
+    void map_binary_mesh(
+        const boost::shared_ptr<const foundation::BinaryMeshFile>&  file,
+        const size_t                                                mesh_index);
+
   private:
     friend class MeshObjectFactory;
 
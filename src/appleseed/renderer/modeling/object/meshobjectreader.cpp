@@ -36,6 +36,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionioerror.h"
 #include "foundation/math/triangulator.h"
+#include "foundation/mesh/binarymeshfile.h"
 #include "foundation/mesh/genericmeshfilereader.h"
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/imeshfilereader.h"
@@ -45,10 +46,16 @@
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// boost headers.
+#include "boost/filesystem/path.hpp"
+#include "boost/shared_ptr.hpp"
+
 // Standard headers.
 #include <exception>
+#include <string>
 #include <vector>
 
+using namespace boost;
 using namespace foundation;
 using namespace std;
 
@@ -309,6 +316,81 @@ namespace
             m_objects.back()->push_triangle(triangle);
         }
     };
+
+    // Return true if a mesh from a binary mesh file can be used in place by a mesh object
+    // and would yield the same object as the one built by MeshObjectBuilder.
+    bool is_mappable(
+        const BinaryMeshFile::Mesh& mesh,
+        const bool                  ignore_vertex_normals)
+    {
+        if (ignore_vertex_normals)
+            return false;
+
+        if (!(mesh.m_flags & BinaryMeshFile::AllFacesHaveNormals))
+            return false;
+
+        // MeshObjectBuilder assigns material 0 to all triangles.
+        for (size_t i = 0; i < mesh.m_face_count; ++i)
+        {
+            if (mesh.m_faces[i].m_material != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Create mesh objects that use the geometry of a binary mesh file in place.
+    // Return false if the file cannot be used in place, in which case it must be
+    // read with a mesh builder.
+    bool map_binary_mesh_file(
+        const char*                 filename,
+        const char*                 base_object_name,
+        const ParamArray&           params,
+        vector<MeshObject*>&        objects)
+    {
+        // The file is mapped once and shared by all the objects created from it.
+        boost::shared_ptr<BinaryMeshFile> file(new BinaryMeshFile());
+        file->open(filename);
+
+        const bool ignore_vertex_normals = params.get_optional<bool>("ignore_vertex_normals");
+        const size_t mesh_count = file->get_mesh_count();
+
+        for (size_t i = 0; i < mesh_count; ++i)
+        {
+            if (!is_mappable(file->get_mesh(i), ignore_vertex_normals))
+                return false;
+        }
+
+        size_t untitled_mesh_counter = 0;
+
+        for (size_t i = 0; i < mesh_count; ++i)
+        {
+            const BinaryMeshFile::Mesh& mesh = file->get_mesh(i);
+
+            // If the mesh has no name, assign it a number (starting with 0).
+            const string mesh_name = mesh.m_name.empty() ? to_string(untitled_mesh_counter++) : mesh.m_name;
+
+            // Construct the final object name from the base object name and the mesh name.
+            const string object_name = string(base_object_name) + "." + mesh_name;
+
+            MeshObject* object = MeshObjectFactory::create(object_name.c_str(), params).release();
+            object->map_binary_mesh(file, i);
+            objects.push_back(object);
+
+            // Print the number of vertices and triangles in the mesh.
+            const size_t vertex_count = object->get_vertex_count();
+            const size_t triangle_count = object->get_triangle_count();
+            RENDERER_LOG_INFO(
+                "mapped mesh object \"%s\" (%s %s, %s %s).",
+                object->get_name(),
+                pretty_int(vertex_count).c_str(),
+                plural(vertex_count, "vertex", "vertices").c_str(),
+                pretty_int(triangle_count).c_str(),
+                plural(triangle_count, "triangle").c_str());
+        }
+
+        return true;
+    }
 }
 
 MeshObjectArray MeshObjectReader::read(
@@ -321,13 +403,21 @@ MeshObjectArray MeshObjectReader::read(
 
     GenericMeshFileReader reader;
     MeshObjectBuilder builder(params, base_object_name);
+    vector<MeshObject*> mapped_objects;
 
     Stopwatch<DefaultWallclockTimer> stopwatch;
     stopwatch.start();
 
     try
     {
-        reader.read(filename, builder);
+        // Binary mesh files are used in place whenever possible.
+        const filesystem::path filepath(filename);
+        const bool mapped =
+            lower_case(filepath.extension()) == BinaryMeshFile::Extension &&
+            map_binary_mesh_file(filename, base_object_name, params, mapped_objects);
+
+        if (!mapped)
+            reader.read(filename, builder);
     }
     catch (const OBJMeshFileReader::ExceptionInvalidFaceDef& e)
     {
@@ -352,7 +442,7 @@ MeshObjectArray MeshObjectReader::read(
             filename);
         return MeshObjectArray();
     }
-    catch (const exception& e)
+    catch (const std::exception& e)
     {
         RENDERER_LOG_ERROR(
             "failed to load mesh file %s: %s.",
@@ -364,6 +454,8 @@ MeshObjectArray MeshObjectReader::read(
     stopwatch.measure();
 
     MeshObjectArray objects;
+    for (const_each<vector<MeshObject*> > i = mapped_objects; i; ++i)
+        objects.push_back(*i);
     for (const_each<vector<MeshObject*> > i = builder.get_objects(); i; ++i)
         objects.push_back(*i);
 
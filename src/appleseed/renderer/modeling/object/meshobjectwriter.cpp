@@ -31,17 +31,29 @@
 
 // appleseed.renderer headers.
 #include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectreader.h"
 #include "renderer/modeling/object/triangle.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exception.h"
 #include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/mesh/binarymeshfile.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
 #include "foundation/mesh/imeshfilewriter.h"
 #include "foundation/mesh/imeshwalker.h"
 #include "foundation/mesh/objmeshfilewriter.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// boost headers.
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace boost;
 using namespace foundation;
 using namespace std;
 
@@ -149,6 +161,48 @@ namespace
     };
 }
 
+namespace
+{
+    template <typename Writer, typename Walkers>
+    bool write_mesh_file(
+        Writer&             writer,
+        const Walkers&      walkers,
+        const char*         filename)
+    {
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        try
+        {
+            writer.write(filename, walkers);
+        }
+        catch (const ExceptionIOError&)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write mesh file %s: i/o error.",
+                filename);
+            return false;
+        }
+        catch (const Exception& e)
+        {
+            RENDERER_LOG_ERROR(
+                "failed to write mesh file %s: %s.",
+                filename,
+                e.what());
+            return false;
+        }
+
+        stopwatch.measure();
+
+        RENDERER_LOG_INFO(
+            "wrote mesh file %s in %s.",
+            filename,
+            pretty_time(stopwatch.get_seconds()).c_str());
+
+        return true;
+    }
+}
+
 bool MeshObjectWriter::write(
     const MeshObject&   object,
     const char*         object_name,
@@ -156,40 +210,55 @@ bool MeshObjectWriter::write(
 {
     assert(filename);
 
-    OBJMeshFileWriter writer;
     MeshObjectWalker walker(object, object_name);
 
-    Stopwatch<DefaultWallclockTimer> stopwatch;
-    stopwatch.start();
+    const filesystem::path filepath(filename);
 
-    try
+    if (lower_case(filepath.extension()) == BinaryMeshFile::Extension)
     {
-        writer.write(filename, walker);
+        BinaryMeshFileWriter writer;
+        return write_mesh_file(writer, walker, filename);
     }
-    catch (const ExceptionIOError&)
+    else
     {
-        RENDERER_LOG_ERROR(
-            "failed to write mesh file %s: i/o error.",
-            filename);
-        return false;
+        OBJMeshFileWriter writer;
+        return write_mesh_file(writer, walker, filename);
     }
-    catch (const Exception& e)
+}
+
+bool MeshObjectWriter::write_binary(
+    const MeshObjectArray&  objects,
+    const char*             base_object_name,
+    const char*             filename,
+    const int               options)
+{
+    assert(base_object_name);
+    assert(filename);
+
+    const string prefix = string(base_object_name) + ".";
+
+    vector<MeshObjectWalker*> walkers;
+    vector<const IMeshWalker*> walker_ptrs;
+
+    for (size_t i = 0; i < objects.size(); ++i)
     {
-        RENDERER_LOG_ERROR(
-            "failed to write mesh file %s: %s.",
-            filename,
-            e.what());
-        return false;
+        const string object_name = objects[i]->get_name();
+        const string mesh_name =
+            object_name.compare(0, prefix.size(), prefix) == 0
+                ? object_name.substr(prefix.size())
+                : object_name;
+
+        walkers.push_back(new MeshObjectWalker(*objects[i], mesh_name.c_str()));
+        walker_ptrs.push_back(walkers.back());
     }
 
-    stopwatch.measure();
+    BinaryMeshFileWriter writer(options);
+    const bool success = write_mesh_file(writer, walker_ptrs, filename);
 
-    RENDERER_LOG_INFO(
-        "wrote mesh file %s in %s.",
-        filename,
-        pretty_time(stopwatch.get_seconds()).c_str());
+    for (size_t i = 0; i < walkers.size(); ++i)
+        delete walkers[i];
 
-    return true;
+    return success;
 }
 
 }   // namespace renderer
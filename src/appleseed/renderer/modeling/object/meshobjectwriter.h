@@ -34,6 +34,7 @@
 
 // Forward declarations.
 namespace renderer      { class MeshObject; }
+namespace renderer      { class MeshObjectArray; }
 
 namespace renderer
 {
@@ -45,12 +46,22 @@ namespace renderer
 class RENDERERDLL MeshObjectWriter
 {
   public:
-    // Write a mesh object to disk.
-    // Return true on success, false otherwise.
+    // Write a mesh object to disk. The format of the file is determined
+    // by its extension. Return true on success, false otherwise.
     static bool write(
         const MeshObject&   object,
         const char*         object_name,
         const char*         filename);
+
+    // Write multiple mesh objects to a single binary mesh file. The name of each
+    // mesh is the name of its object without the "base_object_name." prefix.
+    // 'options' is a combination of foundation::BinaryMeshFileWriter::Options.
+    // Return true on success, false otherwise.
+    static bool write_binary(
+        const MeshObjectArray&  objects,
+        const char*             base_object_name,
+        const char*             filename,
+        const int               options);
 };
 
 }       // namespace renderer
@@ -0,0 +1,230 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "syntheticproject.h"
+
+// appleseed.renderer headers.
+// todo: include the required individual renderer headers rather than API headers.
+#include "renderer/api/camera.h"
+#include "renderer/api/frame.h"
+#include "renderer/api/object.h"
+#include "renderer/api/project.h"
+#include "renderer/api/scene.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/utility/containers/specializedarrays.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cmath>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SyntheticProjectFactory class implementation.
+//
+
+namespace
+{
+    // Create a mesh object made of small triangles randomly placed in the unit cube.
+    auto_release_ptr<MeshObject> create_random_mesh(
+        const char*         name,
+        const size_t        triangle_count,
+        MersenneTwister&    rng)
+    {
+        const float TriangleSize = 0.05f;
+
+        auto_release_ptr<MeshObject> mesh_object =
+            MeshObjectFactory::create(name, ParamArray());
+
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            const GVector3 center(
+                rand_float1(rng),
+                rand_float1(rng),
+                rand_float1(rng));
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const GVector3 offset(
+                    rand_float1(rng, -TriangleSize, TriangleSize),
+                    rand_float1(rng, -TriangleSize, TriangleSize),
+                    rand_float1(rng, -TriangleSize, TriangleSize));
+
+                mesh_object->push_vertex(center + offset);
+            }
+
+            const size_t v = 3 * i;
+            mesh_object->push_triangle(Triangle(v + 0, v + 1, v + 2, 0, 0, 0, 0));
+        }
+
+        // Vertex normals are not used by these projects, but one is required.
+        mesh_object->push_vertex_normal(GVector3(0.0f, 0.0f, -1.0f));
+
+        return mesh_object;
+    }
+
+    // Insert a mesh object into an assembly, along with a single instance of it.
+    void insert_mesh_object(
+        Assembly&                       assembly,
+        auto_release_ptr<MeshObject>    mesh_object)
+    {
+        const string object_instance_name = string(mesh_object->get_name()) + "_inst";
+
+        auto_release_ptr<Object> object(mesh_object.release());
+        Object& object_ref = object.ref();
+
+        assembly.object_instances().insert(
+            ObjectInstanceFactory::create(
+                object_instance_name.c_str(),
+                ParamArray(),
+                object_ref,
+                Transformd(Matrix4d::identity()),
+                StringArray()));
+
+        assembly.objects().insert(object);
+    }
+
+    // Create a project with a camera looking at the unit cube and an empty scene.
+    auto_release_ptr<Project> create_project(const char* name)
+    {
+        auto_release_ptr<Project> project(ProjectFactory::create(name));
+        project->add_default_configurations();
+
+        auto_release_ptr<Scene> scene(SceneFactory::create());
+
+        // Create a pinhole camera on the -Z side of the unit cube, looking toward +Z.
+        ParamArray camera_params;
+        camera_params.insert("film_dimensions", "0.025 0.025");
+        camera_params.insert("focal_length", "0.035");
+        auto_release_ptr<Camera> camera(
+            PinholeCameraFactory().create("camera", camera_params));
+        camera->transform_sequence().set_transform(
+            0.0,
+            Transformd(
+                  Matrix4d::translation(Vector3d(0.5, 0.5, -1.5))
+                * Matrix4d::rotation_y(Pi)));
+        scene->set_camera(camera);
+
+        // Create a frame.
+        ParamArray frame_params;
+        frame_params.insert("camera", "camera");
+        frame_params.insert("resolution", "512 512");
+        frame_params.insert("color_space", "srgb");
+        project->set_frame(FrameFactory::create("beauty", frame_params));
+
+        project->set_scene(scene);
+
+        return project;
+    }
+}
+
+auto_release_ptr<Project> SyntheticProjectFactory::create_triangle_soup(
+    const size_t            triangle_count,
+    const uint32            seed)
+{
+    auto_release_ptr<Project> project(create_project("triangle_soup"));
+    Scene* scene = project->get_scene();
+
+    MersenneTwister rng(seed);
+
+    // Create an assembly containing the mesh.
+    auto_release_ptr<Assembly> assembly(
+        AssemblyFactory::create("assembly", ParamArray()));
+    insert_mesh_object(
+        assembly.ref(),
+        create_random_mesh("triangle_soup", triangle_count, rng));
+
+    // Create a single instance of the assembly.
+    scene->assembly_instances().insert(
+        AssemblyInstanceFactory::create(
+            "assembly_inst",
+            ParamArray(),
+            assembly.ref(),
+            Transformd(Matrix4d::identity())));
+
+    scene->assemblies().insert(assembly);
+
+    return project;
+}
+
+auto_release_ptr<Project> SyntheticProjectFactory::create_instance_grid(
+    const size_t            instance_count,
+    const size_t            triangles_per_instance,
+    const uint32            seed)
+{
+    auto_release_ptr<Project> project(create_project("instance_grid"));
+    Scene* scene = project->get_scene();
+
+    MersenneTwister rng(seed);
+
+    // Create an assembly containing the mesh to instantiate.
+    auto_release_ptr<Assembly> assembly(
+        AssemblyFactory::create("assembly", ParamArray()));
+    insert_mesh_object(
+        assembly.ref(),
+        create_random_mesh("cluster", triangles_per_instance, rng));
+
+    // Lay the instances out on a square grid covering the unit square, at random depths.
+    const size_t grid_size =
+        static_cast<size_t>(ceil(sqrt(static_cast<double>(instance_count))));
+    const double cell_size = 1.0 / grid_size;
+
+    for (size_t i = 0; i < instance_count; ++i)
+    {
+        const Vector3d position(
+            (i % grid_size) * cell_size,
+            (i / grid_size) * cell_size,
+            rand_double1(rng, 0.0, 1.0 - cell_size));
+
+        scene->assembly_instances().insert(
+            AssemblyInstanceFactory::create(
+                ("assembly_inst_" + to_string(i)).c_str(),
+                ParamArray(),
+                assembly.ref(),
+                Transformd(
+                      Matrix4d::translation(position)
+                    * Matrix4d::scaling(Vector3d(cell_size)))));
+    }
+
+    scene->assemblies().insert(assembly);
+
+    return project;
+}
+
+}   // namespace renderer
@@ -0,0 +1,73 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_MODELING_PROJECTBUILTIN_SYNTHETICPROJECT_H
+#define APPLESEED_RENDERER_MODELING_PROJECTBUILTIN_SYNTHETICPROJECT_H
+
+// appleseed.renderer headers.
+#include "renderer/global/global.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace renderer  { class Project; }
+
+namespace renderer
+{
+
+//
+// Factory for procedurally generated projects, meant to stress specific parts
+// of the renderer. The geometry is deterministic for a given seed.
+//
+// Geometry has no material assigned and fits in the unit cube, which the
+// camera of the project looks at from the -Z side.
+//
+
+class RENDERERDLL SyntheticProjectFactory
+{
+  public:
+    // Create a project made of a single mesh of small, randomly placed triangles.
+    static foundation::auto_release_ptr<Project> create_triangle_soup(
+        const size_t                triangle_count,
+        const foundation::uint32    seed);
+
+    // Create a project made of a square grid of instances of a single assembly,
+    // itself containing a small mesh of randomly placed triangles.
+    static foundation::auto_release_ptr<Project> create_instance_grid(
+        const size_t                instance_count,
+        const size_t                triangles_per_instance,
+        const foundation::uint32    seed);
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_MODELING_PROJECTBUILTIN_SYNTHETICPROJECT_H
@@ -76,6 +76,7 @@ struct Project::Impl
     auto_release_ptr<Frame>         m_frame;
     ConfigurationContainer          m_configurations;
     SearchPaths                     m_search_paths;
+    string                          m_tree_cache_path;
     auto_ptr<TraceContext>          m_trace_context;
 };
 
@@ -264,12 +265,29 @@ const SearchPaths& Project::get_search_paths() const
     return impl->m_search_paths;
 }
 
+void Project::set_tree_cache_path(const char* path)
+{
+    assert(path);
+    impl->m_tree_cache_path = path;
+
+    if (impl->m_trace_context.get())
+        impl->m_trace_context->set_tree_cache_path(path);
+}
+
+const char* Project::get_tree_cache_path() const
+{
+    return impl->m_tree_cache_path.c_str();
+}
+
 const TraceContext& Project::get_trace_context() const
 {
     if (impl->m_trace_context.get() == 0)
     {
         assert(impl->m_scene.get());
-        impl->m_trace_context.reset(new TraceContext(*impl->m_scene));
+        impl->m_trace_context.reset(
+            new TraceContext(
+                *impl->m_scene,
+                impl->m_tree_cache_path.c_str()));
     }
 
     return *impl->m_trace_context;
@@ -87,6 +87,11 @@ class RENDERERDLL Project
     foundation::SearchPaths& get_search_paths();
     const foundation::SearchPaths& get_search_paths() const;
 
+    // Set/get the directory where acceleration structures are cached
+    // across renders. An empty path disables caching.
+    void set_tree_cache_path(const char* path);
+    const char* get_tree_cache_path() const;
+
     // Get the trace context.
     const TraceContext& get_trace_context() const;
 
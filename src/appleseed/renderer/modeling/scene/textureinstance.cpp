@@ -88,6 +88,10 @@ TextureInstance::TextureInstance(
         impl->m_filtering_mode = TextureFilteringNearest;
     else if (filtering_mode == "bilinear")
         impl->m_filtering_mode = TextureFilteringBilinear;
+    else if (filtering_mode == "trilinear")
+        impl->m_filtering_mode = TextureFilteringTrilinear;
+    else if (filtering_mode == "ewa")
+        impl->m_filtering_mode = TextureFilteringEWA;
     else
     {
         RENDERER_LOG_ERROR(
@@ -160,7 +164,9 @@ DictionaryArray TextureInstanceFactory::get_widget_definitions()
             .insert("dropdown_items",
                 Dictionary()
                     .insert("Nearest", "nearest")
-                    .insert("Bilinear", "bilinear"))
+                    .insert("Bilinear", "bilinear")
+                    .insert("Trilinear", "trilinear")
+                    .insert("EWA", "ewa"))
             .insert("use", "required")
             .insert("default", "bilinear"));
 
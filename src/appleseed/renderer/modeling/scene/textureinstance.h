@@ -55,9 +55,10 @@ enum TextureFilteringMode
 {
     TextureFilteringNearest = 0,
     TextureFilteringBilinear,
+    TextureFilteringTrilinear,          // requires a mipmap pyramid
     TextureFilteringBicubic,
     TextureFilteringFeline,             // Reference: http://www.hpl.hp.com/techreports/Compaq-DEC/WRL-99-1.pdf
-    TextureFilteringEWA
+    TextureFilteringEWA                 // requires a mipmap pyramid; reference: http://www.cs.cmu.edu/~ph/texfund/texfund.pdf
 };
 
 
@@ -41,14 +41,18 @@
 #include "renderer/modeling/surfaceshader/surfaceshader.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/aabb.h"
 #include "foundation/math/intersection.h"
 #include "foundation/math/minmax.h"
 #include "foundation/math/noise.h"
 #include "foundation/math/scalar.h"
 #include "foundation/utility/containers/specializedarrays.h"
 #include "foundation/utility/searchpaths.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
 // Forward declarations.
@@ -70,6 +74,7 @@ namespace
     const float OccupancyThreshold = 0.0001f;
     const float MinOpacity = 0.0001f;
     const float MaxOpacity = 0.9999f;
+    const float MaxStepOpacity = 0.01f;     // maximum opacity accumulated over one adaptive step
 
 
     //
@@ -119,8 +124,20 @@ namespace
                             *m_voxel_grid.get(),
                             m_channels.m_density_index,
                             OccupancyThreshold));
+                }
+                else if (m_sparse_voxel_grid.get())
+                {
+                    m_occupancy_grid.reset(
+                        new OccupancyGrid(
+                            *m_sparse_voxel_grid.get(),
+                            m_channels.m_density_index,
+                            OccupancyThreshold));
+                }
 
+                if (m_occupancy_grid.get())
+                {
                     m_rcp_bbox_extent = Vector3d(1.0) / m_bbox.extent();
+                    print_memory_usage();
                 }
 
                 m_first_frame = false;
@@ -181,6 +198,12 @@ namespace
             QuadraticMode
         };
 
+        enum VoxelStorage
+        {
+            DenseStorage = 0,
+            SparseStorage
+        };
+
         static const size_t MaxChannels = 14;
 
         bool                    m_first_frame;
@@ -188,9 +211,12 @@ namespace
         AABB3d                  m_bbox;
         ShadingMode             m_shading_mode;
         InterpolationMode       m_interpolation_mode;
+        VoxelStorage            m_voxel_storage;
         float                   m_isosurface_threshold;
         string                  m_filename;
         double                  m_step_size;
+        size_t                  m_max_step_count;
+        bool                    m_skip_empty_space;
         float                   m_density_cutoff;
         float                   m_density_scale;
         Color3f                 m_smoke_color;
@@ -202,8 +228,9 @@ namespace
         float                   m_volume_opacity;
         float                   m_shadow_opacity;
 
-        auto_ptr<VoxelGrid>     m_voxel_grid;
-        FluidChannels           m_channels;
+        auto_ptr<VoxelGrid>         m_voxel_grid;
+        auto_ptr<SparseVoxelGrid>   m_sparse_voxel_grid;
+        FluidChannels               m_channels;
 
         auto_ptr<OccupancyGrid> m_occupancy_grid;
         Vector3d                m_rcp_bbox_extent;
@@ -260,10 +287,30 @@ namespace
                 m_interpolation_mode = LinearMode;
             }
 
+            // Retrieve the voxel storage.
+            const string voxel_storage_string =
+                m_params.get_optional<string>("voxel_storage", "dense");
+            if (voxel_storage_string == "dense")
+                m_voxel_storage = DenseStorage;
+            else if (voxel_storage_string == "sparse")
+                m_voxel_storage = SparseStorage;
+            else
+            {
+                RENDERER_LOG_ERROR(
+                    "invalid voxel storage \"%s\", using default value \"dense\".",
+                    voxel_storage_string.c_str());
+                m_voxel_storage = DenseStorage;
+            }
+
             // Retrieve the other parameters.
             m_isosurface_threshold = m_params.get_optional<float>("isosurface_threshold", 0.5f);
             m_filename = m_params.get_optional<string>("filename", "");
             m_step_size = m_params.get_optional<double>("step_size", 0.1);
+            m_max_step_count =
+                max<size_t>(
+                    truncate<size_t>(m_params.get_optional<double>("max_step_size", m_step_size) / m_step_size + 1.0e-6),
+                    1);
+            m_skip_empty_space = m_params.get_optional<bool>("skip_empty_space", true);
             m_density_cutoff = m_params.get_optional<float>("density_cutoff", 1.0f);
             m_density_scale = m_params.get_optional<float>("density_scale", 1.0f);
             m_smoke_color = m_params.get_optional<Color3f>("smoke_color", Color3f(1.0f, 1.0f, 1.0f));
@@ -333,9 +380,12 @@ namespace
 
             RENDERER_LOG_INFO("loading fluid file %s...", filepath.c_str());
 
-            m_voxel_grid = read_fluid_file(filepath.c_str(), m_channels);
+            if (m_voxel_storage == SparseStorage)
+                m_sparse_voxel_grid = read_sparse_fluid_file(filepath.c_str(), m_channels);
+            else
+                m_voxel_grid = read_fluid_file(filepath.c_str(), m_channels);
 
-            if (m_voxel_grid.get() == 0)
+            if (m_voxel_grid.get() == 0 && m_sparse_voxel_grid.get() == 0)
                 RENDERER_LOG_ERROR("failed to load fluid file %s.", filepath.c_str());
 
 /*
@@ -345,9 +395,43 @@ namespace
 */
         }
 
+        void print_memory_usage() const
+        {
+            size_t voxel_grid_size, xres, yres;
+
+            if (m_sparse_voxel_grid.get())
+            {
+                voxel_grid_size = m_sparse_voxel_grid->get_memory_size();
+                xres = m_sparse_voxel_grid->get_xres();
+                yres = m_sparse_voxel_grid->get_yres();
+            }
+            else
+            {
+                voxel_grid_size = m_voxel_grid->get_memory_size();
+                xres = m_voxel_grid->get_xres();
+                yres = m_voxel_grid->get_yres();
+            }
+
+            const size_t occupancy_grid_size = m_occupancy_grid->get_memory_size();
+
+            // The buffer used to read the fluid file is released before the occupancy grid is built.
+            const size_t read_buffer_size =
+                m_filename.empty() ? 0 : get_fluid_file_read_buffer_size(xres, yres);
+
+            const size_t peak_size =
+                voxel_grid_size +
+                max(read_buffer_size, occupancy_grid_size + OccupancyGrid::get_build_memory_size());
+
+            RENDERER_LOG_INFO(
+                "fluid memory usage: %s for the voxel grid, %s for the occupancy grid, %s at peak while loading.",
+                pretty_size(voxel_grid_size).c_str(),
+                pretty_size(occupancy_grid_size).c_str(),
+                pretty_size(peak_size).c_str());
+        }
+
         void print_channel_availability()
         {
-            if (m_voxel_grid.get())
+            if (m_voxel_grid.get() || m_sparse_voxel_grid.get())
             {
                 RENDERER_LOG_INFO(
                     "fluid channels:\n"
@@ -435,12 +519,130 @@ namespace
             tmax = min(txmax, tymax, tzmax);
         }
 
+        // Express a ray in the unit cube coordinates of the volume.
+        ShadingRay get_normalized_ray(const ShadingRay& ray) const
+        {
+            ShadingRay normalized_ray;
+            normalized_ray.m_org = (ray.m_org - m_bbox.min) * m_rcp_bbox_extent;
+            normalized_ray.m_dir = ray.m_dir * m_rcp_bbox_extent;
+            return normalized_ray;
+        }
+
+        // Return the number of steps from a given sample to the first sample past a node.
+        size_t get_step_count_to_exit(
+            const ShadingRay&               normalized_ray,
+            const ShadingRay::RayInfoType&  normalized_ray_info,
+            const AABB3d&                   node_bbox,
+            const double                    t0,
+            const size_t                    sample_index,
+            const double                    tmax) const
+        {
+            double t_exit;
+            intersect_tmax(
+                normalized_ray,
+                normalized_ray_info,
+                node_bbox,
+                t_exit);
+
+            // Don't move if the exit point could not be reliably computed.
+            const double t = t0 + sample_index * m_step_size;
+            if (!(t_exit > t))
+                return 1;
+
+            // Samples very close to the exit point are not skipped, so that rounding
+            // errors can't make us skip samples that lie just outside of the node.
+            const double exit_index = ceil((min(t_exit, tmax) - t0) / m_step_size - 1.0e-3);
+            const size_t next_sample_index = truncate<size_t>(exit_index);
+
+            return next_sample_index > sample_index ? next_sample_index - sample_index : 1;
+        }
+
+        // Return an upper bound on the opacity of the samples of a region given an upper
+        // bound on the density in that region. Mirrors get_sample_opacity_fast().
+        float get_max_sample_opacity(const float max_density) const
+        {
+            return smoothstep(0.0f, m_density_cutoff, max_density * m_density_scale);
+        }
+
+        // Decide how to take a given sample along a ray. Return false if the sample lies in
+        // an empty region of the volume, in which case 'step_count' is the number of steps
+        // to the first sample past that region. Otherwise return true, 'step_count' then
+        // being the number of steps accounted for by this sample.
+        bool get_step_count(
+            const ShadingRay&               normalized_ray,
+            const ShadingRay::RayInfoType&  normalized_ray_info,
+            const double                    t0,
+            const size_t                    sample_index,
+            const double                    tmax,
+            const float                     opacity_scale,
+            size_t&                         step_count) const
+        {
+            step_count = 1;
+
+            // No fluid is defined.
+            if (m_occupancy_grid.get() == 0)
+                return true;
+
+            const Vector3d point = normalized_ray.point_at(t0 + sample_index * m_step_size);
+
+            // Jump over empty regions of the volume. The samples that are skipped are
+            // those that would have been found empty by the occupancy grid anyway.
+            AABB3d node_bbox;
+            if (m_skip_empty_space && m_occupancy_grid->find_empty_node(point, node_bbox))
+            {
+                step_count =
+                    get_step_count_to_exit(
+                        normalized_ray,
+                        normalized_ray_info,
+                        node_bbox,
+                        t0,
+                        sample_index,
+                        tmax);
+                return false;
+            }
+
+            // Take larger steps through regions of low density, keeping the opacity
+            // accumulated over one step below MaxStepOpacity.
+            if (m_max_step_count > 1)
+            {
+                const size_t level_count = m_occupancy_grid->get_level_count();
+                for (size_t level = 0; level < level_count; ++level)
+                {
+                    const float max_density = m_occupancy_grid->get_max_density(point, level);
+                    const double max_opacity = get_max_sample_opacity(max_density) * opacity_scale * m_step_size;
+
+                    // Coarser nodes are at least as dense: stop as soon as they don't allow larger steps.
+                    if (max_opacity * (step_count + 1) > MaxStepOpacity)
+                        break;
+
+                    size_t count = m_max_step_count;
+                    if (max_opacity * count > MaxStepOpacity)
+                        count = truncate<size_t>(MaxStepOpacity / max_opacity);
+
+                    count =
+                        min(
+                            count,
+                            get_step_count_to_exit(
+                                normalized_ray,
+                                normalized_ray_info,
+                                m_occupancy_grid->get_node_bbox(point, level),
+                                t0,
+                                sample_index,
+                                tmax));
+
+                    step_count = max(step_count, count);
+                }
+            }
+
+            return true;
+        }
+
         // Retrieve the fluid values at a given point, in world space.
         // Return true if the fluid is present at that point, false otherwise.
         bool get_fluid_values(const Vector3d& point, float values[]) const
         {
             // No fluid is defined.
-            if (m_voxel_grid.get() == 0)
+            if (m_occupancy_grid.get() == 0)
                 return false;
 
             // Normalize the lookup point coordinates.
@@ -451,18 +653,30 @@ namespace
                 return false;
 
             // Lookup the grid.
+            return
+                m_sparse_voxel_grid.get()
+                    ? lookup_voxel_grid(*m_sparse_voxel_grid.get(), normalized_point, values)
+                    : lookup_voxel_grid(*m_voxel_grid.get(), normalized_point, values);
+        }
+
+        template <typename Grid>
+        bool lookup_voxel_grid(
+            const Grid&         voxel_grid,
+            const Vector3d&     normalized_point,
+            float               values[]) const
+        {
             switch (m_interpolation_mode)
             {
               case NearestMode:
-                  m_voxel_grid->nearest_lookup(normalized_point, values);
+                  voxel_grid.nearest_lookup(normalized_point, values);
                   return true;
 
               case LinearMode:
-                  m_voxel_grid->linear_lookup(normalized_point, values);
+                  voxel_grid.linear_lookup(normalized_point, values);
                   return true;
 
               case QuadraticMode:
-                  m_voxel_grid->quadratic_lookup(normalized_point, values);
+                  voxel_grid.quadratic_lookup(normalized_point, values);
                   return true;
 
               default:
@@ -651,31 +865,52 @@ namespace
                     m_bbox,
                     tmax);
 
+                // Express the shadow ray in the coordinates of the occupancy grid.
+                const ShadingRay normalized_ray = get_normalized_ray(ray);
+                const ShadingRay::RayInfoType normalized_ray_info(normalized_ray);
+
                 float shadow_opacity = 0.0f;
 
                 // Integrate the shadow opacity along the shadow ray.
-                const float step_size = static_cast<float>(m_step_size);
-                double t = 0.5 * m_step_size;
-                while (t < tmax && shadow_opacity < MaxOpacity)
+                const double t0 = 0.5 * m_step_size;
+                size_t sample_index = 0;
+                while (shadow_opacity < MaxOpacity)
                 {
-                    // Compute the world space position of the sample.
-                    const Vector3d sample_position = ray.point_at(t);
-
-                    // Get the fluid values at this position.
-                    float values[MaxChannels];
-                    if (get_fluid_values(sample_position, values))
+                    // Compute the distance along the ray of the sample.
+                    const double t = t0 + sample_index * m_step_size;
+                    if (t >= tmax)
+                        break;
+
+                    size_t step_count;
+                    if (get_step_count(
+                            normalized_ray,
+                            normalized_ray_info,
+                            t0,
+                            sample_index,
+                            tmax,
+                            m_shadow_opacity,
+                            step_count))
                     {
-                        // Compute the sample opacity.
-                        float sample_opacity = get_sample_opacity_fast(values);
-                        sample_opacity *= m_shadow_opacity;
+                        // Compute the world space position of the sample.
+                        const Vector3d sample_position = ray.point_at(t);
 
-                        // Integrate the shadow opacity.
-                        assert(shadow_opacity < 1.0f);
-                        shadow_opacity += (1.0f - shadow_opacity) * sample_opacity * step_size;
+                        // Get the fluid values at this position.
+                        float values[MaxChannels];
+                        if (get_fluid_values(sample_position, values))
+                        {
+                            // Compute the sample opacity.
+                            float sample_opacity = get_sample_opacity_fast(values);
+                            sample_opacity *= m_shadow_opacity;
+
+                            // Integrate the shadow opacity.
+                            const float step_size = static_cast<float>(step_count * m_step_size);
+                            assert(shadow_opacity < 1.0f);
+                            shadow_opacity += (1.0f - shadow_opacity) * sample_opacity * step_size;
+                        }
                     }
 
                     // Move forward along the ray.
-                    t += m_step_size;
+                    sample_index += step_count;
                 }
 
                 // Clamp the shadow opacity to [0, 1].
@@ -708,36 +943,58 @@ namespace
             volume_color.set(0.0f);
             volume_opacity = 0.0f;
 
-            // Integrate the volume color and opacity along the incoming ray.
-            const float step_size = static_cast<float>(m_step_size);
-            double t = tmin + 0.5 * m_step_size;
-            while (t < tmax && volume_opacity < MaxOpacity)
-            {
-                // Compute the world space position of the sample.
-                const Vector3d sample_position = ray.point_at(t);
+            // Express the ray in the coordinates of the occupancy grid.
+            const ShadingRay normalized_ray = get_normalized_ray(ray);
+            const ShadingRay::RayInfoType normalized_ray_info(normalized_ray);
 
-                // Get the fluid values at this position.
-                float values[MaxChannels];
-                if (get_fluid_values(sample_position, values))
+            // Integrate the volume color and opacity along the incoming ray,
+            // stopping as soon as the volume becomes (almost) fully opaque.
+            const double t0 = tmin + 0.5 * m_step_size;
+            size_t sample_index = 0;
+            while (volume_opacity < MaxOpacity)
+            {
+                // Compute the distance along the ray of the sample.
+                const double t = t0 + sample_index * m_step_size;
+                if (t >= tmax)
+                    break;
+
+                size_t step_count;
+                if (get_step_count(
+                        normalized_ray,
+                        normalized_ray_info,
+                        t0,
+                        sample_index,
+                        tmax,
+                        m_volume_opacity,
+                        step_count))
                 {
-                    // Compute the sample opacity.
-                    float sample_opacity = get_sample_opacity(sample_position, values);
-                    sample_opacity *= m_volume_opacity;
+                    // Compute the world space position of the sample.
+                    const Vector3d sample_position = ray.point_at(t);
 
-                    if (sample_opacity > MinOpacity)
+                    // Get the fluid values at this position.
+                    float values[MaxChannels];
+                    if (get_fluid_values(sample_position, values))
                     {
-                        // Compute the sample color.
-                        const Color3f sample_color = get_sample_color(sample_position, values);
+                        // Compute the sample opacity.
+                        float sample_opacity = get_sample_opacity(sample_position, values);
+                        sample_opacity *= m_volume_opacity;
 
-                        // Integrate the volume color and opacity.
-                        assert(volume_opacity < 1.0f);
-                        volume_color += (1.0f - volume_opacity) * sample_opacity * sample_color * step_size;
-                        volume_opacity += (1.0f - volume_opacity) * sample_opacity * step_size;
+                        if (sample_opacity > MinOpacity)
+                        {
+                            // Compute the sample color.
+                            const Color3f sample_color = get_sample_color(sample_position, values);
+
+                            // Integrate the volume color and opacity.
+                            const float step_size = static_cast<float>(step_count * m_step_size);
+                            assert(volume_opacity < 1.0f);
+                            volume_color += (1.0f - volume_opacity) * sample_opacity * sample_color * step_size;
+                            volume_opacity += (1.0f - volume_opacity) * sample_opacity * step_size;
+                        }
                     }
                 }
 
                 // Move forward along the ray.
-                t += m_step_size;
+                sample_index += step_count;
             }
 
             // Clamp the volume opacity to [0, 1].
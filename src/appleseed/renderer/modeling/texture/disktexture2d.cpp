@@ -35,7 +35,7 @@
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/colorspace.h"
-#include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/image/concurrentimagefilereader.h"
 #include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/platform/thread.h"
@@ -85,16 +85,15 @@ namespace
 
         virtual const CanvasProperties& properties()
         {
-            mutex::scoped_lock lock(m_mutex);
             open_image_file();
-            return m_props;
+            return m_reader.get_canvas_properties();
         }
 
         virtual Tile* load_tile(
             const size_t    tile_x,
             const size_t    tile_y)
         {
-            mutex::scoped_lock lock(m_mutex);
+            // Tiles are read concurrently, the lock only protects the opening of the file.
             open_image_file();
             return m_reader.read_tile(tile_x, tile_y);
         }
@@ -112,8 +111,7 @@ namespace
         ColorSpace                          m_color_space;
 
         mutable mutex                       m_mutex;
-        GenericProgressiveImageFileReader   m_reader;
-        CanvasProperties                    m_props;
+        ConcurrentImageFileReader           m_reader;
 
         void extract_parameters(const SearchPaths& search_paths)
         {
@@ -143,6 +141,8 @@ namespace
         // Open the image file.
         void open_image_file()
         {
+            mutex::scoped_lock lock(m_mutex);
+
             if (!m_reader.is_open())
             {
                 RENDERER_LOG_INFO(
@@ -150,7 +150,6 @@ namespace
                     m_filepath.c_str());
 
                 m_reader.open(m_filepath.c_str());
-                m_reader.read_canvas_properties(m_props);
             }
         }
     };
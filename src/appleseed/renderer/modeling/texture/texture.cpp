@@ -29,7 +29,17 @@
 // Interface header.
 #include "texture.h"
 
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/platform/thread.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -43,12 +53,71 @@ namespace
     const UniqueID g_class_uid = new_guid();
 }
 
+struct Texture::Impl
+{
+    boost::mutex                m_mutex;
+    bool                        m_has_level_props;
+    vector<CanvasProperties>    m_level_props;      // canvas properties of all levels
+};
+
 Texture::Texture(
     const char*         name,
     const ParamArray&   params)
   : Entity(g_class_uid, params)
+  , impl(new Impl())
 {
     set_name(name);
+
+    impl->m_has_level_props = false;
+}
+
+Texture::~Texture()
+{
+    delete impl;
+}
+
+size_t Texture::get_level_count()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    init_level_properties();
+    return impl->m_level_props.size();
+}
+
+const CanvasProperties& Texture::get_level_properties(const size_t level)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    init_level_properties();
+    assert(level < impl->m_level_props.size());
+    return impl->m_level_props[level];
+}
+
+void Texture::init_level_properties()
+{
+    if (impl->m_has_level_props)
+        return;
+
+    const CanvasProperties& base = properties();
+    impl->m_level_props.push_back(base);
+
+    size_t width = base.m_canvas_width;
+    size_t height = base.m_canvas_height;
+
+    while (width > 1 || height > 1)
+    {
+        width = max<size_t>(width / 2, 1);
+        height = max<size_t>(height / 2, 1);
+
+        impl->m_level_props.push_back(
+            CanvasProperties(
+                width,
+                height,
+                min(base.m_tile_width, width),
+                min(base.m_tile_height, height),
+                base.m_channel_count,
+                base.m_pixel_format));
+    }
+
+    impl->m_has_level_props = true;
 }
 
 }   // namespace renderer
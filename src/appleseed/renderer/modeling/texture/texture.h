@@ -75,6 +75,25 @@ class RENDERERDLL Texture
         const size_t        tile_x,
         const size_t        tile_y,
         foundation::Tile*   tile) = 0;
+
+    // Return the number of levels of the mipmap pyramid of the texture.
+    // Level 0 is the texture itself, the last level is 1x1 pixel.
+    size_t get_level_count();
+
+    // Access the canvas properties of a given level of the mipmap pyramid.
+    // Only level 0 is provided by the texture: the tiles of the other levels
+    // are generated on demand by the texture store.
+    const foundation::CanvasProperties& get_level_properties(const size_t level);
+
+  protected:
+    // Destructor.
+    ~Texture();
+
+  private:
+    struct Impl;
+    Impl* impl;
+
+    void init_level_properties();
 };
 
 }       // namespace renderer
@@ -0,0 +1,98 @@
+
+//
+// This source file is part of appleseed.
+// Visit http://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2012 Francois Beaune, Jupiter Jazz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Project headers.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/application.h"
+#include "application/superlogger.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/object.h"
+
+// appleseed.foundation headers.
+#include "foundation/mesh/binarymeshfilewriter.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace appleseed::convertmeshfile;
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+
+//
+// Entry point of convertmeshfile.
+//
+
+int main(int argc, const char* argv[])
+{
+    SuperLogger logger;
+
+    Application::check_installation(logger);
+
+    CommandLineHandler cl;
+    cl.parse(argc, argv, logger);
+
+    global_logger().add_target(&logger.get_log_target());
+
+    const string& input_filename = cl.m_filenames.values()[0];
+    const string& output_filename = cl.m_filenames.values()[1];
+
+    // Load the input mesh file. Vertex normals are kept as they are.
+    const char* BaseObjectName = "mesh";
+    MeshObjectArray objects =
+        MeshObjectReader::read(input_filename.c_str(), BaseObjectName, ParamArray());
+
+    // Bail out if the mesh file couldn't be loaded.
+    if (objects.empty())
+        return 1;
+
+    int options = BinaryMeshFileWriter::Defaults;
+    if (cl.m_quantize_vertices.is_set())
+        options |= BinaryMeshFileWriter::QuantizeVertices;
+    if (cl.m_quantize_normals.is_set())
+        options |= BinaryMeshFileWriter::QuantizeNormals;
+
+    // Write all mesh objects to the output binary mesh file.
+    const bool success =
+        MeshObjectWriter::write_binary(
+            objects,
+            BaseObjectName,
+            output_filename.c_str(),
+            options);
+
+    for (size_t i = 0; i < objects.size(); ++i)
+        objects[i]->release();
+
+    return success ? 0 : 1;
+}